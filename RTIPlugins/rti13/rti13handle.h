@@ -49,6 +49,8 @@ namespace dtHLAGM
          }
          return castH->mHandle == mHandle;
       }
+
+      virtual size_t GetHash() const { return size_t(mHandle); }
    protected:
       virtual ~RTI13Handle() {}
    private:
@@ -45,6 +45,7 @@ namespace dtAI
 {
    class WaypointCollection;
    class WaypointGraph;
+   class PathRequestQueue;
 
    class DT_AI_EXPORT AIPluginInterface : public osg::Referenced
    {
@@ -131,7 +132,7 @@ namespace dtAI
       virtual WaypointInterface* GetClosestWaypoint(const osg::Vec3& pos, float maxDistance) = 0;
 
        /**
-       * Finds the closest waypoint to a given point with a specific name.  O(n) search.
+       * Finds the closest waypoint to a given point with a specific name.
        * @return the waypoint found, or NULL if no waypoints exist
        */
       virtual WaypointInterface* GetClosestNamedWaypoint(const std::string& name, const osg::Vec3& pos, float maxDistance) = 0;
@@ -144,6 +145,38 @@ namespace dtAI
        */
       virtual bool GetWaypointsAtRadius(const osg::Vec3& pos, float radius, WaypointArray& arrayToFill) = 0;
 
+      /**
+       * Finds up to k waypoints closest to a given point, sorted nearest first.
+       * @param pos, the point to search from
+       * @param k, the maximum number of waypoints to return
+       * @param maxDistance, waypoints at or beyond this distance are ignored
+       * @param arrayToFill, a std::vector<WaypointInterface*> by reference for the result
+       * @return true if any waypoints were found.
+       */
+      virtual bool GetNearestWaypoints(const osg::Vec3& pos, unsigned k, float maxDistance, WaypointArray& arrayToFill);
+
+      /**
+       * Batch version of GetClosestWaypoint, for doing queries for many agents at once.
+       * The default implementation just loops, but implementations may split the queries across the
+       * dtUtil::ThreadPool.
+       * @param positions the points to search from
+       * @param maxDistance the maximum search distance for every query
+       * @param results resized to match positions, each entry is the closest waypoint or NULL.
+       */
+      virtual void GetClosestWaypointsBatch(const std::vector<osg::Vec3>& positions, float maxDistance, WaypointArray& results);
+
+      /**
+       * Batch version of GetNearestWaypoints.
+       * @param results resized to match positions, each entry is filled as GetNearestWaypoints would.
+       */
+      virtual void GetNearestWaypointsBatch(const std::vector<osg::Vec3>& positions, unsigned k, float maxDistance, std::vector<WaypointArray>& results);
+
+      /**
+       * Batch version of GetWaypointsAtRadius.
+       * @param results resized to match positions, each entry is filled as GetWaypointsAtRadius would.
+       */
+      virtual void GetWaypointsAtRadiusBatch(const std::vector<osg::Vec3>& positions, float radius, std::vector<WaypointArray>& results);
+
       /**
        * Returns a waypoint by waypoint Id
        * @return the waypoint found, or NULL if no waypoint exists with that Id
@@ -217,6 +250,12 @@ namespace dtAI
        */
       virtual PathFindResult HierarchicalFindPath(WaypointID from, WaypointID to, ConstWaypointArray& result) = 0;
 
+      /**
+       * Returns the queue for searching many paths spread over several frames, or NULL if this interface has none.
+       * The BaseAIComponent updates it every tick.  The default has none.
+       */
+      virtual PathRequestQueue* GetPathRequestQueue();
+
       /**
        * Loads the waypoint file into the system
        * @param the name of the waypoint file
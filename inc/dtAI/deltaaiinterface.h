@@ -24,8 +24,10 @@
 
 #include <dtAI/aiplugininterface.h>
 #include <dtAI/export.h>
+#include <dtAI/pathrequestqueue.h>
 #include <dtAI/waypointgraphastar.h>
 #include <dtUtil/kdtree.h>
+#include <map>
 
 namespace dtAI
 {
@@ -37,6 +39,8 @@ namespace dtAI
       typedef float value_type;
 
       KDHolder(const osg::Vec3& pos)
+         : mID(0)
+         , mWaypoint(NULL)
       {
          d[0] = pos[0];
          d[1] = pos[1];
@@ -44,15 +48,27 @@ namespace dtAI
       }
 
       KDHolder(const osg::Vec3& pos, WaypointID id)
+         : mID(id)
+         , mWaypoint(NULL)
       {
          d[0] = pos[0];
          d[1] = pos[1];
          d[2] = pos[2];
+      }
 
-         mID = id;
+      /// Holding the waypoint pointer allows search results to skip the id lookup.
+      KDHolder(const osg::Vec3& pos, WaypointInterface* waypoint)
+         : mID(waypoint->GetID())
+         , mWaypoint(waypoint)
+      {
+         d[0] = pos[0];
+         d[1] = pos[1];
+         d[2] = pos[2];
       }
 
       KDHolder(value_type a, value_type b, value_type c)
+         : mID(0)
+         , mWaypoint(NULL)
       {
          d[0] = a;
          d[1] = b;
@@ -65,6 +81,7 @@ namespace dtAI
          d[1] = x.d[1];
          d[2] = x.d[2];
          mID = x.mID;
+         mWaypoint = x.mWaypoint;
       }
 
       operator osg::Vec3()
@@ -74,7 +91,14 @@ namespace dtAI
 
       inline value_type operator[](size_t const N) const { return d[N]; }
 
+      /// Used by KDTree::find_exact, matches the position and the waypoint id.
+      bool operator==(const KDHolder& x) const
+      {
+         return mID == x.mID && d[0] == x.d[0] && d[1] == x.d[1] && d[2] == x.d[2];
+      }
+
       WaypointID mID;
+      WaypointInterface* mWaypoint;
       value_type d[3];
    };
 
@@ -108,6 +132,11 @@ namespace dtAI
       void GetAllEdgesFromWaypoint(WaypointID pFrom, ConstWaypointArray& result) const;
       PathFindResult FindPath(WaypointID pFrom, WaypointID pTo, ConstWaypointArray& result);
       PathFindResult HierarchicalFindPath(WaypointID pFrom, WaypointID pTo, ConstWaypointArray& result);
+      PathRequestQueue* GetPathRequestQueue();
+
+      /// The cache of paths between WaypointCollections shared by HierarchicalFindPath and the path request queue.
+      AbstractPathCache& GetAbstractPathCache();
+
       void ClearMemory();
       bool LoadLegacyWaypointFile(const std::string& filename);
       bool LoadWaypointFile(const std::string& filename);
@@ -122,22 +151,69 @@ namespace dtAI
       WaypointInterface* GetClosestWaypoint(const osg::Vec3& pos, float maxRadius);
       WaypointInterface* GetClosestNamedWaypoint(const std::string& name, const osg::Vec3& pos, float maxRadius);
       bool GetWaypointsAtRadius(const osg::Vec3& pos, float radius, WaypointArray& arrayToFill);
+      bool GetNearestWaypoints(const osg::Vec3& pos, unsigned k, float maxDistance, WaypointArray& arrayToFill);
+
+      /**
+       * The batch queries rebalance the kd-tree first if needed, then, if the dtUtil::ThreadPool is initialized and
+       * there are enough queries to make it worthwhile, they are split into tasks and run in parallel.
+       * No waypoints may be added, moved or removed on other threads while these are running.
+       */
+      void GetClosestWaypointsBatch(const std::vector<osg::Vec3>& positions, float maxDistance, WaypointArray& results);
+      void GetNearestWaypointsBatch(const std::vector<osg::Vec3>& positions, unsigned k, float maxDistance, std::vector<WaypointArray>& results);
+      void GetWaypointsAtRadiusBatch(const std::vector<osg::Vec3>& positions, float radius, std::vector<WaypointArray>& results);
+
+      /**
+       * The kd-tree supports inserting and erasing in place, so edits don't force a rebuild.  The tree is only
+       * rebalanced on the next query once the number of edits since the last rebalance exceeds
+       * this fraction of the number of waypoints.  Defaults to 0.25.
+       */
+      void SetRebalanceThreshold(float fractionOfTreeSize);
+      float GetRebalanceThreshold() const;
+
+      /// @return the number of inserts, moves and removes since the kd-tree was last rebalanced.
+      unsigned GetNumEditsSinceRebalance() const;
 
    protected:
 
       virtual ~DeltaAIInterface();
+
+      /// Rebalances the kd-tree if enough edits have accumulated.
+      void OptimizeIfNeeded();
       void Optimize();
       void UpdateDebugDrawable();
 
+      /// Adds the waypoint to the kd-tree and the sub-indices.
+      void IndexWaypoint(WaypointInterface& waypoint);
+      /// Removes the waypoint from the name and type sub-indices.
+      void UnindexWaypoint(WaypointInterface& waypoint);
+      /// Rebuilds the name index if any named waypoint was renamed since it was built.
+      void SyncNameIndex();
+      /// Removes the waypoint from the kd-tree, returns false if it could not be found.
+      bool RemoveFromKDTree(WaypointInterface& waypoint);
+
    private:
       dtCore::RefPtr<AIDebugDrawable> mDrawable;
       dtCore::RefPtr<WaypointGraph> mWaypointGraph;
       WaypointGraphAStar mAStar;
+      dtCore::RefPtr<AbstractPathCache> mPathCache;
+      dtCore::RefPtr<PathRequestQueue> mPathRequests;
 
       typedef std::vector< dtCore::RefPtr<dtAI::WaypointInterface> > WaypointRefArray;
       WaypointRefArray mWaypoints;
 
-      bool mKDTreeDirty;
+      /**
+       * Named waypoints by name.  Renaming a waypoint bumps NamedWaypoint::GetNameGeneration(),
+       * and the next lookup by name rebuilds the index.
+       */
+      typedef std::map<std::string, WaypointArray> NameIndex;
+      NameIndex mNameIndex;
+      unsigned mNameGeneration;
+
+      typedef std::map<dtCore::RefPtr<const dtCore::ObjectType>, WaypointArray, dtCore::ObjectType::RefPtrComp> TypeIndex;
+      TypeIndex mTypeIndex;
+
+      unsigned mKDTreeEdits;
+      float mRebalanceThreshold;
       WaypointKDTree* mKDTree;
 
       std::string mLastFileLoaded;
@@ -0,0 +1,159 @@
+/*
+ * Delta3D Open Source Game and Simulation Engine
+ * Copyright (C) 2014, Caper Holdings, LLC
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef DELTA_PATHREQUESTQUEUE_H
+#define DELTA_PATHREQUESTQUEUE_H
+
+#include <dtAI/export.h>
+#include <dtAI/pathfinding.h>
+#include <dtAI/primitives.h>
+#include <dtAI/waypointgraph.h>
+#include <dtCore/refptr.h>
+#include <dtUtil/functor.h>
+
+#include <osg/Referenced>
+
+#include <deque>
+#include <utility>
+#include <vector>
+
+namespace dtAI
+{
+   class AbstractPathCache;
+
+   /**
+    * The handle to one path search queued on a PathRequestQueue.  Poll IsComplete, or pass a callback
+    * when making the request.
+    */
+   class DT_AI_EXPORT PathRequest : public osg::Referenced
+   {
+   public:
+      enum Status
+      {
+         PENDING,
+         COMPLETE,
+         CANCELLED
+      };
+
+      typedef dtUtil::Functor<void, TYPELIST_1(const PathRequest&)> CompleteCallback;
+
+      PathRequest(WaypointID from, WaypointID to, bool hierarchical, CompleteCallback callback);
+
+      WaypointID GetFrom() const { return mFrom; }
+      WaypointID GetTo() const { return mTo; }
+      bool GetHierarchical() const { return mHierarchical; }
+
+      Status GetStatus() const { return mStatus; }
+      bool IsComplete() const { return mStatus == COMPLETE; }
+
+      /// The result of the search.  Only valid once the request is complete.
+      PathFindResult GetResult() const { return mResult; }
+
+      /// The path found, from the start to the goal.  Only valid once the request is complete.
+      const WaypointGraph::ConstWaypointArray& GetPath() const { return mPath; }
+
+      /// Drops the request if it hasn't been searched yet.  The callback won't be called.
+      void Cancel();
+
+   protected:
+      virtual ~PathRequest();
+
+   private:
+      friend class PathRequestQueue;
+
+      WaypointID mFrom;
+      WaypointID mTo;
+      bool mHierarchical;
+      CompleteCallback mCallback;
+      Status mStatus;
+      PathFindResult mResult;
+      WaypointGraph::ConstWaypointArray mPath;
+   };
+
+   /**
+    * Runs path searches for many agents a few at a time, so a crowd repathing on the same tick doesn't
+    * stall the frame.
+    *
+    * Requests are queued on the calling thread.  Each Update runs at most the configured number of searches.
+    * If the dtUtil::ThreadPool is initialized and there are enough searches, they run in parallel, each
+    * with its own A* instance, and the calling thread runs any a worker hasn't started.  Update returns once
+    * they are done, so the graph must not be changed during an Update, but can be changed between them.
+    * Only the queue's own searches are run and waited on; other IMMEDIATE tasks in the pool are left alone.
+    * Requests for the same start and goal in one Update are only searched once.  Callbacks are called from
+    * Update on the calling thread.
+    *
+    * Hierarchical searches share an AbstractPathCache, so paths between the same WaypointCollections are
+    * only searched for the first agent.
+    */
+   class DT_AI_EXPORT PathRequestQueue : public osg::Referenced
+   {
+   public:
+      /// The number of searches run by each update by default.
+      static const unsigned DEFAULT_MAX_SEARCHES_PER_UPDATE = 32U;
+
+      typedef std::vector<std::pair<WaypointID, WaypointID> > WaypointIDPairArray;
+      typedef std::vector<dtCore::RefPtr<PathRequest> > PathRequestArray;
+
+      /**
+       * @param graph the graph to search, which must outlive the queue.
+       * @param cache the cache hierarchical searches share.  NULL to not cache.
+       */
+      PathRequestQueue(WaypointGraph& graph, AbstractPathCache* cache);
+
+      /// Queues a search and returns the handle to it.
+      dtCore::RefPtr<PathRequest> RequestPath(WaypointID from, WaypointID to, bool hierarchical = true,
+               PathRequest::CompleteCallback callback = PathRequest::CompleteCallback());
+
+      /// Queues a search for each start and goal pair, and adds the handles to requestsOut in the same order.
+      void RequestPaths(const WaypointIDPairArray& fromTo, PathRequestArray& requestsOut, bool hierarchical = true,
+               PathRequest::CompleteCallback callback = PathRequest::CompleteCallback());
+
+      /**
+       * Runs the next searches, up to the limit, and completes their requests.
+       * @return the number of requests completed.
+       */
+      unsigned Update();
+
+      /// Runs searches until nothing is queued, ignoring the limit.
+      void Flush();
+
+      /// Sets the most searches each update runs.  0 means there is no limit.
+      void SetMaxSearchesPerUpdate(unsigned maxSearches);
+      unsigned GetMaxSearchesPerUpdate() const;
+
+      /// @return the number of requests waiting, including cancelled ones that haven't been dropped yet.
+      size_t GetNumPending() const;
+
+      /// Cancels all the waiting requests.
+      void Clear();
+
+   protected:
+      virtual ~PathRequestQueue();
+
+   private:
+      unsigned RunSearches(unsigned maxSearches);
+
+      WaypointGraph& mGraph;
+      dtCore::RefPtr<AbstractPathCache> mCache;
+      std::deque<dtCore::RefPtr<PathRequest> > mPending;
+      unsigned mMaxSearchesPerUpdate;
+   };
+}
+
+#endif // DELTA_PATHREQUESTQUEUE_H
@@ -230,6 +230,18 @@ namespace dtAI
       // clears all memory, does a lot of deleting!
       void Clear();
 
+      /**
+       * The revision changes whenever waypoints, edges or search levels are changed through this class,
+       * so anything cached from the graph, such as the paths in AbstractPathCache, can tell when it is stale.
+       */
+      unsigned GetRevision() const;
+
+      /**
+       * Changes the revision.  Call this after changing a NavMesh or a SearchLevel directly,
+       * or after moving a waypoint without re-inserting it.
+       */
+      void MarkChanged();
+
       /**
        * These are here just for debugging purposes
        */
@@ -28,6 +28,10 @@
 #include <dtAI/waypointgraph.h>
 #include <dtAI/waypointcollection.h>
 
+#include <OpenThreads/Mutex>
+
+#include <map>
+
 namespace dtAI
 {
    
@@ -88,6 +92,45 @@ namespace dtAI
 
    typedef AStar<WaypointGraphNode, WaypointCostFunc, std::list<const WaypointInterface*>, AStarTimer > WaypointGraphAStarBase;
 
+   /**
+    * Holds the paths found between WaypointCollections by hierarchical searches, so agents heading the same
+    * way only search the concrete waypoints.  A path between two collections only depends on the collections,
+    * since the search above them is constrained by their parents.
+    *
+    * The cache empties itself when the revision of the graph changes, so it is never stale.
+    * It can be shared by searches running on several threads.
+    */
+   class DT_AI_EXPORT AbstractPathCache : public osg::Referenced
+   {
+   public:
+      AbstractPathCache();
+
+      /// @return true and fills the path if one from the collection "from" to "to" is cached.
+      bool Find(const WaypointGraph& graph, WaypointID from, WaypointID to, WaypointGraph::ConstWaypointArray& path);
+
+      void Store(const WaypointGraph& graph, WaypointID from, WaypointID to, const WaypointGraph::ConstWaypointArray& path);
+
+      void Clear();
+
+      size_t GetNumPaths() const;
+      unsigned GetNumHits() const;
+      unsigned GetNumMisses() const;
+
+   protected:
+      virtual ~AbstractPathCache();
+
+   private:
+      /// Empties the cache if the graph changed.  The mutex must be held.
+      void CheckRevision(const WaypointGraph& graph);
+
+      typedef std::map<std::pair<WaypointID, WaypointID>, WaypointGraph::ConstWaypointArray> PathMap;
+      PathMap mPaths;
+      unsigned mRevision;
+      unsigned mHits;
+      unsigned mMisses;
+      mutable OpenThreads::Mutex mMutex;
+   };
+
 
    class DT_AI_EXPORT WaypointGraphAStar: public WaypointGraphAStarBase
    {
@@ -104,6 +147,10 @@ namespace dtAI
       //const WaypointInterface* FindNext(WaypointID from, WaypointID to);
 
       WaypointGraphNode* CreateNode(WaypointGraphNode* pParent, const WaypointInterface* pWaypoint, float pGn, float pHn);
+
+      /// Sets the cache the paths between collections are kept in by HierarchicalFindPath.  NULL turns caching off.
+      void SetPathCache(AbstractPathCache* cache);
+      AbstractPathCache* GetPathCache();
    
    private: 
       typedef std::vector<WaypointID> WaypointIDArray;
@@ -122,6 +169,7 @@ namespace dtAI
       bool mUseConstrainedSearch;
       WaypointGraph& mWPGraph;
       dtCore::RefPtr<NavMesh> mSearchSpace;
+      dtCore::RefPtr<AbstractPathCache> mPathCache;
    };
 
 } // namespace dtAI
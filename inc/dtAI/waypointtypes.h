@@ -71,6 +71,12 @@ namespace dtAI
       const std::string& GetName() const;
       std::string GetNameCopy() const;
 
+      /**
+       * @return a count that goes up every time any named waypoint is renamed, so an index
+       *         by name can tell when it has to be rebuilt.
+       */
+      static unsigned GetNameGeneration();
+
       /*virtual*/ std::string ToString() const;
 
       /*virtual*/ const osg::Vec3& GetPosition() const;
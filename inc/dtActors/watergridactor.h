@@ -137,6 +137,10 @@ namespace dtActors
 
       //////////////////////////////////////////////
       static const int MAX_WAVES = 32;
+      /// The number of the current waves the height queries add up.
+      static const int MAX_HEIGHT_QUERY_WAVES = 16;
+      /// The samples over one period in the wave shape tables of the batched height queries.  A power of 2.
+      static const int WAVE_SHAPE_TABLE_SIZE = 1024;
       static const int MAX_TEXTURE_WAVES;
       static const dtUtil::RefString UNIFORM_ELAPSED_TIME;
       static const dtUtil::RefString UNIFORM_MAX_COMPUTED_DISTANCE;
@@ -198,6 +202,31 @@ namespace dtActors
       virtual bool GetHeightAndNormalAtPoint(const osg::Vec3& detectionPoint,
          float& outHeight, osg::Vec3& outNormal) const;
 
+      /**
+      * Gets the height and normal at many points at once, such as the hull points of every
+      * boat in a physics step.  Everything that only depends on the waves and the time is
+      * worked out once a frame, and the points are evaluated a block at a time with each wave
+      * applied across the whole block.  Instead of calling pow and sin per point, the shape
+      * of each wave is interpolated from a table built when its exponent changes.
+      * The results match GetHeightAndNormalAtPoint to within a millimeter.
+      * @param points The points to sample.
+      * @param numPoints The number of points.
+      * @param outHeights Array of numPoints heights to fill.
+      * @param outNormals Array of numPoints normals to fill, or NULL if they aren't needed.
+      */
+      void GetHeightsAndNormalsAtPoints(const osg::Vec3* points, unsigned numPoints,
+         float* outHeights, osg::Vec3* outNormals) const;
+
+      /// Same as above, but resizes the output vectors to match the points.
+      void GetHeightsAndNormalsAtPoints(const std::vector<osg::Vec3>& points,
+         std::vector<float>& outHeights, std::vector<osg::Vec3>& outNormals) const;
+
+      /**
+      * Rebuilds the current wave set without a camera.  This is called every tick
+      * when UseQueryReferencePosition is on, and by the camera callback otherwise.
+      */
+      void DetermineCurrentWaveSet();
+
 
       void ClearWaves();
       void AddRandomizedWaves(float meanWaveLength, float meanAmplitude, float minPeriod, float maxPeriod, unsigned numWaves);
@@ -222,6 +251,14 @@ namespace dtActors
       DT_DECLARE_ACCESSOR_INLINE(float, TexWaveSpreadScalar)
       DT_DECLARE_ACCESSOR_INLINE(float, TexWaveSteepness)
 
+      /**
+      * When true, height queries scale the wave detail by the distance from QueryReferencePosition
+      * rather than from the camera, and the wave set is rebuilt every tick.  Turn it on for a
+      * server, which has no camera, so the same query always gets the same answer.
+      */
+      DT_DECLARE_ACCESSOR_INLINE_WITH_DEFAULT(bool, UseQueryReferencePosition, false)
+      DT_DECLARE_ACCESSOR_INLINE(osg::Vec3, QueryReferencePosition)
+
    protected:
 
       ~WaterGridActor();
@@ -257,6 +294,12 @@ namespace dtActors
 
       void UpdateViewMatrix(dtCore::Camera& pCamera);
 
+      /// Copies out the parts of the current waves the height queries use.
+      void UpdateHeightQueryWaves();
+
+      /// The position the height queries measure the distance for wave detail from.
+      const osg::Vec3& GetHeightQueryCenter() const;
+
       friend class WaterGridActorProxy;
 
    private:
@@ -285,6 +328,28 @@ namespace dtActors
       // Order is: waveLength, speed, amp, freq, steepness, UNUSED, dirX, dirY
       float mProcessedWaveData[MAX_WAVES][8];
 
+      /**
+      * The terms of the height queries that are the same for every point, updated whenever
+      * the waves or the time change.  Waves with no amplitude are left out.
+      */
+      struct HeightQueryWaves
+      {
+         int mNumWaves;
+         float mWaveLength[MAX_HEIGHT_QUERY_WAVES];
+         float mSpeedTime[MAX_HEIGHT_QUERY_WAVES]; // speed * elapsed time
+         float mFreq[MAX_HEIGHT_QUERY_WAVES];
+         float mAmp[MAX_HEIGHT_QUERY_WAVES];
+         float mDirX[MAX_HEIGHT_QUERY_WAVES];
+         float mDirY[MAX_HEIGHT_QUERY_WAVES];
+         float mExponent[MAX_HEIGHT_QUERY_WAVES];
+         float mDetailScalar;
+         /// pow((sin(phase) + 1) / 2, exponent) over one period, with the first sample repeated at the end.
+         std::vector<float> mShapeTable[MAX_HEIGHT_QUERY_WAVES];
+         /// The exponent each shape table was built for.
+         float mShapeTableExponent[MAX_HEIGHT_QUERY_WAVES];
+      };
+      HeightQueryWaves mHeightQueryWaves;
+
 
       osg::ref_ptr<osg::Camera>   mWaveCamera;
       osg::ref_ptr<osg::Camera>   mWaveCameraScreen;
@@ -24,14 +24,18 @@
 
 #include <string>
 #include <map>
+#include <vector>
 
 #include <dtAnim/export.h>
 
 #include <dtCore/refptr.h>
+#include <dtCore/observerptr.h>
 
 #include <dtGame/datacentricgmcomponent.h>
 
 #include <dtAnim/animationhelper.h>
+#include <dtAnim/posecache.h>
+#include <dtUtil/getsetmacros.h>
 #include <dtUtil/threadpool.h>
 
 
@@ -46,6 +50,8 @@ namespace dtGame
 namespace dtAnim
 {
 class AnimationHelper;
+class AnimationUpdateTask;
+class AnimationVisibilityCallback;
 
 class DT_ANIM_EXPORT AnimationComponent: public dtGame::DataCentricGMComponent<AnimationHelper>
 {
@@ -110,11 +116,46 @@ public:
     */
    virtual void OnAnimationEvent(const std::string& eventName);
 
+   /**
+    * Enables the animation level of detail schedule.  Visible characters near the eye point actor are
+    * animated every frame and those further away every second or fourth frame, with the skipped time
+    * added to their next update.  Characters that were not drawn last frame only advance their
+    * animation clocks every fourth frame.  It is off by default.
+    */
+   DT_DECLARE_ACCESSOR(bool, AnimationLODEnabled);
+
+   /// Visible characters closer than this to the eye point actor are animated every frame.
+   DT_DECLARE_ACCESSOR(float, FullRateAnimationDistance);
+
+   /**
+    * Visible characters closer than this, but further than the full rate distance, are animated every
+    * second frame.  Characters further away are animated every fourth frame.
+    */
+   DT_DECLARE_ACCESSOR(float, HalfRateAnimationDistance);
+
+   /// @return the number of frames between updates of a visible character at the given distance from the eye point.
+   unsigned GetAnimationUpdateInterval(float distance) const;
+
+   /**
+    * Shares skeleton poses between Cal3D characters of the same model that play the same animations
+    * at the same quantized time, through GetPoseCache().  Background crowds started in step only
+    * blend their animations once per frame.  It is off by default.
+    */
+   DT_DECLARE_ACCESSOR(bool, PoseSharingEnabled);
+
+   /// The cache the characters share poses through when PoseSharingEnabled is set.
+   PoseCache& GetPoseCache() { return *mPoseCache; }
+
 protected:
    virtual ~AnimationComponent();
 
    virtual void TickLocal(float dt);
-   void BuildThreadWorkerTasks();
+
+   /**
+    * Updates the characters that are due this frame.  Their updates are spread over the thread pool
+    * by their measured cost, then their attachments are updated on this thread.
+    */
+   void UpdateCharacters(float dt);
    // creates batches of isector queries
    void GroundClamp(BaseClass::ActorCompMapping&);
    void ExecuteCommands(BaseClass::ActorCompMapping&);
@@ -123,8 +164,52 @@ private:
    AnimationComponent(const AnimationComponent&);               //not implemented
    AnimationComponent& operator=(const AnimationComponent&);    //not implemented
 
+   /// The scheduling state of a registered character.
+   struct ScheduledCharacter
+   {
+      ScheduledCharacter();
+
+      dtCore::RefPtr<AnimationHelper> mHelper;
+      dtCore::ObserverPtr<dtCore::Transformable> mDrawable;
+      dtCore::RefPtr<AnimationVisibilityCallback> mVisibility;
+      dtCore::ObserverPtr<osg::Node> mWatchedNode;
+      /// Offsets the frames a character is updated on so the work of a tier is spread evenly.
+      unsigned mPhase;
+      /// Time passed since the character was last updated.
+      float mAccumulatedDT;
+      /// Smoothed time in milliseconds of a full update and of a clock-only update.
+      float mCost;
+      float mClockCost;
+      bool mFullUpdate;
+      /// The model wrapper whose animator was last given the pose cache, or NULL.
+      dtCore::ObserverPtr<BaseModelWrapper> mPoseCacheWrapper;
+   };
+
+   typedef std::map<dtCore::UniqueId, ScheduledCharacter> ScheduleMap;
+
+   friend class AnimationUpdateTask;
+
+   /// Gives the time since the character was last updated to its helper and measures how long it took.
+   static void RunScheduledUpdate(ScheduledCharacter& character);
+   static float GetEstimatedCost(const ScheduledCharacter* character);
+   static bool CostlierThan(const ScheduledCharacter* a, const ScheduledCharacter* b);
+
+   /// Moves the character's visibility callback to its current node.
+   void WatchVisibility(ScheduledCharacter& character);
+   void RemoveFromSchedule(ScheduledCharacter& character);
+   /// Gives the character's animator the pose cache, or takes it away, to match PoseSharingEnabled.
+   void AssignPoseCache(ScheduledCharacter& character, bool share);
+   void ClearSchedule();
+
    dtCore::RefPtr<dtGame::BaseGroundClamper> mGroundClamper;
 
+   ScheduleMap mSchedule;
+   dtCore::RefPtr<PoseCache> mPoseCache;
+   std::vector<ScheduledCharacter*> mDueCharacters;
+   std::vector<dtCore::RefPtr<AnimationUpdateTask> > mUpdateTasks;
+   unsigned mFrameCount;
+   unsigned mNextPhase;
+
    // A field used exclusively for the event sending code.
    // This tracks the current actor that whose helper's commands
    // are currently being executed. This information is important
@@ -123,6 +123,23 @@ namespace dtAnim
        */
       void Update(float dt) override;
 
+      /**
+       * Advances the animation sequences and gathers their commands without posing the skeleton.
+       * The time is handed to the animator on the next Update, so a character that only advanced
+       * its clock, such as one that is off screen, catches up when it is next updated.
+       */
+      virtual void AdvanceClock(float dt);
+
+      /// Moves the attached objects to follow the skeleton.  Update calls this unless it is deferred.
+      void UpdateAttachments();
+
+      /**
+       * If true, Update does not move the attachments and the owner must call UpdateAttachments.
+       * The AnimationComponent sets this so the attachments, which change the scene, are updated
+       * on the main thread after the characters are animated in parallel.
+       */
+      DT_DECLARE_ACCESSOR(bool, DeferAttachmentUpdate);
+
       DT_DECLARE_ACCESSOR(dtCore::ResourceDescriptor, SkeletalMesh);
 
       DT_DECLARE_ACCESSOR(bool, LoadModelAsynchronously);
@@ -483,6 +500,8 @@ namespace dtAnim
       bool mGroundClamp;
       bool mEnableCommands;
       double mLastUpdateTime;
+      /// Time the sequences advanced that the animator has not caught up with.
+      float mPendingAnimatorDT;
       std::string mAsyncFile;
       dtCore::RefPtr<osg::Group> mParent;
       dtCore::RefPtr<SequenceMixer> mSequenceMixer;
@@ -43,6 +43,7 @@ namespace osg
 namespace dtAnim
 {
    class Animatable;
+   class CharacterBundle;
 
    // we will hold a vector of animatables for each CalCoreModel
    typedef std::vector<dtCore::RefPtr<dtAnim::Animatable> > AnimatableArray;
@@ -112,6 +113,13 @@ namespace dtAnim
       DT_DECLARE_ACCESSOR(std::string, ShaderGroupName);
       DT_DECLARE_ACCESSOR(std::string, ShaderName);
       DT_DECLARE_ACCESSOR(std::string, PoseMeshFilename);
+
+      /**
+       * Sets the bundle to read the pose mesh from instead of the pose mesh file.  The model keeps
+       * the bundle only when it packs a pose mesh, since pose meshes are built after loading.
+       */
+      void SetPoseMeshBundle(CharacterBundle* bundle);
+      CharacterBundle* GetPoseMeshBundle() const;
       /// Sets the maximum number of bones the shader supports
       DT_DECLARE_ACCESSOR(unsigned, ShaderMaxBones);
 
@@ -319,6 +327,8 @@ namespace dtAnim
 
       LODOptions mLODOptions;
 
+      dtCore::RefPtr<CharacterBundle> mPoseMeshBundle;
+
       // File Mapping
       class ObjectNameAndFileType : public osg::Referenced
       {
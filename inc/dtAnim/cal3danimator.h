@@ -29,6 +29,7 @@
 #include <dtAnim/animationupdaterinterface.h>
 #include <dtAnim/cal3dmodelwrapper.h>
 #include <dtAnim/ical3ddriver.h>
+#include <dtAnim/posecache.h>
 #include <dtCore/observerptr.h>
 #include <osg/Referenced>
 
@@ -89,9 +90,24 @@ namespace dtAnim
       /// Update just the Cal3D's animation using the mixer
       void UpdateAnimation(float deltaTime);
 
-      /// Update just Cal3D's skeleton using the mixer
+      /// Update just Cal3D's skeleton using the mixer, or from the pose cache if one is set.
       void UpdateSkeleton(float deltaTime);
 
+      /**
+       * Shares skeleton poses with the other characters using the same cache.  When another
+       * character of the same model already evaluated the same animations at the same quantized
+       * time, the skeleton is copied from it instead of being blended.  NULL turns it off,
+       * which is the default.
+       */
+      void SetPoseCache(PoseCache* poseCache);
+      PoseCache* GetPoseCache() const { return mPoseCache.get(); }
+
+      /**
+       * @return the shared pose the skeleton was set to in the last update, or NULL if the
+       *         skeleton was evaluated without the cache.
+       */
+      const PoseCache::Pose* GetCurrentPose() const { return mCurrentPose.get(); }
+
       /// Update the CalModel's morph target mixer
       void UpdateMorphTargetMixer(float deltaTime);
 
@@ -151,6 +167,11 @@ namespace dtAnim
       dtCore::RefPtr<ICal3DDriver> mSpringDriver;
       dtCore::RefPtr<ICal3DDriver> mPhysiqueDriver;
 
+      dtCore::RefPtr<PoseCache> mPoseCache;
+      // Reused every update so building the key doesn't allocate.
+      PoseCache::Key mPoseKey;
+      dtCore::RefPtr<const PoseCache::Pose> mCurrentPose;
+
       // Class variables
       static bool sAllowBindPose;
    };
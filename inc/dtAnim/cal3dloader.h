@@ -33,6 +33,7 @@
 #include <osg/Referenced>
 #include <osg/ref_ptr>
 #include <osg/Texture2D>
+#include <OpenThreads/Mutex>
 
 #include <string>
 #include <map>
@@ -116,12 +117,20 @@ namespace dtAnim
          float* vboVertexAttr, Cal3DModelData* modelData, CalIndex*& indexArray);
 
       unsigned int GetMaxBoneID(CalCoreMesh& mesh);
+
+      /**
+       * @return the contents of the file if the character came from a bundle that packs it, otherwise NULL.
+       *         The contents are read in place, so they belong to the bundle.
+       */
+      static void* FindBundledFile(const CharacterFileHandler& handler, CharacterBundle::EntryType type, const std::string& name);
       
       typedef std::map<std::string, osg::ref_ptr<osg::Texture2D> > TextureMap;
       typedef std::map<std::string, cal3d::RefPtr<CalCoreAnimation> > AnimationMap;
 
       TextureMap mTextureCache;
       AnimationMap mAnimationCache;
+      /// Guards both caches, since characters may load on several threads at once.
+      OpenThreads::Mutex mCacheMutex;
    };
 
 } // namespace dtAnim
@@ -23,7 +23,9 @@
 
 #include <dtAnim/export.h>
 #include <dtAnim/basemodeldata.h>
+#include <dtAnim/softwareskinning.h>
 #include <dtCore/refptr.h>
+#include <OpenThreads/Mutex>
 
 DT_DISABLE_WARNING_ALL_START
 #include <cal3d/global.h>
@@ -31,9 +33,11 @@ DT_DISABLE_WARNING_END
 
 #include <dtUtil/hotspotdefinition.h>
 
+#include <map>
 #include <vector>
 
 class CalCoreModel;
+class CalCoreSubmesh;
 class CalHardwareModel;
 
 namespace dtAnim
@@ -72,6 +76,12 @@ namespace dtAnim
       CalHardwareModel* GetCalHardwareModel();
       CalHardwareModel* GetOrCreateCalHardwareModel();
 
+      /**
+       * @return the rest pose and influences of a core submesh for SoftwareSkinning.  It is
+       *         extracted the first time it is asked for and shared by every character of the model.
+       */
+      const SoftwareSkinning::SkinnedMesh& GetSkinnedMesh(CalCoreSubmesh& coreSubmesh);
+
       virtual int LoadResource(dtAnim::ModelResourceType resourceType,
          const std::string& file, const std::string& objectName);
 
@@ -110,6 +120,11 @@ namespace dtAnim
       CalCoreModel* mCoreModel;
       CalHardwareModel* mHardwareModel;
       AttachmentArray mAttachments;
+
+      typedef std::map<const CalCoreSubmesh*, SoftwareSkinning::SkinnedMesh> SkinnedMeshMap;
+      // Drawables on different threads can ask for the same submesh.
+      OpenThreads::Mutex mSkinnedMeshMutex;
+      SkinnedMeshMap mSkinnedMeshes;
    };
 
 } // namespace dtAnim
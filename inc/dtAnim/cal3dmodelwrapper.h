@@ -221,6 +221,12 @@ namespace dtAnim
       dtCore::RefPtr<dtAnim::Cal3dSubmesh> GetSelectedSubmesh();
       dtCore::RefPtr<dtAnim::Cal3dMaterial> GetSelectedSubmeshMaterial();
 
+      /**
+       * @return the bone palette for skinning this character's submeshes on the CPU.  A character
+       *         in a shared pose uses the pose's palette, otherwise it is built from the skeleton.
+       */
+      const SoftwareSkinning::BonePalette& GetSkinningPalette();
+
       /************************************************************************/
 
       /// Get a bounding box the encompasses the character in its default pose
@@ -264,6 +270,9 @@ namespace dtAnim
       // Manages animation controllers.
       dtCore::RefPtr<dtAnim::Cal3DAnimator> mAnimator;
 
+      // Filled by GetSkinningPalette when the pose isn't shared.
+      SoftwareSkinning::BonePalette mSkinningPalette;
+
       // Drawable associated with this model.
       dtCore::RefPtr<osg::Node> mDrawable;
 
@@ -254,6 +254,15 @@ namespace dtAnim
       int GetNormals(float* outData, int stride = 0);
       int GetTextureCoords(int textureUnit, float* outData, int stride = 0);
 
+      /**
+       * Gets the skinned vertices and normals in one pass.  Submeshes without springs or morph
+       * targets are skinned with SoftwareSkinning, the rest by Cal3D's physique.
+       * @param outNormals May be NULL.
+       * @param stride The bytes from one vertex to the next in both arrays, or 0 if they are packed.
+       * @return the number of vertices.
+       */
+      int GetVerticesAndNormals(float* outVertices, float* outNormals, int stride = 0);
+
       void SetDrawable(dtAnim::SubmeshDrawable* drawable);
       dtAnim::SubmeshDrawable* GetDrawable();
       const dtAnim::SubmeshDrawable* GetDrawable() const;
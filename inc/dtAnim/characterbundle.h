@@ -0,0 +1,121 @@
+/* -*-c++-*-
+ * Delta3D Open Source Game and Simulation Engine
+ * Copyright (C) 2007, Alion Science and Technology
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef DELTA_CHARACTER_BUNDLE
+#define DELTA_CHARACTER_BUNDLE
+
+#include <dtAnim/export.h>
+#include <osg/Referenced>
+
+#include <string>
+#include <vector>
+
+namespace dtAnim
+{
+   /**
+    * A character file and every file it references packed into one file, so a character
+    * loads with a single read instead of opening each skeleton, mesh, animation and material.
+    *
+    * The layout, all little endian, is
+    * - header: the magic number "DTCB", the version, the entry count and the table offset
+    * - data: the bytes of each file, starting on a 16 byte boundary and followed by a NUL
+    * - table: the type, name, offset and size of each entry
+    *
+    * Offsets are from the start of the file and nothing is fixed up after reading, so the
+    * data is used where it lies.  The trailing NUL lets Cal3D parse XML files in place.
+    *
+    * Files are packed as they are, so XML Cal3D files stay XML.  Convert them with the Cal3D
+    * tools first for the fastest loads.
+    *
+    * @see ModelDatabase, which loads a bundle in place of a character file that is older than it.
+    */
+   class DT_ANIM_EXPORT CharacterBundle : public osg::Referenced
+   {
+   public:
+      /// The file extension for character bundles, without the dot.
+      static const std::string FILE_EXTENSION;
+
+      enum EntryType
+      {
+         ENTRY_CHARACTER = 0,
+         ENTRY_SKELETON,
+         ENTRY_MESH,
+         ENTRY_MORPH,
+         ENTRY_ANIMATION,
+         ENTRY_MATERIAL,
+         ENTRY_POSE_MESH
+      };
+
+      struct Entry
+      {
+         Entry() : mType(ENTRY_CHARACTER), mOffset(0U), mSize(0U) {}
+
+         EntryType mType;
+         /// The file name as the character file refers to it.
+         std::string mName;
+         unsigned mOffset;
+         unsigned mSize;
+      };
+
+      CharacterBundle();
+
+      /**
+       * Reads a bundle with one read.
+       * @return false if the file can't be read or isn't a valid bundle.
+       */
+      bool Read(const std::string& file);
+
+      /// @return the file the bundle was read from.
+      const std::string& GetFileName() const { return mFileName; }
+
+      /**
+       * @return the entry with the type and name, or NULL.  An empty name matches the first
+       *         entry of the type.
+       */
+      const Entry* FindEntry(EntryType type, const std::string& name) const;
+
+      /// @return the bytes of the entry.  They are followed by a NUL that isn't counted in its size.
+      const char* GetData(const Entry& entry) const;
+
+      unsigned GetNumEntries() const { return unsigned(mEntries.size()); }
+      const Entry& GetEntry(unsigned index) const { return mEntries[index]; }
+
+      /**
+       * Packs a character file and the files it references into a bundle.
+       * @return false if the character file can't be parsed or a file it references can't be read.
+       */
+      static bool Compile(const std::string& characterFile, const std::string& bundleFile);
+
+      /// @return the bundle name for a character file, which is the same name with the bundle extension.
+      static std::string GetBundleFileName(const std::string& characterFile);
+
+      /// @return true if the file starts with the bundle magic number.
+      static bool IsBundleFile(const std::string& file);
+
+   protected:
+      virtual ~CharacterBundle();
+
+   private:
+      std::string mFileName;
+      std::vector<char> mData;
+      std::vector<Entry> mEntries;
+   };
+}
+
+#endif // DELTA_CHARACTER_BUNDLE
@@ -25,6 +25,7 @@
 
 #include <osg/Referenced>
 #include <dtAnim/export.h>
+#include <dtAnim/characterbundle.h>
 #include <dtUtil/mswinmacros.h>
 #include <dtUtil/xercesutils.h>
 #include <dtUtil/hotspotdefinition.h>
@@ -226,6 +227,9 @@ namespace dtAnim
 
       std::string mPoseMeshFilename;
 
+      /// The bundle the character was loaded from, which holds the files named above, or NULL.
+      dtCore::RefPtr<CharacterBundle> mBundle;
+
    private:
       bool AnimatableCharacters(const XMLCh* const chars, AnimatableStruct& animatable);
       void SkinningShaderCharacters(const XMLCh* const chars);
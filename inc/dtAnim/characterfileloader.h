@@ -31,6 +31,12 @@ namespace dtAnim
       
       virtual dtCore::RefPtr<CharacterFileHandler> LoadCharacterFile(const dtCore::ResourceDescriptor& resourde);
       virtual dtCore::RefPtr<CharacterFileHandler> LoadCharacterFile(const std::string& file);
+
+      /**
+       * Loads the character file packed in a bundle.  The handler keeps the bundle so the
+       * model loader reads the other files from it too.
+       */
+      virtual dtCore::RefPtr<CharacterFileHandler> LoadCharacterFile(CharacterBundle& bundle);
    
       virtual void CreateChannelsAndSequences(dtAnim::CharacterFileHandler& handler, dtAnim::BaseModelData& modelData);
    
@@ -35,6 +35,8 @@
 #include <dtAnim/posemeshdatabase.h>
 #include <dtUtil/threadpool.h>
 #include <dtCore/resourcedescriptor.h>
+#include <OpenThreads/Block>
+#include <OpenThreads/Mutex>
 
 
 
@@ -67,6 +69,13 @@ namespace dtAnim
        */
       bool Load(const dtCore::ResourceDescriptor& resource);
 
+      /**
+       * Loads several models at once on the thread pool, with this thread helping.  Each model
+       * loads from its character bundle when there is one at least as new as its character file.
+       * @return the number of models that loaded successfully or were already loaded.
+       */
+      unsigned LoadAll(const std::vector<dtCore::ResourceDescriptor>& resources);
+
       void TruncateDatabase();
 
       bool RegisterModelData(dtAnim::BaseModelData& modelData);
@@ -100,6 +109,9 @@ namespace dtAnim
 
       bool InternalLoad(const dtCore::ResourceDescriptor& resource, dtCore::RefPtr<dtAnim::BaseModelData>& outModelData);
 
+      /// Parses the character, from its bundle if it has a current one.
+      dtCore::RefPtr<CharacterFileHandler> LoadCharacterFile(const dtCore::ResourceDescriptor& resource);
+
       static dtCore::RefPtr<ModelDatabase> mInstance;
       
       bool mHardwareMode;
@@ -115,7 +127,17 @@ namespace dtAnim
       PoseDatabaseMap mPoseMeshMap;
       
       mutable OpenThreads::Mutex mAsynchronousLoadLock;
+      /// Guards the loads in progress.  It isn't held while a model loads.
       mutable OpenThreads::Mutex mLoadingLock;
+
+      /// A model being loaded, which other requests for the same model wait on.
+      struct InProgressLoad : public osg::Referenced
+      {
+         OpenThreads::Block mDone;
+         dtCore::RefPtr<dtAnim::BaseModelData> mModelData;
+      };
+      typedef std::map<dtCore::ResourceDescriptor, dtCore::RefPtr<InProgressLoad> > InProgressLoadMap;
+      InProgressLoadMap mInProgressLoads;
       
       ModelDataArray mModelData;
       
@@ -0,0 +1,182 @@
+/* -*-c++-*-
+ * Delta3D Open Source Game and Simulation Engine
+ * Copyright (C) 2014, Caper Holdings, LLC
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef DELTA_POSECACHE_H
+#define DELTA_POSECACHE_H
+
+#include <dtAnim/export.h>
+#include <dtAnim/softwareskinning.h>
+#include <dtCore/refptr.h>
+#include <OpenThreads/Mutex>
+#include <osg/Referenced>
+
+#include <map>
+#include <vector>
+
+class CalMixer;
+class CalSkeleton;
+
+namespace dtAnim
+{
+   class Cal3DModelData;
+
+   /**
+    * Shares evaluated skeleton poses between characters of the same model that are playing the
+    * same animations at nearly the same time, such as a crowd walking in step.  The first
+    * character to need a pose evaluates its mixer and stores the result.  The others copy the
+    * bone transforms instead of blending the animation tracks, or skin straight from the stored
+    * palette.  The poses are in model space, so each character keeps its own root transform.
+    *
+    * Times are quantized to GetTimeQuantum(), so characters that share a pose can be off from
+    * their own time by up to that much.  Poses not used for more than GetMaxAgeFrames() calls
+    * to AdvanceFrame() are dropped.  All methods are thread safe.
+    */
+   class DT_ANIM_EXPORT PoseCache : public osg::Referenced
+   {
+   public:
+      static const float DEFAULT_TIME_QUANTUM;
+      static const unsigned DEFAULT_MAX_AGE_FRAMES;
+      /// Animation weights are quantized to this, so fades only share at close weights.
+      static const float WEIGHT_QUANTUM;
+
+      /// Identifies a pose: the model and each animation playing with its quantized weight and time.
+      class DT_ANIM_EXPORT Key
+      {
+      public:
+         Key();
+
+         void Clear();
+
+         bool operator<(const Key& other) const;
+         bool operator==(const Key& other) const;
+
+         /// One playing animation, with its weight and time in quantized steps.
+         struct Entry
+         {
+            const void* mAnimation;
+            /// A cycle and an action of the same animation don't make the same pose.
+            bool mAction;
+            int mWeight;
+            int mTime;
+         };
+
+      private:
+         friend class PoseCache;
+
+         const Cal3DModelData* mModelData;
+         int mMixerTime;
+         std::vector<Entry> mEntries;
+      };
+
+      /// A bone's transform relative to its parent.
+      struct BoneTransform
+      {
+         float mRotation[4];
+         float mTranslation[3];
+      };
+
+      /// An evaluated skeleton.  The bone transforms don't change once it is in the cache.
+      class DT_ANIM_EXPORT Pose : public osg::Referenced
+      {
+      public:
+         Pose() {}
+
+         const std::vector<BoneTransform>& GetBoneTransforms() const { return mBoneTransforms; }
+
+         /**
+          * The bone space palette for SoftwareSkinning.  It is built from the skeleton the first
+          * time it is asked for, so the skeleton must be in this pose, and every character that
+          * shares the pose skins from the same palette.
+          */
+         const SoftwareSkinning::BonePalette& GetPalette(CalSkeleton& skeleton) const;
+
+      protected:
+         virtual ~Pose() {}
+
+      private:
+         friend class PoseCache;
+
+         std::vector<BoneTransform> mBoneTransforms;
+         mutable OpenThreads::Mutex mPaletteMutex;
+         mutable SoftwareSkinning::BonePalette mPalette;
+      };
+
+      PoseCache();
+
+      void SetTimeQuantum(float seconds);
+      float GetTimeQuantum() const;
+
+      void SetMaxAgeFrames(unsigned frames);
+      unsigned GetMaxAgeFrames() const;
+
+      /**
+       * Fills in the key for the mixer's current state.
+       * @return false if the mixer is playing something that can't be shared.
+       */
+      bool BuildKey(const Cal3DModelData& modelData, CalMixer& mixer, Key& outKey) const;
+
+      /// @return the pose stored with the key, or NULL.
+      dtCore::RefPtr<const Pose> FindPose(const Key& key);
+
+      /**
+       * Sets the skeleton to the pose stored with the key and recalculates its absolute
+       * and bone space transforms.
+       * @return the pose, or NULL if there is no such pose, so the caller should evaluate it and call StorePose.
+       */
+      dtCore::RefPtr<const Pose> ApplyPose(const Key& key, CalSkeleton& skeleton);
+
+      /**
+       * Stores the skeleton's current pose with the key, if no other character stored it first.
+       * @return the pose in the cache, which is the same as the skeleton's either way.
+       */
+      dtCore::RefPtr<const Pose> StorePose(const Key& key, CalSkeleton& skeleton);
+
+      /// Call once a frame, before characters are updated, to drop old poses.
+      void AdvanceFrame();
+
+      void Clear();
+
+      unsigned GetNumPoses() const;
+      unsigned GetNumHits() const;
+      unsigned GetNumMisses() const;
+      void ResetStatistics();
+
+   protected:
+      virtual ~PoseCache();
+
+   private:
+      struct CacheEntry
+      {
+         dtCore::RefPtr<Pose> mPose;
+         unsigned mLastUsedFrame;
+      };
+
+      typedef std::map<Key, CacheEntry> PoseMap;
+
+      mutable OpenThreads::Mutex mMutex;
+      PoseMap mPoses;
+      float mTimeQuantum;
+      unsigned mMaxAgeFrames;
+      unsigned mFrame;
+      unsigned mNumHits;
+      unsigned mNumMisses;
+   };
+}
+
+#endif // DELTA_POSECACHE_H
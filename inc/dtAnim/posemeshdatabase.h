@@ -35,6 +35,7 @@ namespace dtAnim
 {
    class BaseModelWrapper; 
    class PoseMesh;
+   struct PoseMeshData;
 
    /// manager of the HotSpotData resources
    class DT_ANIM_EXPORT PoseMeshDatabase: public osg::Referenced
@@ -56,7 +57,12 @@ namespace dtAnim
 
       bool LoadFromFile(const std::string& file);
 
+      /// Loads the pose meshes from pose mesh xml that is already in memory, such as in a CharacterBundle.
+      bool LoadFromBuffer(const char* data, size_t length, const std::string& name);
+
    private:
+      void AddMeshes(const std::vector<PoseMeshData>& meshDataVector);
+
       PoseMeshList mMeshes;
       osg::ref_ptr<dtAnim::BaseModelWrapper> mModel;
    };
@@ -43,6 +43,15 @@ namespace dtAnim
       * @param toFill the container where all loaded data will go
       */
       bool Load(const std::string& file, MeshDataContainer& toFill);
+
+      /*
+      * Loads Pose Mesh specifications from a document in memory
+      * @param data the pose mesh xml
+      * @param length the size of the xml in bytes
+      * @param name the name of the document for error messages
+      * @param toFill the container where all loaded data will go
+      */
+      bool Load(const char* data, size_t length, const std::string& name, MeshDataContainer& toFill);
    };
 }
 
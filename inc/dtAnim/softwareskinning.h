@@ -0,0 +1,114 @@
+/* -*-c++-*-
+ * Delta3D Open Source Game and Simulation Engine
+ * Copyright (C) 2014, Caper Holdings, LLC
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef DELTA_SOFTWARESKINNING_H
+#define DELTA_SOFTWARESKINNING_H
+
+#include <dtAnim/export.h>
+#include <osg/Matrix>
+#include <vector>
+
+class CalCoreSubmesh;
+class CalSkeleton;
+
+namespace dtAnim
+{
+   /**
+    * Skins vertices on the CPU from a palette of bone matrices.  It does the same math as
+    * Cal3D's physique, so it can stand in for it on servers and for characters that are
+    * skinned in software, and it uses SSE when the build targets it.
+    *
+    * The skinned mesh is extracted once per core submesh and shared by every instance.
+    * Only the palette is per instance, or per shared pose, see PoseCache.
+    */
+   class DT_ANIM_EXPORT SoftwareSkinning
+   {
+   public:
+      /// The most bones that can move one vertex.  Any more are dropped, lightest first.
+      static const unsigned MAX_INFLUENCES = 4;
+
+      /**
+       * A bone transform in bone space.  The first three columns are the rotation and the
+       * last is the translation.  Each column has a fourth float of padding so it loads into
+       * one SIMD register.
+       */
+      struct BoneMatrix
+      {
+         float mColumns[4][4];
+      };
+
+      typedef std::vector<BoneMatrix> BonePalette;
+
+      /// The rest pose and bone influences of a submesh, MAX_INFLUENCES per vertex.
+      struct SkinnedMesh
+      {
+         /// xyz per vertex.
+         std::vector<float> mPositions;
+         std::vector<float> mNormals;
+         /// Unused influences have a weight of 0.  A vertex with no influences is not moved.
+         std::vector<unsigned short> mBoneIndices;
+         std::vector<float> mBoneWeights;
+
+         unsigned GetVertexCount() const { return unsigned(mPositions.size() / 3); }
+      };
+
+      /// @return true if SkinVertices uses SIMD instructions in this build.
+      static bool IsSimdAvailable();
+
+      /**
+       * Copies the vertices and influences of a core submesh.  Vertices with more than
+       * MAX_INFLUENCES keep the heaviest and have their weights scaled back up to 1.
+       * Morph targets and spring vertices are not included.
+       */
+      static void ExtractSubmesh(CalCoreSubmesh& coreSubmesh, SkinnedMesh& outMesh);
+
+      /// Fills the palette with the current bone space transforms of the skeleton.
+      static void BuildPalette(CalSkeleton& skeleton, BonePalette& outPalette);
+
+      /**
+       * Puts a root transform on each matrix of a palette, so skinning gives world positions.
+       * This is how instances that share a pose are placed.  in and out may be the same.
+       */
+      static void ApplyRootTransform(const osg::Matrix& root, const BoneMatrix* inPalette,
+         BoneMatrix* outPalette, unsigned numBones);
+
+      /**
+       * Skins the mesh with the palette, using SIMD if it is available.
+       * @param outPositions xyz for each vertex, each stride floats apart.
+       * @param outNormals xyz for each vertex, each stride floats apart.  May be NULL.
+       * @param stride The number of floats from one vertex to the next, at least 3.
+       * @param normalizeNormals Normalizes the skinned normals, as Cal3D does by default.
+       * @param maxVertices Skins only the first this many vertices.  A lower Cal3D level of detail
+       *                    uses only the first vertices of a submesh.
+       */
+      static void SkinVertices(const SkinnedMesh& mesh, const BoneMatrix* palette,
+         float* outPositions, float* outNormals, unsigned stride = 3, bool normalizeNormals = true,
+         unsigned maxVertices = ~0U);
+
+      /// The same as SkinVertices, but never uses SIMD.  It is the reference for the SIMD path.
+      static void SkinVerticesScalar(const SkinnedMesh& mesh, const BoneMatrix* palette,
+         float* outPositions, float* outNormals, unsigned stride = 3, bool normalizeNormals = true,
+         unsigned maxVertices = ~0U);
+
+   private:
+      SoftwareSkinning();
+   };
+}
+
+#endif // DELTA_SOFTWARESKINNING_H
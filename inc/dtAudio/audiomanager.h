@@ -49,6 +49,8 @@
 
 namespace dtAudio
 {
+   class SoundPreloadTask;
+   class WrapperOSGSoundObject;
 
    /**
     * dtAudio::AudioManager
@@ -105,6 +107,16 @@ namespace dtAudio
     * At frame time, AudioManager process all Sounds with commands in their
     * respective queues.
     *
+    * Buffers no sound uses any more stay cached, least recently used
+    * evicted first, while they fit under SetBufferCacheLimit.  Long files
+    * can be streamed by the sound instead (see Sound::SetStreaming), or
+    * read ahead of time without blocking with PreloadFileAsync.
+    *
+    * After the commands run, the playing sounds are ranked by priority times
+    * their estimated audibility at the listener.  Only the top
+    * GetMaxRealVoices() hold an OpenAL source; the rest are virtual and just
+    * advance their playback position until they rank high enough again.
+    *
     */
    class DT_AUDIO_EXPORT AudioManager : public dtCore::Base
    {
@@ -125,15 +137,47 @@ namespace dtAudio
          ALenum       format;
          ALsizei      freq;
          ALsizei      size;
+         unsigned int lastUsed;
 
          BufferData()
             : buf(0L)
             , file("")
             , loop(AL_FALSE)
             , use(0L)
+            , size(0)
+            , lastUsed(0)
+         {}
+      };
+
+      /// Memory and hit counts of the sound buffers, from GetBufferCacheStats.
+      struct BufferCacheStats
+      {
+         unsigned int mNumBuffers;       ///< buffers loaded
+         unsigned int mNumUnusedBuffers; ///< loaded buffers no sound is using
+         size_t       mBytes;            ///< sample data in all the buffers
+         size_t       mUnusedBytes;      ///< sample data in the unused buffers
+         unsigned int mNumStreams;       ///< sounds streaming their file
+         size_t       mStreamBytes;      ///< sample data held by the streams
+         unsigned int mHits;             ///< LoadFile calls answered by a loaded buffer
+         unsigned int mMisses;           ///< LoadFile calls that had to read the file
+         unsigned int mEvictions;        ///< unused buffers freed to stay under the limit
+
+         BufferCacheStats()
+            : mNumBuffers(0)
+            , mNumUnusedBuffers(0)
+            , mBytes(0)
+            , mUnusedBytes(0)
+            , mNumStreams(0)
+            , mStreamBytes(0)
+            , mHits(0)
+            , mMisses(0)
+            , mEvictions(0)
          {}
       };
 
+      /// Called when a preload finishes, with the buffer or AL_NONE if the file couldn't be loaded.
+      typedef void (*PreloadCallBack)(const std::string& file, ALint buffer, void* param);
+
    private:
       typedef dtCore::RefPtr<AudioManager>       MOB_ptr;
       typedef dtCore::RefPtr<Sound>              SOB_PTR;
@@ -152,6 +196,31 @@ namespace dtAudio
 
       typedef std::map<Sound*, SoundState> SoundObjectStateMap;
 
+      /// A playing sound competing for a real voice.
+      struct VoiceCandidate
+      {
+         Sound* mSound;
+         float  mScore;
+         bool   mReal;
+
+         /// Higher scores first, and real voices win ties so they don't trade places.
+         bool operator<(const VoiceCandidate& other) const
+         {
+            return mScore > other.mScore || (mScore == other.mScore && mReal && !other.mReal);
+         }
+      };
+
+      typedef std::vector<VoiceCandidate>        VOICE_LST;
+
+      /// A file being read by PreloadFileAsync and who to tell when it's done.
+      struct PendingPreload
+      {
+         dtCore::RefPtr<SoundPreloadTask>                 mTask;
+         std::vector<std::pair<PreloadCallBack, void*> >  mCallBacks;
+      };
+
+      typedef std::map<std::string, PendingPreload> PRELOAD_MAP;
+
    private:
       static MOB_ptr               _Mgr;
       static LOB_PTR               _Mic;
@@ -255,6 +324,32 @@ namespace dtAudio
        */
       void SetSpeedOfSound(float s);
 
+      /**
+       * Sets the most sounds that may hold an OpenAL source at once.  When more
+       * sounds are playing, the lowest ranked become virtual.  Sounds with a user
+       * defined source, streaming sounds, and paused sounds holding a source count
+       * against the limit but are never made virtual.
+       *
+       * Defaults to the number of sources the device reports, if it reports one.
+       *
+       * @param count the number of real voices, 0 for no limit.
+       */
+      void SetMaxRealVoices(unsigned int count);
+      unsigned int GetMaxRealVoices() const;
+
+      /// @return the number of playing sounds that are virtual as of the last frame.
+      unsigned int GetNumVirtualVoices() const;
+
+      /**
+       * Estimates the gain of a sound at the listener the way OpenAL would under
+       * the current distance model, without asking OpenAL.
+       *
+       * @param snd the sound to estimate
+       * @param listenerPos the world position of the listener
+       * @return the sound's gain after attenuation, clamped to its min and max gain.
+       */
+      float EstimateAudibility(const Sound& snd, const osg::Vec3& listenerPos) const;
+
       /// Returns true if initialized
       static bool IsInitialized() { return _Mgr != NULL; }
 
@@ -293,10 +388,59 @@ namespace dtAudio
       /// un-load a sound file from a buffer (if use-count is zero)
       bool UnloadFile(const std::string& file);
 
+      /**
+       * Loads a sound file into a buffer with the read and decode on the
+       * dtUtil::ThreadPool IO queue, so a long file doesn't stall the frame.
+       * The buffer is created during the pre-frame after the read finishes,
+       * and then the callback is called.  If the file is already loaded, the
+       * callback is called right away, and without a running thread pool the
+       * file is loaded right away.
+       *
+       * @param file File to be loaded into a buffer.
+       * @param cb Optional function called with the buffer.
+       * @param param Passed to the callback.
+       * @return false if the file can't be found.
+       */
+      bool PreloadFileAsync(const std::string& file, PreloadCallBack cb = NULL, void* param = NULL);
+
+      /// Returns the number of files PreloadFileAsync is still reading.
+      unsigned int GetNumPendingPreloads() const { return unsigned(mPreloads.size()); }
+
+      /**
+       * Sets how many bytes of sample data may stay loaded in buffers no
+       * sound is using.  Past the limit, the least recently used of them are
+       * unloaded, including files loaded with LoadFile but never played.
+       * The default of 0 unloads a buffer as soon as its last sound is freed.
+       * The unused buffers over the new limit are unloaded right away.
+       */
+      void SetBufferCacheLimit(size_t bytes);
+      size_t GetBufferCacheLimit() const;
+
+      /// Returns the memory held by buffers and streams, and the cache counters.
+      BufferCacheStats GetBufferCacheStats() const;
+
    private:
       /// process commands of all sounds in the sound list
       inline void PreFrame(const double deltaFrameTime);
 
+      /// find the full path of a sound file, or an empty string
+      std::string FindSoundFile(const std::string& file) const;
+
+      /// create buffers for the finished preloads and call their callbacks
+      void ProcessCompletedPreloads();
+
+      /// move decoded sound data into a new buffer; returns AL_NONE on failure
+      ALint CreateBuffer(const std::string& file, WrapperOSGSoundObject& soundData);
+
+      /// unload the least recently used unused buffers until under the cache limit
+      void TrimBufferCache();
+
+      /// rank the playing sounds and move sources from the least to the most audible
+      void UpdateVoices(const double deltaFrameTime);
+
+      /// the number of sources the device supports, or 0 if it doesn't say
+      unsigned int QueryDeviceSources() const;
+
       /// check if manager has been configured
       inline bool Configured() const;
 
@@ -373,6 +517,16 @@ namespace dtAudio
 
       SND_LST             mSoundList;
 
+      unsigned int        mMaxRealVoices;
+      unsigned int        mNumVirtualVoices;
+      ALenum              mDistanceModel;
+      VOICE_LST           mVoiceCandidates; ///kept to reuse its memory each frame
+
+      PRELOAD_MAP         mPreloads;
+      size_t              mBufferCacheLimit;
+      unsigned int        mBufferUseCount;  ///stamps BufferData::lastUsed
+      BufferCacheStats    mBufferCacheCounts; ///only the hit, miss and eviction counts
+
       //SoundObjectStateMap mSoundStateMap; ///Maintains state of each Sound object
       //                                    ///prior to a system-wide pause message
 
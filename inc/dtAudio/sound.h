@@ -31,6 +31,7 @@
 #include <dtCore/motioninterface.h>
 #include <dtCore/resourcedescriptor.h>
 #include <dtAudio/export.h>
+#include <dtAudio/soundstream.h>
 
 #ifdef __APPLE__
   #include <OpenAL/alut.h>
@@ -191,11 +192,80 @@ namespace dtAudio
       // Returns false on failure to restore source.
       bool RestoreSource();
 
+      // Releases the source and keeps tracking the playback position from the given offset.
+      void BecomeVirtual(float offset);
+
    public:
       void SetPositionFromParent();
 
       void SetDirectionFromParent();
 
+      /**
+       * Copies the position and direction from the parent with one world transform
+       * lookup, which is what the AudioManager does each frame.
+       */
+      void SetTransformFromParent();
+
+      /**
+       * Sets how important this sound is when more sounds are playing than the
+       * AudioManager has real voices for.  Sounds are ranked by priority times
+       * their estimated audibility and the lowest ranked become virtual.
+       * Defaults to 1.
+       */
+      void SetPriority(float priority);
+      float GetPriority() const;
+
+      /**
+       * @return true if the sound is playing without an OpenAL source.  Its playback
+       *         position keeps advancing so it resumes in the right place when it
+       *         gets a source back.
+       */
+      bool IsVirtual() const { return mVirtual; }
+
+      /// @return the playback position, in seconds, of a virtual sound.
+      float GetVirtualPlayTimeOffset() const { return mVirtualOffset; }
+
+      /**
+       * Releases the source of a playing sound without stopping it.  Typically
+       * called by the AudioManager.
+       */
+      void Virtualize();
+
+      /**
+       * Gives a virtual sound a source again and resumes playing at its
+       * current playback position.  Typically called by the AudioManager.
+       *
+       * @return false if a source could not be allocated; the sound stays virtual.
+       */
+      bool Devirtualize();
+
+      /**
+       * Advances the playback position of a virtual sound.  A sound that is not
+       * looping is stopped when it reaches its end.
+       *
+       * @param seconds the elapsed time
+       */
+      void AdvanceVirtual(float seconds);
+
+      /// @return true if the source was set with SetSource rather than allocated by the sound.
+      bool HasUserDefinedSource() const { return mUserDefinedSource; }
+
+      /**
+       * Sets whether the file is streamed through a SoundStream instead of
+       * loaded into one buffer.  Use it for long ambient or radio tracks.
+       * It takes effect on the next LoadFile.  Streaming sounds keep their
+       * source while playing, and SetPlayTimeOffset has no effect on them.
+       */
+      void SetStreaming(bool streaming) { mStreaming = streaming; }
+      bool IsStreaming() const { return mStreaming; }
+
+      /// Sets the stream the sound plays from.  Typically called by the AudioManager.
+      void SetStream(SoundStream* stream);
+      SoundStream* GetStream() { return mStream.get(); }
+
+      /// Feeds the stream, if the sound has one and is playing.  Called each frame by the AudioManager.
+      void UpdateStream();
+
       /**
        * Loads the specified sound file.
        *
@@ -250,6 +320,9 @@ namespace dtAudio
       ///Get the IsStopped flag
       int IsStopped() const { return GetState(STOP); }
 
+      /// @return true if Play was called and the command hasn't run yet, even if a later Stop is queued.
+      bool IsPlayPending() const { return mPlayPending; }
+
       /** Set the Sound's OpenAL buffer ID without going through the
        *  AudioManager.  The typical case is to go through the AudioManager,
        *  but this method is provided for exception cases.
@@ -629,6 +702,15 @@ namespace dtAudio
       osg::Vec3               mVelocity;      
 
       bool                    mUserDefinedSource;
+
+      float                   mPriority;
+      bool                    mPlayPending;
+      bool                    mVirtual;
+      float                   mVirtualOffset;
+      float                   mVirtualLength;
+
+      bool                          mStreaming;
+      dtCore::RefPtr<SoundStream>   mStream;
    };
 } // namespace dtAudio
 
@@ -0,0 +1,159 @@
+/* -*-c++-*-
+ * Delta3D Open Source Game and Simulation Engine
+ * Copyright (C) 2008, Alion Science and Technology, BMH Operation
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+
+#ifndef DELTA_SOUNDSTREAM
+#define DELTA_SOUNDSTREAM
+
+#include <deque>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER)
+#   include <al.h>
+#elif defined(__APPLE__)
+#   include <OpenAL/al.h>
+#else
+#   include <AL/al.h>
+#endif
+
+#include <dtAudio/export.h>
+#include <dtCore/refptr.h>
+
+#include <OpenThreads/Condition>
+#include <OpenThreads/Mutex>
+#include <osg/Referenced>
+
+namespace dtAudio
+{
+   class SoundStreamReadTask;
+
+   /**
+    * dtAudio::SoundStream
+    *
+    * Plays a long sound file through a small ring of OpenAL buffers rather
+    * than one buffer holding the whole file.  The file is read a chunk at a
+    * time on the dtUtil::ThreadPool IO queue, and each frame the buffers the
+    * source has finished with are refilled and queued again.
+    *
+    * Only uncompressed PCM wav files can be streamed.
+    *
+    * Streams are created by the AudioManager when a streaming Sound loads
+    * its file.  Everything but ReadChunks is called on the main thread.
+    *
+    * @see Sound::SetStreaming
+    */
+   class DT_AUDIO_EXPORT SoundStream : public osg::Referenced
+   {
+   public:
+      /// The number of buffers in the ring.
+      static const unsigned int NUM_BUFFERS = 4;
+
+      /// The most bytes of sample data in one buffer.
+      static const unsigned int CHUNK_BYTES = 65536;
+
+      /// Starts reading the first chunks of the file.
+      explicit SoundStream(const std::string& file);
+
+      /// Returns the file being streamed.
+      const std::string& GetFileName() const { return mFileName; }
+
+      /**
+       * Returns false once reading the file has failed, such as when it is
+       * not a PCM wav file.  Before the first read finishes this is true.
+       */
+      bool IsValid() const;
+
+      /// Sets whether reading wraps back to the start at the end of the file.
+      void SetLooping(bool loop);
+
+      /**
+       * Queues the chunks read since the last update on the free buffers,
+       * and plays the source if it ran out of data before the end.
+       *
+       * @param source the source the stream plays on
+       */
+      void Update(ALuint source);
+
+      /**
+       * Stops the source, unqueues all the buffers, and goes back to the
+       * start of the file so the next play starts over.
+       */
+      void Stop(ALuint source);
+
+      /// Returns true once the end of the file has been queued and not looped.
+      bool IsFinished() const;
+
+      /// Returns the length of the file in seconds, or 0 before the first read.
+      float GetDuration() const;
+
+      /// Returns the bytes held by the buffers and the chunks waiting for them.
+      size_t GetMemoryUsage() const;
+
+      /// Reads chunks until the ring is full.  Runs on the IO thread.
+      void ReadChunks();
+
+   protected:
+      virtual ~SoundStream();
+
+   private:
+      /// Parses the wav header and finds the sample data.  Reading thread only.
+      bool ReadHeader();
+
+      /// Reads more chunks unless a read is running or the ring is full.
+      void RequestRead();
+
+      /// Blocks until no read is running.  Use this rather than the task's WaitUntilComplete.
+      void WaitForRead();
+
+      /// Marks the read as done and wakes WaitForRead.  Call with mMutex held.
+      void FinishRead();
+
+      std::string mFileName;
+
+      // Only touched by the reading thread, or while no read is running.
+      std::ifstream   mFile;
+      bool            mHeaderRead;
+      std::streamoff  mDataStart;
+      unsigned int    mDataSize;
+      unsigned int    mReadPos;
+
+      mutable OpenThreads::Mutex      mMutex;
+      OpenThreads::Condition          mReadDone;
+      /// Written under mMutex, since GetMemoryUsage reads it from the main thread.
+      unsigned int                    mChunkBytes;
+      std::deque<std::vector<char> >  mChunks;
+      ALenum                          mFormat;
+      ALsizei                         mFrequency;
+      unsigned int                    mBytesPerSecond;
+      bool                            mLooping;
+      bool                            mReading;
+      bool                            mEndOfFile;
+      bool                            mValid;
+
+      dtCore::RefPtr<SoundStreamReadTask> mTask;
+
+      ALuint              mBuffers[NUM_BUFFERS];
+      bool                mBuffersCreated;
+      std::vector<ALuint> mFreeBuffers;
+   };
+} // namespace dtAudio
+
+#endif // DELTA_SOUNDSTREAM
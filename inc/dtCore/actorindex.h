@@ -0,0 +1,110 @@
+/* -*-c++-*-
+ * Delta3D Open Source Game and Simulation Engine
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef DELTA_ACTORINDEX
+#define DELTA_ACTORINDEX
+
+#include <dtCore/export.h>
+#include <dtCore/baseactorobject.h>
+#include <dtUtil/refstring.h>
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace dtCore
+{
+   class ActorType;
+
+   /**
+    * Secondary indices over a collection of actors so they can be found by name,
+    * actor type, or class name without visiting every actor.  The index registers
+    * itself as a name change listener on each actor it holds, so renames are picked
+    * up as they happen.  It does not hold references to the actors, the owner must
+    * keep them alive while they are indexed.
+    *
+    * The Find methods append their results sorted by actor id, so the order doesn't
+    * depend on where the actors were allocated.
+    */
+   class DT_CORE_EXPORT ActorIndex : public BaseActorObject::NameChangeListener
+   {
+   public:
+      ActorIndex();
+      virtual ~ActorIndex();
+
+      /// Adds an actor to the index.  Adding an actor that is already indexed does nothing.
+      void Add(BaseActorObject& actor);
+
+      /**
+       * Removes an actor from the index.
+       * @return true if the actor was indexed.
+       */
+      bool Remove(BaseActorObject& actor);
+
+      /// Removes all the actors.
+      void Clear();
+
+      /// @return the number of indexed actors.
+      unsigned GetSize() const;
+
+      /**
+       * Appends all actors with a name matching the given name.  The name may contain
+       * '*' and '?' wildcards, as supported by dtUtil::Match.  Only names starting with
+       * the literal text before the first wildcard are tested.
+       */
+      void FindByName(const std::string& name, ActorPtrVector& toFill) const;
+
+      /// Appends all actors whose actor type is or inherits from the given type.
+      void FindByType(const ActorType& type, ActorPtrVector& toFill) const;
+
+      /// Appends all actors of exactly the given actor type.
+      void FindByExactType(const ActorType& type, ActorPtrVector& toFill) const;
+
+      /// Appends all actors whose class is or inherits from the given class name.
+      void FindByClassName(const dtUtil::RefString& className, ActorPtrVector& toFill) const;
+
+      /// Fills the vector with each distinct actor type among the indexed actors.
+      void GetActorTypes(std::vector<const ActorType*>& toFill) const;
+
+      /// Keeps the name index current.
+      virtual void OnActorRenamed(BaseActorObject& actor, const std::string& oldName);
+
+   private:
+      typedef std::set<BaseActorObject*> ActorSet;
+
+      /// Sorted so the literal prefix of a wildcard search maps to a contiguous range.
+      typedef std::map<std::string, ActorSet> NameMap;
+
+      /// Actors grouped by their exact type.  There are far fewer types than actors,
+      /// so searches test the type hierarchy once per type instead of once per actor.
+      typedef std::map<const ActorType*, ActorSet> TypeMap;
+
+      static void Append(const ActorSet& actors, ActorPtrVector& toFill);
+      void RemoveFromNameIndex(BaseActorObject& actor, const std::string& name);
+
+      NameMap mNameIndex;
+      TypeMap mTypeIndex;
+      unsigned mSize;
+
+      // Not copyable, the actors hold a pointer to the index.
+      ActorIndex(const ActorIndex&);
+      ActorIndex& operator=(const ActorIndex&);
+   };
+}
+
+#endif
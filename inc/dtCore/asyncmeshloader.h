@@ -0,0 +1,152 @@
+/* -*-c++-*-
+ * Delta3D Open Source Game and Simulation Engine
+ * Copyright (C) 2004-2005 MOVES Institute
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+
+#ifndef DELTA_ASYNCMESHLOADER
+#define DELTA_ASYNCMESHLOADER
+
+#include <dtCore/export.h>
+#include <dtCore/base.h>
+#include <dtCore/refptr.h>
+#include <dtCore/observerptr.h>
+#include <dtUtil/readnodethreadpooltask.h>
+
+#include <OpenThreads/Mutex>
+#include <osg/Node>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace dtCore
+{
+   class Object;
+
+   /**
+    * Loads meshes for Objects on the dtUtil::ThreadPool IO queue.
+    *
+    * Requests for a file that is already loading are coalesced into the one load.  Files loaded with
+    * caching enabled are kept in a model cache that is shared by every object using the file and that
+    * is safe to use from any thread.  Finished loads are handed to their objects on the main thread
+    * during MESSAGE_PRE_FRAME, and no more of them are attached in a frame than fit in the attach budget.
+    *
+    * @see Object::SetLoadAsynchronously
+    */
+   class DT_CORE_EXPORT AsyncMeshLoader : public dtCore::Base
+   {
+      public:
+
+         static AsyncMeshLoader& GetInstance();
+
+         /**
+          * Waits for the loads in progress and deletes the instance.  Call this before shutting down
+          * the dtUtil::ThreadPool; if the pool is already gone the loads are abandoned instead.
+          * dtABC::Application and dtCore::SingletonManager::Destroy call this.
+          */
+         static void Destroy();
+
+         /**
+          * Starts loading a mesh for the object.  Any load the object already requested is canceled.
+          * If the file is in the model cache, the object receives it immediately.
+          * @param useCache true to share the loaded mesh through the model cache.
+          * @return false if the thread pool is not running, in which case the caller should load
+          *         the file itself.
+          */
+         bool RequestLoad(Object& object, const std::string& filename, bool useCache);
+
+         /// Drops the object's pending request, if it has one.
+         void CancelLoad(Object& object);
+
+         /// @return true if the object is waiting for a mesh.
+         bool IsLoading(const Object& object) const;
+
+         /// @return the number of files being loaded or waiting to be attached.
+         unsigned GetNumPendingLoads() const { return unsigned(mPendingLoads.size()); }
+
+         /**
+          * Hands finished loads to their objects until the given time has passed.  At least one
+          * object is always handled so loading makes progress.  This is called each pre frame with
+          * the attach budget, but may be called directly by applications that don't run the System.
+          */
+         void ProcessCompletedLoads(double budgetMS);
+
+         /// Sets the time in milliseconds that may be spent each frame attaching loaded meshes.
+         void SetAttachBudgetMS(double budgetMS) { mAttachBudgetMS = budgetMS; }
+         double GetAttachBudgetMS() const { return mAttachBudgetMS; }
+
+         /**
+          * @return the cached mesh for the file, or NULL.  This may be called from any thread.
+          */
+         dtCore::RefPtr<osg::Node> FindCachedModel(const std::string& filename) const;
+
+         /**
+          * Adds a mesh to the model cache, replacing any mesh cached for the file.  This may
+          * be called from any thread.
+          */
+         void AddCachedModel(const std::string& filename, osg::Node& node);
+
+         /**
+          * Removes the cached meshes that are no longer referenced outside the cache.
+          * @return the number of meshes removed.
+          */
+         unsigned ReleaseUnusedModels();
+
+         /// Empties the model cache.
+         void ClearModelCache();
+
+         void OnSystem(const dtUtil::RefString& str, double deltaSim, double deltaReal);
+
+      protected:
+
+         AsyncMeshLoader();
+         virtual ~AsyncMeshLoader();
+
+      private:
+
+         struct PendingLoad
+         {
+            PendingLoad() : mUseCache(false), mOriginalUsed(false) {}
+
+            dtCore::RefPtr<dtUtil::ReadNodeThreadPoolTask> mTask;
+            bool mUseCache;
+            /// True once the loaded node, not a copy, has been given to an object that doesn't share it.
+            bool mOriginalUsed;
+            std::vector<std::pair<dtCore::ObserverPtr<Object>, bool> > mRequesters;
+         };
+
+         typedef std::map<std::string, PendingLoad> PendingLoadMap;
+         typedef std::map<const Object*, std::string> RequestMap;
+         typedef std::map<std::string, dtCore::RefPtr<osg::Node> > ModelCache;
+
+         void DeliverToObject(Object& object, const std::string& filename, osg::Node* node);
+
+         static dtCore::RefPtr<AsyncMeshLoader> mInstance;
+
+         PendingLoadMap mPendingLoads;
+         /// The file each waiting object requested.
+         RequestMap mRequests;
+
+         ModelCache mModelCache;
+         mutable OpenThreads::Mutex mCacheMutex;
+
+         double mAttachBudgetMS;
+   };
+}
+
+#endif // DELTA_ASYNCMESHLOADER
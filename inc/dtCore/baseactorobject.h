@@ -28,6 +28,7 @@
 
 #include <string>
 #include <set>
+#include <vector>
 #include <osg/Referenced>
 #include <dtUtil/enumeration.h>
 #include <dtUtil/refstring.h>
@@ -158,6 +159,30 @@ namespace dtCore
        */
       void SetName(const std::string& name);
 
+      /**
+       * Interface for objects that need to know when an actor is renamed, such as
+       * indices that look actors up by name.
+       */
+      class DT_CORE_EXPORT NameChangeListener
+      {
+      public:
+         /**
+          * Called after the actor's name has changed.
+          * @param actor The renamed actor, GetName() already returns the new name.
+          * @param oldName The name the actor had before.
+          */
+         virtual void OnActorRenamed(BaseActorObject& actor, const std::string& oldName) = 0;
+
+      protected:
+         virtual ~NameChangeListener() {}
+      };
+
+      /// Adds a listener to be notified when the name of this actor changes.
+      void AddNameChangeListener(NameChangeListener& listener);
+
+      /// Removes a listener added with AddNameChangeListener.
+      void RemoveNameChangeListener(NameChangeListener& listener);
+
       /**
        * Retrieve the class name
        * @note consider not using this, but just use the actor type.
@@ -423,6 +448,7 @@ namespace dtCore
       ObserverPtr<BaseActorObject> mPrototype;
       dtUtil::RefString mName;
       UniqueId mId;
+      std::vector<NameChangeListener*> mNameChangeListeners;
 
 
 
@@ -30,6 +30,7 @@
 #include <osg/Quat>
 
 #include <dtCore/actorproxy.h>
+#include <dtCore/actorindex.h>
 #include <dtCore/export.h>
 #include <dtCore/gameeventmanager.h>
 #include <dtUtil/getsetmacros.h>
@@ -299,6 +300,18 @@ namespace dtCore
                           const std::string& className = std::string(""),
                           PlaceableFilter placeable = Either) const;
 
+         /**
+          * Search for proxies that fills a vector of plain pointers, so no references are taken on the
+          * results.  The map must outlive the use of the pointers.  Searches by name, type and class
+          * name use the map's actor index rather than testing every proxy.
+          * @see FindProxies
+          */
+         void FindProxies(ActorPtrVector& container,
+                          const std::string& name, const std::string& category = std::string(""),
+                          const std::string& typeName = std::string(""),
+                          const std::string& className = std::string(""),
+                          PlaceableFilter placeable = Either) const;
+
          /**
           * @return a vector of ref pointers to the all the proxies in the map.
           */
@@ -309,6 +322,11 @@ namespace dtCore
           */
          void GetAllProxies(std::vector<dtCore::RefPtr<BaseActorObject> >& container);
 
+         /**
+          * Fills a vector with plain pointers to all the proxies in the map.
+          */
+         void GetAllProxies(ActorPtrVector& container) const;
+
          /**
           * Adds a new proxy to the map.
           * @param proxy the proxy to add.
@@ -586,6 +604,8 @@ namespace dtCore
          //ProxiesByClassMap proxiesByClass;
          typedef std::map<dtCore::UniqueId, dtCore::RefPtr<BaseActorObject> > ActorMap;
          ActorMap mActorMap;
+         /// Declared after mActorMap so it is cleared while the actors are still alive.
+         ActorIndex mActorIndex;
 
          std::map<std::string, std::string> mLibraryVersionMap;
          std::vector<std::string> mLibraryOrder;
@@ -605,6 +625,9 @@ namespace dtCore
          bool MatchesSearch(const BaseActorObject& actorProxy, const std::string& category, const std::string& typemName,
                            const std::string& classmName, PlaceableFilter placeable) const;
 
+         bool MatchesTypeSearch(const ActorType& actorType, const std::string& category, const std::string& typeName,
+                           const std::string& className) const;
+
          static bool Match(char* WildCards, char* str);
          static bool Scan(char*& Wildcards, char*& str);
 
@@ -0,0 +1,197 @@
+/* -*-c++-*-
+ * Delta3D Open Source Game and Simulation Engine
+ * Copyright (C) 2005, BMH Associates, Inc.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef DELTA_MAPBINARY
+#define DELTA_MAPBINARY
+
+#include <dtCore/export.h>
+#include <dtCore/map.h>
+#include <dtCore/refptr.h>
+#include <dtUtil/log.h>
+#include <osg/Referenced>
+
+#include <iosfwd>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace dtCore
+{
+   class BaseActorObject;
+   struct MapBinaryLoadState;
+
+   /**
+    * @class MapBinaryWriter
+    * @brief Writes a map into the compact binary map format (.dtmapb).
+    *
+    * The binary format is a load-time cache of the xml map, which remains the file that is edited and
+    * versioned.  Every string in the map is stored once in a string table, actor types are stored once in
+    * a type table, and each actor's properties are written as a blob of typed values so that loading
+    * does no xml parsing and very little string conversion.
+    * @note nothing in this class is considered part of the public api.  Maps should be loaded through project.h.
+    */
+   class DT_CORE_EXPORT MapBinaryWriter : public osg::Referenced
+   {
+      public:
+         /// The file extension for binary maps, without the dot.
+         static const std::string MAP_FILE_EXTENSION;
+
+         MapBinaryWriter();
+
+         /**
+          * Sets the xml file the map was loaded from.  Its size and a hash of its contents are
+          * written with the map so the binary map is only used while the xml is unchanged, see
+          * MapBinaryReader::IsUpToDate.  Without a source file, the binary map is never
+          * considered up to date.
+          * @return false if the file can't be read.
+          */
+         bool SetSourceFile(const std::string& xmlPath);
+
+         /**
+          * Saves the map to the given file path.
+          * @throw MapSaveException if the file can't be written.
+          */
+         void Save(Map& map, const std::string& filePath);
+
+         /**
+          * Writes the map to the given stream.
+          * @throw MapSaveException if the stream fails.
+          */
+         void Save(Map& map, std::ostream& stream);
+
+      protected:
+         virtual ~MapBinaryWriter();
+
+      private:
+         dtUtil::Log* mLogger;
+         unsigned long long mSourceSize;
+         unsigned long long mSourceHash;
+
+         MapBinaryWriter(const MapBinaryWriter&);
+         MapBinaryWriter& operator=(const MapBinaryWriter&);
+   };
+
+   /**
+    * @class MapBinaryReader
+    * @brief Loads a map from the compact binary map format written by MapBinaryWriter.
+    *
+    * The file is read into memory in one pass.  If the dtUtil::ThreadPool is initialized, the per actor
+    * property blobs are decoded in parallel.  Actor creation, property assignment and insertion into the map
+    * happen on the calling thread in the same order the xml parser uses, since actors and property setters
+    * touch the scene and resources.
+    *
+    * Load does all of that at once.  To spread it out, call Decode, which creates nothing and may run on
+    * any thread, then BeginBuild, BuildActors until it returns true, and FinishBuild on the main thread.
+    * @note nothing in this class is considered part of the public api.  Maps should be loaded through project.h.
+    */
+   class DT_CORE_EXPORT MapBinaryReader : public osg::Referenced
+   {
+      public:
+         MapBinaryReader();
+
+         /**
+          * @return true if the file at the path starts with the binary map header.
+          */
+         static bool IsBinaryMapFile(const std::string& filePath);
+
+         /**
+          * Checks the binary map against the xml it was written from.  The size is compared first,
+          * then a hash of the contents, so an edit is caught even if it lands in the same second
+          * the binary map was written.
+          * @return true if the binary map is a current version and the xml is unchanged since.
+          */
+         static bool IsUpToDate(const std::string& binaryPath, const std::string& xmlPath);
+
+         /**
+          * Loads a map from the given file path.
+          * @throw MapParsingException if the file can't be read or is not a valid binary map.
+          */
+         MapPtr Load(const std::string& filePath);
+
+         /**
+          * Loads a map from the given stream.
+          * @throw MapParsingException if the stream doesn't contain a valid binary map.
+          */
+         MapPtr Load(std::istream& stream);
+
+         /**
+          * Reads the string table, the actor records and their properties from the stream.  It doesn't touch
+          * the actor factory or create anything, so it may be called from any thread.
+          * @param decodeInParallel true to decode the properties on the dtUtil::ThreadPool if it is initialized.
+          *                         That waits on the pool, so only pass true on the main thread.
+          * @throw MapParsingException if the stream doesn't contain a valid binary map.
+          */
+         void Decode(std::istream& stream, bool decodeInParallel);
+
+         /// @return true if Decode succeeded and FinishBuild hasn't been called since.
+         bool IsDecoded() const { return mLoadState != NULL; }
+
+         /// @return true if BeginBuild has been called and FinishBuild hasn't.
+         bool IsBuilding() const;
+
+         /**
+          * Creates the decoded map, loads its libraries and adds its events.
+          * @pre IsDecoded()
+          */
+         void BeginBuild();
+
+         /**
+          * Creates the actors of the decoded map in file order, with their components and properties.
+          * @param milliseconds about how long to spend before returning.  0 creates them all.
+          * @return true once every actor has been created.
+          * @pre BeginBuild was called.
+          */
+         bool BuildActors(double milliseconds);
+
+         /// @return the number of top level actors in the decoded map, and how many have been created so far.
+         size_t GetNumActors() const;
+         size_t GetNumActorsBuilt() const;
+
+         /**
+          * Links the actor properties, and sets up the groups, preset cameras and environment actor.
+          * @return the finished map.  The reader no longer holds it or the decoded records.
+          * @pre BuildActors returned true.
+          */
+         MapPtr FinishBuild();
+
+         /// @return the libraries that could not be loaded for the last map loaded.
+         const std::vector<std::string>& GetMissingLibraries() const { return mMissingLibraries; }
+
+         /// @return the actor types that could not be created for the last map loaded.
+         const std::set<std::string>& GetMissingActorTypes() const { return mMissingActorTypes; }
+
+         /// @return true if the last map loaded set a deprecated property.
+         bool HasDeprecatedProperty() const { return mHasDeprecatedProperty; }
+
+      protected:
+         virtual ~MapBinaryReader();
+
+      private:
+         dtUtil::Log* mLogger;
+         std::vector<std::string> mMissingLibraries;
+         std::set<std::string> mMissingActorTypes;
+         bool mHasDeprecatedProperty;
+         MapBinaryLoadState* mLoadState;
+
+         MapBinaryReader(const MapBinaryReader&);
+         MapBinaryReader& operator=(const MapBinaryReader&);
+   };
+}
+
+#endif // DELTA_MAPBINARY
@@ -91,6 +91,33 @@ namespace dtCore
           */
          DT_DECLARE_ACCESSOR(bool, GenerateTangents);
 
+         /**
+          * Load the mesh resource on a background thread when the object is added to the scene
+          * or the resource changes, so the frame doesn't stall on the file read.  The placeholder
+          * node, if any, is shown until the mesh arrives.  LoadFile is still synchronous.
+          * @see AsyncMeshLoader
+          */
+         DT_DECLARE_ACCESSOR(bool, LoadAsynchronously);
+
+         /**
+          * Sets a node to show while the mesh is loading asynchronously, such as a bounding box
+          * or a low detail version.  It is removed when the mesh is attached.
+          */
+         void SetPlaceholderNode(osg::Node* node);
+         osg::Node* GetPlaceholderNode();
+
+         /// @return true if the object is waiting for an asynchronous mesh load.
+         bool IsMeshLoading() const;
+
+         /**
+          * Attaches a mesh loaded by the AsyncMeshLoader and emits MeshLoaded.
+          * @param node the loaded mesh, or NULL if it failed to load.
+          */
+         void OnAsyncMeshLoaded(const std::string& filename, osg::Node* node);
+
+         /// Emitted when an asynchronous mesh load finishes.  The node is NULL if the load failed.
+         sigslot::signal2<Object*, osg::Node*> MeshLoaded;
+
          /**
           * Sets the scale on this object
           * @param xyz The scale vector
@@ -147,7 +174,15 @@ namespace dtCore
 
          void Ctor();
 
+         /// Loads the mesh resource, asynchronously if that is enabled.
+         void LoadMeshResource();
+
+         /// Replaces the current geometry with the given node, which may be NULL.
+         void AttachMesh(osg::Node* node);
+
          dtCore::RefPtr<Model> mModel;
+         dtCore::RefPtr<osg::Node> mPlaceholderNode;
+         bool mMeshLoading;
    };
 }
 
@@ -31,6 +31,7 @@
 #include <dtCore/namedparameter.h>
 #include <dtUtil/hashmap.h>
 #include <iosfwd>
+#include <vector>
 
 namespace dtCore
 {
@@ -96,6 +97,23 @@ namespace dtCore
        */
       const std::string& GetUniqueId() const;
 
+      /**
+       * Gets the dense integer id of this type.  Types with the same unique id string share
+       * an id, so comparing ids is the same as comparing unique ids.  Ids are handed out
+       * as types are created, including by libraries loaded later, and are never reused.
+       */
+      unsigned GetTypeId() const { return mTypeId; }
+
+      /// @return the number of type ids handed out so far.  Every id is less than this.
+      static unsigned GetNumTypeIds();
+
+      /**
+       * @return a count that changes whenever a type is renamed.  Renaming changes the
+       *         type id, so anything that keeps the ids of a type's parents must be rebuilt
+       *         when this changes.
+       */
+      static unsigned GetTypeIdGeneration();
+
       /**
        * Gets the parent or "super" type of this actor type.
        */
@@ -104,6 +122,8 @@ namespace dtCore
       /**
        * Based on this actor types super type hierarchy, this method determines whether
        * or not this type is a descendent or equal to the specified actor type.
+       * This is one bit test against the ids of the hierarchy, which are gathered
+       * when the type is created.
        * @return True if a descendent or equal, false otherwise.
        */
       bool InstanceOf(const ObjectType& rhs) const;
@@ -183,6 +203,12 @@ namespace dtCore
       void GenerateUniqueId();
 
    private:
+      /// @return true if this type or one of its parents has the type id.
+      bool InstanceOf(unsigned typeId) const;
+
+      /// Sets a bit for the id of this type and each parent type.
+      void BuildAncestorBits();
+
       std::string mName;
       std::string mCategory;
       std::string mDescription;
@@ -190,6 +216,13 @@ namespace dtCore
       ///UniqueId for this actor type.
       std::string mUniqueId;
 
+      ///The integer for mUniqueId.
+      unsigned mTypeId;
+
+      ///The ids of this type and its parents as a bit set, valid while mAncestorGeneration is current.
+      std::vector<unsigned> mAncestorBits;
+      unsigned mAncestorGeneration;
+
       ///Parent of this actor type.  Null indicates there is no super type to this one.
       const dtCore::RefPtr<const ObjectType> mParentType;
 
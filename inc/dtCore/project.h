@@ -54,6 +54,7 @@ namespace dtCore
    typedef dtCore::RefPtr<Map> MapPtr;
    class MapParser;
    class MapWriter;
+   class MapBinaryReader;
    class DataType;
    class ActorFactory;
    class BaseActorObject;
@@ -248,6 +249,58 @@ namespace dtCore
        */
       Map& GetMap(const std::string& name);
 
+      /**
+       * The file of a map read into memory ahead of opening it, so the disk reads can happen on another thread.
+       * A binary copy is also decoded there into property records.  Creating the actors still happens on the
+       * main thread, in GetMap or ContinueOpeningMap.
+       */
+      struct DT_CORE_EXPORT PreloadedMapFile
+      {
+         PreloadedMapFile();
+         PreloadedMapFile(const PreloadedMapFile& toCopy);
+         ~PreloadedMapFile();
+         PreloadedMapFile& operator=(const PreloadedMapFile& toCopy);
+
+         std::string mXmlPath; ///< the xml map file.
+         std::string mBinaryPath; ///< the binary copy of the map, read instead if it is up to date.
+         bool mBinary; ///< true if mData holds the binary copy.
+         bool mRead; ///< true once mData holds the whole file.
+         std::string mData;
+         /// The decoded binary copy.  mData is emptied once this is set.
+         dtCore::RefPtr<MapBinaryReader> mBinaryReader;
+      };
+
+      /**
+       * Fills in the files of a map for ReadPreloadedMap.
+       * @throws FileNotFoundException if the map does not exist.
+       * @throws ProjectInvalidContextException if the context is not set.
+       */
+      void BeginPreloadMap(const std::string& name, PreloadedMapFile& preload) const;
+
+      /**
+       * Reads the file of a map into memory, and decodes it if it is the binary copy.  This only touches the
+       * preload and the files, not the project, so unlike the rest of the project, it may be called from any thread.
+       * @return false if the file can't be read, for example because it is in an archive.
+       */
+      static bool ReadPreloadedMap(PreloadedMapFile& preload);
+
+      /**
+       * Like GetMap(const std::string&), but if the preload was read, the map is parsed from it
+       * instead of from the disk.
+       */
+      Map& GetMap(const std::string& name, const PreloadedMapFile& preload);
+
+      /**
+       * Opens a map a slice at a time.  If the preload holds a decoded binary map, each call creates its actors
+       * for about the given number of milliseconds, and the map is only added to the open maps once they all
+       * exist.  Otherwise the map is opened in one call, like GetMap.  Dropping the preload before the map is
+       * open throws the partly built map away, so that must happen on the main thread too.
+       * @param milliseconds about how long to spend creating actors.  0 opens the map in one call.
+       * @return the map once it is open, or NULL if it needs more calls.
+       * @throws the same exceptions as GetMap.
+       */
+      Map* ContinueOpeningMap(const std::string& name, PreloadedMapFile& preload, double milliseconds);
+
       /**
        * Checks to see if the named map is loaded in memory.
        * @param name the name of the map to check.
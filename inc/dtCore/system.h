@@ -27,6 +27,7 @@
 
 #include <dtCore/base.h>
 #include <dtCore/timer.h>
+#include <dtUtil/functor.h>
 
 #include <map>
 
@@ -100,6 +101,36 @@ namespace dtCore
 
       typedef unsigned int SystemStageFlags;
 
+      /**
+       * The messages a listener can subscribe to one at a time with SubscribeToStage,
+       * rather than being called for all of them on TickSignal.
+       */
+      enum TickStage
+      {
+         TICK_EVENT_TRAVERSAL,      ///< MESSAGE_EVENT_TRAVERSAL
+         TICK_POST_EVENT_TRAVERSAL, ///< MESSAGE_POST_EVENT_TRAVERSAL
+         TICK_PRE_FRAME,            ///< MESSAGE_PRE_FRAME
+         TICK_CAMERA_SYNCH,         ///< MESSAGE_CAMERA_SYNCH
+         TICK_FRAME_SYNCH,          ///< MESSAGE_FRAME_SYNCH
+         TICK_FRAME,                ///< MESSAGE_FRAME
+         TICK_POST_FRAME,           ///< MESSAGE_POST_FRAME
+         TICK_CONFIG,               ///< MESSAGE_CONFIG
+         TICK_PAUSE,                ///< MESSAGE_PAUSE
+         TICK_PAUSE_START,          ///< MESSAGE_PAUSE_START
+         TICK_PAUSE_END,            ///< MESSAGE_PAUSE_END
+         TICK_EXIT,                 ///< MESSAGE_EXIT
+         NUM_TICK_STAGES
+      };
+
+      /// Called with the delta sim time and delta real time of the stage.
+      typedef dtUtil::Functor<void, TYPELIST_2(double, double)> TickFunctor;
+
+      /// Called after a stage runs with how long it took in milliseconds.
+      typedef dtUtil::Functor<void, TYPELIST_2(TickStage, double)> StageTimingFunctor;
+
+      /// The priority at which the listeners on TickSignal are called.
+      static const int TICK_SIGNAL_PRIORITY = 0;
+
       /**
        * MESSAGE_EVENT_TRAVERSAL: This message is used by dtABC::Application to perform the OSG Event Traversal
        * Users are not reccommend to listen to this event.
@@ -168,9 +199,42 @@ namespace dtCore
 
    public:
 
-      // This signal sends the phase name, and delta sim time and delta real time.
+      /**
+       * This signal sends the phase name, and delta sim time and delta real time.
+       * Every listener is called for every stage, so prefer SubscribeToStage for new code.
+       */
       sigslot::signal3<const dtUtil::RefString&, double, double> TickSignal;
 
+      /// @return the message TickSignal sends for the given stage.
+      static const dtUtil::RefString& GetTickStageMessage(TickStage stage);
+
+      /**
+       * Calls the functor each time the given stage runs, and only then.
+       *
+       * Subscribers are called in order of priority, lowest first, and in the order they
+       * subscribed when the priorities are equal.  The listeners on TickSignal are called
+       * together at TICK_SIGNAL_PRIORITY, before the subscribers with that same priority.
+       *
+       * Subscribing or unsubscribing while the stage is running is safe.  A new subscriber
+       * is first called the next time the stage runs, and one that unsubscribes is not
+       * called again, even later in the same stage.
+       *
+       * @return an id to pass to UnsubscribeFromStage.  It is never 0.
+       */
+      unsigned SubscribeToStage(TickStage stage, const TickFunctor& func, int priority = TICK_SIGNAL_PRIORITY);
+
+      /// @return false if there is no subscription with that id.
+      bool UnsubscribeFromStage(unsigned subscriptionId);
+
+      /// @return the number of subscribers to a stage, not counting TickSignal.
+      unsigned GetNumStageSubscribers(TickStage stage) const;
+
+      /**
+       * Sets a functor called after each stage with how long it took, such as for
+       * sending the times to a profiler.  Pass an invalid functor to remove it.
+       */
+      void SetStageTimingHook(const StageTimingFunctor& hook);
+
 
       ///Perform any configuration required.  Message: "configure"
       void Config();
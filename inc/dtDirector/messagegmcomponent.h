@@ -27,17 +27,20 @@
 #include <dtDirector/actionnode.h>
 
 #include <dtCore/refptr.h>
+#include <dtCore/uniqueid.h>
 
 #include <dtGame/gamemanager.h>
 #include <dtGame/gmcomponent.h>
 
 #include <dtUtil/functor.h>
 
+#include <map>
 #include <vector>
 #include <string>
 
 namespace dtDirector
 {
+   class Director;
    class Message;
 
    class DT_DIRECTOR_EXPORT MessageGMComponent: public dtGame::GMComponent
@@ -88,13 +91,30 @@ namespace dtDirector
       /**
        * Registers a Message Callback.
        *
-       * @param[in]  msgType   The message type to register.
+       * @param[in]  msgType   The message type to register.  A name matches
+       *                       every message type with that name, including
+       *                       types created later.  A blank name registers
+       *                       for every message.
        * @param[in]  node      The node.
        * @param[in]  callback  The callback functor.
        */
       void RegisterMessage(const std::string& msgType, dtDirector::Node* node, MsgFunc callback);
       void RegisterMessage(const dtGame::MessageType& msgType, dtDirector::Node* node, MsgFunc callback);
 
+      /**
+       * Registers a Message Callback that is only invoked for messages
+       * about the given actor.  Registering the same node again with a
+       * different actor adds another route, call UnRegisterMessage first
+       * to replace it.
+       *
+       * @param[in]  msgType       The message type to register, matched as above.
+       * @param[in]  aboutActorId  The about actor id to filter on.
+       * @param[in]  node          The node.
+       * @param[in]  callback      The callback functor.
+       */
+      void RegisterMessage(const std::string& msgType, const dtCore::UniqueId& aboutActorId, dtDirector::Node* node, MsgFunc callback);
+      void RegisterMessage(const dtGame::MessageType& msgType, const dtCore::UniqueId& aboutActorId, dtDirector::Node* node, MsgFunc callback);
+
       /**
        * Un-registers a Message Callback.
        *
@@ -111,17 +131,86 @@ namespace dtDirector
        */
       void UnRegisterMessages(dtDirector::Node* node);
 
+      /**
+       * Retrieves the number of callbacks invoked for a message type since
+       * the last call to ResetCallbackCounts.  A node registered more than
+       * once for a message is only called, and counted, once.
+       *
+       * @param[in]  msgType  The message type.
+       */
+      unsigned GetCallbackCount(const dtGame::MessageType& msgType) const;
+
+      /**
+       * Retrieves the number of callbacks invoked for all message types.
+       */
+      unsigned GetTotalCallbackCount() const;
+
+      /**
+       * Clears all callback counters.
+       */
+      void ResetCallbackCounts();
+
    private:
 
+      typedef std::map<dtDirector::Node*, MsgFunc> NodeCallbackMap;
+
+      /// Callbacks grouped by the director that owns each node so
+      /// the director state is only checked once per message.
+      typedef std::map<dtDirector::Director*, NodeCallbackMap> DirectorCallbackMap;
+
+      /// The listeners for one message type, name or every message.  Those
+      /// registered for an about actor are kept apart, by actor id.
+      struct MessageListeners
+      {
+         DirectorCallbackMap mAnyActor;
+         std::map<dtCore::UniqueId, DirectorCallbackMap> mByActor;
+
+         bool IsEmpty() const { return mAnyActor.empty() && mByActor.empty(); }
+      };
+
+      typedef std::map<const dtGame::MessageType*, MessageListeners> TypeListenerMap;
+      typedef std::map<std::string, MessageListeners> NameListenerMap;
+
       struct deleteQueue
       {
          std::string msgType;
          dtDirector::Node* node;
       };
 
-      std::map<std::string, std::map<dtDirector::Node*, MsgFunc> > mRegisteredCallbacks;
+      MessageListeners* FindNameListeners(const dtGame::MessageType& msgType);
+      MessageListeners& GetNameListeners(const std::string& msgType);
+      void RemoveCallbacks(const std::string& msgType, dtDirector::Node* node);
+      void RemoveCallbacks(MessageListeners& listeners, dtDirector::Node* node);
+      void RemoveCallbacks(DirectorCallbackMap& callbacks, dtDirector::Node* node);
+      void RemoveEmptyListeners();
+      void CancelQueuedRemoval(const std::string& msgType, dtDirector::Node* node);
+
+      /// Adds the callback maps of the listeners that match the message to the list.
+      void GatherCallbacks(MessageListeners& listeners, const dtGame::Message& message,
+         std::vector<DirectorCallbackMap*>& callbacks);
+
+      /// Calls the callbacks, skipping nodes already in called if it is given.
+      unsigned Deliver(DirectorCallbackMap& callbacks, const dtGame::Message& message,
+         std::vector<dtDirector::Node*>* called);
+
+      /// Listeners registered with a MessageType.
+      TypeListenerMap mTypeListeners;
+
+      /// Listeners registered by name.  Several message types may share a name,
+      /// so these are matched by name rather than resolved to one type.
+      NameListenerMap mNameListeners;
+
+      /// The name listeners found for each message type, or NULL if there
+      /// are none, so the name is only compared once per message type.
+      /// Cleared whenever a name is added to or removed from mNameListeners.
+      std::map<const dtGame::MessageType*, MessageListeners*> mNameLookup;
+
+      /// Listeners registered under a blank name, they receive every message.
+      MessageListeners mAllListeners;
+
+      std::map<const dtGame::MessageType*, unsigned> mCallbackCounts;
 
-      bool mIsProcessingMessages;
+      int mProcessingDepth;
       std::vector<deleteQueue> mDeleteQueue;
    };
 
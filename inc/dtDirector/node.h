@@ -46,6 +46,8 @@
 
 #include <osg/Vec2>
 
+#include <map>
+
 namespace dtCore
 {
    class BaseActorObject;
@@ -411,8 +413,15 @@ namespace dtDirector
       *
       * @param[in]  valueNode  The value node that was retrieved.
       * @param[in]  prop       The property of that value node.
+      * @param[in]  oldVal     The previous value, only used if logging is enabled.
+      * @param[in]  notify     False if the value node already notified its links of the change.
+      */
+      void LogValueChanged(ValueNode* valueNode, dtCore::ActorProperty* prop, const std::string& oldVal, bool notify = true);
+
+      /**
+      * @return  True if value changes on the given value node will be logged.
       */
-      void LogValueChanged(ValueNode* valueNode, dtCore::ActorProperty* prop, const std::string& oldVal);
+      bool IsValueLoggingEnabled(ValueNode* valueNode) const;
 
       /**
        * This method is provided for ease of use.  It will retrieve the
@@ -450,22 +459,41 @@ namespace dtDirector
          dtCore::ActorProperty* prop = GetProperty(name, index, &node);
          if (prop)
          {
-            std::string val = prop->ToString();
-
-            // Special case for boolean values.
-            if (prop->GetDataType() == dtCore::DataType::BOOLEAN)
-            {
-               if (val == "true") val = "1";
-               else if (val == "false") val = "0";
-            }
-
-            result = dtUtil::ToType<T>(val);
+            result = ParsePropertyValue<T>(*prop);
 
             LogValueRetrieved(node, prop);
          }
          return result;
       }
 
+      /**
+       * Converts a property's value to the type of your choice through
+       * its string representation.
+       */
+      template<typename T>
+      static T ParsePropertyValue(dtCore::ActorProperty& prop)
+      {
+         std::string val = prop.ToString();
+
+         // Special case for boolean values.
+         if (prop.GetDataType() == dtCore::DataType::BOOLEAN)
+         {
+            if (val == "true") val = "1";
+            else if (val == "false") val = "0";
+         }
+
+         return dtUtil::ToType<T>(val);
+      }
+
+      /**
+       * The Get* and Set* accessors below read and write the native value
+       * directly when the linked property is of the matching property type,
+       * and only fall back to string conversion when the types differ.
+       * Values are set without being read first, since value node getters
+       * have side effects.  The value node setters ignore equal values, so
+       * value-changed notifications only fire on actual changes.
+       */
+
       bool GetBoolean(const std::string& name = "Value", int index = 0);
       int GetInt(const std::string& name = "Value", int index = 0);
       unsigned int GetUInt(const std::string& name = "Value", int index = 0);
@@ -726,6 +754,47 @@ namespace dtDirector
        */
       bool GetEnabled() const;
 
+      /**
+       * Finds the value link whose default property has the given name.
+       * The links are indexed by name once per ValueLink::GetLinkGeneration(),
+       * so value links added, removed, renamed or redirected later will still be found.
+       *
+       * @return  The link, or NULL if this property is not linked.
+       */
+      ValueLink* FindValueLinkForProperty(const std::string& name);
+
+      /**
+       * Rebuilds the value link index if any value link changed since it was built.
+       */
+      void SyncValueLinkCache();
+
+      /**
+       * Casts a property to the given type.  The result is remembered, so
+       * reading or writing the same property again needs no RTTI.
+       *
+       * @return  The typed property, or NULL if it is not of that type.
+       */
+      template <typename PropType>
+      PropType* CastProperty(dtCore::ActorProperty* prop);
+
+      /**
+       * Retrieves a value through its native property type, falling back
+       * to string conversion if the property is of a different type.
+       */
+      template <typename PropType, typename T>
+      T GetNativePropertyValue(const std::string& name, int index, const T& defaultValue);
+
+      /**
+       * Sets a value through its native property type, falling back to
+       * string conversion if the property is of a different type.
+       *
+       * @param[in]  toString    Converts the value for the fallback.
+       * @param[in]  logChanges  True to log and notify changes when setting all links (index -1).
+       */
+      template <typename PropType, typename T>
+      void SetNativePropertyValue(const T& value, const std::string& name, int index,
+         std::string (*toString)(const T&), bool logChanges);
+
 
       // Properties.
       ID                 mID;
@@ -743,6 +812,27 @@ namespace dtDirector
       Director*          mDirector;
       DirectorGraph*     mGraph;
 
+      // Value link index by property name, valid for one link generation.
+      typedef std::map<std::string, int> ValueLinkCache;
+DT_DISABLE_WARNING_START_MSVC(4251)
+      ValueLinkCache     mValueLinkCache;
+DT_DISABLE_WARNING_END
+      unsigned int       mValueLinkGeneration;
+
+      // Typed properties by address.  The property is held so its address can't be reused.
+      struct PropertyCastEntry
+      {
+         PropertyCastEntry() : mType(NULL), mCast(NULL) {}
+
+         dtCore::RefPtr<dtCore::ActorProperty> mProperty;
+         const void* mType;
+         void* mCast;
+      };
+      enum { PROPERTY_CAST_CACHE_SIZE = 8 };
+DT_DISABLE_WARNING_START_MSVC(4251)
+      PropertyCastEntry  mPropertyCastCache[PROPERTY_CAST_CACHE_SIZE];
+DT_DISABLE_WARNING_END
+
 DT_DISABLE_WARNING_START_MSVC(4276)
       dtCore::RefPtr<const NodeType>   mType;
 DT_DISABLE_WARNING_END
@@ -88,6 +88,13 @@ namespace dtDirector
        */
       ValueLink& operator=(const ValueLink& src);
 
+      /**
+       * @return  A count that goes up whenever any value link is created, copied,
+       *          destroyed, renamed, redirected or given a new default property,
+       *          so nodes can tell when their cached link lookups are stale.
+       */
+      static unsigned int GetLinkGeneration();
+
       /**
        * Retrieves the owner of the link.
        *
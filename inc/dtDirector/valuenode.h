@@ -213,6 +213,13 @@ namespace dtDirector
        */
       void OnValueChanged();
 
+      /**
+       * @return  The number of times OnValueChanged was called.  Setters only
+       *          call it on an actual change, so comparing the count before and
+       *          after a set tells if the value changed without reading it.
+       */
+      unsigned int GetValueChangeCount() const {return mValueChangeCount;}
+
       /**
        * Event handler when the initial value property has changed.
        */
@@ -277,6 +284,7 @@ namespace dtDirector
 
       bool mHasInitialValue;
       bool mIsGlobal;
+      unsigned int mValueChangeCount;
 
       std::vector<ValueLink*> mLinks;
    };
@@ -52,6 +52,12 @@ namespace dtGame
       /** a map from component type strings to components */
       typedef std::vector< std::pair<ActorComponent::ACType, dtCore::RefPtr<ActorComponent> > > ActorComponentMap;
 
+      /**
+       * The components of each type id, listed under their own type and every parent type,
+       * in the order they were added.
+       */
+      typedef dtUtil::AssocVector<unsigned, ActorComponentVector> ComponentSlotTable;
+
       //CTOR
       ActorComponentBase();
 
@@ -62,6 +68,15 @@ namespace dtGame
       template <typename UnaryFunctor>
       void ForEachComponent(UnaryFunctor func) const;
 
+      /**
+       * Performs an operation on each actor component of a type, or of a type derived from it,
+       * without copying them into a vector.  The functor must not add or remove components.
+       * @param type The type of the ActorComponents to visit
+       * @param func a class with an operator() that takes an actor component by reference (dtGame::ActorComponent&)
+       */
+      template <typename UnaryFunctor>
+      void ForEachComponent(ActorComponent::ACType type, UnaryFunctor func) const;
+
       /**
        * Get all components matching this type
        * @param type The type of the ActorComponent to get
@@ -100,6 +115,12 @@ namespace dtGame
        */
       bool HasComponent(ActorComponent::ACType type) const;
 
+      /**
+       * Gets the first component of a type, or of a type derived from it.
+       * This looks the type up in a table, so it doesn't allocate or walk the components.
+       */
+      ActorComponent* FindComponent(ActorComponent::ACType type) const override;
+
       /**
        * Add an ActorComponent. Only one ActorComponent of a given type can be added.
        * @param component The ActorComponent to try to add
@@ -158,7 +179,22 @@ namespace dtGame
 
    private:
 
+      /**
+       * @return false if a type has been renamed since the slots were filled, which changes
+       *         type ids, so the components have to be checked one by one.
+       */
+      bool AreComponentSlotsCurrent() const;
+
+      /// @return the components of the type or a type derived from it, or NULL if there are none.
+      const ActorComponentVector* FindComponentSlot(const dtCore::ObjectType& type) const;
+
+      void AddToComponentSlots(const dtCore::ObjectType& type, ActorComponent& component);
+      void RemoveFromComponentSlots(const dtCore::ObjectType& type, ActorComponent& component);
+      void RebuildComponentSlots();
+
       ActorComponentMap mComponents;
+      ComponentSlotTable mComponentSlots;
+      unsigned mComponentSlotsGeneration;
 
    };
 
@@ -184,6 +220,32 @@ namespace dtGame
       BindActorComponent<UnaryFunctor, ActorComponentBase::ActorComponentMap::value_type> actorCompMapBindFunc(func);
       std::for_each(mComponents.begin(), mComponents.end(), actorCompMapBindFunc);
    }
+
+   template <typename UnaryFunctor>
+   inline void ActorComponentBase::ForEachComponent(ActorComponent::ACType type, UnaryFunctor func) const
+   {
+      if (AreComponentSlotsCurrent())
+      {
+         const ActorComponentVector* slot = FindComponentSlot(*type);
+         if (slot != NULL)
+         {
+            for (ActorComponentVector::const_iterator i = slot->begin(); i != slot->end(); ++i)
+            {
+               func(**i);
+            }
+         }
+      }
+      else
+      {
+         for (ActorComponentMap::const_iterator i = mComponents.begin(); i != mComponents.end(); ++i)
+         {
+            if (i->first->InstanceOf(*type))
+            {
+               func(*i->second);
+            }
+         }
+      }
+   }
 }
 
 #endif // actorcomponentbase_h__
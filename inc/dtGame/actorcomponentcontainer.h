@@ -63,15 +63,7 @@ namespace dtGame
       template <typename TComp>
       bool GetComponent(TComp*& compType) const
       {
-         ActorComponentVector components = GetComponents(TComp::TYPE);
-         if (!components.empty())
-         {
-            compType = static_cast<TComp*>(components[0]);
-         }
-         else
-         {
-            compType = NULL;
-         }
+         compType = static_cast<TComp*>(FindComponent(TComp::TYPE));
          return compType != NULL;
       }
 
@@ -88,15 +80,7 @@ namespace dtGame
       template <typename TComp>
       bool GetComponent(dtCore::RefPtr<TComp>& compType) const
       {
-         ActorComponentVector components = GetComponents(TComp::TYPE);
-         if (!components.empty())
-         {
-            compType = static_cast<TComp*>(components[0]);
-         }
-         else
-         {
-            compType = NULL;
-         }
+         compType = static_cast<TComp*>(FindComponent(TComp::TYPE));
          return compType.valid();
       }
 
@@ -110,12 +94,20 @@ namespace dtGame
        */
       template <class T> T* GetComponent() const
       {
-         T* component = NULL;
-         if (HasComponent(T::TYPE))
-         {
-            component = static_cast<T*>(GetComponents(T::TYPE)[0]);
-         }
-         return component;
+         return static_cast<T*>(FindComponent(T::TYPE));
+      }
+
+      /**
+       * Gets the first component of a type, or of a type derived from it, without building
+       * a vector.  The GetComponent templates call this, so override it with a faster lookup.
+       * @param type The type of the ActorComponent to get
+       * @return the first matching ActorComponent or NULL if there is none.
+       */
+      virtual ActorComponent* FindComponent(ActorComponent::ACType type) const
+      {
+         ActorComponentVector components;
+         GetComponents(type, components);
+         return components.empty() ? NULL : components[0];
       }
 
    //private:
@@ -97,6 +97,15 @@ namespace dtGame
          dtCore::RefPtr<ArrayMessageParameter> mMapNames;
    };
 
+   /**
+    * Sent each frame a map change is spread over, with the names of the maps being loaded.
+    * @see MapChangeStateData
+    */
+   DT_DECLARE_MESSAGE_BEGIN(MapChangeProgressMessage, MapMessage, DT_GAME_EXPORT)
+      /// How far along the map change is, from 0 to 100.
+      DECLARE_PARAMETER_INLINE(float, PercentComplete)
+   DT_DECLARE_MESSAGE_END()
+
    class DT_GAME_EXPORT GameEventMessage : public Message
    {
       public:
@@ -164,6 +164,12 @@ namespace dtGame
        */
       DEPRECATE_FUNC virtual bool HasComponent(ActorComponent::ACType type) const override;
 
+      /**
+       * Gets the first component of a type, or of a type derived from it.
+       * @return the ActorComponent or NULL if there is none.
+       */
+      DEPRECATE_FUNC virtual ActorComponent* FindComponent(ActorComponent::ACType type) const override;
+
       /**
        * Add an ActorComponent. Only one ActorComponent of a given type can be added.
        * @param component The ActorComponent to try to add
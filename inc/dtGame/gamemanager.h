@@ -784,6 +784,32 @@ namespace dtGame
        */
       void CloseCurrentMap();
 
+      /**
+       * Cancels the map change in progress.  The actors of the new maps are deleted and the new maps
+       * closed, then INFO_MAP_CHANGED is sent with no map names.
+       * @see dtGame::MapChangeStateData::CancelMapChange
+       * @return false if no map change is in progress.
+       */
+      bool CancelMapChange();
+
+      /// @return true if a map change or close is in progress.
+      bool IsMapChangeInProgress() const;
+
+      /**
+       * Sets whether map changes read the files of the new maps on the dtUtil::ThreadPool IO queue, so
+       * the simulation keeps ticking while they load from disk.  The maps are parsed and their actors
+       * built on the main thread, one map per frame.  Defaults to false.
+       */
+      void SetMapChangeInBackground(bool background);
+      bool GetMapChangeInBackground() const;
+
+      /**
+       * Sets about how many milliseconds each frame of a map change may spend adding actors.
+       * The rest are added on the following frames.  0, the default, adds them all in one frame.
+       */
+      void SetMapChangeActorTimeBudget(double milliseconds);
+      double GetMapChangeActorTimeBudget() const;
+
 
       /// Load a set of maps.
       /**
@@ -29,6 +29,7 @@
 #include <map>
 
 #include <dtCore/uniqueid.h>
+#include <dtCore/actorindex.h>
 #include <dtCore/timer.h>
 #include <dtGame/gmstatistics.h>
 #include <dtGame/gmsettings.h>
@@ -131,6 +132,13 @@ namespace dtGame
        */
       void AddActorToWorld(GameManager& gm, dtGame::GameActorProxy& actor);
 
+      /**
+       * Adds any game actors in the list that are waiting in a batch add to the world, the
+       * same as the ForEachActor iteration does.  Actors that refuse to be added are removed
+       * from the list.
+       */
+      void AddBatchActorsToWorld(GameManager& gm, dtCore::ActorPtrVector& actors);
+
       void AddActorToScene(dtCore::BaseActorObject& actor);
       // Adds a actor to the scene.  The return bool is if it changed the environment actor.
       bool AddActorToScene(GameActorProxy& actor);
@@ -147,6 +155,9 @@ namespace dtGame
       GameActorMap mGameActorProxyMap;
       GameActorMap mPrototypeActors;
       ActorMap  mBaseActorObjectMap;
+      /// Name, type and class name indices over the game and non-game actors.  Declared after
+      /// the actor maps so it is cleared while the actors are still alive.
+      dtCore::ActorIndex mActorIndex;
       std::vector<dtCore::RefPtr<GameActorProxy> > mDeleteList;
 
       // These are used during changing the map so that
@@ -27,18 +27,34 @@
 
 #include <dtUtil/enumeration.h>
 #include <dtCore/observerptr.h>
+#include <dtCore/refptr.h>
+#include <dtCore/baseactorobject.h>
 #include <dtGame/export.h> 
 #include <dtGame/gamemanager.h>
 
+namespace dtCore
+{
+   class Map;
+}
+
 namespace dtGame
 {
    class MessageType;
+   class MapReadTask;
    
    /**
     * A helper class for changing the map on the GM.  In the future, it would be nice
     * to allow swapping out this class on the GM so people could override/add to the process to 
     * do loading screens and such.
     * 
+    * By default each step runs in one frame on the main thread.  With SetLoadInBackground the
+    * files of the new maps are read on the dtUtil::ThreadPool IO queue.  Up to date binary maps are
+    * also decoded there into property records, and their actors are created on the main thread a slice
+    * at a time.  Xml maps are parsed on the main thread, one per frame, since parsing builds the actors.
+    * With SetActorAddTimeBudget the actors are created and added to the GameManager a slice at a time
+    * over several frames.  While the change is spread out, INFO_MAP_CHANGE_PROGRESS messages report
+    * how far along it is.  INFO_MAP_LOADED is only sent once every actor has been added.
+    *
     * @see dtGame::GameManager::ChangeMapSet for more information on the process.
     */
    class DT_GAME_EXPORT MapChangeStateData: public osg::Referenced
@@ -54,6 +70,9 @@ namespace dtGame
                ///State for unloading the old map.
                static const MapChangeState UNLOAD;
 
+               ///State for reading the new maps on a background thread and opening them as they are read.
+               static const MapChangeState OPEN;
+
                ///State for loading the new map.
                static const MapChangeState LOAD;
 
@@ -85,6 +104,40 @@ namespace dtGame
           */
          void ContinueMapChange();
 
+         /**
+          * Stops the map change in progress.  Actors of the new maps that were already added are
+          * deleted, the new maps are closed, and INFO_MAP_CHANGED is sent with no map names, like a
+          * failed load.  A map is never left part way opened.  One still being built is thrown away.
+          * @return false if no map change is in progress.
+          */
+         bool CancelMapChange();
+
+         /// @return true if CancelMapChange was called on the map change in progress.
+         bool IsCancelRequested() const { return mCancelRequested; }
+
+         /**
+          * Sets whether the files of the new maps are read on the dtUtil::ThreadPool IO queue, so the main
+          * thread keeps running while they load from disk.  Binary maps are decoded there too.  The actors
+          * are still created on the main thread.  It only takes effect if the thread pool is initialized.
+          * Defaults to false.
+          */
+         void SetLoadInBackground(bool background) { mLoadInBackground = background; }
+         bool GetLoadInBackground() const { return mLoadInBackground; }
+
+         /**
+          * Sets about how many milliseconds each frame may spend adding actors to the GameManager, and,
+          * for binary maps loaded in the background, creating them.  The rest are done on the following
+          * frames.  0, the default, does them all in one frame.
+          */
+         void SetActorAddTimeBudget(double milliseconds) { mActorAddTimeBudget = milliseconds; }
+         double GetActorAddTimeBudget() const { return mActorAddTimeBudget; }
+
+         /**
+          * @return how far along the map change is from 0 to 100.  Opening the maps is the first half,
+          *         adding the actors the second.
+          */
+         float GetProgress() const { return mProgress; }
+
          
          /// Takes a map name and loads all the actors into the GM
          /**
@@ -106,6 +159,7 @@ namespace dtGame
 
 
       protected:         
+         virtual ~MapChangeStateData();
 
          // Opens all of the new maps in the new map vector. Returns true if successful
          bool OpenNewMaps();
@@ -113,6 +167,32 @@ namespace dtGame
          // Closes all of the old maps in the old map vector.
          void CloseOldMaps();         
 
+         /// Starts reading the new maps on the IO thread and goes to the OPEN state.
+         void BeginOpenNewMapsInBackground();
+
+         /// Works on opening the next map if its file has been read, and goes to LOAD once all are open.
+         void ContinueOpenNewMaps();
+
+         /// Stops the read task and drops the map it was building, if any.
+         void ReleaseReadTask();
+
+         /**
+          * Adds the game events and environment of the map to the GM and collects the actors
+          * that still need to be added.
+          */
+         void PrepareMapForGM(dtCore::Map& map, dtCore::ActorRefPtrVector& actorsToAdd);
+
+         /// Adds the pending actors until the time budget runs out.  @return true once all are added.
+         bool AddPendingActors();
+
+         /// Deletes what was loaded so far, closes the new maps and goes back to IDLE.
+         void FinishCancel();
+
+         /// Goes back to IDLE with no maps after the new maps couldn't be opened.
+         void FailMapChange();
+
+         void SendProgressMessage();
+
       private:
          dtCore::ObserverPtr<GameManager> mGameManager;
 
@@ -122,6 +202,21 @@ namespace dtGame
          const MapChangeState* mCurrentState;
          bool mAddBillboards;
 
+         bool mLoadInBackground;
+         double mActorAddTimeBudget;
+         bool mCancelRequested;
+         float mProgress;
+         bool mProgressSent;
+
+         dtCore::RefPtr<MapReadTask> mReadTask;
+         // The index in mNewMapNames of the next map to open from the files read.
+         size_t mNextMapToOpen;
+
+         // The actors of the new maps waiting to be added to the GM, and the next one to add.
+         dtCore::ActorRefPtrVector mPendingActors;
+         size_t mNextActor;
+         bool mActorsPrepared;
+
          //disable copy constructor and operator = 
          MapChangeStateData(const MapChangeStateData&) {}
          MapChangeStateData& operator = (const MapChangeStateData&) { return *this; }
@@ -109,6 +109,8 @@ namespace dtGame
          static const MessageType& INFO_MAP_UNLOAD_BEGIN;
          static const MessageType INFO_MAP_CHANGE_BEGIN;
          static const MessageType INFO_MAP_CHANGE_END;
+         ///Sent each frame while a map change is spread over several frames.
+         static const MessageType INFO_MAP_CHANGE_PROGRESS;
          // renamed to INFO_MAP_CHANGE_END
          static const MessageType& INFO_MAP_CHANGED;
 
@@ -0,0 +1,143 @@
+/* -*-c++-*-
+ * Delta3D Open Source Game and Simulation Engine
+ * Copyright (C) 2006, Alion Science and Technology, BMH Operation.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * David Guthrie
+ */
+
+#ifndef DELTA_ATTRIBUTE_TRANSLATION_PLAN
+#define DELTA_ATTRIBUTE_TRANSLATION_PLAN
+
+#include <dtHLAGM/export.h>
+#include <dtHLAGM/rtihandle.h>
+#include <dtCore/refptr.h>
+
+#include <utility>
+#include <vector>
+
+namespace dtHLAGM
+{
+   class ParameterTranslator;
+   class AttributeToPropertyList;
+
+   /**
+    * A precompiled lookup for reflecting the attributes of one object to actor mapping.  It holds, per attribute
+    * to property list, how the attribute is handled and which parameter translator decodes it, plus a flat table
+    * of the distinct attribute handles, sorted by handle hash, that gives the indices of the attribute to property
+    * lists each handle feeds.  Reflecting an update then walks the incoming attributes once with no string
+    * comparisons and no searching for translators.
+    *
+    * The HLAComponent builds the plan once the attribute handles are resolved at connection time.  The mapping
+    * vector of an ObjectToActor can be changed in place, so the plan stores a hash of the mapping contents
+    * it was compiled from and the component rebuilds it when the hash changes.  The plan holds references
+    * to the handles it indexes.
+    */
+   class DT_HLAGM_EXPORT AttributeTranslationPlan
+   {
+      public:
+         enum MappingKind
+         {
+            /// A regular attribute decoded by a parameter translator.
+            MAPPING_KIND_NORMAL,
+            /// The special mapping that holds the name of the object to actor mapping.
+            MAPPING_KIND_MAPPING_NAME,
+            /// The special mapping that holds the entity type attribute.
+            MAPPING_KIND_ENTITY_TYPE
+         };
+
+         struct Entry
+         {
+            Entry(): mKind(MAPPING_KIND_NORMAL), mTranslator(NULL) {}
+
+            MappingKind mKind;
+            const ParameterTranslator* mTranslator;
+         };
+
+         typedef std::vector<unsigned> MappingIndexList;
+         /// A range of indices into the mapping vector, in mapping order.
+         typedef std::pair<MappingIndexList::const_iterator, MappingIndexList::const_iterator> HandleRange;
+
+         AttributeTranslationPlan();
+         ~AttributeTranslationPlan();
+
+         /// Removes all entries so the plan must be compiled again.
+         void Clear();
+
+         /**
+          * Appends the entry for the next attribute to property list.  Entries must be added in the order of
+          * the object to actor's mapping vector.
+          * @param handle the attribute handle or NULL if the mapping should never match an incoming attribute.
+          */
+         void AddMapping(MappingKind kind, RTIAttributeHandle* handle, const ParameterTranslator* translator);
+
+         /**
+          * Builds the handle table.  Call after the last AddMapping.
+          * @param mappingsHash the result of HashMappings for the mapping vector the plan was compiled from.
+          */
+         void Finish(size_t mappingsHash);
+
+         /// @return true if Finish has been called since the last Clear.
+         bool IsCompiled() const { return mCompiled; }
+
+         /// @return the number of entries, which matches the number of attribute to property lists compiled.
+         size_t GetMappingCount() const { return mEntries.size(); }
+
+         /// @pre mappingIndex < GetMappingCount()
+         const Entry& GetEntry(unsigned mappingIndex) const { return mEntries[mappingIndex]; }
+
+         /**
+          * Hashes everything in a mapping vector the plan depends on: the count, and per mapping the attribute
+          * handle, the HLA name and type, and whether it has parameters.
+          */
+         static size_t HashMappings(const std::vector<AttributeToPropertyList>& mappings);
+
+         /// @return true if the plan is compiled for a mapping vector with the given HashMappings result.
+         bool IsCompiledFor(size_t mappingsHash) const { return mCompiled && mMappingsHash == mappingsHash; }
+
+         /**
+          * @return the indices of the mappings fed by the given attribute handle.  The handle is found by its hash,
+          *         and then by pointer, since the RTI ambassadors cache their handle wrappers.  Handle objects that
+          *         only match by value, and handles that aren't mapped but collide with one that is, are
+          *         remembered so later lookups for them don't compare values again.
+          */
+         HandleRange FindMappings(RTIAttributeHandle& handle) const;
+
+      private:
+         struct HandleEntry
+         {
+            size_t mHash;
+            dtCore::RefPtr<RTIAttributeHandle> mHandle;
+            unsigned mBegin, mEnd;
+         };
+
+         typedef std::vector<HandleEntry> HandleTable;
+         /// handle object to index in the handle table, or the table size if it isn't mapped.
+         typedef std::vector<std::pair<dtCore::RefPtr<RTIAttributeHandle>, unsigned> > LookupCache;
+
+         HandleRange GetRange(unsigned tableIndex) const;
+
+         std::vector<Entry> mEntries;
+         std::vector<std::pair<dtCore::RefPtr<RTIAttributeHandle>, unsigned> > mPendingHandles;
+         HandleTable mHandleTable;
+         MappingIndexList mMappingIndices;
+         mutable LookupCache mLookupCache;
+         size_t mMappingsHash;
+         bool mCompiled;
+   };
+}
+
+#endif // DELTA_ATTRIBUTE_TRANSLATION_PLAN
@@ -506,10 +506,12 @@ namespace dtHLAGM
 
          const ParameterTranslator* FindTranslatorForAttributeType(const AttributeType& type) const;
 
+         /// @param translator the translator to use or NULL to find the one for the mapping's HLA type.
          void MapToMessageParameters(const char* buffer,
                                      size_t size,
                                      std::vector<dtCore::RefPtr<dtGame::MessageParameter> >& parameters,
-                                     const OneToManyMapping& mapping) const;
+                                     const OneToManyMapping& mapping,
+                                     const ParameterTranslator* translator = NULL) const;
 
          void MapFromMessageParameters(char* buffer,
                                        size_t& maxSize,
@@ -551,6 +553,7 @@ namespace dtHLAGM
           * @param message Game message to have parameters added.
           * @param addMissingParams Flag used to add parameters to the message if not found. (mostly for actor update messages)
           * @param classHandleString Name of the HLA Interaction (for logging error messages)
+          * @param translator The translator for the mapping, if already known, to save looking it up.
           * @return FALSE if any of the parameter mappings failed; TRUE othewise.
           */
          bool CreateMessageParameters( 
@@ -558,7 +561,8 @@ namespace dtHLAGM
             const OneToManyMapping& paramToParamMapping, // Interaction to Message Parameter Mapping Object
             dtGame::Message& message, // Game message to have parameters added to it.
             bool addMissingParams = false, // 
-            const std::string& classHandleString = "" // HLA Interaction class name (for log output)
+            const std::string& classHandleString = "", // HLA Interaction class name (for log output)
+            const ParameterTranslator* translator = NULL
             );
 
          /**
@@ -572,21 +576,15 @@ namespace dtHLAGM
            const OneToManyMapping& paramToParamMapping,
            dtGame::Message& message,
            bool addMissingParams,
-           const std::string& classHandleString // HLA Interaction class name
+           const std::string& classHandleString, // HLA Interaction class name
+           const ParameterTranslator* translator = NULL
            );
 
          /**
-          * Helper method for obtaining an RTI attribute's buffer and length if the
-          * attribute handle matches that as found on an AttributeToPropertyList.
-          * NOTE: The returned buffer has the same scope as that of the specified attributeSet.
-          *
-          * @param attributeSet Set of RTI attributes to be searched.
-          * @param curAttrToProp Attribute-to-property mapping that has the attribute handle of interest.
-          * @param outBufferLength Length of the attribute buffer that is returned; 0 if not found.
-          * @return Buffer associated with the found attribute; NULL if not found.
+          * Builds the AttributeTranslationPlan on the object to actor from its attribute handles,
+          * special attribute names, and parameter translators.
           */
-         std::string GetAttributeBufferAndLength( const RTIAttributeHandleValueMap& attributeSet,
-            AttributeToPropertyList& curAttrToProp );
+         void CompileTranslationPlan(ObjectToActor& objectToActor);
 
          /**
           * The RTI ambassador.
@@ -653,6 +651,9 @@ namespace dtHLAGM
 
          std::vector<dtCore::RefPtr<ParameterTranslator> > mParameterTranslators;
 
+         /// Scratch space for ReflectAttributeValues, one buffer pointer per attribute to property list.
+         std::vector<const std::string*> mReflectBuffers;
+
          dtCore::RefPtr<dtUtil::Log> mLogger;
 
          /// This is the default entity attr name.
@@ -38,6 +38,7 @@
 #include <dtHLAGM/onetoonemapping.h>
 #include <dtHLAGM/distypes.h>
 #include <dtHLAGM/attributetoproperty.h>
+#include <dtHLAGM/attributetranslationplan.h>
 #include <dtHLAGM/export.h>
 
 #include <dtUtil/enumeration.h>
@@ -216,6 +217,14 @@ namespace dtHLAGM
           */
          const std::string& GetMappingName() const;
 
+         /**
+          * @return the compiled lookup used to reflect attributes into the one to many mappings.  It is
+          *         cleared whenever the mapping vector is replaced.
+          * @see AttributeTranslationPlan
+          */
+         const AttributeTranslationPlan& GetTranslationPlan() const { return mTranslationPlan; }
+         AttributeTranslationPlan& GetTranslationPlan() { return mTranslationPlan; }
+
          ObjectToActor& operator=(const ObjectToActor& setTo);
 
          bool operator==(const ObjectToActor& toCompare) const;
@@ -267,6 +276,9 @@ namespace dtHLAGM
          /// A vector of One to One mappings for this Object to Actor mapping.
          std::vector<AttributeToPropertyList> mOneToMany;
 
+         /// Lookup from attribute handle to mOneToMany entries, compiled at connection time.
+         AttributeTranslationPlan mTranslationPlan;
+
    };
 
 }
@@ -26,6 +26,7 @@
 #include <osg/Referenced>
 #include <dtCore/refptr.h>
 #include <set>
+#include <cstddef>
 
 namespace dtHLAGM
 {
@@ -33,6 +34,12 @@ namespace dtHLAGM
    {
    public:
       virtual bool operator==(RTIHandle&) = 0;
+
+      /**
+       * @return a hash of the handle value.  Handles that compare equal must return the same hash.
+       *         The default is 0, which is always consistent, but makes every handle collide in lookups.
+       */
+      virtual size_t GetHash() const;
    protected:
       RTIHandle();
       virtual ~RTIHandle();
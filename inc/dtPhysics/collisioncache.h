@@ -0,0 +1,116 @@
+/* -*-c++-*-
+ * dtPhysics
+ * Copyright 2014, Caper Holdings, LLC
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef DELTA_COLLISION_CACHE_H_
+#define DELTA_COLLISION_CACHE_H_
+
+#include <dtPhysics/physicsexport.h>
+#include <string>
+
+namespace dtPhysics
+{
+   class VertexData;
+
+   /**
+    * An on disk cache of cooked triangle data.
+    *
+    * Turning a render mesh into collision triangles, and especially into a convex hull, is slow on big maps.
+    * The first time a mesh is cooked the result is written to the cache directory.  Later loads map the
+    * cached file into memory and read the triangles straight out of it.
+    *
+    * Cache files are named by a hash of the source file path, its size and modification time, whether it was
+    * turned into a convex hull, and the cache format version, so an edited source file is cooked again.
+    * The scale of an object is applied after loading, so one cached file serves every scale.
+    *
+    * The cache is off until a directory is set.  Old files are only deleted once the directory goes over
+    * the size set with SetMaxDirectorySize; clearing the directory by hand is safe as well.
+    * All of the methods may be called from any thread.
+    */
+   class DT_PHYSICS_EXPORT CollisionCache
+   {
+   public:
+      /// Bumped whenever the cooked data or the file layout changes, so old files are ignored.
+      static const unsigned CACHE_VERSION = 1U;
+
+      /// Added to the in memory cache key of data that is turned into a convex hull.
+      static const std::string POLYTOPE_KEY_SUFFIX;
+
+      /**
+       * Sets the directory the cooked files are kept in.  It is created if needed.
+       * An empty directory turns the cache off, which is the default.
+       */
+      static void SetDirectory(const std::string& directory);
+      static std::string GetDirectory();
+
+      static bool IsEnabled();
+
+      /**
+       * Sets the most bytes the cooked files may take up.  Whenever a file is written and the directory is
+       * over the limit, the files with the oldest modification time are deleted until it fits.  The
+       * directory is trimmed right away as well.  0, the default, means no limit.
+       */
+      static void SetMaxDirectorySize(unsigned long long bytes);
+      static unsigned long long GetMaxDirectorySize();
+
+      /**
+       * @return the file the cooked data for the source file would be kept in, or an empty string
+       *         if the cache is off or the source file doesn't exist.
+       */
+      static std::string GetCacheFileName(const std::string& sourceFile, bool polytope);
+
+      /**
+       * Fills the triangle data for a source file, which may be any mesh PhysicsReaderWriter can load.
+       * The cooked file is used if there is one, otherwise the source is cooked and the result is written to
+       * the cache.  With the cache off this just cooks the source.
+       * @param polytope true to turn the triangles into a convex hull.
+       * @return false if the source couldn't be loaded.
+       */
+      static bool LoadTriangleData(VertexData& triangleData, const std::string& sourceFile, bool polytope);
+
+      /**
+       * Starts loading a source file on the ThreadPool IO queue.  When it is done the data is added
+       * to the VertexData cache under the given key, where PhysicsObject will find it.  If the thread
+       * pool isn't running, the file is loaded before this returns.
+       * @param meshCacheKey the key the data is cached under.  PhysicsObject uses the resource identifier,
+       *                     with POLYTOPE_KEY_SUFFIX added for convex hulls.
+       * @return false if the key is already cached or being loaded.
+       */
+      static bool RequestLoad(const std::string& meshCacheKey, const std::string& sourceFile, bool polytope);
+
+      /// Blocks until a load requested for the key is done.  Returns at once if there is none.
+      static void WaitForLoad(const std::string& meshCacheKey);
+
+      struct Stats
+      {
+         Stats() : mHits(0U), mMisses(0U), mWrites(0U), mEvictions(0U) {}
+         unsigned mHits; ///< loads served by a cooked file.
+         unsigned mMisses; ///< loads that had to cook the source.
+         unsigned mWrites; ///< cooked files written.
+         unsigned mEvictions; ///< cooked files deleted to stay under the size limit.
+      };
+
+      static Stats GetStats();
+      static void ResetStats();
+
+   private:
+      CollisionCache();
+   };
+}
+
+#endif /* DELTA_COLLISION_CACHE_H_ */
@@ -72,12 +72,39 @@ namespace dtPhysics
        */
       static bool GetOrCreateCachedData(dtCore::RefPtr<VertexData>& dataOut, const std::string& key);
 
+      /**
+       * Adds data that was loaded elsewhere, such as on a loading thread, to the cache.
+       * @return false if the key is already cached.  The existing data is kept.
+       */
+      static bool AddCachedData(const std::string& key, VertexData& data);
+
+      /// @return the cached data for the key, or NULL.  A hit makes the data the most recently used.
       static dtCore::RefPtr<VertexData> FindCachedData(const std::string& key);
 
       static bool ClearCachedData(const std::string& key);
 
       static void ClearAllCachedData();
 
+      /**
+       * Sets the most entries the cache holds.  Past that, the least recently used entries are dropped.
+       * Objects already using dropped data keep it.  0, the default, means no limit.
+       */
+      static void SetMaxCachedData(unsigned maxEntries);
+      static unsigned GetMaxCachedData();
+
+      struct CacheStats
+      {
+         CacheStats() : mHits(0U), mMisses(0U), mEvictions(0U), mNumEntries(0U) {}
+         unsigned mHits;
+         unsigned mMisses;
+         unsigned mEvictions;
+         unsigned mNumEntries;
+      };
+
+      /// @return the lookups and evictions of the cache since the last reset, and the current size.
+      static CacheStats GetCacheStats();
+      static void ResetCacheStats();
+
       void SetMaterialName(dtPhysics::MaterialIndex matIndex, const std::string& materialName);
 
       dtUtil::RefString GetMaterialName(dtPhysics::MaterialIndex matIndex) const;
@@ -33,6 +33,11 @@
 #include <vector>
 #include <dtCore/refptr.h>
 
+namespace dtUtil
+{
+   class DataStream;
+}
+
 namespace dtPhysics
 {
    class VertexData;
@@ -54,6 +59,16 @@ namespace dtPhysics
           */
          static bool SaveTriangleDataFile(const VertexData& triangleData, const std::string& filename);
 
+         /**
+          * Reads the contents of a compiled physics file from a stream, such as one over a mapped file.
+          * @param filename only used in error messages.
+          * @throw dtUtil::Exception if the stream doesn't hold valid triangle data.
+          */
+         static void ReadTriangleData(dtUtil::DataStream& ds, VertexData& triangleData, const std::string& filename);
+
+         /// Writes the triangle data to a stream in the compiled physics file format.
+         static void WriteTriangleData(dtUtil::DataStream& ds, const VertexData& triangleData);
+
       private: 
 
    };
@@ -49,6 +49,9 @@ namespace dtTerrain
           * @param tile The tile with which to generate the base texture.
           */
          virtual void OnLoadTerrainTile(PagedTerrainTile &tile);
+
+         /// Generating or reading the color map only touches the tile, so it can run on the paging thread.
+         virtual bool IsLoadThreadSafe() const { return true; }
          
          /**
           *  Since this decorator does not add any geometry to the terrain,
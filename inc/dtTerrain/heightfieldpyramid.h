@@ -0,0 +1,99 @@
+/*
+* Delta3D Open Source Game and Simulation Engine
+* Copyright (C) 2005, BMH Associates, Inc.
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 2.1 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*/
+#ifndef DELTA_HEIGHTFIELDPYRAMID
+#define DELTA_HEIGHTFIELDPYRAMID
+
+#include <vector>
+#include <osg/Referenced>
+#include "dtTerrain/terrain_export.h"
+
+namespace dtTerrain
+{
+   class HeightField;
+
+   /**
+    * A min/max quadtree (max-mipmap) over the cells of a heightfield.  Level zero has one node
+    * per cell, i.e. per square of four neighboring posts, and each level above it halves the
+    * number of columns and rows until a single node covers the whole heightfield.  A node at
+    * level L covers the cells [c*2^L, (c+1)*2^L) by [r*2^L, (r+1)*2^L).
+    *
+    * This lets ray queries such as line of sight skip large areas of the terrain that are
+    * entirely below the ray.
+    */
+   class DT_TERRAIN_EXPORT HeightFieldPyramid : public osg::Referenced
+   {
+      public:
+
+         HeightFieldPyramid();
+
+         /**
+          * Builds the pyramid from the given heightfield.  Any existing data is discarded.
+          * @param hf The heightfield to build from.  If it has less than two rows or columns
+          *    the pyramid is left empty.
+          * @param border Each level zero node also includes the posts this many posts around
+          *    its cell.  Use this when the heights the pyramid bounds are resampled from the
+          *    heightfield and may be influenced by posts just outside the cell.
+          */
+         void Build(const HeightField &hf, unsigned int border = 0);
+
+         ///Clears all the levels.
+         void Clear();
+
+         ///@return The number of levels, or zero if the pyramid has not been built.
+         unsigned int GetNumLevels() const { return unsigned(mLevels.size()); }
+
+         ///@return The number of node columns at the given level.
+         unsigned int GetNumColumns(unsigned int level) const { return mLevels[level].mNumColumns; }
+
+         ///@return The number of node rows at the given level.
+         unsigned int GetNumRows(unsigned int level) const { return mLevels[level].mNumRows; }
+
+         ///@return The lowest post under the given node.
+         short GetMinHeight(unsigned int level, unsigned int c, unsigned int r) const
+         {
+            const Level &l = mLevels[level];
+            return l.mMin[c + r*l.mNumColumns];
+         }
+
+         ///@return The highest post under the given node.
+         short GetMaxHeight(unsigned int level, unsigned int c, unsigned int r) const
+         {
+            const Level &l = mLevels[level];
+            return l.mMax[c + r*l.mNumColumns];
+         }
+
+      protected:
+
+         virtual ~HeightFieldPyramid();
+
+      private:
+
+         struct Level
+         {
+            unsigned int mNumColumns;
+            unsigned int mNumRows;
+            std::vector<short> mMin;
+            std::vector<short> mMax;
+         };
+
+         std::vector<Level> mLevels;
+   };
+}
+
+#endif
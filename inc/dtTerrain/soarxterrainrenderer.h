@@ -25,6 +25,7 @@
 #include <osg/StateSet>
 #include <osg/Program>
 #include <osg/MatrixTransform>
+#include <OpenThreads/Mutex>
 #include <dtTerrain/terraindatarenderer.h>
 #include <dtTerrain/soarxdrawable.h>
 
@@ -116,6 +117,14 @@ namespace dtTerrain
           * @see SoarXDrawable
           */
          void OnLoadTerrainTile(PagedTerrainTile &tile);
+
+         /**
+          * Builds the SoarXDrawable for the tile, including the vertex errors and
+          * bounding sphere tree, and the base gradient texture, so that OnLoadTerrainTile
+          * only has to set up the render state and attach it.
+          * @param tile The new tile.
+          */
+         void OnPrepareTerrainTile(PagedTerrainTile &tile);
          
          /**
           * This method updates an internal map of tiles and drawables
@@ -135,6 +144,15 @@ namespace dtTerrain
           * @return A vector perpendicular to terrain at the given point.
           */
          osg::Vec3 GetNormal(float x, float y);
+
+         /**
+          * The SoarX surface is the heightfield plus the detail noise, so it never rises
+          * more than the largest detail displacement above the heightfield.
+          */
+         float GetHeightFieldMargin() const { return 32768.0f * mDetailVerticalResolution; }
+
+         ///GetHeight only reads the attached drawables.
+         bool IsGetHeightThreadSafe() const { return true; }
          
          /**
           * Returns a scene node that encapsulates the renderable terrain.  
@@ -257,11 +275,27 @@ namespace dtTerrain
           * to the terrain.
           */
          void CalculateDetailNoise(); 
+
+         /**
+          * Initializes the shared renderer data if it has not been done yet.  This is safe
+          * to call from the terrain paging thread.
+          */
+         void EnsureRendererInitialized();
+
+         /**
+          * Creates and builds the drawable for a tile.
+          */
+         dtCore::RefPtr<SoarXDrawable> CreateDrawable(PagedTerrainTile &tile);
          
       private:        
          
          ///Maps tiles to drawables.
          DrawableMap mDrawables;         
+
+         ///Drawables built by OnPrepareTerrainTile waiting to be attached.
+         std::map<PagedTerrainTile*, DrawableEntry> mPreparedDrawables;
+         OpenThreads::Mutex mPrepareMutex;
+         bool mRendererInitialized;
                        
          ///The root renderable for the terrain.
          dtCore::RefPtr<osg::Group> mRootGroupNode; 
@@ -26,6 +26,9 @@
 #include <string>
 #include <queue>
 #include <list>
+#include <vector>
+#include <set>
+#include <OpenThreads/Mutex>
 
 #include <dtCore/transformable.h>
 #include <dtUtil/enumeration.h>
@@ -44,6 +47,8 @@ namespace dtTerrain
    class TerrainDataRenderer;
    class TerrainDecorationLayer;
    class PagedTerrainTile;
+   class TerrainTileLoadTask;
+   class HeightFieldPyramid;
 
    class NullPointerException : public dtUtil::Exception
    {
@@ -73,6 +78,26 @@ namespace dtTerrain
    	InvalidDecorationLayerException(const std::string& message, const std::string& filename, unsigned int linenum);
    	virtual ~InvalidDecorationLayerException() {};
    };
+
+   /**
+    * One line of sight test in a batch passed to Terrain::ComputeLinesOfSight.
+    */
+   struct LineOfSightQuery
+   {
+      LineOfSightQuery() : mClear(true) {}
+
+      LineOfSightQuery(const osg::Vec3 &start, const osg::Vec3 &end)
+         : mStart(start), mEnd(end), mClear(true) {}
+
+      osg::Vec3 mStart;
+      osg::Vec3 mEnd;
+
+      ///Set to true if the line is not blocked by the terrain.
+      bool mClear;
+
+      ///The terrain point of the first sample that blocked the line.  Only valid if not clear.
+      osg::Vec3 mBlockingPoint;
+   };
    
 
    /**
@@ -169,6 +194,31 @@ namespace dtTerrain
          bool IsClearLineOfSight( const osg::Vec3& pointOne,
                                   const osg::Vec3& pointTwo );
 
+         /**
+          * Same as above, but also returns where the line is blocked.  The result is
+          * identical to SimpleLineOfSight at the same spacing.  If the renderer bounds its
+          * heights (see TerrainDataRenderer::GetHeightFieldMargin), a min/max pyramid
+          * of each tile's heightfield is used to skip the samples that are known to be
+          * above the terrain.
+          *
+          * @param pointOne The start point.
+          * @param pointTwo The end point.
+          * @param blockingPoint Set to the terrain point of the first sample that blocks
+          *    the view.  Untouched if the line of sight is clear.
+          * @return Returns true if there is a clear line of sight.
+          */
+         bool IsClearLineOfSight( const osg::Vec3& pointOne,
+                                  const osg::Vec3& pointTwo,
+                                  osg::Vec3& blockingPoint );
+
+         /**
+          * Computes a batch of line of sight queries.  If the thread pool is initialized
+          * and the renderer's GetHeight is thread safe, the queries are spread over the
+          * pool's worker threads.  This blocks until all the queries are done.
+          * @param queries The queries to compute.  The results are written into them.
+          */
+         void ComputeLinesOfSight(std::vector<LineOfSightQuery> &queries);
+
          void SetLineOfSightSpacing(float spacing) {mLOSPostSpacing = spacing;}
 
          float GetLineOfSightSpacing() const {return mLOSPostSpacing;}
@@ -185,6 +235,40 @@ namespace dtTerrain
 
          virtual void EnsureTileVisibility(const std::set<GeoCoordinates> &coordList);
 
+         /**
+          * Same as EnsureTileVisibility(coordList), but also keeps the tiles in prefetchList resident.
+          * Tiles from coordList are queued for loading before the prefetch tiles.
+          */
+         virtual void EnsureTileVisibility(const std::set<GeoCoordinates> &coordList,
+            const std::set<GeoCoordinates> &prefetchList);
+
+         /**
+          * Enables paging tiles on a background thread.  When enabled and the dtUtil::ThreadPool is
+          * initialized, reading the tile cache, the data reader, thread safe decoration layers and the
+          * renderer's OnPrepareTerrainTile all run on a worker thread, one tile at a time.  Only the
+          * remaining decoration layers and the renderer's OnLoadTerrainTile, which attach to the scene,
+          * run on the main thread.  Defaults to false.
+          */
+         void SetAsyncTileLoading(bool enable) { mAsyncTileLoading = enable; }
+         bool GetAsyncTileLoading() const { return mAsyncTileLoading; }
+
+         /**
+          * Sets how many milliseconds per frame may be spent attaching tiles that finished loading in the
+          * background.  At least one tile is attached per frame regardless.  Defaults to 4 ms.
+          */
+         void SetTileAttachBudgetMS(double ms) { mTileAttachBudgetMS = ms; }
+         double GetTileAttachBudgetMS() const { return mTileAttachBudgetMS; }
+
+         /**
+          * Sets how many seconds ahead the camera velocity is projected when choosing tiles to prefetch.
+          * Set to 0 to disable prefetching.  Defaults to 2 seconds.
+          */
+         void SetPrefetchTime(float seconds) { mPrefetchTime = seconds; }
+         float GetPrefetchTime() const { return mPrefetchTime; }
+
+         /// @return the number of tiles queued or loading in the background but not yet attached.
+         unsigned GetNumTilesLoading() const { return unsigned(mTilesToLoadQ.size() + mTilesInFlight.size()); }
+
          /**
           * Sets the path of the terrain cache.  The terrain cache is a directory
           * somewhere on the hard drive which is used to store on the fly data
@@ -352,6 +436,24 @@ namespace dtTerrain
 
          virtual void PostFrame(double frameTime);
 
+         /**
+          * Runs the loading stages that don't touch the scene: cache path creation, reading the tile
+          * cache and the data reader.  When loading asynchronously this is called on the paging thread
+          * and also runs the given thread safe decoration layers and the renderer's OnPrepareTerrainTile.
+          * @param layers the decoration layers to load in this stage.
+          * @param prepareRenderer true to call OnPrepareTerrainTile on the renderer.
+          * @return false if the reader failed and the tile should not be attached.
+          */
+         virtual bool PrepareTerrainTile(PagedTerrainTile &tile,
+            const std::vector<dtCore::RefPtr<TerrainDecorationLayer> > &layers, bool prepareRenderer);
+
+         /**
+          * Runs the loading stages that must happen on the main thread: the decoration layers, the
+          * renderer's OnLoadTerrainTile, and the resident notifications.
+          * @param skipThreadSafeLayers true if the thread safe layers already ran in PrepareTerrainTile.
+          */
+         virtual void AttachTerrainTile(PagedTerrainTile &tile, bool skipThreadSafeLayers);
+
          ///List of terrain tiles currently queued up for loading.
          std::queue<dtCore::RefPtr<PagedTerrainTile> > mTilesToLoadQ;
 
@@ -387,6 +489,26 @@ namespace dtTerrain
          TerrainLayerMap mDecorationLayers;
 
          float mLOSPostSpacing;
+
+         bool mAsyncTileLoading;
+         double mTileAttachBudgetMS;
+         float mPrefetchTime;
+
+         friend class TerrainTileLoadTask;
+         dtCore::RefPtr<TerrainTileLoadTask> mLoadTask;
+         ///Tiles handed to the load task that have not been attached yet.
+         std::set<PagedTerrainTile*> mTilesInFlight;
+         ///In flight tiles that were unloaded while the paging thread was preparing them.
+         std::set<PagedTerrainTile*> mTilesCancelled;
+         ///Held around data reader calls, since the reader runs on the paging thread.
+         OpenThreads::Mutex mReaderMutex;
+
+         typedef std::map<std::pair<int,int>,dtCore::RefPtr<HeightFieldPyramid> > PyramidMap;
+         ///Line of sight pyramids of the attached tiles, keyed by whole latitude and longitude.
+         PyramidMap mLOSPyramids;
+         ///Pyramids built by PrepareTerrainTile for tiles that are not attached yet.
+         std::map<PagedTerrainTile*,dtCore::RefPtr<HeightFieldPyramid> > mPreparedPyramids;
+         OpenThreads::Mutex mPyramidMutex;
    };
 
    /**
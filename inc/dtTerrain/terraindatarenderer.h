@@ -75,6 +75,16 @@ namespace dtTerrain
           * @see PagedTerrainTile
           */
          virtual void OnLoadTerrainTile(PagedTerrainTile &tile) = 0;
+
+         /**
+          * Called before OnLoadTerrainTile, after the reader has loaded the tile, when the terrain is paging
+          * tiles in the background.  Renderers may do any expensive preprocessing that doesn't touch the
+          * scene graph here, and then only attach the result in OnLoadTerrainTile.
+          * @param tile The tile being loaded.
+          * @note This is called on a worker thread, but never for two tiles at the same time.
+          * @note The default implementation does nothing, so all the work happens in OnLoadTerrainTile.
+          */
+         virtual void OnPrepareTerrainTile(PagedTerrainTile &tile) { }
          
          /**
           * This method is called when the parent terrain wishes
@@ -102,6 +112,23 @@ namespace dtTerrain
           * @return A vector perpendicular to terrain at the given point.
           */
          virtual osg::Vec3 GetNormal(float x, float y) = 0;
+
+         /**
+          * Gets how far above the posts of a tile's heightfield the surface returned by
+          * GetHeight may rise, for example because of detail added by the renderer.  The
+          * terrain uses this to skip line of sight samples over low ground.
+          * @return The margin in meters, or a negative value if GetHeight is not bounded
+          *    by the tile heightfields.  The default returns -1, which makes every line of
+          *    sight query sample the renderer.
+          */
+         virtual float GetHeightFieldMargin() const { return -1.0f; }
+
+         /**
+          * @return true if GetHeight may be called from several threads at once while no tiles
+          *    are being loaded or unloaded.  Batched line of sight queries only run in parallel
+          *    when this is true.  The default returns false.
+          */
+         virtual bool IsGetHeightThreadSafe() const { return false; }
          
          /**
           * Returns a scene node that encapsulates the renderable terrain.  This 
@@ -72,6 +72,15 @@ namespace dtTerrain
           * @see PagedTerrainTile
           */
          virtual void OnLoadTerrainTile(PagedTerrainTile &tile) = 0;
+
+         /**
+          * @return true if OnLoadTerrainTile only works on the tile passed in and
+          *    does not touch the scene graph or other shared state, so the terrain
+          *    may call it from its background paging thread.  Layers that build
+          *    scene nodes should leave this false, and OnLoadTerrainTile will then
+          *    be called on the main thread when the tile is attached.
+          */
+         virtual bool IsLoadThreadSafe() const { return false; }
          
          /**
           * This method is called when the parent terrain wishes
@@ -369,6 +369,52 @@ namespace dtUtil
           */
          const osg::Vec3d ConvertToRemoteRotation(const osg::Vec3& hpr);
 
+         /**
+          * Batch version of ConvertToLocalTranslation.  The coordinate mode, local offset and UTM projection
+          * parameters are looked up once for the whole batch instead of once per location.  Geocentric locations
+          * converted to UTM are split into blocks of separate x, y and z arrays and run through branch free
+          * loops the compiler can vectorize.  The results match ConvertToLocalTranslation on each location to
+          * within float rounding.
+          * @param locs the remote locations to convert.
+          * @param results filled with the local translations.  It must hold count entries, and may not alias locs.
+          * @param count the number of locations.
+          */
+         void ConvertToLocalTranslations(const osg::Vec3d* locs, osg::Vec3* results, size_t count);
+
+         /**
+          * Batch version of ConvertToRemoteTranslation.  The results are identical to calling
+          * ConvertToRemoteTranslation on each translation.
+          */
+         void ConvertToRemoteTranslations(const osg::Vec3* translations, osg::Vec3d* results, size_t count);
+
+         /**
+          * Batch version of ConvertToLocalRotation.  The origin rotation matrix is reconfigured at most once, and
+          * the inverse of each euler rotation is computed as its transpose rather than with a general matrix inverse.
+          * The rotations are converted in blocks, with each matrix element in its own array, so the loops can be
+          * vectorized.  Because of that, the results match ConvertToLocalRotation to within 1e-3 degrees rather
+          * than exactly.
+          * @param psiThetaPhis the remote rotations in radians.
+          * @param results filled with heading, pitch, roll in degrees.  It must hold count entries.
+          * @param count the number of rotations.
+          */
+         void ConvertToLocalRotations(const osg::Vec3* psiThetaPhis, osg::Vec3* results, size_t count);
+
+         /**
+          * Batch version of ConvertToRemoteRotation.  Like ConvertToLocalRotations, it works on blocks of
+          * element arrays and inverts the rotations by transposing them, so the results match
+          * ConvertToRemoteRotation to within 1e-4 radians rather than exactly.
+          */
+         void ConvertToRemoteRotations(const osg::Vec3* hprs, osg::Vec3d* results, size_t count);
+
+         /**
+          * Converts a batch of remote positions and euler rotations, such as a set of entity state updates,
+          * into local translations and rotations in one call.
+          * @see ConvertToLocalTranslations
+          * @see ConvertToLocalRotations
+          */
+         void ConvertToLocalTransforms(const osg::Vec3d* locs, const osg::Vec3* psiThetaPhis,
+                  osg::Vec3* translations, osg::Vec3* hprs, size_t count);
+
          /**
           * Creates a 4x4 rotation matrix from a set of DIS/RPR-FOM Euler angles.
           *
@@ -583,6 +629,12 @@ namespace dtUtil
           */
          void CalculateLocalRotationMatrixLL(double phi, double lambda);
 
+         /**
+          * @return the transverse mercator parameters for the configured utm zone and hemisphere.  They are
+          *         only recalculated when the zone or hemisphere changes.
+          */
+         const UTMParameters& GetUTMParameters();
+
          Log* mLogger;
 
          const LocalCoordinateType* mLocalCoordinateType;
@@ -624,6 +676,11 @@ namespace dtUtil
          /// A flag used to tell it to reconpute the rotation matrix next time it converts.
          bool mRotationDirty;
 
+         /// Cached projection parameters for mUTMParamsZone and mUTMParamsHemisphere.
+         UTMParameters mUTMParams;
+         unsigned mUTMParamsZone;
+         char mUTMParamsHemisphere;
+
       public:
 
          Coordinates& operator = (const Coordinates &rhs);
@@ -57,8 +57,19 @@ namespace dtUtil
          }
       };
 
+      /// The factor the capacity is multiplied by when a write needs more room, by default.
+      static const float DEFAULT_GROWTH_FACTOR;
+      /// The least number of bytes the capacity grows by, by default.
+      static const unsigned int DEFAULT_MIN_GROWTH = 16U;
+
       DataStream();
 
+      /**
+       * Constructs an empty datastream with room for the given number of bytes, so a writer
+       * that knows about how much it will write can skip the reallocations.
+       */
+      explicit DataStream(unsigned int initialCapacity);
+
       /**
        * Constructs the datastream using an existing byte buffer.
        * @param buffer The existing valid buffer.
@@ -72,8 +83,24 @@ namespace dtUtil
        *    the associated buffer memory.
        */
       DataStream(char* buffer, unsigned int bufferSize, bool autoFree=true);
+
+      /**
+       * Creates a read only stream over memory the caller owns.  Nothing is copied, and the
+       * memory must outlive the view and any copies of it.  Writing to or resizing a view
+       * throws DataStreamBufferWriteError.
+       * @param buffer The data to read.  It may only be NULL if bufferSize is 0.
+       * @param bufferSize The size in bytes of the data.
+       */
+      static DataStream CreateView(const char* buffer, unsigned int bufferSize);
+
+      /// Copies the data of rhs, unless rhs is a view, then the copy views the same memory.
       DataStream(const DataStream& rhs);
       DataStream& operator=(const DataStream& rhs);
+
+      /// Takes the buffer of rhs without copying it.  rhs is left empty.
+      DataStream(DataStream&& rhs);
+      DataStream& operator=(DataStream&& rhs);
+
       virtual ~DataStream();
 
       DataStream& operator>>(bool& value) { Read(value); return *this; }
@@ -199,6 +226,18 @@ namespace dtUtil
       void Read(osg::Vec4d& vector);
       void Write(const osg::Vec4d& vector);
 
+      /**
+       * Writes an unsigned integer 7 bits a byte, with the top bit set on all but the last byte,
+       * so small values take less room.  These work whether or not variable length encoding
+       * is turned on for the stream.
+       */
+      void WriteVarUInt(unsigned long long value);
+      void ReadVarUInt(unsigned long long& value);
+
+      /// Writes a signed integer zigzag encoded as a variable length integer, so small negatives stay short.
+      void WriteVarInt(long long value);
+      void ReadVarInt(long long& value);
+
       unsigned int ReadBinary(char* pBuffer, const unsigned int isize);
       unsigned int WriteBinary(const char* pBuffer, const unsigned int isize);
 
@@ -232,6 +271,39 @@ namespace dtUtil
        */
       void SetForceLittleEndian(bool force) { mForceLittleEndian = force; }
 
+      /**
+       * Sets whether the integers wider than a byte are written as variable length integers,
+       * zigzag encoded if they are signed, and strings are written with a variable length size
+       * in front and are not truncated.  Bools, chars, floats and doubles are written the same
+       * either way.
+       *
+       * It is off by default, so the stream reads and writes the fixed width format existing
+       * data and readers use.  The reader of a stream must use the same setting as the writer.
+       */
+      void SetVariableLengthEncoding(bool enable) { mVariableLengthEncoding = enable; }
+      bool GetVariableLengthEncoding() const { return mVariableLengthEncoding; }
+
+      /// @return true if this is a read only view made with CreateView.
+      bool IsReadOnlyView() const { return mReadOnly; }
+
+      /**
+       * Sets how the buffer grows when a write runs out of room.  The new capacity is the old
+       * one times growthFactor, but at least minGrowth bytes more, and always enough for the write.
+       * A factor of 1 grows linearly by minGrowth.
+       * @param growthFactor The multiplier, clamped to at least 1.  The default is 2.
+       * @param minGrowth The least number of bytes to grow by.
+       */
+      void SetGrowthPolicy(float growthFactor, unsigned int minGrowth = DEFAULT_MIN_GROWTH);
+      float GetGrowthFactor() const { return mGrowthFactor; }
+      unsigned int GetMinGrowth() const { return mMinGrowth; }
+
+      /**
+       * Makes sure the buffer can hold at least capacity bytes without growing again.
+       * It never shrinks the buffer.
+       * @return the new capacity.
+       */
+      unsigned int Reserve(unsigned int capacity);
+
       unsigned int SetBufferSize(unsigned int size) { return ResizeBuffer(size); };
       unsigned int IncreaseBufferSize(const unsigned int size = 0);
       unsigned int GetRemainingReadSize() const;
@@ -239,15 +311,34 @@ namespace dtUtil
       unsigned int AppendDataStream(const DataStream& dataStream);
 
    private:
+      /// Constructs a view, see CreateView.
+      DataStream(const char* buffer, unsigned int bufferSize);
+
       unsigned int ResizeBuffer(unsigned int size = 0);
 
+      /// Grows the buffer by the growth policy to at least requiredCapacity bytes.
+      void GrowBuffer(unsigned int requiredCapacity);
+
+      /// Makes room for size more bytes at the write position.
+      void EnsureWriteCapacity(unsigned int size)
+      {
+         if (mReadOnly || mWritePos + size > mBufferCapacity)
+         {
+            GrowBuffer(mWritePos + size);
+         }
+      }
+
    private:
       char* mBuffer;
       unsigned int mBufferSize, mBufferCapacity;
       unsigned int mReadPos, mWritePos;
+      float mGrowthFactor;
+      unsigned int mMinGrowth;
       bool mAutoFreeBuffer;
+      bool mReadOnly;
       bool mIsLittleEndian;
       bool mForceLittleEndian;
+      bool mVariableLengthEncoding;
    };
 
    class DT_UTIL_EXPORT DataStreamBufferInvalid : public dtUtil::Exception
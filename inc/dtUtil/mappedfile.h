@@ -0,0 +1,71 @@
+/* -*-c++-*-
+ * Delta3D Open Source Game and Simulation Engine
+ * Copyright (C) 2014, Caper Holdings, LLC
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef DELTA_MAPPEDFILE_H
+#define DELTA_MAPPEDFILE_H
+
+#include <dtUtil/export.h>
+#include <dtUtil/mswinmacros.h>
+
+#include <cstddef>
+#include <string>
+
+namespace dtUtil
+{
+   /**
+    * Maps a whole file read only into memory, so it can be read without copying it into a buffer first.
+    * The operating system pages the file in as it is touched.  The mapping is released when the object
+    * is destroyed or Close is called.
+    */
+   class DT_UTIL_EXPORT MappedFile
+   {
+   public:
+      MappedFile();
+      ~MappedFile();
+
+      /**
+       * Maps the file, closing any file already mapped.
+       * @return false if the file can't be opened or is empty.
+       */
+      bool Open(const std::string& fileName);
+
+      void Close();
+
+      bool IsOpen() const { return mData != NULL; }
+
+      /// @return the start of the file, or NULL if nothing is mapped.
+      const char* GetData() const { return mData; }
+
+      /// @return the size of the file in bytes.
+      size_t GetSize() const { return mSize; }
+
+   private:
+      MappedFile(const MappedFile&);
+      MappedFile& operator=(const MappedFile&);
+
+      const char* mData;
+      size_t mSize;
+#ifdef DELTA_WIN32
+      void* mFileHandle;
+      void* mMappingHandle;
+#endif
+   };
+}
+
+#endif // DELTA_MAPPEDFILE_H
@@ -0,0 +1,184 @@
+/* -*-c++-*-
+ * Delta3D Open Source Game and Simulation Engine
+ * Copyright (C) 2014, Caper Holdings, LLC
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef DELTA_PROFILER_H
+#define DELTA_PROFILER_H
+
+#include <dtUtil/export.h>
+#include <OpenThreads/Atomic>
+#include <osg/Timer>
+
+#include <iosfwd>
+#include <string>
+
+namespace dtUtil
+{
+   class ProfilerImpl;
+
+   /**
+    * Records what every thread does frame by frame so it can be looked at offline.
+    *
+    * Each thread writes timed zones, counters and frame markers into its own ring buffer,
+    * so recording never waits on another thread.  When a ring is full the oldest events are
+    * overwritten, so the trace always holds the most recent frames.
+    *
+    * The trace is written in the Chrome trace event format, which chrome://tracing and
+    * other trace viewers can open.  Zones nest by time, so a zone opened inside another
+    * shows up beneath it.
+    *
+    * Don't call this directly from instrumented code.  Use the DT_PROFILE_* macros below,
+    * which compile to nothing unless Delta3D is built with BUILD_WITH_PROFILER.  Recording
+    * also has to be switched on at runtime with SetEnabled.
+    */
+   class DT_UTIL_EXPORT Profiler
+   {
+   public:
+      /// The number of events each thread keeps by default.
+      static const unsigned DEFAULT_EVENTS_PER_THREAD = 65536U;
+
+      static Profiler& GetInstance();
+
+      /// Starts or stops recording.  Recording is off by default.  May be called from any thread.
+      void SetEnabled(bool enabled);
+      static bool IsEnabled() { return unsigned(mEnabled) != 0U; }
+
+      /**
+       * Sets the size of the ring buffer of each thread.  Threads that have recorded already
+       * change over on the next Clear.
+       */
+      void SetEventsPerThread(unsigned numEvents);
+      unsigned GetEventsPerThread() const;
+
+      /**
+       * Records a zone on the calling thread.
+       * @param name A name that lives as long as the program, such as a string literal.
+       * @param start The tick the zone started on, from osg::Timer::instance()->tick().
+       * @param end The tick the zone ended on.
+       */
+      void RecordZone(const char* name, osg::Timer_t start, osg::Timer_t end);
+
+      /// Records the current value of a counter.  The name must live as long as the program.
+      void RecordCounter(const char* name, double value);
+
+      /// Marks the start of a new frame.  Call it from the main thread once a frame.
+      void MarkFrame();
+      unsigned GetFrameNumber() const;
+
+      /// Names the calling thread in the trace.  The name is copied.
+      void SetThreadName(const std::string& name);
+
+      /**
+       * Returns a copy of the name that lives as long as the profiler, so a name that is
+       * built at runtime can be used for a zone.  Repeated calls with the same name are cheap.
+       */
+      const char* InternName(const std::string& name);
+
+      /// Writes everything the threads hold right now as Chrome trace JSON.
+      void ExportChromeTrace(std::ostream& stream) const;
+
+      /// Writes the trace to a file.  @return false if the file can't be written.
+      bool ExportChromeTrace(const std::string& fileName) const;
+
+      /// Throws away all recorded events.  Thread names and interned names are kept.
+      void Clear();
+
+   private:
+      Profiler();
+      ~Profiler();
+      Profiler(const Profiler&);
+      Profiler& operator=(const Profiler&);
+
+      ProfilerImpl* mImpl;
+      /// Read by every instrumented thread, so it is atomic rather than a plain bool.
+      static OpenThreads::Atomic mEnabled;
+   };
+
+   /**
+    * Records the time from its construction to its destruction as a zone.  The clock is
+    * only read when the profiler is enabled.
+    */
+   class ProfileZone
+   {
+   public:
+      explicit ProfileZone(const char* name)
+      : mName(Profiler::IsEnabled() ? name : NULL)
+      , mStart(mName != NULL ? osg::Timer::instance()->tick() : 0)
+      {
+      }
+
+      ~ProfileZone()
+      {
+         if (mName != NULL)
+         {
+            Profiler::GetInstance().RecordZone(mName, mStart, osg::Timer::instance()->tick());
+         }
+      }
+
+   private:
+      ProfileZone(const ProfileZone&);
+      ProfileZone& operator=(const ProfileZone&);
+
+      const char* mName;
+      osg::Timer_t mStart;
+   };
+}
+
+#define DT_PROFILE_CONCAT_IMPL(a, b) a##b
+#define DT_PROFILE_CONCAT(a, b) DT_PROFILE_CONCAT_IMPL(a, b)
+
+#ifdef DT_ENABLE_PROFILER
+
+/// Times the rest of the enclosing scope.  The name must be a string literal or live as long.
+#define DT_PROFILE_ZONE(name) \
+   dtUtil::ProfileZone DT_PROFILE_CONCAT(dtProfileZone, __LINE__)(name)
+
+/// Times the rest of the enclosing scope under a name built at runtime, such as a component name.
+#define DT_PROFILE_ZONE_DYNAMIC(nameString) \
+   dtUtil::ProfileZone DT_PROFILE_CONCAT(dtProfileZone, __LINE__)( \
+      dtUtil::Profiler::IsEnabled() ? dtUtil::Profiler::GetInstance().InternName(nameString) : NULL)
+
+#define DT_PROFILE_COUNTER(name, value) \
+   do { if (dtUtil::Profiler::IsEnabled()) { dtUtil::Profiler::GetInstance().RecordCounter(name, double(value)); } } while (false)
+
+#define DT_PROFILE_FRAME() \
+   do { if (dtUtil::Profiler::IsEnabled()) { dtUtil::Profiler::GetInstance().MarkFrame(); } } while (false)
+
+/// Names the calling thread.  Each thread runs it once per call site, so it can sit in a callback.
+#define DT_PROFILE_THREAD_NAME(name) \
+   do \
+   { \
+      static thread_local bool dtProfileThreadNamed = false; \
+      if (!dtProfileThreadNamed) \
+      { \
+         dtProfileThreadNamed = true; \
+         dtUtil::Profiler::GetInstance().SetThreadName(name); \
+      } \
+   } while (false)
+
+#else
+
+#define DT_PROFILE_ZONE(name) ((void)0)
+#define DT_PROFILE_ZONE_DYNAMIC(nameString) ((void)0)
+#define DT_PROFILE_COUNTER(name, value) ((void)0)
+#define DT_PROFILE_FRAME() ((void)0)
+#define DT_PROFILE_THREAD_NAME(name) ((void)0)
+
+#endif
+
+#endif // DELTA_PROFILER_H
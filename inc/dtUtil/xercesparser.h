@@ -30,6 +30,7 @@
 
 XERCES_CPP_NAMESPACE_BEGIN
    class SAX2XMLReader;
+   class ErrorHandler;
 XERCES_CPP_NAMESPACE_END
 
 namespace dtUtil
@@ -60,7 +61,26 @@ namespace dtUtil
       bool Parse(const std::string& data,
                  XERCES_CPP_NAMESPACE_QUALIFIER ContentHandler& handler,
                  const std::string& schema="");
+
+      /** \brief Parses an XML document that is already in memory.
+        * This is for documents that weren't read from their own file, such as ones packed in an archive.
+        * \param data the document, which needn't be null terminated.
+        * \param length the number of bytes in the document.
+        * \param bufferId the name used for the document in error messages.
+        * \param handler the object to handle content within the document.
+        * \param schema the file that defines the schema requirements.
+        * \return false if parsing failed.
+        */
+      bool ParseBuffer(const char* data, size_t length, const std::string& bufferId,
+                       XERCES_CPP_NAMESPACE_QUALIFIER ContentHandler& handler,
+                       const std::string& schema="");
    private:
+      /// Creates the reader and sets up schema checking.  Returns false if that failed.
+      bool CreateReader(XERCES_CPP_NAMESPACE_QUALIFIER ContentHandler& handler,
+                        XERCES_CPP_NAMESPACE_QUALIFIER ErrorHandler& errorHandler,
+                        const std::string& schema);
+
+
       XERCES_CPP_NAMESPACE_QUALIFIER SAX2XMLReader* mParser;
    };
 }
@@ -37,6 +37,7 @@
 #include <dtCore/scene.h>
 #include <dtCore/deltawin.h>
 #include <dtCore/singletonmanager.h>
+#include <dtCore/asyncmeshloader.h>
 #include <dtUtil/log.h>
 #include <dtUtil/stringutils.h>
 #include <dtUtil/xercesparser.h>
@@ -205,6 +206,8 @@ void Application::ReadSystemProperties()
 ///////////////////////////////////////////////////////////////////////////////
 Application::~Application()
 {
+   // Finish the mesh loads while the pool can still run them.
+   dtCore::AsyncMeshLoader::Destroy();
    if (mThreadPoolInitialized) { dtUtil::ThreadPool::Shutdown(); }
 
    //osgDB::Registry::instance()->clearArchiveCache();
@@ -21,6 +21,7 @@
 
 
 #include <dtAI/aiplugininterface.h>
+#include <algorithm>
 
 
 namespace dtAI
@@ -66,6 +67,87 @@ namespace dtAI
       return result;
    }
 
+   /////////////////////////////////////////////////////////////////////////////////////////////////////////////
+   namespace
+   {
+      struct CloserToPoint
+      {
+         CloserToPoint(const osg::Vec3& point) : mPoint(point) {}
+
+         bool operator()(const WaypointInterface* lhs, const WaypointInterface* rhs) const
+         {
+            return (lhs->GetPosition() - mPoint).length2() < (rhs->GetPosition() - mPoint).length2();
+         }
+
+         osg::Vec3 mPoint;
+      };
+   }
+
+   /////////////////////////////////////////////////////////////////////////////////////////////////////////////
+   bool AIPluginInterface::GetNearestWaypoints(const osg::Vec3& pos, unsigned k, float maxDistance, WaypointArray& arrayToFill)
+   {
+      WaypointArray inRange;
+      GetWaypointsAtRadius(pos, maxDistance, inRange);
+
+      // the radius search is allowed to be a box, so trim to the actual sphere.
+      const float maxDistance2 = maxDistance * maxDistance;
+      WaypointArray::iterator i = inRange.begin();
+      while (i != inRange.end())
+      {
+         if (((*i)->GetPosition() - pos).length2() >= maxDistance2)
+         {
+            i = inRange.erase(i);
+         }
+         else
+         {
+            ++i;
+         }
+      }
+
+      size_t count = std::min(size_t(k), inRange.size());
+      std::partial_sort(inRange.begin(), inRange.begin() + count, inRange.end(), CloserToPoint(pos));
+      arrayToFill.insert(arrayToFill.end(), inRange.begin(), inRange.begin() + count);
+      return count > 0;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////////////////////////////////////
+   PathRequestQueue* AIPluginInterface::GetPathRequestQueue()
+   {
+      return NULL;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////////////////////////////////////
+   void AIPluginInterface::GetClosestWaypointsBatch(const std::vector<osg::Vec3>& positions, float maxDistance, WaypointArray& results)
+   {
+      results.resize(positions.size());
+      for (size_t i = 0; i < positions.size(); ++i)
+      {
+         results[i] = GetClosestWaypoint(positions[i], maxDistance);
+      }
+   }
+
+   /////////////////////////////////////////////////////////////////////////////////////////////////////////////
+   void AIPluginInterface::GetNearestWaypointsBatch(const std::vector<osg::Vec3>& positions, unsigned k, float maxDistance, std::vector<WaypointArray>& results)
+   {
+      results.resize(positions.size());
+      for (size_t i = 0; i < positions.size(); ++i)
+      {
+         results[i].clear();
+         GetNearestWaypoints(positions[i], k, maxDistance, results[i]);
+      }
+   }
+
+   /////////////////////////////////////////////////////////////////////////////////////////////////////////////
+   void AIPluginInterface::GetWaypointsAtRadiusBatch(const std::vector<osg::Vec3>& positions, float radius, std::vector<WaypointArray>& results)
+   {
+      results.resize(positions.size());
+      for (size_t i = 0; i < positions.size(); ++i)
+      {
+         results[i].clear();
+         GetWaypointsAtRadius(positions[i], radius, results[i]);
+      }
+   }
+
    /////////////////////////////////////////////////////////////////////////////////////////////////////////////
    bool AIPluginInterface::IsWaypointTypeSupported(dtCore::RefPtr<const dtCore::ObjectType> type) const
    {
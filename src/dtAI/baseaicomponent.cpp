@@ -30,6 +30,7 @@
 #include <dtAI/aiinterfaceactor.h>
 #include <dtAI/aiplugininterface.h>
 #include <dtAI/aidebugdrawable.h>
+#include <dtAI/pathrequestqueue.h>
 
 namespace dtAI
 {
@@ -85,6 +86,11 @@ namespace dtAI
       if (message.GetMessageType() == dtGame::MessageType::TICK_LOCAL)
       {
          //float dt = float(static_cast<const dtGame::TickMessage&>(message).GetDeltaSimTime());
+         dtAI::AIPluginInterface* aiInterface = GetAIPluginInterface();
+         if (aiInterface != NULL && aiInterface->GetPathRequestQueue() != NULL)
+         {
+            aiInterface->GetPathRequestQueue()->Update();
+         }
       }
       else if (message.GetMessageType() == dtGame::MessageType::INFO_GAME_EVENT)
       {
@@ -25,7 +25,10 @@
 #include <dtAI/aidebugdrawable.h>
 #include <dtAI/waypointreaderwriter.h>
 #include <dtAI/waypointrenderinfo.h>
+#include <dtAI/waypointtypes.h>
 #include <dtUtil/templateutility.h>
+#include <dtUtil/threadpool.h>
+#include <algorithm>
 #include <iterator>
 
 namespace dtAI
@@ -44,13 +47,304 @@ namespace dtAI
 */
    };
 
+   /////////////////////////////////////////////////////////////////////////////
+   // spatial query utils
+   /////////////////////////////////////////////////////////////////////////////
+   namespace
+   {
+      // Don't bother rebalancing tiny trees on every few edits.
+      const unsigned MIN_EDITS_BEFORE_REBALANCE = 32;
+
+      // Fewer queries than this per thread aren't worth the overhead of the thread pool.
+      const size_t MIN_BATCH_QUERIES_PER_TASK = 64;
+
+      typedef std::pair<float, WaypointInterface*> DistanceWaypointPair;
+      typedef std::vector<DistanceWaypointPair> DistanceWaypointArray;
+
+      /// kd-tree visitor that appends the held waypoint directly, so no temporary vector or id lookups are needed.
+      struct CollectWaypointVisitor
+      {
+         CollectWaypointVisitor(AIPluginInterface::WaypointArray& toFill) : mToFill(&toFill) {}
+
+         void operator()(const KDHolder& holder)
+         {
+            mToFill->push_back(holder.mWaypoint);
+         }
+
+         AIPluginInterface::WaypointArray* mToFill;
+      };
+
+      /// kd-tree visitor that gathers the waypoints inside the search sphere with their squared distance.
+      struct CollectDistanceVisitor
+      {
+         CollectDistanceVisitor(const osg::Vec3& pos, float maxDistance, DistanceWaypointArray& toFill)
+            : mPos(pos)
+            , mMaxDistance2(maxDistance * maxDistance)
+            , mToFill(&toFill)
+         {
+         }
+
+         void operator()(const KDHolder& holder)
+         {
+            osg::Vec3 delta(holder.d[0] - mPos[0], holder.d[1] - mPos[1], holder.d[2] - mPos[2]);
+            float dist2 = delta.length2();
+            if (dist2 < mMaxDistance2)
+            {
+               mToFill->push_back(DistanceWaypointPair(dist2, holder.mWaypoint));
+            }
+         }
+
+         osg::Vec3 mPos;
+         float mMaxDistance2;
+         DistanceWaypointArray* mToFill;
+      };
+
+      struct DistanceLess
+      {
+         bool operator()(const DistanceWaypointPair& lhs, const DistanceWaypointPair& rhs) const
+         {
+            return lhs.first < rhs.first;
+         }
+      };
+
+      /////////////////////////////////////////////////////////////////////////////
+      WaypointInterface* FindClosest(const WaypointKDTree& tree, const osg::Vec3& pos, float maxRadius)
+      {
+         find_result found = tree.find_nearest(pos, maxRadius);
+         if (found.first != tree.end())
+         {
+            return found.first->mWaypoint;
+         }
+         return NULL;
+      }
+
+      /////////////////////////////////////////////////////////////////////////////
+      bool FindNearest(const WaypointKDTree& tree, const osg::Vec3& pos, unsigned k, float maxDistance,
+               DistanceWaypointArray& scratch, AIPluginInterface::WaypointArray& arrayToFill)
+      {
+         scratch.clear();
+         if (k == 0 || maxDistance <= 0.0f)
+         {
+            return false;
+         }
+
+         tree.visit_within_range(pos, maxDistance, CollectDistanceVisitor(pos, maxDistance, scratch));
+
+         size_t count = std::min(size_t(k), scratch.size());
+         std::partial_sort(scratch.begin(), scratch.begin() + count, scratch.end(), DistanceLess());
+         for (size_t i = 0; i < count; ++i)
+         {
+            arrayToFill.push_back(scratch[i].second);
+         }
+         return count > 0;
+      }
+
+      /////////////////////////////////////////////////////////////////////////////
+      bool FindAtRadius(const WaypointKDTree& tree, const osg::Vec3& pos, float radius, AIPluginInterface::WaypointArray& arrayToFill)
+      {
+         size_t startSize = arrayToFill.size();
+         tree.visit_within_range(pos, radius, CollectWaypointVisitor(arrayToFill));
+         return arrayToFill.size() > startSize;
+      }
+
+      /////////////////////////////////////////////////////////////////////////////
+      /// Runs a contiguous range of one of the batch queries on a worker thread.
+      class SpatialQueryTask : public dtUtil::ThreadPoolTask
+      {
+      public:
+         enum QueryType
+         {
+            CLOSEST,
+            NEAREST_K,
+            RADIUS
+         };
+
+         SpatialQueryTask(QueryType type, const WaypointKDTree& tree, const std::vector<osg::Vec3>& positions,
+                  size_t begin, size_t end, unsigned k, float distance,
+                  AIPluginInterface::WaypointArray* singleResults, std::vector<AIPluginInterface::WaypointArray>* multiResults)
+            : mType(type)
+            , mTree(tree)
+            , mPositions(positions)
+            , mBegin(begin)
+            , mEnd(end)
+            , mK(k)
+            , mDistance(distance)
+            , mSingleResults(singleResults)
+            , mMultiResults(multiResults)
+         {
+         }
+
+         /*override*/ void operator()()
+         {
+            DistanceWaypointArray scratch;
+            for (size_t i = mBegin; i < mEnd; ++i)
+            {
+               switch (mType)
+               {
+               case CLOSEST:
+                  (*mSingleResults)[i] = FindClosest(mTree, mPositions[i], mDistance);
+                  break;
+               case NEAREST_K:
+                  (*mMultiResults)[i].clear();
+                  FindNearest(mTree, mPositions[i], mK, mDistance, scratch, (*mMultiResults)[i]);
+                  break;
+               case RADIUS:
+                  (*mMultiResults)[i].clear();
+                  FindAtRadius(mTree, mPositions[i], mDistance, (*mMultiResults)[i]);
+                  break;
+               }
+            }
+         }
+
+      protected:
+         virtual ~SpatialQueryTask() {}
+
+      private:
+         QueryType mType;
+         const WaypointKDTree& mTree;
+         const std::vector<osg::Vec3>& mPositions;
+         size_t mBegin, mEnd;
+         unsigned mK;
+         float mDistance;
+         AIPluginInterface::WaypointArray* mSingleResults;
+         std::vector<AIPluginInterface::WaypointArray>* mMultiResults;
+      };
+
+      /////////////////////////////////////////////////////////////////////////////
+      void RunSpatialQueries(SpatialQueryTask::QueryType type, const WaypointKDTree& tree, const std::vector<osg::Vec3>& positions,
+               unsigned k, float distance,
+               AIPluginInterface::WaypointArray* singleResults, std::vector<AIPluginInterface::WaypointArray>* multiResults)
+      {
+         size_t numTasks = 1;
+         if (dtUtil::ThreadPool::IsInitialized())
+         {
+            numTasks = std::min(size_t(dtUtil::ThreadPool::GetNumImmediateWorkerThreads()),
+                     positions.size() / MIN_BATCH_QUERIES_PER_TASK);
+         }
+
+         if (numTasks <= 1)
+         {
+            dtCore::RefPtr<SpatialQueryTask> task = new SpatialQueryTask(type, tree, positions, 0, positions.size(),
+                     k, distance, singleResults, multiResults);
+            (*task)();
+            return;
+         }
+
+         std::vector<dtCore::RefPtr<SpatialQueryTask> > tasks;
+         tasks.reserve(numTasks);
+         size_t chunk = positions.size() / numTasks;
+         for (size_t i = 0; i < numTasks; ++i)
+         {
+            size_t begin = i * chunk;
+            size_t end = (i + 1 == numTasks) ? positions.size() : begin + chunk;
+            tasks.push_back(new SpatialQueryTask(type, tree, positions, begin, end, k, distance, singleResults, multiResults));
+            dtUtil::ThreadPool::AddTask(*tasks.back());
+         }
+
+         dtUtil::ThreadPool::ExecuteTasks();
+      }
+   }
+
    /////////////////////////////////////////////////////////////////////////////
    DeltaAIInterface::DeltaAIInterface()
       : mWaypointGraph(new WaypointGraph())
       , mAStar(*mWaypointGraph)
-      , mKDTreeDirty(true)
+      , mPathCache(new AbstractPathCache)
+      , mNameGeneration(NamedWaypoint::GetNameGeneration())
+      , mKDTreeEdits(0U)
+      , mRebalanceThreshold(0.25f)
       , mKDTree(new WaypointKDTree(std::ptr_fun(KDHolderIndexFunc)))
    {
+      mAStar.SetPathCache(mPathCache.get());
+      mPathRequests = new PathRequestQueue(*mWaypointGraph, mPathCache.get());
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void DeltaAIInterface::IndexWaypoint(WaypointInterface& waypoint)
+   {
+      KDHolder node(waypoint.GetPosition(), &waypoint);
+      mKDTree->insert(node);
+      ++mKDTreeEdits;
+
+      // Only named waypoints can be found by name, so the others are left out.
+      const NamedWaypoint* named = dynamic_cast<const NamedWaypoint*>(&waypoint);
+      if (named != NULL)
+      {
+         mNameIndex[named->GetName()].push_back(&waypoint);
+      }
+      mTypeIndex[&waypoint.GetWaypointType()].push_back(&waypoint);
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void DeltaAIInterface::UnindexWaypoint(WaypointInterface& waypoint)
+   {
+      const NamedWaypoint* named = dynamic_cast<const NamedWaypoint*>(&waypoint);
+
+      // the name may have changed since it was indexed, so fall back to searching every bucket.
+      NameIndex::iterator nameIter = named != NULL ? mNameIndex.find(named->GetName()) : mNameIndex.end();
+      bool removed = named == NULL;
+      if (nameIter != mNameIndex.end())
+      {
+         WaypointArray& bucket = nameIter->second;
+         WaypointArray::iterator found = std::find(bucket.begin(), bucket.end(), &waypoint);
+         if (found != bucket.end())
+         {
+            bucket.erase(found);
+            removed = true;
+         }
+         if (bucket.empty())
+         {
+            mNameIndex.erase(nameIter);
+         }
+      }
+
+      for (nameIter = mNameIndex.begin(); !removed && nameIter != mNameIndex.end(); ++nameIter)
+      {
+         WaypointArray& bucket = nameIter->second;
+         WaypointArray::iterator found = std::find(bucket.begin(), bucket.end(), &waypoint);
+         if (found != bucket.end())
+         {
+            bucket.erase(found);
+            if (bucket.empty())
+            {
+               mNameIndex.erase(nameIter);
+            }
+            removed = true;
+            break;
+         }
+      }
+
+      TypeIndex::iterator typeIter = mTypeIndex.find(&waypoint.GetWaypointType());
+      if (typeIter != mTypeIndex.end())
+      {
+         WaypointArray& bucket = typeIter->second;
+         bucket.erase(std::remove(bucket.begin(), bucket.end(), &waypoint), bucket.end());
+         if (bucket.empty())
+         {
+            mTypeIndex.erase(typeIter);
+         }
+      }
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   bool DeltaAIInterface::RemoveFromKDTree(WaypointInterface& waypoint)
+   {
+      WaypointKDTree::const_iterator found = mKDTree->find_exact(KDHolder(waypoint.GetPosition(), waypoint.GetID()));
+
+      if (found == mKDTree->end())
+      {
+         // The position may have been changed without calling MoveWaypoint, so look around the old spot.
+         find_result nearest = mKDTree->find_nearest(waypoint.GetPosition(), 1.0f);
+         if (nearest.first == mKDTree->end() || nearest.first->mID != waypoint.GetID())
+         {
+            return false;
+         }
+         found = nearest.first;
+      }
+
+      mKDTree->erase(found);
+      ++mKDTreeEdits;
+      return true;
    }
 
    /////////////////////////////////////////////////////////////////////////////
@@ -67,10 +361,7 @@ namespace dtAI
             mDrawable->InsertWaypoint(*waypoint);
          }
 
-         KDHolder node(waypoint->GetPosition(), waypoint->GetID());
-         mKDTree->insert(node);
-
-         mKDTreeDirty = true;
+         IndexWaypoint(*waypoint);
       }
    }
 
@@ -88,10 +379,7 @@ namespace dtAI
             mDrawable->InsertWaypoint(*waypoint);
          }
 
-         KDHolder node(waypoint->GetPosition(), waypoint->GetID());
-         mKDTree->insert(node);
-
-         mKDTreeDirty = true;
+         IndexWaypoint(*waypoint);
       }
    }
 
@@ -125,10 +413,7 @@ namespace dtAI
                mDrawable->InsertWaypoint(*parentWp);
             }
 
-            KDHolder node(parentWp->GetPosition(), parentWp->GetID());
-            mKDTree->insert(node);
-
-            mKDTreeDirty = true;
+            IndexWaypoint(*parentWp);
          }
 
          return true;
@@ -140,18 +425,13 @@ namespace dtAI
    /////////////////////////////////////////////////////////////////////////////
    bool DeltaAIInterface::MoveWaypoint(WaypointInterface* wi, const osg::Vec3& newPos)
    {
-      // the kd-tree cannot move :( for now remove and re-insert
-      osg::Vec3 pos = wi->GetPosition();
-
-      find_result found = mKDTree->find_nearest(pos, 1.0f);
-      if (found.first != mKDTree->end() && (*found.first).mID == wi->GetID())
+      // the kd-tree cannot move, so erase and re-insert in place.  This also refreshes the name index.
+      if (RemoveFromKDTree(*wi))
       {
-         mKDTree->erase(found.first);
-
-         KDHolder node(newPos, wi->GetID());
-         mKDTree->insert(node);
+         UnindexWaypoint(*wi);
 
          wi->SetPosition(newPos);
+         IndexWaypoint(*wi);
 
          // re-insert to move
          mWaypointGraph->InsertWaypoint(wi);
@@ -162,7 +442,6 @@ namespace dtAI
             mDrawable->InsertWaypoint(*wi);
          }
 
-         mKDTreeDirty = true;
          return true;
       }
 
@@ -172,43 +451,30 @@ namespace dtAI
    /////////////////////////////////////////////////////////////////////////////
    bool DeltaAIInterface::RemoveWaypoint(WaypointInterface* wi)
    {
-      bool result = false;
-
-      osg::Vec3 pos = wi->GetPosition();
-      std::vector<KDHolder> v;
-
-      mKDTree->find_within_range(pos, 0.1f, std::back_inserter(v));
+      WaypointInterface* wpPtr = GetWaypointById(wi->GetID());
+      if (wpPtr == NULL || !RemoveFromKDTree(*wpPtr))
+      {
+         return false;
+      }
 
-      std::vector<KDHolder>::const_iterator iter = v.begin();
-      std::vector<KDHolder>::const_iterator iterEnd = v.end();
-      for (; iter != iterEnd; ++iter)
+      // remove from current drawable
+      if (mDrawable.valid())
       {
-         WaypointInterface* wpPtr = GetWaypointById(iter->mID);
-         if (wpPtr != NULL && wpPtr->GetID() == wi->GetID())
-         {
-            // remove from current drawable
-            if (mDrawable.valid())
-            {
-               RemoveAllEdges(wpPtr->GetID());
-               mDrawable->RemoveWaypoint(wpPtr->GetID());
-            }
+         RemoveAllEdges(wpPtr->GetID());
+         mDrawable->RemoveWaypoint(wpPtr->GetID());
+      }
 
-            // remove from kd-tree
-            mKDTree->erase(*iter);
-            mKDTreeDirty = true;
+      UnindexWaypoint(*wpPtr);
 
-            // remove from waypoint graph
-            mWaypointGraph->RemoveWaypoint(wpPtr->GetID());
+      // hold a reference so removing it from the graph and array can't delete it out from under us.
+      dtCore::RefPtr<WaypointInterface> wpRef = wpPtr;
 
-            // finally remove it from internal array
-            dtUtil::array_remove<WaypointRefArray> rm(mWaypoints);
-            dtCore::RefPtr<WaypointInterface> wpRef = wpPtr;
-            result = rm(wpRef);
-            break;
-         }
-      }
+      // remove from waypoint graph
+      mWaypointGraph->RemoveWaypoint(wpPtr->GetID());
 
-      return result;
+      // finally remove it from internal array
+      dtUtil::array_remove<WaypointRefArray> rm(mWaypoints);
+      return rm(wpRef);
    }
 
    /////////////////////////////////////////////////////////////////////////////
@@ -226,18 +492,40 @@ namespace dtAI
    }
 
    /////////////////////////////////////////////////////////////////////////////
-   WaypointInterface* DeltaAIInterface::GetWaypointByName(const std::string& name)
+   void DeltaAIInterface::SyncNameIndex()
    {
-      WaypointRefArray::const_iterator iter = mWaypoints.begin();
-      WaypointRefArray::const_iterator iterEnd = mWaypoints.end();
+      unsigned generation = NamedWaypoint::GetNameGeneration();
+      if (generation == mNameGeneration)
+      {
+         return;
+      }
 
-      for (;iter != iterEnd; ++iter)
+      // Something was renamed, maybe through its property container, so the keys may be stale.
+      mNameGeneration = generation;
+      mNameIndex.clear();
+
+      WaypointRefArray::iterator iter = mWaypoints.begin();
+      WaypointRefArray::iterator iterEnd = mWaypoints.end();
+      for (; iter != iterEnd; ++iter)
       {
-         if ((*iter)->ToString() == name)
+         const NamedWaypoint* named = dynamic_cast<const NamedWaypoint*>(iter->get());
+         if (named != NULL)
          {
-            return (*iter).get();
+            mNameIndex[named->GetName()].push_back(iter->get());
          }
       }
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   WaypointInterface* DeltaAIInterface::GetWaypointByName(const std::string& name)
+   {
+      SyncNameIndex();
+
+      NameIndex::const_iterator found = mNameIndex.find(name);
+      if (found != mNameIndex.end() && !found->second.empty())
+      {
+         return found->second.front();
+      }
 
       return NULL;
    }
@@ -245,15 +533,12 @@ namespace dtAI
    /////////////////////////////////////////////////////////////////////////////
    void DeltaAIInterface::GetWaypointsByName(const std::string& name, WaypointArray& arrayToFill)
    {
-      WaypointRefArray::const_iterator iter = mWaypoints.begin();
-      WaypointRefArray::const_iterator iterEnd = mWaypoints.end();
+      SyncNameIndex();
 
-      for (;iter != iterEnd; ++iter)
+      NameIndex::const_iterator found = mNameIndex.find(name);
+      if (found != mNameIndex.end())
       {
-         if ((*iter)->ToString() == name)
-         {
-            arrayToFill.push_back((*iter).get());
-         }
+         arrayToFill.insert(arrayToFill.end(), found->second.begin(), found->second.end());
       }
    }
 
@@ -345,20 +630,39 @@ namespace dtAI
    PathFindResult DeltaAIInterface::HierarchicalFindPath(WaypointID pFrom, WaypointID pTo, ConstWaypointArray& result)
    {
       WaypointGraphAStar astar(*mWaypointGraph);
+      astar.SetPathCache(mPathCache.get());
 
       return astar.HierarchicalFindPath(pFrom, pTo, result);
    }
 
+   /////////////////////////////////////////////////////////////////////////////
+   PathRequestQueue* DeltaAIInterface::GetPathRequestQueue()
+   {
+      return mPathRequests.get();
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   AbstractPathCache& DeltaAIInterface::GetAbstractPathCache()
+   {
+      return *mPathCache;
+   }
+
    /////////////////////////////////////////////////////////////////////////////
    void DeltaAIInterface::ClearMemory()
    {
       mKDTree->clear();
+      mKDTreeEdits = 0U;
+      mNameIndex.clear();
+      mNameGeneration = NamedWaypoint::GetNameGeneration();
+      mTypeIndex.clear();
 
       if (mDrawable.valid())
       {
          mDrawable->ClearMemory();
       }
 
+      mPathRequests->Clear();
+      mPathCache->Clear();
       mWaypointGraph->Clear();
    }
 
@@ -523,35 +827,20 @@ namespace dtAI
    /////////////////////////////////////////////////////////////////////////////
    void DeltaAIInterface::GetWaypointsByType(const dtCore::ObjectType& type, WaypointArray& toFill)
    {
-      WaypointRefArray::const_iterator iter = mWaypoints.begin();
-      WaypointRefArray::const_iterator iterEnd = mWaypoints.end();
-
-      for (;iter != iterEnd; ++iter)
+      dtCore::RefPtr<const dtCore::ObjectType> typeKey = &type;
+      TypeIndex::const_iterator found = mTypeIndex.find(typeKey);
+      if (found != mTypeIndex.end())
       {
-         if ((*iter)->GetWaypointType() == type)
-         {
-            toFill.push_back((*iter).get());
-         }
+         toFill.insert(toFill.end(), found->second.begin(), found->second.end());
       }
    }
 
    /////////////////////////////////////////////////////////////////////////////
    WaypointInterface* DeltaAIInterface::GetClosestWaypoint(const osg::Vec3& pos, float maxRadius)
    {
-      if (mKDTreeDirty)
-      {
-         Optimize();
-      }
-
-      WaypointInterface* result = NULL;
+      OptimizeIfNeeded();
 
-      find_result found = mKDTree->find_nearest(pos, maxRadius);
-      if (found.first != mKDTree->end())
-      {
-         result = GetWaypointById(found.first->mID);
-      }
-
-      return result;
+      return FindClosest(*mKDTree, pos, maxRadius);
    }
 
 
@@ -560,21 +849,25 @@ namespace dtAI
    {
       WaypointInterface* closestPoint = NULL;
 
-      WaypointRefArray::const_iterator iter = mWaypoints.begin();
-      WaypointRefArray::const_iterator iterEnd = mWaypoints.end();
+      SyncNameIndex();
+      NameIndex::const_iterator found = mNameIndex.find(name);
+      if (found == mNameIndex.end())
+      {
+         return NULL;
+      }
+
+      WaypointArray::const_iterator iter = found->second.begin();
+      WaypointArray::const_iterator iterEnd = found->second.end();
 
       float minDistance = FLT_MAX;
 
       for (;iter != iterEnd; ++iter)
       {
-         if ((*iter)->ToString() == name)
+         float distanceSquared = ((*iter)->GetPosition() - pos).length2();
+         if (distanceSquared < minDistance && distanceSquared < osg::square(maxRadius))
          {
-            float distanceSquared = ((*iter)->GetPosition() - pos).length2();
-            if (distanceSquared < minDistance && distanceSquared < osg::square(maxRadius))
-            {
-               minDistance = distanceSquared;
-               closestPoint = *iter;
-            }
+            minDistance = distanceSquared;
+            closestPoint = *iter;
          }
       }
 
@@ -584,31 +877,65 @@ namespace dtAI
    /////////////////////////////////////////////////////////////////////////////
    bool DeltaAIInterface::GetWaypointsAtRadius(const osg::Vec3& pos, float radius, WaypointArray& arrayToFill)
    {
-      if (mKDTreeDirty)
-      {
-         Optimize();
-      }
+      OptimizeIfNeeded();
 
-      std::vector<KDHolder> v;
+      FindAtRadius(*mKDTree, pos, radius, arrayToFill);
 
-      mKDTree->find_within_range(pos, radius, std::back_inserter(v));
+      return !arrayToFill.empty();
+   }
 
-      std::vector<KDHolder>::const_iterator iter = v.begin();
-      std::vector<KDHolder>::const_iterator iterEnd = v.end();
-      for (; iter != iterEnd; ++iter)
-      {
-         WaypointInterface* wi = GetWaypointById(iter->mID);
-         if (wi != NULL)
-         {
-            arrayToFill.push_back(wi);
-         }
-         else
-         {
-            LOG_ERROR("Error searching for waypoints.");
-         }
-      }
+   /////////////////////////////////////////////////////////////////////////////
+   bool DeltaAIInterface::GetNearestWaypoints(const osg::Vec3& pos, unsigned k, float maxDistance, WaypointArray& arrayToFill)
+   {
+      OptimizeIfNeeded();
 
-      return !arrayToFill.empty();
+      DistanceWaypointArray scratch;
+      return FindNearest(*mKDTree, pos, k, maxDistance, scratch, arrayToFill);
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void DeltaAIInterface::GetClosestWaypointsBatch(const std::vector<osg::Vec3>& positions, float maxDistance, WaypointArray& results)
+   {
+      OptimizeIfNeeded();
+
+      results.resize(positions.size());
+      RunSpatialQueries(SpatialQueryTask::CLOSEST, *mKDTree, positions, 1U, maxDistance, &results, NULL);
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void DeltaAIInterface::GetNearestWaypointsBatch(const std::vector<osg::Vec3>& positions, unsigned k, float maxDistance, std::vector<WaypointArray>& results)
+   {
+      OptimizeIfNeeded();
+
+      results.resize(positions.size());
+      RunSpatialQueries(SpatialQueryTask::NEAREST_K, *mKDTree, positions, k, maxDistance, NULL, &results);
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void DeltaAIInterface::GetWaypointsAtRadiusBatch(const std::vector<osg::Vec3>& positions, float radius, std::vector<WaypointArray>& results)
+   {
+      OptimizeIfNeeded();
+
+      results.resize(positions.size());
+      RunSpatialQueries(SpatialQueryTask::RADIUS, *mKDTree, positions, 0U, radius, NULL, &results);
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void DeltaAIInterface::SetRebalanceThreshold(float fractionOfTreeSize)
+   {
+      mRebalanceThreshold = fractionOfTreeSize;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   float DeltaAIInterface::GetRebalanceThreshold() const
+   {
+      return mRebalanceThreshold;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   unsigned DeltaAIInterface::GetNumEditsSinceRebalance() const
+   {
+      return mKDTreeEdits;
    }
 
    /////////////////////////////////////////////////////////////////////////////
@@ -618,10 +945,27 @@ namespace dtAI
       delete mKDTree;
    }
 
+   /////////////////////////////////////////////////////////////////////////////
+   void DeltaAIInterface::OptimizeIfNeeded()
+   {
+      if (mKDTreeEdits == 0U)
+      {
+         return;
+      }
+
+      // The tree is always correct after an insert or erase, just possibly unbalanced, so only pay for
+      // the full rebuild once enough edits have piled up.
+      unsigned threshold = std::max(MIN_EDITS_BEFORE_REBALANCE, unsigned(float(mKDTree->size()) * mRebalanceThreshold));
+      if (mKDTreeEdits >= threshold)
+      {
+         Optimize();
+      }
+   }
+
    /////////////////////////////////////////////////////////////////////////////
    void DeltaAIInterface::Optimize()
    {
       mKDTree->optimize();
-      mKDTreeDirty = false;
+      mKDTreeEdits = 0U;
    }
 }
@@ -0,0 +1,325 @@
+/*
+ * Delta3D Open Source Game and Simulation Engine
+ * Copyright (C) 2014, Caper Holdings, LLC
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include <dtAI/pathrequestqueue.h>
+#include <dtAI/waypointgraphastar.h>
+#include <dtUtil/threadpool.h>
+
+#include <OpenThreads/Atomic>
+
+#include <algorithm>
+#include <map>
+
+namespace dtAI
+{
+   namespace
+   {
+      // Fewer searches than this per thread aren't worth the overhead of the thread pool.
+      const size_t MIN_SEARCHES_PER_TASK = 4;
+
+      /// One search, and all the requests in the update that want its result.
+      struct PathSearch
+      {
+         PathSearch(WaypointID from, WaypointID to, bool hierarchical)
+            : mFrom(from)
+            , mTo(to)
+            , mHierarchical(hierarchical)
+            , mResult(NO_PATH)
+         {
+         }
+
+         WaypointID mFrom;
+         WaypointID mTo;
+         bool mHierarchical;
+         PathFindResult mResult;
+         WaypointGraph::ConstWaypointArray mPath;
+         std::vector<PathRequest*> mRequests;
+      };
+
+      /////////////////////////////////////////////////////////////////////////////
+      /// Runs a contiguous range of the searches of an update on a worker thread.
+      class PathSearchTask : public dtUtil::ThreadPoolTask
+      {
+      public:
+         PathSearchTask(WaypointGraph& graph, AbstractPathCache* cache, std::vector<PathSearch>& searches, size_t begin, size_t end)
+            : mAStar(graph)
+            , mSearches(searches)
+            , mBegin(begin)
+            , mEnd(end)
+         {
+            SetName("Path Search");
+            mAStar.SetPathCache(cache);
+         }
+
+         /*override*/ void operator()()
+         {
+            if (Claim())
+            {
+               Run();
+            }
+         }
+
+         /// @return true for the first caller only, which must then Run the task.
+         bool Claim()
+         {
+            return mClaimed.exchange(1U) == 0U;
+         }
+
+         void Run()
+         {
+            for (size_t i = mBegin; i < mEnd; ++i)
+            {
+               PathSearch& search = mSearches[i];
+               if (search.mHierarchical)
+               {
+                  search.mResult = mAStar.HierarchicalFindPath(search.mFrom, search.mTo, search.mPath);
+               }
+               else
+               {
+                  search.mResult = mAStar.FindSingleLevelPath(search.mFrom, search.mTo, search.mPath);
+               }
+            }
+         }
+
+      protected:
+         virtual ~PathSearchTask() {}
+
+      private:
+         WaypointGraphAStar mAStar;
+         std::vector<PathSearch>& mSearches;
+         size_t mBegin, mEnd;
+         OpenThreads::Atomic mClaimed;
+      };
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   PathRequest::PathRequest(WaypointID from, WaypointID to, bool hierarchical, CompleteCallback callback)
+      : mFrom(from)
+      , mTo(to)
+      , mHierarchical(hierarchical)
+      , mCallback(callback)
+      , mStatus(PENDING)
+      , mResult(NO_PATH)
+   {
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   PathRequest::~PathRequest()
+   {
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void PathRequest::Cancel()
+   {
+      if (mStatus == PENDING)
+      {
+         mStatus = CANCELLED;
+      }
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   PathRequestQueue::PathRequestQueue(WaypointGraph& graph, AbstractPathCache* cache)
+      : mGraph(graph)
+      , mCache(cache)
+      , mMaxSearchesPerUpdate(DEFAULT_MAX_SEARCHES_PER_UPDATE)
+   {
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   PathRequestQueue::~PathRequestQueue()
+   {
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   dtCore::RefPtr<PathRequest> PathRequestQueue::RequestPath(WaypointID from, WaypointID to, bool hierarchical,
+            PathRequest::CompleteCallback callback)
+   {
+      dtCore::RefPtr<PathRequest> request = new PathRequest(from, to, hierarchical, callback);
+      mPending.push_back(request);
+      return request;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void PathRequestQueue::RequestPaths(const WaypointIDPairArray& fromTo, PathRequestArray& requestsOut, bool hierarchical,
+            PathRequest::CompleteCallback callback)
+   {
+      requestsOut.reserve(requestsOut.size() + fromTo.size());
+      for (WaypointIDPairArray::const_iterator i = fromTo.begin(); i != fromTo.end(); ++i)
+      {
+         requestsOut.push_back(RequestPath(i->first, i->second, hierarchical, callback));
+      }
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   unsigned PathRequestQueue::Update()
+   {
+      return RunSearches(mMaxSearchesPerUpdate);
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void PathRequestQueue::Flush()
+   {
+      while (!mPending.empty())
+      {
+         RunSearches(0U);
+      }
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   unsigned PathRequestQueue::RunSearches(unsigned maxSearches)
+   {
+      // Take requests off the front until a new search would go over the limit.
+      std::vector<PathSearch> searches;
+      typedef std::map<std::pair<std::pair<WaypointID, WaypointID>, bool>, size_t> SearchIndex;
+      SearchIndex searchIndex;
+      PathRequestArray requests;
+
+      while (!mPending.empty())
+      {
+         PathRequest& request = *mPending.front();
+         if (request.GetStatus() == PathRequest::CANCELLED)
+         {
+            mPending.pop_front();
+            continue;
+         }
+
+         SearchIndex::key_type key(std::make_pair(request.mFrom, request.mTo), request.mHierarchical);
+         SearchIndex::iterator found = searchIndex.find(key);
+         if (found == searchIndex.end())
+         {
+            if (maxSearches > 0U && searches.size() >= maxSearches)
+            {
+               break;
+            }
+            found = searchIndex.insert(std::make_pair(key, searches.size())).first;
+            searches.push_back(PathSearch(request.mFrom, request.mTo, request.mHierarchical));
+         }
+         searches[found->second].mRequests.push_back(&request);
+
+         // Holding the requests keeps the pointers in the searches good.
+         requests.push_back(&request);
+         mPending.pop_front();
+      }
+
+      if (searches.empty())
+      {
+         return 0U;
+      }
+
+      size_t numTasks = 1;
+      if (dtUtil::ThreadPool::IsInitialized())
+      {
+         numTasks = std::min(size_t(dtUtil::ThreadPool::GetNumImmediateWorkerThreads()),
+                  searches.size() / MIN_SEARCHES_PER_TASK);
+      }
+
+      if (numTasks <= 1)
+      {
+         dtCore::RefPtr<PathSearchTask> task = new PathSearchTask(mGraph, mCache.get(), searches, 0, searches.size());
+         task->Run();
+      }
+      else
+      {
+         std::vector<dtCore::RefPtr<PathSearchTask> > tasks;
+         tasks.reserve(numTasks);
+         size_t chunk = searches.size() / numTasks;
+         for (size_t i = 0; i < numTasks; ++i)
+         {
+            size_t begin = i * chunk;
+            size_t end = (i + 1 == numTasks) ? searches.size() : begin + chunk;
+            tasks.push_back(new PathSearchTask(mGraph, mCache.get(), searches, begin, end));
+            if (i > 0)
+            {
+               dtUtil::ThreadPool::AddTask(*tasks.back());
+            }
+         }
+
+         // This thread runs the first range, then any a worker hasn't started yet.  ExecuteTasks isn't used,
+         // because it would also run, and wait on, every other IMMEDIATE task in the pool.
+         tasks[0]->Run();
+         std::vector<bool> runByWorker(numTasks, false);
+         for (size_t i = 1; i < numTasks; ++i)
+         {
+            if (tasks[i]->Claim())
+            {
+               tasks[i]->Run();
+            }
+            else
+            {
+               runByWorker[i] = true;
+            }
+         }
+
+         // A task run here stays queued until a worker drops it, so only the ones a worker claimed are waited on.
+         for (size_t i = 1; i < numTasks; ++i)
+         {
+            if (runByWorker[i])
+            {
+               tasks[i]->WaitUntilComplete();
+            }
+         }
+      }
+
+      unsigned numCompleted = 0U;
+      for (std::vector<PathSearch>::iterator search = searches.begin(); search != searches.end(); ++search)
+      {
+         for (std::vector<PathRequest*>::iterator i = search->mRequests.begin(); i != search->mRequests.end(); ++i)
+         {
+            PathRequest& request = **i;
+            request.mResult = search->mResult;
+            request.mPath = search->mPath;
+            request.mStatus = PathRequest::COMPLETE;
+            ++numCompleted;
+            if (request.mCallback.valid())
+            {
+               request.mCallback(request);
+            }
+         }
+      }
+      return numCompleted;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void PathRequestQueue::SetMaxSearchesPerUpdate(unsigned maxSearches)
+   {
+      mMaxSearchesPerUpdate = maxSearches;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   unsigned PathRequestQueue::GetMaxSearchesPerUpdate() const
+   {
+      return mMaxSearchesPerUpdate;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   size_t PathRequestQueue::GetNumPending() const
+   {
+      return mPending.size();
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void PathRequestQueue::Clear()
+   {
+      for (size_t i = 0; i < mPending.size(); ++i)
+      {
+         mPending[i]->Cancel();
+      }
+      mPending.clear();
+   }
+}
@@ -80,6 +80,7 @@ namespace dtAI
 
       /////////////////////////////////////////////////////////////////////////////
       WaypointGraphImpl()
+         : mRevision(0U)
       {
       }
 
@@ -429,6 +430,7 @@ namespace dtAI
 
       WaypointMap mWaypointOwnership;
       WaypointGraph::SearchLevelArray mSearchLevels;
+      unsigned mRevision;
    };
 
 
@@ -455,6 +457,7 @@ namespace dtAI
    /////////////////////////////////////////////////////////////////////////////
    void WaypointGraph::Clear()
    {
+      MarkChanged();
       OnClear();
    }
 
@@ -464,9 +467,22 @@ namespace dtAI
       mImpl->CleanUp();
    }
 
+   /////////////////////////////////////////////////////////////////////////////
+   unsigned WaypointGraph::GetRevision() const
+   {
+      return mImpl->mRevision;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void WaypointGraph::MarkChanged()
+   {
+      ++mImpl->mRevision;
+   }
+
    /////////////////////////////////////////////////////////////////////////////
    void WaypointGraph::CreateSearchGraph(WaypointGraphBuilder* builder, unsigned maxLevels)
    {
+      MarkChanged();
       bool success = true;
       for(unsigned i = 1; i < maxLevels && success; ++i)
       {
@@ -477,6 +493,7 @@ namespace dtAI
    /////////////////////////////////////////////////////////////////////////////
    bool WaypointGraph::CreateSearchLevel(WaypointGraphBuilder* builder, unsigned level)
    {
+      MarkChanged();
       if(level > 0)
       {
          return builder->CreateNextSearchLevel(mImpl->GetSearchLevel(level - 1));
@@ -492,6 +509,7 @@ namespace dtAI
    /////////////////////////////////////////////////////////////////////////////
    void WaypointGraph::InsertWaypoint(WaypointInterface* waypoint)
    {
+      MarkChanged();
       if(!Contains(waypoint->GetID()))
       {
          if(waypoint->GetWaypointType() == *WaypointTypes::WAYPOINT_COLLECTION)
@@ -530,6 +548,7 @@ namespace dtAI
    /////////////////////////////////////////////////////////////////////////////
    void WaypointGraph::InsertCollection(WaypointCollection* waypoint, unsigned level)
    {
+      MarkChanged();
       if(!Contains(waypoint->GetID()))
       {
          mImpl->InsertCollection(waypoint, level);
@@ -539,6 +558,7 @@ namespace dtAI
    /////////////////////////////////////////////////////////////////////////////
    void WaypointGraph::RemoveWaypoint(WaypointID waypoint)
    {
+      MarkChanged();
       const WaypointInterface* wpPtr = FindWaypoint(waypoint);
 
       if(wpPtr != NULL)
@@ -663,6 +683,7 @@ namespace dtAI
    /////////////////////////////////////////////////////////////////////////////
    void WaypointGraph::AddEdge(WaypointID pFrom, const WaypointID pTo)
    {
+      MarkChanged();
       const WaypointInterface* wpLhs = FindWaypoint(pFrom);
       const WaypointInterface* wpRhs = FindWaypoint(pTo);
 
@@ -702,6 +723,7 @@ namespace dtAI
    /////////////////////////////////////////////////////////////////////////////
    bool WaypointGraph::RemoveEdge(WaypointID wayFrom, WaypointID wayTo)
    {
+      MarkChanged();
       const WaypointInterface* wpLhs = FindWaypoint(wayFrom);
       const WaypointInterface* wpRhs = FindWaypoint(wayTo);
 
@@ -737,6 +759,7 @@ namespace dtAI
    /////////////////////////////////////////////////////////////////////////////
    void WaypointGraph::RemoveAllEdgesFromWaypoint(WaypointID pFrom)
    {
+      MarkChanged();
       const WaypointInterface* wpFrom = FindWaypoint(pFrom);
 
       if(wpFrom != NULL)
@@ -1003,6 +1026,7 @@ namespace dtAI
    /////////////////////////////////////////////////////////////////////////////
    bool WaypointGraph::Assign(WaypointID childWp, WaypointCollection* parentWp)
    {
+      MarkChanged();
       WaypointID parentID = parentWp->GetID();
 
       WaypointGraphImpl::WaypointMap::iterator iter = mImpl->mWaypointOwnership.find(childWp);
@@ -1082,6 +1106,7 @@ namespace dtAI
 
    void WaypointGraph::CreateAbstractEdges()
    {
+      MarkChanged();
       unsigned numLevels = GetNumSearchLevels();
 
       //we skip the first level since these are user generated
@@ -1093,6 +1118,7 @@ namespace dtAI
 
    void WaypointGraph::CreateAbstractEdgesAtLevel(unsigned level)
    {
+      MarkChanged();
       if(level > 0 && level < GetNumSearchLevels())
       {
          SearchLevel* slLast = GetSearchLevel(level - 1);
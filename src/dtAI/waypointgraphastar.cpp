@@ -21,11 +21,90 @@
 
 
 #include <dtAI/waypointgraphastar.h>
+#include <OpenThreads/ScopedLock>
 #include <iterator>
 
 
 namespace dtAI
 {
+   /////////////////////////////////////////////////////////////////////////////
+   AbstractPathCache::AbstractPathCache()
+      : mRevision(0U)
+      , mHits(0U)
+      , mMisses(0U)
+   {
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   AbstractPathCache::~AbstractPathCache()
+   {
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void AbstractPathCache::CheckRevision(const WaypointGraph& graph)
+   {
+      if (graph.GetRevision() != mRevision)
+      {
+         mPaths.clear();
+         mRevision = graph.GetRevision();
+      }
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   bool AbstractPathCache::Find(const WaypointGraph& graph, WaypointID from, WaypointID to, WaypointGraph::ConstWaypointArray& path)
+   {
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+      CheckRevision(graph);
+
+      PathMap::const_iterator found = mPaths.find(std::make_pair(from, to));
+      if (found == mPaths.end())
+      {
+         ++mMisses;
+         return false;
+      }
+
+      ++mHits;
+      path = found->second;
+      return true;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void AbstractPathCache::Store(const WaypointGraph& graph, WaypointID from, WaypointID to, const WaypointGraph::ConstWaypointArray& path)
+   {
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+      CheckRevision(graph);
+      mPaths[std::make_pair(from, to)] = path;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void AbstractPathCache::Clear()
+   {
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+      mPaths.clear();
+      mHits = 0U;
+      mMisses = 0U;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   size_t AbstractPathCache::GetNumPaths() const
+   {
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+      return mPaths.size();
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   unsigned AbstractPathCache::GetNumHits() const
+   {
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+      return mHits;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   unsigned AbstractPathCache::GetNumMisses() const
+   {
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+      return mMisses;
+   }
 
 
    WaypointGraphAStar::WaypointGraphAStar(WaypointGraph& wpGraph)
@@ -55,6 +134,16 @@ namespace dtAI
       return wgn;
    }
 
+   void WaypointGraphAStar::SetPathCache(AbstractPathCache* cache)
+   {
+      mPathCache = cache;
+   }
+
+   AbstractPathCache* WaypointGraphAStar::GetPathCache()
+   {
+      return mPathCache.get();
+   }
+
    PathFindResult WaypointGraphAStar::HierarchicalFindPath(WaypointID from, WaypointID to, WaypointGraph::ConstWaypointArray& result)
    {
       const WaypointInterface* fromWP = mWPGraph.FindWaypoint(from);
@@ -106,6 +195,11 @@ namespace dtAI
          lhs.pop_back();
          rhs.pop_back();
 
+         if (mPathCache.valid() && mPathCache->Find(mWPGraph, lhsCurNode->GetID(), rhsCurNode->GetID(), lastPath))
+         {
+            return HierarchicalFindPath(from, to, lhs, rhs, lastPath);
+         }
+
          mSearchSpace->Clear();
          CreateSearchSpace(lastPath, *mSearchSpace);
 
@@ -114,6 +208,11 @@ namespace dtAI
 
          result = FindSingleLevelPath(lhsCurNode, rhsCurNode, lastPath);
 
+         if (result == PATH_FOUND && mPathCache.valid())
+         {
+            mPathCache->Store(mWPGraph, lhsCurNode->GetID(), rhsCurNode->GetID(), lastPath);
+         }
+
          if(result == PATH_FOUND)
          {
             //call recursively until no nodes are left... 
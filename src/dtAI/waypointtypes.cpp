@@ -41,6 +41,18 @@ namespace dtAI
 
    /////////////////////////////////////////////////////////////////////////////
    //NamedWaypoint
+   /////////////////////////////////////////////////////////////////////////////
+   namespace
+   {
+      unsigned gNameGeneration = 0U;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   unsigned NamedWaypoint::GetNameGeneration()
+   {
+      return gNameGeneration;
+   }
+
    /////////////////////////////////////////////////////////////////////////////
    NamedWaypoint::NamedWaypoint()
       : BaseClass(WaypointTypes::NAMED_WAYPOINT.get())
@@ -118,7 +130,11 @@ namespace dtAI
    /////////////////////////////////////////////////////////////////////////////
    void NamedWaypoint::SetName(const std::string& name)
    {
-      mName = name;
+      if (name != mName.Get())
+      {
+         mName = name;
+         ++gNameGeneration;
+      }
    }
 
    /////////////////////////////////////////////////////////////////////////////
@@ -81,6 +81,11 @@ namespace dtActors
          dtCore::BooleanActorProperty::GetFuncType(draw, &dtCore::Object::GetGenerateTangents),
          "If the loading process should re-center the geometry to make the origin the center of the bounding box.", GROUPNAME));
 
+      AddProperty(new dtCore::BooleanActorProperty("LoadAsynchronously", "Load Asynchronously",
+         dtCore::BooleanActorProperty::SetFuncType(draw, &dtCore::Object::SetLoadAsynchronously),
+         dtCore::BooleanActorProperty::GetFuncType(draw, &dtCore::Object::GetLoadAsynchronously),
+         "If the mesh should be loaded on a background thread so adding the actor doesn't stall the frame.", GROUPNAME));
+
       AddProperty(new dtCore::Vec3ActorProperty("Scale", "Scale",
          dtCore::Vec3ActorProperty::SetFuncType(draw, &dtCore::Object::SetScale),
          dtCore::Vec3ActorProperty::GetFuncType(draw, &dtCore::Object::GetScale),
@@ -80,6 +80,7 @@
 
 #include <osgViewer/GraphicsWindow>
 
+#include <algorithm>
 #include <iostream>
 #include <cmath>
 
@@ -294,6 +295,9 @@ namespace dtActors
    {
       SetName("WaterGridActor"); // Set a default name
 
+      // Start with every wave off so height queries before the first frame are flat.
+      DetermineCurrentWaveSet();
+
       // Add a callback to the camera this can set uniforms on each camera.
       dtCore::Camera::AddCameraSyncCallback(*this,
          dtCore::Camera::CameraSyncCallback(this, &WaterGridActor::UpdateViewMatrix));
@@ -382,21 +386,37 @@ namespace dtActors
       WaterGridBuilder::BuildTextureWaves(mTextureWaves);
    }
 
+   namespace
+   {
+      /// How much the spacing of the grid vertices flattens the short waves.
+      float GetWaveDetailScalar()
+      {
+         float cameraHeight = 10.0;//std::max(0.1f, std::abs(mCurrentCameraPos.z() - float(GetWaterHeight())));
+
+         float scalar = std::min(10.0f, std::log(cameraHeight/20.0f + 1.0f)) + std::min(10.0f, std::max(0.0f, (cameraHeight-10.0f))/50.0f);
+         return 1.15f * std::max(1.1f, scalar);
+      }
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   const osg::Vec3& WaterGridActor::GetHeightQueryCenter() const
+   {
+      return mUseQueryReferencePosition ? mQueryReferencePosition : mCurrentCameraPos;
+   }
+
    /////////////////////////////////////////////////////////////////////////////
    bool WaterGridActor::GetHeightAndNormalAtPoint(const osg::Vec3& detectionPoint,
                                                   float& outHeight, osg::Vec3& outNormal) const
    {
+      const osg::Vec3& center = GetHeightQueryCenter();
       osg::Vec2 point2d(detectionPoint.x(), detectionPoint.y());
-      osg::Vec2 cameraPos2d(mCurrentCameraPos.x(), mCurrentCameraPos.y());
+      osg::Vec2 cameraPos2d(center.x(), center.y());
 
       float distanceToCamera = (point2d - cameraPos2d).length();
 
       float distBetweenVerts = dtUtil::MapRangeValue(distanceToCamera, 0.0f, mComputedRadialDistance, 2.0f * mNearDistanceBetweenVerts, mFarDistanceBetweenVerts);
 
-      float cameraHeight = 10.0;//std::max(0.1f, std::abs(mCurrentCameraPos.z() - float(GetWaterHeight())));
-
-      float scalar = std::min(10.0f, std::log(cameraHeight/20.0f + 1.0f)) + std::min(10.0f, std::max(0.0f, (cameraHeight-10.0f))/50.0f);
-      scalar = 1.15f * std::max(1.1f, scalar);
+      float scalar = GetWaveDetailScalar();
 
       float distBetweenVertsScalar = 10.0 + (distBetweenVerts * scalar);
       
@@ -408,7 +428,7 @@ namespace dtActors
          float yPos = detectionPoint[1];
 
          // There are 2 vec4's of data per wave, so the loop is MAX_WAVES * 2 but increments by 2's
-         for(int i = 0; i < 16/*MAX_WAVES*/; i++)
+         for(int i = 0; i < MAX_HEIGHT_QUERY_WAVES; i++)
          {
             // Order is: waveLength, speed, amp, freq, UNUSED, UNUSED, dirX, dirY
             float waveLen = mProcessedWaveData[i][0]; //waveArray[i].x;
@@ -438,13 +458,149 @@ namespace dtActors
       return true;
    }
 
+   /////////////////////////////////////////////////////////////////////////////
+   void WaterGridActor::GetHeightsAndNormalsAtPoints(const osg::Vec3* points, unsigned numPoints,
+                                                     float* outHeights, osg::Vec3* outNormals) const
+   {
+      static const unsigned BLOCK_SIZE = 64;
+
+      const HeightQueryWaves& waves = mHeightQueryWaves;
+      const osg::Vec3& center = GetHeightQueryCenter();
+      const float centerX = center.x();
+      const float centerY = center.y();
+      const float nearDistBetweenVerts = 2.0f * mNearDistanceBetweenVerts;
+      const float waterHeight = GetWaterHeight();
+
+      // The points of one block, split into arrays so each wave runs down them in a straight loop.
+      float xPos[BLOCK_SIZE];
+      float yPos[BLOCK_SIZE];
+      float distBetweenVertsScalar[BLOCK_SIZE];
+      float heights[BLOCK_SIZE];
+
+      for (unsigned start = 0; start < numPoints; start += BLOCK_SIZE)
+      {
+         const unsigned count = std::min(BLOCK_SIZE, numPoints - start);
+
+         for (unsigned i = 0; i < count; ++i)
+         {
+            const osg::Vec3& point = points[start + i];
+            xPos[i] = point.x();
+            yPos[i] = point.y();
+
+            const float dx = xPos[i] - centerX;
+            const float dy = yPos[i] - centerY;
+            const float distanceToCenter = std::sqrt(dx * dx + dy * dy);
+            const float distBetweenVerts = dtUtil::MapRangeValue(distanceToCenter, 0.0f, mComputedRadialDistance,
+               nearDistBetweenVerts, mFarDistanceBetweenVerts);
+            distBetweenVertsScalar[i] = 10.0f + distBetweenVerts * waves.mDetailScalar;
+            heights[i] = waterHeight;
+         }
+
+         for (int w = 0; w < waves.mNumWaves; ++w)
+         {
+            const float waveLen = waves.mWaveLength[w];
+            const float speedTime = waves.mSpeedTime[w];
+            const float freq = waves.mFreq[w];
+            const float amp = waves.mAmp[w];
+            const float waveDirX = waves.mDirX[w];
+            const float waveDirY = waves.mDirY[w];
+            const float* shape = &waves.mShapeTable[w][0];
+            const float tableScale = float(WAVE_SHAPE_TABLE_SIZE) / float(osg::PI * 2.0);
+
+            for (unsigned i = 0; i < count; ++i)
+            {
+               // This math MUST match GetHeightAndNormalAtPoint and water.vert, except that
+               // pow(sin) is interpolated from the wave's shape table.
+               const float scaledDownAmp = std::min(std::max(distBetweenVertsScalar[i] / waveLen, 0.0f), 0.999f);
+               const float mPlusPhi = freq * (speedTime + xPos[i] * waveDirX + waveDirY * yPos[i]);
+               const float t = mPlusPhi * tableScale;
+               const float tFloor = std::floor(t);
+               const int index = int(tFloor) & (WAVE_SHAPE_TABLE_SIZE - 1);
+               const float sinDir = shape[index] + (t - tFloor) * (shape[index + 1] - shape[index]);
+               heights[i] += amp * (1.0f - scaledDownAmp) * sinDir;
+            }
+         }
+
+         std::copy(heights, heights + count, outHeights + start);
+      }
+
+      if (outNormals != NULL)
+      {
+         std::fill(outNormals, outNormals + numPoints, osg::Vec3(0.0f, 0.0f, 1.0f));
+      }
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void WaterGridActor::GetHeightsAndNormalsAtPoints(const std::vector<osg::Vec3>& points,
+      std::vector<float>& outHeights, std::vector<osg::Vec3>& outNormals) const
+   {
+      outHeights.resize(points.size());
+      outNormals.resize(points.size());
+      if (!points.empty())
+      {
+         GetHeightsAndNormalsAtPoints(&points[0], unsigned(points.size()), &outHeights[0], &outNormals[0]);
+      }
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void WaterGridActor::UpdateHeightQueryWaves()
+   {
+      HeightQueryWaves& waves = mHeightQueryWaves;
+      waves.mNumWaves = 0;
+      waves.mDetailScalar = GetWaveDetailScalar();
+
+      for (int i = 0; i < MAX_HEIGHT_QUERY_WAVES; ++i)
+      {
+         // A wave with no amplitude adds nothing, so skip it.
+         if (mProcessedWaveData[i][2] == 0.0f)
+         {
+            continue;
+         }
+
+         const int w = waves.mNumWaves++;
+         // Order is: waveLength, speed, amp, freq, steepness, UNUSED, dirX, dirY
+         waves.mWaveLength[w] = mProcessedWaveData[i][0];
+         waves.mSpeedTime[w] = mProcessedWaveData[i][1] * mElapsedTime;
+         waves.mAmp[w] = mProcessedWaveData[i][2];
+         waves.mFreq[w] = mProcessedWaveData[i][3];
+         waves.mExponent[w] = std::max(1.5f * mProcessedWaveData[i][4], 4.00001f);
+         waves.mDirX[w] = mProcessedWaveData[i][6];
+         waves.mDirY[w] = mProcessedWaveData[i][7];
+
+         // The exponent only changes with the sea state, so the table is rarely rebuilt.
+         std::vector<float>& table = waves.mShapeTable[w];
+         if (table.empty() || waves.mShapeTableExponent[w] != waves.mExponent[w])
+         {
+            table.resize(WAVE_SHAPE_TABLE_SIZE + 1);
+            for (int s = 0; s < WAVE_SHAPE_TABLE_SIZE; ++s)
+            {
+               const double phase = osg::PI * 2.0 * double(s) / double(WAVE_SHAPE_TABLE_SIZE);
+               table[s] = float(std::pow((std::sin(phase) + 1.0) / 2.0, double(waves.mExponent[w])));
+            }
+            table[WAVE_SHAPE_TABLE_SIZE] = table[0];
+            waves.mShapeTableExponent[w] = waves.mExponent[w];
+         }
+      }
+   }
+
    /////////////////////////////////////////////////////////////////////////////
    void WaterGridActor::Update(float dt)
    {
       mDeltaTime = dt;
       mElapsedTime += dt;
 
-      dtCore::Keyboard* kb = dtABC::Application::GetInstance("Application")->GetKeyboard();
+      if (mUseQueryReferencePosition)
+      {
+         DetermineCurrentWaveSet();
+      }
+      else
+      {
+         UpdateHeightQueryWaves();
+      }
+
+      // A server has no application, and so no keyboard.
+      dtABC::Application* app = dtABC::Application::GetInstance("Application");
+      dtCore::Keyboard* kb = app != NULL ? app->GetKeyboard() : NULL;
 
       static float keyTimeOut = 0.0f;
       keyTimeOut -= dt;
@@ -873,6 +1029,12 @@ namespace dtActors
       float avgFoV = 0.5f * (camera->GetHorizontalFov() + camera->GetVerticalFov());
       mCameraFoVScalar = (75.0f / avgFoV);
 
+      DetermineCurrentWaveSet();
+   }
+
+   ////////////////////////////////////////////////////////////////////////////////
+   void WaterGridActor::DetermineCurrentWaveSet()
+   {
       int count = 0;
       //float numWaves = float(mWaves.size());
       WaveArray::iterator iter = mWaves.begin();
@@ -955,6 +1117,8 @@ namespace dtActors
             count += 2;
          }
       }
+
+      UpdateHeightQueryWaves();
    }
 
    ///////////////////////////////////////////////////////////////////////////////////////////////////
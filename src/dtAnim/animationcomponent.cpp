@@ -20,8 +20,11 @@
  */
 
 #include <dtAnim/animationcomponent.h>
+#include <dtAnim/cal3danimator.h>
+#include <dtAnim/cal3dmodelwrapper.h>
 #include <dtCore/gameevent.h>
 #include <dtCore/gameeventmanager.h>
+#include <dtCore/transform.h>
 #include <dtGame/basemessages.h>
 #include <dtGame/defaultgroundclamper.h>
 #include <dtGame/messagetype.h>
@@ -30,13 +33,101 @@
 #include <dtUtil/functor.h>
 #include <dtUtil/log.h>
 
+#include <osg/NodeCallback>
+#include <osg/Timer>
+
+#include <algorithm>
+
 namespace dtAnim
 {
 
+/////////////////////////////////////////////////////////////////////////////////
+/**
+ * Cull callback that records whether a character was drawn since it was last checked.
+ */
+class AnimationVisibilityCallback : public osg::NodeCallback
+{
+public:
+   AnimationVisibilityCallback()
+   : mDrawn(true)
+   {
+   }
+
+   virtual void operator()(osg::Node* node, osg::NodeVisitor* nv)
+   {
+      // The cull traversal only reaches this if the node is in the view frustum.
+      mDrawn = true;
+      traverse(node, nv);
+   }
+
+   void MarkDrawn()
+   {
+      mDrawn = true;
+   }
+
+   /// @return true if the node was drawn since the last call.
+   bool CheckDrawn()
+   {
+      bool drawn = mDrawn;
+      mDrawn = false;
+      return drawn;
+   }
+
+private:
+   volatile bool mDrawn;
+};
+
+/////////////////////////////////////////////////////////////////////////////////
+namespace
+{
+   const float COST_SMOOTHING = 0.25f;
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+/**
+ * Updates a share of the characters due this frame.
+ */
+class AnimationUpdateTask : public dtUtil::ThreadPoolTask
+{
+public:
+   AnimationUpdateTask()
+   : mEstimatedCost(0.0f)
+   {
+   }
+
+   virtual void operator()()
+   {
+      for (unsigned i = 0; i < mCharacters.size(); ++i)
+      {
+         AnimationComponent::RunScheduledUpdate(*mCharacters[i]);
+      }
+   }
+
+   std::vector<AnimationComponent::ScheduledCharacter*> mCharacters;
+   float mEstimatedCost;
+};
+
+/////////////////////////////////////////////////////////////////////////////////
+AnimationComponent::ScheduledCharacter::ScheduledCharacter()
+: mPhase(0)
+, mAccumulatedDT(0.0f)
+, mCost(0.0f)
+, mClockCost(0.0f)
+, mFullUpdate(true)
+{
+}
+
 /////////////////////////////////////////////////////////////////////////////////
 AnimationComponent::AnimationComponent(dtCore::SystemComponentType& type)
 : BaseClass(type)
+, mAnimationLODEnabled(false)
+, mFullRateAnimationDistance(50.0f)
+, mHalfRateAnimationDistance(150.0f)
+, mPoseSharingEnabled(false)
 , mGroundClamper(new dtGame::DefaultGroundClamper)
+, mPoseCache(new PoseCache)
+, mFrameCount(0)
+, mNextPhase(0)
 {
    mGroundClamper->SetHighResGroundClampingRange(0.01);
    mGroundClamper->SetLowResGroundClampingRange(0.1);
@@ -45,8 +136,15 @@ AnimationComponent::AnimationComponent(dtCore::SystemComponentType& type)
 /////////////////////////////////////////////////////////////////////////////////
 AnimationComponent::~AnimationComponent()
 {
+   ClearSchedule();
 }
 
+/////////////////////////////////////////////////////////////////////////////////
+DT_IMPLEMENT_ACCESSOR(AnimationComponent, bool, AnimationLODEnabled);
+DT_IMPLEMENT_ACCESSOR(AnimationComponent, float, FullRateAnimationDistance);
+DT_IMPLEMENT_ACCESSOR(AnimationComponent, float, HalfRateAnimationDistance);
+DT_IMPLEMENT_ACCESSOR_WITH_STATEMENT(AnimationComponent, bool, PoseSharingEnabled, if (!value) { mPoseCache->Clear(); });
+
 /////////////////////////////////////////////////////////////////////////////////
 void AnimationComponent::ProcessMessage(const dtGame::Message& message)
 {
@@ -62,6 +160,7 @@ void AnimationComponent::ProcessMessage(const dtGame::Message& message)
    else if (message.GetMessageType() == dtGame::MessageType::INFO_MAP_UNLOADED)
    {
       SetTerrainActor(NULL);
+      ClearSchedule();
    }
 }
 
@@ -69,7 +168,7 @@ void AnimationComponent::ProcessMessage(const dtGame::Message& message)
 /////////////////////////////////////////////////////////////////////////////////
 void AnimationComponent::TickLocal(float dt)
 {
-   BaseClass::TickLocal(dt);
+   UpdateCharacters(dt);
 
    if (mGroundClamper->GetTerrainActor() != NULL)
    {
@@ -89,6 +188,15 @@ bool AnimationComponent::RegisterActor(dtGame::GameActorProxy& actor, dtAnim::An
       // when any animatable reaches a particular state.
       AnimEventCallback callback(this, &AnimationComponent::OnAnimationEvent);
       helper.SetSendEventCallback(callback);
+
+      // The attachments are updated after the parallel update, see UpdateCharacters.
+      helper.SetDeferAttachmentUpdate(true);
+
+      ScheduledCharacter& character = mSchedule[actor.GetId()];
+      character.mHelper = &helper;
+      character.mDrawable = actor.GetDrawable<dtCore::Transformable>();
+      character.mVisibility = new AnimationVisibilityCallback;
+      character.mPhase = mNextPhase++;
    }
    return result;
 }
@@ -101,9 +209,257 @@ bool AnimationComponent::UnregisterActor(const dtCore::UniqueId& actorId)
    {
       actorComp->SetSendEventCallback(AnimEventCallback());
    }
+
+   ScheduleMap::iterator found = mSchedule.find(actorId);
+   if (found != mSchedule.end())
+   {
+      RemoveFromSchedule(found->second);
+      mSchedule.erase(found);
+   }
    return BaseClass::UnregisterActor(actorId);
 }
 
+/////////////////////////////////////////////////////////////////////////////////
+void AnimationComponent::RunScheduledUpdate(ScheduledCharacter& character)
+{
+   osg::Timer* timer = osg::Timer::instance();
+   osg::Timer_t start = timer->tick();
+
+   float* cost = NULL;
+   if (character.mFullUpdate)
+   {
+      character.mHelper->Update(character.mAccumulatedDT);
+      cost = &character.mCost;
+   }
+   else
+   {
+      character.mHelper->AdvanceClock(character.mAccumulatedDT);
+      cost = &character.mClockCost;
+   }
+   character.mAccumulatedDT = 0.0f;
+
+   float elapsed = float(timer->delta_m(start, timer->tick()));
+   *cost += (elapsed - *cost) * COST_SMOOTHING;
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+float AnimationComponent::GetEstimatedCost(const ScheduledCharacter* character)
+{
+   return character->mFullUpdate ? character->mCost : character->mClockCost;
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+bool AnimationComponent::CostlierThan(const ScheduledCharacter* a, const ScheduledCharacter* b)
+{
+   return GetEstimatedCost(a) > GetEstimatedCost(b);
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+unsigned AnimationComponent::GetAnimationUpdateInterval(float distance) const
+{
+   if (distance < mFullRateAnimationDistance)
+   {
+      return 1;
+   }
+   else if (distance < mHalfRateAnimationDistance)
+   {
+      return 2;
+   }
+   return 4;
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+void AnimationComponent::UpdateCharacters(float dt)
+{
+   ++mFrameCount;
+
+   if (mPoseSharingEnabled)
+   {
+      mPoseCache->AdvanceFrame();
+   }
+
+   osg::Vec3 eyePoint;
+   bool useDistance = false;
+   if (mAnimationLODEnabled && GetEyePointActor() != NULL)
+   {
+      dtCore::Transform xform;
+      GetEyePointActor()->GetTransform(xform);
+      xform.GetTranslation(eyePoint);
+      useDistance = true;
+   }
+
+   // Pick the characters whose turn it is.
+   mDueCharacters.clear();
+   float totalCost = 0.0f;
+   ScheduleMap::iterator i, iend;
+   for (i = mSchedule.begin(), iend = mSchedule.end(); i != iend; ++i)
+   {
+      ScheduledCharacter& character = i->second;
+      character.mAccumulatedDT += dt;
+      character.mFullUpdate = true;
+      AssignPoseCache(character, mPoseSharingEnabled);
+
+      unsigned interval = 1;
+      if (mAnimationLODEnabled && character.mHelper->GetNode() != NULL)
+      {
+         WatchVisibility(character);
+         if (!character.mVisibility->CheckDrawn())
+         {
+            character.mFullUpdate = false;
+            interval = 4;
+         }
+         else if (useDistance && character.mDrawable.valid())
+         {
+            dtCore::Transform xform;
+            character.mDrawable->GetTransform(xform);
+            osg::Vec3 pos;
+            xform.GetTranslation(pos);
+            interval = GetAnimationUpdateInterval((pos - eyePoint).length());
+         }
+      }
+
+      if ((mFrameCount + character.mPhase) % interval == 0)
+      {
+         mDueCharacters.push_back(&character);
+         totalCost += GetEstimatedCost(&character);
+      }
+   }
+
+   unsigned numTasks = 1;
+   if (dtUtil::ThreadPool::IsInitialized())
+   {
+      // The calling thread works on the tasks too.
+      numTasks = std::min(unsigned(mDueCharacters.size()), dtUtil::ThreadPool::GetNumImmediateWorkerThreads() + 1);
+   }
+
+   if (numTasks > 1)
+   {
+      // Hand out the most expensive characters first, each to the least loaded task.  Characters that
+      // have not been measured yet cost nothing, so they fill in wherever the load is lowest.
+      std::sort(mDueCharacters.begin(), mDueCharacters.end(), CostlierThan);
+
+      if (mUpdateTasks.size() < numTasks)
+      {
+         mUpdateTasks.reserve(numTasks);
+         while (mUpdateTasks.size() < numTasks)
+         {
+            mUpdateTasks.push_back(new AnimationUpdateTask);
+         }
+      }
+
+      for (unsigned t = 0; t < numTasks; ++t)
+      {
+         mUpdateTasks[t]->mCharacters.clear();
+         mUpdateTasks[t]->mEstimatedCost = 0.0f;
+      }
+
+      for (unsigned c = 0; c < mDueCharacters.size(); ++c)
+      {
+         AnimationUpdateTask* leastLoaded = mUpdateTasks[0].get();
+         for (unsigned t = 1; t < numTasks; ++t)
+         {
+            if (mUpdateTasks[t]->mEstimatedCost < leastLoaded->mEstimatedCost ||
+               (mUpdateTasks[t]->mEstimatedCost == leastLoaded->mEstimatedCost &&
+                  mUpdateTasks[t]->mCharacters.size() < leastLoaded->mCharacters.size()))
+            {
+               leastLoaded = mUpdateTasks[t].get();
+            }
+         }
+         leastLoaded->mCharacters.push_back(mDueCharacters[c]);
+         leastLoaded->mEstimatedCost += GetEstimatedCost(mDueCharacters[c]);
+      }
+
+      for (unsigned t = 0; t < numTasks; ++t)
+      {
+         if (!mUpdateTasks[t]->mCharacters.empty())
+         {
+            dtUtil::ThreadPool::AddTask(*mUpdateTasks[t]);
+         }
+      }
+      dtUtil::ThreadPool::ExecuteTasks();
+   }
+   else
+   {
+      for (unsigned c = 0; c < mDueCharacters.size(); ++c)
+      {
+         RunScheduledUpdate(*mDueCharacters[c]);
+      }
+   }
+
+   // Attachments move other drawables, so they are committed here rather than on the workers.
+   for (unsigned c = 0; c < mDueCharacters.size(); ++c)
+   {
+      if (mDueCharacters[c]->mFullUpdate)
+      {
+         mDueCharacters[c]->mHelper->UpdateAttachments();
+      }
+   }
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+void AnimationComponent::WatchVisibility(ScheduledCharacter& character)
+{
+   osg::Node* node = character.mHelper->GetNode();
+   if (node != character.mWatchedNode.get())
+   {
+      if (character.mWatchedNode.valid())
+      {
+         character.mWatchedNode->removeCullCallback(character.mVisibility.get());
+      }
+
+      node->addCullCallback(character.mVisibility.get());
+      character.mWatchedNode = node;
+      // Treat a new node as visible until it has been through a cull.
+      character.mVisibility->MarkDrawn();
+   }
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+void AnimationComponent::RemoveFromSchedule(ScheduledCharacter& character)
+{
+   if (character.mWatchedNode.valid())
+   {
+      character.mWatchedNode->removeCullCallback(character.mVisibility.get());
+      character.mWatchedNode = NULL;
+   }
+   character.mHelper->SetDeferAttachmentUpdate(false);
+   AssignPoseCache(character, false);
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+void AnimationComponent::AssignPoseCache(ScheduledCharacter& character, bool share)
+{
+   // The helper replaces its wrapper when it loads a model, so the new one is picked up here.
+   BaseModelWrapper* wrapper = share ? character.mHelper->GetModelWrapper() : NULL;
+   if (wrapper == character.mPoseCacheWrapper.get())
+   {
+      return;
+   }
+
+   Cal3DModelWrapper* oldWrapper = dynamic_cast<Cal3DModelWrapper*>(character.mPoseCacheWrapper.get());
+   if (oldWrapper != NULL && oldWrapper->GetCalAnimator() != NULL)
+   {
+      oldWrapper->GetCalAnimator()->SetPoseCache(NULL);
+   }
+
+   Cal3DModelWrapper* newWrapper = dynamic_cast<Cal3DModelWrapper*>(wrapper);
+   if (newWrapper != NULL && newWrapper->GetCalAnimator() != NULL)
+   {
+      newWrapper->GetCalAnimator()->SetPoseCache(mPoseCache.get());
+   }
+   character.mPoseCacheWrapper = wrapper;
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+void AnimationComponent::ClearSchedule()
+{
+   for (ScheduleMap::iterator i = mSchedule.begin(); i != mSchedule.end(); ++i)
+   {
+      RemoveFromSchedule(i->second);
+   }
+   mSchedule.clear();
+}
+
 
 /////////////////////////////////////////////////////////////////////////////////
 dtCore::Transformable* AnimationComponent::GetTerrainActor()
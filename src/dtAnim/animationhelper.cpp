@@ -61,11 +61,13 @@ const std::string AnimationHelper::PROPERTY_SKELETAL_MESH("Skeletal Mesh");
 AnimationHelper::AnimationHelper()
    : BaseClass(TYPE)
    , mAutoRegisterWithGMComponent(true)
+   , mDeferAttachmentUpdate(false)
    , mLoadModelAsynchronously(true)
    , mEnableAttachingNodeToDrawable(true)
    , mGroundClamp(false)
    , mEnableCommands(false)
    , mLastUpdateTime(0.0)
+   , mPendingAnimatorDT(0.0f)
    , mSequenceMixer(new SequenceMixer())
    , mAttachmentController(NULL)
 {
@@ -108,15 +110,40 @@ void AnimationHelper::Update(float dt)
          CollectCommands(mLastUpdateTime, mLastUpdateTime + dt);
 
          mSequenceMixer->Update(dt);
-         animator->Update(dt);
-         if (mAttachmentController.valid())
+         animator->Update(dt + mPendingAnimatorDT);
+         mPendingAnimatorDT = 0.0f;
+
+         if (!mDeferAttachmentUpdate)
          {
-            mAttachmentController->Update(*GetModelWrapper());
+            UpdateAttachments();
          }
       }
    }
 }
 
+/////////////////////////////////////////////////////////////////////////////////
+void AnimationHelper::AdvanceClock(float dt)
+{
+   ModelLoader::LoadingState loadingState = mModelLoader.valid() ? mModelLoader->GetLoadingState(false): ModelLoader::IDLE;
+   if (loadingState != ModelLoader::LOADING && mModelWrapper != NULL && mModelWrapper->GetAnimator() != NULL)
+   {
+      mLastUpdateTime = mSequenceMixer->GetRootSequence().GetElapsedTime();
+      CollectCommands(mLastUpdateTime, mLastUpdateTime + dt);
+
+      mSequenceMixer->Update(dt);
+      mPendingAnimatorDT += dt;
+   }
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+void AnimationHelper::UpdateAttachments()
+{
+   if (mAttachmentController.valid() && mModelWrapper.valid())
+   {
+      mAttachmentController->Update(*GetModelWrapper());
+   }
+}
+
 /////////////////////////////////////////////////////////////////////////////////
 void AnimationHelper::CheckLoadingState()
 {
@@ -186,6 +213,7 @@ void AnimationHelper::ClearAll(float fadeOut)
 
 /////////////////////////////////////////////////////////////////////////////////
 DT_IMPLEMENT_ACCESSOR(AnimationHelper, bool, LoadModelAsynchronously);
+DT_IMPLEMENT_ACCESSOR(AnimationHelper, bool, DeferAttachmentUpdate);
 /////////////////////////////////////////////////////////////////////////////////
 DT_IMPLEMENT_ACCESSOR(AnimationHelper, bool, EnableAttachingNodeToDrawable);
 /////////////////////////////////////////////////////////////////////////////////
@@ -24,6 +24,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 #include <dtAnim/basemodeldata.h>
 #include <dtAnim/animatable.h>
+#include <dtAnim/characterbundle.h>
 #include <dtUtil/fileutils.h>
 #include <dtUtil/log.h>
 #include <dtCore/project.h>
@@ -133,6 +134,19 @@
    DT_IMPLEMENT_ACCESSOR(BaseModelData, std::string, ShaderGroupName);
    DT_IMPLEMENT_ACCESSOR(BaseModelData, std::string, ShaderName);
    DT_IMPLEMENT_ACCESSOR(BaseModelData, std::string, PoseMeshFilename);
+
+   ////////////////////////////////////////////////////////////////////////////////
+   void BaseModelData::SetPoseMeshBundle(CharacterBundle* bundle)
+   {
+      mPoseMeshBundle = bundle;
+   }
+
+   ////////////////////////////////////////////////////////////////////////////////
+   CharacterBundle* BaseModelData::GetPoseMeshBundle() const
+   {
+      return mPoseMeshBundle.get();
+   }
+
    /// Sets the maximum number of bones the shader supports
    DT_IMPLEMENT_ACCESSOR(BaseModelData, unsigned, ShaderMaxBones);
 
@@ -25,6 +25,7 @@
 // DELTA3D
 #include <dtAnim/cal3danimator.h>
 #include <dtAnim/animdriver.h>
+#include <dtAnim/cal3dmodeldata.h>
 #include <dtAnim/skeletondriver.h>
 #include <dtAnim/morphdriver.h>
 #include <dtAnim/osgobjects.h>
@@ -36,6 +37,7 @@
 #include <cal3d/model.h>
 #include <cal3d/morphtargetmixer.h>
 #include <cal3d/physique.h>
+#include <cal3d/skeleton.h>
 #include <cal3d/springsystem.h>
 
 
@@ -200,10 +202,34 @@ namespace dtAnim
    {
       if(IsUpdatable())
       {
+         if (mPoseCache.valid() && mWrapper.valid())
+         {
+            Cal3DModelData* modelData = mWrapper->GetCalModelData();
+            if (modelData != NULL && mPoseCache->BuildKey(*modelData, *mMixer, mPoseKey))
+            {
+               CalSkeleton* skeleton = mCalModel->getSkeleton();
+               mCurrentPose = mPoseCache->ApplyPose(mPoseKey, *skeleton);
+               if (!mCurrentPose.valid())
+               {
+                  mMixer->updateSkeleton();
+                  mCurrentPose = mPoseCache->StorePose(mPoseKey, *skeleton);
+               }
+               return;
+            }
+         }
+
+         mCurrentPose = NULL;
          mMixer->updateSkeleton();
       }
    }
 
+   /////////////////////////////////////////////////////////////////////////////
+   void Cal3DAnimator::SetPoseCache(PoseCache* poseCache)
+   {
+      mPoseCache = poseCache;
+      mCurrentPose = NULL;
+   }
+
    /////////////////////////////////////////////////////////////////////////////
    bool Cal3DAnimator::IsUpdatable() const
    {
@@ -21,6 +21,7 @@
 #include <osgDB/FileNameUtils>
 #include <osgDB/ReadFile>
 #include <osgDB/Registry>
+#include <OpenThreads/ScopedLock>
 #include <osg/Texture2D>
 DT_DISABLE_WARNING_ALL_START
 #include <cal3d/coreanimation.h>
@@ -562,12 +563,22 @@ namespace dtAnim
       }
 
       //load skeleton
-      std::string skelFile(GetAbsolutePath(path + handler.mSkeletonFilename));
-      if (!skelFile.empty() && fileUtils.FileExists(skelFile))
+      void* bundledSkeleton = FindBundledFile(handler, CharacterBundle::ENTRY_SKELETON, handler.mSkeletonFilename);
+      std::string skelFile(bundledSkeleton != NULL ? path + handler.mSkeletonFilename : GetAbsolutePath(path + handler.mSkeletonFilename));
+      if (bundledSkeleton != NULL || (!skelFile.empty() && fileUtils.FileExists(skelFile)))
       {
-         dtCore::RefPtr<CalOptions> calOptions = new CalOptions(*modelData, "skeleton");
-         dtCore::RefPtr<osgDB::ReaderWriter::Options> options = CalOptions::CreateOSGOptions(*calOptions);
-         fileUtils.ReadObject(skelFile, options.get());
+#if defined(CAL3D_VERSION) && CAL3D_VERSION >= 1300
+         if (bundledSkeleton != NULL)
+         {
+            modelData->LoadCoreSkeletonBuffer(bundledSkeleton, skelFile, "skeleton");
+         }
+         else
+#endif
+         {
+            dtCore::RefPtr<CalOptions> calOptions = new CalOptions(*modelData, "skeleton");
+            dtCore::RefPtr<osgDB::ReaderWriter::Options> options = CalOptions::CreateOSGOptions(*calOptions);
+            fileUtils.ReadObject(skelFile, options.get());
+         }
 
          modelData->RegisterFile(skelFile, "skeleton");
 
@@ -589,13 +600,26 @@ namespace dtAnim
       std::vector<CharacterFileHandler::MeshStruct>::iterator meshItr = handler.mMeshes.begin();
       while (meshItr != handler.mMeshes.end())
       {
-         std::string filename(GetAbsolutePath(path + (*meshItr).mFileName));
+         void* bundledMesh = FindBundledFile(handler, CharacterBundle::ENTRY_MESH, (*meshItr).mFileName);
+         std::string filename(bundledMesh != NULL ? path + (*meshItr).mFileName : GetAbsolutePath(path + (*meshItr).mFileName));
          if (!filename.empty())
          {
             // Load the mesh and get its id for further error checking
-            dtCore::RefPtr<CalOptions> calOptions = new CalOptions(*modelData, (*meshItr).mName);
-            dtCore::RefPtr<osgDB::ReaderWriter::Options> options = CalOptions::CreateOSGOptions(*calOptions);
-            if (fileUtils.ReadObject(filename, options.get()) == NULL)
+            bool loaded = false;
+#if defined(CAL3D_VERSION) && CAL3D_VERSION >= 1300
+            if (bundledMesh != NULL)
+            {
+               loaded = modelData->LoadCoreMeshBuffer(bundledMesh, filename, (*meshItr).mName) >= 0;
+            }
+            else
+#endif
+            {
+               dtCore::RefPtr<CalOptions> calOptions = new CalOptions(*modelData, (*meshItr).mName);
+               dtCore::RefPtr<osgDB::ReaderWriter::Options> options = CalOptions::CreateOSGOptions(*calOptions);
+               loaded = fileUtils.ReadObject(filename, options.get()) != NULL;
+            }
+
+            if (!loaded)
             {
                LOG_ERROR("Can't load mesh '" + filename +"':" + CalError::getLastErrorDescription());
             }
@@ -630,18 +654,40 @@ namespace dtAnim
          std::vector<CharacterFileHandler::AnimationStruct>::iterator animItr = handler.mAnimations.begin();
          while (animItr != handler.mAnimations.end())
          {
-            std::string filename(GetAbsolutePath(path + (*animItr).mFileName));
+            void* bundledAnim = FindBundledFile(handler, CharacterBundle::ENTRY_ANIMATION, (*animItr).mFileName);
+            std::string filename(bundledAnim != NULL ? path + (*animItr).mFileName : GetAbsolutePath(path + (*animItr).mFileName));
             std::string animName = (*animItr).mName.empty() ? filename : (*animItr).mName;
 
             if (!filename.empty())
             {
-               dtCore::RefPtr<CalOptions> calOptions = new CalOptions(*modelData, (*animItr).mName);
-               dtCore::RefPtr<osgDB::ReaderWriter::Options> options = CalOptions::CreateOSGOptions(*calOptions);
+               // Characters load on several threads, so only hold the cache lock to look up and store.
+               cal3d::RefPtr<CalCoreAnimation> cachedAnim;
+               {
+                  OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mCacheMutex);
+                  AnimationMap::iterator cachedAnimIter = mAnimationCache.find(filename);
+                  if (cachedAnimIter != mAnimationCache.end())
+                  {
+                     cachedAnim = cachedAnimIter->second;
+                  }
+               }
 
-               AnimationMap::iterator cachedAnimIter = mAnimationCache.find(filename);
-               if (cachedAnimIter == mAnimationCache.end())
+               if (cachedAnim.get() == NULL)
                {
-                  if (fileUtils.ReadObject(filename, options.get()) != NULL)
+                  bool loaded = false;
+#if defined(CAL3D_VERSION) && CAL3D_VERSION >= 1300
+                  if (bundledAnim != NULL)
+                  {
+                     loaded = modelData->LoadCoreAnimationBuffer(bundledAnim, filename, (*animItr).mName) >= 0;
+                  }
+                  else
+#endif
+                  {
+                     dtCore::RefPtr<CalOptions> calOptions = new CalOptions(*modelData, (*animItr).mName);
+                     dtCore::RefPtr<osgDB::ReaderWriter::Options> options = CalOptions::CreateOSGOptions(*calOptions);
+                     loaded = fileUtils.ReadObject(filename, options.get()) != NULL;
+                  }
+
+                  if (loaded)
                   {
                      // Retrieve the animation we just loaded to store in the cache
                      int id = coreModel->getCoreAnimationId(animName);
@@ -650,7 +696,10 @@ namespace dtAnim
 
                      if (animToCache != NULL)
                      {
-                        mAnimationCache[filename] = cal3d::RefPtr<CalCoreAnimation>(animToCache);
+                        {
+                           OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mCacheMutex);
+                           mAnimationCache[filename] = cal3d::RefPtr<CalCoreAnimation>(animToCache);
+                        }
                         modelData->RegisterFile(filename, animName);
                      }
                   }
@@ -661,7 +710,7 @@ namespace dtAnim
                }
                else
                {
-                  int id = coreModel->addCoreAnimation(cachedAnimIter->second.get());
+                  int id = coreModel->addCoreAnimation(cachedAnim.get());
                   coreModel->addAnimationName(animName, id);
 
                   modelData->RegisterFile(filename, animName);
@@ -676,6 +725,7 @@ namespace dtAnim
 
 #if defined(CAL3D_VERSION) && CAL3D_VERSION >= 1300
          // load morph animations
+         // Cal3D can't load animated morphs from memory, so these are read from the loose files even for bundles.
          std::vector<CharacterFileHandler::MorphAnimationStruct>::iterator morphAnimItr = handler.mMorphAnimations.begin();
          while (morphAnimItr != handler.mMorphAnimations.end())
          {
@@ -705,7 +755,8 @@ namespace dtAnim
             matItr != handler.mMaterials.end();
             ++matItr)
          {
-            std::string filename(GetAbsolutePath(path + (*matItr).mFileName));
+            void* bundledMaterial = FindBundledFile(handler, CharacterBundle::ENTRY_MATERIAL, (*matItr).mFileName);
+            std::string filename(bundledMaterial != NULL ? path + (*matItr).mFileName : GetAbsolutePath(path + (*matItr).mFileName));
 
             if (filename.empty())
             {
@@ -713,9 +764,21 @@ namespace dtAnim
             }
             else
             {
-               dtCore::RefPtr<CalOptions> calOptions = new CalOptions(*modelData, (*matItr).mName);
-               dtCore::RefPtr<osgDB::ReaderWriter::Options> options = CalOptions::CreateOSGOptions(*calOptions);
-               if (fileUtils.ReadObject(filename, options.get()) == NULL)
+               bool loaded = false;
+#if defined(CAL3D_VERSION) && CAL3D_VERSION >= 1300
+               if (bundledMaterial != NULL)
+               {
+                  loaded = modelData->LoadCoreMaterialBuffer(bundledMaterial, filename, (*matItr).mName) >= 0;
+               }
+               else
+#endif
+               {
+                  dtCore::RefPtr<CalOptions> calOptions = new CalOptions(*modelData, (*matItr).mName);
+                  dtCore::RefPtr<osgDB::ReaderWriter::Options> options = CalOptions::CreateOSGOptions(*calOptions);
+                  loaded = fileUtils.ReadObject(filename, options.get()) != NULL;
+               }
+
+               if (!loaded)
                {
                   LOG_ERROR("Material file failed to load:'" + filename + "'." + CalError::getLastErrorDescription());
                }
@@ -737,6 +800,13 @@ namespace dtAnim
          if (!handler.mPoseMeshFilename.empty())
          {
             modelData->SetPoseMeshFilename(path + handler.mPoseMeshFilename);
+
+            // Pose meshes are built later, so keep the bundle if it has this one.
+            if (handler.mBundle.valid()
+               && handler.mBundle->FindEntry(CharacterBundle::ENTRY_POSE_MESH, handler.mPoseMeshFilename) != NULL)
+            {
+               modelData->SetPoseMeshBundle(handler.mBundle.get());
+            }
          }
       }
       else
@@ -922,6 +992,24 @@ namespace dtAnim
       }
    }
 
+   /////////////////////////////////////////////////////////////////////////////
+   void* Cal3dLoader::FindBundledFile(const CharacterFileHandler& handler, CharacterBundle::EntryType type, const std::string& name)
+   {
+#if defined(CAL3D_VERSION) && CAL3D_VERSION >= 1300
+      if (handler.mBundle.valid())
+      {
+         const CharacterBundle::Entry* entry = handler.mBundle->FindEntry(type, name);
+         if (entry != NULL)
+         {
+            // Cal3D takes a non-const pointer, but only reads the data.
+            return const_cast<char*>(handler.mBundle->GetData(*entry));
+         }
+      }
+#endif
+      // Older Cal3D versions can't load from memory, so they read the loose files.
+      return NULL;
+   }
+
    /////////////////////////////////////////////////////////////////////////////
    void Cal3dLoader::LoadAllTextures(CalCoreModel& coreModel, const std::string& path)
    {
@@ -940,9 +1028,17 @@ namespace dtAnim
             std::string strFilename;
             strFilename = pCoreMaterial->getMapFilename(mapId);
 
-            TextureMap::iterator textureIterator = mTextureCache.find(strFilename);
+            dtCore::RefPtr<osg::Texture2D> cachedTexture;
+            {
+               OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mCacheMutex);
+               TextureMap::iterator textureIterator = mTextureCache.find(strFilename);
+               if (textureIterator != mTextureCache.end())
+               {
+                  cachedTexture = textureIterator->second.get();
+               }
+            }
 
-            if (textureIterator == mTextureCache.end())
+            if (!cachedTexture.valid())
             {
                // load the texture from the file
                osg::Image* img = osgDB::readImageFile(path + strFilename);
@@ -957,14 +1053,17 @@ namespace dtAnim
                texture->setImage(img);
                texture->setWrap(osg::Texture::WRAP_S, osg::Texture::REPEAT);
                texture->setWrap(osg::Texture::WRAP_T, osg::Texture::REPEAT);
-               mTextureCache[strFilename] = texture;
+               {
+                  OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mCacheMutex);
+                  mTextureCache[strFilename] = texture;
+               }
 
                // store the opengl texture id in the user data of the map
                pCoreMaterial->setMapUserData(mapId, (Cal::UserData)texture);
             }
             else
             {
-               pCoreMaterial->setMapUserData(mapId, (Cal::UserData)((*textureIterator).second.get()));
+               pCoreMaterial->setMapUserData(mapId, (Cal::UserData)(cachedTexture.get()));
             }
          }
       }
@@ -1000,6 +1099,7 @@ namespace dtAnim
    {
       // Note: The texture cache has also passed pointers to corematerial userdata.
       // This may need to be cleaned up to avoid potential crashes after this function is called.
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mCacheMutex);
       mTextureCache.clear();
       mAnimationCache.clear();
    }
@@ -30,6 +30,7 @@
 #include <dtUtil/log.h>
 #include <osg/BufferObject>
 #include <osgDB/FileNameUtils>
+#include <OpenThreads/ScopedLock>
 
 DT_DISABLE_WARNING_ALL_START
 #include <cal3d/coremodel.h>
@@ -131,6 +132,19 @@ DT_DISABLE_WARNING_END
       return mHardwareModel;
    }
 
+   /////////////////////////////////////////////////////////////////////////////
+   const SoftwareSkinning::SkinnedMesh& Cal3DModelData::GetSkinnedMesh(CalCoreSubmesh& coreSubmesh)
+   {
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mSkinnedMeshMutex);
+      SkinnedMeshMap::iterator found = mSkinnedMeshes.find(&coreSubmesh);
+      if (found == mSkinnedMeshes.end())
+      {
+         found = mSkinnedMeshes.insert(std::make_pair(&coreSubmesh, SoftwareSkinning::SkinnedMesh())).first;
+         SoftwareSkinning::ExtractSubmesh(coreSubmesh, found->second);
+      }
+      return found->second;
+   }
+
    int Cal3DModelData::LoadResource(dtAnim::ModelResourceType resourceType,
       const std::string& file, const std::string& objectName)
    {
@@ -205,6 +219,11 @@ DT_DISABLE_WARNING_END
          case dtAnim::MESH_FILE:
             id = mCoreModel->getCoreMeshId(objectName);
             result = mCoreModel->unloadCoreMesh(id);
+            {
+               // The submeshes are gone, and a new mesh could reuse their addresses.
+               OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mSkinnedMeshMutex);
+               mSkinnedMeshes.clear();
+            }
             break;
 
          case dtAnim::MORPH_FILE:
@@ -650,6 +650,20 @@ namespace dtAnim
       return material;
    }
 
+   ////////////////////////////////////////////////////////////////////////////////
+   const SoftwareSkinning::BonePalette& Cal3DModelWrapper::GetSkinningPalette()
+   {
+      CalSkeleton* skeleton = mCalModel->getSkeleton();
+      const PoseCache::Pose* pose = mAnimator.valid() ? mAnimator->GetCurrentPose() : NULL;
+      if (pose != NULL)
+      {
+         return pose->GetPalette(*skeleton);
+      }
+
+      SoftwareSkinning::BuildPalette(*skeleton, mSkinningPalette);
+      return mSkinningPalette;
+   }
+
    void Cal3DModelWrapper::HandleModelResourceUpdate(dtAnim::ModelResourceType resourceType)
    {
       switch (resourceType)
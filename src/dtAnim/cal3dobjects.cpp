@@ -25,10 +25,13 @@
 #include <dtAnim/cal3dobjects.h>
 #include <dtAnim/cal3dmodelwrapper.h>
 #include <dtAnim/cal3danimator.h>
+#include <dtAnim/cal3dmodeldata.h>
+#include <dtAnim/softwareskinning.h>
 // CAL3D
 #include <cal3d/animation_action.h>
 #include <cal3d/animation_cycle.h>
 #include <cal3d/corekeyframe.h>
+#include <cal3d/coresubmesh.h>
 #include <cal3d/coretrack.h>
 #include <cal3d/mixer.h>
 #include <cal3d/submesh.h>
@@ -490,6 +493,40 @@ namespace dtAnim
    {
       return mModel->GetCalRenderer()->getTextureCoordinates(textureUnit, outData, stride);
    }
+
+   int Cal3dSubmesh::GetVerticesAndNormals(float* outVertices, float* outNormals, int stride)
+   {
+      CalCoreSubmesh* coreSubmesh = mSubmesh->getCoreSubmesh();
+      Cal3DModelData* modelData = mModel->GetCalModelData();
+
+      // Cal3D moves springs and morph targets itself.
+      bool software = modelData != NULL && !mSubmesh->hasInternalData()
+         && coreSubmesh->getSpringCount() == 0 && coreSubmesh->getCoreSubMorphTargetCount() == 0;
+
+      const SoftwareSkinning::BonePalette* palette = NULL;
+      if (software)
+      {
+         palette = &mModel->GetSkinningPalette();
+         software = !palette->empty();
+      }
+
+      if (!software)
+      {
+         int vertexCount = GetVertices(outVertices, stride);
+         if (outNormals != NULL)
+         {
+            GetNormals(outNormals, stride);
+         }
+         return vertexCount;
+      }
+
+      // The lower levels of detail use only the first vertices.
+      int vertexCount = mSubmesh->getVertexCount();
+      unsigned floatStride = stride > 0 ? unsigned(stride) / unsigned(sizeof(float)) : 3U;
+      SoftwareSkinning::SkinVertices(modelData->GetSkinnedMesh(*coreSubmesh), &(*palette)[0],
+         outVertices, outNormals, floatStride, true, unsigned(vertexCount));
+      return vertexCount;
+   }
    
    void Cal3dSubmesh::SetDrawable(dtAnim::SubmeshDrawable* drawable)
    {
@@ -0,0 +1,301 @@
+/* -*-c++-*-
+ * Delta3D Open Source Game and Simulation Engine
+ * Copyright (C) 2007, Alion Science and Technology
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include <dtAnim/characterbundle.h>
+#include <dtAnim/characterfileloader.h>
+#include <dtUtil/datastream.h>
+#include <dtUtil/exception.h>
+#include <dtUtil/log.h>
+#include <dtUtil/stringutils.h>
+
+#include <osgDB/FileNameUtils>
+
+#include <cstring>
+#include <fstream>
+#include <set>
+
+namespace dtAnim
+{
+   const std::string CharacterBundle::FILE_EXTENSION("dtcharb");
+
+   namespace
+   {
+      const char BUNDLE_MAGIC[4] = { 'D', 'T', 'C', 'B' };
+      const unsigned BUNDLE_VERSION = 1U;
+
+      /// The magic number, version, entry count and table offset.
+      const unsigned HEADER_SIZE = sizeof(BUNDLE_MAGIC) + 3 * sizeof(unsigned);
+
+      /// Each file starts on this boundary so binary Cal3D data can be read in place.
+      const unsigned DATA_ALIGNMENT = 16U;
+
+      struct FileToPack
+      {
+         CharacterBundle::EntryType mType;
+         std::string mName;
+      };
+
+      //////////////////////////////////////////////////////////////////////////
+      void AddFileToPack(std::vector<FileToPack>& files, std::set<std::string>& names,
+         CharacterBundle::EntryType type, const std::string& name)
+      {
+         // The same animation may be listed more than once, but it only needs packing once.
+         if (!name.empty() && names.insert(name).second)
+         {
+            FileToPack file;
+            file.mType = type;
+            file.mName = name;
+            files.push_back(file);
+         }
+      }
+
+      //////////////////////////////////////////////////////////////////////////
+      bool ReadWholeFile(const std::string& file, std::vector<char>& data)
+      {
+         std::ifstream stream(file.c_str(), std::ios::in | std::ios::binary);
+         if (!stream.is_open())
+         {
+            return false;
+         }
+
+         stream.seekg(0, std::ios::end);
+         std::streamoff size = stream.tellg();
+         stream.seekg(0, std::ios::beg);
+         if (size < 0)
+         {
+            return false;
+         }
+
+         data.resize(size_t(size));
+         return size == 0 || bool(stream.read(&data[0], size));
+      }
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   CharacterBundle::CharacterBundle()
+   {
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   CharacterBundle::~CharacterBundle()
+   {
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   bool CharacterBundle::Read(const std::string& file)
+   {
+      mFileName.clear();
+      mEntries.clear();
+
+      if (!ReadWholeFile(file, mData) || mData.size() < HEADER_SIZE
+         || std::memcmp(&mData[0], BUNDLE_MAGIC, sizeof(BUNDLE_MAGIC)) != 0)
+      {
+         LOG_ERROR("\"" + file + "\" is not a character bundle.");
+         mData.clear();
+         return false;
+      }
+
+      try
+      {
+         dtUtil::DataStream ds(&mData[0], unsigned(mData.size()), false);
+         ds.SetForceLittleEndian(true);
+         ds.Seekg(sizeof(BUNDLE_MAGIC), dtUtil::DataStream::SeekTypeEnum::SET);
+
+         unsigned version = 0U, numEntries = 0U, tableOffset = 0U;
+         ds >> version >> numEntries >> tableOffset;
+         if (version != BUNDLE_VERSION)
+         {
+            LOG_ERROR("Unsupported character bundle version " + dtUtil::ToString(version) + " in \"" + file + "\".");
+            mData.clear();
+            return false;
+         }
+
+         ds.Seekg(tableOffset, dtUtil::DataStream::SeekTypeEnum::SET);
+         mEntries.resize(numEntries);
+         for (unsigned i = 0; i < numEntries; ++i)
+         {
+            Entry& entry = mEntries[i];
+            unsigned type = 0U;
+            ds >> type >> entry.mName >> entry.mOffset >> entry.mSize;
+            entry.mType = EntryType(type);
+
+            // Every entry must lie before the table, NUL included.
+            if (entry.mOffset < HEADER_SIZE || entry.mOffset > tableOffset
+               || entry.mSize >= tableOffset - entry.mOffset)
+            {
+               LOG_ERROR("The character bundle \"" + file + "\" is corrupt.");
+               mEntries.clear();
+               mData.clear();
+               return false;
+            }
+         }
+      }
+      catch (const dtUtil::Exception& ex)
+      {
+         ex.LogException(dtUtil::Log::LOG_ERROR);
+         mEntries.clear();
+         mData.clear();
+         return false;
+      }
+
+      mFileName = file;
+      return true;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   const CharacterBundle::Entry* CharacterBundle::FindEntry(EntryType type, const std::string& name) const
+   {
+      for (std::vector<Entry>::const_iterator i = mEntries.begin(); i != mEntries.end(); ++i)
+      {
+         if (i->mType == type && (name.empty() || i->mName == name))
+         {
+            return &*i;
+         }
+      }
+      return NULL;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   const char* CharacterBundle::GetData(const Entry& entry) const
+   {
+      return &mData[entry.mOffset];
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   bool CharacterBundle::Compile(const std::string& characterFile, const std::string& bundleFile)
+   {
+      dtCore::RefPtr<CharacterFileLoader> loader = new CharacterFileLoader;
+      dtCore::RefPtr<CharacterFileHandler> handler = loader->LoadCharacterFile(characterFile);
+      if (!handler.valid())
+      {
+         LOG_ERROR("Unable to parse the character file \"" + characterFile + "\".");
+         return false;
+      }
+
+      std::vector<FileToPack> files;
+      std::set<std::string> names;
+
+      FileToPack characterEntry;
+      characterEntry.mType = ENTRY_CHARACTER;
+      characterEntry.mName = osgDB::getSimpleFileName(characterFile);
+      files.push_back(characterEntry);
+
+      AddFileToPack(files, names, ENTRY_SKELETON, handler->mSkeletonFilename);
+      for (size_t i = 0; i < handler->mMeshes.size(); ++i)
+      {
+         AddFileToPack(files, names, ENTRY_MESH, handler->mMeshes[i].mFileName);
+      }
+      for (size_t i = 0; i < handler->mMorphAnimations.size(); ++i)
+      {
+         AddFileToPack(files, names, ENTRY_MORPH, handler->mMorphAnimations[i].mFileName);
+      }
+      for (size_t i = 0; i < handler->mAnimations.size(); ++i)
+      {
+         AddFileToPack(files, names, ENTRY_ANIMATION, handler->mAnimations[i].mFileName);
+      }
+      for (size_t i = 0; i < handler->mMaterials.size(); ++i)
+      {
+         AddFileToPack(files, names, ENTRY_MATERIAL, handler->mMaterials[i].mFileName);
+      }
+      AddFileToPack(files, names, ENTRY_POSE_MESH, handler->mPoseMeshFilename);
+
+      // The files a character refers to are relative to its own directory.
+      std::string path(osgDB::getFilePath(characterFile));
+      path = path.empty() ? "./" : path + "/";
+
+      // The header is written last, when the table offset is known.  The offsets count it already.
+      dtUtil::DataStream body;
+      body.SetForceLittleEndian(true);
+
+      std::vector<Entry> entries;
+      std::vector<char> contents;
+      for (size_t i = 0; i < files.size(); ++i)
+      {
+         const std::string fileName = files[i].mType == ENTRY_CHARACTER ? characterFile : path + files[i].mName;
+         if (!ReadWholeFile(fileName, contents))
+         {
+            LOG_ERROR("Unable to read \"" + fileName + "\" to add it to the character bundle.");
+            return false;
+         }
+
+         unsigned offset = HEADER_SIZE + body.GetBufferSize();
+         unsigned padding = (DATA_ALIGNMENT - offset % DATA_ALIGNMENT) % DATA_ALIGNMENT;
+         body.WriteBytes(0, padding);
+
+         Entry entry;
+         entry.mType = files[i].mType;
+         entry.mName = files[i].mName;
+         entry.mOffset = offset + padding;
+         entry.mSize = unsigned(contents.size());
+         entries.push_back(entry);
+
+         if (!contents.empty())
+         {
+            body.WriteBinary(&contents[0], unsigned(contents.size()));
+         }
+         body.WriteBytes(0, 1);
+      }
+
+      const unsigned tableOffset = HEADER_SIZE + body.GetBufferSize();
+      for (std::vector<Entry>::const_iterator i = entries.begin(); i != entries.end(); ++i)
+      {
+         body << unsigned(i->mType) << i->mName << i->mOffset << i->mSize;
+      }
+
+      dtUtil::DataStream data;
+      data.SetForceLittleEndian(true);
+      data.WriteBinary(BUNDLE_MAGIC, sizeof(BUNDLE_MAGIC));
+      data << BUNDLE_VERSION << unsigned(entries.size()) << tableOffset;
+      data.AppendDataStream(body);
+
+      std::ofstream stream(bundleFile.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+      if (!stream.is_open())
+      {
+         LOG_ERROR("Unable to open \"" + bundleFile + "\" for writing.");
+         return false;
+      }
+
+      stream.write(data.GetBuffer(), data.GetBufferSize());
+      if (stream.fail())
+      {
+         LOG_ERROR("Failed writing the character bundle \"" + bundleFile + "\".");
+         return false;
+      }
+
+      return true;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   std::string CharacterBundle::GetBundleFileName(const std::string& characterFile)
+   {
+      return osgDB::getNameLessExtension(characterFile) + "." + FILE_EXTENSION;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   bool CharacterBundle::IsBundleFile(const std::string& file)
+   {
+      std::ifstream stream(file.c_str(), std::ios::in | std::ios::binary);
+      char magic[sizeof(BUNDLE_MAGIC)];
+      if (!stream.is_open() || !stream.read(magic, sizeof(magic)))
+      {
+         return false;
+      }
+      return std::memcmp(magic, BUNDLE_MAGIC, sizeof(magic)) == 0;
+   }
+}
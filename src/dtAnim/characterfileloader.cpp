@@ -33,6 +33,8 @@
 #include <dtUtil/fileutils.h>
 #include <dtUtil/xercesparser.h>
 
+#include <sstream>
+
 
 
 namespace dtAnim
@@ -210,6 +212,36 @@ namespace dtAnim
       return handler;
    }
 
+   /////////////////////////////////////////////////////////////////////////////
+   dtCore::RefPtr<CharacterFileHandler> CharacterFileLoader::LoadCharacterFile(CharacterBundle& bundle)
+   {
+      dtCore::RefPtr<CharacterFileHandler> handler;
+
+      const CharacterBundle::Entry* entry = bundle.FindEntry(CharacterBundle::ENTRY_CHARACTER, "");
+      if (entry == NULL)
+      {
+         LOG_ERROR("The character bundle \"" + bundle.GetFileName() + "\" has no character file.");
+         return handler;
+      }
+
+      osgDB::Registry* osgReg = osgDB::Registry::instance();
+      CharacterXMLReaderWriter* charPlugin = dynamic_cast<CharacterXMLReaderWriter*>
+         (osgReg->getReaderWriterForExtension(CHARACTER_FILE_EXTENSION.Get()));
+
+      // The character file is small, so copying it into a stream for the plug-in costs little.
+      std::istringstream stream(std::string(bundle.GetData(*entry), entry->mSize));
+      dtCore::RefPtr<WrapperOSGCharFileObject> resultObj = static_cast<WrapperOSGCharFileObject*>
+         (charPlugin->readObject(stream, osgReg->getOptions()).getObject());
+
+      if (resultObj.valid())
+      {
+         handler = resultObj->mHandler.get();
+         handler->mBundle = &bundle;
+      }
+
+      return handler;
+   }
+
    /////////////////////////////////////////////////////////////////////////////
    void CharacterFileLoader::CreateChannelsAndSequences(dtAnim::CharacterFileHandler& handler, dtAnim::BaseModelData& modelData)
    {
@@ -21,6 +21,7 @@
 
 #include <dtAnim/modeldatabase.h>
 #include <dtAnim/cal3dloader.h>
+#include <dtAnim/characterbundle.h>
 #include <dtAnim/constants.h>
 #include <dtUtil/fileutils.h>
 #include <dtUtil/log.h>
@@ -29,6 +30,7 @@
 #include <dtUtil/xercesparser.h>
 #include <dtCore/project.h>
 #include <osgDB/FileNameUtils>
+#include <OpenThreads/ScopedLock>
 
 
 
@@ -72,6 +74,34 @@ namespace dtAnim
       const dtCore::ResourceDescriptor& mResource;
    };
 
+   namespace
+   {
+      /////////////////////////////////////////////////////////////////////////////
+      /// Loads one character for ModelDatabase::LoadAll.
+      class LoadCharacterTask : public dtUtil::ThreadPoolTask
+      {
+      public:
+         LoadCharacterTask(ModelDatabase& database, const dtCore::ResourceDescriptor& resource)
+            : mDatabase(database)
+            , mResource(resource)
+            , mLoaded(false)
+         {
+         }
+
+         virtual void operator()()
+         {
+            mLoaded = mDatabase.Load(mResource);
+         }
+
+         bool IsLoaded() const { return mLoaded; }
+
+      private:
+         ModelDatabase& mDatabase;
+         dtCore::ResourceDescriptor mResource;
+         bool mLoaded;
+      };
+   }
+
 
 
    /////////////////////////////////////////////////////////////////////////////
@@ -169,6 +199,44 @@ namespace dtAnim
 
       return InternalLoad(resource, data);
    }
+
+   unsigned ModelDatabase::LoadAll(const std::vector<dtCore::ResourceDescriptor>& resources)
+   {
+      unsigned numLoaded = 0;
+
+      if (resources.size() < 2 || !dtUtil::ThreadPool::IsInitialized())
+      {
+         for (size_t i = 0; i < resources.size(); ++i)
+         {
+            if (Load(resources[i]))
+            {
+               ++numLoaded;
+            }
+         }
+         return numLoaded;
+      }
+
+      std::vector<dtCore::RefPtr<LoadCharacterTask> > tasks;
+      tasks.reserve(resources.size());
+      for (size_t i = 0; i < resources.size(); ++i)
+      {
+         tasks.push_back(new LoadCharacterTask(*this, resources[i]));
+         dtUtil::ThreadPool::AddTask(*tasks.back(), dtUtil::ThreadPool::IMMEDIATE);
+      }
+
+      dtUtil::ThreadPool::ExecuteTasks();
+
+      for (size_t i = 0; i < tasks.size(); ++i)
+      {
+         tasks[i]->WaitUntilComplete();
+         if (tasks[i]->IsLoaded())
+         {
+            ++numLoaded;
+         }
+      }
+
+      return numLoaded;
+   }
       
    void ModelDatabase::TruncateDatabase()
    {
@@ -240,43 +308,130 @@ namespace dtAnim
 
    bool ModelDatabase::InternalLoad(const dtCore::ResourceDescriptor& resource, dtCore::RefPtr<dtAnim::BaseModelData>& outModelData)
    {
-      // have to lock for this entire call because the load function is not thread safe
-      // plus it also prevents anyone from adding data to the cache unless they just loaded it.
-      OpenThreads::ScopedLock<OpenThreads::Mutex> lockLoad(mLoadingLock);
-
-      outModelData = Find(resource);
-
-      if (!outModelData.valid())
+      // The loading lock only covers the bookkeeping, so different characters load at the same time.
+      // A request for a character that is already loading waits for that load instead of repeating it.
+      dtCore::RefPtr<InProgressLoad> load;
+      bool loadHere = false;
       {
-         BaseModelLoader* loader = NULL;
-         dtCore::RefPtr<CharacterFileHandler> handler = mFileLoader->LoadCharacterFile(resource);
-         if (handler.valid())
+         OpenThreads::ScopedLock<OpenThreads::Mutex> lockLoad(mLoadingLock);
+
+         outModelData = Find(resource);
+         if (outModelData.valid())
          {
-            // TODO: Determine if thread safe...
-            loader = GetModelLoader(handler->GetCharacterSystemType());
+            return true;
          }
 
-         if (loader != NULL)
+         InProgressLoadMap::iterator found = mInProgressLoads.find(resource);
+         if (found == mInProgressLoads.end())
          {
-            // TODO: Determine if thread safe...
-            outModelData = loader->CreateModelData(*handler);
+            load = new InProgressLoad;
+            mInProgressLoads.insert(std::make_pair(resource, load));
+            loadHere = true;
+         }
+         else
+         {
+            load = found->second;
+         }
+      }
 
-            if (outModelData.valid())
-            {
-               // TODO: Move the channel and sequence setup out of the file loader.
-               mFileLoader->CreateChannelsAndSequences(*handler, *outModelData);
-            }
+      if (!loadHere)
+      {
+         load->mDone.block();
+         outModelData = load->mModelData;
+         return outModelData.valid();
+      }
+
+      BaseModelLoader* loader = NULL;
+      dtCore::RefPtr<CharacterFileHandler> handler = LoadCharacterFile(resource);
+      if (handler.valid())
+      {
+         loader = GetModelLoader(handler->GetCharacterSystemType());
+      }
+
+      if (loader != NULL)
+      {
+         outModelData = loader->CreateModelData(*handler);
+
+         if (outModelData.valid())
+         {
+            // TODO: Move the channel and sequence setup out of the file loader.
+            mFileLoader->CreateChannelsAndSequences(*handler, *outModelData);
          }
+      }
 
+      {
+         // Registering and finishing under the lock means a new request either finds the data or waits.
+         OpenThreads::ScopedLock<OpenThreads::Mutex> lockLoad(mLoadingLock);
          if (outModelData.valid())
          {
             RegisterModelData(*outModelData);
          }
+         load->mModelData = outModelData;
+         mInProgressLoads.erase(resource);
       }
+      load->mDone.release();
 
       return outModelData.valid();
    }
 
+   dtCore::RefPtr<CharacterFileHandler> ModelDatabase::LoadCharacterFile(const dtCore::ResourceDescriptor& resource)
+   {
+      std::string file;
+      try
+      {
+         file = dtCore::Project::GetInstance().GetResourcePath(resource);
+      }
+      catch(const dtUtil::Exception& ex)
+      {
+         ex.LogException(dtUtil::Log::LOG_ERROR, "modeldatabase.cpp");
+         return NULL;
+      }
+
+      // The character file is the source of truth, but a bundle at least as new as it loads much faster.
+      std::string bundleFile;
+      if (osgDB::getLowerCaseFileExtension(file) == CharacterBundle::FILE_EXTENSION)
+      {
+         bundleFile = file;
+      }
+      else
+      {
+         dtUtil::FileUtils& fileUtils = dtUtil::FileUtils::GetInstance();
+         std::string siblingBundle = CharacterBundle::GetBundleFileName(file);
+         dtUtil::FileInfo bundleInfo = fileUtils.GetFileInfo(siblingBundle);
+         if (bundleInfo.fileType == dtUtil::REGULAR_FILE
+            && bundleInfo.lastModified >= fileUtils.GetFileInfo(file).lastModified)
+         {
+            bundleFile = siblingBundle;
+         }
+      }
+
+      dtCore::RefPtr<CharacterFileHandler> handler;
+      if (!bundleFile.empty())
+      {
+         dtCore::RefPtr<CharacterBundle> bundle = new CharacterBundle;
+         if (bundle->Read(bundleFile))
+         {
+            handler = mFileLoader->LoadCharacterFile(*bundle);
+         }
+
+         if (handler.valid())
+         {
+            handler->mResource = resource;
+         }
+         else if (bundleFile != file)
+         {
+            LOG_WARNING("Unable to load the character bundle \"" + bundleFile + "\", loading \"" + file + "\" instead.");
+         }
+      }
+
+      if (!handler.valid())
+      {
+         handler = mFileLoader->LoadCharacterFile(resource);
+      }
+
+      return handler;
+   }
+
    dtCore::RefPtr<dtAnim::BaseModelWrapper> ModelDatabase::CreateModelWrapper(dtAnim::BaseModelData& data)
    {
       const std::string& characterSystem = data.GetCharacterSystemType();
@@ -373,7 +528,20 @@ namespace dtAnim
             // Load up the pose mesh data
             dtCore::RefPtr<dtAnim::PoseMeshDatabase> newPoseDatabase
                = new dtAnim::PoseMeshDatabase(&wrapper);
-            if (newPoseDatabase->LoadFromFile(poseMeshFile))
+
+            bool loaded = false;
+            const CharacterBundle* bundle = modelData->GetPoseMeshBundle();
+            const CharacterBundle::Entry* entry = bundle != NULL ? bundle->FindEntry(CharacterBundle::ENTRY_POSE_MESH, "") : NULL;
+            if (entry != NULL)
+            {
+               loaded = newPoseDatabase->LoadFromBuffer(bundle->GetData(*entry), entry->mSize, poseMeshFile);
+            }
+            else
+            {
+               loaded = newPoseDatabase->LoadFromFile(poseMeshFile);
+            }
+
+            if (loaded)
             {
                mPoseMeshMap.insert(std::make_pair(poseMeshFile, newPoseDatabase));
 
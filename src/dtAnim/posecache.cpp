@@ -0,0 +1,335 @@
+/* -*-c++-*-
+ * Delta3D Open Source Game and Simulation Engine
+ * Copyright (C) 2014, Caper Holdings, LLC
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include <dtAnim/posecache.h>
+#include <dtUtil/warningdisable.h>
+
+#include <OpenThreads/ScopedLock>
+
+DT_DISABLE_WARNING_ALL_START
+#include <cal3d/animation.h>
+#include <cal3d/animation_action.h>
+#include <cal3d/animation_cycle.h>
+#include <cal3d/bone.h>
+#include <cal3d/mixer.h>
+#include <cal3d/skeleton.h>
+DT_DISABLE_WARNING_END
+
+#include <cmath>
+#include <list>
+
+namespace dtAnim
+{
+   const float PoseCache::DEFAULT_TIME_QUANTUM = 1.0f / 30.0f;
+   const unsigned PoseCache::DEFAULT_MAX_AGE_FRAMES = 2U;
+   const float PoseCache::WEIGHT_QUANTUM = 1.0f / 64.0f;
+
+   namespace
+   {
+      template <typename AnimationList>
+      void AddAnimations(const AnimationList& animations, bool actions, float timeQuantum,
+         std::vector<PoseCache::Key::Entry>& entries)
+      {
+         typename AnimationList::const_iterator i, iend;
+         for (i = animations.begin(), iend = animations.end(); i != iend; ++i)
+         {
+            CalAnimation* animation = *i;
+            PoseCache::Key::Entry entry;
+            entry.mAnimation = animation->getCoreAnimation();
+            entry.mAction = actions;
+            entry.mWeight = int(animation->getWeight() / PoseCache::WEIGHT_QUANTUM + 0.5f);
+            entry.mTime = int(std::floor(animation->getTime() / timeQuantum));
+            entries.push_back(entry);
+         }
+      }
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   PoseCache::Key::Key()
+   : mModelData(NULL)
+   , mMixerTime(0)
+   {
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void PoseCache::Key::Clear()
+   {
+      // Keeps the capacity, so a key reused every frame doesn't allocate.
+      mModelData = NULL;
+      mMixerTime = 0;
+      mEntries.clear();
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   bool PoseCache::Key::operator<(const Key& other) const
+   {
+      if (mModelData != other.mModelData)
+      {
+         return mModelData < other.mModelData;
+      }
+      if (mMixerTime != other.mMixerTime)
+      {
+         return mMixerTime < other.mMixerTime;
+      }
+      if (mEntries.size() != other.mEntries.size())
+      {
+         return mEntries.size() < other.mEntries.size();
+      }
+      for (size_t i = 0; i < mEntries.size(); ++i)
+      {
+         const Entry& a = mEntries[i];
+         const Entry& b = other.mEntries[i];
+         if (a.mAnimation != b.mAnimation)
+         {
+            return a.mAnimation < b.mAnimation;
+         }
+         if (a.mAction != b.mAction)
+         {
+            return b.mAction;
+         }
+         if (a.mWeight != b.mWeight)
+         {
+            return a.mWeight < b.mWeight;
+         }
+         if (a.mTime != b.mTime)
+         {
+            return a.mTime < b.mTime;
+         }
+      }
+      return false;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   bool PoseCache::Key::operator==(const Key& other) const
+   {
+      return !(*this < other) && !(other < *this);
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   const SoftwareSkinning::BonePalette& PoseCache::Pose::GetPalette(CalSkeleton& skeleton) const
+   {
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mPaletteMutex);
+      if (mPalette.empty())
+      {
+         SoftwareSkinning::BuildPalette(skeleton, mPalette);
+      }
+      return mPalette;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   PoseCache::PoseCache()
+   : mTimeQuantum(DEFAULT_TIME_QUANTUM)
+   , mMaxAgeFrames(DEFAULT_MAX_AGE_FRAMES)
+   , mFrame(0U)
+   , mNumHits(0U)
+   , mNumMisses(0U)
+   {
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   PoseCache::~PoseCache()
+   {
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void PoseCache::SetTimeQuantum(float seconds)
+   {
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+      if (seconds > 0.0f && seconds != mTimeQuantum)
+      {
+         mTimeQuantum = seconds;
+         // The keys already stored were quantized differently.
+         mPoses.clear();
+      }
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   float PoseCache::GetTimeQuantum() const
+   {
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+      return mTimeQuantum;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void PoseCache::SetMaxAgeFrames(unsigned frames)
+   {
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+      mMaxAgeFrames = frames;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   unsigned PoseCache::GetMaxAgeFrames() const
+   {
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+      return mMaxAgeFrames;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   bool PoseCache::BuildKey(const Cal3DModelData& modelData, CalMixer& mixer, Key& outKey) const
+   {
+      outKey.Clear();
+
+      // Poses set directly on the mixer aren't described by any animation.
+      if (!mixer.getAnimationPose().empty())
+      {
+         return false;
+      }
+
+      const float timeQuantum = GetTimeQuantum();
+      outKey.mModelData = &modelData;
+      // Synchronized cycles are all driven by the mixer's time.
+      outKey.mMixerTime = int(std::floor(mixer.getAnimationTime() / timeQuantum));
+      AddAnimations(mixer.getAnimationCycle(), false, timeQuantum, outKey.mEntries);
+      AddAnimations(mixer.getAnimationActionList(), true, timeQuantum, outKey.mEntries);
+      return true;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   dtCore::RefPtr<const PoseCache::Pose> PoseCache::FindPose(const Key& key)
+   {
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+      PoseMap::iterator found = mPoses.find(key);
+      if (found == mPoses.end())
+      {
+         ++mNumMisses;
+         return NULL;
+      }
+
+      ++mNumHits;
+      found->second.mLastUsedFrame = mFrame;
+      return found->second.mPose.get();
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   dtCore::RefPtr<const PoseCache::Pose> PoseCache::ApplyPose(const Key& key, CalSkeleton& skeleton)
+   {
+      dtCore::RefPtr<const Pose> pose = FindPose(key);
+      if (!pose.valid())
+      {
+         return NULL;
+      }
+
+      std::vector<CalBone*>& bones = skeleton.getVectorBone();
+      const std::vector<BoneTransform>& transforms = pose->GetBoneTransforms();
+      if (bones.size() != transforms.size())
+      {
+         return NULL;
+      }
+
+      for (size_t b = 0; b < bones.size(); ++b)
+      {
+         const BoneTransform& transform = transforms[b];
+         bones[b]->setRotation(CalQuaternion(transform.mRotation[0], transform.mRotation[1],
+            transform.mRotation[2], transform.mRotation[3]));
+         bones[b]->setTranslation(CalVector(transform.mTranslation[0], transform.mTranslation[1],
+            transform.mTranslation[2]));
+      }
+      skeleton.calculateState();
+      return pose;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   dtCore::RefPtr<const PoseCache::Pose> PoseCache::StorePose(const Key& key, CalSkeleton& skeleton)
+   {
+      // Built outside the lock, since the other threads only need the map.  The palette is left
+      // until a character skins with the pose.
+      dtCore::RefPtr<Pose> pose = new Pose;
+
+      std::vector<CalBone*>& bones = skeleton.getVectorBone();
+      pose->mBoneTransforms.resize(bones.size());
+      for (size_t b = 0; b < bones.size(); ++b)
+      {
+         const CalQuaternion& rotation = bones[b]->getRotation();
+         const CalVector& translation = bones[b]->getTranslation();
+         BoneTransform& transform = pose->mBoneTransforms[b];
+         transform.mRotation[0] = rotation.x;
+         transform.mRotation[1] = rotation.y;
+         transform.mRotation[2] = rotation.z;
+         transform.mRotation[3] = rotation.w;
+         transform.mTranslation[0] = translation.x;
+         transform.mTranslation[1] = translation.y;
+         transform.mTranslation[2] = translation.z;
+      }
+
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+      CacheEntry& entry = mPoses[key];
+      if (!entry.mPose.valid())
+      {
+         entry.mPose = pose;
+      }
+      entry.mLastUsedFrame = mFrame;
+      return entry.mPose.get();
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void PoseCache::AdvanceFrame()
+   {
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+      ++mFrame;
+
+      PoseMap::iterator i = mPoses.begin();
+      while (i != mPoses.end())
+      {
+         if (mFrame - i->second.mLastUsedFrame > mMaxAgeFrames)
+         {
+            mPoses.erase(i++);
+         }
+         else
+         {
+            ++i;
+         }
+      }
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void PoseCache::Clear()
+   {
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+      mPoses.clear();
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   unsigned PoseCache::GetNumPoses() const
+   {
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+      return unsigned(mPoses.size());
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   unsigned PoseCache::GetNumHits() const
+   {
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+      return mNumHits;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   unsigned PoseCache::GetNumMisses() const
+   {
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+      return mNumMisses;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void PoseCache::ResetStatistics()
+   {
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+      mNumHits = 0U;
+      mNumMisses = 0U;
+   }
+}
@@ -110,11 +110,34 @@ bool PoseMeshDatabase::LoadFromFile(const std::string& file)
       result = meshLoader.Load(file, meshDataVector);
       assert(result);
 
-      mMeshes.reserve(mMeshes.size() + meshDataVector.size());
+      AddMeshes(meshDataVector);
+   }
+   catch (dtUtil::Exception& exception)
+   {
+      LOG_ERROR(exception.ToString());
 
-      std::for_each(meshDataVector.begin(),
-                    meshDataVector.end(),
-                    PoseBuilderFunctor<PoseMeshList>(mModel.get(), &mMeshes));
+      mMeshes.clear();
+
+      result = false;
+   }
+
+   return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool PoseMeshDatabase::LoadFromBuffer(const char* data, size_t length, const std::string& name)
+{
+   PoseMeshLoader meshLoader;
+   std::vector<PoseMeshData> meshDataVector;
+
+   bool result = false;
+   try
+   {
+      result = meshLoader.Load(data, length, name, meshDataVector);
+      if (result)
+      {
+         AddMeshes(meshDataVector);
+      }
    }
    catch (dtUtil::Exception& exception)
    {
@@ -128,6 +151,16 @@ bool PoseMeshDatabase::LoadFromFile(const std::string& file)
    return result;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+void PoseMeshDatabase::AddMeshes(const std::vector<PoseMeshData>& meshDataVector)
+{
+   mMeshes.reserve(mMeshes.size() + meshDataVector.size());
+
+   std::for_each(meshDataVector.begin(),
+                 meshDataVector.end(),
+                 PoseBuilderFunctor<PoseMeshList>(mModel.get(), &mMeshes));
+}
+
 
 
 
@@ -63,3 +63,31 @@ bool PoseMeshLoader::Load(const std::string& file, MeshDataContainer& toFill)
 
    return result;
 }
+
+////////////////////////////////////////////////////////////////////////////////
+bool PoseMeshLoader::Load(const char* data, size_t length, const std::string& name, MeshDataContainer& toFill)
+{
+   PoseMeshFileHandler handler;
+   dtUtil::XercesParser parser;
+   bool result = false;
+
+   try
+   {
+      result = parser.ParseBuffer(data, length, name, handler, "");
+   }
+   catch (const dtUtil::Exception& ex)
+   {
+      ex.LogException(dtUtil::Log::LOG_ERROR);
+   }
+
+   if (result)
+   {
+      toFill = handler.GetData();
+   }
+   else
+   {
+      LOG_ERROR("Unable to load pose mesh data: " + name);
+   }
+
+   return result;
+}
@@ -0,0 +1,333 @@
+/* -*-c++-*-
+ * Delta3D Open Source Game and Simulation Engine
+ * Copyright (C) 2014, Caper Holdings, LLC
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include <dtAnim/softwareskinning.h>
+#include <dtUtil/warningdisable.h>
+
+DT_DISABLE_WARNING_ALL_START
+#include <cal3d/bone.h>
+#include <cal3d/coresubmesh.h>
+#include <cal3d/skeleton.h>
+DT_DISABLE_WARNING_END
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define DT_ANIM_SSE_SKINNING
+#include <xmmintrin.h>
+#endif
+
+namespace dtAnim
+{
+   namespace
+   {
+      bool HeavierInfluence(const CalCoreSubmesh::Influence& a, const CalCoreSubmesh::Influence& b)
+      {
+         return a.weight > b.weight;
+      }
+
+      //////////////////////////////////////////////////////////////////////////
+      inline void CopyVertex(const float* position, const float* normal, float* outPosition, float* outNormal)
+      {
+         outPosition[0] = position[0];
+         outPosition[1] = position[1];
+         outPosition[2] = position[2];
+         if (outNormal != NULL)
+         {
+            outNormal[0] = normal[0];
+            outNormal[1] = normal[1];
+            outNormal[2] = normal[2];
+         }
+      }
+
+      //////////////////////////////////////////////////////////////////////////
+      inline void Normalize(float* normal)
+      {
+         float lengthSq = normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2];
+         if (lengthSq > 0.0f)
+         {
+            float scale = 1.0f / std::sqrt(lengthSq);
+            normal[0] *= scale;
+            normal[1] *= scale;
+            normal[2] *= scale;
+         }
+      }
+
+#ifdef DT_ANIM_SSE_SKINNING
+      //////////////////////////////////////////////////////////////////////////
+      void SkinVerticesSSE(const SoftwareSkinning::SkinnedMesh& mesh, const SoftwareSkinning::BoneMatrix* palette,
+         float* outPositions, float* outNormals, unsigned stride, bool normalizeNormals, unsigned maxVertices)
+      {
+         const unsigned numVertices = std::min(mesh.GetVertexCount(), maxVertices);
+         if (numVertices == 0)
+         {
+            return;
+         }
+
+         const float* position = &mesh.mPositions[0];
+         const float* normal = &mesh.mNormals[0];
+         const unsigned short* bones = &mesh.mBoneIndices[0];
+         const float* weights = &mesh.mBoneWeights[0];
+
+         // Stores write all four lanes, so they go here first rather than over the next attribute.
+         float result[4];
+
+         for (unsigned v = 0; v < numVertices; ++v)
+         {
+            float* outPosition = outPositions + v * stride;
+            float* outNormal = outNormals != NULL ? outNormals + v * stride : NULL;
+
+            if (weights[0] == 0.0f)
+            {
+               CopyVertex(position, normal, outPosition, outNormal);
+            }
+            else
+            {
+               // Blend the matrices of the influences, then transform once.
+               const SoftwareSkinning::BoneMatrix* matrix = palette + bones[0];
+               __m128 weight = _mm_set1_ps(weights[0]);
+               __m128 c0 = _mm_mul_ps(weight, _mm_loadu_ps(matrix->mColumns[0]));
+               __m128 c1 = _mm_mul_ps(weight, _mm_loadu_ps(matrix->mColumns[1]));
+               __m128 c2 = _mm_mul_ps(weight, _mm_loadu_ps(matrix->mColumns[2]));
+               __m128 c3 = _mm_mul_ps(weight, _mm_loadu_ps(matrix->mColumns[3]));
+
+               // Influences are sorted heaviest first, so the first zero weight ends them.
+               for (unsigned i = 1; i < SoftwareSkinning::MAX_INFLUENCES && weights[i] != 0.0f; ++i)
+               {
+                  matrix = palette + bones[i];
+                  weight = _mm_set1_ps(weights[i]);
+                  c0 = _mm_add_ps(c0, _mm_mul_ps(weight, _mm_loadu_ps(matrix->mColumns[0])));
+                  c1 = _mm_add_ps(c1, _mm_mul_ps(weight, _mm_loadu_ps(matrix->mColumns[1])));
+                  c2 = _mm_add_ps(c2, _mm_mul_ps(weight, _mm_loadu_ps(matrix->mColumns[2])));
+                  c3 = _mm_add_ps(c3, _mm_mul_ps(weight, _mm_loadu_ps(matrix->mColumns[3])));
+               }
+
+               __m128 p = _mm_add_ps(
+                  _mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(position[0])), _mm_mul_ps(c1, _mm_set1_ps(position[1]))),
+                  _mm_add_ps(_mm_mul_ps(c2, _mm_set1_ps(position[2])), c3));
+               _mm_storeu_ps(result, p);
+               outPosition[0] = result[0];
+               outPosition[1] = result[1];
+               outPosition[2] = result[2];
+
+               if (outNormal != NULL)
+               {
+                  __m128 n = _mm_add_ps(
+                     _mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(normal[0])), _mm_mul_ps(c1, _mm_set1_ps(normal[1]))),
+                     _mm_mul_ps(c2, _mm_set1_ps(normal[2])));
+                  _mm_storeu_ps(result, n);
+                  outNormal[0] = result[0];
+                  outNormal[1] = result[1];
+                  outNormal[2] = result[2];
+               }
+            }
+
+            if (outNormal != NULL && normalizeNormals)
+            {
+               Normalize(outNormal);
+            }
+
+            position += 3;
+            normal += 3;
+            bones += SoftwareSkinning::MAX_INFLUENCES;
+            weights += SoftwareSkinning::MAX_INFLUENCES;
+         }
+      }
+#endif
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   bool SoftwareSkinning::IsSimdAvailable()
+   {
+#ifdef DT_ANIM_SSE_SKINNING
+      return true;
+#else
+      return false;
+#endif
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void SoftwareSkinning::ExtractSubmesh(CalCoreSubmesh& coreSubmesh, SkinnedMesh& outMesh)
+   {
+      std::vector<CalCoreSubmesh::Vertex>& vertices = coreSubmesh.getVectorVertex();
+      const size_t numVertices = vertices.size();
+
+      outMesh.mPositions.resize(numVertices * 3);
+      outMesh.mNormals.resize(numVertices * 3);
+      outMesh.mBoneIndices.assign(numVertices * MAX_INFLUENCES, 0);
+      outMesh.mBoneWeights.assign(numVertices * MAX_INFLUENCES, 0.0f);
+
+      std::vector<CalCoreSubmesh::Influence> influences;
+      for (size_t v = 0; v < numVertices; ++v)
+      {
+         const CalCoreSubmesh::Vertex& vertex = vertices[v];
+         outMesh.mPositions[v * 3 + 0] = vertex.position.x;
+         outMesh.mPositions[v * 3 + 1] = vertex.position.y;
+         outMesh.mPositions[v * 3 + 2] = vertex.position.z;
+         outMesh.mNormals[v * 3 + 0] = vertex.normal.x;
+         outMesh.mNormals[v * 3 + 1] = vertex.normal.y;
+         outMesh.mNormals[v * 3 + 2] = vertex.normal.z;
+
+         influences = vertex.vectorInfluence;
+         std::stable_sort(influences.begin(), influences.end(), HeavierInfluence);
+
+         const size_t numInfluences = std::min(influences.size(), size_t(MAX_INFLUENCES));
+         float total = 0.0f;
+         for (size_t i = 0; i < numInfluences; ++i)
+         {
+            total += influences[i].weight;
+         }
+
+         // Only rescale when something was dropped, so the common case matches Cal3D exactly.
+         float scale = 1.0f;
+         if (numInfluences < influences.size() && total > 0.0f)
+         {
+            float fullTotal = total;
+            for (size_t i = numInfluences; i < influences.size(); ++i)
+            {
+               fullTotal += influences[i].weight;
+            }
+            scale = fullTotal / total;
+         }
+
+         for (size_t i = 0; i < numInfluences; ++i)
+         {
+            outMesh.mBoneIndices[v * MAX_INFLUENCES + i] = static_cast<unsigned short>(influences[i].boneId);
+            outMesh.mBoneWeights[v * MAX_INFLUENCES + i] = influences[i].weight * scale;
+         }
+      }
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void SoftwareSkinning::BuildPalette(CalSkeleton& skeleton, BonePalette& outPalette)
+   {
+      std::vector<CalBone*>& bones = skeleton.getVectorBone();
+      outPalette.resize(bones.size());
+
+      for (size_t b = 0; b < bones.size(); ++b)
+      {
+         // CalVector *= CalMatrix makes x' = dxdx * x + dxdy * y + dxdz * z, so the columns are the d?dx, d?dy and d?dz terms.
+         const CalMatrix& rotation = bones[b]->getTransformMatrix();
+         const CalVector& translation = bones[b]->getTranslationBoneSpace();
+         BoneMatrix& matrix = outPalette[b];
+
+         matrix.mColumns[0][0] = rotation.dxdx;
+         matrix.mColumns[0][1] = rotation.dydx;
+         matrix.mColumns[0][2] = rotation.dzdx;
+         matrix.mColumns[0][3] = 0.0f;
+
+         matrix.mColumns[1][0] = rotation.dxdy;
+         matrix.mColumns[1][1] = rotation.dydy;
+         matrix.mColumns[1][2] = rotation.dzdy;
+         matrix.mColumns[1][3] = 0.0f;
+
+         matrix.mColumns[2][0] = rotation.dxdz;
+         matrix.mColumns[2][1] = rotation.dydz;
+         matrix.mColumns[2][2] = rotation.dzdz;
+         matrix.mColumns[2][3] = 0.0f;
+
+         matrix.mColumns[3][0] = translation.x;
+         matrix.mColumns[3][1] = translation.y;
+         matrix.mColumns[3][2] = translation.z;
+         matrix.mColumns[3][3] = 1.0f;
+      }
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void SoftwareSkinning::ApplyRootTransform(const osg::Matrix& root, const BoneMatrix* inPalette,
+      BoneMatrix* outPalette, unsigned numBones)
+   {
+      // osg matrices transform row vectors, so root(c, r) is the column vector form's row r, column c.
+      for (unsigned b = 0; b < numBones; ++b)
+      {
+         const BoneMatrix in = inPalette[b];
+         BoneMatrix& out = outPalette[b];
+         for (unsigned c = 0; c < 4; ++c)
+         {
+            const float* column = in.mColumns[c];
+            for (unsigned r = 0; r < 3; ++r)
+            {
+               double value = root(0, r) * column[0] + root(1, r) * column[1] + root(2, r) * column[2];
+               if (c == 3)
+               {
+                  value += root(3, r);
+               }
+               out.mColumns[c][r] = float(value);
+            }
+            out.mColumns[c][3] = in.mColumns[c][3];
+         }
+      }
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void SoftwareSkinning::SkinVertices(const SkinnedMesh& mesh, const BoneMatrix* palette,
+      float* outPositions, float* outNormals, unsigned stride, bool normalizeNormals, unsigned maxVertices)
+   {
+#ifdef DT_ANIM_SSE_SKINNING
+      SkinVerticesSSE(mesh, palette, outPositions, outNormals, stride, normalizeNormals, maxVertices);
+#else
+      SkinVerticesScalar(mesh, palette, outPositions, outNormals, stride, normalizeNormals, maxVertices);
+#endif
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void SoftwareSkinning::SkinVerticesScalar(const SkinnedMesh& mesh, const BoneMatrix* palette,
+      float* outPositions, float* outNormals, unsigned stride, bool normalizeNormals, unsigned maxVertices)
+   {
+      const unsigned numVertices = std::min(mesh.GetVertexCount(), maxVertices);
+      for (unsigned v = 0; v < numVertices; ++v)
+      {
+         const float* position = &mesh.mPositions[v * 3];
+         const float* normal = &mesh.mNormals[v * 3];
+         const unsigned short* bones = &mesh.mBoneIndices[v * MAX_INFLUENCES];
+         const float* weights = &mesh.mBoneWeights[v * MAX_INFLUENCES];
+
+         float* outPosition = outPositions + v * stride;
+         float* outNormal = outNormals != NULL ? outNormals + v * stride : NULL;
+
+         if (weights[0] == 0.0f)
+         {
+            CopyVertex(position, normal, outPosition, outNormal);
+         }
+         else
+         {
+            float p[3] = { 0.0f, 0.0f, 0.0f };
+            float n[3] = { 0.0f, 0.0f, 0.0f };
+            for (unsigned i = 0; i < MAX_INFLUENCES && weights[i] != 0.0f; ++i)
+            {
+               const BoneMatrix& m = palette[bones[i]];
+               const float w = weights[i];
+               for (unsigned r = 0; r < 3; ++r)
+               {
+                  const float rotatedPosition = m.mColumns[0][r] * position[0] + m.mColumns[1][r] * position[1] + m.mColumns[2][r] * position[2];
+                  p[r] += w * (rotatedPosition + m.mColumns[3][r]);
+                  n[r] += w * (m.mColumns[0][r] * normal[0] + m.mColumns[1][r] * normal[1] + m.mColumns[2][r] * normal[2]);
+               }
+            }
+            CopyVertex(p, n, outPosition, outNormal);
+         }
+
+         if (outNormal != NULL && normalizeNormals)
+         {
+            Normalize(outNormal);
+         }
+      }
+   }
+}
@@ -498,10 +498,8 @@ namespace dtAnim
                ///offset into the vbo to fill the correct lod.
                vertexArray += mVertexOffsets[lodIndex] * STRIDE;
 
-               submesh->GetVertices(vertexArray, STRIDE_BYTES);
-
-               // get the transformed normals of the Submesh
-               submesh->GetNormals(vertexArray + 3, STRIDE_BYTES);
+               // get the transformed vertices and normals of the Submesh
+               submesh->GetVerticesAndNormals(vertexArray, vertexArray + 3, STRIDE_BYTES);
                glExt->glUnmapBuffer(GL_ARRAY_BUFFER_ARB);
             }
 
@@ -562,11 +560,8 @@ namespace dtAnim
                   submesh->GetFaces(mMeshFaces);
                }
 
-               // get the transformed vertices of the submesh
-               vertexCount = submesh->GetVertices(mMeshVertices);
-
-               // get the transformed normals of the submesh
-               submesh->GetNormals(mMeshNormals);
+               // get the transformed vertices and normals of the submesh
+               vertexCount = submesh->GetVerticesAndNormals(mMeshVertices, mMeshNormals);
 
                // get the texture coordinates of the submesh
                // this is still buggy, it renders only the first texture.
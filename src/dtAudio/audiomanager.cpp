@@ -1,4 +1,6 @@
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <stack>
 
 #include <osg/Vec3>
@@ -19,9 +21,12 @@
 #include <dtAudio/dtaudio.h>
 #include <dtCore/system.h>
 #include <dtCore/camera.h>
+#include <dtCore/transform.h>
 #include <dtUtil/stringutils.h>
 #include <dtUtil/datapathutils.h>
 #include <dtUtil/fileutils.h>
+#include <dtUtil/mathdefines.h>
+#include <dtUtil/threadpool.h>
 
 #include <iostream>
 
@@ -30,6 +35,10 @@
 # define BIT(a) (1L<<a)
 #endif
 
+// Real voices must be outranked by this much before they are made virtual,
+// so sounds of nearly equal audibility don't swap sources every frame.
+static const float VOICE_HYSTERESIS = 1.1f;
+
 // name spaces
 using namespace dtAudio;
 using namespace dtUtil;
@@ -72,10 +81,56 @@ namespace dtAudio
          , mRawData(NULL)
       {}
 
+      // Frees the data if it was never handed to a buffer.
+      void ReleaseRawData()
+      {
+#if !defined (_MSC_VER) || !defined (DONT_ALUT_FREE)
+         free(mRawData);
+#endif
+         mRawData = NULL;
+      }
+
       ALvoid* mRawData;
       AudioManager::BufferData mBufferData;
 
       META_Object("dtAudio", WrapperOSGSoundObject);
+
+   protected:
+      virtual ~WrapperOSGSoundObject()
+      {
+         ReleaseRawData();
+      }
+   };
+
+   /////////////////////////////////////////////////////////////////////////////
+   // Reads and decodes a sound file for AudioManager::PreloadFileAsync.
+   /////////////////////////////////////////////////////////////////////////////
+   class SoundPreloadTask : public dtUtil::ThreadPoolTask
+   {
+   public:
+      explicit SoundPreloadTask(const std::string& filename)
+         : mFileName(filename)
+         , mComplete(false)
+      {
+         SetName("Sound Preload");
+      }
+
+      void operator()() override
+      {
+         dtCore::RefPtr<osg::Object> osgObj = osgDB::readRefObjectFile(mFileName);
+         mResult = dynamic_cast<WrapperOSGSoundObject*>(osgObj.get());
+         mComplete = true;
+      }
+
+      /// Check to see if the read is done.  If it returns true, call WaitUntilComplete() to make sure.
+      bool IsComplete() const { return mComplete; }
+
+      WrapperOSGSoundObject* GetResult() { return mResult.get(); }
+
+   private:
+      std::string mFileName;
+      dtCore::RefPtr<WrapperOSGSoundObject> mResult;
+      volatile bool mComplete;
    };
 
    /////////////////////////////////////////////////////////////////////////////
@@ -209,6 +264,11 @@ AudioManager::AudioManager(const std::string& name /*= "audiomanager"*/,
    , mEAXGet(NULL)
    , mNumSounds(0)
    , mIsConfigured(false)
+   , mMaxRealVoices(0)
+   , mNumVirtualVoices(0)
+   , mDistanceModel(AL_INVERSE_DISTANCE_CLAMPED)
+   , mBufferCacheLimit(0)
+   , mBufferUseCount(0)
    , mDevice(NULL)
    , mContext(NULL)
    , mShutdownContexts(false)
@@ -247,6 +307,8 @@ AudioManager::AudioManager(const std::string& name /*= "audiomanager"*/,
       mContext = cntxt;
       mShutdownContexts = shutdownPassedInContexts;
    }
+
+   mMaxRealVoices = QueryDeviceSources();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -263,6 +325,13 @@ AudioManager::~AudioManager()
          __FUNCTION__, __LINE__);
    }
 
+   // the reads reference nothing of ours, but don't leave them running past shutdown
+   for (PRELOAD_MAP::iterator iter(mPreloads.begin()); iter != mPreloads.end(); ++iter)
+   {
+      iter->second.mTask->WaitUntilComplete();
+   }
+   mPreloads.clear();
+
    // delete the buffers
    BufferData* bd(NULL);
    for (BUF_MAP::iterator iter(mBufferMap.begin()); iter != mBufferMap.end(); iter++)
@@ -327,6 +396,8 @@ void AudioManager::SetOpenALDevice(const ALCchar* deviceName)
 
    OpenDevice(deviceName);
    CreateContext();
+
+   mMaxRealVoices = QueryDeviceSources();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -348,7 +419,10 @@ void AudioManager::SetDistanceModel(ALenum dm)
 {
    CheckForError("Cleanup al error.", __FUNCTION__, __LINE__);
    alDistanceModel(dm);
-   CheckForError("alDistanceModel()", __FUNCTION__, __LINE__);
+   if (!CheckForError("alDistanceModel()", __FUNCTION__, __LINE__))
+   {
+      mDistanceModel = dm;
+   }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -367,6 +441,79 @@ void SetSpeedOfSound(float s)
    CheckForError("alSpeedOfSound", __FUNCTION__, __LINE__);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+void AudioManager::SetMaxRealVoices(unsigned int count)
+{
+   mMaxRealVoices = count;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+unsigned int AudioManager::GetMaxRealVoices() const
+{
+   return mMaxRealVoices;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+unsigned int AudioManager::GetNumVirtualVoices() const
+{
+   return mNumVirtualVoices;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+float AudioManager::EstimateAudibility(const Sound& snd, const osg::Vec3& listenerPos) const
+{
+   osg::Vec3 pos;
+   snd.GetPosition(pos);
+
+   float distance = snd.IsListenerRelative() ? pos.length() : (pos - listenerPos).length();
+
+   const float refDistance = snd.GetReferenceDistance();
+   const float maxDistance = snd.GetMaxDistance();
+   const float rolloff     = snd.GetRolloffFactor();
+
+   // The attenuation formulas from the OpenAL 1.1 specification.
+   float attenuation = 1.0f;
+   switch (mDistanceModel)
+   {
+   case AL_INVERSE_DISTANCE_CLAMPED:
+      distance = std::max(refDistance, std::min(distance, maxDistance));
+      // fall through
+   case AL_INVERSE_DISTANCE:
+      {
+         const float denominator = refDistance + rolloff * (distance - refDistance);
+         if (denominator > 0.0f)
+         {
+            attenuation = refDistance / denominator;
+         }
+      }
+      break;
+   case AL_LINEAR_DISTANCE_CLAMPED:
+      distance = std::max(refDistance, std::min(distance, maxDistance));
+      // fall through
+   case AL_LINEAR_DISTANCE:
+      if (maxDistance > refDistance)
+      {
+         attenuation = 1.0f - rolloff * (distance - refDistance) / (maxDistance - refDistance);
+      }
+      break;
+   case AL_EXPONENT_DISTANCE_CLAMPED:
+      distance = std::max(refDistance, std::min(distance, maxDistance));
+      // fall through
+   case AL_EXPONENT_DISTANCE:
+      if (refDistance > 0.0f && distance > 0.0f)
+      {
+         attenuation = std::pow(distance / refDistance, -rolloff);
+      }
+      break;
+   default:
+      break;
+   }
+
+   float gain = snd.GetGain() * attenuation;
+   dtUtil::Clamp<float>(gain, snd.GetMinGain(), snd.GetMaxGain());
+   return gain;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 void AudioManager::OnSystem(const dtUtil::RefString& str, double deltaSim, double deltaReal)
 
@@ -543,16 +690,17 @@ ALint AudioManager::LoadFile(const std::string& file)
       return false;
    }
 
-   std::string filename;
-   if (dtUtil::FileUtils::GetInstance().FileExists(file))
-   {
-      filename = file;
-   }
-   else
+   // check the cache before touching the file system
+   BUF_MAP::iterator found = mBufferMap.find(file);
+   if (found != mBufferMap.end() && found->second != NULL)
    {
-      filename = dtUtil::FindFileInPathList(file);
+      // file already loaded, bail...
+      ++mBufferCacheCounts.mHits;
+      found->second->lastUsed = ++mBufferUseCount;
+      return found->second->buf;
    }
 
+   const std::string filename = FindSoundFile(file);
    if (filename.empty())
    {
       // still no file name, bail...
@@ -560,14 +708,8 @@ ALint AudioManager::LoadFile(const std::string& file)
       return AL_NONE;
    }
 
-   BufferData* bd = mBufferMap[file];
-   if (bd != 0)
-   {
-      // file already loaded, bail...
-      return bd->buf;
-   }
-
-   bd = new BufferData;
+   ++mBufferCacheCounts.mMisses;
+   BufferData* bd = new BufferData;
 
    // Clear the errors
    //ALenum err( alGetError() );
@@ -645,11 +787,165 @@ ALint AudioManager::LoadFile(const std::string& file)
 
    alBufferData(bd->buf, bd->format, data, bd->size, bd->freq);
 
+#ifndef ALUT_API_MAJOR_VERSION
 #if !defined (_MSC_VER) || !defined (DONT_ALUT_FREE)
    free(data);
+#endif
+#else
+   userData->ReleaseRawData();
+#endif
    data = NULL;
+
+   if (CheckForError("AudioManager: alBufferData error ", __FUNCTION__, __LINE__))
+   {
+      ReleaseSoundBuffer(bd->buf, "alDeleteBuffers error prior to deleting data.",
+         __FUNCTION__, __LINE__);
+
+      delete bd;
+      return AL_NONE;
+   }
+
+   bd->lastUsed = ++mBufferUseCount;
+   mBufferMap[file] = bd;
+   bd->file = mBufferMap.find(file)->first.c_str();
+
+   return bd->buf;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::string AudioManager::FindSoundFile(const std::string& file) const
+{
+   if (dtUtil::FileUtils::GetInstance().FileExists(file))
+   {
+      return file;
+   }
+   return dtUtil::FindFileInPathList(file);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool AudioManager::PreloadFileAsync(const std::string& file, PreloadCallBack cb, void* param)
+{
+   BUF_MAP::iterator found = mBufferMap.find(file);
+   if (found != mBufferMap.end() && found->second != NULL)
+   {
+      ++mBufferCacheCounts.mHits;
+      found->second->lastUsed = ++mBufferUseCount;
+      if (cb != NULL)
+      {
+         cb(file, found->second->buf, param);
+      }
+      return true;
+   }
+
+   PRELOAD_MAP::iterator pending = mPreloads.find(file);
+   if (pending != mPreloads.end())
+   {
+      pending->second.mCallBacks.push_back(std::make_pair(cb, param));
+      return true;
+   }
+
+   const std::string filename = FindSoundFile(file);
+   if (filename.empty())
+   {
+      Log::GetInstance("audiomanager.cpp").LogMessage(Log::LOG_WARNING, __FUNCTION__, "AudioManager: can't preload file %s", file.c_str());
+      return false;
+   }
+
+#ifdef ALUT_API_MAJOR_VERSION
+   if (dtUtil::ThreadPool::IsInitialized())
+   {
+      PendingPreload& preload = mPreloads[file];
+      preload.mTask = new SoundPreloadTask(filename);
+      preload.mCallBacks.push_back(std::make_pair(cb, param));
+      dtUtil::ThreadPool::AddTask(*preload.mTask, dtUtil::ThreadPool::IO);
+      return true;
+   }
 #endif
 
+   // The old ALUT only loads from files, so there is nothing to do off the main thread.
+   ALint buf = LoadFile(file);
+   if (cb != NULL)
+   {
+      cb(file, buf, param);
+   }
+   return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void AudioManager::ProcessCompletedPreloads()
+{
+   PRELOAD_MAP::iterator iter = mPreloads.begin();
+   while (iter != mPreloads.end())
+   {
+      SoundPreloadTask& task = *iter->second.mTask;
+      if (!task.IsComplete())
+      {
+         ++iter;
+         continue;
+      }
+
+      // IsComplete can be seen just before the task finishes returning.
+      task.WaitUntilComplete();
+
+      const std::string file = iter->first;
+      ALint buf = AL_NONE;
+
+      // LoadFile may have been called for the same file while it was being read.
+      BUF_MAP::iterator found = mBufferMap.find(file);
+      if (found != mBufferMap.end() && found->second != NULL)
+      {
+         buf = found->second->buf;
+      }
+      else if (task.GetResult() != NULL)
+      {
+         ++mBufferCacheCounts.mMisses;
+         buf = CreateBuffer(file, *task.GetResult());
+      }
+      else
+      {
+         Log::GetInstance("audiomanager.cpp").LogMessage(Log::LOG_WARNING, __FUNCTION__, "AudioManager: can't load file %s", file.c_str());
+      }
+
+      // The callbacks may preload more files, so finish with the map first.
+      std::vector<std::pair<PreloadCallBack, void*> > callBacks;
+      callBacks.swap(iter->second.mCallBacks);
+      mPreloads.erase(iter++);
+
+      for (size_t i = 0; i < callBacks.size(); ++i)
+      {
+         if (callBacks[i].first != NULL)
+         {
+            callBacks[i].first(file, buf, callBacks[i].second);
+         }
+      }
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+ALint AudioManager::CreateBuffer(const std::string& file, WrapperOSGSoundObject& soundData)
+{
+   if (soundData.mRawData == NULL)
+   {
+      CheckForError("AudioManager: alutLoadMemoryFromFile error", __FUNCTION__, __LINE__);
+      return AL_NONE;
+   }
+
+   BufferData* bd = new BufferData;
+   alGenBuffers(1L, &bd->buf);
+   if (CheckForError("AudioManager: alGenBuffers error", __FUNCTION__, __LINE__))
+   {
+      delete bd;
+      return AL_NONE;
+   }
+
+   const BufferData& loaded = soundData.mBufferData;
+   bd->format = loaded.format;
+   bd->freq   = loaded.freq;
+   bd->size   = loaded.size;
+
+   alBufferData(bd->buf, bd->format, soundData.mRawData, bd->size, bd->freq);
+   soundData.ReleaseRawData();
+
    if (CheckForError("AudioManager: alBufferData error ", __FUNCTION__, __LINE__))
    {
       ReleaseSoundBuffer(bd->buf, "alDeleteBuffers error prior to deleting data.",
@@ -659,12 +955,100 @@ ALint AudioManager::LoadFile(const std::string& file)
       return AL_NONE;
    }
 
+   bd->lastUsed = ++mBufferUseCount;
    mBufferMap[file] = bd;
    bd->file = mBufferMap.find(file)->first.c_str();
 
    return bd->buf;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+void AudioManager::SetBufferCacheLimit(size_t bytes)
+{
+   mBufferCacheLimit = bytes;
+   // A limit of 0 also drops the buffers the old limit was keeping.
+   TrimBufferCache();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+size_t AudioManager::GetBufferCacheLimit() const
+{
+   return mBufferCacheLimit;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+AudioManager::BufferCacheStats AudioManager::GetBufferCacheStats() const
+{
+   BufferCacheStats stats = mBufferCacheCounts;
+
+   for (BUF_MAP::const_iterator iter = mBufferMap.begin(); iter != mBufferMap.end(); ++iter)
+   {
+      const BufferData* bd = iter->second;
+      if (bd == NULL)
+      {
+         continue;
+      }
+
+      ++stats.mNumBuffers;
+      stats.mBytes += bd->size;
+      if (bd->use == 0)
+      {
+         ++stats.mNumUnusedBuffers;
+         stats.mUnusedBytes += bd->size;
+      }
+   }
+
+   for (SND_LST::const_iterator iter = mSoundList.begin(); iter != mSoundList.end(); ++iter)
+   {
+      const SoundStream* stream = iter->valid() ? (*iter)->GetStream() : NULL;
+      if (stream != NULL)
+      {
+         ++stats.mNumStreams;
+         stats.mStreamBytes += stream->GetMemoryUsage();
+      }
+   }
+
+   return stats;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Orders buffers from least to most recently used.
+static bool LessRecentlyUsed(const AudioManager::BufferData* a, const AudioManager::BufferData* b)
+{
+   return a->lastUsed < b->lastUsed;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void AudioManager::TrimBufferCache()
+{
+   size_t unusedBytes = 0;
+   std::vector<BufferData*> unused;
+   for (BUF_MAP::iterator iter = mBufferMap.begin(); iter != mBufferMap.end(); ++iter)
+   {
+      if (iter->second != NULL && iter->second->use == 0)
+      {
+         unused.push_back(iter->second);
+         unusedBytes += iter->second->size;
+      }
+   }
+
+   if (unusedBytes <= mBufferCacheLimit)
+   {
+      return;
+   }
+
+   std::sort(unused.begin(), unused.end(), LessRecentlyUsed);
+   for (size_t i = 0; i < unused.size() && unusedBytes > mBufferCacheLimit; ++i)
+   {
+      unusedBytes -= unused[i]->size;
+      // copy the name, the map owns the string it points to
+      if (UnloadFile(std::string(unused[i]->file)))
+      {
+         ++mBufferCacheCounts.mEvictions;
+      }
+   }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 bool AudioManager::UnloadFile(const std::string& file)
 {
@@ -709,23 +1093,132 @@ bool AudioManager::UnloadFile(const std::string& file)
 void AudioManager::PreFrame(const double deltaFrameTime)
 {
    CheckForError(ERROR_CLEARING_STRING, __FUNCTION__, __LINE__);
-   SOB_PTR     snd(NULL);
+
+   if (!mPreloads.empty())
+   {
+      ProcessCompletedPreloads();
+   }
 
    // flush all the sound commands
    for (unsigned int i = 0; i < mSoundList.size(); ++i)
    {
-      snd = mSoundList.at(i);
+      Sound* snd = mSoundList[i].get();
 
-      if (snd.get() == NULL)
+      if (snd == NULL)
       {
          continue;
       }
 
-      //Position and direct sound before firing commands
-      snd->SetPositionFromParent();
-      snd->SetDirectionFromParent();
+      //Position and direct sound before firing commands.  Stopped sounds can't
+      //be heard, so they skip the world transform unless a queued Play is about
+      //to start them.
+      if (!snd->IsStopped() || snd->IsPlayPending())
+      {
+         snd->SetTransformFromParent();
+      }
       snd->RunAllCommandsInQueue();
+      snd->UpdateStream();
    }
+
+   UpdateVoices(deltaFrameTime);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void AudioManager::UpdateVoices(const double deltaFrameTime)
+{
+   osg::Vec3 listenerPos;
+   if (_Mic.valid())
+   {
+      dtCore::Transform xform;
+      _Mic->GetTransform(xform, dtCore::Transformable::ABS_CS);
+      xform.GetTranslation(listenerPos);
+   }
+
+   mVoiceCandidates.clear();
+   unsigned int reserved = 0;
+
+   for (SND_LST::iterator iter = mSoundList.begin(); iter != mSoundList.end(); ++iter)
+   {
+      Sound* snd = iter->get();
+      if (snd == NULL || !snd->IsPlaying())
+      {
+         continue;
+      }
+
+      // These keep whatever source they have, so they only take from the budget.
+      if (snd->HasUserDefinedSource() || snd->IsPaused() || snd->GetStream() != NULL)
+      {
+         if (snd->GetSource() != AL_NONE)
+         {
+            ++reserved;
+         }
+         continue;
+      }
+
+      if (snd->IsVirtual())
+      {
+         snd->AdvanceVirtual(float(deltaFrameTime));
+         if (!snd->IsPlaying())
+         {
+            continue;
+         }
+      }
+
+      VoiceCandidate candidate;
+      candidate.mSound = snd;
+      candidate.mReal  = !snd->IsVirtual();
+      candidate.mScore = snd->GetPriority() * EstimateAudibility(*snd, listenerPos);
+      if (candidate.mReal)
+      {
+         candidate.mScore *= VOICE_HYSTERESIS;
+      }
+      mVoiceCandidates.push_back(candidate);
+   }
+
+   size_t numReal = mVoiceCandidates.size();
+   if (mMaxRealVoices > 0)
+   {
+      numReal = std::min(numReal, size_t(mMaxRealVoices > reserved ? mMaxRealVoices - reserved : 0));
+      if (numReal < mVoiceCandidates.size())
+      {
+         std::nth_element(mVoiceCandidates.begin(), mVoiceCandidates.begin() + numReal, mVoiceCandidates.end());
+      }
+   }
+
+   // Free the sources of the losers before handing them to the winners.
+   for (size_t i = numReal; i < mVoiceCandidates.size(); ++i)
+   {
+      mVoiceCandidates[i].mSound->Virtualize();
+   }
+
+   mNumVirtualVoices = unsigned(mVoiceCandidates.size() - numReal);
+   for (size_t i = 0; i < numReal; ++i)
+   {
+      Sound* snd = mVoiceCandidates[i].mSound;
+      if (snd->IsVirtual() && !snd->Devirtualize())
+      {
+         // The device ran out of sources before our limit did.
+         ++mNumVirtualVoices;
+      }
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+unsigned int AudioManager::QueryDeviceSources() const
+{
+   ALCint sources = 0;
+#ifdef ALC_MONO_SOURCES
+   if (mDevice != NULL)
+   {
+      ALCint stereoSources = 0;
+      alcGetIntegerv(mDevice, ALC_MONO_SOURCES, 1, &sources);
+      alcGetIntegerv(mDevice, ALC_STEREO_SOURCES, 1, &stereoSources);
+      // Not all implementations answer; ignore the error and fall back to no limit.
+      alcGetError(mDevice);
+      sources = std::max(sources, 0) + std::max(stereoSources, 0);
+   }
+#endif
+   return unsigned(sources);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -803,7 +1296,21 @@ int AudioManager::LoadSoundBuffer(Sound& snd)
    const char* file = snd.GetFilename();
    int useCount = 0;
 
-   if (file != NULL)
+   if (file != NULL && snd.IsStreaming())
+   {
+      // Streams own their buffers, so there is nothing to share.
+      const std::string filename = FindSoundFile(file);
+      if (!filename.empty())
+      {
+         snd.SetStream(new SoundStream(filename));
+         useCount = 1;
+      }
+      else
+      {
+         LOG_ERROR("Unable to find the file \"" + std::string(file) + "\" to stream.");
+      }
+   }
+   else if (file != NULL)
    {
       // Load a new or an existing sound buffer.
       if (LoadFile(file) != AL_NONE)
@@ -843,6 +1350,13 @@ int AudioManager::UnloadSound(Sound* snd)
       return useCount;
    }
 
+   if (snd->GetStream() != NULL)
+   {
+      ReleaseSoundSource(*snd, "Sound source delete error", __FUNCTION__, __LINE__);
+      snd->SetStream(NULL);
+      return 0;
+   }
+
    snd->SetBuffer(AL_NONE);
 
    BufferData* bd = mBufferMap[file];
@@ -875,7 +1389,15 @@ int AudioManager::UnloadSound(Sound* snd)
       ReleaseSoundSource(*snd, "Sound source delete error", __FUNCTION__, __LINE__);
    }
 
-   UnloadFile(file);
+   // With a cache, the buffer stays until it is the least recently used one over the limit.
+   if (mBufferCacheLimit == 0)
+   {
+      UnloadFile(file);
+   }
+   else
+   {
+      TrimBufferCache();
+   }
    CheckForError("Unload Sound Error", __FUNCTION__, __LINE__);
 
    return useCount;
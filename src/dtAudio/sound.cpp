@@ -3,6 +3,7 @@
 //////////////////////////////////////////////////////////////////////
 
 #include <cfloat>
+#include <cmath>
 #include <dtAudio/dtaudio.h>
 #include <dtAudio/sound.h>
 #include <dtCore/scene.h>
@@ -95,6 +96,12 @@ Sound::Sound()
    , mDirection()
    , mVelocity()
    , mUserDefinedSource(false)
+   , mPriority(1.0f)
+   , mPlayPending(false)
+   , mVirtual(false)
+   , mVirtualOffset(0.0f)
+   , mVirtualLength(0.0f)
+   , mStreaming(false)
 {
    RegisterInstance(this);
 
@@ -119,6 +126,11 @@ Sound::~Sound()
 {
    if (IsSource(mSource))
    {
+      if (mStream.valid())
+      {
+         mStream->Stop(mSource);
+      }
+
       alDeleteSources(1, &mSource);
       CheckForError("Attempt to delete an OpenAL source", __FUNCTION__, __LINE__);
    } 
@@ -148,7 +160,8 @@ void Sound::OnSystem(const dtUtil::RefString& str, double /*deltaSim*/, double /
          //source needs to be deallocated. Saves memory -- some sound hardware
          //was only allowing for 32 sources.  Don't worry, we'll reallocate when
          //it's time to play again.
-         if (srcState == AL_STOPPED && !IsStopped())
+         //A stream that ran dry before its end is restarted by UpdateStream.
+         if (srcState == AL_STOPPED && !IsStopped() && (!mStream.valid() || mStream->IsFinished()))
          {
             Stop();
          }
@@ -188,6 +201,147 @@ void Sound::SetDirectionFromParent()
    SetDirection(dir);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+void Sound::SetTransformFromParent()
+{
+   dtCore::Transform transform;
+   GetTransform(transform, dtCore::Transformable::ABS_CS);
+
+   transform.GetTranslation(mPosition);
+   transform.GetRotation(mDirection);
+
+   // Virtual sounds only need the values for ranking and for when they get a source back.
+   if (mSource != AL_NONE && IsSource(mSource) == AL_TRUE)
+   {
+      alSource3f(mSource, AL_POSITION, mPosition[0], mPosition[1], mPosition[2]);
+      alSource3f(mSource, AL_DIRECTION, mDirection[0], mDirection[1], mDirection[2]);
+      CheckForError("Setting source position and direction", __FUNCTION__, __LINE__);
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Sound::SetPriority(float priority)
+{
+   mPriority = dtUtil::Max<float>(0.0f, priority);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+float Sound::GetPriority() const
+{
+   return mPriority;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Sound::BecomeVirtual(float offset)
+{
+   if (IsSource(mSource))
+   {
+      // Not ReleaseSource, which rewinds and so marks the sound stopped.
+      alSourceStop(mSource);
+      alDeleteSources(1, &mSource);
+      CheckForError("Attempting to release source of a virtual sound", __FUNCTION__, __LINE__);
+      mSource = AL_NONE;
+   }
+
+   // The offset is in buffer time, so undo the pitch scaling of the duration.
+   mVirtualLength = GetDurationOfPlay() * mPitch;
+   mVirtualOffset = offset;
+   mVirtual = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Sound::Virtualize()
+{
+   if (mVirtual || mUserDefinedSource || mStream.valid() || !GetState(PLAY))
+   {
+      return;
+   }
+
+   ALfloat offset = 0.0f;
+   if (IsSource(mSource))
+   {
+      alGetSourcef(mSource, AL_SEC_OFFSET, &offset);
+      CheckForError("Attempting to get playback position offset of source", __FUNCTION__, __LINE__);
+   }
+
+   BecomeVirtual(offset);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool Sound::Devirtualize()
+{
+   if (!mVirtual)
+   {
+      return true;
+   }
+
+   if (!RestoreSource())
+   {
+      return false;
+   }
+
+   mVirtual = false;
+
+   alSourcef(mSource, AL_SEC_OFFSET, mVirtualOffset);
+   CheckForError("Attempting to restore playback position offset of source", __FUNCTION__, __LINE__);
+
+   // A paused sound gets its source back but waits to be unpaused.
+   if (!GetState(PAUSE))
+   {
+      alSourcePlay(mSource);
+   }
+   return !CheckForError("Attempting to resume virtual source", __FUNCTION__, __LINE__);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Sound::AdvanceVirtual(float seconds)
+{
+   if (!mVirtual || GetState(PAUSE) || !GetState(PLAY))
+   {
+      return;
+   }
+
+   mVirtualOffset += seconds * mPitch;
+   if (mVirtualOffset >= mVirtualLength)
+   {
+      if (GetState(LOOP) && mVirtualLength > 0.0f)
+      {
+         mVirtualOffset = std::fmod(mVirtualOffset, mVirtualLength);
+      }
+      else
+      {
+         // Same as a real source running out.
+         Stop();
+      }
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Sound::SetStream(SoundStream* stream)
+{
+   if (mStream.valid() && IsSource(mSource))
+   {
+      mStream->Stop(mSource);
+   }
+
+   mStream = stream;
+
+   if (mStream.valid())
+   {
+      mStream->SetLooping(GetState(LOOP) != 0);
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Sound::UpdateStream()
+{
+   if (mStream.valid() && GetState(PLAY) && !GetState(PAUSE) && mSource != AL_NONE)
+   {
+      mStream->Update(mSource);
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
 void Sound::SetState(unsigned int flag)
 {
    mCommandState |= BIT(flag);
@@ -311,12 +465,15 @@ void Sound::Clear()
 {
    mFileName = "";
    mUserDefinedSource = false;
+   mPriority = 1.0f;
+   mStreaming = false;
  
    //clear out command queue
    while (mCommand.size())
    {
       mCommand.pop();
    }
+   mPlayPending = false;
 
    mCommandState = BIT(STOP);
 
@@ -331,6 +488,7 @@ void Sound::Clear()
    }
 
    ReleaseSource();
+   mStream = NULL;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -349,7 +507,11 @@ bool Sound::ReleaseSource()
       // have been freed will essentially become locked.
       //
       // Therefore:  Ensure the sound source is properly stopped before the
-      // sound buffer is deleted.
+      // sound buffer is deleted.  A stream also takes its buffers back.
+      if (mStream.valid())
+      {
+         mStream->Stop(mSource);
+      }
       alSourceStop(mSource);      
       retVal &= !CheckForError("Attempting to stop source", __FUNCTION__, __LINE__);
       RewindImmediately();
@@ -362,6 +524,9 @@ bool Sound::ReleaseSource()
       SetSource(AL_NONE);
    }
 
+   mVirtual = false;
+   mVirtualOffset = 0.0f;
+
    return retVal;
 }
 
@@ -376,6 +541,7 @@ void Sound::RunAllCommandsInQueue()
 
       if (nextCmd == kCommand[PLAY])
       {
+         mPlayPending = false;
          if (mPlayCB)
          {
             mPlayCB(static_cast<Sound*>(this), mPlayCBData);
@@ -492,6 +658,7 @@ void Sound::SetSource(ALuint s)
 void Sound::Play()
 {
    SetState(PLAY);
+   mPlayPending = true;
    mCommand.push(kCommand[PLAY]);
 }
 
@@ -500,7 +667,7 @@ bool Sound::PlayImmediately()
 {
    // first check if sound has a buffer
    ALint buf = GetBuffer();
-   if (alIsBuffer(buf) == AL_FALSE)
+   if (!mStream.valid() && alIsBuffer(buf) == AL_FALSE)
    {
       dtUtil::Log::GetInstance().LogMessage(dtUtil::Log::LOG_WARNING, __FUNCTION__, __LINE__,
                   "Invalid buffer when attempting to play sound");
@@ -510,10 +677,28 @@ bool Sound::PlayImmediately()
 
    SetState(PLAY);
 
+   // Playing a virtual sound starts it over, like playing a playing source does.
+   mVirtual = false;
+
    //Sources get deallocated when stopped: Restore source (if necessary)
    if (! RestoreSource())
    {
-      return false; // unable to restore source
+      // Out of sources, so keep playing virtually until the AudioManager frees one.
+      BecomeVirtual(0.0f);
+      return false;
+   }
+
+   if (mStream.valid())
+   {
+      // Queues whatever has been read so far and starts the source; a paused one just resumes.
+      mStream->Update(mSource);
+      ALint state = AL_STOPPED;
+      alGetSourcei(mSource, AL_SOURCE_STATE, &state);
+      if (state == AL_PAUSED)
+      {
+         alSourcePlay(mSource);
+      }
+      return !CheckForError("Attempting to play stream", __FUNCTION__, __LINE__);
    }
    
    alSourcePlay(mSource);
@@ -544,7 +729,8 @@ void Sound::PauseImmediately()
    else
    {
       ResetState(PAUSE);
-      if (GetState(PLAY))
+      // A virtual sound just resumes advancing until the AudioManager gives it a source.
+      if (GetState(PLAY) && !mVirtual)
       {
          PlayImmediately();
       }
@@ -562,6 +748,8 @@ void Sound::Stop()
 void Sound::StopImmediately()
 {
    SetState(STOP);
+   mVirtual = false;
+   mVirtualOffset = 0.0f;
    if (IsSource(mSource) && !mUserDefinedSource)
    {
       //alSourceStop(mSource);
@@ -610,7 +798,12 @@ void Sound::SetLooping(bool loop)
       loopInt = 0;
    }
 
-   if (IsSource(mSource))
+   if (mStream.valid())
+   {
+      // The stream wraps around itself; a looping source would repeat just its queue.
+      mStream->SetLooping(loop);
+   }
+   else if (IsSource(mSource))
    {
       alSourcei(mSource, AL_LOOPING, loopInt);
       CheckForError("Attempt to set source looping", __FUNCTION__, __LINE__);
@@ -653,7 +846,7 @@ void Sound::SetPlayTimeOffset(float seconds)
    CheckForError("Attempt determine if source is valid (is there a context?)",
                    __FUNCTION__, __LINE__);   
 
-   if (isSource == AL_TRUE)
+   if (isSource == AL_TRUE && !mStream.valid())
    {      
       alSourcef(mSource, AL_SEC_OFFSET, seconds);
       CheckForError("Attempt to set playback position offset in seconds on source",
@@ -985,6 +1178,11 @@ DOMElement* Sound::Serialize(const FrameData* d, XERCES_CPP_NAMESPACE_QUALIFIER
 
 float Sound::GetDurationOfPlay() const
 {
+   if (mStream.valid())
+   {
+      return mStream->GetDuration() / GetPitch();
+   }
+
    int dataSize = 0, bitsPerSample = 0, numChannels = 0;
    int samplesPerSecond = 0;
    if (mBuffer != AL_NONE && alIsBuffer(mBuffer)) 
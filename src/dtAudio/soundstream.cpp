@@ -0,0 +1,446 @@
+/* -*-c++-*-
+ * Delta3D Open Source Game and Simulation Engine
+ * Copyright (C) 2008, Alion Science and Technology, BMH Operation
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+
+#include <dtAudio/soundstream.h>
+#include <dtAudio/dtaudio.h>
+#include <dtUtil/log.h>
+#include <dtUtil/threadpool.h>
+
+#include <OpenThreads/ScopedLock>
+
+#include <algorithm>
+#include <cstring>
+
+namespace dtAudio
+{
+   /////////////////////////////////////////////////////////////////////////////
+   // Reads the next chunks of a stream on the IO queue.
+   /////////////////////////////////////////////////////////////////////////////
+   class SoundStreamReadTask : public dtUtil::ThreadPoolTask
+   {
+   public:
+      explicit SoundStreamReadTask(SoundStream& stream)
+         : mStream(stream)
+      {
+         SetName("Sound Stream Read");
+      }
+
+      void operator()() override
+      {
+         mStream.ReadChunks();
+      }
+
+   private:
+      SoundStream& mStream;
+   };
+
+   namespace
+   {
+      //////////////////////////////////////////////////////////////////////////
+      unsigned int ReadLittleEndian(std::istream& in, unsigned int numBytes)
+      {
+         unsigned char bytes[4] = { 0, 0, 0, 0 };
+         in.read(reinterpret_cast<char*>(bytes), numBytes);
+
+         unsigned int value = 0;
+         for (unsigned int i = numBytes; i > 0; --i)
+         {
+            value = (value << 8) | bytes[i - 1];
+         }
+         return value;
+      }
+
+      const unsigned int WAVE_FORMAT_PCM = 1;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   SoundStream::SoundStream(const std::string& file)
+      : mFileName(file)
+      , mHeaderRead(false)
+      , mDataStart(0)
+      , mDataSize(0)
+      , mReadPos(0)
+      , mChunkBytes(CHUNK_BYTES)
+      , mFormat(AL_NONE)
+      , mFrequency(0)
+      , mBytesPerSecond(0)
+      , mLooping(false)
+      , mReading(false)
+      , mEndOfFile(false)
+      , mValid(true)
+      , mBuffersCreated(false)
+   {
+      mTask = new SoundStreamReadTask(*this);
+      RequestRead();
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   SoundStream::~SoundStream()
+   {
+      // The task reads into this stream, so it has to finish first.
+      WaitForRead();
+
+      if (mBuffersCreated)
+      {
+         alDeleteBuffers(NUM_BUFFERS, mBuffers);
+         CheckForError("Deleting stream buffers", __FUNCTION__, __LINE__);
+      }
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   bool SoundStream::IsValid() const
+   {
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+      return mValid;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void SoundStream::SetLooping(bool loop)
+   {
+      {
+         OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+         mLooping = loop;
+         if (!loop || !mEndOfFile)
+         {
+            return;
+         }
+
+         // Already hit the end, so the reading has to start again to wrap around.
+         mEndOfFile = false;
+      }
+
+      RequestRead();
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void SoundStream::Update(ALuint source)
+   {
+      if (!mBuffersCreated)
+      {
+         alGenBuffers(NUM_BUFFERS, mBuffers);
+         if (CheckForError("Generating stream buffers", __FUNCTION__, __LINE__))
+         {
+            return;
+         }
+         mBuffersCreated = true;
+         mFreeBuffers.assign(mBuffers, mBuffers + NUM_BUFFERS);
+      }
+
+      ALint processed = 0;
+      alGetSourcei(source, AL_BUFFERS_PROCESSED, &processed);
+      for (; processed > 0; --processed)
+      {
+         ALuint buffer = AL_NONE;
+         alSourceUnqueueBuffers(source, 1, &buffer);
+         mFreeBuffers.push_back(buffer);
+      }
+      CheckForError("Unqueueing played stream buffers", __FUNCTION__, __LINE__);
+
+      bool queued = false;
+      std::vector<char> chunk;
+      while (!mFreeBuffers.empty())
+      {
+         ALenum format = AL_NONE;
+         ALsizei frequency = 0;
+         {
+            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+            if (mChunks.empty())
+            {
+               break;
+            }
+            chunk.swap(mChunks.front());
+            mChunks.pop_front();
+            format = mFormat;
+            frequency = mFrequency;
+         }
+
+         ALuint buffer = mFreeBuffers.back();
+         alBufferData(buffer, format, &chunk[0], ALsizei(chunk.size()), frequency);
+         alSourceQueueBuffers(source, 1, &buffer);
+         if (CheckForError("Queueing stream buffer", __FUNCTION__, __LINE__))
+         {
+            break;
+         }
+         mFreeBuffers.pop_back();
+         queued = true;
+      }
+
+      RequestRead();
+
+      if (queued)
+      {
+         // Either just starting, or the reading fell behind and the source ran dry.
+         ALint state = AL_STOPPED;
+         alGetSourcei(source, AL_SOURCE_STATE, &state);
+         if (state == AL_STOPPED || state == AL_INITIAL)
+         {
+            alSourcePlay(source);
+            CheckForError("Starting stream source", __FUNCTION__, __LINE__);
+         }
+      }
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void SoundStream::Stop(ALuint source)
+   {
+      if (source != AL_NONE)
+      {
+         alSourceStop(source);
+         alSourcei(source, AL_BUFFER, AL_NONE);
+         CheckForError("Unqueueing stream buffers", __FUNCTION__, __LINE__);
+      }
+
+      if (mBuffersCreated)
+      {
+         mFreeBuffers.assign(mBuffers, mBuffers + NUM_BUFFERS);
+      }
+
+      // Wait out the running read before moving its position.
+      WaitForRead();
+      {
+         OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+         mChunks.clear();
+         mEndOfFile = false;
+      }
+      mReadPos = 0;
+
+      RequestRead();
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   bool SoundStream::IsFinished() const
+   {
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+      return !mValid || (mEndOfFile && mChunks.empty());
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   float SoundStream::GetDuration() const
+   {
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+      if (mBytesPerSecond == 0)
+      {
+         return 0.0f;
+      }
+      return float(mDataSize) / float(mBytesPerSecond);
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   size_t SoundStream::GetMemoryUsage() const
+   {
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+      size_t bytes = mBuffersCreated ? NUM_BUFFERS * mChunkBytes : 0;
+      for (std::deque<std::vector<char> >::const_iterator i = mChunks.begin(); i != mChunks.end(); ++i)
+      {
+         bytes += i->size();
+      }
+      return bytes;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void SoundStream::RequestRead()
+   {
+      {
+         OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+         if (mReading || mEndOfFile || !mValid || mChunks.size() >= NUM_BUFFERS)
+         {
+            return;
+         }
+         mReading = true;
+      }
+
+      if (dtUtil::ThreadPool::IsInitialized())
+      {
+         dtUtil::ThreadPool::AddTask(*mTask, dtUtil::ThreadPool::IO);
+      }
+      else
+      {
+         ReadChunks();
+      }
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void SoundStream::WaitForRead()
+   {
+      // The task is added again for every read, so its wait block can be released by the
+      // previous read while the next one runs.  A read still queued when the pool shuts
+      // down never runs, so stop waiting then.
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+      while (mReading && dtUtil::ThreadPool::IsInitialized())
+      {
+         mReadDone.wait(&mMutex, 100);
+      }
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void SoundStream::FinishRead()
+   {
+      mReading = false;
+      mReadDone.broadcast();
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void SoundStream::ReadChunks()
+   {
+      if (!mHeaderRead && !ReadHeader())
+      {
+         LOG_WARNING("Unable to stream \"" + mFileName + "\"; only PCM wav files can be streamed.");
+         OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+         mValid = false;
+         FinishRead();
+         return;
+      }
+
+      std::vector<char> chunk;
+      while (true)
+      {
+         bool looping = false;
+         {
+            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+            if (!chunk.empty())
+            {
+               mChunks.push_back(std::vector<char>());
+               mChunks.back().swap(chunk);
+            }
+
+            if (mChunks.size() >= NUM_BUFFERS)
+            {
+               FinishRead();
+               return;
+            }
+            looping = mLooping;
+
+            if (mReadPos >= mDataSize && (!looping || mDataSize == 0))
+            {
+               mEndOfFile = true;
+               FinishRead();
+               return;
+            }
+         }
+
+         if (mReadPos >= mDataSize)
+         {
+            mReadPos = 0;
+         }
+
+         chunk.resize(std::min(mChunkBytes, mDataSize - mReadPos));
+         mFile.clear();
+         mFile.seekg(mDataStart + std::streamoff(mReadPos));
+         mFile.read(&chunk[0], chunk.size());
+         if (size_t(mFile.gcount()) < chunk.size())
+         {
+            // The file is shorter than its header says, so end where it does.
+            chunk.resize(size_t(mFile.gcount()));
+            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+            mDataSize = mReadPos + unsigned(chunk.size());
+         }
+         mReadPos += unsigned(chunk.size());
+      }
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   bool SoundStream::ReadHeader()
+   {
+      mFile.open(mFileName.c_str(), std::ios::in | std::ios::binary);
+      if (!mFile.is_open())
+      {
+         return false;
+      }
+
+      char id[4];
+      mFile.read(id, sizeof(id));
+      ReadLittleEndian(mFile, 4);
+      if (!mFile || std::memcmp(id, "RIFF", sizeof(id)) != 0
+         || !mFile.read(id, sizeof(id)) || std::memcmp(id, "WAVE", sizeof(id)) != 0)
+      {
+         return false;
+      }
+
+      unsigned int formatTag = 0, channels = 0, sampleRate = 0, blockAlign = 0, bitsPerSample = 0;
+      bool haveFormat = false;
+      std::streamoff dataStart = 0;
+      unsigned int dataSize = 0;
+
+      while (dataStart == 0 && mFile.read(id, sizeof(id)))
+      {
+         unsigned int chunkSize = ReadLittleEndian(mFile, 4);
+         if (std::memcmp(id, "fmt ", sizeof(id)) == 0 && chunkSize >= 16)
+         {
+            formatTag     = ReadLittleEndian(mFile, 2);
+            channels      = ReadLittleEndian(mFile, 2);
+            sampleRate    = ReadLittleEndian(mFile, 4);
+            ReadLittleEndian(mFile, 4); // bytes per second
+            blockAlign    = ReadLittleEndian(mFile, 2);
+            bitsPerSample = ReadLittleEndian(mFile, 2);
+            mFile.seekg(chunkSize - 16 + (chunkSize & 1), std::ios::cur);
+            haveFormat = true;
+         }
+         else if (std::memcmp(id, "data", sizeof(id)) == 0)
+         {
+            dataStart = mFile.tellg();
+            dataSize = chunkSize;
+         }
+         else
+         {
+            mFile.seekg(chunkSize + (chunkSize & 1), std::ios::cur);
+         }
+      }
+
+      if (!haveFormat || dataStart <= 0 || formatTag != WAVE_FORMAT_PCM || blockAlign == 0)
+      {
+         return false;
+      }
+
+      ALenum format = AL_NONE;
+      if (channels == 1)
+      {
+         format = bitsPerSample == 8 ? AL_FORMAT_MONO8 : (bitsPerSample == 16 ? AL_FORMAT_MONO16 : AL_NONE);
+      }
+      else if (channels == 2)
+      {
+         format = bitsPerSample == 8 ? AL_FORMAT_STEREO8 : (bitsPerSample == 16 ? AL_FORMAT_STEREO16 : AL_NONE);
+      }
+
+      if (format == AL_NONE)
+      {
+         return false;
+      }
+
+      // Recorders that stream their output often leave the size unset.
+      mFile.clear();
+      mFile.seekg(0, std::ios::end);
+      const std::streamoff available = mFile.tellg() - dataStart;
+      if (std::streamoff(dataSize) > available)
+      {
+         dataSize = unsigned(available);
+      }
+
+      mDataStart = dataStart;
+      mHeaderRead = true;
+
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+      mChunkBytes = CHUNK_BYTES - CHUNK_BYTES % blockAlign;
+      mDataSize = dataSize - dataSize % blockAlign;
+      mFormat = format;
+      mFrequency = ALsizei(sampleRate);
+      mBytesPerSecond = sampleRate * blockAlign;
+      return true;
+   }
+} // namespace dtAudio
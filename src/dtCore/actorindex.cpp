@@ -0,0 +1,220 @@
+/*
+ * Delta3D Open Source Game and Simulation Engine
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include <prefix/dtcoreprefix.h>
+#include <dtCore/actorindex.h>
+#include <dtCore/actortype.h>
+
+#include <dtUtil/stringutils.h>
+
+#include <algorithm>
+
+namespace dtCore
+{
+   namespace
+   {
+      struct ActorIdLess
+      {
+         bool operator()(const BaseActorObject* lhs, const BaseActorObject* rhs) const
+         {
+            return lhs->GetId() < rhs->GetId();
+         }
+      };
+
+      /// The sets are ordered by address, so results are sorted to be the same from run to run.
+      void SortFrom(ActorPtrVector& toFill, size_t first)
+      {
+         std::sort(toFill.begin() + first, toFill.end(), ActorIdLess());
+      }
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   ActorIndex::ActorIndex()
+      : mSize(0)
+   {
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   ActorIndex::~ActorIndex()
+   {
+      Clear();
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void ActorIndex::Add(BaseActorObject& actor)
+   {
+      ActorSet& typeSet = mTypeIndex[&actor.GetActorType()];
+      if (!typeSet.insert(&actor).second)
+      {
+         return;
+      }
+
+      mNameIndex[actor.GetName()].insert(&actor);
+      actor.AddNameChangeListener(*this);
+      ++mSize;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   bool ActorIndex::Remove(BaseActorObject& actor)
+   {
+      TypeMap::iterator t = mTypeIndex.find(&actor.GetActorType());
+      if (t == mTypeIndex.end() || t->second.erase(&actor) == 0)
+      {
+         return false;
+      }
+
+      if (t->second.empty())
+      {
+         mTypeIndex.erase(t);
+      }
+
+      RemoveFromNameIndex(actor, actor.GetName());
+      actor.RemoveNameChangeListener(*this);
+      --mSize;
+      return true;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void ActorIndex::Clear()
+   {
+      for (TypeMap::iterator t = mTypeIndex.begin(); t != mTypeIndex.end(); ++t)
+      {
+         for (ActorSet::iterator a = t->second.begin(); a != t->second.end(); ++a)
+         {
+            (*a)->RemoveNameChangeListener(*this);
+         }
+      }
+
+      mTypeIndex.clear();
+      mNameIndex.clear();
+      mSize = 0;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   unsigned ActorIndex::GetSize() const
+   {
+      return mSize;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void ActorIndex::FindByName(const std::string& name, ActorPtrVector& toFill) const
+   {
+      const size_t first = toFill.size();
+      std::string::size_type wildcard = name.find_first_of("*?");
+      if (wildcard == std::string::npos)
+      {
+         NameMap::const_iterator i = mNameIndex.find(name);
+         if (i != mNameIndex.end())
+         {
+            Append(i->second, toFill);
+            SortFrom(toFill, first);
+         }
+         return;
+      }
+
+      // Only names sharing the literal prefix can match, and they are sorted together.
+      const std::string prefix = name.substr(0, wildcard);
+      for (NameMap::const_iterator i = mNameIndex.lower_bound(prefix);
+         i != mNameIndex.end() && i->first.compare(0, prefix.size(), prefix) == 0; ++i)
+      {
+         if (dtUtil::Match(name.c_str(), i->first.c_str()))
+         {
+            Append(i->second, toFill);
+         }
+      }
+      SortFrom(toFill, first);
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void ActorIndex::FindByType(const ActorType& type, ActorPtrVector& toFill) const
+   {
+      const size_t first = toFill.size();
+      for (TypeMap::const_iterator t = mTypeIndex.begin(); t != mTypeIndex.end(); ++t)
+      {
+         if (t->first->InstanceOf(type))
+         {
+            Append(t->second, toFill);
+         }
+      }
+      SortFrom(toFill, first);
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void ActorIndex::FindByExactType(const ActorType& type, ActorPtrVector& toFill) const
+   {
+      const size_t first = toFill.size();
+      TypeMap::const_iterator t = mTypeIndex.find(&type);
+      if (t != mTypeIndex.end())
+      {
+         Append(t->second, toFill);
+         SortFrom(toFill, first);
+      }
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void ActorIndex::FindByClassName(const dtUtil::RefString& className, ActorPtrVector& toFill) const
+   {
+      const size_t first = toFill.size();
+      // The class hierarchy is shared by all actors of a type.
+      for (TypeMap::const_iterator t = mTypeIndex.begin(); t != mTypeIndex.end(); ++t)
+      {
+         if (t->first->GetSharedClassInfo().IsInstanceOf(className))
+         {
+            Append(t->second, toFill);
+         }
+      }
+      SortFrom(toFill, first);
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void ActorIndex::GetActorTypes(std::vector<const ActorType*>& toFill) const
+   {
+      toFill.clear();
+      toFill.reserve(mTypeIndex.size());
+      for (TypeMap::const_iterator t = mTypeIndex.begin(); t != mTypeIndex.end(); ++t)
+      {
+         toFill.push_back(t->first);
+      }
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void ActorIndex::OnActorRenamed(BaseActorObject& actor, const std::string& oldName)
+   {
+      RemoveFromNameIndex(actor, oldName);
+      mNameIndex[actor.GetName()].insert(&actor);
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void ActorIndex::Append(const ActorSet& actors, ActorPtrVector& toFill)
+   {
+      toFill.insert(toFill.end(), actors.begin(), actors.end());
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void ActorIndex::RemoveFromNameIndex(BaseActorObject& actor, const std::string& name)
+   {
+      NameMap::iterator i = mNameIndex.find(name);
+      if (i != mNameIndex.end())
+      {
+         i->second.erase(&actor);
+         if (i->second.empty())
+         {
+            mNameIndex.erase(i);
+         }
+      }
+   }
+}
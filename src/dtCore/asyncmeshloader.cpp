@@ -0,0 +1,285 @@
+/* -*-c++-*-
+ * Delta3D Open Source Game and Simulation Engine
+ * Copyright (C) 2004-2005 MOVES Institute
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+
+#include <prefix/dtcoreprefix.h>
+#include <dtCore/asyncmeshloader.h>
+#include <dtCore/object.h>
+#include <dtCore/system.h>
+#include <dtUtil/log.h>
+#include <dtUtil/threadpool.h>
+
+#include <OpenThreads/ScopedLock>
+#include <osg/CopyOp>
+#include <osg/Timer>
+#include <osgDB/Registry>
+
+namespace dtCore
+{
+   /////////////////////////////////////////////////////////////////////////////
+   dtCore::RefPtr<AsyncMeshLoader> AsyncMeshLoader::mInstance(NULL);
+
+   /////////////////////////////////////////////////////////////////////////////
+   AsyncMeshLoader::AsyncMeshLoader()
+      : dtCore::Base("AsyncMeshLoader")
+      , mAttachBudgetMS(2.0)
+   {
+      dtCore::System::GetInstance().TickSignal.connect_slot(this, &AsyncMeshLoader::OnSystem);
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   AsyncMeshLoader::~AsyncMeshLoader()
+   {
+      // The tasks reference nothing of ours, but don't leave reads running past shutdown.
+      // Once the pool is shut down, a task still in its queue will never run, so don't wait.
+      if (!dtUtil::ThreadPool::IsInitialized())
+      {
+         return;
+      }
+
+      for (PendingLoadMap::iterator i = mPendingLoads.begin(); i != mPendingLoads.end(); ++i)
+      {
+         i->second.mTask->WaitUntilComplete();
+      }
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   AsyncMeshLoader& AsyncMeshLoader::GetInstance()
+   {
+      if (mInstance == NULL)
+      {
+         mInstance = new AsyncMeshLoader();
+      }
+
+      return *mInstance;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void AsyncMeshLoader::Destroy()
+   {
+      mInstance = NULL;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   bool AsyncMeshLoader::RequestLoad(Object& object, const std::string& filename, bool useCache)
+   {
+      CancelLoad(object);
+
+      if (useCache)
+      {
+         dtCore::RefPtr<osg::Node> cached = FindCachedModel(filename);
+         if (cached.valid())
+         {
+            DeliverToObject(object, filename, cached.get());
+            return true;
+         }
+      }
+
+      PendingLoadMap::iterator found = mPendingLoads.find(filename);
+      if (found == mPendingLoads.end())
+      {
+         if (!dtUtil::ThreadPool::IsInitialized())
+         {
+            return false;
+         }
+
+         PendingLoad& load = mPendingLoads[filename];
+         load.mUseCache = useCache;
+         load.mTask = new dtUtil::ReadNodeThreadPoolTask;
+         load.mTask->SetFileToLoad(filename);
+         load.mTask->SetUseFileCaching(useCache);
+
+         // Clone the registry options like Loadable does, so they reach the plugins.
+         osgDB::Registry* reg = osgDB::Registry::instance();
+         if (reg->getOptions() != NULL)
+         {
+            load.mTask->SetLoadOptions(static_cast<osgDB::Options*>(reg->getOptions()->clone(osg::CopyOp::SHALLOW_COPY)));
+         }
+
+         dtUtil::ThreadPool::AddTask(*load.mTask, dtUtil::ThreadPool::IO);
+         found = mPendingLoads.find(filename);
+      }
+
+      found->second.mRequesters.push_back(std::make_pair(dtCore::ObserverPtr<Object>(&object), useCache));
+      mRequests[&object] = filename;
+      return true;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void AsyncMeshLoader::CancelLoad(Object& object)
+   {
+      RequestMap::iterator request = mRequests.find(&object);
+      if (request == mRequests.end())
+      {
+         return;
+      }
+
+      PendingLoadMap::iterator found = mPendingLoads.find(request->second);
+      if (found != mPendingLoads.end())
+      {
+         std::vector<std::pair<dtCore::ObserverPtr<Object>, bool> >& requesters = found->second.mRequesters;
+         for (size_t i = 0; i < requesters.size(); ++i)
+         {
+            if (requesters[i].first.get() == &object)
+            {
+               requesters.erase(requesters.begin() + i);
+               break;
+            }
+         }
+         // The load keeps running with no requesters so its result can still fill the cache.
+      }
+
+      mRequests.erase(request);
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   bool AsyncMeshLoader::IsLoading(const Object& object) const
+   {
+      return mRequests.find(&object) != mRequests.end();
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void AsyncMeshLoader::ProcessCompletedLoads(double budgetMS)
+   {
+      osg::Timer* timer = osg::Timer::instance();
+      osg::Timer_t startTick = timer->tick();
+      bool first = true;
+
+      PendingLoadMap::iterator i = mPendingLoads.begin();
+      while (i != mPendingLoads.end())
+      {
+         PendingLoad& load = i->second;
+         if (!load.mTask->IsComplete())
+         {
+            ++i;
+            continue;
+         }
+
+         // IsComplete can be seen just before the task finishes returning.
+         load.mTask->WaitUntilComplete();
+
+         osg::Node* node = load.mTask->GetLoadedNode();
+         if (node == NULL)
+         {
+            LOG_WARNING("Can't load '" + i->first + "'");
+         }
+         else if (load.mUseCache)
+         {
+            AddCachedModel(i->first, *node);
+         }
+
+         while (!load.mRequesters.empty())
+         {
+            if (!first && timer->delta_m(startTick, timer->tick()) >= budgetMS)
+            {
+               return;
+            }
+            first = false;
+
+            dtCore::ObserverPtr<Object> requester = load.mRequesters.front().first;
+            bool requesterUsesCache = load.mRequesters.front().second;
+            load.mRequesters.erase(load.mRequesters.begin());
+
+            if (!requester.valid())
+            {
+               continue;
+            }
+
+            // Objects sharing a cached load get the same node, anyone else gets their own copy.
+            dtCore::RefPtr<osg::Node> toAttach = node;
+            bool shared = load.mUseCache && requesterUsesCache;
+            if (node != NULL && !shared)
+            {
+               if (load.mUseCache || load.mOriginalUsed)
+               {
+                  toAttach = static_cast<osg::Node*>(node->clone(osg::CopyOp::DEEP_COPY_NODES));
+               }
+               load.mOriginalUsed = true;
+            }
+
+            mRequests.erase(requester.get());
+            DeliverToObject(*requester, i->first, toAttach.get());
+         }
+
+         mPendingLoads.erase(i++);
+      }
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void AsyncMeshLoader::DeliverToObject(Object& object, const std::string& filename, osg::Node* node)
+   {
+      object.OnAsyncMeshLoaded(filename, node);
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   dtCore::RefPtr<osg::Node> AsyncMeshLoader::FindCachedModel(const std::string& filename) const
+   {
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mCacheMutex);
+      ModelCache::const_iterator found = mModelCache.find(filename);
+      if (found == mModelCache.end())
+      {
+         return NULL;
+      }
+      return found->second;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void AsyncMeshLoader::AddCachedModel(const std::string& filename, osg::Node& node)
+   {
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mCacheMutex);
+      mModelCache[filename] = &node;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   unsigned AsyncMeshLoader::ReleaseUnusedModels()
+   {
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mCacheMutex);
+      unsigned numReleased = 0;
+      ModelCache::iterator i = mModelCache.begin();
+      while (i != mModelCache.end())
+      {
+         if (i->second->referenceCount() == 1)
+         {
+            mModelCache.erase(i++);
+            ++numReleased;
+         }
+         else
+         {
+            ++i;
+         }
+      }
+      return numReleased;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void AsyncMeshLoader::ClearModelCache()
+   {
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mCacheMutex);
+      mModelCache.clear();
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void AsyncMeshLoader::OnSystem(const dtUtil::RefString& str, double deltaSim, double deltaReal)
+   {
+      if (str == dtCore::System::MESSAGE_PRE_FRAME && !mPendingLoads.empty())
+      {
+         ProcessCompletedLoads(mAttachBudgetMS);
+      }
+   }
+}
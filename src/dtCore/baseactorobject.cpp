@@ -189,7 +189,23 @@ namespace dtCore
    /////////////////////////////////////////////////////////////////////////////
    void BaseActorObject::SetName(const std::string& name)
    {
-      mName = name;
+      if (!mNameChangeListeners.empty() && name != GetName())
+      {
+         std::string oldName = GetName();
+         mName = name;
+
+         // Copy in case a listener removes itself.
+         std::vector<NameChangeListener*> listeners(mNameChangeListeners);
+         for (unsigned i = 0; i < listeners.size(); ++i)
+         {
+            listeners[i]->OnActorRenamed(*this, oldName);
+         }
+      }
+      else
+      {
+         mName = name;
+      }
+
       if (GetDrawable() != NULL)
       {
          GetDrawable()->SetName(name);
@@ -200,6 +216,25 @@ namespace dtCore
       }
    }
 
+   /////////////////////////////////////////////////////////////////////////////
+   void BaseActorObject::AddNameChangeListener(NameChangeListener& listener)
+   {
+      if (std::find(mNameChangeListeners.begin(), mNameChangeListeners.end(), &listener) == mNameChangeListeners.end())
+      {
+         mNameChangeListeners.push_back(&listener);
+      }
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void BaseActorObject::RemoveNameChangeListener(NameChangeListener& listener)
+   {
+      std::vector<NameChangeListener*>::iterator i = std::find(mNameChangeListeners.begin(), mNameChangeListeners.end(), &listener);
+      if (i != mNameChangeListeners.end())
+      {
+         mNameChangeListeners.erase(i);
+      }
+   }
+
    /////////////////////////////////////////////////////////////////////////////
    bool BaseActorObject::IsGhost() const
    {
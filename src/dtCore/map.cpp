@@ -37,6 +37,7 @@
 
 #include <osgDB/FileNameUtils>
 
+#include <algorithm>
 #include <cstring>
 
 namespace dtCore
@@ -130,6 +131,18 @@ namespace dtCore
       }
    }
 
+   ////////////////////////////////////////////////////////////////////////////////
+   namespace
+   {
+      struct ActorIdLess
+      {
+         bool operator()(const BaseActorObject* lhs, const BaseActorObject* rhs) const
+         {
+            return lhs->GetId() < rhs->GetId();
+         }
+      };
+   }
+
    ////////////////////////////////////////////////////////////////////////////////
    void Map::FindProxies(std::vector<dtCore::RefPtr<BaseActorObject> >& container,
                          const std::string& name,
@@ -138,32 +151,9 @@ namespace dtCore
                          const std::string& className,
                          PlaceableFilter placeable)
    {
-      container.clear();
-
-      if (name != "" || category != "" || typeName != "" || className != "" || placeable != Either )
-      {
-         for (std::map<dtCore::UniqueId, dtCore::RefPtr<BaseActorObject> >::iterator i = mActorMap.begin();
-              i != mActorMap.end(); ++i)
-         {
-            BaseActorObject* ap = i->second.get();
-
-            if (name == "" || WildMatch(name, ap->GetName()))
-               if (MatchesSearch(*ap, category, typeName, className, placeable))
-                  container.push_back(dtCore::RefPtr<BaseActorObject>(ap));
-         }
-      }
-      else
-      {
-         //return everything.
-         container.reserve(mActorMap.size());
-         for (std::map<dtCore::UniqueId, dtCore::RefPtr<BaseActorObject> >::iterator i = mActorMap.begin();
-              i != mActorMap.end(); ++i)
-         {
-            BaseActorObject* ap = i->second.get();
-            container.push_back(ap);
-         }
-      }
-
+      ActorPtrVector found;
+      FindProxies(found, name, category, typeName, className, placeable);
+      container.assign(found.begin(), found.end());
    }
 
    ////////////////////////////////////////////////////////////////////////////////
@@ -173,32 +163,59 @@ namespace dtCore
                          const std::string& typeName,
                          const std::string& className,
                          PlaceableFilter placeable) const
+   {
+      ActorPtrVector found;
+      FindProxies(found, name, category, typeName, className, placeable);
+      container.assign(found.begin(), found.end());
+   }
+
+   ////////////////////////////////////////////////////////////////////////////////
+   void Map::FindProxies(ActorPtrVector& container,
+                         const std::string& name,
+                         const std::string& category,
+                         const std::string& typeName,
+                         const std::string& className,
+                         PlaceableFilter placeable) const
    {
       container.clear();
 
-      if (name != "" || category != "" || typeName != "" || className != "" || placeable != Either)
+      if (name.empty() && category.empty() && typeName.empty() && className.empty() && placeable == Either)
       {
-         for (std::map<dtCore::UniqueId, dtCore::RefPtr<BaseActorObject> >::const_iterator i = mActorMap.begin();
-              i != mActorMap.end(); ++i)
-         {
-            const BaseActorObject* ap = i->second.get();
+         //return everything.
+         GetAllProxies(container);
+         return;
+      }
 
-            if (name == "" || WildMatch(name, ap->GetName()))
-               if (MatchesSearch(*ap, category, typeName, className, placeable))
-                  container.push_back(ap);
-         }
+      if (!name.empty())
+      {
+         mActorIndex.FindByName(name, container);
       }
       else
       {
-         //return everything.
-         container.reserve(mActorMap.size());
-         for (std::map<dtCore::UniqueId, dtCore::RefPtr<BaseActorObject> >::const_iterator i = mActorMap.begin();
-              i != mActorMap.end(); ++i)
+         // The type and class criteria only depend on the actor type, so test each type once.
+         std::vector<const ActorType*> types;
+         mActorIndex.GetActorTypes(types);
+         for (unsigned i = 0; i < types.size(); ++i)
          {
-            const BaseActorObject* ap = i->second.get();
-            container.push_back(ap);
+            if (MatchesTypeSearch(*types[i], category, typeName, className))
+            {
+               mActorIndex.FindByExactType(*types[i], container);
+            }
          }
       }
+
+      unsigned kept = 0;
+      for (unsigned i = 0; i < container.size(); ++i)
+      {
+         if (MatchesSearch(*container[i], category, typeName, className, placeable))
+         {
+            container[kept++] = container[i];
+         }
+      }
+      container.resize(kept);
+
+      // Keep the same order as iterating the map.
+      std::sort(container.begin(), container.end(), ActorIdLess());
    }
 
    ////////////////////////////////////////////////////////////////////////////////
@@ -208,12 +225,30 @@ namespace dtCore
                            const std::string& className,
                            PlaceableFilter placeable) const
    {
-      if (!className.empty() && !actorProxy.IsInstanceOf(className))
+      if (!MatchesTypeSearch(actorProxy.GetActorType(), category, typeName, className))
+         return false;
+
+      if (placeable == Placeable && !actorProxy.IsPlaceable())
+         return false;
+      else if (placeable == NotPlaceable && actorProxy.IsPlaceable())
+         return false;
+
+      return true;
+
+   }
+
+   ////////////////////////////////////////////////////////////////////////////////
+   bool Map::MatchesTypeSearch(const ActorType& type,
+                               const std::string& category,
+                               const std::string& typeName,
+                               const std::string& className) const
+   {
+      if (!className.empty() && !type.GetSharedClassInfo().IsInstanceOf(className))
          return false;
 
       if (!typeName.empty() || !category.empty())
       {
-         const ActorType* actorType = &actorProxy.GetActorType();
+         const ActorType* actorType = &type;
          bool matches = false;
 
          while (!matches && actorType != NULL)
@@ -238,13 +273,7 @@ namespace dtCore
             return false;
       }
 
-      if (placeable == Placeable && !actorProxy.IsPlaceable())
-         return false;
-      else if (placeable == NotPlaceable && actorProxy.IsPlaceable())
-         return false;
-
       return true;
-
    }
 
    ////////////////////////////////////////////////////////////////////////////////
@@ -292,6 +321,7 @@ namespace dtCore
 
       if (mActorMap.insert(std::make_pair(proxy.GetId(), dtCore::RefPtr<BaseActorObject>(&proxy))).second)
       {
+         mActorIndex.Add(proxy);
          const std::set<dtUtil::RefString>& hierarchy = proxy.GetActorType().GetSharedClassInfo().mClassHierarchy;
          mProxyActorClasses.insert(proxy.GetActorType().GetSharedClassInfo().GetClassName());
          mProxyActorClasses.insert(hierarchy.begin(), hierarchy.end());
@@ -358,7 +388,7 @@ namespace dtCore
 
          //notify proxy it is being removed from map
          proxy.OnRemove();
-         std::vector<dtCore::RefPtr<BaseActorObject> > proxies;
+         ActorPtrVector proxies;
 
          GetAllProxies(proxies);
          for (unsigned int j = 0; j < proxies.size(); j++)
@@ -389,6 +419,7 @@ namespace dtCore
                }
             }
          }
+         mActorIndex.Remove(*i->second);
          mActorMap.erase(i);
          return true;
       }
@@ -423,6 +454,7 @@ namespace dtCore
    ////////////////////////////////////////////////////////////////////////////////
    void Map::ClearProxies()
    {
+      mActorIndex.Clear();
       mActorMap.clear();
       mProxyActorClasses.clear();
    }
@@ -866,6 +898,17 @@ namespace dtCore
       FindProxies(container, "");
    }
 
+   //////////////////////////////////////////////////////////////////////////
+   void Map::GetAllProxies(ActorPtrVector& container) const
+   {
+      container.clear();
+      container.reserve(mActorMap.size());
+      for (ActorMap::const_iterator i = mActorMap.begin(); i != mActorMap.end(); ++i)
+      {
+         container.push_back(i->second.get());
+      }
+   }
+
    //////////////////////////////////////////////////////////////////////////
    const std::set<dtUtil::RefString>& Map::GetProxyActorClasses() const
    {
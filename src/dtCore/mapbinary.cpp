@@ -0,0 +1,1573 @@
+/* -*-c++-*-
+ * Delta3D Open Source Game and Simulation Engine
+ * Copyright (C) 2005, BMH Associates, Inc.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include <prefix/dtcoreprefix.h>
+#include <dtCore/mapbinary.h>
+
+#include <dtCore/actoractorproperty.h>
+#include <dtCore/actorcomponentcontainer.h>
+#include <dtCore/actorfactory.h>
+#include <dtCore/actortype.h>
+#include <dtCore/baseactorobject.h>
+#include <dtCore/booleanactorproperty.h>
+#include <dtCore/doubleactorproperty.h>
+#include <dtCore/environmentactor.h>
+#include <dtCore/exceptionenum.h>
+#include <dtCore/floatactorproperty.h>
+#include <dtCore/gameevent.h>
+#include <dtCore/gameeventmanager.h>
+#include <dtCore/groupactorproperty.h>
+#include <dtCore/intactorproperty.h>
+#include <dtCore/longactorproperty.h>
+#include <dtCore/mapcontenthandler.h>
+#include <dtCore/stringactorproperty.h>
+#include <dtCore/vectoractorproperties.h>
+
+#include <dtUtil/datastream.h>
+#include <dtUtil/fileutils.h>
+#include <dtUtil/stringutils.h>
+#include <dtUtil/threadpool.h>
+
+#include <osg/Timer>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <sstream>
+
+namespace dtCore
+{
+   const std::string MapBinaryWriter::MAP_FILE_EXTENSION("dtmapb");
+
+   namespace
+   {
+      const char MAP_BINARY_MAGIC[4] = { 'D', 'T', 'M', 'B' };
+      const unsigned MAP_BINARY_VERSION = 2U;
+
+      /// Compression codec for everything after the header.  Only uncompressed payloads are written today,
+      /// the field is there so a codec can be added without changing the layout.
+      const unsigned MAP_BINARY_COMPRESSION_NONE = 0U;
+
+      /// Marks an absent string or type index.
+      const unsigned NO_INDEX = 0xFFFFFFFFU;
+
+      /// Below this many actors per task, decoding in parallel costs more than it saves.
+      const size_t MIN_ACTORS_PER_DECODE_TASK = 32;
+
+      enum PropertyEncoding
+      {
+         ENCODING_TEXT = 0,
+         ENCODING_FLOAT,
+         ENCODING_DOUBLE,
+         ENCODING_INT,
+         ENCODING_LONG,
+         ENCODING_BOOL,
+         ENCODING_STRING,
+         ENCODING_VEC2F,
+         ENCODING_VEC3F,
+         ENCODING_VEC4F,
+         ENCODING_VEC2D,
+         ENCODING_VEC3D,
+         ENCODING_VEC4D,
+         ENCODING_ACTOR,
+         ENCODING_GROUP,
+         ENCODING_COUNT
+      };
+
+      ////////////////////////////////////////////////////////////////////////////////
+      /// Reads the file through a 64 bit FNV-1a hash.
+      bool ComputeSourceStamp(const std::string& filePath, unsigned long long& outSize, unsigned long long& outHash)
+      {
+         std::ifstream stream(filePath.c_str(), std::ios::in | std::ios::binary);
+         if (!stream.is_open())
+         {
+            return false;
+         }
+
+         unsigned long long size = 0ULL;
+         unsigned long long hash = 14695981039346656037ULL;
+         char chunk[16384];
+         while (stream)
+         {
+            stream.read(chunk, sizeof(chunk));
+            std::streamsize count = stream.gcount();
+            for (std::streamsize i = 0; i < count; ++i)
+            {
+               hash ^= (unsigned char)chunk[i];
+               hash *= 1099511628211ULL;
+            }
+            size += (unsigned long long)count;
+         }
+
+         if (stream.bad())
+         {
+            return false;
+         }
+         outSize = size;
+         outHash = hash;
+         return true;
+      }
+
+      ////////////////////////////////////////////////////////////////////////////////
+      void WriteRawString(dtUtil::DataStream& ds, const std::string& value)
+      {
+         // DataStream strings are limited to a short length, and property strings can be much longer.
+         ds << unsigned(value.size());
+         if (!value.empty())
+         {
+            ds.WriteBinary(value.data(), unsigned(value.size()));
+         }
+      }
+
+      ////////////////////////////////////////////////////////////////////////////////
+      void ReadRawString(dtUtil::DataStream& ds, std::string& value)
+      {
+         unsigned size = 0U;
+         ds >> size;
+         if (size > ds.GetRemainingReadSize())
+         {
+            throw dtCore::MapParsingException("A string in the binary map runs past the end of the data.", __FILE__, __LINE__);
+         }
+         value.assign(ds.GetBuffer() + ds.GetReadPosition(), size);
+         ds.Seekg(size, dtUtil::DataStream::SeekTypeEnum::CURRENT);
+      }
+
+      /**
+       * Assigns each distinct string an index in the order it is first seen.
+       */
+      class StringTable
+      {
+      public:
+         unsigned Intern(const std::string& value)
+         {
+            std::map<std::string, unsigned>::const_iterator found = mIndices.find(value);
+            if (found != mIndices.end())
+            {
+               return found->second;
+            }
+
+            unsigned index = unsigned(mStrings.size());
+            mIndices.insert(std::make_pair(value, index));
+            mStrings.push_back(value);
+            return index;
+         }
+
+         const std::vector<std::string>& GetStrings() const { return mStrings; }
+
+      private:
+         std::map<std::string, unsigned> mIndices;
+         std::vector<std::string> mStrings;
+      };
+
+      /**
+       * Holds the tables built while writing the map body.
+       */
+      struct WriteContext
+      {
+         StringTable mStrings;
+         std::map<std::string, unsigned> mTypeIndices;
+         std::vector<std::pair<unsigned, unsigned> > mTypes;
+
+         unsigned InternType(const ActorType& type)
+         {
+            const std::string fullName = type.GetFullName();
+            std::map<std::string, unsigned>::const_iterator found = mTypeIndices.find(fullName);
+            if (found != mTypeIndices.end())
+            {
+               return found->second;
+            }
+
+            unsigned index = unsigned(mTypes.size());
+            mTypeIndices.insert(std::make_pair(fullName, index));
+            mTypes.push_back(std::make_pair(mStrings.Intern(type.GetCategory()), mStrings.Intern(type.GetName())));
+            return index;
+         }
+      };
+
+      ////////////////////////////////////////////////////////////////////////////////
+      void WriteProperty(const ActorProperty& prop, WriteContext& ctx, dtUtil::DataStream& ds)
+      {
+         ds << ctx.mStrings.Intern(prop.GetName());
+
+         if (const FloatActorProperty* p = dynamic_cast<const FloatActorProperty*>(&prop))
+         {
+            ds << (unsigned char)ENCODING_FLOAT << p->GetValue();
+         }
+         else if (const DoubleActorProperty* p = dynamic_cast<const DoubleActorProperty*>(&prop))
+         {
+            ds << (unsigned char)ENCODING_DOUBLE << p->GetValue();
+         }
+         else if (const IntActorProperty* p = dynamic_cast<const IntActorProperty*>(&prop))
+         {
+            ds << (unsigned char)ENCODING_INT << p->GetValue();
+         }
+         else if (const LongActorProperty* p = dynamic_cast<const LongActorProperty*>(&prop))
+         {
+            // long is a different size on different platforms, so it is always written as 64 bits.
+            ds << (unsigned char)ENCODING_LONG << (long long)p->GetValue();
+         }
+         else if (const BooleanActorProperty* p = dynamic_cast<const BooleanActorProperty*>(&prop))
+         {
+            ds << (unsigned char)ENCODING_BOOL << p->GetValue();
+         }
+         else if (const StringActorProperty* p = dynamic_cast<const StringActorProperty*>(&prop))
+         {
+            ds << (unsigned char)ENCODING_STRING << ctx.mStrings.Intern(p->GetValue());
+         }
+         else if (const Vec2fActorProperty* p = dynamic_cast<const Vec2fActorProperty*>(&prop))
+         {
+            ds << (unsigned char)ENCODING_VEC2F << p->GetValue();
+         }
+         else if (const Vec3fActorProperty* p = dynamic_cast<const Vec3fActorProperty*>(&prop))
+         {
+            ds << (unsigned char)ENCODING_VEC3F << p->GetValue();
+         }
+         else if (const Vec4fActorProperty* p = dynamic_cast<const Vec4fActorProperty*>(&prop))
+         {
+            // Also covers ColorRgbaActorProperty.
+            ds << (unsigned char)ENCODING_VEC4F << p->GetValue();
+         }
+         else if (const Vec2dActorProperty* p = dynamic_cast<const Vec2dActorProperty*>(&prop))
+         {
+            ds << (unsigned char)ENCODING_VEC2D << p->GetValue();
+         }
+         else if (const Vec3dActorProperty* p = dynamic_cast<const Vec3dActorProperty*>(&prop))
+         {
+            ds << (unsigned char)ENCODING_VEC3D << p->GetValue();
+         }
+         else if (const Vec4dActorProperty* p = dynamic_cast<const Vec4dActorProperty*>(&prop))
+         {
+            ds << (unsigned char)ENCODING_VEC4D << p->GetValue();
+         }
+         else if (dynamic_cast<const ActorActorProperty*>(&prop) != NULL)
+         {
+            // Linked after all the actors exist, the same as the xml loader.
+            ds << (unsigned char)ENCODING_ACTOR << ctx.mStrings.Intern(prop.ToString());
+         }
+         else if (dynamic_cast<const GroupActorProperty*>(&prop) != NULL)
+         {
+            ds << (unsigned char)ENCODING_GROUP << ctx.mStrings.Intern(prop.ToString());
+         }
+         else
+         {
+            // Everything else, resources, enumerations, arrays, containers and so on, round trips as a string.
+            ds << (unsigned char)ENCODING_TEXT << ctx.mStrings.Intern(prop.ToString());
+         }
+      }
+
+      ////////////////////////////////////////////////////////////////////////////////
+      void WriteActorRecord(BaseActorObject& actor, WriteContext& ctx, dtUtil::DataStream& ds)
+      {
+         ds << ctx.InternType(actor.GetActorType());
+         ds << ctx.mStrings.Intern(actor.GetId().ToString());
+         ds << ctx.mStrings.Intern(actor.GetName());
+
+         ActorComponentContainer* compContainer = dynamic_cast<ActorComponentContainer*>(&actor);
+
+         unsigned parentIndex = NO_INDEX;
+         if (compContainer != NULL && compContainer->GetParentBaseActor() != NULL)
+         {
+            parentIndex = ctx.mStrings.Intern(compContainer->GetParentBaseActor()->GetId().ToString());
+         }
+         ds << parentIndex;
+
+         // PROPERTIES, written as a sized blob so the reader can decode them independently.
+         PropertyContainer::PropertyConstVector propList;
+         actor.GetPropertyList(propList);
+
+         PropertyContainer::PropertyConstVector toSave;
+         toSave.reserve(propList.size());
+         for (PropertyContainer::PropertyConstVector::const_iterator i = propList.begin(); i != propList.end(); ++i)
+         {
+            if (actor.ShouldPropertySave(**i))
+            {
+               toSave.push_back(*i);
+            }
+         }
+
+         dtUtil::DataStream blob;
+         blob.SetForceLittleEndian(true);
+         blob << unsigned(toSave.size());
+         for (PropertyContainer::PropertyConstVector::const_iterator i = toSave.begin(); i != toSave.end(); ++i)
+         {
+            WriteProperty(**i, ctx, blob);
+         }
+
+         ds << blob.GetBufferSize();
+         ds.WriteBinary(blob.GetBuffer(), blob.GetBufferSize());
+
+         // ACTOR COMPONENTS
+         ActorPtrVector comps;
+         if (compContainer != NULL)
+         {
+            ActorPtrVector allComps;
+            compContainer->GetAllComponents(allComps);
+            for (ActorPtrVector::const_iterator i = allComps.begin(); i != allComps.end(); ++i)
+            {
+               if (!(*i)->IsGhost())
+               {
+                  comps.push_back(*i);
+               }
+            }
+         }
+
+         ds << unsigned(comps.size());
+         for (ActorPtrVector::const_iterator i = comps.begin(); i != comps.end(); ++i)
+         {
+            WriteActorRecord(**i, ctx, ds);
+         }
+      }
+
+      /**
+       * A decoded property value.  Vectors and floats are held as doubles, which is exact for floats.
+       */
+      struct PropertyValue
+      {
+         unsigned mNameIndex;
+         unsigned char mEncoding;
+         unsigned mStringIndex;
+         long long mInteger;
+         double mNumber[4];
+
+         PropertyValue()
+         : mNameIndex(NO_INDEX)
+         , mEncoding(ENCODING_TEXT)
+         , mStringIndex(NO_INDEX)
+         , mInteger(0)
+         {
+            mNumber[0] = mNumber[1] = mNumber[2] = mNumber[3] = 0.0;
+         }
+      };
+
+      /**
+       * One actor as read from the file.  The properties are filled in by the decode pass.
+       */
+      struct ActorRecord
+      {
+         unsigned mTypeIndex;
+         unsigned mIdIndex;
+         unsigned mNameIndex;
+         unsigned mParentIdIndex;
+         unsigned mBlobOffset;
+         unsigned mBlobSize;
+         bool mDecodeFailed;
+         std::string mDecodeError;
+         std::vector<PropertyValue> mProperties;
+         std::vector<ActorRecord> mComponents;
+
+         ActorRecord()
+         : mTypeIndex(NO_INDEX)
+         , mIdIndex(NO_INDEX)
+         , mNameIndex(NO_INDEX)
+         , mParentIdIndex(NO_INDEX)
+         , mBlobOffset(0U)
+         , mBlobSize(0U)
+         , mDecodeFailed(false)
+         {
+         }
+      };
+
+      typedef std::vector<ActorRecord*> ActorRecordPtrVector;
+
+      ////////////////////////////////////////////////////////////////////////////////
+      template <typename VecType>
+      void ReadVector(dtUtil::DataStream& ds, PropertyValue& value)
+      {
+         VecType vec;
+         ds >> vec;
+         for (unsigned i = 0; i < unsigned(VecType::num_components); ++i)
+         {
+            value.mNumber[i] = vec[i];
+         }
+      }
+
+      ////////////////////////////////////////////////////////////////////////////////
+      void DecodeProperties(const char* buffer, ActorRecord& record)
+      {
+         try
+         {
+            dtUtil::DataStream ds = dtUtil::DataStream::CreateView(buffer + record.mBlobOffset, record.mBlobSize);
+            ds.SetForceLittleEndian(true);
+
+            unsigned count = 0U;
+            ds >> count;
+            record.mProperties.resize(count);
+
+            for (unsigned i = 0; i < count; ++i)
+            {
+               PropertyValue& value = record.mProperties[i];
+               ds >> value.mNameIndex >> value.mEncoding;
+
+               switch (value.mEncoding)
+               {
+               case ENCODING_FLOAT:
+                  {
+                     float f = 0.0f;
+                     ds >> f;
+                     value.mNumber[0] = f;
+                     break;
+                  }
+               case ENCODING_DOUBLE:
+                  ds >> value.mNumber[0];
+                  break;
+               case ENCODING_INT:
+                  {
+                     int n = 0;
+                     ds >> n;
+                     value.mInteger = n;
+                     break;
+                  }
+               case ENCODING_LONG:
+                  ds >> value.mInteger;
+                  break;
+               case ENCODING_BOOL:
+                  {
+                     bool b = false;
+                     ds >> b;
+                     value.mInteger = b ? 1 : 0;
+                     break;
+                  }
+               case ENCODING_VEC2F:
+                  ReadVector<osg::Vec2f>(ds, value);
+                  break;
+               case ENCODING_VEC3F:
+                  ReadVector<osg::Vec3f>(ds, value);
+                  break;
+               case ENCODING_VEC4F:
+                  ReadVector<osg::Vec4f>(ds, value);
+                  break;
+               case ENCODING_VEC2D:
+                  ReadVector<osg::Vec2d>(ds, value);
+                  break;
+               case ENCODING_VEC3D:
+                  ReadVector<osg::Vec3d>(ds, value);
+                  break;
+               case ENCODING_VEC4D:
+                  ReadVector<osg::Vec4d>(ds, value);
+                  break;
+               case ENCODING_TEXT:
+               case ENCODING_STRING:
+               case ENCODING_ACTOR:
+               case ENCODING_GROUP:
+                  ds >> value.mStringIndex;
+                  break;
+               default:
+                  throw dtCore::MapParsingException("Unknown property encoding in the binary map.", __FILE__, __LINE__);
+               }
+            }
+         }
+         catch (const dtUtil::Exception& ex)
+         {
+            record.mDecodeFailed = true;
+            record.mDecodeError = ex.What();
+         }
+      }
+
+      /**
+       * Decodes the property blobs for a slice of the actor records.
+       */
+      class DecodePropertiesTask : public dtUtil::ThreadPoolTask
+      {
+      public:
+         DecodePropertiesTask(const char* buffer, const ActorRecordPtrVector& records, size_t begin, size_t end)
+         : mBuffer(buffer)
+         , mRecords(records)
+         , mBegin(begin)
+         , mEnd(end)
+         {
+         }
+
+         virtual void operator()()
+         {
+            for (size_t i = mBegin; i < mEnd; ++i)
+            {
+               DecodeProperties(mBuffer, *mRecords[i]);
+            }
+         }
+
+      private:
+         const char* mBuffer;
+         const ActorRecordPtrVector& mRecords;
+         size_t mBegin, mEnd;
+      };
+
+      ////////////////////////////////////////////////////////////////////////////////
+      void CollectRecords(std::vector<ActorRecord>& records, ActorRecordPtrVector& toFill)
+      {
+         for (std::vector<ActorRecord>::iterator i = records.begin(); i != records.end(); ++i)
+         {
+            toFill.push_back(&*i);
+            CollectRecords(i->mComponents, toFill);
+         }
+      }
+
+      /**
+       * A property that has to be assigned after all the actors are created.
+       */
+      struct DeferredProperty
+      {
+         RefPtr<BaseActorObject> mActor;
+         std::string mPropertyName;
+         std::string mValue;
+      };
+
+      /**
+       * State shared by the serial part of the load.
+       */
+      struct LoadContext
+      {
+         dtUtil::Log* mLogger;
+         Map* mMap;
+         std::vector<std::string> mStrings;
+         std::vector<ActorTypePtr> mTypes;
+         std::vector<std::pair<std::string, std::string> > mTypeNames;
+         std::set<std::string>* mMissingActorTypes;
+         std::vector<DeferredProperty> mActorLinks;
+         std::vector<DeferredProperty> mGroupProperties;
+         bool mHasDeprecatedProperty;
+
+         const std::string& GetString(unsigned index) const
+         {
+            if (index >= mStrings.size())
+            {
+               throw dtCore::MapParsingException("String index out of range in the binary map.", __FILE__, __LINE__);
+            }
+            return mStrings[index];
+         }
+      };
+
+      ////////////////////////////////////////////////////////////////////////////////
+      std::string ValueToString(const PropertyValue& value, const LoadContext& ctx)
+      {
+         std::ostringstream ss;
+         ss << std::setprecision(17);
+         switch (value.mEncoding)
+         {
+         case ENCODING_FLOAT:
+         case ENCODING_DOUBLE:
+            ss << value.mNumber[0];
+            break;
+         case ENCODING_INT:
+         case ENCODING_LONG:
+            ss << value.mInteger;
+            break;
+         case ENCODING_BOOL:
+            ss << (value.mInteger != 0 ? "true" : "false");
+            break;
+         case ENCODING_VEC2F:
+         case ENCODING_VEC2D:
+            ss << value.mNumber[0] << " " << value.mNumber[1];
+            break;
+         case ENCODING_VEC3F:
+         case ENCODING_VEC3D:
+            ss << value.mNumber[0] << " " << value.mNumber[1] << " " << value.mNumber[2];
+            break;
+         case ENCODING_VEC4F:
+         case ENCODING_VEC4D:
+            ss << value.mNumber[0] << " " << value.mNumber[1] << " " << value.mNumber[2] << " " << value.mNumber[3];
+            break;
+         default:
+            return ctx.GetString(value.mStringIndex);
+         }
+         return ss.str();
+      }
+
+      ////////////////////////////////////////////////////////////////////////////////
+      template <typename PropertyType, typename ValueType>
+      bool SetTypedValue(ActorProperty& prop, const ValueType& value)
+      {
+         PropertyType* typed = dynamic_cast<PropertyType*>(&prop);
+         if (typed == NULL)
+         {
+            return false;
+         }
+         typed->SetValue(value);
+         return true;
+      }
+
+      ////////////////////////////////////////////////////////////////////////////////
+      bool SetPropertyValue(ActorProperty& prop, const PropertyValue& value, const LoadContext& ctx)
+      {
+         const double* n = value.mNumber;
+         switch (value.mEncoding)
+         {
+         case ENCODING_FLOAT:
+            return SetTypedValue<FloatActorProperty>(prop, float(n[0]));
+         case ENCODING_DOUBLE:
+            return SetTypedValue<DoubleActorProperty>(prop, n[0]);
+         case ENCODING_INT:
+            return SetTypedValue<IntActorProperty>(prop, int(value.mInteger));
+         case ENCODING_LONG:
+            return SetTypedValue<LongActorProperty>(prop, long(value.mInteger));
+         case ENCODING_BOOL:
+            return SetTypedValue<BooleanActorProperty>(prop, value.mInteger != 0);
+         case ENCODING_STRING:
+            return SetTypedValue<StringActorProperty>(prop, ctx.GetString(value.mStringIndex));
+         case ENCODING_VEC2F:
+            return SetTypedValue<Vec2fActorProperty>(prop, osg::Vec2f(n[0], n[1]));
+         case ENCODING_VEC3F:
+            return SetTypedValue<Vec3fActorProperty>(prop, osg::Vec3f(n[0], n[1], n[2]));
+         case ENCODING_VEC4F:
+            return SetTypedValue<Vec4fActorProperty>(prop, osg::Vec4f(n[0], n[1], n[2], n[3]));
+         case ENCODING_VEC2D:
+            return SetTypedValue<Vec2dActorProperty>(prop, osg::Vec2d(n[0], n[1]));
+         case ENCODING_VEC3D:
+            return SetTypedValue<Vec3dActorProperty>(prop, osg::Vec3d(n[0], n[1], n[2]));
+         case ENCODING_VEC4D:
+            return SetTypedValue<Vec4dActorProperty>(prop, osg::Vec4d(n[0], n[1], n[2], n[3]));
+         default:
+            return false;
+         }
+      }
+
+      ////////////////////////////////////////////////////////////////////////////////
+      void ApplyProperties(LoadContext& ctx, const ActorRecord& record, BaseActorObject& actor)
+      {
+         for (std::vector<PropertyValue>::const_iterator i = record.mProperties.begin(); i != record.mProperties.end(); ++i)
+         {
+            const PropertyValue& value = *i;
+            const std::string& propName = ctx.GetString(value.mNameIndex);
+
+            RefPtr<ActorProperty> prop = actor.GetProperty(propName);
+            if (!prop.valid())
+            {
+               prop = actor.GetDeprecatedProperty(propName);
+               if (prop.valid())
+               {
+                  ctx.mHasDeprecatedProperty = true;
+               }
+            }
+
+            if (!prop.valid())
+            {
+               ctx.mLogger->LogMessage(dtUtil::Log::LOG_WARNING, __FUNCTION__, __LINE__,
+                  "Property \"%s\" was not found on actor \"%s\".", propName.c_str(), actor.GetName().c_str());
+               continue;
+            }
+
+            if (prop->IsReadOnly())
+            {
+               continue;
+            }
+
+            if (value.mEncoding == ENCODING_ACTOR || value.mEncoding == ENCODING_GROUP)
+            {
+               DeferredProperty deferred;
+               deferred.mActor = &actor;
+               deferred.mPropertyName = propName;
+               deferred.mValue = ctx.GetString(value.mStringIndex);
+               if (value.mEncoding == ENCODING_ACTOR)
+               {
+                  ctx.mActorLinks.push_back(deferred);
+               }
+               else
+               {
+                  ctx.mGroupProperties.push_back(deferred);
+               }
+               continue;
+            }
+
+            // If the property class changed since the file was written, fall back to the string form.
+            if (!SetPropertyValue(*prop, value, ctx) && !prop->FromString(ValueToString(value, ctx)))
+            {
+               ctx.mLogger->LogMessage(dtUtil::Log::LOG_WARNING, __FUNCTION__, __LINE__,
+                  "Unable to set property \"%s\" on actor \"%s\".", propName.c_str(), actor.GetName().c_str());
+            }
+         }
+      }
+
+      ////////////////////////////////////////////////////////////////////////////////
+      ActorProperty* FindDeferredProperty(const DeferredProperty& deferred)
+      {
+         ActorProperty* prop = deferred.mActor->GetProperty(deferred.mPropertyName);
+         if (prop == NULL)
+         {
+            RefPtr<ActorProperty> deprecated = deferred.mActor->GetDeprecatedProperty(deferred.mPropertyName);
+            // Deprecated properties are owned by the actor, so the raw pointer stays valid.
+            prop = deprecated.get();
+         }
+         return prop;
+      }
+
+      ////////////////////////////////////////////////////////////////////////////////
+      RefPtr<BaseActorObject> CreateActor(LoadContext& ctx, const ActorRecord& record, ActorComponentContainer* owner)
+      {
+         if (record.mTypeIndex >= ctx.mTypes.size())
+         {
+            throw dtCore::MapParsingException("Actor type index out of range in the binary map.", __FILE__, __LINE__);
+         }
+
+         const std::pair<std::string, std::string>& typeName = ctx.mTypeNames[record.mTypeIndex];
+         const std::string actorTypeFullName = typeName.first + "." + typeName.second;
+
+         // Make sure we have not tried to load this actor type already and failed.
+         if (ctx.mMissingActorTypes->find(actorTypeFullName) != ctx.mMissingActorTypes->end())
+         {
+            return NULL;
+         }
+
+         ActorTypePtr actorType = ctx.mTypes[record.mTypeIndex];
+         RefPtr<BaseActorObject> actor;
+
+         if (owner != NULL)
+         {
+            ActorPtrVector existingComponents;
+            if (actorType == NULL)
+            {
+               ActorTypePtr tempType = new ActorType(typeName.second, typeName.first, std::string());
+               owner->GetComponents(tempType, existingComponents);
+               if (!existingComponents.empty())
+               {
+                  ctx.mLogger->LogMessage(dtUtil::Log::LOG_WARNING, __FUNCTION__, __LINE__,
+                     "ActorComponent actorType \"%s\" was not found in the registry, but it was found as an existing component.",
+                     actorTypeFullName.c_str());
+               }
+            }
+            else
+            {
+               owner->GetComponents(actorType, existingComponents);
+            }
+
+            if (!existingComponents.empty())
+            {
+               actor = existingComponents[0];
+               // Actor components created in code won't have their defaults initialized unless the developer
+               // created it through the factory.
+               actor->InitDefaults();
+            }
+         }
+
+         bool newActorComponent = !actor.valid();
+         if (!actor.valid() && actorType != NULL)
+         {
+            actor = ActorFactory::GetInstance().CreateActor(*actorType);
+         }
+
+         if (!actor.valid())
+         {
+            ctx.mLogger->LogMessage(dtUtil::Log::LOG_WARNING, __FUNCTION__, __LINE__,
+               "ActorType \"%s\" not found.", actorTypeFullName.c_str());
+            ctx.mMissingActorTypes->insert(actorTypeFullName);
+            return NULL;
+         }
+
+         // Notify the actor that it is being loaded.
+         actor->OnMapLoadBegin();
+
+         if (owner != NULL && newActorComponent)
+         {
+            owner->AddComponent(*actor);
+         }
+
+         actor->SetId(dtCore::UniqueId(ctx.GetString(record.mIdIndex)));
+         actor->SetName(ctx.GetString(record.mNameIndex));
+
+         // Components come before direct properties so that all components exist before deprecated
+         // properties are handled.
+         ActorComponentContainer* compContainer = dynamic_cast<ActorComponentContainer*>(actor.get());
+         if (compContainer != NULL)
+         {
+            for (std::vector<ActorRecord>::const_iterator i = record.mComponents.begin(); i != record.mComponents.end(); ++i)
+            {
+               CreateActor(ctx, *i, compContainer);
+            }
+         }
+
+         ApplyProperties(ctx, record, *actor);
+
+         if (!actor->IsActorComponent())
+         {
+            // Parents are always written before their children.
+            if (record.mParentIdIndex != NO_INDEX && compContainer != NULL)
+            {
+               BaseActorObject* parent = ctx.mMap->GetProxyById(dtCore::UniqueId(ctx.GetString(record.mParentIdIndex)));
+               if (parent != NULL)
+               {
+                  compContainer->SetParentBaseActor(parent);
+               }
+            }
+
+            ctx.mMap->AddProxy(*actor);
+         }
+
+         actor->OnMapLoadEnd(); //notify BaseActorObject we're done loading it
+         return actor;
+      }
+
+      ////////////////////////////////////////////////////////////////////////////////
+      void ReadActorRecord(dtUtil::DataStream& ds, ActorRecord& record)
+      {
+         ds >> record.mTypeIndex >> record.mIdIndex >> record.mNameIndex >> record.mParentIdIndex;
+         ds >> record.mBlobSize;
+         record.mBlobOffset = ds.GetReadPosition();
+         if (record.mBlobSize == 0U || record.mBlobSize > ds.GetRemainingReadSize())
+         {
+            throw dtCore::MapParsingException("An actor record in the binary map is truncated.", __FILE__, __LINE__);
+         }
+         ds.Seekg(record.mBlobSize, dtUtil::DataStream::SeekTypeEnum::CURRENT);
+
+         unsigned componentCount = 0U;
+         ds >> componentCount;
+         record.mComponents.resize(componentCount);
+         for (unsigned i = 0; i < componentCount; ++i)
+         {
+            ReadActorRecord(ds, record.mComponents[i]);
+         }
+      }
+
+      ////////////////////////////////////////////////////////////////////////////////
+      void WritePresetCamera(dtUtil::DataStream& ds, int index, const Map::PresetCameraData& data)
+      {
+         ds << index;
+         ds << data.persPosition;
+         ds << double(data.persRotation.x()) << double(data.persRotation.y())
+            << double(data.persRotation.z()) << double(data.persRotation.w());
+         ds << data.topPosition << data.topZoom;
+         ds << data.sidePosition << data.sideZoom;
+         ds << data.frontPosition << data.frontZoom;
+      }
+
+      ////////////////////////////////////////////////////////////////////////////////
+      int ReadPresetCamera(dtUtil::DataStream& ds, Map::PresetCameraData& data)
+      {
+         int index = 0;
+         double x, y, z, w;
+         ds >> index;
+         ds >> data.persPosition;
+         ds >> x >> y >> z >> w;
+         data.persRotation.set(x, y, z, w);
+         ds >> data.topPosition >> data.topZoom;
+         ds >> data.sidePosition >> data.sideZoom;
+         ds >> data.frontPosition >> data.frontZoom;
+         data.isValid = true;
+         return index;
+      }
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   MapBinaryWriter::MapBinaryWriter()
+   : mLogger(&dtUtil::Log::GetInstance("mapbinary.cpp"))
+   , mSourceSize(0ULL)
+   , mSourceHash(0ULL)
+   {
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   MapBinaryWriter::~MapBinaryWriter()
+   {
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   bool MapBinaryWriter::SetSourceFile(const std::string& xmlPath)
+   {
+      if (!ComputeSourceStamp(xmlPath, mSourceSize, mSourceHash))
+      {
+         mSourceSize = 0ULL;
+         mSourceHash = 0ULL;
+         return false;
+      }
+      return true;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void MapBinaryWriter::Save(Map& map, const std::string& filePath)
+   {
+      std::ofstream stream(filePath.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+      if (!stream.is_open())
+      {
+         throw dtCore::MapSaveException("Unable to open \"" + filePath + "\" for writing.", __FILE__, __LINE__);
+      }
+      Save(map, stream);
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void MapBinaryWriter::Save(Map& map, std::ostream& stream)
+   {
+      WriteContext ctx;
+
+      // The body is written first so the string table is complete when the header is written.
+      dtUtil::DataStream body;
+      body.SetForceLittleEndian(true);
+
+      // HEADER
+      body << ctx.mStrings.Intern(map.GetName());
+      body << ctx.mStrings.Intern(map.GetDescription());
+      body << ctx.mStrings.Intern(map.GetAuthor());
+      body << ctx.mStrings.Intern(map.GetComment());
+      body << ctx.mStrings.Intern(map.GetCopyright());
+      body << ctx.mStrings.Intern(map.GetCreateDateTime());
+      body << ctx.mStrings.Intern(map.GetIconFile());
+
+      // LIBRARIES
+      const std::vector<std::string>& libs = map.GetAllLibraries();
+      body << unsigned(libs.size());
+      for (std::vector<std::string>::const_iterator i = libs.begin(); i != libs.end(); ++i)
+      {
+         body << ctx.mStrings.Intern(*i) << ctx.mStrings.Intern(map.GetLibraryVersion(*i));
+      }
+
+      // EVENTS
+      std::vector<GameEvent*> events;
+      map.GetEventManager().GetAllEvents(events);
+      body << unsigned(events.size());
+      for (std::vector<GameEvent*>::const_iterator i = events.begin(); i != events.end(); ++i)
+      {
+         body << ctx.mStrings.Intern((*i)->GetUniqueId().ToString());
+         body << ctx.mStrings.Intern((*i)->GetName());
+         body << ctx.mStrings.Intern((*i)->GetDescription());
+      }
+
+      // ENVIRONMENT ACTOR
+      if (map.GetEnvironmentActor() != NULL)
+      {
+         body << ctx.mStrings.Intern(map.GetEnvironmentActor()->GetId().ToString());
+      }
+      else
+      {
+         body << NO_INDEX;
+      }
+
+      // ACTORS, in the same order as the xml writer: each top level container followed by its children.
+      ActorPtrVector toWrite;
+      typedef std::map<dtCore::UniqueId, dtCore::RefPtr<BaseActorObject> > ActorMap;
+      const ActorMap& actorMap = map.GetAllProxies();
+      for (ActorMap::const_iterator curIter = actorMap.begin(); curIter != actorMap.end(); ++curIter)
+      {
+         BaseActorObject* actor = curIter->second.get();
+         if (actor->IsActorComponent())
+         {
+            mLogger->LogMessage(dtUtil::Log::LOG_ERROR, __FUNCTION__, __LINE__,
+               "Cannot write an ActorComponent \"%s\" directly to the map root.", actor->GetName().c_str());
+            continue;
+         }
+
+         ActorComponentContainer* compContainer = dynamic_cast<ActorComponentContainer*>(actor);
+
+         // Skip actors that have parents since they are written right after their parents.
+         if (actor->IsGhost() || (compContainer != NULL && compContainer->GetParentBaseActor() != NULL))
+         {
+            continue;
+         }
+
+         if (compContainer == NULL)
+         {
+            toWrite.push_back(actor);
+         }
+         else
+         {
+            dtCore::RefPtr<ActorComponentContainer::ActorIterator> iter = compContainer->GetIterator();
+            if (!iter.valid())
+            {
+               toWrite.push_back(actor);
+               continue;
+            }
+
+            while (!iter->IsAtEnd())
+            {
+               BaseActorObject* curActor = *(*iter);
+               if (!curActor->IsGhost())
+               {
+                  toWrite.push_back(curActor);
+               }
+               ++(*iter);
+            }
+         }
+      }
+
+      dtUtil::DataStream actors;
+      actors.SetForceLittleEndian(true);
+      actors << unsigned(toWrite.size());
+      for (ActorPtrVector::const_iterator i = toWrite.begin(); i != toWrite.end(); ++i)
+      {
+         WriteActorRecord(**i, ctx, actors);
+      }
+
+      // GROUPS
+      dtUtil::DataStream tail;
+      tail.SetForceLittleEndian(true);
+      int groupCount = map.GetGroupCount();
+      tail << groupCount;
+      for (int groupIndex = 0; groupIndex < groupCount; ++groupIndex)
+      {
+         std::vector<unsigned> ids;
+         int actorCount = map.GetGroupActorCount(groupIndex);
+         for (int actorIndex = 0; actorIndex < actorCount; ++actorIndex)
+         {
+            BaseActorObject* actor = map.GetActorFromGroup(groupIndex, actorIndex);
+            if (actor != NULL)
+            {
+               ids.push_back(ctx.mStrings.Intern(actor->GetId().ToString()));
+            }
+         }
+
+         tail << unsigned(ids.size());
+         for (std::vector<unsigned>::const_iterator i = ids.begin(); i != ids.end(); ++i)
+         {
+            tail << *i;
+         }
+      }
+
+      // PRESET CAMERAS
+      std::vector<int> presetIndices;
+      for (int presetIndex = 0; presetIndex < 10; ++presetIndex)
+      {
+         if (map.GetPresetCameraData(presetIndex).isValid)
+         {
+            presetIndices.push_back(presetIndex);
+         }
+      }
+      tail << unsigned(presetIndices.size());
+      for (std::vector<int>::const_iterator i = presetIndices.begin(); i != presetIndices.end(); ++i)
+      {
+         WritePresetCamera(tail, *i, map.GetPresetCameraData(*i));
+      }
+
+      // TYPE TABLE, needs every actor written first.
+      dtUtil::DataStream types;
+      types.SetForceLittleEndian(true);
+      types << unsigned(ctx.mTypes.size());
+      for (std::vector<std::pair<unsigned, unsigned> >::const_iterator i = ctx.mTypes.begin(); i != ctx.mTypes.end(); ++i)
+      {
+         types << i->first << i->second;
+      }
+
+      dtUtil::DataStream out;
+      out.SetForceLittleEndian(true);
+      out.WriteBinary(MAP_BINARY_MAGIC, sizeof(MAP_BINARY_MAGIC));
+      out << MAP_BINARY_VERSION;
+      out << MAP_BINARY_COMPRESSION_NONE;
+      out << mSourceSize << mSourceHash;
+
+      const std::vector<std::string>& strings = ctx.mStrings.GetStrings();
+      out << unsigned(strings.size());
+      for (std::vector<std::string>::const_iterator i = strings.begin(); i != strings.end(); ++i)
+      {
+         WriteRawString(out, *i);
+      }
+
+      out.AppendDataStream(body);
+      out.AppendDataStream(types);
+      out.AppendDataStream(actors);
+      out.AppendDataStream(tail);
+
+      stream.write(out.GetBuffer(), out.GetBufferSize());
+      if (stream.fail())
+      {
+         throw dtCore::MapSaveException("Failed writing the binary map \"" + map.GetName() + "\".", __FILE__, __LINE__);
+      }
+   }
+
+   /**
+    * What MapBinaryReader::Decode reads from the file, and how far the build has got.  Only string table
+    * indices and plain data are kept, so nothing here depends on the actor factory until BeginBuild.
+    */
+   struct MapBinaryLoadState
+   {
+      LoadContext mContext;
+      MapPtr mMap;
+
+      unsigned mHeader[7];
+      std::vector<std::pair<unsigned, unsigned> > mLibraries;
+      /// id, name and description index for each event.
+      std::vector<unsigned> mEvents;
+      unsigned mEnvActorIndex;
+
+      std::vector<ActorRecord> mRecords;
+      std::vector<int> mGroupSizes;
+      std::vector<unsigned> mGroupActorIds;
+      std::vector<std::pair<int, Map::PresetCameraData> > mPresets;
+
+      size_t mNextRecord;
+
+      MapBinaryLoadState()
+      : mEnvActorIndex(NO_INDEX)
+      , mNextRecord(0U)
+      {
+         mContext.mLogger = NULL;
+         mContext.mMap = NULL;
+         mContext.mMissingActorTypes = NULL;
+         mContext.mHasDeprecatedProperty = false;
+         std::fill(mHeader, mHeader + 7, NO_INDEX);
+      }
+   };
+
+   /////////////////////////////////////////////////////////////////////////////
+   MapBinaryReader::MapBinaryReader()
+   : mLogger(&dtUtil::Log::GetInstance("mapbinary.cpp"))
+   , mHasDeprecatedProperty(false)
+   , mLoadState(NULL)
+   {
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   MapBinaryReader::~MapBinaryReader()
+   {
+      delete mLoadState;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   bool MapBinaryReader::IsBinaryMapFile(const std::string& filePath)
+   {
+      std::ifstream stream(filePath.c_str(), std::ios::in | std::ios::binary);
+      char magic[sizeof(MAP_BINARY_MAGIC)];
+      if (!stream.is_open() || !stream.read(magic, sizeof(magic)))
+      {
+         return false;
+      }
+      return std::memcmp(magic, MAP_BINARY_MAGIC, sizeof(magic)) == 0;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   bool MapBinaryReader::IsUpToDate(const std::string& binaryPath, const std::string& xmlPath)
+   {
+      std::ifstream stream(binaryPath.c_str(), std::ios::in | std::ios::binary);
+      const size_t headerSize = sizeof(MAP_BINARY_MAGIC) + 2 * sizeof(unsigned) + 2 * sizeof(unsigned long long);
+      char header[headerSize];
+      if (!stream.is_open() || !stream.read(header, headerSize)
+         || std::memcmp(header, MAP_BINARY_MAGIC, sizeof(MAP_BINARY_MAGIC)) != 0)
+      {
+         return false;
+      }
+
+      dtUtil::DataStream ds(header, unsigned(headerSize), false);
+      ds.SetForceLittleEndian(true);
+      ds.Seekg(sizeof(MAP_BINARY_MAGIC), dtUtil::DataStream::SeekTypeEnum::SET);
+      unsigned version = 0U, compression = 0U;
+      unsigned long long sourceSize = 0ULL, sourceHash = 0ULL;
+      ds >> version >> compression >> sourceSize >> sourceHash;
+      if (version != MAP_BINARY_VERSION || sourceSize == 0ULL)
+      {
+         return false;
+      }
+
+      // Checking the size first avoids hashing the xml for most edits.
+      dtUtil::FileInfo xmlInfo = dtUtil::FileUtils::GetInstance().GetFileInfo(xmlPath);
+      if (xmlInfo.fileType != dtUtil::REGULAR_FILE || (unsigned long long)xmlInfo.size != sourceSize)
+      {
+         return false;
+      }
+
+      unsigned long long xmlSize = 0ULL, xmlHash = 0ULL;
+      return ComputeSourceStamp(xmlPath, xmlSize, xmlHash) && xmlSize == sourceSize && xmlHash == sourceHash;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   MapPtr MapBinaryReader::Load(const std::string& filePath)
+   {
+      std::ifstream stream(filePath.c_str(), std::ios::in | std::ios::binary);
+      if (!stream.is_open())
+      {
+         throw dtCore::MapParsingException("Unable to open binary map \"" + filePath + "\".", __FILE__, __LINE__);
+      }
+      return Load(stream);
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   MapPtr MapBinaryReader::Load(std::istream& stream)
+   {
+      Decode(stream, true);
+      BeginBuild();
+      BuildActors(0.0);
+      return FinishBuild();
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void MapBinaryReader::Decode(std::istream& stream, bool decodeInParallel)
+   {
+      delete mLoadState;
+      mLoadState = NULL;
+
+      std::vector<char> buffer((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+      if (buffer.size() < sizeof(MAP_BINARY_MAGIC) || std::memcmp(&buffer[0], MAP_BINARY_MAGIC, sizeof(MAP_BINARY_MAGIC)) != 0)
+      {
+         throw dtCore::MapParsingException("The data is not a binary map.", __FILE__, __LINE__);
+      }
+
+      std::unique_ptr<MapBinaryLoadState> state(new MapBinaryLoadState());
+      LoadContext& ctx = state->mContext;
+
+      try
+      {
+         dtUtil::DataStream ds(&buffer[0], unsigned(buffer.size()), false);
+         ds.SetForceLittleEndian(true);
+         ds.Seekg(sizeof(MAP_BINARY_MAGIC), dtUtil::DataStream::SeekTypeEnum::SET);
+
+         unsigned version = 0U, compression = 0U;
+         unsigned long long sourceSize = 0ULL, sourceHash = 0ULL;
+         ds >> version >> compression >> sourceSize >> sourceHash;
+         if (version != MAP_BINARY_VERSION)
+         {
+            throw dtCore::MapParsingException("Unsupported binary map version " + dtUtil::ToString(version) + ".", __FILE__, __LINE__);
+         }
+         if (compression != MAP_BINARY_COMPRESSION_NONE)
+         {
+            throw dtCore::MapParsingException("Unsupported binary map compression " + dtUtil::ToString(compression) + ".", __FILE__, __LINE__);
+         }
+
+         // STRING TABLE
+         unsigned stringCount = 0U;
+         ds >> stringCount;
+         ctx.mStrings.resize(stringCount);
+         for (unsigned i = 0; i < stringCount; ++i)
+         {
+            ReadRawString(ds, ctx.mStrings[i]);
+         }
+
+         // HEADER: name, description, author, comment, copyright, create time and icon file.
+         for (unsigned i = 0; i < 7; ++i)
+         {
+            ds >> state->mHeader[i];
+            ctx.GetString(state->mHeader[i]);
+         }
+
+         // LIBRARIES
+         unsigned libCount = 0U;
+         ds >> libCount;
+         state->mLibraries.resize(libCount);
+         for (unsigned i = 0; i < libCount; ++i)
+         {
+            ds >> state->mLibraries[i].first >> state->mLibraries[i].second;
+         }
+
+         // EVENTS
+         unsigned eventCount = 0U;
+         ds >> eventCount;
+         state->mEvents.resize(eventCount * 3U);
+         for (unsigned i = 0; i < eventCount * 3U; ++i)
+         {
+            ds >> state->mEvents[i];
+         }
+
+         ds >> state->mEnvActorIndex;
+
+         // TYPES, resolved in BeginBuild once each instead of once per actor.
+         unsigned typeCount = 0U;
+         ds >> typeCount;
+         ctx.mTypeNames.resize(typeCount);
+         for (unsigned i = 0; i < typeCount; ++i)
+         {
+            unsigned category, typeName;
+            ds >> category >> typeName;
+            ctx.mTypeNames[i] = std::make_pair(ctx.GetString(category), ctx.GetString(typeName));
+         }
+
+         // ACTORS
+         unsigned actorCount = 0U;
+         ds >> actorCount;
+         state->mRecords.resize(actorCount);
+         for (unsigned i = 0; i < actorCount; ++i)
+         {
+            ReadActorRecord(ds, state->mRecords[i]);
+         }
+
+         // GROUPS
+         int groupCount = 0;
+         ds >> groupCount;
+         for (int i = 0; i < groupCount; ++i)
+         {
+            unsigned groupActorCount = 0U;
+            ds >> groupActorCount;
+            state->mGroupSizes.push_back(int(groupActorCount));
+            for (unsigned j = 0; j < groupActorCount; ++j)
+            {
+               unsigned id;
+               ds >> id;
+               state->mGroupActorIds.push_back(id);
+            }
+         }
+
+         // PRESET CAMERAS
+         unsigned presetCount = 0U;
+         ds >> presetCount;
+         for (unsigned i = 0; i < presetCount; ++i)
+         {
+            Map::PresetCameraData data;
+            int index = ReadPresetCamera(ds, data);
+            state->mPresets.push_back(std::make_pair(index, data));
+         }
+      }
+      catch (const dtCore::MapParsingException&)
+      {
+         throw;
+      }
+      catch (const dtUtil::Exception& ex)
+      {
+         throw dtCore::MapParsingException("The binary map is corrupt: " + ex.What(), __FILE__, __LINE__);
+      }
+
+      // Decode the property blobs.  This is pure data work, so it can be spread over the thread pool.
+      ActorRecordPtrVector allRecords;
+      CollectRecords(state->mRecords, allRecords);
+
+      size_t numTasks = 1;
+      if (decodeInParallel && dtUtil::ThreadPool::IsInitialized())
+      {
+         numTasks = std::min(size_t(dtUtil::ThreadPool::GetNumImmediateWorkerThreads()),
+            allRecords.size() / MIN_ACTORS_PER_DECODE_TASK);
+      }
+
+      if (numTasks > 1)
+      {
+         std::vector<dtCore::RefPtr<DecodePropertiesTask> > tasks;
+         size_t perTask = (allRecords.size() + numTasks - 1) / numTasks;
+         for (size_t begin = 0; begin < allRecords.size(); begin += perTask)
+         {
+            size_t end = std::min(begin + perTask, allRecords.size());
+            tasks.push_back(new DecodePropertiesTask(&buffer[0], allRecords, begin, end));
+            dtUtil::ThreadPool::AddTask(*tasks.back());
+         }
+         dtUtil::ThreadPool::ExecuteTasks();
+      }
+      else
+      {
+         for (ActorRecordPtrVector::iterator i = allRecords.begin(); i != allRecords.end(); ++i)
+         {
+            DecodeProperties(&buffer[0], **i);
+         }
+      }
+
+      for (ActorRecordPtrVector::const_iterator i = allRecords.begin(); i != allRecords.end(); ++i)
+      {
+         if ((*i)->mDecodeFailed)
+         {
+            throw dtCore::MapParsingException("The binary map has a corrupt actor record: " + (*i)->mDecodeError, __FILE__, __LINE__);
+         }
+      }
+
+      mLoadState = state.release();
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void MapBinaryReader::BeginBuild()
+   {
+      if (mLoadState == NULL)
+      {
+         throw dtCore::MapParsingException("BeginBuild was called without a decoded binary map.", __FILE__, __LINE__);
+      }
+
+      mMissingLibraries.clear();
+      mMissingActorTypes.clear();
+      mHasDeprecatedProperty = false;
+
+      MapBinaryLoadState& state = *mLoadState;
+      LoadContext& ctx = state.mContext;
+
+      MapPtr map = new Map("", "");
+      state.mMap = map;
+      state.mNextRecord = 0U;
+      ctx.mLogger = mLogger;
+      ctx.mMap = map.get();
+      ctx.mMissingActorTypes = &mMissingActorTypes;
+      ctx.mHasDeprecatedProperty = false;
+      ctx.mActorLinks.clear();
+      ctx.mGroupProperties.clear();
+
+      // HEADER
+      map->SetName(ctx.GetString(state.mHeader[0]));
+      map->SetDescription(ctx.GetString(state.mHeader[1]));
+      map->SetAuthor(ctx.GetString(state.mHeader[2]));
+      map->SetComment(ctx.GetString(state.mHeader[3]));
+      map->SetCopyright(ctx.GetString(state.mHeader[4]));
+      map->SetCreateDateTime(ctx.GetString(state.mHeader[5]));
+      map->SetIconFile(ctx.GetString(state.mHeader[6]));
+
+      // LIBRARIES
+      for (std::vector<std::pair<unsigned, unsigned> >::const_iterator i = state.mLibraries.begin(); i != state.mLibraries.end(); ++i)
+      {
+         const std::string& libNameStr = ctx.GetString(i->first);
+         const std::string& libVersionStr = ctx.GetString(i->second);
+         try
+         {
+            if (ActorFactory::GetInstance().GetRegistry(libNameStr) == NULL)
+            {
+               ActorFactory::GetInstance().LoadActorRegistry(libNameStr);
+            }
+            map->AddLibrary(libNameStr, libVersionStr);
+         }
+         catch (const dtUtil::Exception& e)
+         {
+            mMissingLibraries.push_back(libNameStr);
+
+            mLogger->LogMessage(dtUtil::Log::LOG_ERROR, __FUNCTION__, __LINE__,
+               "Error loading library %s version %s in the library manager.  Exception message to follow.",
+               libNameStr.c_str(), libVersionStr.c_str());
+            e.LogException(dtUtil::Log::LOG_ERROR, *mLogger);
+         }
+      }
+
+      // EVENTS
+      for (size_t i = 0; i + 2 < state.mEvents.size(); i += 3)
+      {
+         RefPtr<GameEvent> gameEvent = new GameEvent();
+         gameEvent->SetUniqueId(dtCore::UniqueId(ctx.GetString(state.mEvents[i])));
+         gameEvent->SetName(ctx.GetString(state.mEvents[i + 1]));
+         gameEvent->SetDescription(ctx.GetString(state.mEvents[i + 2]));
+         map->GetEventManager().AddEvent(*gameEvent);
+      }
+
+      // TYPES, once the libraries are loaded.
+      ctx.mTypes.resize(ctx.mTypeNames.size());
+      for (size_t i = 0; i < ctx.mTypeNames.size(); ++i)
+      {
+         ctx.mTypes[i] = MapContentHandler::FindActorType(ctx.mTypeNames[i].first, ctx.mTypeNames[i].second);
+      }
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   bool MapBinaryReader::BuildActors(double milliseconds)
+   {
+      if (mLoadState == NULL || !mLoadState->mMap.valid())
+      {
+         throw dtCore::MapParsingException("BuildActors was called before BeginBuild.", __FILE__, __LINE__);
+      }
+
+      MapBinaryLoadState& state = *mLoadState;
+
+      // Creating actors and setting properties touches the scene and resources, so it stays on this thread.
+      const osg::Timer& timer = *osg::Timer::instance();
+      const osg::Timer_t start = timer.tick();
+      while (state.mNextRecord < state.mRecords.size())
+      {
+         CreateActor(state.mContext, state.mRecords[state.mNextRecord], NULL);
+         ++state.mNextRecord;
+
+         if (milliseconds > 0.0 && timer.delta_m(start, timer.tick()) >= milliseconds)
+         {
+            break;
+         }
+      }
+
+      return state.mNextRecord >= state.mRecords.size();
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   bool MapBinaryReader::IsBuilding() const
+   {
+      return mLoadState != NULL && mLoadState->mMap.valid();
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   size_t MapBinaryReader::GetNumActors() const
+   {
+      return mLoadState != NULL ? mLoadState->mRecords.size() : 0U;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   size_t MapBinaryReader::GetNumActorsBuilt() const
+   {
+      return mLoadState != NULL ? mLoadState->mNextRecord : 0U;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   MapPtr MapBinaryReader::FinishBuild()
+   {
+      if (mLoadState == NULL || !mLoadState->mMap.valid() || mLoadState->mNextRecord < mLoadState->mRecords.size())
+      {
+         throw dtCore::MapParsingException("FinishBuild was called before all the actors were built.", __FILE__, __LINE__);
+      }
+
+      // Let go of the decoded records however this ends.
+      std::unique_ptr<MapBinaryLoadState> state(mLoadState);
+      mLoadState = NULL;
+
+      LoadContext& ctx = state->mContext;
+      MapPtr map = state->mMap;
+
+      // Link actor properties now that all the actors exist.
+      for (std::vector<DeferredProperty>::const_iterator i = ctx.mActorLinks.begin(); i != ctx.mActorLinks.end(); ++i)
+      {
+         ActorActorProperty* aap = dynamic_cast<ActorActorProperty*>(FindDeferredProperty(*i));
+         if (aap == NULL)
+         {
+            mLogger->LogMessage(dtUtil::Log::LOG_INFO, __FUNCTION__, __LINE__,
+               "Actor property %s does not exist on actor %s.", i->mPropertyName.c_str(), i->mActor->GetName().c_str());
+            continue;
+         }
+
+         if (i->mValue.empty())
+         {
+            aap->SetValue(NULL);
+            continue;
+         }
+
+         BaseActorObject* valueActor = map->GetProxyById(dtCore::UniqueId(i->mValue));
+         if (valueActor == NULL)
+         {
+            mLogger->LogMessage(dtUtil::Log::LOG_ERROR, __FUNCTION__, __LINE__,
+               "Actor property %s was set with actor %s, but the actor does not exist in the new map.",
+               i->mPropertyName.c_str(), i->mValue.c_str());
+            continue;
+         }
+         aap->SetValue(valueActor);
+      }
+
+      for (std::vector<DeferredProperty>::const_iterator i = ctx.mGroupProperties.begin(); i != ctx.mGroupProperties.end(); ++i)
+      {
+         ActorProperty* prop = FindDeferredProperty(*i);
+         if (prop == NULL || !prop->FromString(i->mValue))
+         {
+            mLogger->LogMessage(dtUtil::Log::LOG_INFO, __FUNCTION__, __LINE__,
+               "Unable to set group property %s on actor %s.", i->mPropertyName.c_str(), i->mActor->GetName().c_str());
+         }
+      }
+
+      mHasDeprecatedProperty = ctx.mHasDeprecatedProperty;
+
+      // GROUPS
+      std::vector<unsigned>::const_iterator groupIdIter = state->mGroupActorIds.begin();
+      for (std::vector<int>::const_iterator i = state->mGroupSizes.begin(); i != state->mGroupSizes.end(); ++i)
+      {
+         int groupIndex = map->GetGroupCount();
+         for (int j = 0; j < *i; ++j, ++groupIdIter)
+         {
+            BaseActorObject* actor = map->GetProxyById(dtCore::UniqueId(ctx.GetString(*groupIdIter)));
+            if (actor != NULL)
+            {
+               map->AddActorToGroup(groupIndex, *actor);
+            }
+         }
+      }
+
+      for (std::vector<std::pair<int, Map::PresetCameraData> >::const_iterator i = state->mPresets.begin(); i != state->mPresets.end(); ++i)
+      {
+         map->SetPresetCameraData(i->first, i->second);
+      }
+
+      if (state->mEnvActorIndex != NO_INDEX)
+      {
+         BaseActorObject* envActor = map->GetProxyById(dtCore::UniqueId(ctx.GetString(state->mEnvActorIndex)));
+         if (envActor != NULL)
+         {
+            IEnvironmentActor* ea = dynamic_cast<IEnvironmentActor*>(envActor->GetDrawable());
+            if (ea == NULL)
+            {
+               throw dtCore::InvalidActorException(
+                  "The environment actor proxy's actor should be an environment, but a dynamic_cast failed", __FILE__, __LINE__);
+            }
+            map->SetEnvironmentActor(envActor);
+         }
+      }
+
+      return map;
+   }
+}
@@ -3,11 +3,13 @@
 //////////////////////////////////////////////////////////////////////
 #include <prefix/dtcoreprefix.h>
 #include <dtCore/object.h>
+#include <dtCore/asyncmeshloader.h>
 #include <dtCore/transform.h>
 #include <dtCore/project.h>
 
 #include <dtUtil/boundingshapeutils.h>
 
+#include <osg/CopyOp>
 #include <osg/MatrixTransform>
 #include <osg/Matrix>
 
@@ -22,7 +24,9 @@ namespace dtCore
       , mUseCache(true)
       , mRecenterGeometryUponLoad(false)
       , mGenerateTangents(false)
+      , mLoadAsynchronously(false)
       , mModel(new Model)
+      , mMeshLoading(false)
    {
       Ctor();
    }
@@ -33,7 +37,9 @@ namespace dtCore
       , mUseCache(true)
       , mRecenterGeometryUponLoad(false)
       , mGenerateTangents(false)
+      , mLoadAsynchronously(false)
       , mModel(new Model)
+      , mMeshLoading(false)
    {
       Ctor();
    }
@@ -54,18 +60,37 @@ namespace dtCore
    Object::~Object()
    {
       //DeregisterInstance(this);
+      if (mMeshLoading)
+      {
+         AsyncMeshLoader::GetInstance().CancelLoad(*this);
+         mMeshLoading = false;
+      }
    }
 
    /////////////////////////////////////////////////////////////////////////////
    osg::Node* Object::LoadFile(const std::string& filename, bool useCache)
    {
+      // A synchronous load replaces whatever was requested asynchronously.
+      if (mMeshLoading)
+      {
+         AsyncMeshLoader::GetInstance().CancelLoad(*this);
+         mMeshLoading = false;
+      }
+
       osg::Node* node = NULL;
       node = Loadable::LoadFile(filename, useCache);
 
+      AttachMesh(node);
+      return node;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void Object::AttachMesh(osg::Node* node)
+   {
       //We should always clear the geometry.  If LoadFile fails, we should have no geometry.
       if (mModel->GetMatrixTransform().getNumChildren() != 0)
       {
-         mModel->GetMatrixTransform().removeChild(0,GetMatrixNode()->getNumChildren());
+         mModel->GetMatrixTransform().removeChildren(0, mModel->GetMatrixTransform().getNumChildren());
       }
 
       //attach our geometry node to the matrix node
@@ -91,13 +116,70 @@ namespace dtCore
          {
             GenerateTangents();
          }
+      }
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void Object::LoadMeshResource()
+   {
+      const std::string filename = dtCore::Project::GetInstance().GetResourcePath(mMeshResource);
+      if (!mLoadAsynchronously)
+      {
+         LoadFile(filename, GetUseCache());
+         return;
+      }
+
+      // Show the placeholder until the real mesh arrives.
+      osg::MatrixTransform& modelTransform = mModel->GetMatrixTransform();
+      modelTransform.removeChildren(0, modelTransform.getNumChildren());
+      if (mPlaceholderNode.valid())
+      {
+         modelTransform.addChild(mPlaceholderNode.get());
+      }
 
-         return node;
+      // A cached mesh is delivered before RequestLoad returns, which clears the flag again.
+      mMeshLoading = true;
+      if (!AsyncMeshLoader::GetInstance().RequestLoad(*this, filename, GetUseCache()))
+      {
+         mMeshLoading = false;
+         LoadFile(filename, GetUseCache());
       }
-      else
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void Object::OnAsyncMeshLoaded(const std::string& filename, osg::Node* node)
+   {
+      mMeshLoading = false;
+      mFilename = filename;
+
+      // A cached node is shared with other objects, so generate the tangents on our own copy of
+      // the geometry.  Recentering only sets our transform and can use the shared node.
+      dtCore::RefPtr<osg::Node> toAttach = node;
+      if (node != NULL && mGenerateTangents && GetUseCache())
       {
-         return NULL;
+         toAttach = static_cast<osg::Node*>(node->clone(osg::CopyOp::DEEP_COPY_NODES | osg::CopyOp::DEEP_COPY_DRAWABLES));
       }
+
+      AttachMesh(toAttach.get());
+      MeshLoaded(this, toAttach.get());
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void Object::SetPlaceholderNode(osg::Node* node)
+   {
+      mPlaceholderNode = node;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   osg::Node* Object::GetPlaceholderNode()
+   {
+      return mPlaceholderNode.get();
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   bool Object::IsMeshLoading() const
+   {
+      return mMeshLoading;
    }
 
    //////////////////////////////////////////////////////////////////////////////
@@ -111,7 +193,7 @@ namespace dtCore
       {
          if (mMeshResource != dtCore::ResourceDescriptor::NULL_RESOURCE)
          {
-            LoadFile(dtCore::Project::GetInstance().GetResourcePath(mMeshResource), GetUseCache());
+            LoadMeshResource();
          }
       }
    }
@@ -120,6 +202,7 @@ namespace dtCore
    DT_IMPLEMENT_ACCESSOR(Object, bool, UseCache);
    DT_IMPLEMENT_ACCESSOR(Object, bool, RecenterGeometryUponLoad);
    DT_IMPLEMENT_ACCESSOR(Object, bool, GenerateTangents);
+   DT_IMPLEMENT_ACCESSOR(Object, bool, LoadAsynchronously);
 
 
    //////////////////////////////////////////////////////////////////////////
@@ -134,7 +217,7 @@ namespace dtCore
          // For the initial setting, load the mesh when we first enter the world so we can use the cache variable
          if (GetSceneParent())
          {
-            LoadFile(dtCore::Project::GetInstance().GetResourcePath(mMeshResource), GetUseCache());
+            LoadMeshResource();
          }
       }
 
@@ -24,11 +24,73 @@
 
 #include <prefix/dtcoreprefix.h>
 #include <dtCore/objecttype.h>
+#include <dtUtil/hashmap.h>
 
+#include <OpenThreads/Atomic>
+#include <OpenThreads/Mutex>
+#include <OpenThreads/ScopedLock>
+
+#include <algorithm>
 #include <iostream>
 
 namespace dtCore
 {
+   namespace
+   {
+      const unsigned BITS_PER_WORD = sizeof(unsigned) * 8U;
+
+      typedef dtUtil::HashMap<std::string, unsigned> TypeIdMap;
+
+      // Types are created during static initialization in many libraries, so these are
+      // function statics to be sure they exist first.
+      OpenThreads::Mutex& GetTypeIdMutex()
+      {
+         static OpenThreads::Mutex mutex;
+         return mutex;
+      }
+
+      TypeIdMap& GetTypeIdMap()
+      {
+         static TypeIdMap typeIds;
+         return typeIds;
+      }
+
+      OpenThreads::Atomic& GetTypeIdGenerationCounter()
+      {
+         static OpenThreads::Atomic generation;
+         return generation;
+      }
+
+      ////////////////////////////////////////////////////////////////////////
+      unsigned AcquireTypeId(const std::string& uniqueId)
+      {
+         OpenThreads::ScopedLock<OpenThreads::Mutex> lock(GetTypeIdMutex());
+         TypeIdMap& typeIds = GetTypeIdMap();
+         TypeIdMap::const_iterator i = typeIds.find(uniqueId);
+         if (i != typeIds.end())
+         {
+            return i->second;
+         }
+
+         unsigned newId = unsigned(typeIds.size());
+         typeIds.insert(std::make_pair(uniqueId, newId));
+         return newId;
+      }
+
+      ////////////////////////////////////////////////////////////////////////
+      bool FindTypeId(const std::string& uniqueId, unsigned& typeIdOut)
+      {
+         OpenThreads::ScopedLock<OpenThreads::Mutex> lock(GetTypeIdMutex());
+         const TypeIdMap& typeIds = GetTypeIdMap();
+         TypeIdMap::const_iterator i = typeIds.find(uniqueId);
+         if (i == typeIds.end())
+         {
+            return false;
+         }
+         typeIdOut = i->second;
+         return true;
+      }
+   }
 
    ///////////////////////////////////////////////////////////////////////////
    ObjectType::ObjectType(const std::string& name,
@@ -38,6 +100,8 @@ namespace dtCore
    : mName(name)
    , mCategory(category)
    , mDescription(desc)
+   , mTypeId(0U)
+   , mAncestorGeneration(0U)
    , mParentType(parentType)
    {
       GenerateUniqueId();
@@ -73,6 +137,8 @@ namespace dtCore
    void ObjectType::SetName(const std::string& name)
    {
       mName = name;
+      // Types made from this one now hold a stale id for it.
+      ++GetTypeIdGenerationCounter();
       GenerateUniqueId();
    }
 
@@ -83,6 +149,7 @@ namespace dtCore
    void ObjectType::SetCategory(const std::string& category)
    {
       mCategory = category;
+      ++GetTypeIdGenerationCounter();
       GenerateUniqueId();
    }
 
@@ -105,6 +172,39 @@ namespace dtCore
    void ObjectType::GenerateUniqueId()
    {
       mUniqueId = mName + mCategory;
+      mTypeId = AcquireTypeId(mUniqueId);
+      BuildAncestorBits();
+   }
+
+   ///////////////////////////////////////////////////////////////////////////////
+   void ObjectType::BuildAncestorBits()
+   {
+      mAncestorGeneration = GetTypeIdGeneration();
+
+      unsigned maxId = 0U;
+      for (const ObjectType* t = this; t != NULL; t = t->GetParentType())
+      {
+         maxId = std::max(maxId, t->mTypeId);
+      }
+
+      mAncestorBits.assign(maxId / BITS_PER_WORD + 1U, 0U);
+      for (const ObjectType* t = this; t != NULL; t = t->GetParentType())
+      {
+         mAncestorBits[t->mTypeId / BITS_PER_WORD] |= 1U << (t->mTypeId % BITS_PER_WORD);
+      }
+   }
+
+   ///////////////////////////////////////////////////////////////////////////////
+   unsigned ObjectType::GetNumTypeIds()
+   {
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(GetTypeIdMutex());
+      return unsigned(GetTypeIdMap().size());
+   }
+
+   ///////////////////////////////////////////////////////////////////////////////
+   unsigned ObjectType::GetTypeIdGeneration()
+   {
+      return unsigned(GetTypeIdGenerationCounter());
    }
 
    ///////////////////////////////////////////////////////////////////////////////
@@ -117,15 +217,25 @@ namespace dtCore
    ///////////////////////////////////////////////////////////////////////////////
    bool ObjectType::InstanceOf(const ObjectType& rhs) const
    {
-      if (rhs == *this)
-         return true;
+      return InstanceOf(rhs.mTypeId);
+   }
 
-      const ObjectType* parent = GetParentType();
-      while (parent != NULL)
+   ///////////////////////////////////////////////////////////////////////////////
+   bool ObjectType::InstanceOf(unsigned typeId) const
+   {
+      if (mAncestorGeneration == GetTypeIdGeneration())
+      {
+         const unsigned word = typeId / BITS_PER_WORD;
+         return word < mAncestorBits.size() && (mAncestorBits[word] & (1U << (typeId % BITS_PER_WORD))) != 0;
+      }
+
+      // A type was renamed since the bits were made, so check the current ids of the parents.
+      for (const ObjectType* t = this; t != NULL; t = t->GetParentType())
       {
-         if (*parent == rhs)
+         if (t->mTypeId == typeId)
+         {
             return true;
-         parent = parent->GetParentType();
+         }
       }
 
       return false;
@@ -134,8 +244,9 @@ namespace dtCore
    ///////////////////////////////////////////////////////////////////////////////
    bool ObjectType::InstanceOf(const std::string& category, const std::string& name) const
    {
-      dtCore::RefPtr<ObjectType> typeToCheck = new ObjectType(name,category);
-      return InstanceOf(*typeToCheck);
+      // If no type has ever had this unique id, then this can't be one.
+      unsigned typeId = 0U;
+      return FindTypeId(name + category, typeId) && InstanceOf(typeId);
    }
 
    ////////////////////////////////////////////////////////////////////////////////
@@ -209,13 +320,13 @@ namespace dtCore
    ///////////////////////////////////////////////////////////////////////////
    bool ObjectType::operator==(const ObjectType& rhs) const
    {
-      return (mUniqueId == rhs.mUniqueId);
+      return mTypeId == rhs.mTypeId;
    }
 
    ///////////////////////////////////////////////////////////////////////////
    bool ObjectType::operator!=(const ObjectType& rhs) const
    {
-      return (mUniqueId != rhs.mUniqueId);
+      return mTypeId != rhs.mTypeId;
    }
 
    ///////////////////////////////////////////////////////////////////////////
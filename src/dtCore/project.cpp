@@ -22,6 +22,8 @@
 #include <prefix/dtcoreprefix.h>
 #include <string>
 #include <sstream>
+#include <fstream>
+#include <iterator>
 #include <set>
 #include <cassert>
 
@@ -41,6 +43,7 @@
 #include <dtCore/projectconfigxmlhandler.h>
 #include <dtCore/map.h>
 #include <dtCore/mapxml.h>
+#include <dtCore/mapbinary.h>
 #include <dtCore/datatype.h>
 #include <dtCore/exceptionenum.h>
 #include <dtCore/actorfactory.h>
@@ -123,8 +126,12 @@ namespace dtCore
       //internal handling for deleting a map.
       void InternalDeleteMap(const MapFileData& mapFileData);
 
-      //internal handling for loading a map.
-      Map& InternalLoadMap(const MapFileData& fileData, bool backup, bool clearModified);
+      // Finds the xml file of a map and the binary copy that may be loaded instead.
+      void GetMapFilePaths(const MapFileData& fileData, bool backup, std::string& xmlPathOut, std::string& binaryPathOut) const;
+
+      //internal handling for loading a map.  If preload was read, it is parsed instead of the file.
+      Map& InternalLoadMap(const MapFileData& fileData, bool backup, bool clearModified,
+         const Project::PreloadedMapFile* preload = NULL);
 
       MapPtr InternalLoadPrefab(const std::string& fullPath, dtCore::ActorRefPtrVector& actorsOut);
 
@@ -839,21 +846,42 @@ namespace dtCore
    }
 
    /////////////////////////////////////////////////////////////////////////////
-   Map& ProjectImpl::InternalLoadMap(const MapFileData& fileData, bool backup, bool clearModified)
+   void ProjectImpl::GetMapFilePaths(const MapFileData& fileData, bool backup, std::string& xmlPathOut, std::string& binaryPathOut) const
    {
-      dtUtil::FileUtils& fileUtils = dtUtil::FileUtils::GetInstance();
-
-      std::string fullPath = GetMapsDirectory(mContexts[fileData.mSlotId], true).fileName;
+      xmlPathOut = GetMapsDirectory(mContexts[fileData.mSlotId], true).fileName;
 
       if (backup)
       {
-         fullPath += dtUtil::FileUtils::PATH_SEPARATOR + GetBackupDir();
+         xmlPathOut += dtUtil::FileUtils::PATH_SEPARATOR + GetBackupDir();
       }
 
-      fullPath += dtUtil::FileUtils::PATH_SEPARATOR + fileData.mFileName;
+      xmlPathOut += dtUtil::FileUtils::PATH_SEPARATOR + fileData.mFileName;
       if (backup)
       {
-         fullPath += ".backup";
+         xmlPathOut += ".backup";
+         // Backups are always xml.
+         binaryPathOut.clear();
+      }
+      else
+      {
+         binaryPathOut = osgDB::getNameLessExtension(xmlPathOut) + "." + MapBinaryWriter::MAP_FILE_EXTENSION;
+      }
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   Map& ProjectImpl::InternalLoadMap(const MapFileData& fileData, bool backup, bool clearModified,
+      const Project::PreloadedMapFile* preload)
+   {
+      dtUtil::FileUtils& fileUtils = dtUtil::FileUtils::GetInstance();
+
+      std::string fullPath, binaryPath;
+      GetMapFilePaths(fileData, backup, fullPath, binaryPath);
+
+      // Contents read for another path, not read at all, or already built into a map are ignored.
+      if (preload != NULL && (!preload->mRead || preload->mXmlPath != fullPath
+            || (preload->mBinaryReader.valid() && !preload->mBinaryReader->IsDecoded())))
+      {
+         preload = NULL;
       }
 
       Map* map = NULL;
@@ -869,13 +897,68 @@ namespace dtCore
 
       try
       {
-         if (fileUtils.GetFileInfo(fullPath).fileType != dtUtil::REGULAR_FILE)
+         if (preload == NULL && fileUtils.GetFileInfo(fullPath).fileType != dtUtil::REGULAR_FILE)
          {
             throw dtCore::ProjectFileNotFoundException(
                    std::string("Map file \"") + fullPath + "\" not found.", __FILE__, __LINE__);
          }
 
-         if (!mParser->Parse(fullPath, &map) || map == NULL)
+         // The xml is the source of truth, but a binary copy written from the same xml loads much faster.
+         dtCore::RefPtr<MapBinaryReader> binaryReader;
+         MapPtr binaryMap;
+         const bool useBinary = preload != NULL ? preload->mBinary
+            : !binaryPath.empty() && fileUtils.GetFileInfo(binaryPath).fileType == dtUtil::REGULAR_FILE
+               && MapBinaryReader::IsUpToDate(binaryPath, fullPath);
+         if (useBinary)
+         {
+            try
+            {
+               if (preload != NULL && preload->mBinaryReader.valid())
+               {
+                  // Decoded off the main thread, and maybe partly built by ContinueOpeningMap.
+                  binaryReader = preload->mBinaryReader;
+                  if (!binaryReader->IsBuilding())
+                  {
+                     binaryReader->BeginBuild();
+                  }
+                  binaryReader->BuildActors(0.0);
+                  binaryMap = binaryReader->FinishBuild();
+               }
+               else if (preload != NULL)
+               {
+                  binaryReader = new MapBinaryReader();
+                  std::istringstream stream(preload->mData);
+                  binaryMap = binaryReader->Load(stream);
+               }
+               else
+               {
+                  binaryReader = new MapBinaryReader();
+                  binaryMap = binaryReader->Load(binaryPath);
+               }
+               map = binaryMap.get();
+            }
+            catch (const dtUtil::Exception& ex)
+            {
+               mLogger->LogMessage(dtUtil::Log::LOG_WARNING, __FUNCTION__, __LINE__,
+                  "Unable to load binary map \"%s\", loading the xml map instead.  Error: %s",
+                  binaryPath.c_str(), ex.What().c_str());
+               binaryReader = NULL;
+               binaryMap = NULL;
+               map = NULL;
+            }
+         }
+
+         if (map == NULL && preload != NULL && !preload->mBinary)
+         {
+            std::istringstream stream(preload->mData);
+            if (!mParser->Parse(stream, &map) || map == NULL)
+            {
+               throw dtCore::MapParsingException(
+                  "Map loading didn't throw an exception, but the result is NULL", __FILE__, __LINE__);
+            }
+         }
+
+         if (map == NULL && (!mParser->Parse(fullPath, &map) || map == NULL))
          {
             throw dtCore::MapParsingException(
                "Map loading didn't throw an exception, but the result is NULL", __FILE__, __LINE__);
@@ -893,14 +976,27 @@ namespace dtCore
             map->ClearModified();
          }
 
-         // If the map has a temporary property, we should mark it modified.
-         if (mParser->HasDeprecatedProperty())
+         if (binaryReader.valid())
          {
-            map->SetModified(true);
+            if (binaryReader->HasDeprecatedProperty())
+            {
+               map->SetModified(true);
+            }
+
+            map->AddMissingLibraries(binaryReader->GetMissingLibraries());
+            map->AddMissingActorTypes(binaryReader->GetMissingActorTypes());
          }
+         else
+         {
+            // If the map has a temporary property, we should mark it modified.
+            if (mParser->HasDeprecatedProperty())
+            {
+               map->SetModified(true);
+            }
 
-         map->AddMissingLibraries(mParser->GetMissingLibraries());
-         map->AddMissingActorTypes(mParser->GetMissingActorTypes());
+            map->AddMissingLibraries(mParser->GetMissingLibraries());
+            map->AddMissingActorTypes(mParser->GetMissingActorTypes());
+         }
       }
       catch (const dtUtil::Exception& e)
       {
@@ -917,6 +1013,117 @@ namespace dtCore
 
    /////////////////////////////////////////////////////////////////////////////
    Map& Project::GetMap(const std::string& name)
+   {
+      return GetMap(name, PreloadedMapFile());
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   Project::PreloadedMapFile::PreloadedMapFile()
+   : mBinary(false)
+   , mRead(false)
+   {
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   Project::PreloadedMapFile::PreloadedMapFile(const PreloadedMapFile& toCopy)
+   : mXmlPath(toCopy.mXmlPath)
+   , mBinaryPath(toCopy.mBinaryPath)
+   , mBinary(toCopy.mBinary)
+   , mRead(toCopy.mRead)
+   , mData(toCopy.mData)
+   , mBinaryReader(toCopy.mBinaryReader)
+   {
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   Project::PreloadedMapFile::~PreloadedMapFile()
+   {
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   Project::PreloadedMapFile& Project::PreloadedMapFile::operator=(const PreloadedMapFile& toCopy)
+   {
+      mXmlPath = toCopy.mXmlPath;
+      mBinaryPath = toCopy.mBinaryPath;
+      mBinary = toCopy.mBinary;
+      mRead = toCopy.mRead;
+      mData = toCopy.mData;
+      mBinaryReader = toCopy.mBinaryReader;
+      return *this;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void Project::BeginPreloadMap(const std::string& name, PreloadedMapFile& preload) const
+   {
+      if (!IsContextValid())
+      {
+         throw dtCore::ProjectInvalidContextException(
+         std::string("The context is not valid."), __FILE__, __LINE__);
+      }
+
+      ProjectImpl::MapListType::const_iterator mapIter = mImpl->mMapList.find(name);
+      if (mapIter == mImpl->mMapList.end())
+      {
+         throw dtCore::ProjectFileNotFoundException(
+                std::string("Map named ") + name + " does not exist.", __FILE__, __LINE__);
+      }
+
+      preload = PreloadedMapFile();
+      mImpl->GetMapFilePaths(mapIter->second, false, preload.mXmlPath, preload.mBinaryPath);
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   bool Project::ReadPreloadedMap(PreloadedMapFile& preload)
+   {
+      preload.mRead = false;
+      preload.mData.clear();
+      preload.mBinaryReader = NULL;
+      if (preload.mXmlPath.empty())
+      {
+         return false;
+      }
+
+      // Checking the binary copy hashes the xml, which is as much disk work as the rest.
+      preload.mBinary = !preload.mBinaryPath.empty() && MapBinaryReader::IsUpToDate(preload.mBinaryPath, preload.mXmlPath);
+
+      const std::string& path = preload.mBinary ? preload.mBinaryPath : preload.mXmlPath;
+      std::ifstream stream(path.c_str(), std::ios_base::in | std::ios_base::binary);
+      if (!stream.is_open())
+      {
+         return false;
+      }
+
+      preload.mData.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+      if (stream.bad())
+      {
+         preload.mData.clear();
+         return false;
+      }
+
+      preload.mRead = true;
+
+      if (preload.mBinary)
+      {
+         // Decoding creates nothing, so it is safe here.  The pool may be busy with this thread, so it isn't used.
+         dtCore::RefPtr<MapBinaryReader> binaryReader = new MapBinaryReader();
+         try
+         {
+            std::istringstream stream(preload.mData);
+            binaryReader->Decode(stream, false);
+            preload.mBinaryReader = binaryReader;
+            std::string().swap(preload.mData);
+         }
+         catch (const dtUtil::Exception&)
+         {
+            // The data is kept, so opening the map reports the error and falls back to the xml.
+         }
+      }
+
+      return true;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   Map& Project::GetMap(const std::string& name, const PreloadedMapFile& preload)
    {
       if (!IsContextValid())
       {
@@ -942,12 +1149,43 @@ namespace dtCore
 
       MapFileData& fileData = mapIter->second;
 
-      Map& map = mImpl->InternalLoadMap(fileData, false, true);
+      Map& map = mImpl->InternalLoadMap(fileData, false, true, &preload);
 
       map.SetFileName(fileData.mFileName);
       return map;
    }
 
+   //////////////////////////////////////////////////////////////////////////
+   Map* Project::ContinueOpeningMap(const std::string& name, PreloadedMapFile& preload, double milliseconds)
+   {
+      if (milliseconds > 0.0 && preload.mBinaryReader.valid() && preload.mBinaryReader->IsDecoded() && !IsMapOpen(name))
+      {
+         MapBinaryReader& binaryReader = *preload.mBinaryReader;
+         try
+         {
+            if (!binaryReader.IsBuilding())
+            {
+               binaryReader.BeginBuild();
+            }
+
+            if (!binaryReader.BuildActors(milliseconds))
+            {
+               return NULL;
+            }
+         }
+         catch (const dtUtil::Exception& ex)
+         {
+            mImpl->mLogger->LogMessage(dtUtil::Log::LOG_WARNING, __FUNCTION__, __LINE__,
+               "Unable to build binary map \"%s\", loading the map from disk instead.  Error: %s",
+               name.c_str(), ex.What().c_str());
+            preload = PreloadedMapFile();
+         }
+      }
+
+      // Finishes the map built so far, or opens it in one go.
+      return &GetMap(name, preload);
+   }
+
    //////////////////////////////////////////////////////////////////////////
    bool Project::IsMapOpen(const std::string& name)
    {
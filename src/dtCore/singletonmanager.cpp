@@ -1,6 +1,7 @@
 #include <prefix/dtcoreprefix.h>
 #include <dtCore/singletonmanager.h>
 #include <dtCore/shadermanager.h>
+#include <dtCore/asyncmeshloader.h>
 
 ////////////////////////////////////////////////////////////////////////////////
 dtCore::SingletonManager::SingletonManager()
@@ -18,5 +19,6 @@ dtCore::SingletonManager::~SingletonManager()
 void dtCore::SingletonManager::Destroy()
 {
    ShaderManager::Destroy();
+   AsyncMeshLoader::Destroy();
 }
 
@@ -7,6 +7,7 @@
 #include <dtUtil/log.h>
 #include <dtUtil/bits.h>
 #include <dtUtil/mswinmacros.h>
+#include <dtUtil/profiler.h>
 #include <dtCore/deltawin.h>
 
 #include <osgViewer/GraphicsWindow>
@@ -15,6 +16,9 @@
 //#include <sstream>
 #include <osg/Stats>
 
+#include <algorithm>
+#include <vector>
+
 using namespace dtUtil;
 
 namespace dtCore
@@ -35,6 +39,41 @@ namespace dtCore
    const dtUtil::RefString System::MESSAGE_EXIT("exit");
 
 
+   /// One functor subscribed to one stage.
+   struct StageSubscription
+   {
+      int mPriority;
+      unsigned mId;
+      /// Invalid for the entry that emits TickSignal.
+      System::TickFunctor mFunc;
+      bool mActive;
+   };
+
+   /// Orders by priority only, so a new subscription goes after the ones it ties with.
+   struct StageSubscriptionPriorityLess
+   {
+      bool operator()(int priority, const StageSubscription& sub) const
+      {
+         return priority < sub.mPriority;
+      }
+   };
+
+   /// The subscriptions of one stage.
+   struct StageSubscriptionList
+   {
+      StageSubscriptionList()
+      : mDispatchDepth(0U)
+      , mNeedsSweep(false)
+      {
+      }
+
+      std::vector<StageSubscription> mSubscriptions;
+      /// Subscribed while the stage was running.  Added once it finishes.
+      std::vector<StageSubscription> mPending;
+      unsigned mDispatchDepth;
+      bool mNeedsSweep;
+   };
+
    /// A wrapper for data like stats to prevent includes wherever system.h is used - uses the pimple pattern (like view)
    class SystemImpl
    {
@@ -57,7 +96,14 @@ namespace dtCore
       , mShutdownOnWindowClose(true)
       , mPaused(false)
       , mWasPaused(false)
+      , mLastSubscriptionId(0U)
       {
+         // TickSignal is emitted by an entry in each list, so it keeps its place among the subscribers.
+         for (unsigned i = 0; i < System::NUM_TICK_STAGES; ++i)
+         {
+            StageSubscription signalEntry = { System::TICK_SIGNAL_PRIORITY, 0U, System::TickFunctor(), true };
+            mStageSubscriptions[i].mSubscriptions.push_back(signalEntry);
+         }
       }
       ~SystemImpl()
       {
@@ -197,6 +243,14 @@ namespace dtCore
       ///One System frame
       void SystemStep(float realDt = 0.0f);
 
+      /// Calls the subscribers of a stage, including the listeners on TickSignal.
+      void DispatchStage(System::TickStage stage, const double deltaSimTime, const double deltaRealTime);
+
+      /// Drops the unsubscribed entries and adds the ones subscribed while the stage ran.
+      void MergeStageSubscriptions(StageSubscriptionList& list);
+
+      static void InsertStageSubscription(StageSubscriptionList& list, const StageSubscription& sub);
+
       dtCore::Timer mTickClock;
       dtCore::Timer_t mTimerStart;
       dtCore::ObserverPtr<osg::Stats> mStats;
@@ -234,6 +288,9 @@ namespace dtCore
       bool mPaused;
       bool mWasPaused;
 
+      StageSubscriptionList mStageSubscriptions[System::NUM_TICK_STAGES];
+      unsigned mLastSubscriptionId;
+      System::StageTimingFunctor mStageTimingHook;
    };
 
    bool SystemImpl::mInstanceFlag = false;
@@ -425,11 +482,11 @@ namespace dtCore
 
       if (mSystemImpl->mPaused)
       {
-         TickSignal.emit_signal(System::MESSAGE_PAUSE_START, 0.0, 0.0);
+         mSystemImpl->DispatchStage(System::TICK_PAUSE_START, 0.0, 0.0);
       }
       else
       {
-         TickSignal.emit_signal(System::MESSAGE_PAUSE_END, 0.0, 0.0);
+         mSystemImpl->DispatchStage(System::TICK_PAUSE_END, 0.0, 0.0);
       }
    }
 
@@ -455,7 +512,7 @@ namespace dtCore
    ////////////////////////////////////////////////////////////////////////////////
    void SystemImpl::Pause(const double deltaRealTime)
    {
-      System::GetInstance().TickSignal.emit_signal(System::MESSAGE_PAUSE, 0.0, deltaRealTime);
+      DispatchStage(System::TICK_PAUSE, 0.0, deltaRealTime);
    }
 
    ////////////////////////////////////////////////////////////////////////////////
@@ -627,7 +684,7 @@ namespace dtCore
       }
 
       LOG_DEBUG("System: Exiting...");
-      TickSignal.emit_signal(MESSAGE_EXIT, 0.0, 0.0);
+      mSystemImpl->DispatchStage(TICK_EXIT, 0.0, 0.0);
       LOG_DEBUG("System: Done Exiting.");
    }
 
@@ -677,7 +734,7 @@ namespace dtCore
       {
          StartStatTimer();
 
-         System::GetInstance().TickSignal.emit_signal(System::MESSAGE_EVENT_TRAVERSAL, deltaSimTime, deltaRealTime);
+         DispatchStage(System::TICK_EVENT_TRAVERSAL, deltaSimTime, deltaRealTime);
 
          EndStatTimer(System::MESSAGE_EVENT_TRAVERSAL, System::STAGE_EVENT_TRAVERSAL);
       }
@@ -690,7 +747,7 @@ namespace dtCore
       {
          StartStatTimer();
 
-         System::GetInstance().TickSignal.emit_signal(System::MESSAGE_POST_EVENT_TRAVERSAL, deltaSimTime, deltaRealTime);
+         DispatchStage(System::TICK_POST_EVENT_TRAVERSAL, deltaSimTime, deltaRealTime);
 
          EndStatTimer(System::MESSAGE_POST_EVENT_TRAVERSAL, System::STAGE_POST_EVENT_TRAVERSAL);
       }
@@ -703,7 +760,7 @@ namespace dtCore
       {
          StartStatTimer();
 
-         System::GetInstance().TickSignal.emit_signal(System::MESSAGE_PRE_FRAME, deltaSimTime, deltaRealTime);
+         DispatchStage(System::TICK_PRE_FRAME, deltaSimTime, deltaRealTime);
 
          EndStatTimer(System::MESSAGE_PRE_FRAME, System::STAGE_PREFRAME);
       }
@@ -716,7 +773,7 @@ namespace dtCore
       {
          StartStatTimer();
 
-         System::GetInstance().TickSignal.emit_signal(System::MESSAGE_FRAME_SYNCH, deltaSimTime, deltaRealTime);
+         DispatchStage(System::TICK_FRAME_SYNCH, deltaSimTime, deltaRealTime);
 
          EndStatTimer(System::MESSAGE_FRAME_SYNCH, System::STAGE_FRAME_SYNCH);
       }
@@ -729,7 +786,7 @@ namespace dtCore
       {
          StartStatTimer();
 
-         System::GetInstance().TickSignal.emit_signal(System::MESSAGE_CAMERA_SYNCH, deltaSimTime, deltaRealTime);
+         DispatchStage(System::TICK_CAMERA_SYNCH, deltaSimTime, deltaRealTime);
 
          EndStatTimer(System::MESSAGE_CAMERA_SYNCH, System::STAGE_CAMERA_SYNCH);
       }
@@ -742,7 +799,7 @@ namespace dtCore
       {
          StartStatTimer();
 
-         System::GetInstance().TickSignal.emit_signal(System::MESSAGE_FRAME, deltaSimTime, deltaRealTime);
+         DispatchStage(System::TICK_FRAME, deltaSimTime, deltaRealTime);
 
          EndStatTimer(System::MESSAGE_FRAME, System::STAGE_FRAME);
       }
@@ -755,7 +812,7 @@ namespace dtCore
       {
          StartStatTimer();
 
-         System::GetInstance().TickSignal.emit_signal(System::MESSAGE_POST_FRAME, deltaSimTime, deltaRealTime);
+         DispatchStage(System::TICK_POST_FRAME, deltaSimTime, deltaRealTime);
 
          EndStatTimer(System::MESSAGE_POST_FRAME, System::STAGE_POSTFRAME);
       }
@@ -766,7 +823,7 @@ namespace dtCore
    {
       if (dtUtil::Bits::Has(mSystemImpl->mSystemStages, System::STAGE_CONFIG))
       {
-         System::GetInstance().TickSignal.emit_signal(System::MESSAGE_CONFIG, 0.0, 0.0);
+         mSystemImpl->DispatchStage(System::TICK_CONFIG, 0.0, 0.0);
       }
    }
 
@@ -776,5 +833,191 @@ namespace dtCore
       return mSystemImpl->mSystemStageTimes[systemStage];
    }
 
-}
+   ////////////////////////////////////////////////////////////////////////////////
+   const dtUtil::RefString& System::GetTickStageMessage(TickStage stage)
+   {
+      switch (stage)
+      {
+      case TICK_EVENT_TRAVERSAL:      return MESSAGE_EVENT_TRAVERSAL;
+      case TICK_POST_EVENT_TRAVERSAL: return MESSAGE_POST_EVENT_TRAVERSAL;
+      case TICK_PRE_FRAME:            return MESSAGE_PRE_FRAME;
+      case TICK_CAMERA_SYNCH:         return MESSAGE_CAMERA_SYNCH;
+      case TICK_FRAME_SYNCH:          return MESSAGE_FRAME_SYNCH;
+      case TICK_FRAME:                return MESSAGE_FRAME;
+      case TICK_POST_FRAME:           return MESSAGE_POST_FRAME;
+      case TICK_CONFIG:               return MESSAGE_CONFIG;
+      case TICK_PAUSE:                return MESSAGE_PAUSE;
+      case TICK_PAUSE_START:          return MESSAGE_PAUSE_START;
+      case TICK_PAUSE_END:            return MESSAGE_PAUSE_END;
+      case TICK_EXIT:
+      default:                        return MESSAGE_EXIT;
+      }
+   }
+
+   ////////////////////////////////////////////////////////////////////////////////
+   unsigned System::SubscribeToStage(TickStage stage, const TickFunctor& func, int priority)
+   {
+      if (stage >= NUM_TICK_STAGES || !func.valid())
+      {
+         LOG_ERROR("Unable to subscribe to a system stage with an invalid stage or functor.");
+         return 0U;
+      }
+
+      StageSubscription sub = { priority, ++mSystemImpl->mLastSubscriptionId, func, true };
+      StageSubscriptionList& list = mSystemImpl->mStageSubscriptions[stage];
+      if (list.mDispatchDepth > 0U)
+      {
+         list.mPending.push_back(sub);
+      }
+      else
+      {
+         SystemImpl::InsertStageSubscription(list, sub);
+      }
+      return sub.mId;
+   }
+
+   ////////////////////////////////////////////////////////////////////////////////
+   bool System::UnsubscribeFromStage(unsigned subscriptionId)
+   {
+      if (subscriptionId == 0U)
+      {
+         return false;
+      }
+
+      for (unsigned i = 0; i < NUM_TICK_STAGES; ++i)
+      {
+         StageSubscriptionList& list = mSystemImpl->mStageSubscriptions[i];
+         for (std::vector<StageSubscription>::iterator itr = list.mSubscriptions.begin(); itr != list.mSubscriptions.end(); ++itr)
+         {
+            if (itr->mId == subscriptionId && itr->mActive)
+            {
+               if (list.mDispatchDepth > 0U)
+               {
+                  // The stage is looping over the list, so just skip it until the loop ends.
+                  itr->mActive = false;
+                  list.mNeedsSweep = true;
+               }
+               else
+               {
+                  list.mSubscriptions.erase(itr);
+               }
+               return true;
+            }
+         }
+
+         for (std::vector<StageSubscription>::iterator itr = list.mPending.begin(); itr != list.mPending.end(); ++itr)
+         {
+            if (itr->mId == subscriptionId)
+            {
+               list.mPending.erase(itr);
+               return true;
+            }
+         }
+      }
+      return false;
+   }
 
+   ////////////////////////////////////////////////////////////////////////////////
+   unsigned System::GetNumStageSubscribers(TickStage stage) const
+   {
+      if (stage >= NUM_TICK_STAGES)
+      {
+         return 0U;
+      }
+
+      const StageSubscriptionList& list = mSystemImpl->mStageSubscriptions[stage];
+      unsigned count = unsigned(list.mPending.size());
+      for (size_t i = 0; i < list.mSubscriptions.size(); ++i)
+      {
+         if (list.mSubscriptions[i].mActive && list.mSubscriptions[i].mFunc.valid())
+         {
+            ++count;
+         }
+      }
+      return count;
+   }
+
+   ////////////////////////////////////////////////////////////////////////////////
+   void System::SetStageTimingHook(const StageTimingFunctor& hook)
+   {
+      mSystemImpl->mStageTimingHook = hook;
+   }
+
+   ////////////////////////////////////////////////////////////////////////////////
+   void SystemImpl::DispatchStage(System::TickStage stage, const double deltaSimTime, const double deltaRealTime)
+   {
+      const dtUtil::RefString& message = System::GetTickStageMessage(stage);
+      DT_PROFILE_ZONE(message.c_str());
+
+      const bool timed = mStageTimingHook.valid();
+      const dtCore::Timer_t start = timed ? mTickClock.Tick() : 0;
+
+      StageSubscriptionList& list = mStageSubscriptions[stage];
+      ++list.mDispatchDepth;
+
+      // New subscriptions wait in mPending, so the list doesn't change size during the loop.
+      const size_t count = list.mSubscriptions.size();
+      for (size_t i = 0; i < count; ++i)
+      {
+         StageSubscription& sub = list.mSubscriptions[i];
+         if (!sub.mActive)
+         {
+            continue;
+         }
+
+         if (sub.mFunc.valid())
+         {
+            System::TickFunctor func = sub.mFunc;
+            func(deltaSimTime, deltaRealTime);
+         }
+         else
+         {
+            System::GetInstance().TickSignal.emit_signal(message, deltaSimTime, deltaRealTime);
+         }
+      }
+
+      if (--list.mDispatchDepth == 0U)
+      {
+         MergeStageSubscriptions(list);
+      }
+
+      if (timed)
+      {
+         mStageTimingHook(stage, mTickClock.DeltaMil(start, mTickClock.Tick()));
+      }
+   }
+
+   ////////////////////////////////////////////////////////////////////////////////
+   void SystemImpl::MergeStageSubscriptions(StageSubscriptionList& list)
+   {
+      if (list.mNeedsSweep)
+      {
+         std::vector<StageSubscription> active;
+         active.reserve(list.mSubscriptions.size());
+         for (size_t i = 0; i < list.mSubscriptions.size(); ++i)
+         {
+            if (list.mSubscriptions[i].mActive)
+            {
+               active.push_back(list.mSubscriptions[i]);
+            }
+         }
+         list.mSubscriptions.swap(active);
+         list.mNeedsSweep = false;
+      }
+
+      for (size_t i = 0; i < list.mPending.size(); ++i)
+      {
+         InsertStageSubscription(list, list.mPending[i]);
+      }
+      list.mPending.clear();
+   }
+
+   ////////////////////////////////////////////////////////////////////////////////
+   void SystemImpl::InsertStageSubscription(StageSubscriptionList& list, const StageSubscription& sub)
+   {
+      // Ids only go up, so inserting after the equal priorities keeps the order they subscribed in.
+      std::vector<StageSubscription>::iterator pos = std::upper_bound(list.mSubscriptions.begin(),
+         list.mSubscriptions.end(), sub.mPriority, StageSubscriptionPriorityLess());
+      list.mSubscriptions.insert(pos, sub);
+   }
+}
@@ -23,6 +23,8 @@
 #include <dtGame/message.h>
 #include <dtGame/messagetype.h>
 
+#include <algorithm>
+
 namespace dtDirector
 {
 
@@ -32,14 +34,16 @@ namespace dtDirector
    //////////////////////////////////////////////
    MessageGMComponent::MessageGMComponent(dtCore::SystemComponentType& type)
       : dtGame::GMComponent(type)
-      , mIsProcessingMessages(false)
+      , mProcessingDepth(0)
    {
    }
 
    //////////////////////////////////////////////
    MessageGMComponent::~MessageGMComponent()
    {
-      mRegisteredCallbacks.clear();
+      mTypeListeners.clear();
+      mNameListeners.clear();
+      mNameLookup.clear();
    }
 
    //////////////////////////////////////////////
@@ -51,73 +55,55 @@ namespace dtDirector
    //////////////////////////////////////////////
    void MessageGMComponent::ProcessMessage(const dtGame::Message& message)
    {
-      mIsProcessingMessages = true;
-      std::map<std::string, std::map<dtDirector::Node*, MsgFunc> >::iterator i =
-         mRegisteredCallbacks.find(message.GetMessageType().GetName());
+      const dtGame::MessageType& msgType = message.GetMessageType();
+
+      // The type table comes first, then the about actor tables, then the
+      // names and the listeners registered under a blank message name.
+      std::vector<DirectorCallbackMap*> callbacks;
 
-      if (i != mRegisteredCallbacks.end())
+      TypeListenerMap::iterator i = mTypeListeners.find(&msgType);
+      if (i != mTypeListeners.end())
       {
-         std::map<dtDirector::Node*, MsgFunc>& callbacks = i->second;
+         GatherCallbacks(i->second, message, callbacks);
+      }
 
-         for (std::map<dtDirector::Node*, MsgFunc>::iterator a = callbacks.begin();
-            a != callbacks.end(); ++a)
-         {
-            if( a->first->IsEnabled() && a->first->GetDirector()->GetActive() )
-            {
-               a->second(message);
-            }
-         }
+      MessageListeners* nameListeners = FindNameListeners(msgType);
+      if (nameListeners != NULL)
+      {
+         GatherCallbacks(*nameListeners, message, callbacks);
       }
 
-      // Also send this message to all registered messages registered
-      // under a blank message name.
-      i = mRegisteredCallbacks.find("");
-      if (i != mRegisteredCallbacks.end())
+      GatherCallbacks(mAllListeners, message, callbacks);
+
+      ++mProcessingDepth;
+      unsigned callbackCount = 0;
+
+      // A node is only in a table once, so only a message reaching several
+      // tables needs to remember which nodes were already called.
+      std::vector<dtDirector::Node*> called;
+      std::vector<dtDirector::Node*>* calledPtr = callbacks.size() > 1 ? &called : NULL;
+      for (size_t c = 0; c < callbacks.size(); ++c)
       {
-         std::map<dtDirector::Node*, MsgFunc>& callbacks = i->second;
+         callbackCount += Deliver(*callbacks[c], message, calledPtr);
+      }
 
-         for (std::map<dtDirector::Node*, MsgFunc>::iterator a = callbacks.begin();
-            a != callbacks.end(); ++a)
-         {
-            if( a->first->IsEnabled() && a->first->GetDirector()->GetActive() )
-            {
-               a->second(message);
-            }
-         }
+      --mProcessingDepth;
+
+      if (callbackCount > 0)
+      {
+         mCallbackCounts[&msgType] += callbackCount;
       }
-      mIsProcessingMessages = false;
 
       // Now clear all unregistered messages from the listing.
-      if (!mDeleteQueue.empty())
+      if (mProcessingDepth == 0 && !mDeleteQueue.empty())
       {
-         for (size_t q = 0; q < mDeleteQueue.size(); ++q)
-         {
-            const std::string& msgType = mDeleteQueue[q].msgType;
-
-            i = mRegisteredCallbacks.begin();
-            while (i != mRegisteredCallbacks.end())
-            {
-               std::map<dtDirector::Node*, MsgFunc>::iterator a = i->second.begin();
-
-               while(a != i->second.end())
-               {
-                  if (msgType == "" || msgType == i->first)
-                  {
-                     if (mDeleteQueue[q].node == a->first)
-                     {
-                        i->second.erase(a++);
-                        break;
-                     }
-                  }
-
-                  ++a;
-               }
+         std::vector<deleteQueue> queue;
+         queue.swap(mDeleteQueue);
 
-               ++i;
-            }
+         for (size_t q = 0; q < queue.size(); ++q)
+         {
+            RemoveCallbacks(queue[q].msgType, queue[q].node);
          }
-
-         mDeleteQueue.clear();
       }
    }
 
@@ -134,48 +120,35 @@ namespace dtDirector
    ////////////////////////////////////////////////////////////////////////////////
    void MessageGMComponent::RegisterMessage(const std::string& msgType, dtDirector::Node* node, MsgFunc callback)
    {
-      std::map<std::string, std::map<dtDirector::Node*, MsgFunc> >::iterator i =
-         mRegisteredCallbacks.find(msgType);
-
-      // Register the message type if it isn't.
-      if (i == mRegisteredCallbacks.end())
-      {
-         i = mRegisteredCallbacks.insert(
-            mRegisteredCallbacks.end(), std::make_pair(msgType, std::map<dtDirector::Node*, MsgFunc>()));
-      }
+      GetNameListeners(msgType).mAnyActor[node->GetDirector()].insert(std::make_pair(node, callback));
+      CancelQueuedRemoval(msgType, node);
+   }
 
-      // Register this callback for that message type.
-      if (i != mRegisteredCallbacks.end())
-      {
-         i->second.insert(i->second.end(), std::make_pair(node, callback));
+   ////////////////////////////////////////////////////////////////////////////////
+   void MessageGMComponent::RegisterMessage(const dtGame::MessageType& msgType, dtDirector::Node* node, MsgFunc callback)
+   {
+      mTypeListeners[&msgType].mAnyActor[node->GetDirector()].insert(std::make_pair(node, callback));
+      CancelQueuedRemoval(msgType.GetName(), node);
+   }
 
-         // If this message type is queued to be removed, make sure we
-         // no longer queue it because it is being registered again.
-         if (!mDeleteQueue.empty())
-         {
-            for (size_t q = 0; q < mDeleteQueue.size(); ++q)
-            {
-               if (msgType == mDeleteQueue[q].msgType &&
-                   node == mDeleteQueue[q].node)
-               {
-                  mDeleteQueue.erase(mDeleteQueue.begin() + q);
-                  break;
-               }
-            }
-         }
-      }
+   ////////////////////////////////////////////////////////////////////////////////
+   void MessageGMComponent::RegisterMessage(const std::string& msgType, const dtCore::UniqueId& aboutActorId, dtDirector::Node* node, MsgFunc callback)
+   {
+      GetNameListeners(msgType).mByActor[aboutActorId][node->GetDirector()].insert(std::make_pair(node, callback));
+      CancelQueuedRemoval(msgType, node);
    }
 
    ////////////////////////////////////////////////////////////////////////////////
-   void MessageGMComponent::RegisterMessage(const dtGame::MessageType& msgType, dtDirector::Node* node, MsgFunc callback)
+   void MessageGMComponent::RegisterMessage(const dtGame::MessageType& msgType, const dtCore::UniqueId& aboutActorId, dtDirector::Node* node, MsgFunc callback)
    {
-      RegisterMessage(msgType.GetName(), node, callback);
+      mTypeListeners[&msgType].mByActor[aboutActorId][node->GetDirector()].insert(std::make_pair(node, callback));
+      CancelQueuedRemoval(msgType.GetName(), node);
    }
 
    ////////////////////////////////////////////////////////////////////////////////
    void MessageGMComponent::UnRegisterMessage(const std::string& msgType, dtDirector::Node* node)
    {
-      if (mIsProcessingMessages)
+      if (mProcessingDepth > 0)
       {
          deleteQueue item;
          item.msgType = msgType;
@@ -184,41 +157,267 @@ namespace dtDirector
          return;
       }
 
-      std::map<std::string, std::map<dtDirector::Node*, MsgFunc> >::iterator i = mRegisteredCallbacks.begin();
-      while (i != mRegisteredCallbacks.end())
+      RemoveCallbacks(msgType, node);
+   }
+
+   ////////////////////////////////////////////////////////////////////////////////
+   void MessageGMComponent::UnRegisterMessage(const dtGame::MessageType& msgType, dtDirector::Node* node)
+   {
+      UnRegisterMessage(msgType.GetName(), node);
+   }
+
+   ////////////////////////////////////////////////////////////////////////////////
+   void MessageGMComponent::UnRegisterMessages(dtDirector::Node* node)
+   {
+      UnRegisterMessage("", node);
+   }
+
+   ////////////////////////////////////////////////////////////////////////////////
+   unsigned MessageGMComponent::GetCallbackCount(const dtGame::MessageType& msgType) const
+   {
+      std::map<const dtGame::MessageType*, unsigned>::const_iterator i = mCallbackCounts.find(&msgType);
+      if (i != mCallbackCounts.end())
+      {
+         return i->second;
+      }
+      return 0;
+   }
+
+   ////////////////////////////////////////////////////////////////////////////////
+   unsigned MessageGMComponent::GetTotalCallbackCount() const
+   {
+      unsigned total = 0;
+      std::map<const dtGame::MessageType*, unsigned>::const_iterator i = mCallbackCounts.begin();
+      for (; i != mCallbackCounts.end(); ++i)
+      {
+         total += i->second;
+      }
+      return total;
+   }
+
+   ////////////////////////////////////////////////////////////////////////////////
+   void MessageGMComponent::ResetCallbackCounts()
+   {
+      mCallbackCounts.clear();
+   }
+
+   ////////////////////////////////////////////////////////////////////////////////
+   MessageGMComponent::MessageListeners* MessageGMComponent::FindNameListeners(const dtGame::MessageType& msgType)
+   {
+      if (mNameListeners.empty())
+      {
+         return NULL;
+      }
+
+      std::map<const dtGame::MessageType*, MessageListeners*>::iterator cached = mNameLookup.find(&msgType);
+      if (cached != mNameLookup.end())
       {
-         std::map<dtDirector::Node*, MsgFunc>::iterator a = i->second.begin();
+         return cached->second;
+      }
 
-         while(a != i->second.end())
+      MessageListeners* result = NULL;
+      NameListenerMap::iterator found = mNameListeners.find(msgType.GetName());
+      if (found != mNameListeners.end())
+      {
+         result = &found->second;
+      }
+      mNameLookup.insert(std::make_pair(&msgType, result));
+      return result;
+   }
+
+   ////////////////////////////////////////////////////////////////////////////////
+   MessageGMComponent::MessageListeners& MessageGMComponent::GetNameListeners(const std::string& msgType)
+   {
+      if (msgType.empty())
+      {
+         return mAllListeners;
+      }
+
+      NameListenerMap::iterator found = mNameListeners.find(msgType);
+      if (found == mNameListeners.end())
+      {
+         found = mNameListeners.insert(std::make_pair(msgType, MessageListeners())).first;
+         mNameLookup.clear();
+      }
+      return found->second;
+   }
+
+   ////////////////////////////////////////////////////////////////////////////////
+   void MessageGMComponent::RemoveCallbacks(const std::string& msgType, dtDirector::Node* node)
+   {
+      if (msgType.empty())
+      {
+         RemoveCallbacks(mAllListeners, node);
+
+         for (NameListenerMap::iterator n = mNameListeners.begin(); n != mNameListeners.end(); ++n)
          {
-            if (msgType == "" || msgType == i->first)
-            {
-               if (node == a->first)
-               {
-                  i->second.erase(a++);
-                  break;
-               }
-            }
+            RemoveCallbacks(n->second, node);
+         }
+      }
+      else
+      {
+         NameListenerMap::iterator n = mNameListeners.find(msgType);
+         if (n != mNameListeners.end())
+         {
+            RemoveCallbacks(n->second, node);
+         }
+      }
+
+      // Types registered directly are unregistered by their name as well.
+      for (TypeListenerMap::iterator i = mTypeListeners.begin(); i != mTypeListeners.end(); ++i)
+      {
+         if (msgType.empty() || i->first->GetName() == msgType)
+         {
+            RemoveCallbacks(i->second, node);
+         }
+      }
+
+      RemoveEmptyListeners();
+   }
 
+   ////////////////////////////////////////////////////////////////////////////////
+   void MessageGMComponent::RemoveCallbacks(MessageListeners& listeners, dtDirector::Node* node)
+   {
+      RemoveCallbacks(listeners.mAnyActor, node);
+
+      std::map<dtCore::UniqueId, DirectorCallbackMap>::iterator a = listeners.mByActor.begin();
+      while (a != listeners.mByActor.end())
+      {
+         RemoveCallbacks(a->second, node);
+         if (a->second.empty())
+         {
+            listeners.mByActor.erase(a++);
+         }
+         else
+         {
             ++a;
          }
+      }
+   }
 
-         ++i;
+   ////////////////////////////////////////////////////////////////////////////////
+   void MessageGMComponent::RemoveCallbacks(DirectorCallbackMap& callbacks, dtDirector::Node* node)
+   {
+      DirectorCallbackMap::iterator d = callbacks.begin();
+      while (d != callbacks.end())
+      {
+         d->second.erase(node);
+         if (d->second.empty())
+         {
+            callbacks.erase(d++);
+         }
+         else
+         {
+            ++d;
+         }
       }
    }
 
    ////////////////////////////////////////////////////////////////////////////////
-   void MessageGMComponent::UnRegisterMessage(const dtGame::MessageType& msgType, dtDirector::Node* node)
+   void MessageGMComponent::RemoveEmptyListeners()
    {
-      UnRegisterMessage(msgType.GetName(), node);
+      // Drop message types nobody listens to anymore.
+      TypeListenerMap::iterator i = mTypeListeners.begin();
+      while (i != mTypeListeners.end())
+      {
+         if (i->second.IsEmpty())
+         {
+            mTypeListeners.erase(i++);
+         }
+         else
+         {
+            ++i;
+         }
+      }
+
+      NameListenerMap::iterator n = mNameListeners.begin();
+      while (n != mNameListeners.end())
+      {
+         if (n->second.IsEmpty())
+         {
+            mNameListeners.erase(n++);
+            // The lookup may point at the erased entry.
+            mNameLookup.clear();
+         }
+         else
+         {
+            ++n;
+         }
+      }
    }
 
    ////////////////////////////////////////////////////////////////////////////////
-   void MessageGMComponent::UnRegisterMessages(dtDirector::Node* node)
+   void MessageGMComponent::CancelQueuedRemoval(const std::string& msgType, dtDirector::Node* node)
    {
-      UnRegisterMessage("", node);
+      // If this message type is queued to be removed, make sure we
+      // no longer queue it because it is being registered again.
+      for (size_t q = 0; q < mDeleteQueue.size(); ++q)
+      {
+         if (msgType == mDeleteQueue[q].msgType &&
+             node == mDeleteQueue[q].node)
+         {
+            mDeleteQueue.erase(mDeleteQueue.begin() + q);
+            break;
+         }
+      }
+   }
+
+   ////////////////////////////////////////////////////////////////////////////////
+   void MessageGMComponent::GatherCallbacks(MessageListeners& listeners, const dtGame::Message& message,
+      std::vector<DirectorCallbackMap*>& callbacks)
+   {
+      if (!listeners.mAnyActor.empty())
+      {
+         callbacks.push_back(&listeners.mAnyActor);
+      }
+
+      if (!listeners.mByActor.empty())
+      {
+         std::map<dtCore::UniqueId, DirectorCallbackMap>::iterator found =
+            listeners.mByActor.find(message.GetAboutActorId());
+         if (found != listeners.mByActor.end())
+         {
+            callbacks.push_back(&found->second);
+         }
+      }
+   }
+
+   ////////////////////////////////////////////////////////////////////////////////
+   unsigned MessageGMComponent::Deliver(DirectorCallbackMap& callbacks, const dtGame::Message& message,
+      std::vector<dtDirector::Node*>* called)
+   {
+      unsigned count = 0;
+      for (DirectorCallbackMap::iterator d = callbacks.begin(); d != callbacks.end(); ++d)
+      {
+         // Every node in this batch belongs to the same director.
+         dtDirector::Director* director = d->first;
+         if (director == NULL || !director->GetActive())
+         {
+            continue;
+         }
+
+         for (NodeCallbackMap::iterator a = d->second.begin(); a != d->second.end(); ++a)
+         {
+            if (!a->first->IsEnabled())
+            {
+               continue;
+            }
+
+            if (called != NULL)
+            {
+               if (std::find(called->begin(), called->end(), a->first) != called->end())
+               {
+                  continue;
+               }
+               called->push_back(a->first);
+            }
+
+            a->second(message);
+            ++count;
+         }
+      }
+      return count;
    }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-
@@ -30,8 +30,11 @@
 #include <dtCore/actoridactorproperty.h>
 #include <dtCore/actorproperty.h>
 #include <dtCore/booleanactorproperty.h>
+#include <dtCore/doubleactorproperty.h>
+#include <dtCore/floatactorproperty.h>
 #include <dtCore/gameevent.h>
 #include <dtCore/gameeventactorproperty.h>
+#include <dtCore/intactorproperty.h>
 #include <dtCore/stringactorproperty.h>
 #include <dtCore/vectoractorproperties.h>
 #include <dtCore/resourceactorproperty.h>
@@ -52,11 +55,13 @@ namespace dtDirector
       , mIsReadOnly(false)
       , mDirector(NULL)
       , mGraph(NULL)
+      , mValueLinkGeneration(ValueLink::GetLinkGeneration() - 1)
    {
    }
 
    ///////////////////////////////////////////////////////////////////////////////////////
    Node::Node(const Node& rhs)
+      : mValueLinkGeneration(ValueLink::GetLinkGeneration() - 1)
    {
    }
 
@@ -455,35 +460,67 @@ namespace dtDirector
    }
 
    ////////////////////////////////////////////////////////////////////////////////
-   int Node::GetValueNodeCount(const std::string& name)
+   void Node::SyncValueLinkCache()
    {
+      const unsigned int generation = ValueLink::GetLinkGeneration();
+      if (generation == mValueLinkGeneration)
+      {
+         return;
+      }
+
+      mValueLinkGeneration = generation;
+      mValueLinkCache.clear();
+
+      // Keep the first link for each name, which is the one a linear search would find.
       for (int valueIndex = 0; valueIndex < (int)mValues.size(); valueIndex++)
       {
          dtCore::ActorProperty* prop = mValues[valueIndex].GetDefaultProperty();
-         if (prop && prop->GetName() == name)
+         if (prop)
          {
-            return (int)mValues[valueIndex].GetLinks().size();
+            mValueLinkCache.insert(std::make_pair(prop->GetName().Get(), valueIndex));
          }
       }
 
+      // Drop the held properties, since reconnected links may have released them.
+      for (int entry = 0; entry < PROPERTY_CAST_CACHE_SIZE; ++entry)
+      {
+         mPropertyCastCache[entry] = PropertyCastEntry();
+      }
+   }
+
+   ////////////////////////////////////////////////////////////////////////////////
+   ValueLink* Node::FindValueLinkForProperty(const std::string& name)
+   {
+      SyncValueLinkCache();
+
+      ValueLinkCache::const_iterator cached = mValueLinkCache.find(name);
+      if (cached != mValueLinkCache.end())
+      {
+         return &mValues[cached->second];
+      }
+
+      return NULL;
+   }
+
+   ////////////////////////////////////////////////////////////////////////////////
+   int Node::GetValueNodeCount(const std::string& name)
+   {
+      ValueLink* link = FindValueLinkForProperty(name);
+      if (link)
+      {
+         return (int)link->GetLinks().size();
+      }
+
       return 0;
    }
 
    ////////////////////////////////////////////////////////////////////////////////
    ValueNode* Node::GetValueNode(const std::string& name, int index)
    {
-      for (int valueIndex = 0; valueIndex < (int)mValues.size(); valueIndex++)
+      ValueLink* link = FindValueLinkForProperty(name);
+      if (link && index < (int)link->GetLinks().size())
       {
-         dtCore::ActorProperty* prop = mValues[valueIndex].GetDefaultProperty();
-         if (prop && prop->GetName() == name)
-         {
-            if (index < (int)mValues[valueIndex].GetLinks().size())
-            {
-               return mValues[valueIndex].GetLinks()[index];
-            }
-
-            return NULL;
-         }
+         return link->GetLinks()[index];
       }
 
       return NULL;
@@ -494,16 +531,11 @@ namespace dtDirector
    {
       int propertyCount = 0;
 
-      // First iterate through all value links to see if this property
-      // is redirected.
-      for (int valueIndex = 0; valueIndex < (int)mValues.size(); valueIndex++)
+      // First check the value links to see if this property is redirected.
+      ValueLink* link = FindValueLinkForProperty(name);
+      if (link)
       {
-         dtCore::ActorProperty* prop = mValues[valueIndex].GetDefaultProperty();
-         if (prop && prop->GetName() == name)
-         {
-            propertyCount = mValues[valueIndex].GetPropertyCount();
-            break;
-         }
+         propertyCount = link->GetPropertyCount();
       }
 
       // Did not find any overrides, so return the default.
@@ -518,15 +550,11 @@ namespace dtDirector
    //////////////////////////////////////////////////////////////////////////
    dtCore::ActorProperty* Node::GetProperty(const std::string& name, int index, ValueNode** outNode)
    {
-      // First iterate through all value links to see if this property
-      // is redirected.
-      for (int valueIndex = 0; valueIndex < (int)mValues.size(); valueIndex++)
+      // First check the value links to see if this property is redirected.
+      ValueLink* link = FindValueLinkForProperty(name);
+      if (link)
       {
-         dtCore::ActorProperty* prop = mValues[valueIndex].GetDefaultProperty();
-         if (prop && prop->GetName() == name)
-         {
-            return mValues[valueIndex].GetProperty(index, outNode);
-         }
+         return link->GetProperty(index, outNode);
       }
 
       // Did not find any overrides, so return the default.
@@ -573,10 +601,16 @@ namespace dtDirector
    }
 
    ////////////////////////////////////////////////////////////////////////////////
-   void Node::LogValueChanged(ValueNode* valueNode, dtCore::ActorProperty* prop, const std::string& oldVal)
+   bool Node::IsValueLoggingEnabled(ValueNode* valueNode) const
+   {
+      return GetDirector()->GetNodeLogging() && valueNode && valueNode->GetNodeLogging();
+   }
+
+   ////////////////////////////////////////////////////////////////////////////////
+   void Node::LogValueChanged(ValueNode* valueNode, dtCore::ActorProperty* prop, const std::string& oldVal, bool notify)
    {
       // Log the comment for this value.
-      if (GetDirector()->GetNodeLogging() && valueNode && valueNode->GetNodeLogging())
+      if (IsValueLoggingEnabled(valueNode))
       {
          std::string message = "Value Node \'" + valueNode->GetName();
          if (!valueNode->GetComment().empty())
@@ -587,7 +621,7 @@ namespace dtDirector
          dtUtil::Log::GetInstance().LogMessage(dtUtil::Log::LOG_ALWAYS, __FUNCTION__, __LINE__, message);
       }
 
-      if (valueNode)
+      if (valueNode && notify)
       {
          valueNode->OnValueChanged();
       }
@@ -604,97 +638,262 @@ namespace dtDirector
       return "";
    }
 
+   ////////////////////////////////////////////////////////////////////////////////
+   namespace
+   {
+      template <typename VecType>
+      std::string VecToString(const VecType& value)
+      {
+         std::ostringstream stream;
+         stream.precision(2 * sizeof(float) + 1);
+         stream << value;
+         return stream.str();
+      }
+
+      template <typename T>
+      std::string ValueToString(const T& value)
+      {
+         return dtUtil::ToString(value);
+      }
+
+      std::string StringToString(const std::string& value)
+      {
+         return value;
+      }
+
+      std::string UniqueIdToString(const dtCore::UniqueId& value)
+      {
+         return value.ToString();
+      }
+
+      template <typename T>
+      T ParseFallbackValue(dtCore::ActorProperty& prop)
+      {
+         return Node::ParsePropertyValue<T>(prop);
+      }
+
+      template <>
+      std::string ParseFallbackValue<std::string>(dtCore::ActorProperty& prop)
+      {
+         return prop.ToString();
+      }
+
+      template <>
+      osg::Vec2 ParseFallbackValue<osg::Vec2>(dtCore::ActorProperty& prop)
+      {
+         osg::Vec2 newValue;
+         dtUtil::ParseVec<osg::Vec2>(prop.ToString(), newValue, 2);
+         return newValue;
+      }
+
+      template <>
+      osg::Vec3 ParseFallbackValue<osg::Vec3>(dtCore::ActorProperty& prop)
+      {
+         osg::Vec3 newValue;
+         dtUtil::ParseVec<osg::Vec3>(prop.ToString(), newValue, 3);
+         return newValue;
+      }
+
+      template <>
+      osg::Vec4 ParseFallbackValue<osg::Vec4>(dtCore::ActorProperty& prop)
+      {
+         osg::Vec4 newValue;
+         dtUtil::ParseVec<osg::Vec4>(prop.ToString(), newValue, 4);
+         return newValue;
+      }
+
+      template <>
+      dtCore::UniqueId ParseFallbackValue<dtCore::UniqueId>(dtCore::ActorProperty& prop)
+      {
+         return dtCore::UniqueId(prop.ToString());
+      }
+
+      // A unique address per property type, used to tag cast results.
+      template <typename PropType>
+      const void* PropertyTypeTag()
+      {
+         static const char tag = 0;
+         return &tag;
+      }
+   }
+
+   ////////////////////////////////////////////////////////////////////////////////
+   template <typename PropType>
+   PropType* Node::CastProperty(dtCore::ActorProperty* prop)
+   {
+      const void* type = PropertyTypeTag<PropType>();
+      PropertyCastEntry& entry = mPropertyCastCache[(reinterpret_cast<size_t>(prop) / sizeof(void*)) % PROPERTY_CAST_CACHE_SIZE];
+      if (entry.mProperty.get() != prop || entry.mType != type)
+      {
+         entry.mProperty = prop;
+         entry.mType = type;
+         entry.mCast = dynamic_cast<PropType*>(prop);
+      }
+
+      return static_cast<PropType*>(entry.mCast);
+   }
+
+   ////////////////////////////////////////////////////////////////////////////////
+   template <typename PropType, typename T>
+   T Node::GetNativePropertyValue(const std::string& name, int index, const T& defaultValue)
+   {
+      ValueNode* node = NULL;
+      dtCore::ActorProperty* prop = GetProperty(name, index, &node);
+      if (prop == NULL)
+      {
+         return defaultValue;
+      }
+
+      T result;
+      PropType* typedProp = CastProperty<PropType>(prop);
+      if (typedProp != NULL)
+      {
+         result = typedProp->GetValue();
+      }
+      else
+      {
+         result = ParseFallbackValue<T>(*prop);
+      }
+
+      LogValueRetrieved(node, prop);
+      return result;
+   }
+
+   ////////////////////////////////////////////////////////////////////////////////
+   template <typename PropType, typename T>
+   void Node::SetNativePropertyValue(const T& value, const std::string& name, int index,
+      std::string (*toString)(const T&), bool logChanges)
+   {
+      int first = index;
+      int last = index + 1;
+      if (index == -1)
+      {
+         first = 0;
+         last = GetPropertyCount(name);
+      }
+      else
+      {
+         // Setting a single index has never logged or notified.
+         logChanges = false;
+      }
+
+      for (int propIndex = first; propIndex < last; ++propIndex)
+      {
+         ValueNode* node = NULL;
+         dtCore::ActorProperty* prop = GetProperty(name, propIndex, &node);
+         if (!prop)
+         {
+            continue;
+         }
+
+         // The value is never read here, since value node getters have side effects
+         // such as OnValueRetrieved or rolling a new random number.  Value node setters
+         // notify their links themselves on an actual change, which the change count shows.
+         const bool logValue = logChanges && IsValueLoggingEnabled(node);
+         std::string oldVal;
+         if (logValue)
+         {
+            oldVal = prop->GetValueString();
+         }
+         const unsigned int changeCount = node != NULL ? node->GetValueChangeCount() : 0;
+
+         PropType* typedProp = CastProperty<PropType>(prop);
+         if (typedProp != NULL)
+         {
+            typedProp->SetValue(value);
+         }
+         else
+         {
+            prop->FromString(toString(value));
+         }
+
+         if (logValue && node->GetValueChangeCount() != changeCount)
+         {
+            LogValueChanged(node, prop, oldVal, false);
+         }
+      }
+   }
+
    //////////////////////////////////////////////////////////////////////////
    bool Node::GetBoolean(const std::string& name, int index)
    {
-      return GetPropertyValue<bool>(name, index);
+      return GetNativePropertyValue<dtCore::BooleanActorProperty, bool>(name, index, false);
    }
 
    //////////////////////////////////////////////////////////////////////////
    int Node::GetInt(const std::string& name, int index)
    {
-      return GetPropertyValue<int>(name, index);
+      return GetNativePropertyValue<dtCore::IntActorProperty, int>(name, index, 0);
    }
 
    ////////////////////////////////////////////////////////////////////////////////
    unsigned int Node::GetUInt(const std::string& name, int index)
    {
+      // There is no unsigned property type, so this always converts.
       return GetPropertyValue<unsigned int>(name, index);
    }
 
    //////////////////////////////////////////////////////////////////////////
    float Node::GetFloat(const std::string& name, int index)
    {
-      return GetPropertyValue<float>(name, index);
+      return GetNativePropertyValue<dtCore::FloatActorProperty, float>(name, index, 0.0f);
    }
 
    //////////////////////////////////////////////////////////////////////////
    double Node::GetDouble(const std::string& name, int index)
    {
-      return GetPropertyValue<double>(name, index);
+      return GetNativePropertyValue<dtCore::DoubleActorProperty, double>(name, index, 0.0);
    }
 
    //////////////////////////////////////////////////////////////////////////
    std::string Node::GetString(const std::string& name, int index)
    {
       dtCore::ActorProperty* prop = GetProperty(name, index);
-      if (prop) return prop->ToString();
+      if (prop)
+      {
+         dtCore::StringActorProperty* stringProp = CastProperty<dtCore::StringActorProperty>(prop);
+         if (stringProp != NULL)
+         {
+            return stringProp->GetValue();
+         }
+
+         return prop->ToString();
+      }
       return "";
    }
 
    ////////////////////////////////////////////////////////////////////////////////
    osg::Vec2 Node::GetVec2(const std::string& name, int index)
    {
-      dtCore::ActorProperty* prop = GetProperty(name, index);
-      if (prop)
-      {
-         std::string str = prop->ToString();
-
-         osg::Vec2 newValue;
-         dtUtil::ParseVec<osg::Vec2>(str, newValue, 2);
-         return newValue;
-      }
-
-      return osg::Vec2();
+      return GetNativePropertyValue<dtCore::Vec2ActorProperty, osg::Vec2>(name, index, osg::Vec2());
    }
 
    ////////////////////////////////////////////////////////////////////////////////
    osg::Vec3 Node::GetVec3(const std::string& name, int index)
    {
-      dtCore::ActorProperty* prop = GetProperty(name, index);
-      if (prop)
-      {
-         std::string str = prop->ToString();
-
-         osg::Vec3 newValue;
-         dtUtil::ParseVec<osg::Vec3>(str, newValue, 3);
-         return newValue;
-      }
-
-      return osg::Vec3();
+      return GetNativePropertyValue<dtCore::Vec3ActorProperty, osg::Vec3>(name, index, osg::Vec3());
    }
 
    ////////////////////////////////////////////////////////////////////////////////
    osg::Vec4 Node::GetVec4(const std::string& name, int index)
    {
-      dtCore::ActorProperty* prop = GetProperty(name, index);
-      if (prop)
-      {
-         std::string str = prop->ToString();
-
-         osg::Vec4 newValue;
-         dtUtil::ParseVec<osg::Vec4>(str, newValue, 4);
-         return newValue;
-      }
-
-      return osg::Vec4();
+      return GetNativePropertyValue<dtCore::Vec4ActorProperty, osg::Vec4>(name, index, osg::Vec4());
    }
 
    //////////////////////////////////////////////////////////////////////////
    dtCore::UniqueId Node::GetActorID(const std::string& name, int index)
    {
       dtCore::ActorProperty* prop = GetProperty(name, index);
-      if (prop) return dtCore::UniqueId(prop->ToString());
+      if (prop)
+      {
+         dtCore::ActorIDActorProperty* actorIdProp = CastProperty<dtCore::ActorIDActorProperty>(prop);
+         if (actorIdProp != NULL)
+         {
+            return actorIdProp->GetValue();
+         }
+
+         return dtCore::UniqueId(prop->ToString());
+      }
 
       dtCore::UniqueId emptyID;
       emptyID = "";
@@ -795,13 +994,13 @@ namespace dtDirector
    //////////////////////////////////////////////////////////////////////////
    void Node::SetBoolean(bool value, const std::string& name, int index)
    {
-      SetPropertyValue<bool>(value, name, index);
+      SetNativePropertyValue<dtCore::BooleanActorProperty, bool>(value, name, index, &ValueToString<bool>, true);
    }
 
    //////////////////////////////////////////////////////////////////////////
    void Node::SetInt(int value, const std::string& name, int index)
    {
-      SetPropertyValue<int>(value, name, index);
+      SetNativePropertyValue<dtCore::IntActorProperty, int>(value, name, index, &ValueToString<int>, true);
    }
 
    ////////////////////////////////////////////////////////////////////////////////
@@ -813,143 +1012,43 @@ namespace dtDirector
    //////////////////////////////////////////////////////////////////////////
    void Node::SetFloat(float value, const std::string& name, int index)
    {
-      SetPropertyValue<float>(value, name, index);
+      SetNativePropertyValue<dtCore::FloatActorProperty, float>(value, name, index, &ValueToString<float>, true);
    }
 
    //////////////////////////////////////////////////////////////////////////
    void Node::SetDouble(double value, const std::string& name, int index)
    {
-      SetPropertyValue<double>(value, name, index);
+      SetNativePropertyValue<dtCore::DoubleActorProperty, double>(value, name, index, &ValueToString<double>, true);
    }
 
    //////////////////////////////////////////////////////////////////////////
    void Node::SetString(const std::string& value, const std::string& name, int index)
    {
-      if (index == -1)
-      {
-         int count = GetPropertyCount(name);
-         for (index = 0; index < count; index++)
-         {
-            dtCore::ActorProperty* prop = GetProperty(name, index);
-            if (prop)
-            {
-               prop->FromString(value);
-            }
-         }
-      }
-      else
-      {
-         dtCore::ActorProperty* prop = GetProperty(name, index);
-         if (prop)
-         {
-            prop->FromString(value);
-         }
-      }
+      SetNativePropertyValue<dtCore::StringActorProperty, std::string>(value, name, index, &StringToString, false);
    }
 
    ////////////////////////////////////////////////////////////////////////////////
    void Node::SetVec2(osg::Vec2 value, const std::string& name, int index)
    {
-      if (index == -1)
-      {
-         int count = GetPropertyCount(name);
-         for (index = 0; index < count; index++)
-         {
-            dtCore::ActorProperty* prop = GetProperty(name, index);
-            if (prop)
-            {
-               std::ostringstream stream;
-               stream.precision(2 * sizeof(float) + 1);
-               stream << value;
-
-               prop->FromString(stream.str());
-            }
-         }
-      }
-      else
-      {
-         dtCore::ActorProperty* prop = GetProperty(name, index);
-         if (prop)
-         {
-            std::ostringstream stream;
-            stream.precision(2 * sizeof(float) + 1);
-            stream << value;
-
-            prop->FromString(stream.str());
-         }
-      }
+      SetNativePropertyValue<dtCore::Vec2ActorProperty, osg::Vec2>(value, name, index, &VecToString<osg::Vec2>, false);
    }
 
    ////////////////////////////////////////////////////////////////////////////////
    void Node::SetVec3(osg::Vec3 value, const std::string& name, int index)
    {
-      if (index == -1)
-      {
-         int count = GetPropertyCount(name);
-         for (index = 0; index < count; index++)
-         {
-            dtCore::ActorProperty* prop = GetProperty(name, index);
-            if (prop)
-            {
-               std::ostringstream stream;
-               stream.precision(2 * sizeof(float) + 1);
-               stream << value;
-
-               prop->FromString(stream.str());
-            }
-         }
-      }
-      else
-      {
-         dtCore::ActorProperty* prop = GetProperty(name, index);
-         if (prop)
-         {
-            std::ostringstream stream;
-            stream.precision(2 * sizeof(float) + 1);
-            stream << value;
-
-            prop->FromString(stream.str());
-         }
-      }
+      SetNativePropertyValue<dtCore::Vec3ActorProperty, osg::Vec3>(value, name, index, &VecToString<osg::Vec3>, false);
    }
 
    ////////////////////////////////////////////////////////////////////////////////
    void Node::SetVec4(osg::Vec4 value, const std::string& name, int index)
    {
-      if (index == -1)
-      {
-         int count = GetPropertyCount(name);
-         for (index = 0; index < count; index++)
-         {
-            dtCore::ActorProperty* prop = GetProperty(name, index);
-            if (prop)
-            {
-               std::ostringstream stream;
-               stream.precision(2 * sizeof(float) + 1);
-               stream << value;
-
-               prop->FromString(stream.str());
-            }
-         }
-      }
-      else
-      {
-         dtCore::ActorProperty* prop = GetProperty(name, index);
-         if (prop)
-         {
-            std::ostringstream stream;
-            stream.precision(2 * sizeof(float) + 1);
-            stream << value;
-
-            prop->FromString(stream.str());
-         }
-      }
+      SetNativePropertyValue<dtCore::Vec4ActorProperty, osg::Vec4>(value, name, index, &VecToString<osg::Vec4>, false);
    }
 
    //////////////////////////////////////////////////////////////////////////
    void Node::SetActorID(const dtCore::UniqueId& value, const std::string& name, int index)
    {
-      SetString(value.ToString(), name, index);
+      SetNativePropertyValue<dtCore::ActorIDActorProperty, dtCore::UniqueId>(value, name, index, &UniqueIdToString, false);
    }
 
    ////////////////////////////////////////////////////////////////////////////////
@@ -32,6 +32,17 @@
 
 namespace dtDirector
 {
+   namespace
+   {
+      unsigned int gLinkGeneration = 0;
+   }
+
+   ///////////////////////////////////////////////////////////////////////////////////////
+   unsigned int ValueLink::GetLinkGeneration()
+   {
+      return gLinkGeneration;
+   }
+
    ///////////////////////////////////////////////////////////////////////////////////////
    ValueLink::ValueLink(Node* owner, dtCore::ActorProperty* prop, bool isOut, bool allowMultiple, bool typeCheck, bool exposed)
       : mOwner(owner)
@@ -50,6 +61,8 @@ namespace dtDirector
       {
          SetComment(prop->GetDescription());
       }
+
+      ++gLinkGeneration;
    }
 
    ///////////////////////////////////////////////////////////////////////////////////////
@@ -57,6 +70,8 @@ namespace dtDirector
    {
       // Disconnect all values from this link.
       Disconnect();
+
+      ++gLinkGeneration;
    }
 
    ////////////////////////////////////////////////////////////////////////////////
@@ -90,6 +105,8 @@ namespace dtDirector
 
       mAllowMultiple = src.mAllowMultiple;
       mTypeCheck = src.mTypeCheck;
+
+      ++gLinkGeneration;
    }
 
    ////////////////////////////////////////////////////////////////////////////////
@@ -119,6 +136,7 @@ namespace dtDirector
          Connect(src.mLinks[index]);
       }
 
+      ++gLinkGeneration;
       return *this;
    }
 
@@ -136,6 +154,8 @@ namespace dtDirector
       {
          mRedirector->SetProxyOwner(GetOwner());
       }
+
+      ++gLinkGeneration;
    }
 
    //////////////////////////////////////////////////////////////////////////
@@ -262,6 +282,7 @@ namespace dtDirector
       }
 
       mDefaultProperty = prop;
+      ++gLinkGeneration;
    }
 
    //////////////////////////////////////////////////////////////////////////
@@ -321,6 +342,7 @@ namespace dtDirector
       }
 
       mName = name;
+      ++gLinkGeneration;
    }
 
    //////////////////////////////////////////////////////////////////////////
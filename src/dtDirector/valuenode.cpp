@@ -38,6 +38,7 @@ namespace dtDirector
        , mInitialProperty(NULL)
        , mHasInitialValue(false)
        , mIsGlobal(false)
+       , mValueChangeCount(0)
    {
    }
 
@@ -302,6 +303,8 @@ namespace dtDirector
    //////////////////////////////////////////////////////////////////////////
    void ValueNode::OnValueChanged()
    {
+      ++mValueChangeCount;
+
       std::vector<ValueLink*> links = mLinks;
       int count = (int)links.size();
       for (int index = 0; index < count; index++)
@@ -26,6 +26,7 @@
 #include <dtGame/actorcomponentbase.h>
 #include <dtUtil/exception.h>
 
+#include <algorithm>
 #include <cassert>
 #include <sstream>
 
@@ -36,6 +37,7 @@ namespace dtGame
    ActorComponentBase::ActorComponentBase()
       : dtCore::ActorComponentContainer()
       , dtGame::ActorComponentContainer()
+      , mComponentSlotsGeneration(dtCore::ObjectType::GetTypeIdGeneration())
    {
    }
 
@@ -64,6 +66,14 @@ namespace dtGame
             return;
       }
       mComponents.push_back(std::pair<ActorComponent::ACType, dtCore::RefPtr<ActorComponent> >(component.GetType(), &component));
+      if (AreComponentSlotsCurrent())
+      {
+         AddToComponentSlots(*component.GetType(), component);
+      }
+      else
+      {
+         RebuildComponentSlots();
+      }
 
       OnActorComponentAdded(component);
    }
@@ -96,6 +106,16 @@ namespace dtGame
    //////////////////////////////////////////////////////////////////////////
    void ActorComponentBase::GetComponents(ActorComponent::ACType type, ActorComponentVector& outComponents) const
    {
+      if (AreComponentSlotsCurrent())
+      {
+         const ActorComponentVector* slot = FindComponentSlot(*type);
+         if (slot != NULL)
+         {
+            outComponents.insert(outComponents.end(), slot->begin(), slot->end());
+         }
+         return;
+      }
+
       ActorComponentMap::const_iterator iter = mComponents.begin();
       while (iter != mComponents.end())
       {
@@ -157,16 +177,92 @@ namespace dtGame
    //////////////////////////////////////////////////////////////////////////
    bool ActorComponentBase::HasComponent(ActorComponent::ACType type) const
    {
+      return FindComponent(type) != NULL;
+   }
+
+   //////////////////////////////////////////////////////////////////////////
+   ActorComponent* ActorComponentBase::FindComponent(ActorComponent::ACType type) const
+   {
+      if (AreComponentSlotsCurrent())
+      {
+         const ActorComponentVector* slot = FindComponentSlot(*type);
+         return slot != NULL ? slot->front() : NULL;
+      }
+
       ActorComponentMap::const_iterator iter = mComponents.begin();
       while (iter != mComponents.end())
       {
          if (iter->first->InstanceOf(*type))
          {
-            return true;
+            return iter->second.get();
          }
          ++iter;
       }
-      return false;
+      return NULL;
+   }
+
+   //////////////////////////////////////////////////////////////////////////
+   bool ActorComponentBase::AreComponentSlotsCurrent() const
+   {
+      return mComponentSlotsGeneration == dtCore::ObjectType::GetTypeIdGeneration();
+   }
+
+   //////////////////////////////////////////////////////////////////////////
+   const ActorComponentVector* ActorComponentBase::FindComponentSlot(const dtCore::ObjectType& type) const
+   {
+      ComponentSlotTable::const_iterator slot = mComponentSlots.find(type.GetTypeId());
+      if (slot != mComponentSlots.end())
+      {
+         return &slot->second;
+      }
+      return NULL;
+   }
+
+   //////////////////////////////////////////////////////////////////////////
+   void ActorComponentBase::AddToComponentSlots(const dtCore::ObjectType& type, ActorComponent& component)
+   {
+      // List it under every parent type too, so looking up a base type finds it.
+      for (const dtCore::ObjectType* t = &type; t != NULL; t = t->GetParentType())
+      {
+         ActorComponentVector& components = mComponentSlots[t->GetTypeId()];
+         // A parent with the same id as its child would list it twice.
+         if (components.empty() || components.back() != &component)
+         {
+            components.push_back(&component);
+         }
+      }
+   }
+
+   //////////////////////////////////////////////////////////////////////////
+   void ActorComponentBase::RebuildComponentSlots()
+   {
+      mComponentSlots.clear();
+      mComponentSlotsGeneration = dtCore::ObjectType::GetTypeIdGeneration();
+      for (ActorComponentMap::const_iterator i = mComponents.begin(); i != mComponents.end(); ++i)
+      {
+         AddToComponentSlots(*i->first, *i->second);
+      }
+   }
+
+   //////////////////////////////////////////////////////////////////////////
+   void ActorComponentBase::RemoveFromComponentSlots(const dtCore::ObjectType& type, ActorComponent& component)
+   {
+      for (const dtCore::ObjectType* t = &type; t != NULL; t = t->GetParentType())
+      {
+         ComponentSlotTable::iterator slot = mComponentSlots.find(t->GetTypeId());
+         if (slot == mComponentSlots.end())
+         {
+            continue;
+         }
+
+         ActorComponentVector& components = slot->second;
+         components.erase(std::remove(components.begin(), components.end(), &component), components.end());
+
+         if (components.empty())
+         {
+            mComponentSlots.erase(slot);
+         }
+      }
    }
 
    //////////////////////////////////////////////////////////////////////////
@@ -180,10 +276,21 @@ namespace dtGame
       {
          if (iter->second == &component)
          {
+            const bool slotsCurrent = AreComponentSlotsCurrent();
+            if (slotsCurrent)
+            {
+               RemoveFromComponentSlots(*iter->first, *iter->second);
+            }
+
             // Clear the component's owner pointer
             iter->second->SetOwner(NULL);
             mComponents.erase(iter);
             removedComponent = true;
+
+            if (!slotsCurrent)
+            {
+               RebuildComponentSlots();
+            }
             break;
          }
          ++iter;
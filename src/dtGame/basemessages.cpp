@@ -117,6 +117,11 @@ namespace dtGame
       std::for_each(nameVec.begin(), nameVec.end(), parameterFunc);
    }
 
+   //////////////////////////////////////////////////////////////////////////////
+   DT_IMPLEMENT_MESSAGE_BEGIN(MapChangeProgressMessage)
+      DT_ADD_PARAMETER(float, PercentComplete)
+   DT_IMPLEMENT_MESSAGE_END()
+
    //////////////////////////////////////////////////////////////////////////////
    //////////////////////////////////////////////////////////////////////////////
 
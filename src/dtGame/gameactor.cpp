@@ -181,6 +181,12 @@ namespace dtGame
       return GetGameActorProxy().HasComponent(type);
    }
 
+   ////////////////////////////////////////////////////////////////////////////////
+   ActorComponent* GameActor::FindComponent(ActorComponent::ACType type) const
+   {
+      return GetGameActorProxy().FindComponent(type);
+   }
+
 
    ////////////////////////////////////////////////////////////////////////////////
    void GameActor::AddComponent(ActorComponent& component)
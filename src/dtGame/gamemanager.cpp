@@ -54,6 +54,7 @@
 
 #include <dtUtil/stringutils.h>
 #include <dtUtil/log.h>
+#include <dtUtil/profiler.h>
 
 #include <list>
 
@@ -89,6 +90,9 @@ namespace dtGame
    {
       dtCore::System::GetInstance().TickSignal.connect_slot(this, &GameManager::OnSystem);
 
+      // The GM ticks on the thread that creates it.
+      DT_PROFILE_THREAD_NAME("Main");
+
       mGMImpl->mMapChangeStateData = new MapChangeStateData(*this);
 
       // when we come alive, the first message everyone gets will be INFO_RESTARTED
@@ -419,6 +423,9 @@ namespace dtGame
    ///////////////////////////////////////////////////////////////////////////////
    void GameManager::PreFrame(double deltaSimTime, double deltaRealTime)
    {
+      DT_PROFILE_FRAME();
+      DT_PROFILE_ZONE("GameManager::PreFrame");
+
       try
       {
          // information used to track statistics over a fragment of time (ex 30 seconds)
@@ -429,13 +436,15 @@ namespace dtGame
 
          if (mGMImpl->mMapChangeStateData.valid())
          {
+            DT_PROFILE_ZONE("GameManager Map Change");
             const MapChangeStateData::MapChangeState* pPrevState = &mGMImpl->mMapChangeStateData->GetCurrentState();
             mGMImpl->mMapChangeStateData->ContinueMapChange();
 
             // Update mLoadedMaps only when a Map Change takes place.
             // This check is needed to keep the name vec consistent, as single maps may be loaded/unloaded
             // without changing the whole set.
-            if ((*pPrevState == MapChangeStateData::MapChangeState::LOAD || *pPrevState == MapChangeStateData::MapChangeState::UNLOAD) &&
+            if ((*pPrevState == MapChangeStateData::MapChangeState::LOAD || *pPrevState == MapChangeStateData::MapChangeState::OPEN
+               || *pPrevState == MapChangeStateData::MapChangeState::UNLOAD) &&
                mGMImpl->mMapChangeStateData->GetCurrentState() == MapChangeStateData::MapChangeState::IDLE)
             {
                mGMImpl->mLoadedMaps = mGMImpl->mMapChangeStateData->GetNewMapNames();
@@ -449,8 +458,11 @@ namespace dtGame
          GetMessageFactory().CreateMessage(MessageType::TICK_LOCAL, tick);
          PopulateTickMessage(*tick, deltaSimTime, deltaRealTime, simulationTime);
          SendMessage(*tick);
-         mGMImpl->ProcessTimers(*this, mGMImpl->mRealTimeTimers, GetRealClockTime());
-         mGMImpl->ProcessTimers(*this, mGMImpl->mSimulationTimers, dtCore::Timer_t(GetSimTimeSinceStartup() * 1000000.0));
+         {
+            DT_PROFILE_ZONE("GameManager Timers");
+            mGMImpl->ProcessTimers(*this, mGMImpl->mRealTimeTimers, GetRealClockTime());
+            mGMImpl->ProcessTimers(*this, mGMImpl->mSimulationTimers, dtCore::Timer_t(GetSimTimeSinceStartup() * 1000000.0));
+         }
          DoSendMessages();
 
          // The tick remote comes after ALL responses to Tick Local
@@ -473,6 +485,8 @@ namespace dtGame
 
          DoSendMessageToComponents(*tickEnd, false);
 
+         DT_PROFILE_COUNTER("GameManager Actors", mGMImpl->mGameActorProxyMap.size());
+
          // End the stats for this frame.
          mGMImpl->mGMStatistics.FragmentTimeDump(frameTickStart, *this, mGMImpl->mLogger);
       }
@@ -520,6 +534,7 @@ namespace dtGame
          {
             id = itor->first;
             UnregisterAllMessageListenersForActor(gameActorProxy);
+            mGMImpl->mActorIndex.Remove(gameActorProxy);
             mGMImpl->mGameActorProxyMap.erase(itor);
             mGMImpl->ReparentDanglingDrawables(*this, gameActorProxy.GetDrawable());
             gameActorProxy.SetParentActor(NULL);
@@ -544,6 +559,8 @@ namespace dtGame
    ///////////////////////////////////////////////////////////////////////////////
    void GameManager::DoSendNetworkMessages()
    {
+      DT_PROFILE_ZONE("GameManager::DoSendNetworkMessages");
+
       // SEND MESSAGES - Forward Send Messages to all components (no actors)
       while (!mGMImpl->mSendNetworkMessageQueue.empty())
       {
@@ -603,6 +620,7 @@ namespace dtGame
 
          try
          {
+            DT_PROFILE_ZONE_DYNAMIC(component->GetName());
             if (toNetwork)
             {
                component->DispatchNetworkMessage(message);
@@ -939,6 +957,8 @@ namespace dtGame
    ///////////////////////////////////////////////////////////////////////////////
    void GameManager::PostFrame(double deltaSimTime, double deltaRealTime)
    {
+      DT_PROFILE_ZONE("GameManager::PostFrame");
+
       double simulationTime = dtCore::System::GetInstance().GetSimulationTime();
 
       dtCore::RefPtr<SystemMessage> postFrame;
@@ -1221,7 +1241,10 @@ namespace dtGame
       {
          mGMImpl->AddActorToScene(actor);
 
-         mGMImpl->mBaseActorObjectMap.insert(std::make_pair(actor.GetId(), &actor));
+         if (mGMImpl->mBaseActorObjectMap.insert(std::make_pair(actor.GetId(), &actor)).second)
+         {
+            mGMImpl->mActorIndex.Add(actor);
+         }
       }
    }
 
@@ -1306,7 +1329,10 @@ namespace dtGame
 
          bool envChanged = mGMImpl->AddActorToScene(actor);
 
-         mGMImpl->mGameActorProxyMap.insert(std::make_pair(actor.GetId(), &actor));
+         if (mGMImpl->mGameActorProxyMap.insert(std::make_pair(actor.GetId(), &actor)).second)
+         {
+            mGMImpl->mActorIndex.Add(actor);
+         }
          if (envChanged) mGMImpl->SendEnvironmentChangedMessage(*this, mGMImpl->mEnvironment.get());
 
 
@@ -1563,6 +1589,7 @@ namespace dtGame
                //mGMImpl->RemoveActorFromScene(*this, *itor->second);
                dd->Emancipate();
                mGMImpl->ReparentDanglingDrawables(*this, dd);
+               mGMImpl->mActorIndex.Remove(*itor->second);
                mGMImpl->mBaseActorObjectMap.erase(itor);
             }
          }
@@ -1816,10 +1843,9 @@ namespace dtGame
    ///////////////////////////////////////////////////////////////////////////////
    void GameManager::FindActorsByName(const std::string& name, dtCore::ActorPtrVector& toFill)
    {
-      toFill.reserve(mGMImpl->mGameActorProxyMap.size() + mGMImpl->mBaseActorObjectMap.size());
-
-      GMWildMatchSearchFunc searchFunc(name);
-      FindActorsIf(searchFunc, toFill);
+      toFill.clear();
+      mGMImpl->mActorIndex.FindByName(name, toFill);
+      mGMImpl->AddBatchActorsToWorld(*this, toFill);
    }
 
    ///////////////////////////////////////////////////////////////////////////////
@@ -1842,42 +1868,20 @@ namespace dtGame
    ///////////////////////////////////////////////////////////////////////////////
    void GameManager::FindActorsByType(const dtCore::ActorType& type, dtCore::ActorPtrVector& toFill)
    {
-      toFill.reserve(mGMImpl->mGameActorProxyMap.size() + mGMImpl->mBaseActorObjectMap.size());
-
-      GMTypeMatchSearchFunc searchFunc(type);
-      FindActorsIf(searchFunc, toFill);
+      toFill.clear();
+      mGMImpl->mActorIndex.FindByType(type, toFill);
+      mGMImpl->AddBatchActorsToWorld(*this, toFill);
    }
 
-   ///////////////////////////////////////////////////////////////////////////////
-   class GMClassMatchSearchFunc
-   {
-   public:
-      GMClassMatchSearchFunc(const std::string& type)
-         : mType(type)
-      {
-      }
-
-      bool operator()(dtCore::BaseActorObject& actor)
-      {
-         return actor.IsInstanceOf(mType);
-      }
-
-      const std::string& mType;
-   };
-
    ///////////////////////////////////////////////////////////////////////////////
    void GameManager::FindActorsByClassName(const std::string& className,
       dtCore::ActorPtrVector& toFill)
    {
+      toFill.clear();
       if (!className.empty())
       {
-         toFill.reserve(mGMImpl->mBaseActorObjectMap.size() + mGMImpl->mGameActorProxyMap.size());
-         GMClassMatchSearchFunc searchFunc(className);
-         FindActorsIf(searchFunc, toFill);
-      }
-      else
-      {
-         toFill.clear();
+         mGMImpl->mActorIndex.FindByClassName(className, toFill);
+         mGMImpl->AddBatchActorsToWorld(*this, toFill);
       }
    }
 
@@ -1960,6 +1964,42 @@ namespace dtGame
       mGMImpl->mMapChangeStateData->BeginMapChange(mGMImpl->mLoadedMaps, emptyVec, false);
    }
 
+   ///////////////////////////////////////////////////////////////////////////////
+   bool GameManager::CancelMapChange()
+   {
+      return mGMImpl->mMapChangeStateData->CancelMapChange();
+   }
+
+   ///////////////////////////////////////////////////////////////////////////////
+   bool GameManager::IsMapChangeInProgress() const
+   {
+      return mGMImpl->mMapChangeStateData->GetCurrentState() != MapChangeStateData::MapChangeState::IDLE;
+   }
+
+   ///////////////////////////////////////////////////////////////////////////////
+   void GameManager::SetMapChangeInBackground(bool background)
+   {
+      mGMImpl->mMapChangeStateData->SetLoadInBackground(background);
+   }
+
+   ///////////////////////////////////////////////////////////////////////////////
+   bool GameManager::GetMapChangeInBackground() const
+   {
+      return mGMImpl->mMapChangeStateData->GetLoadInBackground();
+   }
+
+   ///////////////////////////////////////////////////////////////////////////////
+   void GameManager::SetMapChangeActorTimeBudget(double milliseconds)
+   {
+      mGMImpl->mMapChangeStateData->SetActorAddTimeBudget(milliseconds);
+   }
+
+   ///////////////////////////////////////////////////////////////////////////////
+   double GameManager::GetMapChangeActorTimeBudget() const
+   {
+      return mGMImpl->mMapChangeStateData->GetActorAddTimeBudget();
+   }
+
    ///////////////////////////////////////////////////////////////////////////////
    void GameManager::ChangeMap(const std::string& mapName, bool addBillboards)
    {
@@ -254,6 +254,38 @@ void GMImpl::AddActorToWorld(GameManager& gm, dtGame::GameActorProxy& actor)
    }
 
 }
+////////////////////////////////////////////////////////////////////////////////
+void GMImpl::AddBatchActorsToWorld(GameManager& gm, dtCore::ActorPtrVector& actors)
+{
+   if (!mBatchData.valid())
+   {
+      return;
+   }
+
+   dtCore::ActorPtrVector::iterator i = actors.begin();
+   while (i != actors.end())
+   {
+      dtCore::BaseActorObject* actor = *i;
+      if (actor->IsGameActor() && !static_cast<GameActorProxy*>(actor)->IsInGM() && !static_cast<GameActorProxy*>(actor)->IsDeleted())
+      {
+         try
+         {
+            AddActorToWorld(gm, *static_cast<GameActorProxy*>(actor));
+         }
+         catch (const dtUtil::Exception& ex)
+         {
+            // Actors can just decide to not be added by throwing an exception.  If it's an error, the actor
+            // should log it as such, but here it's only a warning.
+            ex.LogException(dtUtil::Log::LOG_WARNING, *mLogger);
+            i = actors.erase(i);
+            continue;
+         }
+      }
+      ++i;
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
 void GMImpl::AddActorToScene(dtCore::BaseActorObject& actor)
 {
    bool hasDrawable = actor.GetDrawable() != NULL;
@@ -21,9 +21,12 @@
 #include <prefix/dtgameprefix.h>
 #include <dtUtil/log.h>
 #include <dtUtil/exception.h>
+#include <dtUtil/profiler.h>
+#include <dtUtil/threadpool.h>
 
 #include <dtCore/project.h>
 #include <dtCore/map.h>
+#include <dtCore/mapbinary.h>
 #include <dtCore/actortype.h>
 
 #include <dtGame/exceptionenum.h>
@@ -37,14 +40,107 @@
 #include <dtGame/gmcomponent.h>
 
 #include <dtCore/system.h>
+
+#include <OpenThreads/Mutex>
+#include <OpenThreads/ScopedLock>
+#include <osg/Timer>
+
 namespace dtGame
 {
+   /**
+    * Reads the files of the new maps into memory on the IO thread, and decodes the binary ones into property
+    * records.  Creating the actors isn't safe off the main thread, so the task touches nothing but its own preloads.
+    */
+   class MapReadTask : public dtUtil::ThreadPoolTask
+   {
+   public:
+      explicit MapReadTask(const std::vector<dtCore::Project::PreloadedMapFile>& preloads)
+      : mPreloads(preloads)
+      , mNumFinished(0U)
+      , mCancelled(false)
+      {
+         SetName("Map Read");
+      }
+
+      virtual void operator()()
+      {
+         for (size_t i = 0; i < mPreloads.size(); ++i)
+         {
+            if (IsCancelled())
+            {
+               break;
+            }
+
+            // If it fails, the map is read on the main thread when it is opened, or the error is reported then.
+            dtCore::Project::ReadPreloadedMap(mPreloads[i]);
+
+            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+            ++mNumFinished;
+         }
+      }
+
+      /// Stops before the next file.
+      void Cancel()
+      {
+         OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+         mCancelled = true;
+      }
+
+      bool IsCancelled() const
+      {
+         OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+         return mCancelled;
+      }
+
+      /// @return the number of files the task is done with.  Those preloads won't change again.
+      unsigned GetNumFinished() const
+      {
+         OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+         return mNumFinished;
+      }
+
+      /// Only valid for an index below GetNumFinished, since the task is done with those.
+      dtCore::Project::PreloadedMapFile& GetPreload(size_t index)
+      {
+         return mPreloads[index];
+      }
+
+   private:
+      std::vector<dtCore::Project::PreloadedMapFile> mPreloads;
+
+      mutable OpenThreads::Mutex mMutex;
+      unsigned mNumFinished;
+      bool mCancelled;
+   };
+
+   namespace
+   {
+      ///////////////////////////////////////////////////////////////////////////////
+      void AddActorToGM(GameManager& gm, dtCore::BaseActorObject& actor)
+      {
+         try
+         {
+            gm.AddActor(actor);
+         }
+         catch (const dtUtil::Exception& ex)
+         {
+            dtUtil::Log::GetInstance("mapchangestatedata.cpp").LogMessage(dtUtil::Log::LOG_ERROR, __FUNCTION__, __LINE__,
+                  "A problem occurred adding Actor with name \"%s\" of type \"%s\" to the GameManager.",
+                  actor.GetName().c_str(), actor.GetActorType().GetFullName().c_str());
+            ex.LogException(dtUtil::Log::LOG_ERROR, dtUtil::Log::GetInstance("mapchangestatedata.cpp"));
+         }
+      }
+   }
+
    IMPLEMENT_ENUM(MapChangeStateData::MapChangeState);
 
 
    ///////////////////////////////////////////////////////////////////////////////
    const MapChangeStateData::MapChangeState MapChangeStateData::MapChangeState::UNLOAD("UNLOAD");
 
+   ///////////////////////////////////////////////////////////////////////////////
+   const MapChangeStateData::MapChangeState MapChangeStateData::MapChangeState::OPEN("OPEN");
+
    ///////////////////////////////////////////////////////////////////////////////
    const MapChangeStateData::MapChangeState MapChangeStateData::MapChangeState::LOAD("LOAD");
 
@@ -54,10 +150,17 @@ namespace dtGame
    ///////////////////////////////////////////////////////////////////////////////
    MapChangeStateData::MapChangeStateData(GameManager& gm):
       osg::Referenced(), mGameManager(&gm), mCurrentState(&MapChangeStateData::MapChangeState::IDLE),
-      mAddBillboards(false)
+      mAddBillboards(false), mLoadInBackground(false), mActorAddTimeBudget(0.0), mCancelRequested(false),
+      mProgress(0.0f), mProgressSent(false), mNextMapToOpen(0U), mNextActor(0U), mActorsPrepared(false)
    {
    }
 
+   ///////////////////////////////////////////////////////////////////////////////
+   MapChangeStateData::~MapChangeStateData()
+   {
+      ReleaseReadTask();
+   }
+
    ///////////////////////////////////////////////////////////////////////////////
    void MapChangeStateData::BeginMapChange(const MapChangeStateData::NameVector& oldMapNames, const MapChangeStateData::NameVector& newMapNames, bool addBillboards)
    {
@@ -75,6 +178,13 @@ namespace dtGame
       mNewMapNames = newMapNames;
       mAddBillboards = addBillboards;
 
+      mCancelRequested = false;
+      mProgress = 0.0f;
+      mProgressSent = false;
+      mPendingActors.clear();
+      mNextActor = 0U;
+      mActorsPrepared = false;
+
       mCurrentState = &MapChangeState::UNLOAD;
 
       // We are only changing maps if the new map list is not empty
@@ -110,6 +220,7 @@ namespace dtGame
    ///////////////////////////////////////////////////////////////////////////////
    void MapChangeStateData::CloseOldMaps()
    {
+      DT_PROFILE_ZONE("MapChangeStateData::CloseOldMaps");
       if (!mOldMapNames.empty())
       {
          MapChangeStateData::NameVector::const_iterator i = mOldMapNames.begin();
@@ -163,6 +274,7 @@ namespace dtGame
    ///////////////////////////////////////////////////////////////////////////////
    bool MapChangeStateData::OpenNewMaps()
    {
+      DT_PROFILE_ZONE("MapChangeStateData::OpenNewMaps");
       bool success = true;
       if (!mNewMapNames.empty())
       {
@@ -204,9 +316,8 @@ namespace dtGame
    }
 
    ///////////////////////////////////////////////////////////////////////////////
-   void MapChangeStateData::LoadSingleMapIntoGM(const std::string& mapName)
+   void MapChangeStateData::PrepareMapForGM(dtCore::Map& map, dtCore::ActorRefPtrVector& actorsToAdd)
    {
-      dtCore::Map& map = dtCore::Project::GetInstance().GetMap(mapName);
       // add all the events in the map to the game manager.
       std::vector<dtCore::GameEvent* > events;
       map.GetEventManager().GetAllEvents(events);
@@ -223,8 +334,6 @@ namespace dtGame
          }
       }
 
-      ScopedGMBatchAdd batch(*mGameManager);
-
       if (map.GetEnvironmentActor() != NULL)
       {
          dtGame::IEnvGameActorProxy* eap =
@@ -236,6 +345,7 @@ namespace dtGame
       dtCore::ActorRefPtrVector proxies;
       map.GetAllProxies(proxies);
 
+      actorsToAdd.reserve(actorsToAdd.size() + proxies.size());
       for (unsigned int i = 0; i < proxies.size(); ++i)
       {
          dtCore::BaseActorObject& curAddActor = *proxies[i];
@@ -249,21 +359,216 @@ namespace dtGame
          {
             continue;
          }
-         else
+
+         actorsToAdd.push_back(proxies[i]);
+      }
+   }
+
+   ///////////////////////////////////////////////////////////////////////////////
+   void MapChangeStateData::LoadSingleMapIntoGM(const std::string& mapName)
+   {
+      DT_PROFILE_ZONE("MapChangeStateData::LoadSingleMapIntoGM");
+      dtCore::Map& map = dtCore::Project::GetInstance().GetMap(mapName);
+
+      ScopedGMBatchAdd batch(*mGameManager);
+
+      dtCore::ActorRefPtrVector actorsToAdd;
+      PrepareMapForGM(map, actorsToAdd);
+
+      for (unsigned int i = 0; i < actorsToAdd.size(); ++i)
+      {
+         AddActorToGM(*mGameManager, *actorsToAdd[i]);
+      }
+   }
+
+   ///////////////////////////////////////////////////////////////////////////////
+   bool MapChangeStateData::AddPendingActors()
+   {
+      DT_PROFILE_ZONE("MapChangeStateData::AddPendingActors");
+      ScopedGMBatchAdd batch(*mGameManager);
+
+      if (!mActorsPrepared)
+      {
+         MapChangeStateData::NameVector::const_iterator i = mNewMapNames.begin();
+         MapChangeStateData::NameVector::const_iterator iend = mNewMapNames.end();
+         for (; i != iend; ++i)
          {
-            try
-            {
-               mGameManager->AddActor(curAddActor);
-            }
-            catch (const dtUtil::Exception& ex)
-            {
-               dtUtil::Log::GetInstance("mapchangestatedata.cpp").LogMessage(dtUtil::Log::LOG_ERROR, __FUNCTION__, __LINE__,
-                     "A problem occurred adding Actor with name \"%s\" of type \"%s\" to the GameManager.",
-                     curAddActor.GetName().c_str(), curAddActor.GetActorType().GetFullName().c_str());
-               ex.LogException(dtUtil::Log::LOG_ERROR, dtUtil::Log::GetInstance("mapchangestatedata.cpp"));
-            }
+            PrepareMapForGM(dtCore::Project::GetInstance().GetMap(*i), mPendingActors);
+         }
+         mNextActor = 0U;
+         mActorsPrepared = true;
+      }
+
+      const osg::Timer& timer = *osg::Timer::instance();
+      const osg::Timer_t start = timer.tick();
+      while (mNextActor < mPendingActors.size())
+      {
+         AddActorToGM(*mGameManager, *mPendingActors[mNextActor]);
+         ++mNextActor;
+
+         if (mActorAddTimeBudget > 0.0 && timer.delta_m(start, timer.tick()) >= mActorAddTimeBudget)
+         {
+            break;
+         }
+      }
+
+      if (mPendingActors.empty())
+      {
+         mProgress = 100.0f;
+      }
+      else
+      {
+         mProgress = 50.0f + 50.0f * float(mNextActor) / float(mPendingActors.size());
+      }
+
+      return mNextActor >= mPendingActors.size();
+   }
+
+   ///////////////////////////////////////////////////////////////////////////////
+   void MapChangeStateData::BeginOpenNewMapsInBackground()
+   {
+      std::vector<dtCore::Project::PreloadedMapFile> preloads(mNewMapNames.size());
+      for (size_t i = 0; i < mNewMapNames.size(); ++i)
+      {
+         try
+         {
+            dtCore::Project::GetInstance().BeginPreloadMap(mNewMapNames[i], preloads[i]);
+         }
+         catch (const dtUtil::Exception&)
+         {
+            // Left empty, so it isn't read, and GetMap reports the error when the map is opened.
          }
       }
+
+      mReadTask = new MapReadTask(preloads);
+      mNextMapToOpen = 0U;
+      dtUtil::ThreadPool::AddTask(*mReadTask, dtUtil::ThreadPool::IO);
+      mCurrentState = &MapChangeState::OPEN;
+   }
+
+   ///////////////////////////////////////////////////////////////////////////////
+   void MapChangeStateData::ReleaseReadTask()
+   {
+      if (!mReadTask.valid())
+      {
+         return;
+      }
+
+      mReadTask->Cancel();
+
+      // The task may outlive this on the IO thread, so a map that is part way built must be dropped here.
+      if (mNextMapToOpen < mReadTask->GetNumFinished())
+      {
+         mReadTask->GetPreload(mNextMapToOpen) = dtCore::Project::PreloadedMapFile();
+      }
+
+      mReadTask = NULL;
+   }
+
+   ///////////////////////////////////////////////////////////////////////////////
+   void MapChangeStateData::ContinueOpenNewMaps()
+   {
+      if (mCancelRequested)
+      {
+         ReleaseReadTask();
+         FinishCancel();
+         return;
+      }
+
+      // Work on one map each update, as soon as its file has been read.  Binary maps were decoded with the read,
+      // so only their actors are created here, within the time budget.  Xml maps are parsed in one update.
+      const unsigned numRead = mReadTask->GetNumFinished();
+      float builtFraction = 0.0f;
+      if (mNextMapToOpen < numRead)
+      {
+         const std::string& mapName = mNewMapNames[mNextMapToOpen];
+         dtCore::Project::PreloadedMapFile& preload = mReadTask->GetPreload(mNextMapToOpen);
+         dtCore::Map* map = NULL;
+         try
+         {
+            map = dtCore::Project::GetInstance().ContinueOpeningMap(mapName, preload, mActorAddTimeBudget);
+         }
+         catch (const dtUtil::Exception& ex)
+         {
+            dtUtil::Log::GetInstance("mapchangestatedata.cpp").LogMessage(dtUtil::Log::LOG_ERROR, __FUNCTION__, __LINE__,
+               "Critical failure occurred while opening map[%s].", mapName.c_str());
+            ex.LogException(dtUtil::Log::LOG_ERROR, dtUtil::Log::GetInstance("mapchangestatedata.cpp"));
+            ReleaseReadTask();
+            FailMapChange();
+            return;
+         }
+
+         if (map != NULL)
+         {
+            preload = dtCore::Project::PreloadedMapFile();
+            ++mNextMapToOpen;
+         }
+         else if (preload.mBinaryReader.valid() && preload.mBinaryReader->GetNumActors() > 0U)
+         {
+            builtFraction = float(preload.mBinaryReader->GetNumActorsBuilt()) / float(preload.mBinaryReader->GetNumActors());
+         }
+      }
+
+      if (mNextMapToOpen < mNewMapNames.size())
+      {
+         // Reading and opening each count for half of the first half.
+         mProgress = 25.0f * (float(numRead + mNextMapToOpen) + builtFraction) / float(mNewMapNames.size());
+         SendProgressMessage();
+         return;
+      }
+
+      mReadTask = NULL;
+      mProgress = 50.0f;
+      SendMapMessage(MessageType::INFO_MAP_LOAD_BEGIN, mNewMapNames);
+      mCurrentState = &MapChangeState::LOAD;
+   }
+
+   ///////////////////////////////////////////////////////////////////////////////
+   bool MapChangeStateData::CancelMapChange()
+   {
+      if (*mCurrentState == MapChangeState::IDLE)
+      {
+         return false;
+      }
+
+      mCancelRequested = true;
+      if (mReadTask.valid())
+      {
+         mReadTask->Cancel();
+      }
+      return true;
+   }
+
+   ///////////////////////////////////////////////////////////////////////////////
+   void MapChangeStateData::FinishCancel()
+   {
+      LOGN_INFO("mapchangestatedata.cpp", "The map change was cancelled.");
+
+      // Removes the actors of the new maps that were added so far.
+      mGameManager->DeleteAllActors(false);
+      mPendingActors.clear();
+      mNextActor = 0U;
+      mActorsPrepared = false;
+
+      MapChangeStateData::NameVector::const_iterator i = mNewMapNames.begin();
+      MapChangeStateData::NameVector::const_iterator iend = mNewMapNames.end();
+      for (; i != iend; ++i)
+      {
+         CloseSingleMap(*i, true);
+      }
+
+      FailMapChange();
+   }
+
+   ///////////////////////////////////////////////////////////////////////////////
+   void MapChangeStateData::FailMapChange()
+   {
+      mCurrentState = &MapChangeState::IDLE;
+      mNewMapNames.clear();
+      mProgress = 0.0f;
+      // set the app to unpause so time stepping is correct
+      mGameManager->SetPaused(false);
+      SendMapMessage(MessageType::INFO_MAP_CHANGED, MapChangeStateData::NameVector());
    }
 
    ///////////////////////////////////////////////////////////////////////////////
@@ -286,8 +591,17 @@ namespace dtGame
       {
          CloseOldMaps();
 
-         if (OpenNewMaps())
+         if (mCancelRequested)
+         {
+            FinishCancel();
+         }
+         else if (mLoadInBackground && !mNewMapNames.empty() && dtUtil::ThreadPool::IsInitialized())
+         {
+            BeginOpenNewMapsInBackground();
+         }
+         else if (OpenNewMaps())
          {
+            mProgress = 50.0f;
             mCurrentState = &MapChangeState::LOAD;
          }
          else
@@ -297,19 +611,36 @@ namespace dtGame
             mCurrentState = &MapChangeState::IDLE;
          }
       }
+      else if (*mCurrentState == MapChangeState::OPEN)
+      {
+         ContinueOpenNewMaps();
+      }
       else if (mCurrentState == &MapChangeState::LOAD)
       {
-         MapChangeStateData::NameVector::const_iterator i = mNewMapNames.begin();
-         MapChangeStateData::NameVector::const_iterator iend = mNewMapNames.end();
+         if (mCancelRequested)
+         {
+            FinishCancel();
+            return;
+         }
 
-         for (; i != iend; ++i)
+         if (!AddPendingActors())
          {
-            LoadSingleMapIntoGM(*i);
+            SendProgressMessage();
+            return;
          }
 
+         mPendingActors.clear();
+         mActorsPrepared = false;
+
          // set the app to unpause so time stepping is correct
          mGameManager->SetPaused(false);
 
+         // Only finish the progress if the change was spread out enough to report any.
+         if (mProgressSent)
+         {
+            SendProgressMessage();
+         }
+
          SendMapMessage(MessageType::INFO_MAPS_OPENED, mNewMapNames);
          SendMapMessage(MessageType::INFO_MAP_CHANGE_LOAD_END, mNewMapNames);
          SendMapMessage(MessageType::INFO_MAP_CHANGE_END, mNewMapNames);
@@ -317,6 +648,18 @@ namespace dtGame
       }
    }
 
+   ///////////////////////////////////////////////////////////////////////////////
+   void MapChangeStateData::SendProgressMessage()
+   {
+      dtCore::RefPtr<MapChangeProgressMessage> progressMessage;
+      mGameManager->GetMessageFactory().CreateMessage(MessageType::INFO_MAP_CHANGE_PROGRESS, progressMessage);
+      progressMessage->SetMapNames(mNewMapNames);
+      progressMessage->SetPercentComplete(mProgress);
+
+      mGameManager->SendMessage(*progressMessage);
+      mProgressSent = true;
+   }
+
    ///////////////////////////////////////////////////////////////////////////////
    void MapChangeStateData::SendMapMessage(const MessageType& type, const MapChangeStateData::NameVector& names)
    {
@@ -214,6 +214,7 @@ namespace dtGame
    const MessageType MessageType::INFO_MAP_CHANGE_UNLOAD_BEGIN("Map Unload Began", MessageType::CATEGORY_INFO, "Sent when unloading a map has begun.", 24, (MapMessage*)(NULL));
    const MessageType MessageType::INFO_MAP_CHANGE_BEGIN("Map Change Began", MessageType::CATEGORY_INFO, "Sent when the program has begun to unload a map and load a new one.  Unload and load messages will be sent", 25, (MapMessage*)(NULL));
    const MessageType MessageType::INFO_MAP_CHANGE_END("Map Changed", MessageType::CATEGORY_INFO, "Sent when the program has completed unloading and loading a new map.", 26, (MapMessage*)(NULL));
+   const MessageType MessageType::INFO_MAP_CHANGE_PROGRESS("Map Change Progress", MessageType::CATEGORY_INFO, "Sent each frame while a map change is spread over several frames, with the percent complete.", 27, (MapChangeProgressMessage*)(NULL));
 
    ////////////////////
    // Deprecated
@@ -59,6 +59,7 @@ namespace dtGame
       mIgnoredMessageTypeList.insert(&dtGame::MessageType::INFO_MAPS_CLOSED);
       mIgnoredMessageTypeList.insert(&dtGame::MessageType::INFO_MAP_UNLOAD_BEGIN);
       mIgnoredMessageTypeList.insert(&dtGame::MessageType::INFO_MAP_UNLOADED);
+      mIgnoredMessageTypeList.insert(&dtGame::MessageType::INFO_MAP_CHANGE_PROGRESS);
    }
 
    //////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,278 @@
+/* -*-c++-*-
+ * Delta3D Open Source Game and Simulation Engine
+ * Copyright (C) 2006, Alion Science and Technology, BMH Operation.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * David Guthrie
+ */
+
+#include <dtHLAGM/attributetranslationplan.h>
+#include <dtHLAGM/attributetoproperty.h>
+#include <dtHLAGM/attributetype.h>
+#include <algorithm>
+
+namespace dtHLAGM
+{
+   namespace
+   {
+      /// Past this many entries, the lookup cache is emptied rather than grown.
+      const size_t MAX_LOOKUP_CACHE_SIZE = 64;
+
+      /////////////////////////////////////////////////////////////////////
+      /// 64 bit FNV-1a over the bytes of a value.
+      template <typename T>
+      void HashValue(unsigned long long& hash, const T& value)
+      {
+         const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&value);
+         for (size_t i = 0; i < sizeof(T); ++i)
+         {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+         }
+      }
+
+      struct HandleHashLess
+      {
+         template <typename Entry>
+         bool operator()(const Entry& lhs, size_t rhs) const
+         {
+            return lhs.mHash < rhs;
+         }
+
+         template <typename Entry>
+         bool operator()(size_t lhs, const Entry& rhs) const
+         {
+            return lhs < rhs.mHash;
+         }
+
+         template <typename Entry>
+         bool operator()(const Entry& lhs, const Entry& rhs) const
+         {
+            return lhs.mHash < rhs.mHash;
+         }
+      };
+
+      struct HandlePointerLess
+      {
+         typedef std::pair<dtCore::RefPtr<RTIAttributeHandle>, unsigned> Value;
+
+         bool operator()(const Value& lhs, const RTIAttributeHandle* rhs) const
+         {
+            return lhs.first.get() < rhs;
+         }
+      };
+   }
+
+   /////////////////////////////////////////////////////////////////////
+   AttributeTranslationPlan::AttributeTranslationPlan()
+   : mMappingsHash(0)
+   , mCompiled(false)
+   {
+   }
+
+   /////////////////////////////////////////////////////////////////////
+   AttributeTranslationPlan::~AttributeTranslationPlan()
+   {
+   }
+
+   /////////////////////////////////////////////////////////////////////
+   void AttributeTranslationPlan::Clear()
+   {
+      mEntries.clear();
+      mPendingHandles.clear();
+      mHandleTable.clear();
+      mMappingIndices.clear();
+      mLookupCache.clear();
+      mMappingsHash = 0;
+      mCompiled = false;
+   }
+
+   /////////////////////////////////////////////////////////////////////
+   void AttributeTranslationPlan::AddMapping(MappingKind kind, RTIAttributeHandle* handle, const ParameterTranslator* translator)
+   {
+      Entry entry;
+      entry.mKind = kind;
+      entry.mTranslator = translator;
+
+      if (handle != NULL)
+      {
+         mPendingHandles.push_back(std::make_pair(handle, unsigned(mEntries.size())));
+      }
+
+      mEntries.push_back(entry);
+      mCompiled = false;
+   }
+
+   /////////////////////////////////////////////////////////////////////
+   void AttributeTranslationPlan::Finish(size_t mappingsHash)
+   {
+      mHandleTable.clear();
+      mMappingIndices.clear();
+      mLookupCache.clear();
+
+      // Group the mappings by handle value.  mBegin counts the mappings of each handle for now.
+      std::vector<unsigned> pendingGroups(mPendingHandles.size());
+      for (unsigned i = 0; i < mPendingHandles.size(); ++i)
+      {
+         RTIAttributeHandle& handle = *mPendingHandles[i].first;
+
+         unsigned group = 0;
+         for (; group < mHandleTable.size(); ++group)
+         {
+            if (mHandleTable[group].mHandle.get() == &handle || *mHandleTable[group].mHandle == handle)
+            {
+               break;
+            }
+         }
+
+         if (group == mHandleTable.size())
+         {
+            HandleEntry handleEntry;
+            handleEntry.mHash = handle.GetHash();
+            handleEntry.mHandle = &handle;
+            handleEntry.mBegin = 0;
+            handleEntry.mEnd = 0;
+            mHandleTable.push_back(handleEntry);
+         }
+
+         ++mHandleTable[group].mBegin;
+         pendingGroups[i] = group;
+      }
+
+      // Lay the groups out in hash order.  Stable, so the table doesn't depend on the sort implementation.
+      std::vector<HandleEntry> sortedTable(mHandleTable);
+      std::stable_sort(sortedTable.begin(), sortedTable.end(), HandleHashLess());
+
+      std::vector<unsigned> groupPositions(mHandleTable.size());
+      unsigned offset = 0;
+      for (unsigned i = 0; i < sortedTable.size(); ++i)
+      {
+         unsigned count = sortedTable[i].mBegin;
+         sortedTable[i].mBegin = offset;
+         sortedTable[i].mEnd = offset;
+         offset += count;
+
+         for (unsigned group = 0; group < mHandleTable.size(); ++group)
+         {
+            if (mHandleTable[group].mHandle.get() == sortedTable[i].mHandle.get())
+            {
+               groupPositions[group] = i;
+               break;
+            }
+         }
+      }
+
+      // Walk the mappings in order, so mappings sharing a handle keep the order of the mapping vector.
+      mMappingIndices.resize(mPendingHandles.size());
+      for (unsigned i = 0; i < mPendingHandles.size(); ++i)
+      {
+         HandleEntry& handleEntry = sortedTable[groupPositions[pendingGroups[i]]];
+         mMappingIndices[handleEntry.mEnd] = mPendingHandles[i].second;
+         ++handleEntry.mEnd;
+      }
+
+      mHandleTable.swap(sortedTable);
+      mPendingHandles.clear();
+      mMappingsHash = mappingsHash;
+      mCompiled = true;
+   }
+
+   /////////////////////////////////////////////////////////////////////
+   size_t AttributeTranslationPlan::HashMappings(const std::vector<AttributeToPropertyList>& mappings)
+   {
+      unsigned long long hash = 14695981039346656037ULL;
+      HashValue(hash, mappings.size());
+
+      std::vector<AttributeToPropertyList>::const_iterator i, iend;
+      i = mappings.begin();
+      iend = mappings.end();
+      for (; i != iend; ++i)
+      {
+         const AttributeType* type = i->GetHLAType();
+         HashValue(hash, i->GetAttributeHandle());
+         HashValue(hash, type);
+         HashValue(hash, i->GetParameterDefinitions().empty());
+
+         const std::string& name = i->GetHLAName();
+         HashValue(hash, name.size());
+         for (size_t c = 0; c < name.size(); ++c)
+         {
+            HashValue(hash, name[c]);
+         }
+      }
+
+      return size_t(hash);
+   }
+
+   /////////////////////////////////////////////////////////////////////
+   AttributeTranslationPlan::HandleRange AttributeTranslationPlan::GetRange(unsigned tableIndex) const
+   {
+      if (tableIndex >= mHandleTable.size())
+      {
+         return HandleRange(mMappingIndices.end(), mMappingIndices.end());
+      }
+
+      const HandleEntry& handleEntry = mHandleTable[tableIndex];
+      return HandleRange(mMappingIndices.begin() + handleEntry.mBegin, mMappingIndices.begin() + handleEntry.mEnd);
+   }
+
+   /////////////////////////////////////////////////////////////////////
+   AttributeTranslationPlan::HandleRange AttributeTranslationPlan::FindMappings(RTIAttributeHandle& handle) const
+   {
+      std::pair<HandleTable::const_iterator, HandleTable::const_iterator> hashRange =
+               std::equal_range(mHandleTable.begin(), mHandleTable.end(), handle.GetHash(), HandleHashLess());
+
+      // Nothing mapped has this hash, so there is nothing to compare.
+      if (hashRange.first == hashRange.second)
+      {
+         return GetRange(unsigned(mHandleTable.size()));
+      }
+
+      HandleTable::const_iterator i;
+      for (i = hashRange.first; i != hashRange.second; ++i)
+      {
+         if (i->mHandle.get() == &handle)
+         {
+            return GetRange(unsigned(i - mHandleTable.begin()));
+         }
+      }
+
+      LookupCache::iterator cached = std::lower_bound(mLookupCache.begin(), mLookupCache.end(), &handle, HandlePointerLess());
+      if (cached != mLookupCache.end() && cached->first.get() == &handle)
+      {
+         return GetRange(cached->second);
+      }
+
+      unsigned tableIndex = unsigned(mHandleTable.size());
+      for (i = hashRange.first; i != hashRange.second; ++i)
+      {
+         if (*i->mHandle == handle)
+         {
+            tableIndex = unsigned(i - mHandleTable.begin());
+            break;
+         }
+      }
+
+      if (mLookupCache.size() >= MAX_LOOKUP_CACHE_SIZE)
+      {
+         mLookupCache.clear();
+         cached = mLookupCache.end();
+      }
+      mLookupCache.insert(cached, std::make_pair(&handle, tableIndex));
+
+      return GetRange(tableIndex);
+   }
+}
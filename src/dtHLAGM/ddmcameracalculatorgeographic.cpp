@@ -116,11 +116,17 @@ namespace dtHLAGM
          osg::Vec3 pos;
          xform.GetTranslation(pos);
 
-         osg::Vec3 lowerBound(pos.x() - mXRange/2.0, pos.y() - mYRange/2.0, pos.z());
-         osg::Vec3 upperBound(pos.x() + mXRange/2.0, pos.y() + mYRange/2.0, pos.z());
-
-         const osg::Vec3d latLonElevLower = mCoordinates.ConvertToRemoteTranslation(lowerBound);
-         const osg::Vec3d latLonElevUpper = mCoordinates.ConvertToRemoteTranslation(upperBound);
+         const osg::Vec3 bounds[2] =
+         {
+            osg::Vec3(pos.x() - mXRange/2.0, pos.y() - mYRange/2.0, pos.z()),
+            osg::Vec3(pos.x() + mXRange/2.0, pos.y() + mYRange/2.0, pos.z())
+         };
+
+         // Both corners share one lookup of the mode and projection.
+         osg::Vec3d latLonElevBounds[2];
+         mCoordinates.ConvertToRemoteTranslations(bounds, latLonElevBounds, 2);
+         const osg::Vec3d& latLonElevLower = latLonElevBounds[0];
+         const osg::Vec3d& latLonElevUpper = latLonElevBounds[1];
 
          if (UpdateDimension(ddmData, 1, GetSecondDimensionName(),
                DDMUtil::MapLinear(latLonElevLower.x() , -75.0, 75.0),
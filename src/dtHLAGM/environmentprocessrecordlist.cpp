@@ -727,9 +727,7 @@ namespace dtHLAGM
    bool EnvironmentProcessRecordList::Decode(const char* buffer, size_t size)
    {
       bool result = false;
-      //ewww, const cast, but the data stream won't use a const pointer.
-      // we aren't writing to it, though, and no one else it accessing the data, so it should be fine.
-      dtUtil::DataStream ds(const_cast<char *>(buffer), size, false);
+      dtUtil::DataStream ds = dtUtil::DataStream::CreateView(buffer, unsigned(size));
       ds.SetForceLittleEndian(mLittleEndian);
 
       size_t baseSize = GetBaseSize();
@@ -293,6 +293,9 @@ namespace dtHLAGM
          ++attributeToPropertyListIterator;
       }
 
+      // The attribute handles are all known now, so build the lookup used when reflecting.
+      CompileTranslationPlan(objectToActor);
+
       bool failed = false;
       if (!objectToActor.IsLocalOnly())
       {
@@ -773,6 +776,15 @@ namespace dtHLAGM
    void HLAComponent::AddParameterTranslator(ParameterTranslator& newTranslator)
    {
       mParameterTranslators.push_back(&newTranslator);
+
+      // The plans cache translators, so have them rebuilt on the next reflect.
+      ObjectToActorMapIter i, iend;
+      i = mObjectToActorMap.begin();
+      iend = mObjectToActorMap.end();
+      for (; i != iend; ++i)
+      {
+         i->second->GetTranslationPlan().Clear();
+      }
    }
 
    /////////////////////////////////////////////////////////////////////////////////
@@ -1392,7 +1404,34 @@ namespace dtHLAGM
          //USE OBJECTTOACTOR TO CREATE ACTOR UPDATE
          std::vector<AttributeToPropertyList>& currentAttributeToPropertyListVector = bestObjectToActor->GetOneToManyMappingVector();
 
-         std::vector<AttributeToPropertyList>::iterator vectorIterator;
+         // The mapping vector can be edited in place through GetOneToManyMappingVector, so check its contents.
+         if (!bestObjectToActor->GetTranslationPlan().IsCompiledFor(
+                  AttributeTranslationPlan::HashMappings(currentAttributeToPropertyListVector)))
+         {
+            CompileTranslationPlan(*bestObjectToActor);
+         }
+
+         const AttributeTranslationPlan& plan = bestObjectToActor->GetTranslationPlan();
+
+         // Walk the incoming attributes once and point each mapping at its buffer.
+         mReflectBuffers.assign(currentAttributeToPropertyListVector.size(), NULL);
+
+         RTIAttributeHandleValueMap::const_iterator attrIter, attrEnd;
+         attrIter = theAttributes.begin();
+         attrEnd = theAttributes.end();
+         for (; attrIter != attrEnd; ++attrIter)
+         {
+            if (!attrIter->first.valid())
+            {
+               continue;
+            }
+
+            AttributeTranslationPlan::HandleRange range = plan.FindMappings(*attrIter->first);
+            for (; range.first != range.second; ++range.first)
+            {
+               mReflectBuffers[*range.first] = &attrIter->second.mData;
+            }
+         }
 
          dtGame::GameManager* gameManager = GetGameManager();
 
@@ -1404,31 +1443,28 @@ namespace dtHLAGM
          else
             msg = factory.CreateMessage(dtGame::MessageType::INFO_ACTOR_UPDATED);
 
-         AttributeToPropertyList* curAttrToProp = NULL;
-         for (vectorIterator = currentAttributeToPropertyListVector.begin();
-               vectorIterator != currentAttributeToPropertyListVector.end();
-               ++vectorIterator)
+         for (unsigned mappingIndex = 0; mappingIndex < currentAttributeToPropertyListVector.size(); ++mappingIndex)
          {
-            curAttrToProp = &(*vectorIterator);
+            AttributeToPropertyList& curAttrToProp = currentAttributeToPropertyListVector[mappingIndex];
 
             // Avoid invalid mappings.
-            if( curAttrToProp->IsInvalid() )
+            if( curAttrToProp.IsInvalid() )
             {
                continue;
             }
 
-            const std::string& attributeString = curAttrToProp->GetHLAName();
+            const AttributeTranslationPlan::Entry& planEntry = plan.GetEntry(mappingIndex);
 
             bool matched = false;
 
             // If attribute name is valid...
-            if( ! attributeString.empty() )
+            if( ! curAttrToProp.GetHLAName().empty() )
             {
-               // Get ready to capture an attribute buffer and its length.
-               std::string buf;
+               // The attribute buffer, if it was in the update.
+               const std::string* buf = mReflectBuffers[mappingIndex];
 
                // Handle special cases...
-               if( curAttrToProp->IsSpecial() )
+               if( curAttrToProp.IsSpecial() )
                {
                   // Make sure that the default parameters are not used.
                   matched = true;
@@ -1439,52 +1475,46 @@ namespace dtHLAGM
                   // if Entity Type usage is disabled.
 
                   // Is this Object Mapping Name?
-                  if( attributeString == ATTR_NAME_MAPPING_NAME )
+                  if( planEntry.mKind == AttributeTranslationPlan::MAPPING_KIND_MAPPING_NAME )
                   {
-                     const std::string& mappingName = bestObjectToActor->GetMappingName();
-                     buf = mappingName;
+                     buf = &bestObjectToActor->GetMappingName();
                   }
                   // Is this the Entity Type?
                   // GetEntityType will not be NULL if Entity Types are being used.
-                  else if( attributeString == ATTR_NAME_ENTITY_TYPE )
-                  {
-                     buf = GetAttributeBufferAndLength( theAttributes, *curAttrToProp);
-                  }
-                  else
+                  else if( planEntry.mKind != AttributeTranslationPlan::MAPPING_KIND_ENTITY_TYPE )
                   {
+                     buf = NULL;
+
                      // Bad match. Special parameter does not have the name of
                      // a special attribute.
-                     curAttrToProp->SetInvalid( true );
+                     curAttrToProp.SetInvalid( true );
 
                      std::ostringstream reason;
                      reason << "HLA attribute mapping \""
-                        << attributeString.c_str()
+                        << curAttrToProp.GetHLAName()
                         << "\" was marked as SPECIAL but does NOT match the name of a special type HLA attribute."
                         << std::endl;
-                     LogMappingError( *curAttrToProp, reason.str() );
+                     LogMappingError( curAttrToProp, reason.str() );
                   }
-
                }
                else
                {
-                  buf = GetAttributeBufferAndLength( theAttributes, *curAttrToProp);
-
-                  matched = !buf.empty();
+                  matched = buf != NULL && !buf->empty();
                }
 
                // If an attribute was found to match, its buffer and length will
                // have been obtained and can be used to create the message parameters.
-               if( matched && !buf.empty() )
+               if( matched && buf != NULL && !buf->empty() )
                {
                   bool success = CreateMessageParameters(
-                     buf, *curAttrToProp, *msg, true );
+                     *buf, curAttrToProp, *msg, true, std::string(), planEntry.mTranslator );
 
                   if( ! success )
                   {
                      // One or more parameter mappings failed.
-                     curAttrToProp->SetInvalid( true );
+                     curAttrToProp.SetInvalid( true );
 
-                     LogMappingError( *curAttrToProp, "Mapping was not successful, it was not able to create the correct message parameters." );
+                     LogMappingError( curAttrToProp, "Mapping was not successful, it was not able to create the correct message parameters." );
                   }
                }
             }
@@ -1493,7 +1523,7 @@ namespace dtHLAGM
             //use defaults for all parameters that need them.
             if (!matched)
             {
-               SetDefaultParameters(vectorIterator, bNewObject, msg.get());
+               SetDefaultParameters(currentAttributeToPropertyListVector.begin() + mappingIndex, bNewObject, msg.get());
             }
          }
 
@@ -1514,28 +1544,47 @@ namespace dtHLAGM
    }
 
    /////////////////////////////////////////////////////////////////////////////////
-   std::string HLAComponent::GetAttributeBufferAndLength( const RTIAttributeHandleValueMap& attributeSet,
-      AttributeToPropertyList& curAttrToProp )
+   void HLAComponent::CompileTranslationPlan(ObjectToActor& objectToActor)
    {
-      if( ! curAttrToProp.GetParameterDefinitions().empty() )
+      AttributeTranslationPlan& plan = objectToActor.GetTranslationPlan();
+      plan.Clear();
+
+      std::vector<AttributeToPropertyList>& attrToPropVector = objectToActor.GetOneToManyMappingVector();
+      std::vector<AttributeToPropertyList>::iterator i, iend;
+      i = attrToPropVector.begin();
+      iend = attrToPropVector.end();
+      for (; i != iend; ++i)
       {
-         RTIAttributeHandleValueMap::const_iterator i, iend;
-         i = attributeSet.begin();
-         iend = attributeSet.end();
-         for(; i != iend; ++i )
+         AttributeToPropertyList& curAttrToProp = *i;
+         const std::string& attributeString = curAttrToProp.GetHLAName();
+
+         AttributeTranslationPlan::MappingKind kind = AttributeTranslationPlan::MAPPING_KIND_NORMAL;
+         if (attributeString == ATTR_NAME_MAPPING_NAME)
+         {
+            kind = AttributeTranslationPlan::MAPPING_KIND_MAPPING_NAME;
+         }
+         else if (attributeString == ATTR_NAME_ENTITY_TYPE)
          {
-            RTIAttributeHandle* handle = i->first;
+            kind = AttributeTranslationPlan::MAPPING_KIND_ENTITY_TYPE;
+         }
 
-            if( handle != NULL && curAttrToProp.GetAttributeHandle() != NULL &&
-                     *handle == *curAttrToProp.GetAttributeHandle() )
-            {
-               return i->second.mData;
-            }
+         // A mapping with no parameters never takes a value from an update.
+         RTIAttributeHandle* handle = NULL;
+         if (!curAttrToProp.GetParameterDefinitions().empty())
+         {
+            handle = curAttrToProp.GetAttributeHandle();
+         }
+
+         const ParameterTranslator* translator = NULL;
+         if (!attributeString.empty())
+         {
+            translator = FindTranslatorForAttributeType(curAttrToProp.GetHLAType());
          }
+
+         plan.AddMapping(kind, handle, translator);
       }
 
-      // The target attribute was not found.
-      return std::string();
+      plan.Finish(AttributeTranslationPlan::HashMappings(attrToPropVector));
    }
 
    /////////////////////////////////////////////////////////////////////////////////
@@ -1780,9 +1829,14 @@ namespace dtHLAGM
    void HLAComponent::MapToMessageParameters(const char* buffer,
                                              size_t size,
                                              std::vector<dtCore::RefPtr<dtGame::MessageParameter> >& parameters,
-                                             const OneToManyMapping& mapping) const
+                                             const OneToManyMapping& mapping,
+                                             const ParameterTranslator* translator) const
    {
-      const ParameterTranslator* pt = FindTranslatorForAttributeType(mapping.GetHLAType());
+      const ParameterTranslator* pt = translator;
+      if (pt == NULL)
+      {
+         pt = FindTranslatorForAttributeType(mapping.GetHLAType());
+      }
 
       if (pt != NULL)
          pt->MapToMessageParameters(buffer, size, parameters, mapping);
@@ -1971,7 +2025,8 @@ namespace dtHLAGM
       const OneToManyMapping& paramToParamMapping,
       dtGame::Message& message,
       bool addMissingParams,
-      const std::string& classHandleString // HLA Interaction class name
+      const std::string& classHandleString, // HLA Interaction class name
+      const ParameterTranslator* translator
       )
    {
        bool success = true;
@@ -2036,7 +2091,7 @@ namespace dtHLAGM
                 }
 
                 MapToMessageParameters( bufferPtr, perLength,
-                   messageParams, paramToParamMapping );
+                   messageParams, paramToParamMapping, translator );
 
                 bufferPtr += perLength;
                 remainder -= perLength;
@@ -2055,7 +2110,8 @@ namespace dtHLAGM
       const OneToManyMapping& paramToParamMapping,
       dtGame::Message& message,
       bool addMissingParams,
-      const std::string& classHandleString // HLA Interaction class name
+      const std::string& classHandleString, // HLA Interaction class name
+      const ParameterTranslator* translator
       )
    {
       // Initiate the state of this procedure. Mapping is successful until
@@ -2066,7 +2122,7 @@ namespace dtHLAGM
       {
          // Do the array and return.
          success = CreateMessageParametersArray(paramNameBuffer,
-               paramToParamMapping, message, addMissingParams, classHandleString);
+               paramToParamMapping, message, addMissingParams, classHandleString, translator);
          return success;
       }
 
@@ -2160,7 +2216,7 @@ namespace dtHLAGM
       }
 
       MapToMessageParameters( paramNameBuffer.c_str(), paramNameBuffer.length(),
-         messageParams, paramToParamMapping );
+         messageParams, paramToParamMapping, translator );
 
       if (aboutParameter.valid())
       {
@@ -203,6 +203,7 @@ namespace dtHLAGM
    void ObjectToActor::SetOneToManyMappingVector(std::vector<AttributeToPropertyList> &thisOneToManyMapping)
    {
       mOneToMany = thisOneToManyMapping;
+      mTranslationPlan.Clear();
    }
 
    /////////////////////////////////////////////////////////////////////
@@ -230,6 +231,7 @@ namespace dtHLAGM
       mEntityIdAttribute = setTo.mEntityIdAttribute;
       mEntityTypeAttribute = setTo.mEntityTypeAttribute;
       mOneToMany = setTo.mOneToMany;
+      mTranslationPlan.Clear();
 
       return *this;
    }
@@ -46,6 +46,8 @@ namespace dtHLAGM
          }
          return castH->mHandle == mHandle;
       }
+
+      virtual size_t GetHash() const { return size_t(mHandle.hash()); }
    protected:
       virtual ~RTI1516eHandle() {}
    private:
@@ -32,4 +32,9 @@ namespace dtHLAGM
    {
 
    }
+
+   size_t RTIHandle::GetHash() const
+   {
+      return 0;
+   }
 }
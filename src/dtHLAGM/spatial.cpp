@@ -248,8 +248,7 @@ namespace dtHLAGM
    bool Spatial::Decode(const char* buffer, size_t size)
    {
       bool result = false;
-      //ewww, const cast, but the data stream won't use a const pointer.
-      dtUtil::DataStream ds(const_cast<char *>(buffer), size, false);
+      dtUtil::DataStream ds = dtUtil::DataStream::CreateView(buffer, unsigned(size));
       ds.SetForceLittleEndian(mLittleEndian);
 
       size_t baseSize = GetBaseSize();
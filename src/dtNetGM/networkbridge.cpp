@@ -28,6 +28,7 @@
 #include <dtUtil/stringutils.h>
 #include <gnelib.h>
 #include <dtUtil/log.h>
+#include <dtUtil/profiler.h>
 
 namespace dtNetGM
 {
@@ -131,6 +132,10 @@ namespace dtNetGM
 
    void NetworkBridge::OnReceive(GNE::Connection& conn)
    {
+      // GNE calls this on its own event thread.
+      DT_PROFILE_THREAD_NAME("GNE Network");
+      DT_PROFILE_ZONE("NetworkBridge::OnReceive");
+
       // Set the timestamp to current time
       SetTimeStamp();
 
@@ -201,6 +206,8 @@ namespace dtNetGM
 
    void NetworkBridge::SendDataStream(dtUtil::DataStream& dataStream, bool allowBestEffort)
    {
+      DT_PROFILE_ZONE("NetworkBridge::SendDataStream");
+
       // Unreliable;
       bool reliable = allowBestEffort && mGneConnection->getStats(0).openSockets == 0;
 
@@ -32,6 +32,7 @@
 #include <dtGame/messagefactory.h>
 #include <dtGame/basemessages.h>
 #include <dtUtil/log.h>
+#include <dtUtil/profiler.h>
 #include <dtUtil/threadpool.h>
 #include <dtCore/system.h>
 
@@ -53,6 +54,7 @@ namespace dtNetGM
    public:
       DispatchTask()
       {
+         SetName("Network Dispatch");
       }
 
       virtual void operator () ()
@@ -271,6 +273,8 @@ namespace dtNetGM
    ////////////////////////////////////////////////////////////////////////////////
    void NetworkComponent::HandleIncomingMessages()
    {
+      DT_PROFILE_ZONE("NetworkComponent::HandleIncomingMessages");
+
       HandleWaitingMessages();
 
       {
@@ -692,6 +696,9 @@ namespace dtNetGM
    /////////////////////////////////////////////////////////////
    void NetworkComponent::SendNetworkMessages(MessageBufferType& messageBuffer)
    {
+      DT_PROFILE_ZONE("NetworkComponent::SendNetworkMessages");
+      DT_PROFILE_COUNTER("NetworkComponent Messages Sent", messageBuffer.size());
+
       MessageBufferType::iterator i, iend;
       i = messageBuffer.begin();
       iend = messageBuffer.end();
@@ -0,0 +1,463 @@
+/* -*-c++-*-
+ * dtPhysics
+ * Copyright 2014, Caper Holdings, LLC
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include <dtPhysics/collisioncache.h>
+#include <dtPhysics/geometry.h>
+#include <dtPhysics/physicsreaderwriter.h>
+
+#include <dtUtil/datastream.h>
+#include <dtUtil/exception.h>
+#include <dtUtil/fileutils.h>
+#include <dtUtil/log.h>
+#include <dtUtil/mappedfile.h>
+#include <dtUtil/mswinmacros.h>
+#include <dtUtil/threadpool.h>
+
+#include <OpenThreads/Mutex>
+#include <OpenThreads/ScopedLock>
+
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+#ifdef DELTA_WIN32
+#   include <dtUtil/mswin.h>
+#endif
+
+namespace dtPhysics
+{
+   const std::string CollisionCache::POLYTOPE_KEY_SUFFIX("_Polytope");
+
+   static const std::string CACHE_FILE_EXTENSION(".dtphyscache");
+
+   /////////////////////////////////////////////////////////////////////////////
+   // Loads one source file for CollisionCache::RequestLoad.
+   /////////////////////////////////////////////////////////////////////////////
+   class CollisionCacheLoadTask : public dtUtil::ThreadPoolTask
+   {
+   public:
+      CollisionCacheLoadTask(const std::string& meshCacheKey, const std::string& sourceFile, bool polytope)
+      : mMeshCacheKey(meshCacheKey)
+      , mSourceFile(sourceFile)
+      , mPolytope(polytope)
+      {
+         SetName("Collision Cache Load");
+      }
+
+      void operator()() override;
+
+   private:
+      std::string mMeshCacheKey;
+      std::string mSourceFile;
+      bool mPolytope;
+   };
+
+   namespace
+   {
+      OpenThreads::Mutex gCacheMutex;
+      // Only one thread trims at a time, so a file isn't counted or deleted twice.
+      OpenThreads::Mutex gTrimMutex;
+      std::string gCacheDirectory;
+      unsigned long long gMaxDirectorySize = 0ULL;
+      CollisionCache::Stats gCacheStats;
+      unsigned gTempFileCounter = 0U;
+
+      typedef std::map<std::string, dtCore::RefPtr<CollisionCacheLoadTask> > PendingLoadMap;
+      PendingLoadMap gPendingLoads;
+
+      //////////////////////////////////////////////////////////////////////////
+      unsigned long long HashKey(const std::string& key)
+      {
+         // 64 bit FNV-1a
+         unsigned long long hash = 14695981039346656037ULL;
+         for (size_t i = 0; i < key.size(); ++i)
+         {
+            hash ^= static_cast<unsigned char>(key[i]);
+            hash *= 1099511628211ULL;
+         }
+         return hash;
+      }
+
+      //////////////////////////////////////////////////////////////////////////
+      /// Builds the string the cache file is named by.  It is also stored in the file to catch hash collisions.
+      std::string BuildCacheKey(const std::string& sourceFile, bool polytope, std::string& cacheFileOut)
+      {
+         std::string directory;
+         {
+            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(gCacheMutex);
+            directory = gCacheDirectory;
+         }
+
+         cacheFileOut.clear();
+         if (directory.empty())
+         {
+            return std::string();
+         }
+
+         const dtUtil::FileInfo info = dtUtil::FileUtils::GetInstance().GetFileInfo(sourceFile);
+         if (info.fileType != dtUtil::REGULAR_FILE)
+         {
+            return std::string();
+         }
+
+         std::ostringstream key;
+         key << CollisionCache::CACHE_VERSION << '|' << sourceFile << '|' << info.size << '|'
+             << static_cast<long long>(info.lastModified) << '|' << (polytope ? "hull" : "mesh");
+
+         std::ostringstream fileName;
+         fileName << std::hex << HashKey(key.str());
+         cacheFileOut = dtUtil::FileUtils::ConcatPaths(directory, fileName.str() + CACHE_FILE_EXTENSION);
+         return key.str();
+      }
+
+      //////////////////////////////////////////////////////////////////////////
+      bool CookTriangleData(VertexData& triangleData, const std::string& sourceFile, bool polytope)
+      {
+         if (!PhysicsReaderWriter::LoadTriangleDataFile(triangleData, sourceFile))
+         {
+            return false;
+         }
+         if (polytope)
+         {
+            triangleData.ConvertToPolytope();
+         }
+         return true;
+      }
+
+      //////////////////////////////////////////////////////////////////////////
+      bool ReadCacheFile(VertexData& triangleData, const std::string& cacheFile, const std::string& key)
+      {
+         dtUtil::MappedFile mappedFile;
+         if (!mappedFile.Open(cacheFile))
+         {
+            return false;
+         }
+
+         // The mapping still owns the memory, the view just reads it.
+         dtUtil::DataStream ds = dtUtil::DataStream::CreateView(mappedFile.GetData(), unsigned(mappedFile.GetSize()));
+         dtCore::RefPtr<VertexData> readData = new VertexData;
+         try
+         {
+            std::string storedKey;
+            ds.Read(storedKey);
+            if (storedKey != key)
+            {
+               LOG_WARNING("Cooked collision file \"" + cacheFile + "\" belongs to a different source, it will be replaced.");
+               return false;
+            }
+            PhysicsReaderWriter::ReadTriangleData(ds, *readData, cacheFile);
+         }
+         catch (const dtUtil::Exception& ex)
+         {
+            ex.LogException(dtUtil::Log::LOG_WARNING);
+            return false;
+         }
+
+         triangleData.Swap(*readData);
+         return true;
+      }
+
+      //////////////////////////////////////////////////////////////////////////
+      bool WriteCacheFile(const VertexData& triangleData, const std::string& cacheFile, const std::string& key)
+      {
+         dtUtil::DataStream ds;
+         ds.Write(key);
+         PhysicsReaderWriter::WriteTriangleData(ds, triangleData);
+
+         // Write to a file of our own first, so a reader never maps a half written file.
+         std::ostringstream tempFile;
+         {
+            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(gCacheMutex);
+            tempFile << cacheFile << '.' << ++gTempFileCounter << ".tmp";
+         }
+
+         {
+            std::ofstream outfile(tempFile.str().c_str(), std::ios_base::binary | std::ios_base::out | std::ios_base::trunc);
+            if (!outfile.is_open())
+            {
+               LOG_WARNING("Unable to write the cooked collision file \"" + tempFile.str() + "\".");
+               return false;
+            }
+            outfile.write(ds.GetBuffer(), ds.GetBufferSize());
+            outfile.close();
+            if (outfile.fail())
+            {
+               std::remove(tempFile.str().c_str());
+               return false;
+            }
+         }
+
+#ifdef DELTA_WIN32
+         // rename won't replace an existing file on Windows, such as one with a stale key.
+         const bool moved = MoveFileExA(tempFile.str().c_str(), cacheFile.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+         const bool moved = std::rename(tempFile.str().c_str(), cacheFile.c_str()) == 0;
+#endif
+         if (!moved)
+         {
+            // Another thread wrote the same file first, or a reader still has it mapped.
+            std::remove(tempFile.str().c_str());
+            return false;
+         }
+         return true;
+      }
+
+      //////////////////////////////////////////////////////////////////////////
+      /// Deletes the oldest cooked files until the directory is under the size limit.
+      void TrimDirectory()
+      {
+         std::string directory;
+         unsigned long long maxSize = 0ULL;
+         {
+            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(gCacheMutex);
+            directory = gCacheDirectory;
+            maxSize = gMaxDirectorySize;
+         }
+
+         if (directory.empty() || maxSize == 0ULL)
+         {
+            return;
+         }
+
+         OpenThreads::ScopedLock<OpenThreads::Mutex> trimLock(gTrimMutex);
+
+         dtUtil::FileUtils& fileUtils = dtUtil::FileUtils::GetInstance();
+         dtUtil::FileExtensionList extensions;
+         extensions.push_back(CACHE_FILE_EXTENSION);
+         dtUtil::DirectoryContents files;
+         try
+         {
+            files = fileUtils.DirGetFiles(directory, extensions);
+         }
+         catch (const dtUtil::Exception& ex)
+         {
+            ex.LogException(dtUtil::Log::LOG_WARNING);
+            return;
+         }
+
+         typedef std::multimap<time_t, std::pair<std::string, unsigned long long> > FileAgeMap;
+         FileAgeMap filesByAge;
+         unsigned long long totalSize = 0ULL;
+         for (size_t i = 0; i < files.size(); ++i)
+         {
+            const std::string path = dtUtil::FileUtils::ConcatPaths(directory, files[i]);
+            const dtUtil::FileInfo info = fileUtils.GetFileInfo(path);
+            if (info.fileType == dtUtil::REGULAR_FILE)
+            {
+               totalSize += info.size;
+               filesByAge.insert(std::make_pair(info.lastModified, std::make_pair(path, static_cast<unsigned long long>(info.size))));
+            }
+         }
+
+         unsigned numEvicted = 0U;
+         for (FileAgeMap::iterator i = filesByAge.begin(); i != filesByAge.end() && totalSize > maxSize; ++i)
+         {
+            // A file that is mapped can't be deleted on Windows, so it is skipped until the next trim.
+            if (std::remove(i->second.first.c_str()) == 0)
+            {
+               totalSize -= i->second.second;
+               ++numEvicted;
+            }
+         }
+
+         if (numEvicted > 0U)
+         {
+            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(gCacheMutex);
+            gCacheStats.mEvictions += numEvicted;
+         }
+      }
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void CollisionCacheLoadTask::operator()()
+   {
+      dtCore::RefPtr<VertexData> data = new VertexData;
+      if (CollisionCache::LoadTriangleData(*data, mSourceFile, mPolytope))
+      {
+         VertexData::AddCachedData(mMeshCacheKey, *data);
+      }
+      else
+      {
+         LOG_ERROR("Unable to load triangle data from \"" + mSourceFile + "\".");
+      }
+
+      // The data is cached before the task is dropped, so WaitForLoad either finds the task or the data.
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(gCacheMutex);
+      gPendingLoads.erase(mMeshCacheKey);
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void CollisionCache::SetDirectory(const std::string& directory)
+   {
+      if (!directory.empty() && !dtUtil::FileUtils::GetInstance().DirExists(directory))
+      {
+         try
+         {
+            dtUtil::FileUtils::GetInstance().MakeDirectoryEX(directory);
+         }
+         catch (const dtUtil::Exception& ex)
+         {
+            ex.LogException(dtUtil::Log::LOG_ERROR);
+            LOG_ERROR("The collision cache is off because \"" + directory + "\" can't be created.");
+            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(gCacheMutex);
+            gCacheDirectory.clear();
+            return;
+         }
+      }
+
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(gCacheMutex);
+      gCacheDirectory = directory;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   std::string CollisionCache::GetDirectory()
+   {
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(gCacheMutex);
+      return gCacheDirectory;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   bool CollisionCache::IsEnabled()
+   {
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(gCacheMutex);
+      return !gCacheDirectory.empty();
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void CollisionCache::SetMaxDirectorySize(unsigned long long bytes)
+   {
+      {
+         OpenThreads::ScopedLock<OpenThreads::Mutex> lock(gCacheMutex);
+         gMaxDirectorySize = bytes;
+      }
+      TrimDirectory();
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   unsigned long long CollisionCache::GetMaxDirectorySize()
+   {
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(gCacheMutex);
+      return gMaxDirectorySize;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   std::string CollisionCache::GetCacheFileName(const std::string& sourceFile, bool polytope)
+   {
+      std::string cacheFile;
+      BuildCacheKey(sourceFile, polytope, cacheFile);
+      return cacheFile;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   bool CollisionCache::LoadTriangleData(VertexData& triangleData, const std::string& sourceFile, bool polytope)
+   {
+      std::string cacheFile;
+      const std::string key = BuildCacheKey(sourceFile, polytope, cacheFile);
+      if (key.empty())
+      {
+         return CookTriangleData(triangleData, sourceFile, polytope);
+      }
+
+      if (dtUtil::FileUtils::GetInstance().FileExists(cacheFile) && ReadCacheFile(triangleData, cacheFile, key))
+      {
+         OpenThreads::ScopedLock<OpenThreads::Mutex> lock(gCacheMutex);
+         ++gCacheStats.mHits;
+         return true;
+      }
+
+      {
+         OpenThreads::ScopedLock<OpenThreads::Mutex> lock(gCacheMutex);
+         ++gCacheStats.mMisses;
+      }
+
+      if (!CookTriangleData(triangleData, sourceFile, polytope))
+      {
+         return false;
+      }
+
+      if (WriteCacheFile(triangleData, cacheFile, key))
+      {
+         {
+            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(gCacheMutex);
+            ++gCacheStats.mWrites;
+         }
+         TrimDirectory();
+      }
+      return true;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   bool CollisionCache::RequestLoad(const std::string& meshCacheKey, const std::string& sourceFile, bool polytope)
+   {
+      if (VertexData::FindCachedData(meshCacheKey).valid())
+      {
+         return false;
+      }
+
+      dtCore::RefPtr<CollisionCacheLoadTask> task = new CollisionCacheLoadTask(meshCacheKey, sourceFile, polytope);
+      {
+         OpenThreads::ScopedLock<OpenThreads::Mutex> lock(gCacheMutex);
+         if (!gPendingLoads.insert(std::make_pair(meshCacheKey, task)).second)
+         {
+            return false;
+         }
+      }
+
+      if (dtUtil::ThreadPool::IsInitialized())
+      {
+         dtUtil::ThreadPool::AddTask(*task, dtUtil::ThreadPool::IO);
+      }
+      else
+      {
+         (*task)();
+      }
+      return true;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void CollisionCache::WaitForLoad(const std::string& meshCacheKey)
+   {
+      dtCore::RefPtr<CollisionCacheLoadTask> task;
+      {
+         OpenThreads::ScopedLock<OpenThreads::Mutex> lock(gCacheMutex);
+         PendingLoadMap::iterator found = gPendingLoads.find(meshCacheKey);
+         if (found == gPendingLoads.end())
+         {
+            return;
+         }
+         task = found->second;
+      }
+      task->WaitUntilComplete();
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   CollisionCache::Stats CollisionCache::GetStats()
+   {
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(gCacheMutex);
+      return gCacheStats;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void CollisionCache::ResetStats()
+   {
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(gCacheMutex);
+      gCacheStats = Stats();
+   }
+}
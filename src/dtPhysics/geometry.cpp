@@ -31,25 +31,146 @@
 #include <dtUtil/exception.h>
 #include <dtUtil/mathdefines.h>
 
+#include <OpenThreads/Mutex>
+#include <OpenThreads/ScopedLock>
+
+#include <list>
+
 namespace dtPhysics
 {
    const std::string VertexData::NO_CACHE_KEY("");
 
+   /**
+    * The process wide index of loaded vertex data.  It is used from the loading threads as well as
+    * the main thread, so everything goes through the mutex.  Entries are kept in least recently used
+    * order so the oldest can be dropped once there are more than the configured maximum.
+    */
    class MeshCache
    {
    public:
-      typedef std::map<std::string, dtCore::RefPtr<VertexData> > MeshCacheContainerType;
+      typedef std::list<std::string> LRUListType;
+
+      struct Entry
+      {
+         dtCore::RefPtr<VertexData> mData;
+         LRUListType::iterator mLRUPosition;
+      };
+
+      typedef std::map<std::string, Entry> MeshCacheContainerType;
+
+      MeshCache()
+      : mMaxEntries(0U)
+      {
+      }
+
       ~MeshCache()
       {
          DeleteAll();
       }
 
+      dtCore::RefPtr<VertexData> Find(const std::string& key)
+      {
+         OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+         MeshCacheContainerType::iterator found = mMeshCacheMap.find(key);
+         if (found == mMeshCacheMap.end())
+         {
+            ++mStats.mMisses;
+            return NULL;
+         }
+         ++mStats.mHits;
+         mLRUList.splice(mLRUList.begin(), mLRUList, found->second.mLRUPosition);
+         return found->second.mData;
+      }
+
+      /// @return false if the key is already in the cache, in which case dataInOut is changed to the existing data.
+      bool Insert(const std::string& key, dtCore::RefPtr<VertexData>& dataInOut)
+      {
+         OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+         MeshCacheContainerType::iterator found = mMeshCacheMap.find(key);
+         if (found != mMeshCacheMap.end())
+         {
+            mLRUList.splice(mLRUList.begin(), mLRUList, found->second.mLRUPosition);
+            dataInOut = found->second.mData;
+            return false;
+         }
+
+         mLRUList.push_front(key);
+         Entry& entry = mMeshCacheMap[key];
+         entry.mData = dataInOut;
+         entry.mLRUPosition = mLRUList.begin();
+         EvictToMax();
+         return true;
+      }
+
+      bool Erase(const std::string& key)
+      {
+         OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+         MeshCacheContainerType::iterator found = mMeshCacheMap.find(key);
+         if (found == mMeshCacheMap.end())
+         {
+            return false;
+         }
+         mLRUList.erase(found->second.mLRUPosition);
+         mMeshCacheMap.erase(found);
+         return true;
+      }
+
       void DeleteAll()
       {
+         OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
          mMeshCacheMap.clear();
+         mLRUList.clear();
+      }
+
+      void SetMaxEntries(unsigned maxEntries)
+      {
+         OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+         mMaxEntries = maxEntries;
+         EvictToMax();
+      }
+
+      unsigned GetMaxEntries()
+      {
+         OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+         return mMaxEntries;
+      }
+
+      VertexData::CacheStats GetStats()
+      {
+         OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+         VertexData::CacheStats result = mStats;
+         result.mNumEntries = unsigned(mMeshCacheMap.size());
+         return result;
+      }
+
+      void ResetStats()
+      {
+         OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+         mStats = VertexData::CacheStats();
+      }
+
+   private:
+      /// Drops the least recently used entries until the cache fits.  The mutex must be held.
+      void EvictToMax()
+      {
+         if (mMaxEntries == 0U)
+         {
+            return;
+         }
+
+         while (mMeshCacheMap.size() > mMaxEntries)
+         {
+            mMeshCacheMap.erase(mLRUList.back());
+            mLRUList.pop_back();
+            ++mStats.mEvictions;
+         }
       }
 
+      OpenThreads::Mutex mMutex;
       MeshCacheContainerType mMeshCacheMap;
+      LRUListType mLRUList;
+      unsigned mMaxEntries;
+      VertexData::CacheStats mStats;
    };
 
    static MeshCache gMeshCache;
@@ -153,50 +274,34 @@ namespace dtPhysics
    ////////////////////////////////////////////////////////////
    bool VertexData::GetOrCreateCachedData(dtCore::RefPtr<VertexData>& dataOut, const std::string& key)
    {
-      bool result = false;
       dataOut = FindCachedData(key);
-      if (!dataOut.valid())
-      {
-         std::pair<MeshCache::MeshCacheContainerType::iterator, bool> insertResult = gMeshCache.mMeshCacheMap.insert(std::make_pair(key, new VertexData));
-         if (insertResult.second)
-         {
-            dataOut = insertResult.first->second;
-            result = true;
-         }
-         else
-         {
-            throw dtUtil::Exception(std::string("Attempted to create a cached data object that already exists even though the find failed: ") + key,
-                     __FILE__, __LINE__);
-         }
-      }
-      else
+      if (dataOut.valid())
       {
-         result = false;
+         return false;
       }
-      return result;
+
+      // Another thread may have added the key since the find, in which case its data is returned.
+      dataOut = new VertexData;
+      return gMeshCache.Insert(key, dataOut);
+   }
+
+   ////////////////////////////////////////////////////////////
+   bool VertexData::AddCachedData(const std::string& key, VertexData& data)
+   {
+      dtCore::RefPtr<VertexData> dataRef = &data;
+      return gMeshCache.Insert(key, dataRef);
    }
 
    ////////////////////////////////////////////////////////////
    dtCore::RefPtr<VertexData> VertexData::FindCachedData(const std::string& key)
    {
-      MeshCache::MeshCacheContainerType::iterator found = gMeshCache.mMeshCacheMap.find(key);
-      if (found != gMeshCache.mMeshCacheMap.end())
-      {
-         return found->second;
-      }
-      return NULL;
+      return gMeshCache.Find(key);
    }
 
    ////////////////////////////////////////////////////////////
    bool VertexData::ClearCachedData(const std::string& key)
    {
-      MeshCache::MeshCacheContainerType::iterator found = gMeshCache.mMeshCacheMap.find(key);
-      if (found != gMeshCache.mMeshCacheMap.end())
-      {
-         gMeshCache.mMeshCacheMap.erase(found);
-         return true;
-      }
-      return false;
+      return gMeshCache.Erase(key);
    }
 
    ////////////////////////////////////////////////////////////
@@ -205,6 +310,30 @@ namespace dtPhysics
       gMeshCache.DeleteAll();
    }
 
+   ////////////////////////////////////////////////////////////
+   void VertexData::SetMaxCachedData(unsigned maxEntries)
+   {
+      gMeshCache.SetMaxEntries(maxEntries);
+   }
+
+   ////////////////////////////////////////////////////////////
+   unsigned VertexData::GetMaxCachedData()
+   {
+      return gMeshCache.GetMaxEntries();
+   }
+
+   ////////////////////////////////////////////////////////////
+   VertexData::CacheStats VertexData::GetCacheStats()
+   {
+      return gMeshCache.GetStats();
+   }
+
+   ////////////////////////////////////////////////////////////
+   void VertexData::ResetCacheStats()
+   {
+      gMeshCache.ResetStats();
+   }
+
    ////////////////////////////////////////////////////////////
    void VertexData::SetMaterialName(dtPhysics::MaterialIndex matIndex, const std::string& materialName)
    {
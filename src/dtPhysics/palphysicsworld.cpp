@@ -37,6 +37,7 @@
 #include <dtUtil/mathdefines.h>
 #include <dtUtil/threadpool.h>
 #include <dtUtil/datapathutils.h>
+#include <dtUtil/profiler.h>
 
 #include <dtCore/system.h>
 #include <dtCore/observerptr.h>
@@ -582,6 +583,7 @@ namespace dtPhysics
    //////////////////////////////////////////////////////////////////////////
    void PhysicsWorld::UpdateStep(float elapsedTime)
    {
+      DT_PROFILE_ZONE("PhysicsWorld::UpdateStep");
       mImpl->UpdateStep(elapsedTime);
    }
 
@@ -633,6 +635,7 @@ namespace dtPhysics
    //////////////////////////////////////////////////////////////////////////
    void PhysicsWorld::WaitForUpdateStepToComplete() const
    {
+      DT_PROFILE_ZONE("PhysicsWorld::WaitForUpdateStepToComplete");
       if (mImpl->mBackgroundStepTask.valid())
       {
          if (!mImpl->mBackgroundStepTask->WaitUntilComplete(100000))
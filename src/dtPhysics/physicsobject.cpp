@@ -30,6 +30,7 @@
 #include <dtPhysics/physicsactcomp.h>
 #include <dtPhysics/palphysicsworld.h>
 #include <dtPhysics/bodywrapper.h>
+#include <dtPhysics/collisioncache.h>
 #include <dtPhysics/geometry.h>
 #include <dtPhysics/physicsreaderwriter.h>
 #include <dtGame/gameactor.h>
@@ -523,8 +524,6 @@ namespace dtPhysics
 
    }
 
-   static const std::string POLYTOPE_SUFFIX = "_Polytope";
-
    /////////////////////////////////////////////////////////////////////////////
    bool PhysicsObject::Create(const osg::Node* nodeToLoad, bool adjustOriginOffsetForGeometry,
          const std::string& cachingKey)
@@ -566,7 +565,7 @@ namespace dtPhysics
             if (nodeToLoad != nullptr)
             {
                bool polytope = GetPrimitiveType() == PrimitiveType::CONVEX_HULL;
-               VertexData::GetOrCreateCachedDataForNode(data, nodeToLoad, polytope && !cachingKey.empty() ? cachingKey + POLYTOPE_SUFFIX : cachingKey, polytope);
+               VertexData::GetOrCreateCachedDataForNode(data, nodeToLoad, polytope && !cachingKey.empty() ? cachingKey + CollisionCache::POLYTOPE_KEY_SUFFIX : cachingKey, polytope);
             }
             else
             {
@@ -593,16 +592,17 @@ namespace dtPhysics
 
       std::string fileToLoad;
 
-      bool dataNew = true;
-      if (cachingKey != VertexData::NO_CACHE_KEY)
+      std::string meshCacheKey = cachingKey != VertexData::NO_CACHE_KEY ? cachingKey : GetMeshResource().GetResourceIdentifier();
+      if (polytope)
       {
-         dataNew = VertexData::GetOrCreateCachedData(vertDataOut, polytope ? cachingKey + POLYTOPE_SUFFIX : cachingKey );
-      }
-      else
-      {
-         dataNew = VertexData::GetOrCreateCachedData(vertDataOut, polytope ? GetMeshResource().GetResourceIdentifier() + POLYTOPE_SUFFIX : GetMeshResource().GetResourceIdentifier() );
+         meshCacheKey += CollisionCache::POLYTOPE_KEY_SUFFIX;
       }
 
+      // The mesh may already be loading on the IO thread.
+      CollisionCache::WaitForLoad(meshCacheKey);
+
+      bool dataNew = VertexData::GetOrCreateCachedData(vertDataOut, meshCacheKey);
+
       if (dataNew)
       {
          // throw the exception
@@ -612,19 +612,15 @@ namespace dtPhysics
          {
             dtCore::RefPtr<VertexData> readerData = new VertexData;
 
-            if (dtPhysics::PhysicsReaderWriter::LoadTriangleDataFile(*readerData, fileToLoad))
+            // This also turns the data into a convex hull if needed.
+            if (CollisionCache::LoadTriangleData(*readerData, fileToLoad, polytope))
             {
-               dtCore::Transform geometryWorld;
-               GetTransform(geometryWorld);
-
                vertDataOut->Swap(*readerData);
-               if (polytope)
-               {
-                  vertDataOut->ConvertToPolytope();
-               }
             }
             else
             {
+               // Don't leave the empty data in the cache for the next object to find.
+               VertexData::ClearCachedData(meshCacheKey);
                vertDataOut = nullptr;
                throw dtUtil::Exception("Unable to load triangle data from existing file resource: "
                      + GetMeshResource().GetResourceIdentifier(), __FILE__, __LINE__);
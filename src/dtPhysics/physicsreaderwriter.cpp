@@ -66,6 +66,116 @@ namespace dtPhysics
 
 
 
+   //////////////////////////////////////////////////////////////////////////
+   /// Throws if a count read from a stream needs more bytes than are left, each item taking at least minItemSize.
+   static void CheckCount(const dtUtil::DataStream& ds, unsigned count, unsigned minItemSize, const std::string& filename)
+   {
+      if (count > ds.GetRemainingReadSize() / minItemSize)
+      {
+         throw dtCore::BaseException(
+            "Error reading Physics file '" + filename + "', a count is larger than the file.", __FILE__, __LINE__);
+      }
+   }
+
+   //////////////////////////////////////////////////////////////////////////
+   void PhysicsReaderWriter::ReadTriangleData(dtUtil::DataStream& ds, VertexData& triangleData, const std::string& filename)
+   {
+      char fileStart;
+      unsigned fileIdent, vMajor, vMinor;
+
+      ds >> fileStart >> fileIdent >> vMajor >> vMinor;
+
+      if(fileStart == PhysicsFileHeader::FILE_START_END_CHAR &&
+         fileIdent == PhysicsFileHeader::TRIANGLE_DATA_FILE_IDENT &&
+         vMajor == 1)
+      {
+
+         // Vertex Data
+         unsigned numVerts = 0;
+         unsigned numIndices = 0;
+         unsigned numMaterials = 0;
+
+         ds.Read(numVerts);
+         // A corrupt count must not reserve more than the stream could possibly hold.
+         CheckCount(ds, numVerts, sizeof(osg::Vec3), filename);
+         {
+            triangleData.mVertices.reserve(triangleData.mVertices.size() + numVerts);
+            for(unsigned i = 0; i < numVerts; ++i)
+            {
+               osg::Vec3 vert;
+               ds.Read(vert);
+               triangleData.mVertices.push_back(vert);
+            }
+         }
+
+         // Triangle Data
+         ds.Read(numIndices);
+         CheckCount(ds, numIndices, 1U, filename);
+         {
+            for(unsigned i = 0; i < numIndices; ++i)
+            {
+               unsigned face = 0;
+               ds.Read(face);
+               triangleData.mIndices.push_back(face);
+            }
+         }
+
+         // Material Data
+         ds.Read(numMaterials);
+         CheckCount(ds, numMaterials, 1U, filename);
+         {
+            for(unsigned i = 0; i < numMaterials; ++i)
+            {
+               unsigned materialID = 0;
+               ds.Read(materialID);
+               triangleData.mMaterialFlags.push_back(materialID);
+            }
+         }
+
+         // New material section data
+         // Check for old material data section
+         bool oldVersion = vMinor == 0;
+         if ( ! oldVersion)
+         {
+            unsigned numMaterialEntries = 0;
+            ds.Read(numMaterialEntries);
+            CheckCount(ds, numMaterialEntries, 1U, filename);
+
+            // Check for a material table (added in version 1.1).
+
+            // Material Data
+
+            for(unsigned i = 0; i < numMaterialEntries; ++i)
+            {
+               unsigned materialID = 0;
+               std::string materialName;
+
+               ds.Read(materialID);
+               ds.Read(materialName);
+
+               // Add actual material id-name pairs.
+               triangleData.SetMaterialName(materialID, materialName);
+            }
+         }
+
+      }
+      else
+      {
+         throw dtCore::BaseException(
+            "Error reading Physics file '" + filename + ".", __FILE__, __LINE__);
+      }
+
+
+      ds.Read(fileStart);
+      if(fileStart != PhysicsFileHeader::FILE_START_END_CHAR)
+      {
+         throw dtCore::BaseException(
+            "Error reading Physics file '" + filename + ".", __FILE__, __LINE__);
+      }
+   }
+
+
+
    /////////////////////////////////////////////////////////////////////////////
    // CLASS CODE
    /////////////////////////////////////////////////////////////////////////////
@@ -231,94 +341,7 @@ namespace dtPhysics
             infile.read(buffer, length);
 
             dtUtil::DataStream ds(buffer, length);
-
-            char fileStart;
-            unsigned fileIdent, vMajor, vMinor;
-
-            ds >> fileStart >> fileIdent >> vMajor >> vMinor;
-
-            if(fileStart == PhysicsFileHeader::FILE_START_END_CHAR &&
-               fileIdent == PhysicsFileHeader::TRIANGLE_DATA_FILE_IDENT &&
-               vMajor == 1)
-            {
-
-               // Vertex Data
-               unsigned numVerts = 0;
-               unsigned numIndices = 0;
-               unsigned numMaterials = 0;
-
-               ds.Read(numVerts);
-               {
-                  triangleData.mVertices.reserve(triangleData.mVertices.size() + numVerts);
-                  for(unsigned i = 0; i < numVerts; ++i)
-                  {
-                     osg::Vec3 vert;
-                     ds.Read(vert);
-                     triangleData.mVertices.push_back(vert);
-                  }
-               }
-
-               // Triangle Data
-               ds.Read(numIndices);
-               {
-                  for(unsigned i = 0; i < numIndices; ++i)
-                  {
-                     unsigned face = 0;
-                     ds.Read(face);
-                     triangleData.mIndices.push_back(face);
-                  }
-               }
-
-               // Material Data
-               ds.Read(numMaterials);
-               {
-                  for(unsigned i = 0; i < numMaterials; ++i)
-                  {
-                     unsigned materialID = 0;
-                     ds.Read(materialID);
-                     triangleData.mMaterialFlags.push_back(materialID);
-                  }
-               }
-
-               // New material section data
-               // Check for old material data section
-               bool oldVersion = vMinor == 0;
-               if ( ! oldVersion)
-               {
-                  unsigned numMaterialEntries = 0;
-                  ds.Read(numMaterialEntries);
-
-                  // Check for a material table (added in version 1.1).
-
-                  // Material Data
-
-                  for(unsigned i = 0; i < numMaterialEntries; ++i)
-                  {
-                     unsigned materialID = 0;
-                     std::string materialName;
-
-                     ds.Read(materialID);
-                     ds.Read(materialName);
-
-                     // Add actual material id-name pairs.
-                     triangleData.SetMaterialName(materialID, materialName);
-                  }
-               }
-
-            }
-            else
-            {
-               throw dtCore::BaseException(
-                  "Error reading Physics file '" + filename + ".", __FILE__, __LINE__);
-            }
-
-
-            ds.Read(fileStart);
-            if(fileStart != PhysicsFileHeader::FILE_START_END_CHAR)
-            {
-               throw dtCore::BaseException(
-                  "Error reading Physics file '" + filename + ".", __FILE__, __LINE__);
-            }
+            PhysicsReaderWriter::ReadTriangleData(ds, triangleData, filename);
 
             //read successful
             read_file_ok = true;
@@ -412,18 +435,8 @@ namespace dtPhysics
       return !triangleData.mVertices.empty();
    }
   
-   bool PhysicsReaderWriter::SaveTriangleDataFile(const VertexData& triangleData, const std::string& filename)
+   void PhysicsReaderWriter::WriteTriangleData(dtUtil::DataStream& ds, const VertexData& triangleData)
    {
-      std::ofstream outfile;
-
-      outfile.open(filename.c_str(), std::ios_base::binary | std::ofstream::out);
-      if (outfile.fail())
-      {
-         LOG_ERROR(std::string("Unable to open filename: ") + filename + std::string(" for writing"));
-         return false;
-      }
-
-      dtUtil::DataStream ds;
       ds.Write(PhysicsFileHeader::FILE_START_END_CHAR);
       ds.Write(PhysicsFileHeader::TRIANGLE_DATA_FILE_IDENT);
       ds.Write(PhysicsFileHeader::VERSION_MAJOR);
@@ -490,6 +503,21 @@ namespace dtPhysics
 
 
       ds.Write(PhysicsFileHeader::FILE_START_END_CHAR);
+   }
+
+   bool PhysicsReaderWriter::SaveTriangleDataFile(const VertexData& triangleData, const std::string& filename)
+   {
+      std::ofstream outfile;
+
+      outfile.open(filename.c_str(), std::ios_base::binary | std::ofstream::out);
+      if (outfile.fail())
+      {
+         LOG_ERROR(std::string("Unable to open filename: ") + filename + std::string(" for writing"));
+         return false;
+      }
+
+      dtUtil::DataStream ds;
+      WriteTriangleData(ds, triangleData);
       outfile.write(ds.GetBuffer(), ds.GetBufferSize());
       outfile.flush();
       outfile.close();
@@ -0,0 +1,132 @@
+/*
+* Delta3D Open Source Game and Simulation Engine
+* Copyright (C) 2005, BMH Associates, Inc.
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 2.1 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*/
+#include "dtTerrain/heightfieldpyramid.h"
+#include "dtTerrain/heightfield.h"
+
+#include <algorithm>
+
+namespace dtTerrain
+{
+   //////////////////////////////////////////////////////////////////////////
+   HeightFieldPyramid::HeightFieldPyramid()
+   {
+   }
+
+   //////////////////////////////////////////////////////////////////////////
+   HeightFieldPyramid::~HeightFieldPyramid()
+   {
+   }
+
+   //////////////////////////////////////////////////////////////////////////
+   void HeightFieldPyramid::Clear()
+   {
+      mLevels.clear();
+   }
+
+   //////////////////////////////////////////////////////////////////////////
+   void HeightFieldPyramid::Build(const HeightField &hf, unsigned int border)
+   {
+      Clear();
+
+      const short *data = hf.GetHeightFieldData();
+      const unsigned int numPostCols = hf.GetNumColumns();
+      const unsigned int numPostRows = hf.GetNumRows();
+      if (data == NULL || numPostCols < 2 || numPostRows < 2)
+         return;
+
+      const unsigned int numCols = numPostCols - 1;
+      const unsigned int numRows = numPostRows - 1;
+
+      //Level zero is built in two separable passes.  First each row of posts is
+      //reduced over the horizontal window of a cell plus its border, then those
+      //results are reduced over the vertical window.
+      std::vector<short> rowMin(numCols * numPostRows);
+      std::vector<short> rowMax(numCols * numPostRows);
+      unsigned int r, c;
+      for (r=0; r<numPostRows; r++)
+      {
+         const short *row = data + r*numPostCols;
+         for (c=0; c<numCols; c++)
+         {
+            unsigned int first = c > border ? c - border : 0;
+            unsigned int last = std::min(c + 1 + border, numPostCols - 1);
+            short lo = row[first], hi = row[first];
+            for (unsigned int i=first+1; i<=last; i++)
+            {
+               lo = std::min(lo,row[i]);
+               hi = std::max(hi,row[i]);
+            }
+            rowMin[c + r*numCols] = lo;
+            rowMax[c + r*numCols] = hi;
+         }
+      }
+
+      mLevels.push_back(Level());
+      Level *level = &mLevels.back();
+      level->mNumColumns = numCols;
+      level->mNumRows = numRows;
+      level->mMin.resize(numCols * numRows);
+      level->mMax.resize(numCols * numRows);
+      for (r=0; r<numRows; r++)
+      {
+         unsigned int first = r > border ? r - border : 0;
+         unsigned int last = std::min(r + 1 + border, numPostRows - 1);
+         for (c=0; c<numCols; c++)
+         {
+            short lo = rowMin[c + first*numCols], hi = rowMax[c + first*numCols];
+            for (unsigned int i=first+1; i<=last; i++)
+            {
+               lo = std::min(lo,rowMin[c + i*numCols]);
+               hi = std::max(hi,rowMax[c + i*numCols]);
+            }
+            level->mMin[c + r*numCols] = lo;
+            level->mMax[c + r*numCols] = hi;
+         }
+      }
+
+      //Each level above combines up to four nodes of the level below it.
+      while (level->mNumColumns > 1 || level->mNumRows > 1)
+      {
+         Level next;
+         next.mNumColumns = (level->mNumColumns + 1) / 2;
+         next.mNumRows = (level->mNumRows + 1) / 2;
+         next.mMin.resize(next.mNumColumns * next.mNumRows);
+         next.mMax.resize(next.mNumColumns * next.mNumRows);
+
+         for (r=0; r<next.mNumRows; r++)
+         {
+            unsigned int r0 = r*2, r1 = std::min(r*2 + 1, level->mNumRows - 1);
+            for (c=0; c<next.mNumColumns; c++)
+            {
+               unsigned int c0 = c*2, c1 = std::min(c*2 + 1, level->mNumColumns - 1);
+               const unsigned int w = level->mNumColumns;
+               next.mMin[c + r*next.mNumColumns] = std::min(
+                  std::min(level->mMin[c0 + r0*w], level->mMin[c1 + r0*w]),
+                  std::min(level->mMin[c0 + r1*w], level->mMin[c1 + r1*w]));
+               next.mMax[c + r*next.mNumColumns] = std::max(
+                  std::max(level->mMax[c0 + r0*w], level->mMax[c1 + r0*w]),
+                  std::max(level->mMax[c0 + r1*w], level->mMax[c1 + r1*w]));
+            }
+         }
+
+         mLevels.push_back(next);
+         level = &mLevels.back();
+      }
+   }
+}
@@ -35,6 +35,7 @@
 #include <osg/io_utils>
 #include <osgDB/WriteFile>
 #include <osgDB/ReadFile>
+#include <OpenThreads/ScopedLock>
 
 #include <dtUtil/fileutils.h>
 #include <dtUtil/datapathutils.h>
@@ -77,6 +78,7 @@ namespace dtTerrain
       mDetailMultiplier = 3.0f;
       mRenderWithFog = false;
       mUniformRenderWithFog = 0;
+      mRendererInitialized = false;
    }   
    
    //////////////////////////////////////////////////////////////////////////    
@@ -101,34 +103,26 @@ namespace dtTerrain
       //If this is the first time this renderer is loading a tile, make sure we
       //have compute the data the renderer needs which is shared amoungst all the
       //terrain tiles.
-      static bool firstTime = true;
-      if (firstTime)
-      {
-         InitializeRenderer();
-         firstTime = false;
-      }
+      EnsureRendererInitialized();
        
-      //Each tile gets its own drawable. So we need to construct it and
-      //add it to our drawable map.
+      //Each tile gets its own drawable. If the terrain prepared it in the
+      //background, just pick it up, otherwise build it now.
       DrawableEntry newEntry;                 
-      int baseSize = tile.GetHeightField()->GetNumColumns() - 1;
-      
-      double gridSpacing = GeoCoordinates::EQUATORIAL_RADIUS *
-         osg::DegreesToRadians(1.0);
-      
-      double horizRes;
-      int baseBits;
-      
-      baseBits = (int)(logf((float)baseSize) / logf(2.0f));    
-      horizRes = gridSpacing / (double)(1 << baseBits);
-      
-      newEntry.drawable = new SoarXDrawable(baseBits,(float)horizRes);
-      newEntry.drawable->SetThreshold(mThreshold);
-      newEntry.drawable->SetDetailMultiplier(mDetailMultiplier);
-      newEntry.drawable->SetDetailNoise(mDetailNoiseBits,
-         mDetailVerticalResolution,mDetailNoise);         
-      if (!newEntry.drawable->Build(tile))
-         tile.SetUpdateCache(true);
+      {
+         OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mPrepareMutex);
+         std::map<PagedTerrainTile*, DrawableEntry>::iterator prepared = mPreparedDrawables.find(&tile);
+         if (prepared != mPreparedDrawables.end())
+         {
+            newEntry = prepared->second;
+            mPreparedDrawables.erase(prepared);
+         }
+      }
+
+      if (!newEntry.drawable.valid())
+      {
+         newEntry.drawable = CreateDrawable(tile);
+         CheckBaseGradientCache(tile,newEntry);
+      }
       
       GeoCoordinates coords = tile.GetGeoCoordinates();
       osg::Geode *geode = new osg::Geode();
@@ -137,7 +131,6 @@ namespace dtTerrain
       osg::Vec3 origin = coords.GetCartesianPoint();
       newEntry.sceneNode->setMatrix(osg::Matrix::translate(origin));
            
-      CheckBaseGradientCache(tile,newEntry);
       SetupRenderState(tile,newEntry,*geode->getOrCreateStateSet());
       geode->addDrawable(newEntry.drawable.get());
       newEntry.sceneNode->addChild(geode);
@@ -146,9 +139,70 @@ namespace dtTerrain
       mDrawables.insert(std::make_pair(&tile,newEntry));     
    }
    
+   //////////////////////////////////////////////////////////////////////////
+   void SoarXTerrainRenderer::OnPrepareTerrainTile(PagedTerrainTile &tile)
+   {
+      if (tile.GetHeightField() == NULL)
+      {
+         throw dtTerrain::InvalidHeightfieldDataException(
+            "Cannot prepare terrain tile.  HeightField is NULL.", __FILE__, __LINE__);
+      }
+
+      EnsureRendererInitialized();
+
+      DrawableEntry entry;
+      entry.drawable = CreateDrawable(tile);
+      CheckBaseGradientCache(tile,entry);
+
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mPrepareMutex);
+      mPreparedDrawables[&tile] = entry;
+   }
+
+   //////////////////////////////////////////////////////////////////////////
+   dtCore::RefPtr<SoarXDrawable> SoarXTerrainRenderer::CreateDrawable(PagedTerrainTile &tile)
+   {
+      int baseSize = tile.GetHeightField()->GetNumColumns() - 1;
+      
+      double gridSpacing = GeoCoordinates::EQUATORIAL_RADIUS *
+         osg::DegreesToRadians(1.0);
+      
+      double horizRes;
+      int baseBits;
+      
+      baseBits = (int)(logf((float)baseSize) / logf(2.0f));    
+      horizRes = gridSpacing / (double)(1 << baseBits);
+      
+      dtCore::RefPtr<SoarXDrawable> drawable = new SoarXDrawable(baseBits,(float)horizRes);
+      drawable->SetThreshold(mThreshold);
+      drawable->SetDetailMultiplier(mDetailMultiplier);
+      drawable->SetDetailNoise(mDetailNoiseBits,
+         mDetailVerticalResolution,mDetailNoise);         
+      if (!drawable->Build(tile))
+         tile.SetUpdateCache(true);
+
+      return drawable;
+   }
+
+   //////////////////////////////////////////////////////////////////////////
+   void SoarXTerrainRenderer::EnsureRendererInitialized()
+   {
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mPrepareMutex);
+      if (!mRendererInitialized)
+      {
+         InitializeRenderer();
+         mRendererInitialized = true;
+      }
+   }
+
    //////////////////////////////////////////////////////////////////////////
    void SoarXTerrainRenderer::OnUnloadTerrainTile(PagedTerrainTile &tile)
    {
+      {
+         // A tile unloaded before it was attached may still have a prepared drawable.
+         OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mPrepareMutex);
+         mPreparedDrawables.erase(&tile);
+      }
+
       DrawableMap::iterator itor = mDrawables.find(&tile);
       if (itor != mDrawables.end())
       {
@@ -20,11 +20,17 @@
 */
 #include <osgDB/FileUtils>
 #include <osg/MatrixTransform>
+#include <osg/FrameStamp>
+#include <osg/Timer>
+#include <OpenThreads/ScopedLock>
+#include <OpenThreads/Condition>
 
 #include <dtCore/scene.h>
 #include <dtCore/system.h>
 #include <dtUtil/fileutils.h>
 #include <dtUtil/exception.h>
+#include <dtUtil/profiler.h>
+#include <dtUtil/threadpool.h>
 
 #include <dtTerrain/terrain.h>
 #include <dtTerrain/terraindatareader.h>
@@ -33,9 +39,11 @@
 #include <dtTerrain/vegetationdecorator.h>
 #include <dtTerrain/pagedterraintile.h>
 #include <dtTerrain/heightfield.h>
+#include <dtTerrain/heightfieldpyramid.h>
 
 #include <sstream>
 #include <algorithm>
+#include <deque>
 
 namespace dtTerrain 
 {
@@ -43,18 +51,220 @@ namespace dtTerrain
    //////////////////////////////////////////////////////////////////////////
    IMPLEMENT_MANAGEMENT_LAYER(Terrain);
 
+   namespace
+   {
+      ///Posts around each cell included in its line of sight bounds.  This covers the renderer
+      ///resampling the heightfield and the rounding of the sample positions.
+      const unsigned int LOS_PYRAMID_BORDER = 2;
+
+      ///Meters the ray must clear the bound of a pyramid node by before its samples are skipped.
+      const float LOS_HEIGHT_SLACK = 1.0f;
+
+      ///Pyramid nodes are grown by this many posts so rounding can't leave gaps between them.
+      const double LOS_GRID_EPSILON = 1e-3;
+
+      ///Fewest queries worth giving a thread in ComputeLinesOfSight.
+      const size_t MIN_QUERIES_PER_LOS_TASK = 16;
+
+      //////////////////////////////////////////////////////////////////////////
+      std::pair<int,int> GetTileKey(double latitude, double longitude)
+      {
+         return std::make_pair(int(floor(latitude)), int(floor(longitude)));
+      }
+
+      //////////////////////////////////////////////////////////////////////////
+      /**
+       * Walks the same samples as SimpleLineOfSight, in the same order, but only asks the
+       * renderer for the heights of the samples in the intervals it is told to check.
+       */
+      class LineOfSightSampler
+      {
+      public:
+         LineOfSightSampler(TerrainDataRenderer &renderer, const osg::Vec3 &start,
+            const osg::Vec3 &ray, float stepsize)
+         : mRenderer(renderer)
+         , mStart(start)
+         , mRay(ray)
+         , mStepSize(stepsize)
+         , mS(0.0)
+         {
+         }
+
+         /**
+          * Checks the samples in [tBegin,tEnd] that have not been passed yet.  Samples
+          * before tBegin are skipped.
+          * @return false if a sample is blocked.
+          */
+         bool Check(double tBegin, double tEnd)
+         {
+            while (mS < tBegin && mS < 1.0)
+               mS += mStepSize;
+
+            while (mS <= tEnd && mS < 1.0)
+            {
+               osg::Vec3 testPt = mStart + mRay*mS;
+               double h(mRenderer.GetHeight(testPt.x(), testPt.y()));
+               if (h >= testPt.z())
+               {
+                  mBlockingPoint.set(testPt.x(), testPt.y(), h);
+                  return false;
+               }
+               mS += mStepSize;
+            }
+            return true;
+         }
+
+         const osg::Vec3 &GetBlockingPoint() const { return mBlockingPoint; }
+
+      private:
+         TerrainDataRenderer &mRenderer;
+         osg::Vec3 mStart;
+         osg::Vec3 mRay;
+         float mStepSize;
+         double mS;
+         osg::Vec3 mBlockingPoint;
+      };
+
+      ///A ray in the post space of one tile.  Columns go east and rows go south.
+      struct GridRay
+      {
+         double mX, mDX;
+         double mY, mDY;
+         double mZ, mDZ;
+      };
+
+      //////////////////////////////////////////////////////////////////////////
+      bool ClipToSlab(double a, double da, double lo, double hi, double &t0, double &t1)
+      {
+         if (da == 0.0)
+            return a >= lo && a <= hi;
+
+         double ta = (lo - a) / da;
+         double tb = (hi - a) / da;
+         if (ta > tb)
+            std::swap(ta,tb);
+
+         t0 = std::max(t0,ta);
+         t1 = std::min(t1,tb);
+         return t0 <= t1;
+      }
+
+      //////////////////////////////////////////////////////////////////////////
+      bool ClipToNode(const HeightFieldPyramid &pyramid, unsigned int level,
+         unsigned int c, unsigned int r, const GridRay &ray, double &t0, double &t1)
+      {
+         double size = double(1u << level);
+         double x0 = c * size, x1 = std::min((c+1) * size, double(pyramid.GetNumColumns(0)));
+         double y0 = r * size, y1 = std::min((r+1) * size, double(pyramid.GetNumRows(0)));
+
+         return ClipToSlab(ray.mX, ray.mDX, x0 - LOS_GRID_EPSILON, x1 + LOS_GRID_EPSILON, t0, t1) &&
+            ClipToSlab(ray.mY, ray.mDY, y0 - LOS_GRID_EPSILON, y1 + LOS_GRID_EPSILON, t0, t1);
+      }
+
+      //////////////////////////////////////////////////////////////////////////
+      /**
+       * Walks the pyramid front to back along the ray.  Nodes the ray passes over with room
+       * to spare are skipped, and the samples inside the leaf cells that are left are checked.
+       * @return false if a sample is blocked.
+       */
+      bool TraversePyramid(const HeightFieldPyramid &pyramid, unsigned int level,
+         unsigned int c, unsigned int r, double t0, double t1, const GridRay &ray,
+         float margin, LineOfSightSampler &sampler)
+      {
+         if (!ClipToNode(pyramid,level,c,r,ray,t0,t1))
+            return true;
+
+         double zMin = std::min(ray.mZ + ray.mDZ*t0, ray.mZ + ray.mDZ*t1);
+         if (zMin > pyramid.GetMaxHeight(level,c,r) + margin)
+            return true;
+
+         if (level == 0)
+            return sampler.Check(t0,t1);
+
+         //Visit the children in the order the ray enters them.
+         std::pair<double,std::pair<unsigned int,unsigned int> > children[4];
+         unsigned int numChildren = 0;
+         for (unsigned int cr=r*2; cr<=r*2+1 && cr<pyramid.GetNumRows(level-1); cr++)
+         {
+            for (unsigned int cc=c*2; cc<=c*2+1 && cc<pyramid.GetNumColumns(level-1); cc++)
+            {
+               double enter = t0, exit = t1;
+               if (ClipToNode(pyramid,level-1,cc,cr,ray,enter,exit))
+                  children[numChildren++] = std::make_pair(enter,std::make_pair(cc,cr));
+            }
+         }
+         std::sort(children,children+numChildren);
+
+         for (unsigned int i=0; i<numChildren; i++)
+         {
+            if (!TraversePyramid(pyramid,level-1,children[i].second.first,children[i].second.second,
+               t0,t1,ray,margin,sampler))
+               return false;
+         }
+
+         return true;
+      }
+
+      //////////////////////////////////////////////////////////////////////////
+      void AddDegreeCrossings(double from, double to, std::vector<double> &splits)
+      {
+         if (from == to)
+            return;
+
+         int first = int(floor(std::min(from,to))) + 1;
+         int last = int(ceil(std::max(from,to))) - 1;
+         for (int degree=first; degree<=last; degree++)
+            splits.push_back((degree - from) / (to - from));
+      }
+
+      //////////////////////////////////////////////////////////////////////////
+      class LineOfSightTask : public dtUtil::ThreadPoolTask
+      {
+      public:
+         LineOfSightTask(Terrain &terrain, std::vector<LineOfSightQuery> &queries,
+            size_t begin, size_t end)
+         : mTerrain(terrain)
+         , mQueries(queries)
+         , mBegin(begin)
+         , mEnd(end)
+         {
+            SetName("Terrain Line Of Sight");
+         }
+
+         virtual void operator()()
+         {
+            for (size_t i = mBegin; i < mEnd; ++i)
+            {
+               LineOfSightQuery &query = mQueries[i];
+               query.mClear = mTerrain.IsClearLineOfSight(query.mStart,query.mEnd,
+                  query.mBlockingPoint);
+            }
+         }
+
+      private:
+         Terrain &mTerrain;
+         std::vector<LineOfSightQuery> &mQueries;
+         size_t mBegin, mEnd;
+      };
+   }
+
    //////////////////////////////////////////////////////////////////////////    
    class TerrainCullCallback : public osg::NodeCallback
    {
    public:
 
-      TerrainCullCallback(Terrain *terrain) : mTerrain(terrain) { }         
+      TerrainCullCallback(Terrain *terrain)
+      : mTerrain(terrain)
+      , mLastTime(0.0)
+      , mHasLastEye(false)
+      { }         
+
       virtual void operator()(osg::Node *node, osg::NodeVisitor *nv)
       {
          GeoCoordinates coords;
-         int i,j;
+         osg::Vec3 eye = nv->getEyePoint();
 
-         coords.SetCartesianPoint(nv->getEyePoint());
+         coords.SetCartesianPoint(eye);
 
          //Now that we have the location of the camera, figure out how many tiles to 
          //load.  The tiles to load are based on latitude and longitude for now.  A
@@ -62,13 +272,52 @@ namespace dtTerrain
          double bounds = (mTerrain->GetLoadDistance() / GeoCoordinates::EQUATORIAL_RADIUS) * 
             osg::RadiansToDegrees(1.0);
 
+         //First build a set of tiles that should be resident for this frame.
+         std::set<GeoCoordinates> residentTileLocations;
+         AddTilesAround(coords, bounds, residentTileLocations);
+
+         //Then project the camera forward by its velocity and prefetch the tiles
+         //around where it is headed.
+         std::set<GeoCoordinates> prefetchTileLocations;
+         const osg::FrameStamp* frameStamp = nv->getFrameStamp();
+         if (frameStamp != NULL)
+         {
+            double time = frameStamp->getReferenceTime();
+            if (mHasLastEye && time > mLastTime)
+            {
+               mVelocity = (eye - mLastEye) / float(time - mLastTime);
+            }
+
+            if (!mHasLastEye || time > mLastTime)
+            {
+               mLastEye = eye;
+               mLastTime = time;
+               mHasLastEye = true;
+            }
+
+            if (mTerrain->GetPrefetchTime() > 0.0f && mVelocity.length2() > 0.0f)
+            {
+               GeoCoordinates predicted;
+               predicted.SetCartesianPoint(eye + mVelocity * mTerrain->GetPrefetchTime());
+               AddTilesAround(predicted, bounds, prefetchTileLocations);
+            }
+         }
+
+         //Inform the terrain of the tile set that should be visible for this
+         //frame.
+         mTerrain->EnsureTileVisibility(residentTileLocations, prefetchTileLocations);  
+         traverse(node,nv);     
+      }
+
+   private:
+      void AddTilesAround(const GeoCoordinates& coords, double bounds, std::set<GeoCoordinates>& tiles)
+      {
+         int i,j;
          int minLat = (int)floor(coords.GetLatitude() - bounds);
          int maxLat = (int)ceil(coords.GetLatitude() + bounds);
          int minLon = (int)floor(coords.GetLongitude() - bounds);
          int maxLon = (int)ceil(coords.GetLongitude() + bounds);
 
-         //First build a set of tiles that should be resident for this frame.
-         std::set<GeoCoordinates> residentTileLocations;
          for (i=minLat; i<=maxLat; i++)
          {
             for (j=minLon; j<=maxLon; j++)
@@ -77,20 +326,160 @@ namespace dtTerrain
                resCoords.SetLatitude(i);
                resCoords.SetLongitude(j);
                resCoords.SetAltitude(0);
-               residentTileLocations.insert(resCoords);   
+               tiles.insert(resCoords);   
             }   
          }
-
-         //Inform the terrain of the tile set that should be visible for this
-         //frame.
-         mTerrain->EnsureTileVisibility(residentTileLocations);  
-         traverse(node,nv);     
       }
 
-   private:
       Terrain *mTerrain;
+      osg::Vec3 mLastEye;
+      osg::Vec3 mVelocity;
+      double mLastTime;
+      bool mHasLastEye;
    };   
 
+   //////////////////////////////////////////////////////////////////////////    
+   /**
+    * Runs the background stages of tile loading on the thread pool.  Tiles are processed one at a
+    * time in the order they were queued, so readers and decoration layers never see two tiles at once.
+    * The task is added to the pool again whenever it goes idle, so the pool's wait block may be
+    * released by the previous run; use WaitUntilIdle rather than WaitUntilComplete.
+    */
+   class TerrainTileLoadTask : public dtUtil::ThreadPoolTask
+   {
+   public:
+      typedef std::vector<dtCore::RefPtr<TerrainDecorationLayer> > LayerList;
+
+      struct Request
+      {
+         dtCore::RefPtr<PagedTerrainTile> mTile;
+         LayerList mLayers;
+      };
+
+      struct Result
+      {
+         Result(): mSuccess(false) {}
+         dtCore::RefPtr<PagedTerrainTile> mTile;
+         bool mSuccess;
+      };
+
+      TerrainTileLoadTask(Terrain& terrain)
+      : mTerrain(&terrain)
+      , mRunning(false)
+      {
+         SetName("Terrain Tile Load");
+      }
+
+      /**
+       * Queues a tile.
+       * @return true if the task was idle and must be added to the thread pool.
+       */
+      bool Add(PagedTerrainTile& tile, const LayerList& layers)
+      {
+         OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+         mPending.push_back(Request());
+         mPending.back().mTile = &tile;
+         mPending.back().mLayers = layers;
+         if (!mRunning)
+         {
+            mRunning = true;
+            return true;
+         }
+         return false;
+      }
+
+      bool PopResult(Result& result)
+      {
+         OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+         if (mResults.empty())
+         {
+            return false;
+         }
+         result = mResults.front();
+         mResults.pop_front();
+         return true;
+      }
+
+      /// Drops the tiles that haven't been started.
+      void ClearPending()
+      {
+         OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+         mPending.clear();
+      }
+
+      /**
+       * Removes a tile that hasn't been started.
+       * @return false if the tile is being prepared now or is already done.
+       */
+      bool Cancel(PagedTerrainTile& tile)
+      {
+         OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+         std::deque<Request>::iterator i, iend = mPending.end();
+         for (i = mPending.begin(); i != iend; ++i)
+         {
+            if (i->mTile.get() == &tile)
+            {
+               mPending.erase(i);
+               return true;
+            }
+         }
+         return false;
+      }
+
+      /**
+       * Blocks until the task has run out of tiles.  Returns early if the thread pool
+       * is shut down, since a task still sitting in its queue will then never run.
+       */
+      void WaitUntilIdle()
+      {
+         OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+         while (mRunning && dtUtil::ThreadPool::IsInitialized())
+         {
+            mIdleCondition.wait(&mMutex, 100);
+         }
+      }
+
+      bool IsRunning()
+      {
+         OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+         return mRunning;
+      }
+
+      virtual void operator()()
+      {
+         for (;;)
+         {
+            Request request;
+            {
+               OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+               if (mPending.empty())
+               {
+                  mRunning = false;
+                  mIdleCondition.broadcast();
+                  return;
+               }
+               request = mPending.front();
+               mPending.pop_front();
+            }
+
+            Result result;
+            result.mTile = request.mTile;
+            result.mSuccess = mTerrain->PrepareTerrainTile(*request.mTile, request.mLayers, true);
+
+            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+            mResults.push_back(result);
+         }
+      }
+
+   private:
+      Terrain* mTerrain;
+      OpenThreads::Mutex mMutex;
+      OpenThreads::Condition mIdleCondition;
+      std::deque<Request> mPending;
+      std::deque<Result> mResults;
+      bool mRunning;
+   };
+
    //////////////////////////////////////////////////////////////////////////
    Terrain::Terrain(const std::string &name)
    {
@@ -101,6 +490,10 @@ namespace dtTerrain
       dtCore::System::GetInstance().TickSignal.connect_slot(this, &Terrain::OnSystem);
 
       SetLineOfSightSpacing(25.0f); // a bit less than DTED L2
+
+      mAsyncTileLoading = false;
+      mTileAttachBudgetMS = 4.0;
+      mPrefetchTime = 2.0f;
    }
 
    //////////////////////////////////////////////////////////////////////////
@@ -109,6 +502,19 @@ namespace dtTerrain
       //Be sure to clear the resident list of tiles, moving them to the
       //unload queue so they can be safely unloaded and then flush the queue.
       LOG_INFO("Cleaning up and flushing the tile unload queue.");
+
+      //Stop the background loading first so no tile is still in flight.
+      if (mLoadTask.valid())
+      {
+         mLoadTask->ClearPending();
+         mLoadTask->WaitUntilIdle();
+
+         TerrainTileLoadTask::Result result;
+         while (mLoadTask->PopResult(result)) {}
+      }
+      mTilesInFlight.clear();
+      mTilesCancelled.clear();
+
       UnloadAllTerrainTiles();
       PostFrame(-1.0);      
       DeregisterInstance(this);
@@ -128,8 +534,141 @@ namespace dtTerrain
    bool Terrain::IsClearLineOfSight( const osg::Vec3& pointOne,
                                      const osg::Vec3& pointTwo )
    {
-      // Would be nice to have a functor instead of very simple built-in
-      return SimpleLineOfSight(this, pointOne, pointTwo);
+      osg::Vec3 blockingPoint;
+      return IsClearLineOfSight(pointOne, pointTwo, blockingPoint);
+   }
+
+   ////////////////////////////////////////////////////////////////////////// 
+   bool Terrain::IsClearLineOfSight( const osg::Vec3& pointOne,
+                                     const osg::Vec3& pointTwo,
+                                     osg::Vec3& blockingPoint )
+   {
+      osg::Vec3 ray = pointTwo - pointOne;
+      double length( ray.length() );
+      // If closer than post spacing, then clear LOS
+      if( length < GetLineOfSightSpacing() )
+      {
+         return true;
+      }
+
+      if (!mDataRenderer.valid())
+         throw dtTerrain::InvalidDataRendererException(
+         "Cannot compute the line of sight.", __FILE__, __LINE__);
+
+      float stepsize( GetLineOfSightSpacing() / length );
+      LineOfSightSampler sampler(*mDataRenderer, pointOne, ray, stepsize);
+
+      float margin = mDataRenderer->GetHeightFieldMargin();
+      if (margin < 0.0f || mLOSPyramids.empty())
+      {
+         if (sampler.Check(0.0, 1.0))
+            return true;
+
+         blockingPoint = sampler.GetBlockingPoint();
+         return false;
+      }
+      margin += LOS_HEIGHT_SLACK;
+
+      //Each tile covers one square degree, so split the ray where it crosses a
+      //whole degree of latitude or longitude.  Both are linear along the ray.
+      GeoCoordinates startCoords, endCoords;
+      startCoords.SetCartesianPoint(pointOne);
+      endCoords.SetCartesianPoint(pointTwo);
+      const double lat0 = startCoords.GetLatitude(), dLat = endCoords.GetLatitude() - lat0;
+      const double lon0 = startCoords.GetLongitude(), dLon = endCoords.GetLongitude() - lon0;
+
+      std::vector<double> splits;
+      splits.push_back(0.0);
+      AddDegreeCrossings(lat0, lat0 + dLat, splits);
+      AddDegreeCrossings(lon0, lon0 + dLon, splits);
+      std::sort(splits.begin(), splits.end());
+      splits.push_back(1.0);
+
+      //The renderer may use the neighboring tile for samples right at a tile edge,
+      //so the first and last meter of each piece are always sampled.
+      const double edge = 1.0 / length;
+      const double tileSize = GeoCoordinates::EQUATORIAL_RADIUS * osg::DegreesToRadians(1.0);
+
+      for (unsigned int i=0; i+1<splits.size(); i++)
+      {
+         double ta = splits[i], tb = splits[i+1];
+         double tm = (ta + tb) * 0.5;
+         PyramidMap::const_iterator found = mLOSPyramids.find(
+            GetTileKey(lat0 + dLat*tm, lon0 + dLon*tm));
+
+         if (found == mLOSPyramids.end() || found->second->GetNumLevels() == 0)
+         {
+            if (!sampler.Check(ta, tb))
+            {
+               blockingPoint = sampler.GetBlockingPoint();
+               return false;
+            }
+            continue;
+         }
+
+         const HeightFieldPyramid &pyramid = *found->second;
+         GeoCoordinates origin;
+         origin.SetLatitude(found->first.first);
+         origin.SetLongitude(found->first.second);
+         origin.SetAltitude(0);
+         const osg::Vec3 &originPoint = origin.GetCartesianPoint();
+
+         double xScale = pyramid.GetNumColumns(0) / tileSize;
+         double yScale = pyramid.GetNumRows(0) / tileSize;
+         GridRay gridRay;
+         gridRay.mX = (double(pointOne.x()) - originPoint.x()) * xScale;
+         gridRay.mDX = double(ray.x()) * xScale;
+         gridRay.mY = pyramid.GetNumRows(0) - (double(pointOne.y()) - originPoint.y()) * yScale;
+         gridRay.mDY = -double(ray.y()) * yScale;
+         gridRay.mZ = pointOne.z();
+         gridRay.mDZ = ray.z();
+
+         if (!sampler.Check(ta, ta + edge) ||
+            !TraversePyramid(pyramid, pyramid.GetNumLevels() - 1, 0, 0, ta + edge, tb - edge,
+               gridRay, margin, sampler) ||
+            !sampler.Check(tb - edge, tb))
+         {
+            blockingPoint = sampler.GetBlockingPoint();
+            return false;
+         }
+      }
+
+      return true;
+   }
+
+   ////////////////////////////////////////////////////////////////////////// 
+   void Terrain::ComputeLinesOfSight(std::vector<LineOfSightQuery> &queries)
+   {
+      if (!mDataRenderer.valid())
+         throw dtTerrain::InvalidDataRendererException(
+         "Cannot compute the lines of sight.", __FILE__, __LINE__);
+
+      size_t numTasks = 1;
+      if (mDataRenderer->IsGetHeightThreadSafe() && dtUtil::ThreadPool::IsInitialized())
+      {
+         numTasks = std::min(size_t(dtUtil::ThreadPool::GetNumImmediateWorkerThreads()),
+            queries.size() / MIN_QUERIES_PER_LOS_TASK);
+      }
+
+      if (numTasks > 1)
+      {
+         std::vector<dtCore::RefPtr<LineOfSightTask> > tasks;
+         size_t perTask = (queries.size() + numTasks - 1) / numTasks;
+         for (size_t begin = 0; begin < queries.size(); begin += perTask)
+         {
+            size_t end = std::min(begin + perTask, queries.size());
+            tasks.push_back(new LineOfSightTask(*this, queries, begin, end));
+            dtUtil::ThreadPool::AddTask(*tasks.back());
+         }
+         dtUtil::ThreadPool::ExecuteTasks();
+      }
+      else
+      {
+         for (std::vector<LineOfSightQuery>::iterator i = queries.begin(); i != queries.end(); ++i)
+         {
+            i->mClear = IsClearLineOfSight(i->mStart, i->mEnd, i->mBlockingPoint);
+         }
+      }
    }
 
    //////////////////////////////////////////////////////////////////////////
@@ -312,6 +851,13 @@ namespace dtTerrain
 
    //////////////////////////////////////////////////////////////////////////
    void Terrain::EnsureTileVisibility(const std::set<GeoCoordinates> &coordList)
+   {
+      EnsureTileVisibility(coordList, std::set<GeoCoordinates>());
+   }
+
+   //////////////////////////////////////////////////////////////////////////
+   void Terrain::EnsureTileVisibility(const std::set<GeoCoordinates> &coordList,
+      const std::set<GeoCoordinates> &prefetchList)
    {
       //This is a two pass operation.  First we need to unload the tiles that
       //are visible but shouldn't be.  Second, we need to load the tiles that
@@ -322,12 +868,13 @@ namespace dtTerrain
       std::vector<dtCore::RefPtr<PagedTerrainTile> >::iterator resultItor;
 
       //Loop through the currently visible set of tiles, if there is a tile not 
-      //in the newly specified list, unload it.      
+      //in the newly specified lists, unload it.      
       resItor = mResidentTiles.begin();
       while (resItor != mResidentTiles.end())
       {
-         if (!std::binary_search(coordList.begin(),coordList.end(),
-            resItor->second->GetGeoCoordinates()))
+         const GeoCoordinates& coords = resItor->second->GetGeoCoordinates();
+         if (coordList.find(coords) == coordList.end() &&
+            prefetchList.find(coords) == prefetchList.end())
          {
             result.push_back(resItor->second);
          }       
@@ -339,14 +886,20 @@ namespace dtTerrain
          UnloadTerrainTile(*resultItor->get());
 
       //Now we need to make sure all tiles from the requested visible set
-      //that are not currently loaded are put in the load queue.
-      for (visItor=coordList.begin(); visItor!=coordList.end(); ++visItor)
+      //that are not currently loaded are put in the load queue, followed
+      //by the prefetch tiles.
+      const std::set<GeoCoordinates>* lists[2] = { &coordList, &prefetchList };
+      for (unsigned i = 0; i < 2; ++i)
       {
-         resItor = mResidentTiles.find(*visItor);
-         if (resItor == mResidentTiles.end())
+         for (visItor=lists[i]->begin(); visItor!=lists[i]->end(); ++visItor)
          {
-            PagedTerrainTile *newTile = CreateTerrainTile(*visItor);
-            LoadTerrainTile(*newTile);
+            resItor = mResidentTiles.find(*visItor);
+            if (resItor == mResidentTiles.end())
+            {
+               PagedTerrainTile *newTile = CreateTerrainTile(*visItor);
+               if (newTile != NULL)
+                  LoadTerrainTile(*newTile);
+            }
          }
       }
    }
@@ -365,6 +918,8 @@ namespace dtTerrain
    //////////////////////////////////////////////////////////////////////////
    void Terrain::PreFrame(double frameTime)
    {      
+      DT_PROFILE_ZONE("Terrain::PreFrame");
+
       //To flush the load queue, we pass the terrain tile through four
       //stages.  Exception handling is done on a per stage basis.  Therefore,
       //failure on one stage does not mean the tile will not load.  The only 
@@ -381,132 +936,277 @@ namespace dtTerrain
          throw dtTerrain::InvalidDataRendererException(
          "Cannot flush the terrain tile load queue.  The terrain renderer is not valid.", __FILE__, __LINE__);
 
-      while (!mTilesToLoadQ.empty())      
+      if (!mAsyncTileLoading || !dtUtil::ThreadPool::IsInitialized())
+      {
+         std::vector<dtCore::RefPtr<TerrainDecorationLayer> > noLayers;
+         while (!mTilesToLoadQ.empty())      
+         {
+            dtCore::RefPtr<PagedTerrainTile> currTile = mTilesToLoadQ.front();
+            mTilesToLoadQ.pop();
+
+            if (PrepareTerrainTile(*currTile, noLayers, false))
+            {
+               AttachTerrainTile(*currTile, false);
+            }
+         }
+         return;
+      }
+
+      if (!mLoadTask.valid())
+      {
+         mLoadTask = new TerrainTileLoadTask(*this);
+      }
+
+      //Hand the queued tiles to the paging thread along with the layers that
+      //may load on it.
+      if (!mTilesToLoadQ.empty())
+      {
+         TerrainTileLoadTask::LayerList threadSafeLayers;
+         TerrainLayerMap::iterator layerItor;
+         for (layerItor=mDecorationLayers.begin(); layerItor!=mDecorationLayers.end(); 
+            ++layerItor)
+         {
+            if (layerItor->second->IsLoadThreadSafe())
+               threadSafeLayers.push_back(layerItor->second);
+         }
+
+         bool startTask = false;
+         while (!mTilesToLoadQ.empty())
+         {
+            PagedTerrainTile *currTile = mTilesToLoadQ.front().get();
+            mTilesInFlight.insert(currTile);
+            startTask = mLoadTask->Add(*currTile, threadSafeLayers) || startTask;
+            mTilesToLoadQ.pop();
+         }
+
+         if (startTask)
+         {
+            dtUtil::ThreadPool::AddTask(*mLoadTask, dtUtil::ThreadPool::IO);
+         }
+      }
+
+      //Attach the tiles that finished loading, within the frame budget.  At
+      //least one is attached each frame so paging always makes progress.
+      osg::Timer* timer = osg::Timer::instance();
+      osg::Timer_t startTick = timer->tick();
+      TerrainTileLoadTask::Result result;
+      bool first = true;
+      while ((first || timer->delta_m(startTick, timer->tick()) < mTileAttachBudgetMS)
+         && mLoadTask->PopResult(result))
       {
-         PagedTerrainTile *currTile = mTilesToLoadQ.front().get();
+         first = false;
+         mTilesInFlight.erase(result.mTile.get());
+         if (mTilesCancelled.erase(result.mTile.get()) > 0)
+         {
+            //Unloaded while it was being prepared, so only the unload stages are left.
+            mTilesToUnloadQ.push(result.mTile);
+         }
+         else if (result.mSuccess)
+         {
+            AttachTerrainTile(*result.mTile, true);
+         }
+      }
+
+      DT_PROFILE_COUNTER("Terrain Tiles Loading", GetNumTilesLoading());
+   }
+
+   //////////////////////////////////////////////////////////////////////////
+   bool Terrain::PrepareTerrainTile(PagedTerrainTile &tile,
+      const std::vector<dtCore::RefPtr<TerrainDecorationLayer> > &layers, bool prepareRenderer)
+   {
+      DT_PROFILE_ZONE("Terrain::PrepareTerrainTile");
+      PagedTerrainTile *currTile = &tile;
 
-         //Create a cache path for the tile being loaded if it does not already
-         //exist.
-         if (!mCachePath.empty())
+      //Create a cache path for the tile being loaded if it does not already
+      //exist.
+      if (!mCachePath.empty())
+      {
+         std::string tilePath;
          {
-            std::string tilePath = mCachePath + "/" + "tile_" + 
+            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mReaderMutex);
+            tilePath = mCachePath + "/" + "tile_" + 
                mDataReader->GenerateTerrainTileCachePath(*currTile);
+         }
 
-            //Now that we generated a tile's cache path, make sure it exists.  If it does
-            //not go ahead and create it.
-            if (!dtUtil::FileUtils::GetInstance().DirExists(tilePath))
+         //Now that we generated a tile's cache path, make sure it exists.  If it does
+         //not go ahead and create it.
+         if (!dtUtil::FileUtils::GetInstance().DirExists(tilePath))
+         {
+            try 
             {
-               try 
-               {
-                  dtUtil::FileUtils::GetInstance().MakeDirectory(tilePath);
-                  currTile->SetCachePath(tilePath);                  
-               }
-               catch (dtUtil::Exception &ex)
-               {
-                  ex.LogException(dtUtil::Log::LOG_ERROR);
-               }
+               dtUtil::FileUtils::GetInstance().MakeDirectory(tilePath);
+               currTile->SetCachePath(tilePath);                  
             }
-            else
+            catch (dtUtil::Exception &ex)
             {
-               currTile->SetCachePath(tilePath);
+               ex.LogException(dtUtil::Log::LOG_ERROR);
             }
          }
          else
          {
-            currTile->SetCachePath("");
+            currTile->SetCachePath(tilePath);
          }
+      }
+      else
+      {
+         currTile->SetCachePath("");
+      }
+
+      //First, we tell the tile to load any tile specific data from its cache.
+      //This is to allow subclassed terrain tiles to cache and restore application
+      //specific data.  Note, the base paged tile implementation of this method
+      //will load any basic data from its cache if present.
+      try
+      {
+         currTile->ReadFromCache();
+
+         //When the tile is first loaded its contents are in sync with its cache.
+         //This should be set to "true" by either an external class if any tile
+         //related data needs to be updated in the cache.
+         currTile->SetUpdateCache(false);
+      }
+      catch (dtUtil::Exception &ex)
+      {
+         LOG_ERROR("Error loading terrain tile. (RestoreFromCache): " + ex.What());
+      }
+
+      //Second, tell the terrain reader we need to load the tile.
+      try
+      {
+         OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mReaderMutex);
+         if (!mDataReader->OnLoadTerrainTile(*currTile))
+         {
+            return false;
+         }
+      }
+      catch (dtUtil::Exception &ex)
+      {
+         ex.What();
+         //The responsibility of error reporting is left up to the terrain 
+         //reader in this case as to avoid too many redundant error messages.
+         return false;
+      }       
 
-         //First, we tell the tile to load any tile specific data from its cache.
-         //This is to allow subclassed terrain tiles to cache and restore application
-         //specific data.  Note, the base paged tile implementation of this method
-         //will load any basic data from its cache if present.
+      //Build the line of sight bounds of the tile while we are off the main thread.
+      if (currTile->GetHeightField() != NULL && mDataRenderer->GetHeightFieldMargin() >= 0.0f)
+      {
+         dtCore::RefPtr<HeightFieldPyramid> pyramid = new HeightFieldPyramid();
+         pyramid->Build(*currTile->GetHeightField(), LOS_PYRAMID_BORDER);
+
+         OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mPyramidMutex);
+         mPreparedPyramids[currTile] = pyramid;
+      }
+
+      //Third, the decorator layers that are safe to run here load or create
+      //data relating to the tile.
+      std::vector<dtCore::RefPtr<TerrainDecorationLayer> >::const_iterator layerItor;
+      for (layerItor=layers.begin(); layerItor!=layers.end(); ++layerItor)
+      {
          try
          {
-            currTile->ReadFromCache();
+            (*layerItor)->OnLoadTerrainTile(*currTile);   
+         }
+         catch (dtUtil::Exception &ex)
+         {
+            LOG_ERROR("Error loading tile in decoration layer. (" + (*layerItor)->GetName()
+               + "):  " + ex.What());
+         }  
+      }  
 
-            //When the tile is first loaded its contents are in sync with its cache.
-            //This should be set to "true" by either an external class if any tile
-            //related data needs to be updated in the cache.
-            currTile->SetUpdateCache(false);
+      //Finally let the renderer do its preprocessing.
+      if (prepareRenderer)
+      {
+         try
+         {
+            mDataRenderer->OnPrepareTerrainTile(*currTile);
          }
          catch (dtUtil::Exception &ex)
          {
-            LOG_ERROR("Error loading terrain tile. (RestoreFromCache): " + ex.What());
+            LOG_ERROR("Error preparing terrain tile. (TerrainRenderer): " + ex.What());
          }
+      }
+
+      return true;
+   }
+
+   //////////////////////////////////////////////////////////////////////////
+   void Terrain::AttachTerrainTile(PagedTerrainTile &tile, bool skipThreadSafeLayers)
+   {
+      DT_PROFILE_ZONE("Terrain::AttachTerrainTile");
+      PagedTerrainTile *currTile = &tile;
+
+      //We pass the terrain tile to each of the decorator
+      //layers so they may load or create data relating to the tile.
+      TerrainLayerMap::iterator layerItor;
+      for (layerItor=mDecorationLayers.begin(); layerItor!=mDecorationLayers.end(); 
+         ++layerItor)
+      {
+         if (skipThreadSafeLayers && layerItor->second->IsLoadThreadSafe())
+            continue;
 
-         //Second, tell the terrain reader we need to load the tile.
          try
          {
-            if (!mDataReader->OnLoadTerrainTile(*currTile))
-            {
-               mTilesToLoadQ.pop();
-               continue;
-            }
+            layerItor->second->OnLoadTerrainTile(*currTile);   
          }
          catch (dtUtil::Exception &ex)
          {
-            ex.What();
-            //The responsibility of error reporting is left up to the terrain 
-            //reader in this case as to avoid too many redundant error messages.
-            mTilesToLoadQ.pop();
-            continue;          
-         }       
+            LOG_ERROR("Error loading tile in decoration layer. (" + layerItor->first
+               + "):  " + ex.What());
+         }  
+      }  
 
-         //Third, we pass the terrain tile to each of the decorator
-         //layers so they may load or create data relating to the tile.
-         TerrainLayerMap::iterator layerItor;
-         for (layerItor=mDecorationLayers.begin(); layerItor!=mDecorationLayers.end(); 
-            ++layerItor)
+      //Then, we tell the terrain renderer to load the tile.  This gives the
+      //renderer a chance to generate, preprocess, or do any data loading
+      //it needs for an individual tile.
+      bool rendered = false;
+      try
+      {
+         mDataRenderer->OnLoadTerrainTile(*currTile);
+         rendered = true;
+      }
+      catch (dtUtil::Exception &ex)
+      {
+         LOG_ERROR("Error loading terrain tile. (TerrainRenderer): " + ex.What());
+      }         
+
+      //Line of sight may only use the tile's bounds once the renderer has the tile.
+      {
+         OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mPyramidMutex);
+         std::map<PagedTerrainTile*,dtCore::RefPtr<HeightFieldPyramid> >::iterator found =
+            mPreparedPyramids.find(currTile);
+         if (found != mPreparedPyramids.end())
          {
-            try
+            if (rendered)
             {
-               layerItor->second->OnLoadTerrainTile(*currTile);   
+               const GeoCoordinates &coords = currTile->GetGeoCoordinates();
+               mLOSPyramids[GetTileKey(coords.GetLatitude(),coords.GetLongitude())] = found->second;
             }
-            catch (dtUtil::Exception &ex)
-            {
-               LOG_ERROR("Error loading tile in decoration layer. (" + layerItor->first
-                  + "):  " + ex.What());
-            }  
-         }  
+            mPreparedPyramids.erase(found);
+         }
+      }
 
-         //Finally, we tell the terrain renderer to load the tile.  This gives the
-         //renderer a chance to generate, preprocess, or do any data loading
-         //it needs for an individual tile.
+      //Need to make one final pass over all the decorators in case they need to 
+      //perform any post tile loading operations.
+      for (layerItor=mDecorationLayers.begin(); layerItor!=mDecorationLayers.end(); 
+         ++layerItor)
+      {
          try
          {
-            mDataRenderer->OnLoadTerrainTile(*currTile);
+            layerItor->second->OnTerrainTileResident(*currTile);   
          }
          catch (dtUtil::Exception &ex)
          {
-            LOG_ERROR("Error loading terrain tile. (TerrainRenderer): " + ex.What());
-         }         
-
-         //Need to make one final pass over all the decorators in case they need to 
-         //perform any post tile loading operations.
-         for (layerItor=mDecorationLayers.begin(); layerItor!=mDecorationLayers.end(); 
-            ++layerItor)
-         {
-            try
-            {
-               /*GeoCoordinates c =*/ currTile->GetGeoCoordinates();
-               layerItor->second->OnTerrainTileResident(*currTile);   
-            }
-            catch (dtUtil::Exception &ex)
-            {
-               LOG_ERROR("Error processing tile in decoration layer. (" + layerItor->first
-                  + "):  " + ex.What());
-            }  
+            LOG_ERROR("Error processing tile in decoration layer. (" + layerItor->first
+               + "):  " + ex.What());
          }  
-
-         //Now once we have finished loading a tile, remove it from the load queue,
-         //and add it to the lisbt of loaded and resident tiles.
-         mTilesToLoadQ.pop();
-      }     
+      }  
    }
 
    //////////////////////////////////////////////////////////////////////////
    void Terrain::PostFrame(double frameTime)
    {
+      DT_PROFILE_ZONE("Terrain::PostFrame");
+
       //In the same way we passed tiles through different stages to load them,
       //we conversly pass them through the same stages to unload them.  This 
       //allows each stage to possibly cache data before unloading and perform
@@ -521,8 +1221,26 @@ namespace dtTerrain
 
       while (!mTilesToUnloadQ.empty())
       {
-         LOG_INFO("UnLoading new terrain tile.");
          PagedTerrainTile *currTile = mTilesToUnloadQ.front().get();
+         if (mTilesInFlight.find(currTile) != mTilesInFlight.end())
+         {
+            //A tile the paging thread hasn't started is simply dropped.  One it is preparing
+            //right now is never attached; it comes back here once its result arrives.
+            if (mLoadTask.valid() && mLoadTask->Cancel(*currTile))
+            {
+               mTilesInFlight.erase(currTile);
+               OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mPyramidMutex);
+               mPreparedPyramids.erase(currTile);
+            }
+            else
+            {
+               mTilesCancelled.insert(currTile);
+            }
+            mTilesToUnloadQ.pop();
+            continue;
+         }
+
+         LOG_INFO("UnLoading new terrain tile.");
 
          //First, we tell the tile to unload any tile specific data to its cache.
          //This is to allow subclassed terrain tiles to save and restore application
@@ -540,6 +1258,7 @@ namespace dtTerrain
          //Second, inform the terrain reader that a tile is being unloaded.
          try
          {
+            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mReaderMutex);
             mDataReader->OnUnloadTerrainTile(*currTile);
          }
          catch (dtUtil::Exception &ex)
@@ -564,6 +1283,18 @@ namespace dtTerrain
             }  
          }       
 
+         //Stop using the tile for line of sight, unless a newer tile has already
+         //replaced it.
+         {
+            const GeoCoordinates &coords = currTile->GetGeoCoordinates();
+            TerrainTileMap::iterator resident = mResidentTiles.find(coords);
+            if (resident == mResidentTiles.end() || resident->second.get() == currTile)
+               mLOSPyramids.erase(GetTileKey(coords.GetLatitude(),coords.GetLongitude()));
+
+            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mPyramidMutex);
+            mPreparedPyramids.erase(currTile);
+         }
+
          //Finally, we tell the terrain renderer to unload the tile.  This gives the
          //renderer a chance to save off any data it does not want to pregenerate
          //every time a tile is loaded.
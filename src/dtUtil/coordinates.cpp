@@ -2,6 +2,7 @@
 #include <cmath>
 #include <cstdio>
 #include <cfloat>
+#include <algorithm>
 
 #include <dtUtil/matrixutil.h>
 #include <dtUtil/coordinates.h>
@@ -11,6 +12,256 @@
 
 namespace dtUtil
 {
+   namespace
+   {
+      /////////////////////////////////////////////////////////////////////////////
+      void CalcUTMZoneParameters(UTMParameters& params, unsigned zone, char hemisphere)
+      {
+         double Origin_Latitude = 0.0;
+         double Central_Meridian = 0.0;
+         double False_Easting = 500000;
+         double False_Northing = 0;
+
+         if (zone >= 31)
+         {
+            Central_Meridian = osg::DegreesToRadians(double(6 * zone - 183));
+         }
+         else
+         {
+            Central_Meridian = osg::DegreesToRadians(double(6 * zone + 177));
+         }
+
+         // If we are projecting in the southern hemisphere, set the false northing.
+         if (hemisphere == 'S' || hemisphere == 's')
+         {
+            False_Northing = 10000000;
+         }
+
+         params.CalcTransverseMercatorParameters(Geocent_a, Geocent_f, Origin_Latitude,
+                                         Central_Meridian, False_Easting, False_Northing, CentralMeridianScale);
+      }
+
+      /////////////////////////////////////////////////////////////////////////////
+      void GeodeticToUTM(const UTMParameters& params, double Latitude, double Longitude, double& Easting, double& Northing)
+      {
+         if (Longitude < 0)
+         {
+            Longitude += (2*osg::PI) + 1.0e-10;
+         }
+
+         Coordinates::ConvertGeodeticToTransverseMercator(params, Latitude, Longitude, Easting, Northing);
+      }
+
+      /// How many locations or rotations the batch conversions work on at a time.
+      const size_t BATCH_BLOCK_SIZE = 64;
+
+      /// A quarter turn, for taking a cosine as sinf(angle + QUARTER_TURN).  The sine and cosine of the same
+      /// angle would otherwise be fused into sincosf, which has no vector version.
+      const float QUARTER_TURN = float(osg::PI_2);
+
+      /// Same as MatrixUtil::ClampUnity, but in double and written so it compiles to min and max.
+      inline double ClampUnity(double x)
+      {
+         return std::min(1.0, std::max(-1.0, x));
+      }
+
+      /////////////////////////////////////////////////////////////////////////////
+      /**
+       * Converts up to BATCH_BLOCK_SIZE geocentric locations to UTM easting, northing and elevation.
+       * The components are in separate arrays and the loops have no branches, so they can be vectorized.
+       * This is ConvertGeocentricToGeodetic followed by GeodeticToUTM, except that locations on the polar
+       * axis, which those handle as special cases, are redone with them afterwards.
+       */
+      void GeocentricToUTMBlock(const UTMParameters& params, const double* x, const double* y, const double* z,
+               double* easting, double* northing, double* elevation, size_t count)
+      {
+         const double geocentB = Geocent_a * (1 - Geocent_f);
+
+         double lat[BATCH_BLOCK_SIZE];
+         double lon[BATCH_BLOCK_SIZE];
+         bool onAxis[BATCH_BLOCK_SIZE];
+
+         for (size_t i = 0; i < count; ++i)
+         {
+            const double w2 = x[i] * x[i] + y[i] * y[i];
+            const double w = sqrt(w2);
+            const double t0 = z[i] * AD_C;
+            const double s0 = sqrt(t0 * t0 + w2);
+            const double sinB0 = t0 / s0;
+            const double cosB0 = w / s0;
+            const double sin3B0 = sinB0 * sinB0 * sinB0;
+            const double t1 = z[i] + geocentB * Geocent_ep2 * sin3B0;
+            const double sum = w - Geocent_a * Geocent_e2 * cosB0 * cosB0 * cosB0;
+            const double s1 = sqrt(t1 * t1 + sum * sum);
+            const double sinP1 = t1 / s1;
+            const double cosP1 = sum / s1;
+            const double rn = Geocent_a / sqrt(1.0 - Geocent_e2 * sinP1 * sinP1);
+            const double absCosP1 = std::abs(cosP1);
+
+            elevation[i] = absCosP1 >= COS_67P5 ? w / absCosP1 - rn : z[i] / sinP1 + rn * (Geocent_e2 - 1.0);
+            lat[i] = atan(sinP1 / cosP1);
+            lon[i] = atan2(y[i], x[i]);
+            onAxis[i] = w2 == 0.0;
+         }
+
+         // ConvertGeodeticToTransverseMercator with the powers of dlam multiplied out.  The parameters are
+         // copied to locals, otherwise the compiler can't tell the output arrays don't overwrite them.
+         const double k = params.TranMerc_Scale_Factor;
+         const double tmdo = params.SPHTMD(params.TranMerc_Origin_Lat);
+         const double twoPI = 2 * osg::PI;
+         const double originLong = params.TranMerc_Origin_Long;
+         const double falseEasting = params.TranMerc_False_Easting;
+         const double falseNorthing = params.TranMerc_False_Northing;
+         const double a = params.TranMerc_a;
+         const double es = params.TranMerc_es;
+         const double ebs = params.TranMerc_ebs;
+         const double ap = params.TranMerc_ap;
+         const double bp = params.TranMerc_bp;
+         const double cp = params.TranMerc_cp;
+         const double dp = params.TranMerc_dp;
+         const double ep = params.TranMerc_ep;
+
+         for (size_t i = 0; i < count; ++i)
+         {
+            double longitude = lon[i];
+            longitude = longitude < 0.0 ? longitude + twoPI + 1.0e-10 : longitude;
+            longitude = longitude > osg::PI ? longitude - twoPI : longitude;
+
+            double dlam = longitude - originLong;
+            dlam = dlam > osg::PI ? dlam - twoPI : dlam;
+            dlam = dlam < -osg::PI ? dlam + twoPI : dlam;
+            dlam = std::abs(dlam) < 2.e-10 ? 0.0 : dlam;
+
+            // The latitude is within +-90 degrees, so its cosine is never negative and can be taken from
+            // the sine.  Calling sin and cos on the same value gets them fused into sincos, which has
+            // no vector version, and that would keep the loop from being vectorized.
+            const double latitude = lat[i];
+            const double s = sin(latitude);
+            const double c = sqrt((1.0 - s) * (1.0 + s));
+            const double c2 = c * c;
+            const double c3 = c2 * c;
+            const double c5 = c3 * c2;
+            const double c7 = c5 * c2;
+            const double t = s / c;
+            const double tan2 = t * t;
+            const double tan4 = tan2 * tan2;
+            const double tan6 = tan4 * tan2;
+            const double eta = ebs * c2;
+            const double eta2 = eta * eta;
+            const double eta3 = eta2 * eta;
+            const double eta4 = eta3 * eta;
+
+            const double sn = a / sqrt(1.e0 - es * s * s);
+            const double tmd = ap * latitude - bp * sin(2.e0 * latitude) + cp * sin(4.e0 * latitude)
+               - dp * sin(6.e0 * latitude) + ep * sin(8.e0 * latitude);
+
+            const double t1 = (tmd - tmdo) * k;
+            const double t2 = sn * s * c * k / 2.e0;
+            const double t3 = sn * s * c3 * k * (5.e0 - tan2 + 9.e0 * eta + 4.e0 * eta2) / 24.e0;
+            const double t4 = sn * s * c5 * k * (61.e0 - 58.e0 * tan2
+                                                + tan4 + 270.e0 * eta - 330.e0 * tan2 * eta + 445.e0 * eta2
+                                                + 324.e0 * eta3 -680.e0 * tan2 * eta2 + 88.e0 * eta4
+                                                -600.e0 * tan2 * eta3 - 192.e0 * tan2 * eta4) / 720.e0;
+            const double t5 = sn * s * c7 * k * (1385.e0 - 3111.e0 * tan2 + 543.e0 * tan4 - tan6) / 40320.e0;
+            const double t6 = sn * c * k;
+            const double t7 = sn * c3 * k * (1.e0 - tan2 + eta) / 6.e0;
+            const double t8 = sn * c5 * k * (5.e0 - 18.e0 * tan2 + tan4
+                                            + 14.e0 * eta - 58.e0 * tan2 * eta + 13.e0 * eta2 + 4.e0 * eta3
+                                            - 64.e0 * tan2 * eta2 - 24.e0 * tan2 * eta3) / 120.e0;
+            const double t9 = sn * c7 * k * (61.e0 - 479.e0 * tan2 + 179.e0 * tan4 - tan6) / 5040.e0;
+
+            const double dlam2 = dlam * dlam;
+            const double dlam3 = dlam2 * dlam;
+            const double dlam4 = dlam2 * dlam2;
+            const double dlam5 = dlam4 * dlam;
+            const double dlam6 = dlam4 * dlam2;
+            const double dlam7 = dlam6 * dlam;
+            const double dlam8 = dlam4 * dlam4;
+
+            northing[i] = falseNorthing + t1 + dlam2 * t2 + dlam4 * t3 + dlam6 * t4 + dlam8 * t5;
+            easting[i] = falseEasting + dlam * t6 + dlam3 * t7 + dlam5 * t8 + dlam7 * t9;
+         }
+
+         for (size_t i = 0; i < count; ++i)
+         {
+            if (onAxis[i])
+            {
+               Coordinates::ConvertGeocentricToGeodetic(x[i], y[i], z[i], lat[i], lon[i], elevation[i]);
+               GeodeticToUTM(params, lat[i], lon[i], easting[i], northing[i]);
+            }
+         }
+      }
+
+      /////////////////////////////////////////////////////////////////////////////
+      /**
+       * Converts up to BATCH_BLOCK_SIZE rotation matrices, given as nine arrays of elements indexed
+       * [row * 3 + column], to heading, pitch and roll in degrees like MatrixUtil::MatrixToHpr.
+       * The loop has no branches so it can be vectorized.  The cases MatrixToHpr handles specially,
+       * a degenerate matrix or a pitch near +-90 degrees, are redone with MatrixToHpr afterwards.
+       */
+      void MatrixToHprBlock(const double* const m[9], float* heading, float* pitch, float* roll, size_t count)
+      {
+         const double magicEpsilon = 0.00001;
+         bool special[BATCH_BLOCK_SIZE];
+
+         for (size_t i = 0; i < count; ++i)
+         {
+            const double scale = sqrt(m[0][i] * m[0][i] + m[1][i] * m[1][i] + m[2][i] * m[2][i]);
+            const double oneOverS = 1.0 / scale;
+
+            const double p = asin(ClampUnity(m[5][i] * oneOverS));
+            const double cp = cos(p);
+            const double oneOverCp = oneOverS / cp;
+
+            const double sr = ClampUnity(-m[2][i] * oneOverCp);
+            const double cr = ClampUnity( m[8][i] * oneOverCp);
+            const double sh = ClampUnity(-m[3][i] * oneOverCp);
+            const double ch = ClampUnity( m[4][i] * oneOverCp);
+
+            heading[i] = osg::RadiansToDegrees(atan2(sh, ch));
+            pitch[i] = osg::RadiansToDegrees(p);
+            roll[i] = osg::RadiansToDegrees(atan2(sr, cr));
+
+            special[i] = scale <= magicEpsilon || std::abs(cp) < magicEpsilon ||
+               (std::abs(sh) <= magicEpsilon && std::abs(ch) <= magicEpsilon) ||
+               (std::abs(sr) <= magicEpsilon && std::abs(cr) <= magicEpsilon);
+         }
+
+         for (size_t i = 0; i < count; ++i)
+         {
+            if (special[i])
+            {
+               osg::Matrix rotation(m[0][i], m[1][i], m[2][i], 0.0,
+                                    m[3][i], m[4][i], m[5][i], 0.0,
+                                    m[6][i], m[7][i], m[8][i], 0.0,
+                                    0.0,     0.0,     0.0,     1.0);
+               osg::Vec3 hpr;
+               MatrixUtil::MatrixToHpr(hpr, rotation);
+               heading[i] = hpr[0];
+               pitch[i] = hpr[1];
+               roll[i] = hpr[2];
+            }
+         }
+      }
+
+      /////////////////////////////////////////////////////////////////////////////
+      /// The ZFlop of a rotation held as nine element arrays: rows 0 and 1 swap places and row 2 is negated.
+      void ZFlopBlock(double* m[9], size_t count)
+      {
+         std::swap(m[0], m[3]);
+         std::swap(m[1], m[4]);
+         std::swap(m[2], m[5]);
+         for (unsigned j = 6; j < 9; ++j)
+         {
+            double* row = m[j];
+            for (size_t i = 0; i < count; ++i)
+            {
+               row[i] = -row[i];
+            }
+         }
+      }
+   }
+
    /////////////////////////////////////////////////////////////////////////////
    UTMParameters::UTMParameters()
    {
@@ -144,6 +395,8 @@ namespace dtUtil
       , mConvergence(0.0)
       , mApplyRotationConversionMatrix(true)
       , mRotationDirty(true)
+      , mUTMParamsZone(0)
+      , mUTMParamsHemisphere('N')
    {
       mLogger = &Log::GetInstance("coordinates.cpp");
 
@@ -180,6 +433,10 @@ namespace dtUtil
       mRotationOffsetInverse  = rhs.mRotationOffsetInverse;
       mApplyRotationConversionMatrix = rhs.mApplyRotationConversionMatrix;
 
+      mUTMParams              = rhs.mUTMParams;
+      mUTMParamsZone          = rhs.mUTMParamsZone;
+      mUTMParamsHemisphere    = rhs.mUTMParamsHemisphere;
+
       return *this;
    }
 
@@ -518,7 +775,7 @@ namespace dtUtil
                   osg::RadiansToDegrees(lat), osg::RadiansToDegrees(lon));
             }
 
-            ConvertGeodeticToUTM(lat, lon, mUTMZone, mUTMHemisphere, easting, northing);
+            GeodeticToUTM(GetUTMParameters(), lat, lon, easting, northing);
 
             osg::Vec3d localOffset;
             GetLocalOffset(localOffset);
@@ -532,8 +789,8 @@ namespace dtUtil
             // This code is not yet unit tested
             double easting, northing;
 
-            ConvertGeodeticToUTM(osg::DegreesToRadians(loc[0]), osg::DegreesToRadians(loc[1]),
-                     mUTMZone, mUTMHemisphere, easting, northing);
+            GeodeticToUTM(GetUTMParameters(), osg::DegreesToRadians(loc[0]), osg::DegreesToRadians(loc[1]),
+                     easting, northing);
 
             osg::Vec3d localOffset;
             GetLocalOffset(localOffset);
@@ -586,7 +843,7 @@ namespace dtUtil
          else if (*mIncomingCoordinateType == IncomingCoordinateType::UTM)
          {
             double lat, lon;
-            ConvertUTMToGeodetic(mUTMZone, mUTMHemisphere, loc[0], loc[1], lat, lon);
+            ConvertTransverseMercatorToGeodetic(GetUTMParameters(), loc[0], loc[1], lat, lon);
             osg::Vec3d xyz;
             ConvertLatLonToFlatEarth(xyz, osg::Vec3d(osg::RadiansToDegrees(lat), osg::RadiansToDegrees(lon), loc[2]), mFlatEarthOrigin, mConvergence);
 
@@ -676,7 +933,7 @@ namespace dtUtil
             osg::Vec3d localOffset;
             GetLocalOffset(localOffset);
 
-            ConvertUTMToGeodetic(mUTMZone, mUTMHemisphere, translation[0] + localOffset.x(), translation[1] + localOffset.y(), lat, lon);
+            ConvertTransverseMercatorToGeodetic(GetUTMParameters(), translation[0] + localOffset.x(), translation[1] + localOffset.y(), lat, lon);
 
             if (mLogger->IsLevelEnabled(dtUtil::Log::LOG_DEBUG))
             {
@@ -699,7 +956,7 @@ namespace dtUtil
             osg::Vec3d localOffset;
             GetLocalOffset(localOffset);
 
-            ConvertUTMToGeodetic(mUTMZone, mUTMHemisphere, translation[0] + localOffset.x(), translation[1] + localOffset.y(), lat, lon);
+            ConvertTransverseMercatorToGeodetic(GetUTMParameters(), translation[0] + localOffset.x(), translation[1] + localOffset.y(), lat, lon);
 
             remoteLoc[0] = osg::RadiansToDegrees(lat);
             remoteLoc[1] = osg::RadiansToDegrees(lon);
@@ -776,7 +1033,7 @@ namespace dtUtil
             }
 
             double easting, northing;
-            ConvertGeodeticToUTM(lle[0], lle[1], mUTMZone, mUTMHemisphere, easting, northing);
+            GeodeticToUTM(GetUTMParameters(), lle[0], lle[1], easting, northing);
             remoteLoc[0] = easting;
             remoteLoc[1] = northing;
             remoteLoc[2] = lle[2];
@@ -938,6 +1195,378 @@ namespace dtUtil
       return rotation;
    }
 
+   /////////////////////////////////////////////////////////////////////////////
+   const UTMParameters& Coordinates::GetUTMParameters()
+   {
+      if (mUTMParamsZone != mUTMZone || mUTMParamsHemisphere != mUTMHemisphere)
+      {
+         CalcUTMZoneParameters(mUTMParams, mUTMZone, mUTMHemisphere);
+         mUTMParamsZone = mUTMZone;
+         mUTMParamsHemisphere = mUTMHemisphere;
+      }
+      return mUTMParams;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void Coordinates::ConvertToLocalTranslations(const osg::Vec3d* locs, osg::Vec3* results, size_t count)
+   {
+      if (*mIncomingCoordinateType != IncomingCoordinateType::GEOCENTRIC || mLogger->IsLevelEnabled(Log::LOG_DEBUG))
+      {
+         // Only the geocentric paths are hoisted.  Everything else, and debug logging, goes through the single version.
+         for (size_t i = 0; i < count; ++i)
+         {
+            results[i] = ConvertToLocalTranslation(locs[i]);
+         }
+         return;
+      }
+
+      if (*mLocalCoordinateType == LocalCoordinateType::GLOBE)
+      {
+         const double scale = GetGlobeRadius();
+         for (size_t i = 0; i < count; ++i)
+         {
+            const osg::Vec3d& loc = locs[i];
+            osg::Vec3& position = results[i];
+            position[0] = (loc[0] / semiMajorAxis) * scale;
+            position[1] = (loc[1] / semiMajorAxis) * scale;
+            position[2] = (loc[2] / semiMajorAxis) * scale;
+         }
+      }
+      else if (*mLocalCoordinateType == LocalCoordinateType::CARTESIAN_UTM)
+      {
+         const UTMParameters& params = GetUTMParameters();
+         osg::Vec3d localOffset;
+         GetLocalOffset(localOffset);
+
+         double x[BATCH_BLOCK_SIZE], y[BATCH_BLOCK_SIZE], z[BATCH_BLOCK_SIZE];
+         double easting[BATCH_BLOCK_SIZE], northing[BATCH_BLOCK_SIZE], elevation[BATCH_BLOCK_SIZE];
+
+         for (size_t start = 0; start < count; start += BATCH_BLOCK_SIZE)
+         {
+            const size_t blockSize = std::min(BATCH_BLOCK_SIZE, count - start);
+            const osg::Vec3d* blockLocs = locs + start;
+            osg::Vec3* blockResults = results + start;
+
+            for (size_t i = 0; i < blockSize; ++i)
+            {
+               x[i] = blockLocs[i][0];
+               y[i] = blockLocs[i][1];
+               z[i] = blockLocs[i][2];
+            }
+
+            GeocentricToUTMBlock(params, x, y, z, easting, northing, elevation, blockSize);
+
+            for (size_t i = 0; i < blockSize; ++i)
+            {
+               osg::Vec3& position = blockResults[i];
+               position[0] = easting[i] - localOffset.x();
+               position[1] = northing[i] - localOffset.y();
+               position[2] = elevation[i] - localOffset.z();
+            }
+         }
+      }
+      else
+      {
+         for (size_t i = 0; i < count; ++i)
+         {
+            results[i] = ConvertToLocalTranslation(locs[i]);
+         }
+         return;
+      }
+
+      for (size_t i = 0; i < count; ++i)
+      {
+         osg::Vec3& position = results[i];
+         for (unsigned j = 0; j < 3; ++j)
+         {
+            if (!IsFinite(position[j]))
+            {
+               position[j] = 0.0f;
+            }
+         }
+      }
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void Coordinates::ConvertToRemoteTranslations(const osg::Vec3* translations, osg::Vec3d* results, size_t count)
+   {
+      for (size_t i = 0; i < count; ++i)
+      {
+         results[i] = ConvertToRemoteTranslation(translations[i]);
+      }
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void Coordinates::ConvertToLocalRotations(const osg::Vec3* psiThetaPhis, osg::Vec3* results, size_t count)
+   {
+      const bool globe = *mLocalCoordinateType == LocalCoordinateType::GLOBE;
+      const bool cartesian = *mLocalCoordinateType == LocalCoordinateType::CARTESIAN_UTM ||
+               *mLocalCoordinateType == LocalCoordinateType::CARTESIAN_FLAT_EARTH;
+      const bool geocentric = *mIncomingCoordinateType == IncomingCoordinateType::GEOCENTRIC;
+
+      if ((!globe && !cartesian) || (globe && !geocentric) || mLogger->IsLevelEnabled(Log::LOG_DEBUG))
+      {
+         // Let the single version report the errors and do the logging.
+         for (size_t i = 0; i < count; ++i)
+         {
+            const osg::Vec3& ptp = psiThetaPhis[i];
+            results[i] = ConvertToLocalRotation(ptp[0], ptp[1], ptp[2]);
+         }
+         return;
+      }
+
+      if (mRotationDirty)
+      {
+         ReconfigureRotationMatrix();
+      }
+
+      const bool applyOrigin = cartesian && mApplyRotationConversionMatrix;
+      const bool flop = cartesian && geocentric;
+      const osg::Matrix& originRot = GetOriginRotationMatrix();
+
+      float psi[BATCH_BLOCK_SIZE], theta[BATCH_BLOCK_SIZE], phi[BATCH_BLOCK_SIZE];
+      double elements[9][BATCH_BLOCK_SIZE];
+      double product[9][BATCH_BLOCK_SIZE];
+      float heading[BATCH_BLOCK_SIZE], pitch[BATCH_BLOCK_SIZE], roll[BATCH_BLOCK_SIZE];
+
+      for (size_t start = 0; start < count; start += BATCH_BLOCK_SIZE)
+      {
+         const size_t blockSize = std::min(BATCH_BLOCK_SIZE, count - start);
+         const osg::Vec3* blockRotations = psiThetaPhis + start;
+
+         for (size_t i = 0; i < blockSize; ++i)
+         {
+            psi[i] = blockRotations[i][0];
+            theta[i] = blockRotations[i][1];
+            phi[i] = blockRotations[i][2];
+         }
+
+         // EulersToMatrix, in float like the single version.
+         for (size_t i = 0; i < blockSize; ++i)
+         {
+            const float cosPsi = sinf(psi[i] + QUARTER_TURN);
+            const float sinPsi = sinf(psi[i]);
+            const float cosTheta = sinf(theta[i] + QUARTER_TURN);
+            const float sinTheta = sinf(theta[i]);
+            const float cosPhi = sinf(phi[i] + QUARTER_TURN);
+            const float sinPhi = sinf(phi[i]);
+
+            elements[0][i] = cosPsi * cosTheta;
+            elements[1][i] = - sinPsi * cosPhi + cosPsi * sinTheta * sinPhi;
+            elements[2][i] = sinPsi * sinPhi + cosPsi * sinTheta * cosPhi;
+            elements[3][i] = sinPsi * cosTheta;
+            elements[4][i] = cosPsi * cosPhi + sinPsi * sinTheta * sinPhi;
+            elements[5][i] = - cosPsi * sinPhi + sinPsi * sinTheta * cosPhi;
+            elements[6][i] = - sinTheta;
+            elements[7][i] = cosTheta * sinPhi;
+            elements[8][i] = cosTheta * cosPhi;
+         }
+
+         double* m[9];
+         for (unsigned j = 0; j < 9; ++j)
+         {
+            m[j] = elements[j];
+         }
+
+         if (applyOrigin)
+         {
+            // The euler matrix is a pure rotation, so its transpose is its inverse.
+            for (unsigned row = 0; row < 3; ++row)
+            {
+               for (unsigned col = 0; col < 3; ++col)
+               {
+                  const double o0 = originRot(0, col);
+                  const double o1 = originRot(1, col);
+                  const double o2 = originRot(2, col);
+                  double* out = product[row * 3 + col];
+                  const double* e0 = elements[row];
+                  const double* e1 = elements[3 + row];
+                  const double* e2 = elements[6 + row];
+                  for (size_t i = 0; i < blockSize; ++i)
+                  {
+                     out[i] = e0[i] * o0 + e1[i] * o1 + e2[i] * o2;
+                  }
+               }
+            }
+
+            for (unsigned j = 0; j < 9; ++j)
+            {
+               m[j] = product[j];
+            }
+         }
+
+         if (flop)
+         {
+            ZFlopBlock(m, blockSize);
+         }
+
+         MatrixToHprBlock(m, heading, pitch, roll, blockSize);
+
+         osg::Vec3* blockResults = results + start;
+         for (size_t i = 0; i < blockSize; ++i)
+         {
+            osg::Vec3& rotation = blockResults[i];
+            rotation.set(heading[i], pitch[i], roll[i]);
+            for (unsigned j = 0; j < 3; ++j)
+            {
+               if (!IsFinite(rotation[j]))
+               {
+                  rotation[j] = 0.0f;
+               }
+            }
+         }
+      }
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void Coordinates::ConvertToRemoteRotations(const osg::Vec3* hprs, osg::Vec3d* results, size_t count)
+   {
+      const bool globe = *mLocalCoordinateType == LocalCoordinateType::GLOBE;
+      const bool cartesian = *mLocalCoordinateType == LocalCoordinateType::CARTESIAN_UTM ||
+               *mLocalCoordinateType == LocalCoordinateType::CARTESIAN_FLAT_EARTH;
+      const bool geocentric = *mIncomingCoordinateType == IncomingCoordinateType::GEOCENTRIC;
+
+      if ((!globe && !cartesian) || (globe && !geocentric))
+      {
+         // Let the single version report the errors.
+         for (size_t i = 0; i < count; ++i)
+         {
+            results[i] = ConvertToRemoteRotation(hprs[i]);
+         }
+         return;
+      }
+
+      if (mRotationDirty)
+      {
+         ReconfigureRotationMatrix();
+      }
+
+      const bool flop = cartesian && geocentric;
+      const osg::Matrix& originInverse = GetOriginRotationMatrixInverse();
+      const float magicEpsilon = 0.00001f;
+
+      float sinH[BATCH_BLOCK_SIZE], cosH[BATCH_BLOCK_SIZE];
+      float sinP[BATCH_BLOCK_SIZE], cosP[BATCH_BLOCK_SIZE];
+      float sinR[BATCH_BLOCK_SIZE], cosR[BATCH_BLOCK_SIZE];
+      double elements[9][BATCH_BLOCK_SIZE];
+      double product[9][BATCH_BLOCK_SIZE];
+
+      for (size_t start = 0; start < count; start += BATCH_BLOCK_SIZE)
+      {
+         const size_t blockSize = std::min(BATCH_BLOCK_SIZE, count - start);
+         const osg::Vec3* blockHprs = hprs + start;
+
+         // MatrixUtil::HprToMatrix, which treats angles within its epsilon of zero as zero.
+         for (size_t i = 0; i < blockSize; ++i)
+         {
+            const float h = std::abs(blockHprs[i][0]) <= magicEpsilon ? 0.0f : osg::DegreesToRadians(blockHprs[i][0]);
+            const float p = std::abs(blockHprs[i][1]) <= magicEpsilon ? 0.0f : osg::DegreesToRadians(blockHprs[i][1]);
+            const float r = std::abs(blockHprs[i][2]) <= magicEpsilon ? 0.0f : osg::DegreesToRadians(blockHprs[i][2]);
+            sinH[i] = sinf(h);
+            cosH[i] = sinf(h + QUARTER_TURN);
+            sinP[i] = sinf(p);
+            cosP[i] = sinf(p + QUARTER_TURN);
+            sinR[i] = sinf(r);
+            cosR[i] = sinf(r + QUARTER_TURN);
+         }
+
+         for (size_t i = 0; i < blockSize; ++i)
+         {
+            const double sh = sinH[i], ch = cosH[i];
+            const double sp = sinP[i], cp = cosP[i];
+            const double sr = sinR[i], cr = cosR[i];
+            const double srsp = sr * sp;
+            const double crsp = cr * sp;
+            const double srcp = sr * cp;
+
+            elements[0][i] =  ch * cr - sh * srsp;
+            elements[1][i] =  cr * sh + srsp * ch;
+            elements[2][i] = -srcp;
+            elements[3][i] = -sh * cp;
+            elements[4][i] =  ch * cp;
+            elements[5][i] =  sp;
+            elements[6][i] =  sr * ch + sh * crsp;
+            elements[7][i] =  sr * sh - crsp * ch;
+            elements[8][i] =  cr * cp;
+         }
+
+         double* m[9];
+         for (unsigned j = 0; j < 9; ++j)
+         {
+            m[j] = elements[j];
+         }
+
+         if (cartesian)
+         {
+            if (flop)
+            {
+               ZFlopBlock(m, blockSize);
+            }
+
+            // Both matrices are pure rotations, so the inverse of the product is its transpose.
+            for (unsigned row = 0; row < 3; ++row)
+            {
+               for (unsigned col = 0; col < 3; ++col)
+               {
+                  const double o0 = originInverse(0, row);
+                  const double o1 = originInverse(1, row);
+                  const double o2 = originInverse(2, row);
+                  double* out = product[row * 3 + col];
+                  const double* e0 = m[col * 3];
+                  const double* e1 = m[col * 3 + 1];
+                  const double* e2 = m[col * 3 + 2];
+                  for (size_t i = 0; i < blockSize; ++i)
+                  {
+                     out[i] = e0[i] * o0 + e1[i] * o1 + e2[i] * o2;
+                  }
+               }
+            }
+
+            for (unsigned j = 0; j < 9; ++j)
+            {
+               m[j] = product[j];
+            }
+         }
+
+         // MatrixToEulers, with the quadrant corrections written as selects.
+         osg::Vec3d* blockResults = results + start;
+         for (size_t i = 0; i < blockSize; ++i)
+         {
+            const float m00 = m[0][i], m10 = m[3][i], m20 = m[6][i], m21 = m[7][i], m22 = m[8][i];
+
+            const float sqCosTheta = 1.0 - m20 * m20;
+            float cosTheta = sqCosTheta < 0.0f ? 0.0f : sqrtf(sqCosTheta);
+            cosTheta = cosTheta == 0.0f ? 0.000001f : cosTheta;
+
+            float psi = safeASIN(m10 / cosTheta);
+            psi = m00 < 0.0f ? (psi < 0.0f ? -osg::PI : osg::PI) - psi : psi;
+
+            const float theta = -safeASIN(m20);
+
+            float phi = safeASIN(m21 / cosTheta);
+            phi = m22 < 0.0f ? (phi < 0.0f ? -osg::PI : osg::PI) - phi : phi;
+
+            osg::Vec3d& rotation = blockResults[i];
+            rotation.set(psi, theta, phi);
+            for (unsigned j = 0; j < 3; ++j)
+            {
+               if (!IsFinite(rotation[j]))
+               {
+                  rotation[j] = 0.0f;
+               }
+            }
+         }
+      }
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void Coordinates::ConvertToLocalTransforms(const osg::Vec3d* locs, const osg::Vec3* psiThetaPhis,
+            osg::Vec3* translations, osg::Vec3* hprs, size_t count)
+   {
+      ConvertToLocalTranslations(locs, translations, count);
+      ConvertToLocalRotations(psiThetaPhis, hprs, count);
+   }
+
    /////////////////////////////////////////////////////////////////////////////
    void Coordinates::ZFlop(osg::Matrix& toFlop)
    {
@@ -1048,39 +1677,9 @@ namespace dtUtil
    void Coordinates::ConvertGeodeticToUTM (double Latitude, double Longitude,
                                            unsigned Zone, char Hemisphere, double& Easting, double& Northing)
    {
-      double Origin_Latitude = 0.0;
-      double Central_Meridian = 0.0;
-      double False_Easting = 500000;
-      double False_Northing = 0;
-
-      // no errors
-      if (Longitude < 0)
-      {
-         Longitude += (2*osg::PI) + 1.0e-10;
-      }
-
-      //char nsZone;
-      //CalculateUTMZone(osg::RadiansToDegrees(Latitude), osg::RadiansToDegrees(Longitude), Zone, nsZone);
-
-      if (Zone >= 31)
-      {
-         Central_Meridian = osg::DegreesToRadians(double(6 * Zone - 183));
-      }
-      else
-      {
-         Central_Meridian = osg::DegreesToRadians(double(6 * Zone + 177));
-      }
-
-      // If we are projecting in the southern hemisphere, set the false northing.
-      if (Hemisphere == 'S' || Hemisphere == 's')
-      {
-         False_Northing = 10000000;
-      }
-
       UTMParameters params;
-      params.CalcTransverseMercatorParameters(Geocent_a, Geocent_f, Origin_Latitude,
-                                      Central_Meridian, False_Easting, False_Northing, CentralMeridianScale);
-      ConvertGeodeticToTransverseMercator(params, Latitude, Longitude, Easting, Northing);
+      CalcUTMZoneParameters(params, Zone, Hemisphere);
+      GeodeticToUTM(params, Latitude, Longitude, Easting, Northing);
    } // END OF Convert_Geodetic_To_UTM
 
    void Coordinates::ConvertUTMToGeodetic (unsigned zone, char hemisphere, double easting, double northing, double& latitude, double& longitude)
@@ -1101,28 +1700,8 @@ namespace dtUtil
        *    Longitude         : Longitude in radians                   (output)
        */
 
-      double Origin_Latitude = 0;
-      double Central_Meridian = 0;
-      double False_Easting = 500000;
-      double False_Northing = 0;
-
-      if (zone >= 31)
-      {
-         Central_Meridian = ((6 * zone - 183) * osg::PI / 180.0 /*+ 0.00000005*/);
-      }
-      else
-      {
-         Central_Meridian = ((6 * zone + 177) * osg::PI / 180.0 /*+ 0.00000005*/);
-      }
-
-      if (hemisphere == 'S' || hemisphere == 's')
-      {
-         False_Northing = 10000000;
-      }
-
       UTMParameters params;
-      params.CalcTransverseMercatorParameters(Geocent_a, Geocent_f, Origin_Latitude,
-                                      Central_Meridian, False_Easting, False_Northing, CentralMeridianScale);
+      CalcUTMZoneParameters(params, zone, hemisphere);
 
       ConvertTransverseMercatorToGeodetic(params, easting,northing,latitude,longitude);
    }
@@ -23,7 +23,9 @@
 #include <osg/Endian>
 #include <dtUtil/exception.h>
 #include <dtUtil/datastream.h>
+#include <algorithm>
 #include <cstring>
+#include <utility>
 
 namespace dtUtil
 {
@@ -35,6 +37,8 @@ namespace dtUtil
    const DataStream::SeekTypeEnum DataStream::SeekTypeEnum::CURRENT("CURRENT");
    const DataStream::SeekTypeEnum DataStream::SeekTypeEnum::END("END");
 
+   const float DataStream::DEFAULT_GROWTH_FACTOR = 2.0f;
+
    /////////////////////////////////////////////////////////////////////////////
    DataStream::DataStream()
       : mBuffer(NULL)
@@ -42,8 +46,30 @@ namespace dtUtil
       , mBufferCapacity(16)
       , mReadPos(0)
       , mWritePos(0)
+      , mGrowthFactor(DEFAULT_GROWTH_FACTOR)
+      , mMinGrowth(DEFAULT_MIN_GROWTH)
+      , mAutoFreeBuffer(true)
+      , mReadOnly(false)
+      , mForceLittleEndian(false)
+      , mVariableLengthEncoding(false)
+   {
+      mBuffer = new char[this->mBufferCapacity];
+      mIsLittleEndian = osg::getCpuByteOrder() == osg::LittleEndian;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   DataStream::DataStream(unsigned int initialCapacity)
+      : mBuffer(NULL)
+      , mBufferSize(0)
+      , mBufferCapacity(initialCapacity)
+      , mReadPos(0)
+      , mWritePos(0)
+      , mGrowthFactor(DEFAULT_GROWTH_FACTOR)
+      , mMinGrowth(DEFAULT_MIN_GROWTH)
       , mAutoFreeBuffer(true)
+      , mReadOnly(false)
       , mForceLittleEndian(false)
+      , mVariableLengthEncoding(false)
    {
       mBuffer = new char[this->mBufferCapacity];
       mIsLittleEndian = osg::getCpuByteOrder() == osg::LittleEndian;
@@ -56,8 +82,12 @@ namespace dtUtil
       , mBufferCapacity(bufferSize)
       , mReadPos(0)
       , mWritePos(0)
+      , mGrowthFactor(DEFAULT_GROWTH_FACTOR)
+      , mMinGrowth(DEFAULT_MIN_GROWTH)
       , mAutoFreeBuffer(autoFree)
+      , mReadOnly(false)
       , mForceLittleEndian(false)
+      , mVariableLengthEncoding(false)
    {
       if (bufferSize == 0)
       {
@@ -72,35 +102,128 @@ namespace dtUtil
       mIsLittleEndian = osg::getCpuByteOrder() == osg::LittleEndian;
    }
 
+   /////////////////////////////////////////////////////////////////////////////
+   DataStream::DataStream(const char* buffer, unsigned int bufferSize)
+      : mBuffer(const_cast<char*>(buffer))
+      , mBufferSize(bufferSize)
+      , mBufferCapacity(bufferSize)
+      , mReadPos(0)
+      , mWritePos(0)
+      , mGrowthFactor(DEFAULT_GROWTH_FACTOR)
+      , mMinGrowth(DEFAULT_MIN_GROWTH)
+      , mAutoFreeBuffer(false)
+      , mReadOnly(true)
+      , mForceLittleEndian(false)
+      , mVariableLengthEncoding(false)
+   {
+      if (buffer == NULL && bufferSize > 0)
+      {
+         throw DataStreamBufferInvalid("Source buffer is not valid.", __FILE__, __LINE__);
+      }
+
+      mIsLittleEndian = osg::getCpuByteOrder() == osg::LittleEndian;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   DataStream DataStream::CreateView(const char* buffer, unsigned int bufferSize)
+   {
+      return DataStream(buffer, bufferSize);
+   }
+
    /////////////////////////////////////////////////////////////////////////////
    DataStream::DataStream(const DataStream& rhs)
+      : mBuffer(NULL)
+      , mBufferCapacity(0)
+      , mAutoFreeBuffer(false)
    {
       *this = rhs;
    }
 
+   /////////////////////////////////////////////////////////////////////////////
+   DataStream::DataStream(DataStream&& rhs)
+      : mBuffer(NULL)
+      , mBufferCapacity(0)
+      , mAutoFreeBuffer(false)
+   {
+      *this = std::move(rhs);
+   }
+
    /////////////////////////////////////////////////////////////////////////////
    DataStream& DataStream::operator=(const DataStream& rhs)
    {
       if (this != &rhs)
       {
-         if (rhs.mBufferSize == 0)
+         if (rhs.mBufferSize == 0 && !rhs.mReadOnly)
          {
             throw DataStreamBufferInvalid("Attempted to copy an invalid data stream.  BufferSize is zero.", __FILE__, __LINE__);
          }
 
-         mBufferCapacity    = rhs.mBufferCapacity;
-         mBufferSize        = rhs.mBufferSize;
-         mBuffer            = new char[mBufferCapacity];
-         mWritePos          = rhs.mWritePos;
-         mReadPos           = rhs.mReadPos;
-         mAutoFreeBuffer    = rhs.mAutoFreeBuffer;
-         mForceLittleEndian = rhs.mForceLittleEndian;
-         mIsLittleEndian    = rhs.mIsLittleEndian;
+         char* newBuffer = NULL;
+         if (rhs.mReadOnly)
+         {
+            // A copy of a view is another view of the same memory.
+            newBuffer = rhs.mBuffer;
+         }
+         else
+         {
+            newBuffer = new char[rhs.mBufferCapacity];
+            memcpy(&newBuffer[0], &rhs.mBuffer[0], rhs.mBufferSize);
+         }
+
+         if (mAutoFreeBuffer)
+         {
+            delete[] mBuffer;
+         }
+
+         mBuffer                 = newBuffer;
+         mBufferCapacity         = rhs.mBufferCapacity;
+         mBufferSize             = rhs.mBufferSize;
+         mWritePos               = rhs.mWritePos;
+         mReadPos                = rhs.mReadPos;
+         mGrowthFactor           = rhs.mGrowthFactor;
+         mMinGrowth              = rhs.mMinGrowth;
+         // The copy always owns the memory it allocated, even if rhs didn't own its own.
+         mAutoFreeBuffer         = !rhs.mReadOnly;
+         mReadOnly               = rhs.mReadOnly;
+         mForceLittleEndian      = rhs.mForceLittleEndian;
+         mIsLittleEndian         = rhs.mIsLittleEndian;
+         mVariableLengthEncoding = rhs.mVariableLengthEncoding;
+      }
+
+      return *this;
+   }
 
-         if (mBufferSize > 0)
+   /////////////////////////////////////////////////////////////////////////////
+   DataStream& DataStream::operator=(DataStream&& rhs)
+   {
+      if (this != &rhs)
+      {
+         if (mAutoFreeBuffer)
          {
-            memcpy(&mBuffer[0], &rhs.mBuffer[0], mBufferSize);
+            delete[] mBuffer;
          }
+
+         mBuffer                 = rhs.mBuffer;
+         mBufferCapacity         = rhs.mBufferCapacity;
+         mBufferSize             = rhs.mBufferSize;
+         mWritePos               = rhs.mWritePos;
+         mReadPos                = rhs.mReadPos;
+         mGrowthFactor           = rhs.mGrowthFactor;
+         mMinGrowth              = rhs.mMinGrowth;
+         mAutoFreeBuffer         = rhs.mAutoFreeBuffer;
+         mReadOnly               = rhs.mReadOnly;
+         mForceLittleEndian      = rhs.mForceLittleEndian;
+         mIsLittleEndian         = rhs.mIsLittleEndian;
+         mVariableLengthEncoding = rhs.mVariableLengthEncoding;
+
+         // Leave rhs empty but usable.  Its next write allocates a new buffer.
+         rhs.mBuffer         = NULL;
+         rhs.mBufferCapacity = 0;
+         rhs.mBufferSize     = 0;
+         rhs.mWritePos       = 0;
+         rhs.mReadPos        = 0;
+         rhs.mAutoFreeBuffer = false;
+         rhs.mReadOnly       = false;
       }
 
       return *this;
@@ -145,10 +268,7 @@ namespace dtUtil
    /////////////////////////////////////////////////////////////////////////////
    void DataStream::Write(unsigned char c)
    {
-      if (mWritePos + sizeof(unsigned char) > mBufferCapacity)
-      {
-         ResizeBuffer();
-      }
+      EnsureWriteCapacity(sizeof(unsigned char));
 
       *((unsigned char *)(&mBuffer[mWritePos])) = c;
       mWritePos += sizeof(unsigned char);
@@ -161,9 +281,12 @@ namespace dtUtil
    /////////////////////////////////////////////////////////////////////////////
    void DataStream::WriteBytes(unsigned char c, size_t count)
    {
-      for (size_t i = 0; i < count; ++i)
+      EnsureWriteCapacity(unsigned(count));
+      memset(&mBuffer[mWritePos], c, count);
+      mWritePos += unsigned(count);
+      if (mWritePos > mBufferSize)
       {
-         Write(c);
+         mBufferSize = mWritePos;
       }
    }
 
@@ -182,10 +305,7 @@ namespace dtUtil
    /////////////////////////////////////////////////////////////////////////////
    void DataStream::Write(char c)
    {
-      if (mWritePos + sizeof(char) > mBufferCapacity)
-      {
-         ResizeBuffer();
-      }
+      EnsureWriteCapacity(sizeof(char));
 
       *((char *)(&mBuffer[mWritePos])) = c;
       mWritePos += sizeof(char);
@@ -198,6 +318,14 @@ namespace dtUtil
    /////////////////////////////////////////////////////////////////////////////
    void DataStream::Read(short& s)
    {
+      if (mVariableLengthEncoding)
+      {
+         long long value;
+         ReadVarInt(value);
+         s = (short)value;
+         return;
+      }
+
       if (mReadPos + sizeof(short) > mBufferSize)
       {
          throw DataStreamBufferReadError("Buffer underflow detected.", __FILE__, __LINE__);
@@ -216,11 +344,14 @@ namespace dtUtil
    /////////////////////////////////////////////////////////////////////////////
    void DataStream::Write(short s)
    {
-      if (mWritePos + sizeof(short) > mBufferCapacity)
+      if (mVariableLengthEncoding)
       {
-         ResizeBuffer();
+         WriteVarInt(s);
+         return;
       }
 
+      EnsureWriteCapacity(sizeof(short));
+
       if (mForceLittleEndian ^ mIsLittleEndian)
       {
          osg::swapBytes((char*)&s, sizeof(s));
@@ -237,6 +368,14 @@ namespace dtUtil
    /////////////////////////////////////////////////////////////////////////////
    void DataStream::Read(unsigned short& s)
    {
+      if (mVariableLengthEncoding)
+      {
+         unsigned long long value;
+         ReadVarUInt(value);
+         s = (unsigned short)value;
+         return;
+      }
+
       if (mReadPos + sizeof(unsigned short) > mBufferSize)
       {
          throw DataStreamBufferReadError("Buffer underflow detected.", __FILE__, __LINE__);
@@ -255,11 +394,14 @@ namespace dtUtil
    /////////////////////////////////////////////////////////////////////////////
    void DataStream::Write(unsigned short s)
    {
-      if (mWritePos + sizeof(unsigned short) > mBufferCapacity)
+      if (mVariableLengthEncoding)
       {
-         ResizeBuffer();
+         WriteVarUInt(s);
+         return;
       }
 
+      EnsureWriteCapacity(sizeof(unsigned short));
+
       if (mForceLittleEndian ^ mIsLittleEndian)
       {
          osg::swapBytes((char*)&s, sizeof(s));
@@ -277,6 +419,14 @@ namespace dtUtil
    /////////////////////////////////////////////////////////////////////////////
    void DataStream::Read(int& i)
    {
+      if (mVariableLengthEncoding)
+      {
+         long long value;
+         ReadVarInt(value);
+         i = (int)value;
+         return;
+      }
+
       if (mReadPos + sizeof(int) > mBufferSize)
       {
          throw DataStreamBufferReadError("Buffer underflow detected.", __FILE__, __LINE__);
@@ -295,11 +445,14 @@ namespace dtUtil
    /////////////////////////////////////////////////////////////////////////////
    void DataStream::Write(int i)
    {
-      if (mWritePos + sizeof(int) > mBufferCapacity)
+      if (mVariableLengthEncoding)
       {
-         ResizeBuffer();
+         WriteVarInt(i);
+         return;
       }
 
+      EnsureWriteCapacity(sizeof(int));
+
       if (mForceLittleEndian ^ mIsLittleEndian)
       {
          osg::swapBytes((char*)&i, sizeof(i));
@@ -316,6 +469,13 @@ namespace dtUtil
    /////////////////////////////////////////////////////////////////////////////
    void DataStream::Read(unsigned& i)
    {
+      if (mVariableLengthEncoding)
+      {
+         unsigned long long value;
+         ReadVarUInt(value);
+         i = (unsigned)value;
+         return;
+      }
 
       if (mReadPos + sizeof(unsigned) > mBufferSize)
       {
@@ -335,11 +495,14 @@ namespace dtUtil
    /////////////////////////////////////////////////////////////////////////////
    void DataStream::Write(unsigned int i)
    {
-      if (mWritePos + sizeof(unsigned int) > mBufferCapacity)
+      if (mVariableLengthEncoding)
       {
-         ResizeBuffer();
+         WriteVarUInt(i);
+         return;
       }
 
+      EnsureWriteCapacity(sizeof(unsigned int));
+
       if (mForceLittleEndian ^ mIsLittleEndian)
          osg::swapBytes((char*)&i, sizeof(i));
 
@@ -354,6 +517,14 @@ namespace dtUtil
    /////////////////////////////////////////////////////////////////////////////
    void DataStream::Read(long& i)
    {
+      if (mVariableLengthEncoding)
+      {
+         long long value;
+         ReadVarInt(value);
+         i = (long)value;
+         return;
+      }
+
       if (mReadPos + sizeof(long) > mBufferSize)
       {
          throw DataStreamBufferReadError("Buffer underflow detected.", __FILE__, __LINE__);
@@ -372,11 +543,14 @@ namespace dtUtil
    /////////////////////////////////////////////////////////////////////////////
    void DataStream::Write(long i)
    {
-      if (mWritePos + sizeof(long) > mBufferCapacity)
+      if (mVariableLengthEncoding)
       {
-         ResizeBuffer();
+         WriteVarInt(i);
+         return;
       }
 
+      EnsureWriteCapacity(sizeof(long));
+
       if (mForceLittleEndian ^ mIsLittleEndian)
       {
          osg::swapBytes((char*)&i, sizeof(i));
@@ -393,6 +567,13 @@ namespace dtUtil
    /////////////////////////////////////////////////////////////////////////////
    void DataStream::Read(unsigned long& i)
    {
+      if (mVariableLengthEncoding)
+      {
+         unsigned long long value;
+         ReadVarUInt(value);
+         i = (unsigned long)value;
+         return;
+      }
 
       if (mReadPos + sizeof(unsigned long) > mBufferSize)
       {
@@ -412,11 +593,14 @@ namespace dtUtil
    /////////////////////////////////////////////////////////////////////////////
    void DataStream::Write(unsigned long i)
    {
-      if (mWritePos + sizeof(unsigned long) > mBufferCapacity)
+      if (mVariableLengthEncoding)
       {
-         ResizeBuffer();
+         WriteVarUInt(i);
+         return;
       }
 
+      EnsureWriteCapacity(sizeof(unsigned long));
+
       if (mForceLittleEndian ^ mIsLittleEndian)
       {
          osg::swapBytes((char*)&i, sizeof(i));
@@ -455,10 +639,7 @@ namespace dtUtil
    /////////////////////////////////////////////////////////////////////////////
    void DataStream::Write(float f)
    {
-      if (mWritePos + sizeof(float) > mBufferCapacity)
-      {
-         ResizeBuffer();
-      }
+      EnsureWriteCapacity(sizeof(float));
 
       memcpy(&mBuffer[mWritePos], &f, sizeof(float));
       if (mForceLittleEndian ^ mIsLittleEndian)
@@ -496,10 +677,7 @@ namespace dtUtil
    /////////////////////////////////////////////////////////////////////////////
    void DataStream::Write(double d)
    {
-      if (mWritePos + sizeof(double) > mBufferCapacity)
-      {
-         ResizeBuffer();
-      }
+      EnsureWriteCapacity(sizeof(double));
 
       if (mForceLittleEndian ^ mIsLittleEndian)
       {
@@ -517,6 +695,14 @@ namespace dtUtil
    /////////////////////////////////////////////////////////////////////////////
    void DataStream::Read(long long& d)
    {
+      if (mVariableLengthEncoding)
+      {
+         long long value;
+         ReadVarInt(value);
+         d = (long long)value;
+         return;
+      }
+
       if (mReadPos + sizeof(long long) > mBufferSize)
       {
          throw DataStreamBufferReadError("Buffer underflow detected.", __FILE__, __LINE__);
@@ -535,11 +721,14 @@ namespace dtUtil
    /////////////////////////////////////////////////////////////////////////////
    void DataStream::Write(long long d)
    {
-      if (mWritePos + sizeof(long long) > mBufferCapacity)
+      if (mVariableLengthEncoding)
       {
-         ResizeBuffer();
+         WriteVarInt(d);
+         return;
       }
 
+      EnsureWriteCapacity(sizeof(long long));
+
       if (mForceLittleEndian ^ mIsLittleEndian)
       {
          osg::swapBytes((char*)&d, sizeof(d));
@@ -556,6 +745,14 @@ namespace dtUtil
    /////////////////////////////////////////////////////////////////////////////
    void DataStream::Read(unsigned long long& d)
    {
+      if (mVariableLengthEncoding)
+      {
+         unsigned long long value;
+         ReadVarUInt(value);
+         d = (unsigned long long)value;
+         return;
+      }
+
       if (mReadPos + sizeof(long long) > mBufferSize)
       {
          throw DataStreamBufferReadError("Buffer underflow detected.", __FILE__, __LINE__);
@@ -574,11 +771,14 @@ namespace dtUtil
    /////////////////////////////////////////////////////////////////////////////
    void DataStream::Write(unsigned long long d)
    {
-      if (mWritePos + sizeof(long long) > mBufferCapacity)
+      if (mVariableLengthEncoding)
       {
-         ResizeBuffer();
+         WriteVarUInt(d);
+         return;
       }
 
+      EnsureWriteCapacity(sizeof(long long));
+
       if (mForceLittleEndian ^ mIsLittleEndian)
       {
          osg::swapBytes((char*)&d, sizeof(d));
@@ -595,77 +795,157 @@ namespace dtUtil
    /////////////////////////////////////////////////////////////////////////////
    void DataStream::Read(std::string& str)
    {
-      if (mReadPos + sizeof(unsigned char) > mBufferSize)
+      unsigned strSize;
+      if (mVariableLengthEncoding)
       {
-         throw DataStreamBufferReadError("Buffer underflow detected.", __FILE__, __LINE__);
+         unsigned long long varSize;
+         ReadVarUInt(varSize);
+         if (varSize > GetRemainingReadSize())
+         {
+            throw DataStreamBufferReadError("Buffer underflow detected.", __FILE__, __LINE__);
+         }
+         strSize = unsigned(varSize);
       }
+      else
+      {
+         if (mReadPos + sizeof(unsigned char) > mBufferSize)
+         {
+            throw DataStreamBufferReadError("Buffer underflow detected.", __FILE__, __LINE__);
+         }
 
-      signed char c = *((signed char *)(&mBuffer[mReadPos]));
+         signed char c = *((signed char *)(&mBuffer[mReadPos]));
 
+         if (c < 0)
+         {
+            short sStrSize;
+            Read(sStrSize);
+            strSize = (unsigned)(-sStrSize);
+         }
+         else
+         {
+            unsigned char cStrSize;
+            Read(cStrSize);
+            strSize = (unsigned)cStrSize;
+         }
+
+         if (strSize > GetRemainingReadSize())
+         {
+            throw DataStreamBufferReadError("Buffer underflow detected.", __FILE__, __LINE__);
+         }
+      }
+
+      str.assign(mBuffer + mReadPos, strSize);
+      mReadPos += strSize;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void DataStream::Write(const std::string& str)
+   {
       unsigned strSize;
-      if (c < 0)
+      if (mVariableLengthEncoding)
       {
-         short sStrSize;
-         Read(sStrSize);
-         strSize = (unsigned)(-sStrSize);
+         // The length is a varint, so there is no limit to truncate at.
+         strSize = unsigned(str.length());
+         WriteVarUInt(strSize);
       }
       else
       {
-         unsigned char cStrSize;
-         Read(cStrSize);
-         strSize = (unsigned)cStrSize;
+         // it will truncate any strings longer than a short can handle
+         if (str.length() > SHRT_MAX)
+         {
+            LOGN_WARNING(LOGNAME,
+               "Attempting to write string a string longer than the max size for messages, truncating.");
+            strSize = SHRT_MAX;
+         }
+         else
+         {
+            strSize = unsigned(str.length());
+         }
+
+         // for short and long strings: write one byte for a short string and write the
+         // the negative length for the long string so that when the string is read back in, it
+         // the first bit of the size can be checked to see if one should read one or two bytes.
+         if (strSize < 128)
+         {
+            Write((unsigned char)strSize);
+         }
+         else
+         {
+            Write((short)-(short)strSize);
+         }
       }
 
-      str.clear();
-      str.reserve(strSize);
-      for (unsigned i = strSize; i > 0; --i)
+      EnsureWriteCapacity(strSize);
+
+      memcpy(mBuffer+mWritePos, str.c_str(), strSize);
+
+      mWritePos += strSize;
+      if (mWritePos > mBufferSize)
       {
-         unsigned char c2;
-         Read(c2);
-         str.append(1, (char)c2);
+         mBufferSize = mWritePos;
       }
    }
 
    /////////////////////////////////////////////////////////////////////////////
-   void DataStream::Write(const std::string& str)
+   void DataStream::WriteVarUInt(unsigned long long value)
    {
-      // it will truncate any strings longer than a short can handle
+      // A 64 bit value takes at most 10 bytes of 7 bits each.
+      EnsureWriteCapacity(10U);
 
-      if (str.length() > SHRT_MAX)
+      unsigned char* out = reinterpret_cast<unsigned char*>(&mBuffer[mWritePos]);
+      unsigned int count = 0;
+      while (value >= 0x80ULL)
       {
-         LOGN_WARNING(LOGNAME,
-            "Attempting to write string a string longer than the max size for messages, truncating.");
+         out[count++] = (unsigned char)(value | 0x80ULL);
+         value >>= 7;
       }
+      out[count++] = (unsigned char)value;
 
-      short strSize = (short)str.length();
-
-      // for short and long strings: write one byte for a short string and write the
-      // the negative length for the long string so that when the string is read back in, it
-      // the first bit of the size can be checked to see if one should read one or two bytes.
-      // this could technically fail if the string is longer than a signed int can hold, but one would not
-      // be wise to send a string that long.
-      if (strSize < 128)
-      {
-         Write((unsigned char)strSize);
-      }
-      else
+      mWritePos += count;
+      if (mWritePos > mBufferSize)
       {
-         Write((short)-strSize);
+         mBufferSize = mWritePos;
       }
+   }
 
-      while (mWritePos + strSize > mBufferCapacity)
+   /////////////////////////////////////////////////////////////////////////////
+   void DataStream::ReadVarUInt(unsigned long long& value)
+   {
+      const unsigned char* in = reinterpret_cast<const unsigned char*>(mBuffer);
+      unsigned long long result = 0ULL;
+      for (unsigned int shift = 0; shift < 64; shift += 7)
       {
-         ResizeBuffer();
+         if (mReadPos >= mBufferSize)
+         {
+            throw DataStreamBufferReadError("Buffer underflow detected.", __FILE__, __LINE__);
+         }
+
+         unsigned char byte = in[mReadPos++];
+         result |= (unsigned long long)(byte & 0x7F) << shift;
+         if ((byte & 0x80) == 0)
+         {
+            value = result;
+            return;
+         }
       }
 
-      memcpy(mBuffer+mWritePos, str.c_str(), strSize);
+      throw DataStreamBufferReadError("Variable length integer is longer than 64 bits.", __FILE__, __LINE__);
+   }
 
-      mWritePos += strSize;
-      if (mWritePos > mBufferSize)
-      {
-         mBufferSize = mWritePos;
-      }
+   /////////////////////////////////////////////////////////////////////////////
+   void DataStream::WriteVarInt(long long value)
+   {
+      // Zigzag encoding maps small negative numbers to small unsigned ones so they stay short.
+      unsigned long long zigzag = ((unsigned long long)value << 1) ^ (unsigned long long)(value >> 63);
+      WriteVarUInt(zigzag);
+   }
 
+   /////////////////////////////////////////////////////////////////////////////
+   void DataStream::ReadVarInt(long long& value)
+   {
+      unsigned long long zigzag;
+      ReadVarUInt(zigzag);
+      value = (long long)(zigzag >> 1) ^ -(long long)(zigzag & 1ULL);
    }
 
    /////////////////////////////////////////////////////////////////////////////
@@ -765,13 +1045,13 @@ namespace dtUtil
    /////////////////////////////////////////////////////////////////////////////
    unsigned int DataStream::WriteBinary(const char* pBuffer, const unsigned int size)
    {
-      if (mBufferCapacity - mWritePos < size)
-      {
-         IncreaseBufferSize(size - (mBufferCapacity - mWritePos));
-      }
+      EnsureWriteCapacity(size);
       memcpy(&mBuffer[mWritePos], pBuffer, size);
       mWritePos += size;
-      mBufferSize = mWritePos;
+      if (mWritePos > mBufferSize)
+      {
+         mBufferSize = mWritePos;
+      }
       return size;
    }
 
@@ -854,29 +1134,66 @@ namespace dtUtil
       }
    }
 
+   /////////////////////////////////////////////////////////////////////////////
+   void DataStream::SetGrowthPolicy(float growthFactor, unsigned int minGrowth)
+   {
+      mGrowthFactor = growthFactor < 1.0f ? 1.0f : growthFactor;
+      mMinGrowth = minGrowth;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   unsigned int DataStream::Reserve(unsigned int capacity)
+   {
+      if (capacity > mBufferCapacity)
+      {
+         ResizeBuffer(capacity);
+      }
+      return mBufferCapacity;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void DataStream::GrowBuffer(unsigned int requiredCapacity)
+   {
+      double grown = double(mBufferCapacity) * double(mGrowthFactor);
+      unsigned int newCapacity = grown > double(UINT_MAX) ? UINT_MAX : unsigned(grown);
+      if (newCapacity < mBufferCapacity + mMinGrowth)
+      {
+         newCapacity = mBufferCapacity + mMinGrowth;
+      }
+      if (newCapacity < requiredCapacity)
+      {
+         newCapacity = requiredCapacity;
+      }
+      ResizeBuffer(newCapacity);
+   }
+
    /////////////////////////////////////////////////////////////////////////////
    unsigned int DataStream::ResizeBuffer(unsigned int size)
    {
-      unsigned int newSize = 0;
-      if (size == 0)
+      if (mReadOnly)
       {
-         newSize = mBufferCapacity * 2;
+         throw DataStreamBufferWriteError("A read only view of a buffer cannot be written to or resized.", __FILE__, __LINE__);
       }
-      else
+
+      if (size == 0)
       {
-         newSize = size;
+         GrowBuffer(mBufferCapacity + 1);
+         return mBufferCapacity;
       }
 
-      char* newBuffer = new char[newSize];
+      char* newBuffer = new char[size];
 
-      // copy old buffercontents
-      if (newSize < mBufferCapacity)
+      // copy the old buffer contents, anything past the data size is garbage anyway.
+      if (size < mBufferSize)
       {
-         memcpy(&newBuffer[0], &mBuffer[0], newSize);
+         mBufferSize = size;
+         mWritePos = std::min(mWritePos, size);
+         mReadPos = std::min(mReadPos, size);
       }
-      else
+
+      if (mBufferSize > 0)
       {
-         memcpy(&newBuffer[0], &mBuffer[0], mBufferCapacity);
+         memcpy(&newBuffer[0], &mBuffer[0], mBufferSize);
       }
 
       if (mAutoFreeBuffer)
@@ -884,8 +1201,10 @@ namespace dtUtil
          delete [] mBuffer;
       }
 
+      // The stream always owns a buffer it allocated itself.
+      mAutoFreeBuffer = true;
       mBuffer = newBuffer;
-      mBufferCapacity = newSize;
+      mBufferCapacity = size;
       return mBufferCapacity;
    }
 
@@ -904,7 +1223,15 @@ namespace dtUtil
    /////////////////////////////////////////////////////////////////////////////
    unsigned int DataStream::ClearBuffer()
    {
-      memset(mBuffer, 0, mBufferCapacity);
+      if (mReadOnly)
+      {
+         throw DataStreamBufferWriteError("A read only view of a buffer cannot be cleared.", __FILE__, __LINE__);
+      }
+
+      if (mBuffer != NULL)
+      {
+         memset(mBuffer, 0, mBufferCapacity);
+      }
       Rewind();
       mBufferSize = 0;
       return mBufferCapacity;
@@ -913,7 +1240,8 @@ namespace dtUtil
    /////////////////////////////////////////////////////////////////////////////
    unsigned int DataStream::AppendDataStream(const DataStream& dataStream)
    {
-      IncreaseBufferSize(dataStream.GetBufferSize());
+      // Grow first so the source pointer stays good when a stream is appended to itself.
+      EnsureWriteCapacity(dataStream.GetBufferSize());
       return WriteBinary(dataStream.GetBuffer(), dataStream.GetBufferSize());
    }
 
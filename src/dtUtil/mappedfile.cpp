@@ -0,0 +1,158 @@
+/* -*-c++-*-
+ * Delta3D Open Source Game and Simulation Engine
+ * Copyright (C) 2014, Caper Holdings, LLC
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include <prefix/dtutilprefix.h>
+#include <dtUtil/mappedfile.h>
+#include <dtUtil/mswinmacros.h>
+#include <dtUtil/log.h>
+
+#ifdef DELTA_WIN32
+#   include <dtUtil/mswin.h>
+#else
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+namespace dtUtil
+{
+   //////////////////////////////////////////////////////////////////////////
+   MappedFile::MappedFile()
+   : mData(NULL)
+   , mSize(0U)
+#ifdef DELTA_WIN32
+   , mFileHandle(INVALID_HANDLE_VALUE)
+   , mMappingHandle(NULL)
+#endif
+   {
+   }
+
+   //////////////////////////////////////////////////////////////////////////
+   MappedFile::~MappedFile()
+   {
+      Close();
+   }
+
+#ifdef DELTA_WIN32
+
+   //////////////////////////////////////////////////////////////////////////
+   bool MappedFile::Open(const std::string& fileName)
+   {
+      Close();
+
+      mFileHandle = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+               OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+      if (mFileHandle == INVALID_HANDLE_VALUE)
+      {
+         return false;
+      }
+
+      LARGE_INTEGER size;
+      if (!GetFileSizeEx(mFileHandle, &size) || size.QuadPart == 0)
+      {
+         Close();
+         return false;
+      }
+
+      mMappingHandle = CreateFileMappingA(mFileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+      if (mMappingHandle == NULL)
+      {
+         Close();
+         return false;
+      }
+
+      mData = static_cast<const char*>(MapViewOfFile(mMappingHandle, FILE_MAP_READ, 0, 0, 0));
+      if (mData == NULL)
+      {
+         Close();
+         return false;
+      }
+      mSize = size_t(size.QuadPart);
+      return true;
+   }
+
+   //////////////////////////////////////////////////////////////////////////
+   void MappedFile::Close()
+   {
+      if (mData != NULL)
+      {
+         UnmapViewOfFile(mData);
+         mData = NULL;
+      }
+      if (mMappingHandle != NULL)
+      {
+         CloseHandle(mMappingHandle);
+         mMappingHandle = NULL;
+      }
+      if (mFileHandle != INVALID_HANDLE_VALUE)
+      {
+         CloseHandle(mFileHandle);
+         mFileHandle = INVALID_HANDLE_VALUE;
+      }
+      mSize = 0U;
+   }
+
+#else
+
+   //////////////////////////////////////////////////////////////////////////
+   bool MappedFile::Open(const std::string& fileName)
+   {
+      Close();
+
+      int fd = open(fileName.c_str(), O_RDONLY);
+      if (fd < 0)
+      {
+         return false;
+      }
+
+      struct stat info;
+      if (fstat(fd, &info) != 0 || info.st_size == 0)
+      {
+         close(fd);
+         return false;
+      }
+
+      void* data = mmap(NULL, size_t(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+      // The mapping keeps its own reference to the file.
+      close(fd);
+      if (data == MAP_FAILED)
+      {
+         LOG_WARNING("Unable to map file \"" + fileName + "\" into memory.");
+         return false;
+      }
+
+      mData = static_cast<const char*>(data);
+      mSize = size_t(info.st_size);
+      return true;
+   }
+
+   //////////////////////////////////////////////////////////////////////////
+   void MappedFile::Close()
+   {
+      if (mData != NULL)
+      {
+         munmap(const_cast<char*>(mData), mSize);
+         mData = NULL;
+      }
+      mSize = 0U;
+   }
+
+#endif
+}
@@ -0,0 +1,363 @@
+/* -*-c++-*-
+ * Delta3D Open Source Game and Simulation Engine
+ * Copyright (C) 2014, Caper Holdings, LLC
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include <prefix/dtutilprefix.h>
+#include <dtUtil/profiler.h>
+#include <dtUtil/log.h>
+
+#include <OpenThreads/Mutex>
+#include <OpenThreads/ScopedLock>
+#include <osg/Referenced>
+#include <dtCore/refptr.h>
+
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+#include <set>
+#include <vector>
+
+namespace dtUtil
+{
+   OpenThreads::Atomic Profiler::mEnabled(0U);
+
+   namespace
+   {
+      enum ProfileEventType
+      {
+         EVENT_ZONE,
+         EVENT_COUNTER,
+         EVENT_FRAME
+      };
+
+      struct ProfileEvent
+      {
+         ProfileEventType mType;
+         const char* mName;
+         osg::Timer_t mStart;
+         osg::Timer_t mEnd;
+         double mValue;
+      };
+
+      //////////////////////////////////////////////////////////////////////////
+      void WriteJsonString(std::ostream& stream, const char* str)
+      {
+         stream << '"';
+         for (; *str != '\0'; ++str)
+         {
+            const char c = *str;
+            if (c == '"' || c == '\\')
+            {
+               stream << '\\' << c;
+            }
+            else if (static_cast<unsigned char>(c) < 0x20)
+            {
+               stream << ' ';
+            }
+            else
+            {
+               stream << c;
+            }
+         }
+         stream << '"';
+      }
+   }
+
+   /**
+    * The events of one thread.  Only that thread writes to it, so its mutex is only
+    * contended while a trace is being exported or cleared.
+    */
+   class ThreadEventBuffer : public osg::Referenced
+   {
+   public:
+      ThreadEventBuffer(unsigned threadId, unsigned capacity)
+      : mThreadId(threadId)
+      , mNext(0U)
+      , mWrapped(false)
+      {
+         mEvents.resize(capacity);
+      }
+
+      void Add(const ProfileEvent& evt)
+      {
+         OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+         if (mEvents.empty())
+         {
+            return;
+         }
+
+         mEvents[mNext] = evt;
+         if (++mNext == mEvents.size())
+         {
+            mNext = 0U;
+            mWrapped = true;
+         }
+      }
+
+      /// Copies out the events oldest first.
+      void CopyEvents(std::vector<ProfileEvent>& events, std::string& threadName)
+      {
+         OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+         threadName = mThreadName;
+         if (mWrapped)
+         {
+            events.insert(events.end(), mEvents.begin() + mNext, mEvents.end());
+         }
+         events.insert(events.end(), mEvents.begin(), mEvents.begin() + mNext);
+      }
+
+      void Clear(unsigned capacity)
+      {
+         OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+         mEvents.resize(capacity);
+         mNext = 0U;
+         mWrapped = false;
+      }
+
+      void SetThreadName(const std::string& name)
+      {
+         OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+         if (mThreadName != name)
+         {
+            mThreadName = name;
+         }
+      }
+
+      const unsigned mThreadId;
+
+   protected:
+      virtual ~ThreadEventBuffer() {}
+
+   private:
+      OpenThreads::Mutex mMutex;
+      std::vector<ProfileEvent> mEvents;
+      size_t mNext;
+      bool mWrapped;
+      std::string mThreadName;
+   };
+
+   class ProfilerImpl
+   {
+   public:
+      ProfilerImpl()
+      : mEventsPerThread(Profiler::DEFAULT_EVENTS_PER_THREAD)
+      , mFrameNumber(0U)
+      {
+      }
+
+      /// Returns the buffer of the calling thread, creating it on first use.
+      ThreadEventBuffer& GetThreadBuffer()
+      {
+         // The buffers are held by mBuffers until the profiler goes away, so the raw pointer is safe.
+         static thread_local ThreadEventBuffer* threadBuffer = NULL;
+         if (threadBuffer == NULL)
+         {
+            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mBuffersMutex);
+            threadBuffer = new ThreadEventBuffer(unsigned(mBuffers.size()) + 1U, mEventsPerThread);
+            mBuffers.push_back(threadBuffer);
+         }
+         return *threadBuffer;
+      }
+
+      mutable OpenThreads::Mutex mBuffersMutex;
+      std::vector<dtCore::RefPtr<ThreadEventBuffer> > mBuffers;
+      unsigned mEventsPerThread;
+
+      OpenThreads::Mutex mNamesMutex;
+      std::set<std::string> mNames;
+
+      unsigned mFrameNumber;
+   };
+
+   //////////////////////////////////////////////////////////////////////////
+   Profiler& Profiler::GetInstance()
+   {
+      static Profiler instance;
+      return instance;
+   }
+
+   //////////////////////////////////////////////////////////////////////////
+   Profiler::Profiler()
+   : mImpl(new ProfilerImpl)
+   {
+   }
+
+   //////////////////////////////////////////////////////////////////////////
+   Profiler::~Profiler()
+   {
+      // Threads still running at exit must not record into buffers that are gone.
+      mEnabled.exchange(0U);
+      delete mImpl;
+      mImpl = NULL;
+   }
+
+   //////////////////////////////////////////////////////////////////////////
+   void Profiler::SetEnabled(bool enabled)
+   {
+      mEnabled.exchange(enabled ? 1U : 0U);
+   }
+
+   //////////////////////////////////////////////////////////////////////////
+   void Profiler::SetEventsPerThread(unsigned numEvents)
+   {
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mImpl->mBuffersMutex);
+      mImpl->mEventsPerThread = numEvents;
+   }
+
+   //////////////////////////////////////////////////////////////////////////
+   unsigned Profiler::GetEventsPerThread() const
+   {
+      return mImpl->mEventsPerThread;
+   }
+
+   //////////////////////////////////////////////////////////////////////////
+   void Profiler::RecordZone(const char* name, osg::Timer_t start, osg::Timer_t end)
+   {
+      ProfileEvent evt = { EVENT_ZONE, name, start, end, 0.0 };
+      mImpl->GetThreadBuffer().Add(evt);
+   }
+
+   //////////////////////////////////////////////////////////////////////////
+   void Profiler::RecordCounter(const char* name, double value)
+   {
+      osg::Timer_t now = osg::Timer::instance()->tick();
+      ProfileEvent evt = { EVENT_COUNTER, name, now, now, value };
+      mImpl->GetThreadBuffer().Add(evt);
+   }
+
+   //////////////////////////////////////////////////////////////////////////
+   void Profiler::MarkFrame()
+   {
+      osg::Timer_t now = osg::Timer::instance()->tick();
+      ProfileEvent evt = { EVENT_FRAME, "Frame", now, now, double(++mImpl->mFrameNumber) };
+      mImpl->GetThreadBuffer().Add(evt);
+   }
+
+   //////////////////////////////////////////////////////////////////////////
+   unsigned Profiler::GetFrameNumber() const
+   {
+      return mImpl->mFrameNumber;
+   }
+
+   //////////////////////////////////////////////////////////////////////////
+   void Profiler::SetThreadName(const std::string& name)
+   {
+      mImpl->GetThreadBuffer().SetThreadName(name);
+   }
+
+   //////////////////////////////////////////////////////////////////////////
+   const char* Profiler::InternName(const std::string& name)
+   {
+      // std::set never moves its elements, so the pointer stays good.
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mImpl->mNamesMutex);
+      return mImpl->mNames.insert(name).first->c_str();
+   }
+
+   //////////////////////////////////////////////////////////////////////////
+   void Profiler::ExportChromeTrace(std::ostream& stream) const
+   {
+      std::vector<dtCore::RefPtr<ThreadEventBuffer> > buffers;
+      {
+         OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mImpl->mBuffersMutex);
+         buffers = mImpl->mBuffers;
+      }
+
+      const osg::Timer& timer = *osg::Timer::instance();
+      const osg::Timer_t startTick = timer.getStartTick();
+
+      const std::ios::fmtflags oldFlags = stream.flags();
+      const std::streamsize oldPrecision = stream.precision();
+
+      stream << "{\"traceEvents\":[";
+      bool first = true;
+
+      std::vector<ProfileEvent> events;
+      std::string threadName;
+      for (size_t i = 0; i < buffers.size(); ++i)
+      {
+         ThreadEventBuffer& buffer = *buffers[i];
+         events.clear();
+         buffer.CopyEvents(events, threadName);
+
+         if (!threadName.empty())
+         {
+            stream << (first ? "\n" : ",\n");
+            first = false;
+            stream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer.mThreadId
+                   << ",\"args\":{\"name\":";
+            WriteJsonString(stream, threadName.c_str());
+            stream << "}}";
+         }
+
+         for (std::vector<ProfileEvent>::const_iterator e = events.begin(); e != events.end(); ++e)
+         {
+            stream << (first ? "\n" : ",\n");
+            first = false;
+
+            stream << "{\"name\":";
+            WriteJsonString(stream, e->mName);
+            stream << ",\"pid\":1,\"tid\":" << buffer.mThreadId
+                   << ",\"ts\":" << std::fixed << std::setprecision(3) << timer.delta_u(startTick, e->mStart);
+
+            switch (e->mType)
+            {
+            case EVENT_ZONE:
+               stream << ",\"ph\":\"X\",\"dur\":" << timer.delta_u(e->mStart, e->mEnd);
+               break;
+            case EVENT_COUNTER:
+               stream << ",\"ph\":\"C\",\"args\":{\"value\":" << std::setprecision(6) << e->mValue << "}";
+               break;
+            case EVENT_FRAME:
+               stream << ",\"ph\":\"i\",\"s\":\"g\",\"args\":{\"frame\":" << std::setprecision(0) << e->mValue << "}";
+               break;
+            }
+            stream << "}";
+         }
+      }
+
+      stream << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+      stream.flags(oldFlags);
+      stream.precision(oldPrecision);
+   }
+
+   //////////////////////////////////////////////////////////////////////////
+   bool Profiler::ExportChromeTrace(const std::string& fileName) const
+   {
+      std::ofstream stream(fileName.c_str(), std::ios::out | std::ios::trunc);
+      if (!stream.is_open())
+      {
+         LOG_ERROR("Unable to open \"" + fileName + "\" to write the profiler trace.");
+         return false;
+      }
+
+      ExportChromeTrace(stream);
+      return !stream.fail();
+   }
+
+   //////////////////////////////////////////////////////////////////////////
+   void Profiler::Clear()
+   {
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mImpl->mBuffersMutex);
+      for (size_t i = 0; i < mImpl->mBuffers.size(); ++i)
+      {
+         mImpl->mBuffers[i]->Clear(mImpl->mEventsPerThread);
+      }
+      mImpl->mFrameNumber = 0U;
+   }
+}
@@ -28,6 +28,7 @@ namespace dtUtil
    : mUseFileCaching(true)
    , mComplete(false)
    {
+      SetName("Read Node");
    }
 
    ///////////////////////////////////////////////////////////////////////////////
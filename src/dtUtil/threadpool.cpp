@@ -28,6 +28,7 @@
 
 #include <dtUtil/mswinmacros.h>
 #include <dtUtil/mathdefines.h>
+#include <dtUtil/profiler.h>
 
 #include <OpenThreads/Thread>
 #include <OpenThreads/Atomic>
@@ -289,7 +290,10 @@ template<class _Ty,
       else
       {
          /// execute
-         (*currentTask)();
+         {
+            DT_PROFILE_ZONE_DYNAMIC(currentTask->GetName().Get());
+            (*currentTask)();
+         }
 
          if (currentTask->GetKeep())
          {
@@ -405,6 +409,8 @@ template<class _Ty,
    {
       bool firstTime = true;
 
+      DT_PROFILE_THREAD_NAME("ThreadPool Worker");
+
       // Run Loop
       while (!mDone)
       {
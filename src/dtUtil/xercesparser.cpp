@@ -10,6 +10,7 @@
 #include <xercesc/util/PlatformUtils.hpp>
 #include <xercesc/util/XMLUni.hpp>
 #include <xercesc/util/XMLString.hpp>
+#include <xercesc/framework/MemBufInputSource.hpp>
 #include <xercesc/sax2/XMLReaderFactory.hpp>
 #include <xercesc/validators/common/Grammar.hpp>
 
@@ -77,6 +78,41 @@ bool XercesParser::Parse(const std::string& datafile,
       return false;
    }
 
+   dtUtil::XercesErrorHandler xmlerror;                         // instantiate the error handler
+   if (!CreateReader(handler, xmlerror, schemafile))
+   {
+      return false;
+   }
+
+   bool retVal(false);
+   try // to parse the file
+   {
+      LOG_DEBUG("About to parse file: " + filename)
+      mParser->parse(filename.c_str());
+      LOG_DEBUG("...done parsing file: " + filename)
+      retVal = true;
+   }
+   catch (const XMLException& e)
+   {
+      char* message = XMLString::transcode(e.getMessage());
+      LOG_ERROR(std::string("Exception message is: ") + message)
+      XMLString::release(&message);
+   }
+   catch (const SAXParseException&)
+   {
+      // problem with the xml parsing.  Not much to do here since the XercesErrorHandler
+      // will report it for us.
+      retVal = false;
+   }
+
+   return retVal;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool XercesParser::CreateReader(XERCES_CPP_NAMESPACE_QUALIFIER ContentHandler& handler,
+                                XERCES_CPP_NAMESPACE_QUALIFIER ErrorHandler& errorHandler,
+                                const std::string& schemafile)
+{
    try  // to inialize the xmlutils
    {
       XMLPlatformUtils::Initialize();
@@ -94,13 +130,15 @@ bool XercesParser::Parse(const std::string& datafile,
       return false;
    }
 
-   dtUtil::XercesErrorHandler xmlerror;                         // instantiate the error handler
-
    try // to create a reader
    {
+      // A parser may be used more than once, so don't leak the previous reader.
+      delete mParser;
+      mParser = NULL;
+
       mParser = XMLReaderFactory::createXMLReader();        // allocate the mParser
       mParser->setContentHandler(&handler);
-      mParser->setErrorHandler(&xmlerror);
+      mParser->setErrorHandler(&errorHandler);
 
       if (!schemafile.empty())
       {
@@ -142,12 +180,28 @@ bool XercesParser::Parse(const std::string& datafile,
       return false;
    }
 
+   return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool XercesParser::ParseBuffer(const char* data, size_t length, const std::string& bufferId,
+                               XERCES_CPP_NAMESPACE_QUALIFIER ContentHandler& handler,
+                               const std::string& schemafile)
+{
+   dtUtil::XercesErrorHandler xmlerror;
+   if (!CreateReader(handler, xmlerror, schemafile))
+   {
+      return false;
+   }
+
    bool retVal(false);
-   try // to parse the file
+   try // to parse the buffer
    {
-      LOG_DEBUG("About to parse file: " + filename)
-      mParser->parse(filename.c_str());
-      LOG_DEBUG("...done parsing file: " + filename)
+      // The source doesn't adopt the buffer, so the caller keeps ownership.
+      MemBufInputSource source(reinterpret_cast<const XMLByte*>(data), XMLSize_t(length), bufferId.c_str(), false);
+      LOG_DEBUG("About to parse buffer: " + bufferId)
+      mParser->parse(source);
+      LOG_DEBUG("...done parsing buffer: " + bufferId)
       retVal = true;
    }
    catch (const XMLException& e)
@@ -158,12 +212,9 @@ bool XercesParser::Parse(const std::string& datafile,
    }
    catch (const SAXParseException&)
    {
-      // problem with the xml parsing.  Not much to do here since the XercesErrorHandler
-      // will report it for us.
+      // The XercesErrorHandler reports the problem.
       retVal = false;
    }
 
    return retVal;
 }
-
-////////////////////////////////////////////////////////////////////////////////
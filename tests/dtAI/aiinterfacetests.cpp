@@ -27,6 +27,9 @@
 #include <dtAI/aiplugininterface.h>
 #include <dtAI/aiactorregistry.h>
 #include <dtAI/aiinterfaceactor.h>
+#include <dtAI/waypointpropertycontainer.h>
+#include <dtAI/waypointtypes.h>
+#include <dtCore/actorproperty.h>
 #include <dtCore/actorfactory.h>
 #include <dtCore/refptr.h>
 #include <osg/Vec3>
@@ -37,6 +40,8 @@ namespace dtAI
    {
       CPPUNIT_TEST_SUITE(AIInterfaceTests);
       CPPUNIT_TEST( TestAddRemoveWaypoints );
+      CPPUNIT_TEST( TestBatchQueries );
+      CPPUNIT_TEST( TestRenameWaypoints );
       CPPUNIT_TEST( TestAddRemoveEdge );
       CPPUNIT_TEST( TestPathfinding );
       CPPUNIT_TEST( TestLoadSave );
@@ -49,6 +54,8 @@ namespace dtAI
          void tearDown();
          
          void TestAddRemoveWaypoints();
+         void TestBatchQueries();
+         void TestRenameWaypoints();
          void TestAddRemoveEdge();
          void TestPathfinding();
          void TestLoadSave();
@@ -179,9 +186,115 @@ namespace dtAI
 
    }
 
+   void AIInterfaceTests::TestBatchQueries()
+   {
+      std::vector<dtCore::RefPtr<const dtCore::ObjectType> > objectTypes;
+      mAIInterface->GetSupportedWaypointTypes(objectTypes);
+      CPPUNIT_ASSERT(!objectTypes.empty());
+
+      // a 10x10 grid, 2 units apart.
+      for (unsigned x = 0; x < 10; ++x)
+      {
+         for (unsigned y = 0; y < 10; ++y)
+         {
+            CPPUNIT_ASSERT(mAIInterface->CreateWaypoint(osg::Vec3(2.0f * x, 2.0f * y, 0.0f), *(objectTypes[0])) != NULL);
+         }
+      }
+
+      std::vector<osg::Vec3> queries;
+      for (unsigned i = 0; i < 200; ++i)
+      {
+         queries.push_back(osg::Vec3(0.13f * i - 2.0f, 0.09f * i, 0.5f));
+      }
+
+      AIPluginInterface::WaypointArray closest;
+      mAIInterface->GetClosestWaypointsBatch(queries, 3.0f, closest);
+      CPPUNIT_ASSERT_EQUAL(queries.size(), closest.size());
+
+      std::vector<AIPluginInterface::WaypointArray> atRadius;
+      mAIInterface->GetWaypointsAtRadiusBatch(queries, 3.0f, atRadius);
+      CPPUNIT_ASSERT_EQUAL(queries.size(), atRadius.size());
+
+      std::vector<AIPluginInterface::WaypointArray> nearest;
+      mAIInterface->GetNearestWaypointsBatch(queries, 4U, 5.0f, nearest);
+      CPPUNIT_ASSERT_EQUAL(queries.size(), nearest.size());
+
+      for (unsigned i = 0; i < queries.size(); ++i)
+      {
+         CPPUNIT_ASSERT(mAIInterface->GetClosestWaypoint(queries[i], 3.0f) == closest[i]);
+
+         AIPluginInterface::WaypointArray single;
+         mAIInterface->GetWaypointsAtRadius(queries[i], 3.0f, single);
+         CPPUNIT_ASSERT_EQUAL(single.size(), atRadius[i].size());
+
+         CPPUNIT_ASSERT(nearest[i].size() <= 4U);
+         for (unsigned j = 1; j < nearest[i].size(); ++j)
+         {
+            CPPUNIT_ASSERT((nearest[i][j - 1]->GetPosition() - queries[i]).length2() <=
+                     (nearest[i][j]->GetPosition() - queries[i]).length2());
+         }
+
+         if (closest[i] != NULL)
+         {
+            CPPUNIT_ASSERT(!nearest[i].empty());
+            CPPUNIT_ASSERT(nearest[i].front() == closest[i]);
+         }
+      }
+
+      // edits between queries must be visible without a full rebuild.
+      WaypointInterface* moved = mAIInterface->GetClosestWaypoint(osg::Vec3(), 1.0f);
+      CPPUNIT_ASSERT(moved != NULL);
+      CPPUNIT_ASSERT(mAIInterface->MoveWaypoint(moved, osg::Vec3(-50.0f, -50.0f, 0.0f)));
+      CPPUNIT_ASSERT(mAIInterface->GetClosestWaypoint(osg::Vec3(-50.0f, -50.0f, 0.0f), 1.0f) == moved);
+      CPPUNIT_ASSERT(mAIInterface->GetClosestWaypoint(osg::Vec3(), 1.0f) == NULL);
+
+      AIPluginInterface::WaypointArray byType;
+      mAIInterface->GetWaypointsByType(*(objectTypes[0]), byType);
+      CPPUNIT_ASSERT_EQUAL(size_t(100), byType.size());
+
+      CPPUNIT_ASSERT(mAIInterface->RemoveWaypoint(moved));
+      CPPUNIT_ASSERT(mAIInterface->GetClosestWaypoint(osg::Vec3(-50.0f, -50.0f, 0.0f), 1.0f) == NULL);
+      byType.clear();
+      mAIInterface->GetWaypointsByType(*(objectTypes[0]), byType);
+      CPPUNIT_ASSERT_EQUAL(size_t(99), byType.size());
+   }
+
    //most of these are currently being tested in waypointgraphtests.cpp,
    //and are placeholders here
 
+   void AIInterfaceTests::TestRenameWaypoints()
+   {
+      dtCore::RefPtr<NamedWaypoint> named = new NamedWaypoint(osg::Vec3(1.0f, 2.0f, 3.0f), "Alpha");
+      mAIInterface->InsertWaypoint(named.get());
+      CPPUNIT_ASSERT(mAIInterface->GetWaypointByName("Alpha") == named.get());
+
+      named->SetName("Bravo");
+      CPPUNIT_ASSERT(mAIInterface->GetWaypointByName("Alpha") == NULL);
+      CPPUNIT_ASSERT(mAIInterface->GetWaypointByName("Bravo") == named.get());
+
+      WaypointArray wpArray;
+      mAIInterface->GetWaypointsByName("Bravo", wpArray);
+      CPPUNIT_ASSERT_EQUAL(size_t(1), wpArray.size());
+      CPPUNIT_ASSERT(wpArray[0] == named.get());
+      CPPUNIT_ASSERT(mAIInterface->GetClosestNamedWaypoint("Bravo", osg::Vec3(), 100.0f) == named.get());
+
+      // Renaming through the property goes through SetName, so the index has to follow it too.
+      dtCore::RefPtr<WaypointPropertyBase> container =
+         mAIInterface->CreateWaypointPropertyContainer(*WaypointTypes::NAMED_WAYPOINT, named.get());
+      CPPUNIT_ASSERT(container.valid());
+      dtCore::ActorProperty* nameProp = container->GetProperty("WaypointName");
+      CPPUNIT_ASSERT(nameProp != NULL);
+      nameProp->FromString("Charlie");
+
+      CPPUNIT_ASSERT(mAIInterface->GetWaypointByName("Bravo") == NULL);
+      CPPUNIT_ASSERT(mAIInterface->GetClosestNamedWaypoint("Bravo", osg::Vec3(), 100.0f) == NULL);
+      CPPUNIT_ASSERT(mAIInterface->GetWaypointByName("Charlie") == named.get());
+      CPPUNIT_ASSERT(mAIInterface->GetClosestNamedWaypoint("Charlie", osg::Vec3(), 100.0f) == named.get());
+
+      CPPUNIT_ASSERT(mAIInterface->RemoveWaypoint(named.get()));
+      CPPUNIT_ASSERT(mAIInterface->GetWaypointByName("Charlie") == NULL);
+   }
+
    void AIInterfaceTests::TestAddRemoveEdge()
    {
 
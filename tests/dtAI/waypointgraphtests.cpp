@@ -30,6 +30,7 @@
 #include <dtAI/waypointgraphbuilder.h>
 #include <dtAI/waypointtypes.h>
 #include <dtAI/waypointgraphastar.h>
+#include <dtAI/pathrequestqueue.h>
 #include <dtAI/aiplugininterface.h>
 #include <dtAI/aiinterfaceactor.h>
 #include <dtAI/aiactorregistry.h>
@@ -38,12 +39,20 @@
 
 #include <dtCore/refptr.h>
 #include <dtUtil/mathdefines.h>
+#include <dtUtil/threadpool.h>
 #include <algorithm>
 
 namespace dtAI
 {
    typedef dtCore::ObserverPtr<Waypoint> WaypointWeakPtr;
 
+   struct PathRequestCounter
+   {
+      PathRequestCounter() : mCount(0U) {}
+      void OnComplete(const PathRequest& request) { if (request.IsComplete()) { ++mCount; } }
+      unsigned mCount;
+   };
+
    class WaypointGraphTests : public CPPUNIT_NS::TestFixture
    {
       CPPUNIT_TEST_SUITE(WaypointGraphTests);
@@ -57,6 +66,9 @@ namespace dtAI
       CPPUNIT_TEST(TestLoadSave);
       CPPUNIT_TEST(TestClearMemory);
       CPPUNIT_TEST(TestAddDuplicates);
+      CPPUNIT_TEST(TestPathCache);
+      CPPUNIT_TEST(TestPathRequestQueue);
+      CPPUNIT_TEST(TestParallelPathRequests);
       CPPUNIT_TEST_SUITE_END();
 
    public:
@@ -75,6 +87,9 @@ namespace dtAI
       void TestCollectionBounds();
       void TestAddDuplicates();
       void TestTreeTraversal();
+      void TestPathCache();
+      void TestPathRequestQueue();
+      void TestParallelPathRequests();
 
    private:
       void CreateWaypoints();
@@ -741,5 +756,151 @@ void WaypointGraphTests::TestAddDuplicates()
 
 }
 
+void WaypointGraphTests::TestPathCache()
+{
+   CreateWaypoints();
+
+   WaypointGraphAStar astar(*mGraph);
+   WaypointGraphAStar cachedAStar(*mGraph);
+   dtCore::RefPtr<AbstractPathCache> cache = new AbstractPathCache;
+   cachedAStar.SetPathCache(cache.get());
+
+   for (int pass = 0; pass < 2; ++pass)
+   {
+      for (int i = 1; i < 17; i += 3)
+      {
+         for (int j = 1; j < 17; j += 2)
+         {
+            if (i != j)
+            {
+               WaypointGraph::ConstWaypointArray path, cachedPath;
+               CPPUNIT_ASSERT_EQUAL(PATH_FOUND, astar.HierarchicalFindPath(wpArray[i], wpArray[j], path));
+               CPPUNIT_ASSERT_EQUAL(PATH_FOUND, cachedAStar.HierarchicalFindPath(wpArray[i], wpArray[j], cachedPath));
+               CPPUNIT_ASSERT_MESSAGE("A cached search should find the same path.", path == cachedPath);
+            }
+         }
+      }
+   }
+
+   CPPUNIT_ASSERT(cache->GetNumPaths() > 0U);
+   CPPUNIT_ASSERT(cache->GetNumHits() > 0U);
+
+   // Any change to the graph makes the cached paths stale.
+   unsigned revision = mGraph->GetRevision();
+   mGraph->RemoveEdge(wpArray[1], wpArray[2]);
+   mGraph->AddEdge(wpArray[1], wpArray[2]);
+   CPPUNIT_ASSERT(mGraph->GetRevision() != revision);
+
+   WaypointGraph::ConstWaypointArray unused;
+   CPPUNIT_ASSERT(!cache->Find(*mGraph, wpArray[1], wpArray[16], unused));
+   CPPUNIT_ASSERT_EQUAL(size_t(0), cache->GetNumPaths());
+}
+
+void WaypointGraphTests::TestPathRequestQueue()
+{
+   CreateWaypoints();
+
+   PathRequestQueue* queue = mAIInterface->GetPathRequestQueue();
+   CPPUNIT_ASSERT(queue != NULL);
+   queue->SetMaxSearchesPerUpdate(2U);
+
+   PathRequestCounter counter;
+   PathRequest::CompleteCallback callback(&counter, &PathRequestCounter::OnComplete);
+
+   PathRequestQueue::WaypointIDPairArray fromTo;
+   fromTo.push_back(std::make_pair(wpArray[5], wpArray[14]));
+   fromTo.push_back(std::make_pair(wpArray[5], wpArray[14]));
+   fromTo.push_back(std::make_pair(wpArray[2], wpArray[9]));
+   fromTo.push_back(std::make_pair(wpArray[3], wpArray[12]));
+
+   PathRequestQueue::PathRequestArray requests;
+   queue->RequestPaths(fromTo, requests, true, callback);
+   CPPUNIT_ASSERT_EQUAL(size_t(4), requests.size());
+   dtCore::RefPtr<PathRequest> cancelled = queue->RequestPath(wpArray[1], wpArray[16]);
+   cancelled->Cancel();
+   CPPUNIT_ASSERT_EQUAL(size_t(5), queue->GetNumPending());
+
+   // The duplicate rides along with the first search, so two searches complete three requests.
+   CPPUNIT_ASSERT_EQUAL(3U, queue->Update());
+   CPPUNIT_ASSERT_EQUAL(3U, counter.mCount);
+   CPPUNIT_ASSERT(requests[0]->IsComplete());
+   CPPUNIT_ASSERT(requests[1]->IsComplete());
+   CPPUNIT_ASSERT(requests[2]->IsComplete());
+   CPPUNIT_ASSERT(!requests[3]->IsComplete());
+   CPPUNIT_ASSERT(requests[0]->GetPath() == requests[1]->GetPath());
+
+   WaypointGraph::ConstWaypointArray path;
+   CPPUNIT_ASSERT_EQUAL(PATH_FOUND, mAIInterface->HierarchicalFindPath(wpArray[5], wpArray[14], path));
+   CPPUNIT_ASSERT_EQUAL(PATH_FOUND, requests[0]->GetResult());
+   CPPUNIT_ASSERT(requests[0]->GetPath() == path);
+
+   queue->Flush();
+   CPPUNIT_ASSERT(requests[3]->IsComplete());
+   CPPUNIT_ASSERT_EQUAL(4U, counter.mCount);
+   CPPUNIT_ASSERT_EQUAL(PathRequest::CANCELLED, cancelled->GetStatus());
+   CPPUNIT_ASSERT_EQUAL(size_t(0), queue->GetNumPending());
+   CPPUNIT_ASSERT_EQUAL(0U, queue->Update());
+
+   queue->SetMaxSearchesPerUpdate(PathRequestQueue::DEFAULT_MAX_SEARCHES_PER_UPDATE);
 }
 
+void WaypointGraphTests::TestParallelPathRequests()
+{
+   bool startedThreadPool = !dtUtil::ThreadPool::IsInitialized();
+   if (startedThreadPool)
+   {
+      dtUtil::ThreadPool::Init(3);
+   }
+
+   CreateWaypoints();
+
+   // Every ordered pair, both ways of searching, so each worker gets plenty of searches.
+   PathRequestQueue::WaypointIDPairArray fromTo;
+   for (size_t i = 1; i < wpArray.size(); ++i)
+   {
+      for (size_t j = 1; j < wpArray.size(); ++j)
+      {
+         if (i != j)
+         {
+            fromTo.push_back(std::make_pair(wpArray[i], wpArray[j]));
+         }
+      }
+   }
+   CPPUNIT_ASSERT(fromTo.size() >= 4U * dtUtil::ThreadPool::GetNumImmediateWorkerThreads());
+
+   PathRequestQueue* queue = mAIInterface->GetPathRequestQueue();
+   queue->SetMaxSearchesPerUpdate(0U);
+
+   PathRequestCounter counter;
+   PathRequest::CompleteCallback callback(&counter, &PathRequestCounter::OnComplete);
+   PathRequestQueue::PathRequestArray hierarchical, singleLevel;
+   queue->RequestPaths(fromTo, hierarchical, true, callback);
+   queue->RequestPaths(fromTo, singleLevel, false, callback);
+
+   CPPUNIT_ASSERT_EQUAL(unsigned(2U * fromTo.size()), queue->Update());
+   CPPUNIT_ASSERT_EQUAL(unsigned(2U * fromTo.size()), counter.mCount);
+   CPPUNIT_ASSERT_EQUAL(size_t(0), queue->GetNumPending());
+
+   // The searches split across the workers must match the same searches run one at a time.
+   WaypointGraphAStar astar(*mGraph);
+   for (size_t i = 0; i < fromTo.size(); ++i)
+   {
+      WaypointGraph::ConstWaypointArray path;
+      CPPUNIT_ASSERT(hierarchical[i]->IsComplete());
+      CPPUNIT_ASSERT_EQUAL(astar.HierarchicalFindPath(fromTo[i].first, fromTo[i].second, path), hierarchical[i]->GetResult());
+      CPPUNIT_ASSERT(hierarchical[i]->GetPath() == path);
+
+      path.clear();
+      CPPUNIT_ASSERT(singleLevel[i]->IsComplete());
+      CPPUNIT_ASSERT_EQUAL(astar.FindSingleLevelPath(fromTo[i].first, fromTo[i].second, path), singleLevel[i]->GetResult());
+      CPPUNIT_ASSERT(singleLevel[i]->GetPath() == path);
+   }
+
+   queue->SetMaxSearchesPerUpdate(PathRequestQueue::DEFAULT_MAX_SEARCHES_PER_UPDATE);
+   if (startedThreadPool)
+   {
+      dtUtil::ThreadPool::Shutdown();
+   }
+}
+
+}
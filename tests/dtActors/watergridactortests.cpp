@@ -0,0 +1,149 @@
+/* -*-c++-*-
+ * allTests - This source file (.h & .cpp) - Using 'The MIT License'
+ * Copyright (C) 2014, Caper Holdings, LLC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <prefix/unittestprefix.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <dtActors/watergridactor.h>
+#include <dtActors/engineactorregistry.h>
+
+#include <dtCore/system.h>
+
+#include <dtUtil/mathdefines.h>
+
+#include "../dtGame/basegmtests.h"
+
+#include <vector>
+
+namespace dtActors
+{
+   class WaterGridActorTests : public dtGame::BaseGMTestFixture
+   {
+      CPPUNIT_TEST_SUITE(WaterGridActorTests);
+         CPPUNIT_TEST(TestBatchedQueriesMatchScalar);
+         CPPUNIT_TEST(TestQueryReferencePosition);
+      CPPUNIT_TEST_SUITE_END();
+
+   public:
+      ///////////////////////////////////////////////////////////////////////////////
+      void setUp() override
+      {
+         dtGame::BaseGMTestFixture::setUp();
+         try
+         {
+            mGM->CreateActor(*dtActors::EngineActorRegistry::WATER_GRID_ACTOR_TYPE, mProxy);
+            CPPUNIT_ASSERT(mProxy.valid());
+            mGM->AddActor(*mProxy, false, false);
+
+            mProxy->GetDrawable(mActor);
+            mActor->Initialize();
+            mActor->SetSeaState(WaterGridActor::SeaState::SeaState_5);
+            mActor->SetUseQueryReferencePosition(true);
+            mActor->SetQueryReferencePosition(osg::Vec3(25.0f, -40.0f, 10.0f));
+         }
+         catch (const dtUtil::Exception& e)
+         {
+            CPPUNIT_FAIL(e.ToString());
+         }
+      }
+
+      ///////////////////////////////////////////////////////////////////////////////
+      void tearDown() override
+      {
+         mActor = NULL;
+         mProxy = NULL;
+         dtGame::BaseGMTestFixture::tearDown();
+      }
+
+      ///////////////////////////////////////////////////////////////////////////////
+      void TestBatchedQueriesMatchScalar()
+      {
+         // More than one block of points, from close by to past the edge of the grid.
+         std::vector<osg::Vec3> points;
+         for (unsigned i = 0; i < 150; ++i)
+         {
+            points.push_back(osg::Vec3(dtUtil::RandFloat(-3000.0f, 3000.0f), dtUtil::RandFloat(-3000.0f, 3000.0f), 0.0f));
+         }
+         points.push_back(mActor->GetQueryReferencePosition());
+
+         // Step a few times so the waves have moved.
+         for (unsigned step = 0; step < 3; ++step)
+         {
+            dtCore::System::GetInstance().Step(0.37f);
+            CheckBatchMatchesScalar(points);
+         }
+      }
+
+      ///////////////////////////////////////////////////////////////////////////////
+      void TestQueryReferencePosition()
+      {
+         dtCore::System::GetInstance().Step(0.5f);
+
+         std::vector<osg::Vec3> points;
+         points.push_back(osg::Vec3(10.0f, 20.0f, 0.0f));
+         points.push_back(osg::Vec3(-400.0f, 250.0f, 0.0f));
+
+         std::vector<float> firstHeights, secondHeights;
+         std::vector<osg::Vec3> normals;
+         mActor->GetHeightsAndNormalsAtPoints(points, firstHeights, normals);
+         mActor->GetHeightsAndNormalsAtPoints(points, secondHeights, normals);
+         CPPUNIT_ASSERT(firstHeights == secondHeights);
+
+         // The detail of the waves depends on the distance to the reference, so it must be used.
+         mActor->SetQueryReferencePosition(osg::Vec3(2000.0f, 2000.0f, 0.0f));
+         mActor->GetHeightsAndNormalsAtPoints(points, secondHeights, normals);
+         CPPUNIT_ASSERT(firstHeights != secondHeights);
+         CheckBatchMatchesScalar(points);
+
+         // The normals can be skipped.
+         std::vector<float> heights(points.size());
+         mActor->GetHeightsAndNormalsAtPoints(&points[0], unsigned(points.size()), &heights[0], NULL);
+         CPPUNIT_ASSERT(heights == secondHeights);
+      }
+
+   private:
+      ///////////////////////////////////////////////////////////////////////////////
+      void CheckBatchMatchesScalar(const std::vector<osg::Vec3>& points)
+      {
+         std::vector<float> heights;
+         std::vector<osg::Vec3> normals;
+         mActor->GetHeightsAndNormalsAtPoints(points, heights, normals);
+         CPPUNIT_ASSERT_EQUAL(points.size(), heights.size());
+         CPPUNIT_ASSERT_EQUAL(points.size(), normals.size());
+
+         for (size_t i = 0; i < points.size(); ++i)
+         {
+            float height = 0.0f;
+            osg::Vec3 normal;
+            CPPUNIT_ASSERT(mActor->GetHeightAndNormalAtPoint(points[i], height, normal));
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(height, heights[i], 1e-3);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, (normal - normals[i]).length(), 1e-5);
+         }
+      }
+
+      dtCore::RefPtr<dtGame::GameActorProxy> mProxy;
+      WaterGridActor* mActor;
+   };
+
+   CPPUNIT_TEST_SUITE_REGISTRATION(WaterGridActorTests);
+}
@@ -79,6 +79,7 @@ namespace dtAnim
    {
       CPPUNIT_TEST_SUITE(AnimationComponentTests);
          CPPUNIT_TEST(TestAnimationComponent);
+         CPPUNIT_TEST(TestAnimationLODSchedule);
          CPPUNIT_TEST(TestAnimationPerformance);
          CPPUNIT_TEST(TestRegisterUnregister);
          CPPUNIT_TEST(TestRegisterMapUnload);
@@ -97,6 +98,7 @@ namespace dtAnim
       void tearDown() override;
 
       void TestAnimationComponent();
+      void TestAnimationLODSchedule();
       void TestAnimationPerformance();
       void TestRegisterUnregister();
       void TestRegisterMapUnload();
@@ -274,6 +276,31 @@ namespace dtAnim
       CPPUNIT_ASSERT(mHelper->HasBeenUpdated());
    }
 
+   /////////////////////////////////////////////////////////////////////////////
+   void AnimationComponentTests::TestAnimationLODSchedule()
+   {
+      CPPUNIT_ASSERT(!mAnimComp->GetAnimationLODEnabled());
+
+      mAnimComp->SetFullRateAnimationDistance(10.0f);
+      mAnimComp->SetHalfRateAnimationDistance(20.0f);
+      CPPUNIT_ASSERT_EQUAL(1U, mAnimComp->GetAnimationUpdateInterval(5.0f));
+      CPPUNIT_ASSERT_EQUAL(2U, mAnimComp->GetAnimationUpdateInterval(15.0f));
+      CPPUNIT_ASSERT_EQUAL(4U, mAnimComp->GetAnimationUpdateInterval(25.0f));
+
+      dtCore::RefPtr<TestAnimHelper> helper = new TestAnimHelper();
+      mAnimComp->RegisterActor(*mTestGameActor, *helper);
+      CPPUNIT_ASSERT_MESSAGE("The component updates the attachments after the parallel update.",
+               helper->GetDeferAttachmentUpdate());
+
+      // A character without a node can't be culled, so it is updated every frame.
+      mAnimComp->SetAnimationLODEnabled(true);
+      dtCore::System::GetInstance().Step();
+      CPPUNIT_ASSERT(helper->HasBeenUpdated());
+
+      mAnimComp->UnregisterActor(mTestGameActor->GetId());
+      CPPUNIT_ASSERT(!helper->GetDeferAttachmentUpdate());
+   }
+
    /////////////////////////////////////////////////////////////////////////////
    void AnimationComponentTests::TestAnimationPerformance()
    {
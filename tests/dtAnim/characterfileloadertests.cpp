@@ -37,12 +37,15 @@
 #include <dtAnim/basemodelwrapper.h>
 #include <dtAnim/cal3dmodeldata.h>
 #include <dtAnim/cal3dmodelwrapper.h>
+#include <dtAnim/characterbundle.h>
+#include <dtAnim/characterfileloader.h>
 #include <dtAnim/modeldatabase.h>
 #include <dtAnim/sequencemixer.h>
 
 #include <dtCore/refptr.h>
 #include <dtCore/project.h>
 #include <dtUtil/datapathutils.h>
+#include <dtUtil/fileutils.h>
 #include <dtUtil/refstring.h>
 #include <dtUtil/mathdefines.h>
 
@@ -65,6 +68,7 @@ namespace dtAnim
          CPPUNIT_TEST(TestModelScale);
          CPPUNIT_TEST(TestModelData);
          CPPUNIT_TEST(TestModelDataFileRegistration);
+         CPPUNIT_TEST(TestCharacterBundle);
       CPPUNIT_TEST_SUITE_END();
 
       public:
@@ -472,6 +476,47 @@ namespace dtAnim
             nameList.clear();
          }
 
+         void TestCharacterBundle()
+         {
+            dtCore::ResourceDescriptor modelPath("SkeletalMeshes:Marine:marine_test.xml");
+            const std::string characterFile = dtCore::Project::GetInstance().GetResourcePath(modelPath);
+
+            // Don't write it next to the character, where the model database would pick it up for the other tests.
+            const std::string bundleFile("marine_test_bundle." + CharacterBundle::FILE_EXTENSION);
+            CPPUNIT_ASSERT(CharacterBundle::Compile(characterFile, bundleFile));
+            CPPUNIT_ASSERT(CharacterBundle::IsBundleFile(bundleFile));
+            CPPUNIT_ASSERT(!CharacterBundle::IsBundleFile(characterFile));
+
+            dtCore::RefPtr<CharacterBundle> bundle = new CharacterBundle;
+            CPPUNIT_ASSERT(bundle->Read(bundleFile));
+            dtUtil::FileUtils::GetInstance().FileDelete(bundleFile);
+
+            dtCore::RefPtr<CharacterFileLoader> fileLoader = new CharacterFileLoader;
+            dtCore::RefPtr<CharacterFileHandler> fileHandler = fileLoader->LoadCharacterFile(characterFile);
+            CPPUNIT_ASSERT(fileHandler.valid());
+
+            const CharacterBundle::Entry* skeleton = bundle->FindEntry(CharacterBundle::ENTRY_SKELETON, fileHandler->mSkeletonFilename);
+            CPPUNIT_ASSERT_MESSAGE("The skeleton should be packed under the name the character file uses.", skeleton != NULL);
+            CPPUNIT_ASSERT_EQUAL_MESSAGE("Every file should be followed by a NUL.", '\0', bundle->GetData(*skeleton)[skeleton->mSize]);
+            CPPUNIT_ASSERT_EQUAL_MESSAGE("Every file should be aligned for reading in place.", 0U, skeleton->mOffset % 16U);
+
+            for (size_t i = 0; i < fileHandler->mMeshes.size(); ++i)
+            {
+               CPPUNIT_ASSERT(bundle->FindEntry(CharacterBundle::ENTRY_MESH, fileHandler->mMeshes[i].mFileName) != NULL);
+            }
+            for (size_t i = 0; i < fileHandler->mAnimations.size(); ++i)
+            {
+               CPPUNIT_ASSERT(bundle->FindEntry(CharacterBundle::ENTRY_ANIMATION, fileHandler->mAnimations[i].mFileName) != NULL);
+            }
+
+            dtCore::RefPtr<CharacterFileHandler> bundleHandler = fileLoader->LoadCharacterFile(*bundle);
+            CPPUNIT_ASSERT(bundleHandler.valid());
+            CPPUNIT_ASSERT(bundleHandler->mBundle == bundle);
+            CPPUNIT_ASSERT_EQUAL(fileHandler->mName, bundleHandler->mName);
+            CPPUNIT_ASSERT_EQUAL(fileHandler->mAnimations.size(), bundleHandler->mAnimations.size());
+            CPPUNIT_ASSERT_EQUAL(fileHandler->mAnimationChannels.size(), bundleHandler->mAnimationChannels.size());
+         }
+
       private:
 
          void TestEmptyHelper()
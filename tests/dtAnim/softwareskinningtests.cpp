@@ -0,0 +1,398 @@
+/* -*-c++-*-
+ * allTests - This source file (.h & .cpp) - Using 'The MIT License'
+ * Copyright (C) 2014, Caper Holdings LLC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <prefix/unittestprefix.h>
+#include "AnimModelLoadingTestFixture.h"
+
+#include <dtAnim/animationhelper.h>
+#include <dtAnim/cal3danimator.h>
+#include <dtAnim/cal3dmodelwrapper.h>
+#include <dtAnim/cal3dobjects.h>
+#include <dtAnim/posecache.h>
+#include <dtAnim/softwareskinning.h>
+
+#include <dtCore/project.h>
+#include <dtCore/refptr.h>
+#include <dtUtil/log.h>
+#include <dtUtil/mathdefines.h>
+
+#include <cal3d/coresubmesh.h>
+#include <cal3d/mesh.h>
+#include <cal3d/model.h>
+#include <cal3d/submesh.h>
+
+#include <osg/Matrix>
+#include <osg/Quat>
+#include <osg/Timer>
+
+#include <cmath>
+#include <sstream>
+#include <vector>
+
+namespace dtAnim
+{
+   class SoftwareSkinningTests : public AnimModelLoadingTestFixture
+   {
+      CPPUNIT_TEST_SUITE(SoftwareSkinningTests);
+      CPPUNIT_TEST(TestSimdMatchesScalar);
+      CPPUNIT_TEST(TestRootTransform);
+      CPPUNIT_TEST(TestMatchesCal3D);
+      CPPUNIT_TEST(TestSubmeshLevelOfDetail);
+      CPPUNIT_TEST(TestPoseSharing);
+      CPPUNIT_TEST_SUITE_END();
+
+   public:
+      static const unsigned NUM_BONES = 64;
+      static const unsigned NUM_VERTICES = 20000;
+
+      //////////////////////////////////////////////////////////////////////////
+      void setUp() override
+      {
+         AnimModelLoadingTestFixture::setUp();
+         dtCore::Project::GetInstance().SetContext("../examples/data");
+      }
+
+      //////////////////////////////////////////////////////////////////////////
+      void tearDown() override
+      {
+         AnimModelLoadingTestFixture::tearDown();
+      }
+
+      //////////////////////////////////////////////////////////////////////////
+      void TestSimdMatchesScalar()
+      {
+         SoftwareSkinning::SkinnedMesh mesh;
+         SoftwareSkinning::BonePalette palette;
+         MakeRandomMesh(mesh, palette);
+
+         // Skin into an interleaved buffer like the submesh VBO to make sure nothing past xyz is written.
+         const unsigned STRIDE = 10;
+         const float SENTINEL = -12345.0f;
+         std::vector<float> scalar(NUM_VERTICES * STRIDE, SENTINEL);
+         std::vector<float> simd(NUM_VERTICES * STRIDE, SENTINEL);
+
+         SoftwareSkinning::SkinVerticesScalar(mesh, &palette[0], &scalar[0], &scalar[3], STRIDE);
+         SoftwareSkinning::SkinVertices(mesh, &palette[0], &simd[0], &simd[3], STRIDE);
+
+         for (unsigned v = 0; v < NUM_VERTICES; ++v)
+         {
+            for (unsigned i = 0; i < 6; ++i)
+            {
+               CPPUNIT_ASSERT_DOUBLES_EQUAL(scalar[v * STRIDE + i], simd[v * STRIDE + i], 1e-4f);
+            }
+            for (unsigned i = 6; i < STRIDE; ++i)
+            {
+               CPPUNIT_ASSERT_EQUAL(SENTINEL, simd[v * STRIDE + i]);
+            }
+         }
+
+         // Not an assertion, since the machines running the tests vary too much.
+         const unsigned ITERATIONS = 20;
+         osg::Timer_t start = osg::Timer::instance()->tick();
+         for (unsigned i = 0; i < ITERATIONS; ++i)
+         {
+            SoftwareSkinning::SkinVerticesScalar(mesh, &palette[0], &scalar[0], &scalar[3], STRIDE);
+         }
+         double scalarMs = osg::Timer::instance()->delta_m(start, osg::Timer::instance()->tick()) / ITERATIONS;
+
+         start = osg::Timer::instance()->tick();
+         for (unsigned i = 0; i < ITERATIONS; ++i)
+         {
+            SoftwareSkinning::SkinVertices(mesh, &palette[0], &simd[0], &simd[3], STRIDE);
+         }
+         double simdMs = osg::Timer::instance()->delta_m(start, osg::Timer::instance()->tick()) / ITERATIONS;
+
+         std::ostringstream ss;
+         ss << "Skinning " << NUM_VERTICES << " vertices: scalar " << scalarMs << " ms, "
+            << (SoftwareSkinning::IsSimdAvailable() ? "SIMD " : "SIMD (not available) ") << simdMs << " ms.";
+         LOG_ALWAYS(ss.str());
+      }
+
+      //////////////////////////////////////////////////////////////////////////
+      void TestRootTransform()
+      {
+         SoftwareSkinning::SkinnedMesh mesh;
+         SoftwareSkinning::BonePalette palette;
+         MakeRandomMesh(mesh, palette);
+
+         osg::Matrix root = osg::Matrix::rotate(osg::Quat(0.7, osg::Vec3(0.0f, 0.0f, 1.0f)))
+            * osg::Matrix::translate(10.0f, -20.0f, 3.0f);
+
+         SoftwareSkinning::BonePalette rootPalette(palette.size());
+         SoftwareSkinning::ApplyRootTransform(root, &palette[0], &rootPalette[0], unsigned(palette.size()));
+
+         std::vector<float> local(NUM_VERTICES * 3), localNormals(NUM_VERTICES * 3);
+         std::vector<float> world(NUM_VERTICES * 3), worldNormals(NUM_VERTICES * 3);
+         SoftwareSkinning::SkinVertices(mesh, &palette[0], &local[0], &localNormals[0]);
+         SoftwareSkinning::SkinVertices(mesh, &rootPalette[0], &world[0], &worldNormals[0]);
+
+         for (unsigned v = 0; v < NUM_VERTICES; ++v)
+         {
+            osg::Vec3 expected = osg::Vec3(local[v * 3], local[v * 3 + 1], local[v * 3 + 2]) * root;
+            osg::Vec3 expectedNormal = osg::Matrix::transform3x3(
+               osg::Vec3(localNormals[v * 3], localNormals[v * 3 + 1], localNormals[v * 3 + 2]), root);
+            for (unsigned i = 0; i < 3; ++i)
+            {
+               CPPUNIT_ASSERT_DOUBLES_EQUAL(expected[i], world[v * 3 + i], 1e-3f);
+               CPPUNIT_ASSERT_DOUBLES_EQUAL(expectedNormal[i], worldNormals[v * 3 + i], 1e-4f);
+            }
+         }
+      }
+
+      //////////////////////////////////////////////////////////////////////////
+      void TestMatchesCal3D()
+      {
+         dtCore::RefPtr<AnimationHelper> helper = LoadMarine();
+         helper->PlayAnimation("Run");
+         helper->Update(0.3f);
+
+         Cal3DModelWrapper* wrapper = dynamic_cast<Cal3DModelWrapper*>(helper->GetModelWrapper());
+         CPPUNIT_ASSERT(wrapper != NULL);
+         wrapper->SetLODLevel(1.0f);
+
+         SoftwareSkinning::BonePalette palette;
+         SoftwareSkinning::BuildPalette(*wrapper->GetCalModel()->getSkeleton(), palette);
+
+         std::vector<CalMesh*>& meshes = wrapper->GetCalModel()->getVectorMesh();
+         unsigned numCompared = 0;
+         for (unsigned m = 0; m < meshes.size(); ++m)
+         {
+            std::vector<CalSubmesh*>& submeshes = meshes[m]->getVectorSubmesh();
+            for (unsigned s = 0; s < submeshes.size(); ++s)
+            {
+               CalCoreSubmesh* coreSubmesh = submeshes[s]->getCoreSubmesh();
+               // Cal3D moves these itself, so there is nothing to compare against.
+               if (coreSubmesh->getSpringCount() > 0 || coreSubmesh->getCoreSubMorphTargetCount() > 0)
+               {
+                  continue;
+               }
+
+               SoftwareSkinning::SkinnedMesh mesh;
+               SoftwareSkinning::ExtractSubmesh(*coreSubmesh, mesh);
+               const unsigned numVertices = mesh.GetVertexCount();
+
+               std::vector<float> expected(numVertices * 3), expectedNormals(numVertices * 3);
+               CPPUNIT_ASSERT(wrapper->BeginRenderingQuery());
+               CPPUNIT_ASSERT(wrapper->SelectMeshSubmesh(m, s));
+               dtCore::RefPtr<Cal3dSubmesh> calSubmesh = wrapper->GetSelectedSubmesh();
+               CPPUNIT_ASSERT_EQUAL(int(numVertices), calSubmesh->GetVertices(&expected[0]));
+               calSubmesh->GetNormals(&expectedNormals[0]);
+
+               // The path the drawables use.
+               std::vector<float> submeshPositions(numVertices * 3), submeshNormals(numVertices * 3);
+               CPPUNIT_ASSERT_EQUAL(int(numVertices), calSubmesh->GetVerticesAndNormals(&submeshPositions[0], &submeshNormals[0]));
+               wrapper->EndRenderingQuery();
+
+               std::vector<float> positions(numVertices * 3), normals(numVertices * 3);
+               SoftwareSkinning::SkinVertices(mesh, &palette[0], &positions[0], &normals[0]);
+
+               for (unsigned i = 0; i < numVertices * 3; ++i)
+               {
+                  CPPUNIT_ASSERT_DOUBLES_EQUAL(expected[i], positions[i], 1e-3f + 1e-4f * std::abs(expected[i]));
+                  CPPUNIT_ASSERT_DOUBLES_EQUAL(expectedNormals[i], normals[i], 1e-3f);
+                  CPPUNIT_ASSERT_DOUBLES_EQUAL(positions[i], submeshPositions[i], 1e-5f);
+                  CPPUNIT_ASSERT_DOUBLES_EQUAL(normals[i], submeshNormals[i], 1e-5f);
+               }
+               ++numCompared;
+            }
+         }
+         CPPUNIT_ASSERT(numCompared > 0);
+      }
+
+      //////////////////////////////////////////////////////////////////////////
+      void TestSubmeshLevelOfDetail()
+      {
+         dtCore::RefPtr<AnimationHelper> helper = LoadMarine();
+         helper->PlayAnimation("Run");
+         helper->Update(0.3f);
+
+         Cal3DModelWrapper* wrapper = dynamic_cast<Cal3DModelWrapper*>(helper->GetModelWrapper());
+         CPPUNIT_ASSERT(wrapper != NULL);
+         wrapper->SetLODLevel(0.5f);
+
+         // Interleaved like the drawable's vertex buffer.
+         const unsigned STRIDE = 10;
+         std::vector<CalMesh*>& meshes = wrapper->GetCalModel()->getVectorMesh();
+         unsigned numCompared = 0;
+         for (unsigned m = 0; m < meshes.size(); ++m)
+         {
+            std::vector<CalSubmesh*>& submeshes = meshes[m]->getVectorSubmesh();
+            for (unsigned s = 0; s < submeshes.size(); ++s)
+            {
+               const unsigned numVertices = unsigned(submeshes[s]->getCoreSubmesh()->getVertexCount());
+               std::vector<float> expected(numVertices * STRIDE, 0.0f), actual(numVertices * STRIDE, 0.0f);
+
+               CPPUNIT_ASSERT(wrapper->BeginRenderingQuery());
+               CPPUNIT_ASSERT(wrapper->SelectMeshSubmesh(m, s));
+               dtCore::RefPtr<Cal3dSubmesh> calSubmesh = wrapper->GetSelectedSubmesh();
+               int vertexCount = calSubmesh->GetVertices(&expected[0], STRIDE * sizeof(float));
+               calSubmesh->GetNormals(&expected[3], STRIDE * sizeof(float));
+               CPPUNIT_ASSERT_EQUAL(vertexCount,
+                  calSubmesh->GetVerticesAndNormals(&actual[0], &actual[3], STRIDE * sizeof(float)));
+               wrapper->EndRenderingQuery();
+
+               for (unsigned i = 0; i < unsigned(vertexCount) * STRIDE; ++i)
+               {
+                  CPPUNIT_ASSERT_DOUBLES_EQUAL(expected[i], actual[i], 1e-3f + 1e-4f * std::abs(expected[i]));
+               }
+               // Nothing is written past the vertices the level of detail uses.
+               for (unsigned i = unsigned(vertexCount) * STRIDE; i < numVertices * STRIDE; ++i)
+               {
+                  CPPUNIT_ASSERT_EQUAL(0.0f, actual[i]);
+               }
+               ++numCompared;
+            }
+         }
+         CPPUNIT_ASSERT(numCompared > 0);
+      }
+
+      //////////////////////////////////////////////////////////////////////////
+      void TestPoseSharing()
+      {
+         dtCore::RefPtr<AnimationHelper> leader = LoadMarine();
+         dtCore::RefPtr<AnimationHelper> follower = LoadMarine();
+         Cal3DModelWrapper* leaderWrapper = dynamic_cast<Cal3DModelWrapper*>(leader->GetModelWrapper());
+         Cal3DModelWrapper* followerWrapper = dynamic_cast<Cal3DModelWrapper*>(follower->GetModelWrapper());
+         CPPUNIT_ASSERT(leaderWrapper != NULL && followerWrapper != NULL);
+         CPPUNIT_ASSERT(leaderWrapper->GetCalModelData() == followerWrapper->GetCalModelData());
+
+         dtCore::RefPtr<PoseCache> cache = new PoseCache;
+         leaderWrapper->GetCalAnimator()->SetPoseCache(cache.get());
+         followerWrapper->GetCalAnimator()->SetPoseCache(cache.get());
+
+         leader->PlayAnimation("Run");
+         follower->PlayAnimation("Run");
+
+         for (unsigned frame = 0; frame < 5; ++frame)
+         {
+            cache->AdvanceFrame();
+
+            leader->Update(0.1f);
+            unsigned missesAfterLeader = cache->GetNumMisses();
+            unsigned hitsBeforeFollower = cache->GetNumHits();
+
+            follower->Update(0.1f);
+            CPPUNIT_ASSERT_EQUAL_MESSAGE("The follower is in step, so it should not evaluate its own pose.",
+               missesAfterLeader, cache->GetNumMisses());
+            CPPUNIT_ASSERT(cache->GetNumHits() > hitsBeforeFollower);
+
+            // In the same pose, they skin from the same palette, built once.
+            const PoseCache::Pose* pose = leaderWrapper->GetCalAnimator()->GetCurrentPose();
+            CPPUNIT_ASSERT(pose != NULL);
+            CPPUNIT_ASSERT(pose == followerWrapper->GetCalAnimator()->GetCurrentPose());
+            CPPUNIT_ASSERT(&leaderWrapper->GetSkinningPalette() == &followerWrapper->GetSkinningPalette());
+
+            BoneArray leaderBones, followerBones;
+            leaderWrapper->GetBones(leaderBones);
+            followerWrapper->GetBones(followerBones);
+            CPPUNIT_ASSERT_EQUAL(leaderBones.size(), followerBones.size());
+            for (unsigned b = 0; b < leaderBones.size(); ++b)
+            {
+               CPPUNIT_ASSERT((leaderBones[b]->GetAbsoluteTranslation() - followerBones[b]->GetAbsoluteTranslation()).length() < 1e-4f);
+            }
+         }
+
+         // Poses nobody asks for go away.
+         CPPUNIT_ASSERT(cache->GetNumPoses() > 0U);
+         for (unsigned i = 0; i <= cache->GetMaxAgeFrames(); ++i)
+         {
+            cache->AdvanceFrame();
+         }
+         CPPUNIT_ASSERT_EQUAL(0U, cache->GetNumPoses());
+
+         // Out of step, the follower evaluates its own pose.
+         follower->Update(0.37f);
+         leader->Update(0.1f);
+         unsigned misses = cache->GetNumMisses();
+         follower->Update(0.1f);
+         CPPUNIT_ASSERT(cache->GetNumMisses() > misses);
+
+         leaderWrapper->GetCalAnimator()->SetPoseCache(NULL);
+         followerWrapper->GetCalAnimator()->SetPoseCache(NULL);
+      }
+
+   private:
+      //////////////////////////////////////////////////////////////////////////
+      dtCore::RefPtr<AnimationHelper> LoadMarine()
+      {
+         dtCore::RefPtr<AnimationHelper> helper = new AnimationHelper;
+         Connect(helper.get());
+         LoadModel(helper.get(), dtCore::ResourceDescriptor("SkeletalMeshes/Marine/marine_test.xml"));
+         return helper;
+      }
+
+      //////////////////////////////////////////////////////////////////////////
+      void MakeRandomMesh(SoftwareSkinning::SkinnedMesh& mesh, SoftwareSkinning::BonePalette& palette)
+      {
+         palette.resize(NUM_BONES);
+         for (unsigned b = 0; b < NUM_BONES; ++b)
+         {
+            osg::Vec3 axis(dtUtil::RandFloat(-1.0f, 1.0f), dtUtil::RandFloat(-1.0f, 1.0f), 1.0f);
+            axis.normalize();
+            osg::Quat rotation(dtUtil::RandFloat(-3.0f, 3.0f), axis);
+            for (unsigned c = 0; c < 3; ++c)
+            {
+               osg::Vec3 unit;
+               unit[c] = 1.0f;
+               osg::Vec3 column = rotation * unit;
+               palette[b].mColumns[c][0] = column.x();
+               palette[b].mColumns[c][1] = column.y();
+               palette[b].mColumns[c][2] = column.z();
+               palette[b].mColumns[c][3] = 0.0f;
+            }
+            palette[b].mColumns[3][0] = dtUtil::RandFloat(-2.0f, 2.0f);
+            palette[b].mColumns[3][1] = dtUtil::RandFloat(-2.0f, 2.0f);
+            palette[b].mColumns[3][2] = dtUtil::RandFloat(-2.0f, 2.0f);
+            palette[b].mColumns[3][3] = 1.0f;
+         }
+
+         mesh.mPositions.resize(NUM_VERTICES * 3);
+         mesh.mNormals.resize(NUM_VERTICES * 3);
+         mesh.mBoneIndices.assign(NUM_VERTICES * SoftwareSkinning::MAX_INFLUENCES, 0);
+         mesh.mBoneWeights.assign(NUM_VERTICES * SoftwareSkinning::MAX_INFLUENCES, 0.0f);
+         for (unsigned v = 0; v < NUM_VERTICES; ++v)
+         {
+            osg::Vec3 normal(dtUtil::RandFloat(-1.0f, 1.0f), dtUtil::RandFloat(-1.0f, 1.0f), 0.5f);
+            normal.normalize();
+            for (unsigned i = 0; i < 3; ++i)
+            {
+               mesh.mPositions[v * 3 + i] = dtUtil::RandFloat(-1.0f, 1.0f);
+               mesh.mNormals[v * 3 + i] = normal[i];
+            }
+
+            // Every tenth vertex has no bones, the rest one to four, heaviest first.
+            unsigned numInfluences = v % 10 == 0 ? 0 : 1 + v % SoftwareSkinning::MAX_INFLUENCES;
+            float remaining = 1.0f;
+            for (unsigned i = 0; i < numInfluences; ++i)
+            {
+               float weight = i + 1 == numInfluences ? remaining : remaining * 0.6f;
+               remaining -= weight;
+               mesh.mBoneIndices[v * SoftwareSkinning::MAX_INFLUENCES + i] = static_cast<unsigned short>(dtUtil::RandRange(0U, NUM_BONES - 1));
+               mesh.mBoneWeights[v * SoftwareSkinning::MAX_INFLUENCES + i] = weight;
+            }
+         }
+      }
+   };
+
+   CPPUNIT_TEST_SUITE_REGISTRATION(SoftwareSkinningTests);
+}
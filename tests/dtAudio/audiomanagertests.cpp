@@ -30,8 +30,16 @@
 #include <cppunit/extensions/HelperMacros.h>
 
 #include <dtAudio/audiomanager.h>
+#include <dtAudio/soundstream.h>
+#include <dtCore/system.h>
+#include <dtCore/timer.h>
+#include <dtCore/transform.h>
+#include <dtCore/transformable.h>
 #include <dtUtil/datapathutils.h>
 #include <dtUtil/exception.h>
+#include <dtUtil/threadpool.h>
+
+#include <osg/io_utils>
 
 class AudioManagerTests : public CPPUNIT_NS::TestFixture
 {
@@ -40,6 +48,10 @@ class AudioManagerTests : public CPPUNIT_NS::TestFixture
       CPPUNIT_TEST(TestInitializeCustomContext);
       CPPUNIT_TEST(TestInitializeCustomContextNoShutdown);
       CPPUNIT_TEST(TestPausing);
+      CPPUNIT_TEST(TestVoiceVirtualization);
+      CPPUNIT_TEST(TestPlayUsesCurrentTransform);
+      CPPUNIT_TEST(TestBufferCache);
+      CPPUNIT_TEST(TestStreamStopWhileReading);
    CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -50,6 +62,10 @@ public:
    void TestInitializeCustomContext();
    void TestInitializeCustomContextNoShutdown();
    void TestPausing();
+   void TestVoiceVirtualization();
+   void TestPlayUsesCurrentTransform();
+   void TestBufferCache();
+   void TestStreamStopWhileReading();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(AudioManagerTests);
@@ -218,3 +234,218 @@ void AudioManagerTests::TestPausing()
       CPPUNIT_FAIL(e.ToString());
    }
 }
+
+void AudioManagerTests::TestVoiceVirtualization()
+{
+   try
+   {
+      using namespace dtAudio;
+
+      ALCdevice* device = NULL;
+      ALCcontext* context = NULL;
+      CreateDeviceAndContext(device, context);
+      AudioManager::Instantiate("joe", device, context, true);
+      AudioManager& am = AudioManager::GetInstance();
+
+      const std::string testSoundFile = dtUtil::GetDeltaRootPath() + "/tests/data/Sounds/silence.wav";
+
+      Sound* nearSound = am.NewSound();
+      Sound* farSound = am.NewSound();
+      nearSound->LoadFile(testSoundFile.c_str());
+      farSound->LoadFile(testSoundFile.c_str());
+      nearSound->SetLooping(true);
+      farSound->SetLooping(true);
+      // The transform rather than SetPosition, which the next frame replaces with the transform.
+      nearSound->SetTransform(dtCore::Transform(1.0f, 0.0f, 0.0f));
+      farSound->SetTransform(dtCore::Transform(100.0f, 0.0f, 0.0f));
+
+      const osg::Vec3 origin;
+      CPPUNIT_ASSERT(am.EstimateAudibility(*nearSound, origin) > am.EstimateAudibility(*farSound, origin));
+
+      am.SetMaxRealVoices(1);
+      CPPUNIT_ASSERT_EQUAL(1U, am.GetMaxRealVoices());
+
+      nearSound->Play();
+      farSound->Play();
+      am.OnSystem(dtCore::System::MESSAGE_PRE_FRAME, 0.25, 0.25);
+
+      CPPUNIT_ASSERT(!nearSound->IsVirtual());
+      CPPUNIT_ASSERT(farSound->IsVirtual());
+      CPPUNIT_ASSERT(farSound->IsPlaying());
+      CPPUNIT_ASSERT_EQUAL(ALuint(AL_NONE), farSound->GetSource());
+      CPPUNIT_ASSERT_EQUAL(1U, am.GetNumVirtualVoices());
+
+      // Priority outweighs distance.
+      farSound->SetPriority(1000.0f);
+      am.OnSystem(dtCore::System::MESSAGE_PRE_FRAME, 0.25, 0.25);
+
+      CPPUNIT_ASSERT(nearSound->IsVirtual());
+      CPPUNIT_ASSERT(nearSound->IsPlaying());
+      CPPUNIT_ASSERT(!farSound->IsVirtual());
+      CPPUNIT_ASSERT(farSound->GetSource() != AL_NONE);
+
+      am.SetMaxRealVoices(0);
+      am.OnSystem(dtCore::System::MESSAGE_PRE_FRAME, 0.25, 0.25);
+
+      CPPUNIT_ASSERT(!nearSound->IsVirtual());
+      CPPUNIT_ASSERT(!farSound->IsVirtual());
+      CPPUNIT_ASSERT_EQUAL(0U, am.GetNumVirtualVoices());
+
+      am.FreeSound(nearSound);
+      am.FreeSound(farSound);
+   }
+   catch (const dtUtil::Exception& e)
+   {
+      CPPUNIT_FAIL(e.ToString());
+   }
+}
+
+void AudioManagerTests::TestPlayUsesCurrentTransform()
+{
+   try
+   {
+      using namespace dtAudio;
+
+      ALCdevice* device = NULL;
+      ALCcontext* context = NULL;
+      CreateDeviceAndContext(device, context);
+      AudioManager::Instantiate("joe", device, context, true);
+      AudioManager& am = AudioManager::GetInstance();
+
+      Sound* sound = am.NewSound();
+      sound->LoadFile((dtUtil::GetDeltaRootPath() + "/tests/data/Sounds/silence.wav").c_str());
+
+      dtCore::RefPtr<dtCore::Transformable> parent = new dtCore::Transformable("SoundParent");
+      parent->AddChild(sound);
+      am.OnSystem(dtCore::System::MESSAGE_PRE_FRAME, 0.25, 0.25);
+
+      // Moved while stopped, then played and stopped again before the next frame.
+      parent->SetTransform(dtCore::Transform(5.0f, 0.0f, 0.0f));
+      sound->Play();
+      sound->Stop();
+      CPPUNIT_ASSERT(sound->IsStopped());
+      CPPUNIT_ASSERT(sound->IsPlayPending());
+
+      am.OnSystem(dtCore::System::MESSAGE_PRE_FRAME, 0.25, 0.25);
+      CPPUNIT_ASSERT(!sound->IsPlayPending());
+
+      osg::Vec3 position;
+      sound->GetPosition(position);
+      CPPUNIT_ASSERT_EQUAL(osg::Vec3(5.0f, 0.0f, 0.0f), position);
+
+      parent->RemoveChild(sound);
+      am.FreeSound(sound);
+   }
+   catch (const dtUtil::Exception& e)
+   {
+      CPPUNIT_FAIL(e.ToString());
+   }
+}
+
+void AudioManagerTests::TestBufferCache()
+{
+   try
+   {
+      using namespace dtAudio;
+
+      ALCdevice* device = NULL;
+      ALCcontext* context = NULL;
+      CreateDeviceAndContext(device, context);
+      AudioManager::Instantiate("joe", device, context, true);
+      AudioManager& am = AudioManager::GetInstance();
+
+      const std::string testSoundFile = dtUtil::GetDeltaRootPath() + "/tests/data/Sounds/silence.wav";
+
+      am.SetBufferCacheLimit(1 << 20);
+
+      Sound* sound = am.NewSound();
+      sound->LoadFile(testSoundFile.c_str());
+      AudioManager::BufferCacheStats stats = am.GetBufferCacheStats();
+      CPPUNIT_ASSERT_EQUAL(1U, stats.mNumBuffers);
+      CPPUNIT_ASSERT_EQUAL(0U, stats.mNumUnusedBuffers);
+      CPPUNIT_ASSERT_EQUAL(1U, stats.mMisses);
+      CPPUNIT_ASSERT(stats.mBytes > 0);
+
+      // The buffer outlives the sound while it fits in the cache.
+      am.FreeSound(sound);
+      stats = am.GetBufferCacheStats();
+      CPPUNIT_ASSERT_EQUAL(1U, stats.mNumBuffers);
+      CPPUNIT_ASSERT_EQUAL(1U, stats.mNumUnusedBuffers);
+      CPPUNIT_ASSERT_EQUAL(stats.mBytes, stats.mUnusedBytes);
+
+      sound = am.NewSound();
+      sound->LoadFile(testSoundFile.c_str());
+      stats = am.GetBufferCacheStats();
+      CPPUNIT_ASSERT_EQUAL(1U, stats.mHits);
+      CPPUNIT_ASSERT_EQUAL(0U, stats.mNumUnusedBuffers);
+      am.FreeSound(sound);
+
+      am.SetBufferCacheLimit(1);
+      stats = am.GetBufferCacheStats();
+      CPPUNIT_ASSERT_EQUAL(0U, stats.mNumBuffers);
+      CPPUNIT_ASSERT_EQUAL(1U, stats.mEvictions);
+
+      // Going back to no cache drops what the cache was holding.
+      am.SetBufferCacheLimit(1 << 20);
+      sound = am.NewSound();
+      sound->LoadFile(testSoundFile.c_str());
+      am.FreeSound(sound);
+      CPPUNIT_ASSERT_EQUAL(1U, am.GetBufferCacheStats().mNumUnusedBuffers);
+      am.SetBufferCacheLimit(0);
+      stats = am.GetBufferCacheStats();
+      CPPUNIT_ASSERT_EQUAL(0U, stats.mNumBuffers);
+      CPPUNIT_ASSERT_EQUAL(2U, stats.mEvictions);
+
+      // Streams hold a ring of chunks instead of a shared buffer.
+      sound = am.NewSound();
+      sound->SetStreaming(true);
+      sound->LoadFile(testSoundFile.c_str());
+      CPPUNIT_ASSERT(sound->GetStream() != NULL);
+      CPPUNIT_ASSERT(sound->GetStream()->IsValid());
+      CPPUNIT_ASSERT(sound->GetDurationOfPlay() > 0.0f);
+      stats = am.GetBufferCacheStats();
+      CPPUNIT_ASSERT_EQUAL(0U, stats.mNumBuffers);
+      CPPUNIT_ASSERT_EQUAL(1U, stats.mNumStreams);
+      am.FreeSound(sound);
+   }
+   catch (const dtUtil::Exception& e)
+   {
+      CPPUNIT_FAIL(e.ToString());
+   }
+}
+
+void AudioManagerTests::TestStreamStopWhileReading()
+{
+   bool startedThreadPool = !dtUtil::ThreadPool::IsInitialized();
+   if (startedThreadPool)
+   {
+      dtUtil::ThreadPool::Init();
+   }
+
+   const std::string testSoundFile = dtUtil::GetDeltaRootPath() + "/tests/data/Sounds/silence.wav";
+   dtCore::RefPtr<dtAudio::SoundStream> stream = new dtAudio::SoundStream(testSoundFile);
+
+   // Each stop waits for the read it interrupts and starts another, so the reads
+   // run back to back on the IO thread.
+   for (int i = 0; i < 50; ++i)
+   {
+      stream->Stop(AL_NONE);
+   }
+
+   for (int i = 0; i < 500 && stream->GetMemoryUsage() == 0; ++i)
+   {
+      dtCore::AppSleep(10);
+   }
+   CPPUNIT_ASSERT(stream->IsValid());
+   CPPUNIT_ASSERT(stream->GetMemoryUsage() > 0);
+   CPPUNIT_ASSERT(stream->GetDuration() > 0.0f);
+
+   // Deleting waits for the read that Stop started.
+   stream->Stop(AL_NONE);
+   stream = NULL;
+
+   if (startedThreadPool)
+   {
+      dtUtil::ThreadPool::Shutdown();
+   }
+}
@@ -30,17 +30,50 @@
 #include <dtCore/system.h>
 #include <dtCore/actortype.h>
 #include <dtUtil/exception.h>
+#include <dtUtil/stringutils.h>
+#include <vector>
  
 class ActorTypeTests : public CPPUNIT_NS::TestFixture 
 {
    CPPUNIT_TEST_SUITE(ActorTypeTests);   
       CPPUNIT_TEST(TestActorType);
+      CPPUNIT_TEST(TestTypeIds);
+      CPPUNIT_TEST(TestLateRegistrationAndRenaming);
    CPPUNIT_TEST_SUITE_END();
    
    public:
       void setUp();
       void tearDown();      
       void TestActorType();
+      void TestTypeIds();
+      void TestLateRegistrationAndRenaming();
+
+   private:
+      /// InstanceOf as it was done with strings, to compare against.
+      static bool StringInstanceOf(const dtCore::ObjectType& type, const dtCore::ObjectType& rhs)
+      {
+         for (const dtCore::ObjectType* t = &type; t != NULL; t = t->GetParentType())
+         {
+            if (t->GetUniqueId() == rhs.GetUniqueId())
+            {
+               return true;
+            }
+         }
+         return false;
+      }
+
+      void CheckAllPairs(const std::vector<dtCore::RefPtr<dtCore::ActorType> >& types)
+      {
+         for (size_t i = 0; i < types.size(); ++i)
+         {
+            for (size_t j = 0; j < types.size(); ++j)
+            {
+               CPPUNIT_ASSERT_EQUAL_MESSAGE(types[i]->GetFullName() + " vs " + types[j]->GetFullName(),
+                  StringInstanceOf(*types[i], *types[j]), types[i]->InstanceOf(*types[j]));
+               CPPUNIT_ASSERT_EQUAL(types[i]->GetUniqueId() == types[j]->GetUniqueId(), *types[i] == *types[j]);
+            }
+         }
+      }
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(ActorTypeTests);
@@ -132,3 +165,69 @@ void ActorTypeTests::TestActorType()
       CPPUNIT_FAIL((std::string("Error: ") + e.what()).c_str());
    }
 }
+
+//////////////////////////////////////////////////////////////////////////
+void ActorTypeTests::TestTypeIds()
+{
+   dtCore::RefPtr<dtCore::ActorType> typeA = new dtCore::ActorType("IdType","Tests.Ids");
+   dtCore::RefPtr<dtCore::ActorType> sameAsA = new dtCore::ActorType("IdType","Tests.Ids","A separate object with the same name.");
+   dtCore::RefPtr<dtCore::ActorType> typeB = new dtCore::ActorType("OtherIdType","Tests.Ids");
+
+   CPPUNIT_ASSERT_EQUAL(typeA->GetTypeId(), sameAsA->GetTypeId());
+   CPPUNIT_ASSERT(typeA->GetTypeId() != typeB->GetTypeId());
+   CPPUNIT_ASSERT(typeA->GetTypeId() < dtCore::ObjectType::GetNumTypeIds());
+   CPPUNIT_ASSERT(typeB->GetTypeId() < dtCore::ObjectType::GetNumTypeIds());
+
+   // The name and category are simply joined, so these two have the same unique id.
+   dtCore::RefPtr<dtCore::ActorType> joinedOne = new dtCore::ActorType("ab","c");
+   dtCore::RefPtr<dtCore::ActorType> joinedTwo = new dtCore::ActorType("a","bc");
+   CPPUNIT_ASSERT_EQUAL(joinedOne->GetUniqueId(), joinedTwo->GetUniqueId());
+   CPPUNIT_ASSERT(*joinedOne == *joinedTwo);
+
+   // Asking by strings that no type has must not fail or make a new id.
+   unsigned numIds = dtCore::ObjectType::GetNumTypeIds();
+   CPPUNIT_ASSERT(!typeA->InstanceOf("Tests.Ids","NeverRegistered"));
+   CPPUNIT_ASSERT_EQUAL(numIds, dtCore::ObjectType::GetNumTypeIds());
+   CPPUNIT_ASSERT(typeA->InstanceOf("Tests.Ids","IdType"));
+}
+
+//////////////////////////////////////////////////////////////////////////
+void ActorTypeTests::TestLateRegistrationAndRenaming()
+{
+   std::vector<dtCore::RefPtr<dtCore::ActorType> > types;
+   dtCore::RefPtr<dtCore::ActorType> root = new dtCore::ActorType("Root","Tests.Late");
+   types.push_back(root);
+   types.push_back(new dtCore::ActorType("Middle","Tests.Late","",root.get()));
+
+   // Types from a library loaded later get ids well past their parents', past the first word of bits.
+   for (unsigned i = 0; i < 100; ++i)
+   {
+      types.push_back(new dtCore::ActorType("Filler" + dtUtil::ToString(i),"Tests.Late.Plugin","",
+         i % 2 == 0 ? root.get() : types[1].get()));
+   }
+
+   dtCore::RefPtr<dtCore::ActorType> lateChild = new dtCore::ActorType("LateChild","Tests.Late.Plugin","",types.back().get());
+   types.push_back(lateChild);
+   // A type equal to one of the old ones, made by the late library.
+   types.push_back(new dtCore::ActorType("Middle","Tests.Late","",NULL));
+
+   CPPUNIT_ASSERT(lateChild->InstanceOf(*root));
+   CPPUNIT_ASSERT(lateChild->InstanceOf(*types[1]));
+   CPPUNIT_ASSERT(!root->InstanceOf(*lateChild));
+   CheckAllPairs(types);
+
+   // Renaming changes the ids, and the types made from the renamed one must follow.
+   types[1]->SetName("Renamed");
+   CPPUNIT_ASSERT(!lateChild->InstanceOf(*types.back()));
+   CheckAllPairs(types);
+
+   types[1]->SetName("Middle");
+   CPPUNIT_ASSERT(lateChild->InstanceOf(*types.back()));
+   CheckAllPairs(types);
+
+   // Types made after the rename use the bits again.
+   dtCore::RefPtr<dtCore::ActorType> afterRename = new dtCore::ActorType("AfterRename","Tests.Late","",lateChild.get());
+   types.push_back(afterRename);
+   CPPUNIT_ASSERT(afterRename->InstanceOf(*root));
+   CheckAllPairs(types);
+}
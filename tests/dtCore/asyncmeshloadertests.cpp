@@ -0,0 +1,151 @@
+/* -*-c++-*-
+ * allTests - This source file (.h & .cpp) - Using 'The MIT License'
+ * Copyright (C) 2014, Caper Holdings, LLC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <prefix/unittestprefix.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <dtCore/asyncmeshloader.h>
+#include <dtCore/object.h>
+#include <dtCore/refptr.h>
+#include <dtCore/timer.h>
+#include <dtUtil/datapathutils.h>
+#include <dtUtil/threadpool.h>
+
+#include <osg/MatrixTransform>
+
+/**
+ * @class AsyncMeshLoaderTests
+ * @brief Tests loading Object meshes on the thread pool.
+ */
+class AsyncMeshLoaderTests : public CPPUNIT_NS::TestFixture
+{
+   CPPUNIT_TEST_SUITE(AsyncMeshLoaderTests);
+      CPPUNIT_TEST(TestSharedCachedLoad);
+      CPPUNIT_TEST(TestTangentsOnCopy);
+      CPPUNIT_TEST(TestDestroyAfterThreadPoolShutdown);
+   CPPUNIT_TEST_SUITE_END();
+
+public:
+   void setUp()
+   {
+      mStartedThreadPool = !dtUtil::ThreadPool::IsInitialized();
+      if (mStartedThreadPool)
+      {
+         dtUtil::ThreadPool::Init();
+      }
+
+      mFile = dtUtil::GetDeltaRootPath() + "/examples/data/StaticMeshes/physics_crate.ive";
+      dtCore::AsyncMeshLoader::GetInstance().ClearModelCache();
+   }
+
+   void tearDown()
+   {
+      dtCore::AsyncMeshLoader::Destroy();
+      if (mStartedThreadPool)
+      {
+         dtUtil::ThreadPool::Shutdown();
+      }
+   }
+
+   void TestSharedCachedLoad()
+   {
+      dtCore::RefPtr<dtCore::Object> first = CreateObject(false);
+      dtCore::RefPtr<dtCore::Object> second = CreateObject(false);
+
+      dtCore::AsyncMeshLoader& loader = dtCore::AsyncMeshLoader::GetInstance();
+      CPPUNIT_ASSERT(loader.RequestLoad(*first, mFile, true));
+      CPPUNIT_ASSERT(loader.RequestLoad(*second, mFile, true));
+      CPPUNIT_ASSERT_EQUAL(1U, loader.GetNumPendingLoads());
+      CPPUNIT_ASSERT(FinishLoads());
+
+      dtCore::RefPtr<osg::Node> cached = loader.FindCachedModel(mFile);
+      CPPUNIT_ASSERT(cached.valid());
+      CPPUNIT_ASSERT(GetMesh(*first) == cached.get());
+      CPPUNIT_ASSERT(GetMesh(*second) == cached.get());
+      CPPUNIT_ASSERT(!loader.IsLoading(*first));
+   }
+
+   void TestTangentsOnCopy()
+   {
+      dtCore::RefPtr<dtCore::Object> plain = CreateObject(false);
+      dtCore::RefPtr<dtCore::Object> withTangents = CreateObject(true);
+
+      dtCore::AsyncMeshLoader& loader = dtCore::AsyncMeshLoader::GetInstance();
+      CPPUNIT_ASSERT(loader.RequestLoad(*plain, mFile, true));
+      CPPUNIT_ASSERT(loader.RequestLoad(*withTangents, mFile, true));
+      CPPUNIT_ASSERT(FinishLoads());
+
+      // Generating tangents must not touch the geometry in the cache.
+      dtCore::RefPtr<osg::Node> cached = loader.FindCachedModel(mFile);
+      CPPUNIT_ASSERT(cached.valid());
+      CPPUNIT_ASSERT(GetMesh(*plain) == cached.get());
+      CPPUNIT_ASSERT(GetMesh(*withTangents) != NULL);
+      CPPUNIT_ASSERT(GetMesh(*withTangents) != cached.get());
+   }
+
+   void TestDestroyAfterThreadPoolShutdown()
+   {
+      dtCore::RefPtr<dtCore::Object> object = CreateObject(false);
+      CPPUNIT_ASSERT(dtCore::AsyncMeshLoader::GetInstance().RequestLoad(*object, mFile, false));
+
+      // Must return without waiting on a task the pool will never run.
+      dtUtil::ThreadPool::Shutdown();
+      dtCore::AsyncMeshLoader::Destroy();
+      CPPUNIT_ASSERT(!dtUtil::ThreadPool::IsInitialized());
+
+      dtUtil::ThreadPool::Init();
+   }
+
+private:
+   dtCore::RefPtr<dtCore::Object> CreateObject(bool generateTangents)
+   {
+      dtCore::RefPtr<dtCore::Object> object = new dtCore::Object;
+      object->SetUseCache(true);
+      object->SetGenerateTangents(generateTangents);
+      return object;
+   }
+
+   bool FinishLoads()
+   {
+      dtCore::AsyncMeshLoader& loader = dtCore::AsyncMeshLoader::GetInstance();
+      for (int i = 0; i < 500 && loader.GetNumPendingLoads() > 0; ++i)
+      {
+         loader.ProcessCompletedLoads(1000.0);
+         if (loader.GetNumPendingLoads() > 0)
+         {
+            dtCore::AppSleep(10);
+         }
+      }
+      return loader.GetNumPendingLoads() == 0;
+   }
+
+   osg::Node* GetMesh(dtCore::Object& object)
+   {
+      osg::MatrixTransform& transform = object.GetMatrixTransform();
+      return transform.getNumChildren() > 0 ? transform.getChild(0) : NULL;
+   }
+
+   std::string mFile;
+   bool mStartedThreadPool;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(AsyncMeshLoaderTests);
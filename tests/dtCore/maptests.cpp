@@ -55,6 +55,7 @@
 #include <dtCore/intactorproperty.h>
 #include <dtCore/actorfactory.h>
 #include <dtCore/map.h>
+#include <dtCore/mapbinary.h>
 #include <dtCore/mapxml.h>
 #include <dtCore/namedactorparameter.h>
 #include <dtCore/namedbooleanparameter.h>
@@ -95,6 +96,7 @@
 
 #include <cstdio>
 #include <ctime>
+#include <fstream>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -118,6 +120,8 @@ class MapTests : public CPPUNIT_NS::TestFixture
    CPPUNIT_TEST(TestMapSaveAndLoadPropertyContainerProperty);
    CPPUNIT_TEST(TestMapSaveAndLoadNestedPropertyContainerArray);
    CPPUNIT_TEST(TestMapSaveAndLoadActorGroups);
+   CPPUNIT_TEST(TestMapBinarySaveAndLoad);
+   CPPUNIT_TEST(TestMapBinaryUpToDate);
    CPPUNIT_TEST(TestMapAddLibrariesOnSave);
    CPPUNIT_TEST(TestMapCorrectLibraryListSetsModified);
    CPPUNIT_TEST(TestPrefabLoadHeader);
@@ -149,6 +153,8 @@ public:
    void TestMapSaveAndLoadPropertyContainerProperty();
    void TestMapSaveAndLoadNestedPropertyContainerArray();
    void TestMapSaveAndLoadActorGroups();
+   void TestMapBinarySaveAndLoad();
+   void TestMapBinaryUpToDate();
    void TestMapAddLibrariesOnSave();
    void TestMapCorrectLibraryListSetsModified();
    void TestPrefabLoadHeader();
@@ -486,6 +492,156 @@ void MapTests::TestMapAddRemoveProxies()
    }
 }
 
+///////////////////////////////////////////////////////////////////////////////////////
+void MapTests::TestMapBinarySaveAndLoad()
+{
+   try
+   {
+      dtCore::Project& project = dtCore::Project::GetInstance();
+
+      dtCore::Map& map = project.CreateMap(std::string("Neato Map"), std::string("neatomap"));
+      map.SetDescription("Binary map description.");
+      map.SetIconFile("neatomap_icon.png");
+      map.AddLibrary(mExampleLibraryName, "1.0");
+      dtCore::ActorFactory::GetInstance().LoadActorRegistry(mExampleLibraryName);
+
+      dtCore::RefPtr<const dtCore::ActorType> exampleType = dtCore::ActorFactory::GetInstance().FindActorType("dtcore.examples", "Test All Properties");
+      CPPUNIT_ASSERT_MESSAGE("The example type is NULL", exampleType.valid());
+
+      dtCore::RefPtr<dtCore::BaseActorObject> actor1 = dtCore::ActorFactory::GetInstance().CreateActor(*exampleType);
+      dtCore::RefPtr<dtCore::BaseActorObject> actor2 = dtCore::ActorFactory::GetInstance().CreateActor(*exampleType);
+      actor1->SetName("First");
+      actor2->SetName("Second");
+      map.AddProxy(*actor1);
+      map.AddProxy(*actor2);
+
+      const float testFloat(37.36f);
+      const int testInt(-347);
+      dtCore::FloatActorProperty* fap = NULL;
+      actor1->GetProperty("Test_Float", fap);
+      CPPUNIT_ASSERT(fap != NULL);
+      fap->SetValue(testFloat);
+
+      dtCore::IntActorProperty* iap = NULL;
+      actor1->GetProperty("Test_Int", iap);
+      CPPUNIT_ASSERT(iap != NULL);
+      iap->SetValue(testInt);
+
+      dynamic_cast<dtCore::ActorIDActorProperty*>(actor1->GetProperty("Test_Actor"))->SetValue(actor2->GetId());
+
+      std::stringstream stream;
+      dtCore::RefPtr<dtCore::MapBinaryWriter> writer = new dtCore::MapBinaryWriter();
+      writer->Save(map, stream);
+
+      dtCore::RefPtr<dtCore::MapBinaryReader> reader = new dtCore::MapBinaryReader();
+      dtCore::MapPtr loaded = reader->Load(stream);
+      CPPUNIT_ASSERT(loaded.valid());
+      CPPUNIT_ASSERT(reader->GetMissingActorTypes().empty());
+
+      CPPUNIT_ASSERT_EQUAL(map.GetName(), loaded->GetName());
+      CPPUNIT_ASSERT_EQUAL(map.GetDescription(), loaded->GetDescription());
+      CPPUNIT_ASSERT_EQUAL(map.GetIconFile(), loaded->GetIconFile());
+      CPPUNIT_ASSERT(loaded->HasLibrary(mExampleLibraryName));
+      CPPUNIT_ASSERT_EQUAL(map.GetAllProxies().size(), loaded->GetAllProxies().size());
+
+      dtCore::BaseActorObject* loaded1 = loaded->GetProxyById(actor1->GetId());
+      CPPUNIT_ASSERT(loaded1 != NULL);
+      CPPUNIT_ASSERT_EQUAL(std::string("First"), loaded1->GetName());
+
+      loaded1->GetProperty("Test_Float", fap);
+      CPPUNIT_ASSERT_EQUAL(testFloat, fap->GetValue());
+      loaded1->GetProperty("Test_Int", iap);
+      CPPUNIT_ASSERT_EQUAL(testInt, iap->GetValue());
+      CPPUNIT_ASSERT(dynamic_cast<dtCore::ActorIDActorProperty*>(loaded1->GetProperty("Test_Actor"))->GetValue() == actor2->GetId());
+
+      // The same map a step at a time, like a map change loading in the background.
+      stream.clear();
+      stream.seekg(0);
+      reader->Decode(stream, false);
+      CPPUNIT_ASSERT(reader->IsDecoded());
+      CPPUNIT_ASSERT(!reader->IsBuilding());
+
+      reader->BeginBuild();
+      CPPUNIT_ASSERT(reader->IsBuilding());
+      CPPUNIT_ASSERT_EQUAL(map.GetAllProxies().size(), reader->GetNumActors());
+      CPPUNIT_ASSERT_EQUAL(size_t(0), reader->GetNumActorsBuilt());
+
+      // Any positive budget still creates at least one actor per call.
+      unsigned calls = 1;
+      while (!reader->BuildActors(1e-6))
+      {
+         ++calls;
+      }
+      CPPUNIT_ASSERT_EQUAL(map.GetAllProxies().size(), size_t(calls));
+      CPPUNIT_ASSERT_EQUAL(reader->GetNumActors(), reader->GetNumActorsBuilt());
+
+      loaded = reader->FinishBuild();
+      CPPUNIT_ASSERT(!reader->IsDecoded());
+      CPPUNIT_ASSERT_EQUAL(map.GetAllProxies().size(), loaded->GetAllProxies().size());
+      loaded1 = loaded->GetProxyById(actor1->GetId());
+      CPPUNIT_ASSERT(loaded1 != NULL);
+      loaded1->GetProperty("Test_Int", iap);
+      CPPUNIT_ASSERT_EQUAL(testInt, iap->GetValue());
+      CPPUNIT_ASSERT(dynamic_cast<dtCore::ActorIDActorProperty*>(loaded1->GetProperty("Test_Actor"))->GetValue() == actor2->GetId());
+
+      project.DeleteMap(map, true);
+   }
+   catch (const dtUtil::Exception& e)
+   {
+      CPPUNIT_FAIL((std::string("Error: ") + e.What()).c_str());
+   }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+static void WriteTextFile(const std::string& path, const std::string& text)
+{
+   std::ofstream out(path.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+   out << text;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+void MapTests::TestMapBinaryUpToDate()
+{
+   const std::string xmlPath("binaryUpToDateTest.xml");
+   const std::string binaryPath("binaryUpToDateTest." + dtCore::MapBinaryWriter::MAP_FILE_EXTENSION);
+   try
+   {
+      dtCore::Project& project = dtCore::Project::GetInstance();
+      dtCore::Map& map = project.CreateMap(std::string("Up To Date Map"), std::string("uptodatemap"));
+
+      WriteTextFile(xmlPath, "<map>original</map>");
+
+      // Without a source file the binary map is never used in place of the xml.
+      dtCore::RefPtr<dtCore::MapBinaryWriter> writer = new dtCore::MapBinaryWriter();
+      writer->Save(map, binaryPath);
+      CPPUNIT_ASSERT(!dtCore::MapBinaryReader::IsUpToDate(binaryPath, xmlPath));
+
+      CPPUNIT_ASSERT(writer->SetSourceFile(xmlPath));
+      writer->Save(map, binaryPath);
+      CPPUNIT_ASSERT(dtCore::MapBinaryReader::IsUpToDate(binaryPath, xmlPath));
+
+      // The same size and, most likely, the same modification second.
+      WriteTextFile(xmlPath, "<map>changed!</map>");
+      CPPUNIT_ASSERT(!dtCore::MapBinaryReader::IsUpToDate(binaryPath, xmlPath));
+
+      WriteTextFile(xmlPath, "<map>a longer change</map>");
+      CPPUNIT_ASSERT(!dtCore::MapBinaryReader::IsUpToDate(binaryPath, xmlPath));
+
+      WriteTextFile(xmlPath, "<map>original</map>");
+      CPPUNIT_ASSERT(dtCore::MapBinaryReader::IsUpToDate(binaryPath, xmlPath));
+
+      CPPUNIT_ASSERT(!dtCore::MapBinaryReader::IsUpToDate(binaryPath, "binaryUpToDateTestMissing.xml"));
+
+      project.DeleteMap(map, true);
+   }
+   catch (const dtUtil::Exception& e)
+   {
+      CPPUNIT_FAIL((std::string("Error: ") + e.What()).c_str());
+   }
+   std::remove(xmlPath.c_str());
+   std::remove(binaryPath.c_str());
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////
 void MapTests::TestMapAddLibrariesOnSave()
 {
@@ -724,6 +880,24 @@ void MapTests::TestMapProxySearch()
                (*i)->IsInstanceOf("dtCore::Light"));
       }
 
+      // The name index must follow renames.
+      dtCore::BaseActorObject* renamed = map.GetAllProxies().begin()->second.get();
+      const std::string oldName = renamed->GetName();
+      renamed->SetName("Renamed Index Test");
+
+      map.FindProxies(results, "Renamed Index*");
+      CPPUNIT_ASSERT_EQUAL(size_t(1), results.size());
+      CPPUNIT_ASSERT(results.front() == renamed);
+
+      dtCore::ActorPtrVector rawResults;
+      map.FindProxies(rawResults, "*Index T?st");
+      CPPUNIT_ASSERT_EQUAL(size_t(1), rawResults.size());
+      CPPUNIT_ASSERT(rawResults.front() == renamed);
+
+      renamed->SetName(oldName);
+      map.FindProxies(results, "Renamed Index*");
+      CPPUNIT_ASSERT(results.empty());
+
       dtCore::ActorRefPtrVector proxies;
 
       map.GetAllProxies(proxies);
@@ -41,6 +41,9 @@
 #include <dtCore/camera.h>
 #include <dtUtil/bits.h>
 #include <dtUtil/mathdefines.h>
+#include <algorithm>
+#include <string>
+#include <vector>
 
 extern dtABC::Application& GetGlobalApplication();
 
@@ -211,6 +214,66 @@ public:
 };
 
 
+/// Logs the stage subscribers and TickSignal in the order they are called.
+class StageLogger: public dtCore::Base
+{
+public:
+   StageLogger()
+      : mSubscribeDuringPreFrame(false)
+      , mIdToUnsubscribe(0U)
+   {
+      dtCore::System::GetInstance().TickSignal.connect_slot(this, &StageLogger::OnSystem);
+   }
+
+   void OnSystem(const dtUtil::RefString& str, double, double)
+   {
+      if (str == dtCore::System::MESSAGE_PRE_FRAME)
+      {
+         mLog.push_back("signal");
+      }
+   }
+
+   void OnLow(double, double) { mLog.push_back("low"); }
+
+   void OnHighFirst(double, double)
+   {
+      mLog.push_back("highFirst");
+      if (mSubscribeDuringPreFrame)
+      {
+         mSubscribeDuringPreFrame = false;
+         mLateIds.push_back(dtCore::System::GetInstance().SubscribeToStage(dtCore::System::TICK_PRE_FRAME,
+            dtCore::System::TickFunctor(this, &StageLogger::OnLate), -100));
+      }
+      if (mIdToUnsubscribe != 0U)
+      {
+         CPPUNIT_ASSERT(dtCore::System::GetInstance().UnsubscribeFromStage(mIdToUnsubscribe));
+         mIdToUnsubscribe = 0U;
+      }
+   }
+
+   void OnHighSecond(double, double) { mLog.push_back("highSecond"); }
+
+   void OnLate(double, double) { mLog.push_back("late"); }
+
+   void OnPostFrame(double, double) { mLog.push_back("postframe"); }
+
+   void OnStageTime(dtCore::System::TickStage stage, double ms)
+   {
+      mTimedStages.push_back(stage);
+      CPPUNIT_ASSERT(ms >= 0.0);
+   }
+
+   std::vector<std::string> mLog;
+   std::vector<dtCore::System::TickStage> mTimedStages;
+   std::vector<unsigned> mLateIds;
+   bool mSubscribeDuringPreFrame;
+   unsigned mIdToUnsubscribe;
+
+protected:
+   ~StageLogger() {}
+};
+
+
 class DummyNode: public osg::ShapeDrawable
 {
 public:
@@ -270,6 +333,7 @@ class SystemTests : public CPPUNIT_NS::TestFixture
    CPPUNIT_TEST(TestProperties);
    CPPUNIT_TEST(TestStepping);
    CPPUNIT_TEST(TestSystemStages);
+   CPPUNIT_TEST(TestStageSubscriptions);
 
    CPPUNIT_TEST_SUITE_END();
 
@@ -280,6 +344,7 @@ public:
    void TestProperties();
    void TestStepping();
    void TestSystemStages();
+   void TestStageSubscriptions();
    void AssertStages(int stageMask);
    void TestStage(int stageMask);
 
@@ -589,3 +654,78 @@ void SystemTests::AssertStages( int stageMask )
 
    (stageMask & System::STAGE_POSTFRAME) ? CPPUNIT_ASSERT(mDummyDrawable->mPostFrameCalled) : CPPUNIT_ASSERT(!mDummyDrawable->mPostFrameCalled);
 }
+
+//////////////////////////////////////////////////////////////////////////
+void SystemTests::TestStageSubscriptions()
+{
+   dtCore::System& ourSystem = dtCore::System::GetInstance();
+   ourSystem.SetShutdownOnWindowClose(false);
+   ourSystem.SetUseFixedTimeStep(false);
+   ourSystem.Start();
+
+   dtCore::RefPtr<StageLogger> logger = new StageLogger();
+   typedef dtCore::System::TickFunctor TickFunctor;
+
+   const unsigned numPreFrame = ourSystem.GetNumStageSubscribers(System::TICK_PRE_FRAME);
+   unsigned highFirst = ourSystem.SubscribeToStage(System::TICK_PRE_FRAME, TickFunctor(logger.get(), &StageLogger::OnHighFirst), 10);
+   unsigned highSecond = ourSystem.SubscribeToStage(System::TICK_PRE_FRAME, TickFunctor(logger.get(), &StageLogger::OnHighSecond), 10);
+   unsigned low = ourSystem.SubscribeToStage(System::TICK_PRE_FRAME, TickFunctor(logger.get(), &StageLogger::OnLow), -5);
+   unsigned postFrame = ourSystem.SubscribeToStage(System::TICK_POST_FRAME, TickFunctor(logger.get(), &StageLogger::OnPostFrame));
+   CPPUNIT_ASSERT(highFirst != 0U && highSecond != 0U && low != 0U && postFrame != 0U);
+   CPPUNIT_ASSERT_EQUAL(numPreFrame + 3U, ourSystem.GetNumStageSubscribers(System::TICK_PRE_FRAME));
+
+   ourSystem.SetStageTimingHook(dtCore::System::StageTimingFunctor(logger.get(), &StageLogger::OnStageTime));
+
+   ourSystem.Step(0.016f);
+
+   // Each subscriber is only called for its own stage, in order of priority, with TickSignal at 0.
+   std::vector<std::string> expected;
+   expected.push_back("low");
+   expected.push_back("signal");
+   expected.push_back("highFirst");
+   expected.push_back("highSecond");
+   expected.push_back("postframe");
+   CPPUNIT_ASSERT(expected == logger->mLog);
+
+   CPPUNIT_ASSERT(std::find(logger->mTimedStages.begin(), logger->mTimedStages.end(), System::TICK_PRE_FRAME) != logger->mTimedStages.end());
+   CPPUNIT_ASSERT(std::find(logger->mTimedStages.begin(), logger->mTimedStages.end(), System::TICK_PAUSE) == logger->mTimedStages.end());
+   ourSystem.SetStageTimingHook(dtCore::System::StageTimingFunctor());
+
+   // A subscriber added during the stage waits until the next time the stage runs,
+   // and one removed during the stage is not called again.
+   logger->mLog.clear();
+   logger->mSubscribeDuringPreFrame = true;
+   logger->mIdToUnsubscribe = highSecond;
+   ourSystem.Step(0.016f);
+
+   expected.clear();
+   expected.push_back("low");
+   expected.push_back("signal");
+   expected.push_back("highFirst");
+   expected.push_back("postframe");
+   CPPUNIT_ASSERT(expected == logger->mLog);
+   CPPUNIT_ASSERT_EQUAL(size_t(1), logger->mLateIds.size());
+   CPPUNIT_ASSERT(!ourSystem.UnsubscribeFromStage(highSecond));
+
+   logger->mLog.clear();
+   ourSystem.Step(0.016f);
+
+   expected.clear();
+   expected.push_back("late");
+   expected.push_back("low");
+   expected.push_back("signal");
+   expected.push_back("highFirst");
+   expected.push_back("postframe");
+   CPPUNIT_ASSERT(expected == logger->mLog);
+
+   CPPUNIT_ASSERT(ourSystem.UnsubscribeFromStage(highFirst));
+   CPPUNIT_ASSERT(ourSystem.UnsubscribeFromStage(low));
+   CPPUNIT_ASSERT(ourSystem.UnsubscribeFromStage(postFrame));
+   CPPUNIT_ASSERT(ourSystem.UnsubscribeFromStage(logger->mLateIds[0]));
+   CPPUNIT_ASSERT_EQUAL(numPreFrame, ourSystem.GetNumStageSubscribers(System::TICK_PRE_FRAME));
+
+   logger->mLog.clear();
+   ourSystem.Step(0.016f);
+   CPPUNIT_ASSERT_EQUAL(size_t(1), logger->mLog.size());
+   CPPUNIT_ASSERT_EQUAL(std::string("signal"), logger->mLog[0]);
+}
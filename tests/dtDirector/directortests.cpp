@@ -28,11 +28,13 @@
 #include <prefix/unittestprefix.h>
 #include <dtUtil/log.h>
 #include <dtUtil/exception.h>
+#include <dtUtil/stringutils.h>
 #include <dtUtil/datapathutils.h>
 #include <cppunit/extensions/HelperMacros.h>
 
 #include <dtDirector/director.h>
 #include <dtDirector/valuenode.h>
+#include <dtDirector/nodemanager.h>
 #include <dtCore/project.h>
 
 /**
@@ -42,6 +44,7 @@
 class DirectorTests : public CPPUNIT_NS::TestFixture {
    CPPUNIT_TEST_SUITE( DirectorTests );
    CPPUNIT_TEST( TestRunScript );
+   CPPUNIT_TEST( TestTypedValueAccess );
    CPPUNIT_TEST_SUITE_END();
 
    public:
@@ -53,6 +56,11 @@ class DirectorTests : public CPPUNIT_NS::TestFixture {
        */
       void TestRunScript();
 
+      /**
+       * Tests reading and writing linked values through the typed accessors.
+       */
+      void TestTypedValueAccess();
+
    private:
       dtUtil::Log* mLogger;
 
@@ -204,3 +212,63 @@ void DirectorTests::TestRunScript()
 }
 
 //////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////
+void DirectorTests::TestTypedValueAccess()
+{
+   dtDirector::NodeManager& nodeManager = dtDirector::NodeManager::GetInstance();
+
+   dtCore::RefPtr<dtDirector::Node> delay = nodeManager.CreateNode("Delay", "General", mDirector->GetGraphRoot());
+   dtCore::RefPtr<dtDirector::Node> floatValue = nodeManager.CreateNode("Float", "General", mDirector->GetGraphRoot());
+   dtCore::RefPtr<dtDirector::Node> stringValue = nodeManager.CreateNode("String", "General", mDirector->GetGraphRoot());
+   CPPUNIT_ASSERT(delay.valid() && floatValue.valid() && stringValue.valid());
+
+   // Without a link, the node's own property is used.
+   delay->SetFloat(1.5f, "Delay");
+   CPPUNIT_ASSERT_DOUBLES_EQUAL(1.5f, delay->GetFloat("Delay"), 0.0001f);
+
+   dtDirector::ValueLink* link = delay->GetValueLink("Delay");
+   CPPUNIT_ASSERT(link != NULL);
+   CPPUNIT_ASSERT(link->Connect(floatValue->AsValueNode()));
+
+   floatValue->SetFloat(2.25f);
+   CPPUNIT_ASSERT_DOUBLES_EQUAL(2.25f, delay->GetFloat("Delay"), 0.0001f);
+
+   delay->SetFloat(4.0f, "Delay");
+   CPPUNIT_ASSERT_DOUBLES_EQUAL(4.0f, floatValue->GetFloat(), 0.0001f);
+
+   // Setting the same value doesn't notify, and a new value notifies once.
+   unsigned int changeCount = floatValue->AsValueNode()->GetValueChangeCount();
+   delay->SetFloat(4.0f, "Delay");
+   CPPUNIT_ASSERT_EQUAL(changeCount, floatValue->AsValueNode()->GetValueChangeCount());
+   delay->SetFloat(5.0f, "Delay");
+   CPPUNIT_ASSERT_EQUAL(changeCount + 1, floatValue->AsValueNode()->GetValueChangeCount());
+
+   // A mismatched type falls back on string conversion.
+   stringValue->SetString("3.5");
+   CPPUNIT_ASSERT_DOUBLES_EQUAL(3.5f, stringValue->GetFloat(), 0.0001f);
+   stringValue->SetFloat(7.0f);
+   CPPUNIT_ASSERT_DOUBLES_EQUAL(7.0f, dtUtil::ToType<float>(stringValue->GetString()), 0.0001f);
+
+   // Links changed after the first lookup must still be found.
+   CPPUNIT_ASSERT(link->Disconnect());
+   CPPUNIT_ASSERT_EQUAL(0, delay->GetValueNodeCount("Delay"));
+   CPPUNIT_ASSERT(link->Connect(floatValue->AsValueNode()));
+   CPPUNIT_ASSERT_EQUAL(1, delay->GetValueNodeCount("Delay"));
+   CPPUNIT_ASSERT(delay->GetValueNode("Delay") == floatValue->AsValueNode());
+
+   // Changing a link's default property moves it to a new generation, and lookups follow it.
+   unsigned int generation = dtDirector::ValueLink::GetLinkGeneration();
+   dtCore::RefPtr<dtCore::ActorProperty> defaultProp = link->GetDefaultProperty();
+   link->SetDefaultProperty(NULL);
+   CPPUNIT_ASSERT(dtDirector::ValueLink::GetLinkGeneration() != generation);
+   CPPUNIT_ASSERT_EQUAL(0, delay->GetValueNodeCount("Delay"));
+   link->SetDefaultProperty(defaultProp.get());
+   CPPUNIT_ASSERT(delay->GetValueNode("Delay") == floatValue->AsValueNode());
+
+   // The same property read through another type still converts.
+   floatValue->SetFloat(6.0f);
+   CPPUNIT_ASSERT_DOUBLES_EQUAL(6.0f, delay->GetFloat("Delay"), 0.0001f);
+   CPPUNIT_ASSERT_DOUBLES_EQUAL(6.0f, dtUtil::ToType<float>(delay->GetString("Delay")), 0.0001f);
+   CPPUNIT_ASSERT_DOUBLES_EQUAL(6.0f, delay->GetFloat("Delay"), 0.0001f);
+}
@@ -0,0 +1,312 @@
+/* -*-c++-*-
+* allTests - This source file (.h & .cpp) - Using 'The MIT License'
+* Copyright (C) 2014, Caper Holdings, LLC
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+* THE SOFTWARE.
+*/
+#include <prefix/unittestprefix.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <dtDirector/director.h>
+#include <dtDirector/messagegmcomponent.h>
+#include <dtDirector/nodemanager.h>
+#include <dtCore/project.h>
+#include <dtGame/machineinfo.h>
+#include <dtGame/message.h>
+#include <dtGame/messagefactory.h>
+#include <dtGame/messagetype.h>
+#include <dtUtil/datapathutils.h>
+
+/// A user type that has the same name as one of the engine's types.
+DT_DECLARE_MESSAGE_TYPE_CLASS_BEGIN(DirectorTestMessageType, )
+   static const DirectorTestMessageType TIMER_ELAPSED;
+DT_DECLARE_MESSAGE_TYPE_CLASS_END()
+
+DT_IMPLEMENT_MESSAGE_TYPE_CLASS(DirectorTestMessageType);
+const DirectorTestMessageType DirectorTestMessageType::TIMER_ELAPSED("Timer Elapsed", "Info",
+   "Has the same name as dtGame::MessageType::INFO_TIMER_ELAPSED.", dtGame::MessageType::USER_DEFINED_MESSAGE_TYPE + 2811,
+   DT_MSG_CLASS(dtGame::Message));
+
+/**
+ * @class MessageGMComponentTests
+ * @brief Unit tests for routing messages to Director nodes.
+ */
+class MessageGMComponentTests : public CPPUNIT_NS::TestFixture
+{
+   CPPUNIT_TEST_SUITE(MessageGMComponentTests);
+   CPPUNIT_TEST(TestNameMatchesEveryType);
+   CPPUNIT_TEST(TestAllMessages);
+   CPPUNIT_TEST(TestUnRegister);
+   CPPUNIT_TEST(TestUnRegisterWhileProcessing);
+   CPPUNIT_TEST(TestInactiveDirector);
+   CPPUNIT_TEST(TestAboutActor);
+   CPPUNIT_TEST(TestCalledOncePerMessage);
+   CPPUNIT_TEST_SUITE_END();
+
+public:
+   void setUp();
+   void tearDown();
+
+   /// A name registration gets every type with the name, a type registration only its type.
+   void TestNameMatchesEveryType();
+   void TestAllMessages();
+   void TestUnRegister();
+   void TestUnRegisterWhileProcessing();
+   void TestInactiveDirector();
+   void TestAboutActor();
+   void TestCalledOncePerMessage();
+
+private:
+   void OnMessageA(const dtGame::Message& message);
+   void OnMessageB(const dtGame::Message& message);
+   void Process(const dtGame::MessageType& type, const dtCore::UniqueId& aboutActorId = dtCore::UniqueId(""));
+
+   dtCore::RefPtr<dtDirector::Director> mDirector;
+   dtCore::RefPtr<dtDirector::MessageGMComponent> mComponent;
+   dtCore::RefPtr<dtDirector::Node> mNodeA;
+   dtCore::RefPtr<dtDirector::Node> mNodeB;
+   dtGame::MessageFactory* mFactory;
+   unsigned mCountA;
+   unsigned mCountB;
+   bool mUnRegisterBInA;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(MessageGMComponentTests);
+
+///////////////////////////////////////////////////////////////////////////////
+void MessageGMComponentTests::setUp()
+{
+   dtCore::Project::GetInstance().SetContext(dtUtil::GetDeltaRootPath() + "/tests/data/ProjectContext");
+
+   mDirector = new dtDirector::Director();
+   mDirector->Init();
+
+   dtDirector::NodeManager& nodeManager = dtDirector::NodeManager::GetInstance();
+   mNodeA = nodeManager.CreateNode("Delay", "General", mDirector->GetGraphRoot());
+   mNodeB = nodeManager.CreateNode("Delay", "General", mDirector->GetGraphRoot());
+   CPPUNIT_ASSERT(mNodeA.valid() && mNodeB.valid());
+
+   mComponent = new dtDirector::MessageGMComponent();
+   mFactory = new dtGame::MessageFactory("MessageGMComponentTests", dtGame::MachineInfo());
+   mCountA = 0;
+   mCountB = 0;
+   mUnRegisterBInA = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void MessageGMComponentTests::tearDown()
+{
+   delete mFactory;
+   mFactory = NULL;
+   mComponent = NULL;
+   mNodeA = NULL;
+   mNodeB = NULL;
+   mDirector = NULL;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void MessageGMComponentTests::OnMessageA(const dtGame::Message&)
+{
+   ++mCountA;
+   if (mUnRegisterBInA)
+   {
+      mComponent->UnRegisterMessages(mNodeB.get());
+   }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void MessageGMComponentTests::OnMessageB(const dtGame::Message&)
+{
+   ++mCountB;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void MessageGMComponentTests::Process(const dtGame::MessageType& type, const dtCore::UniqueId& aboutActorId)
+{
+   dtCore::RefPtr<dtGame::Message> message = mFactory->CreateMessage(type);
+   message->SetAboutActorId(aboutActorId);
+   mComponent->ProcessMessage(*message);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void MessageGMComponentTests::TestNameMatchesEveryType()
+{
+   mComponent->RegisterMessage("Timer Elapsed", mNodeA.get(),
+      dtDirector::MessageGMComponent::MsgFunc(this, &MessageGMComponentTests::OnMessageA));
+   mComponent->RegisterMessage(dtGame::MessageType::INFO_TIMER_ELAPSED, mNodeB.get(),
+      dtDirector::MessageGMComponent::MsgFunc(this, &MessageGMComponentTests::OnMessageB));
+
+   Process(dtGame::MessageType::INFO_TIMER_ELAPSED);
+   CPPUNIT_ASSERT_EQUAL(1U, mCountA);
+   CPPUNIT_ASSERT_EQUAL(1U, mCountB);
+
+   Process(DirectorTestMessageType::TIMER_ELAPSED);
+   CPPUNIT_ASSERT_EQUAL(2U, mCountA);
+   CPPUNIT_ASSERT_EQUAL(1U, mCountB);
+
+   // Processed twice, so the cached name lookup is used as well.
+   Process(DirectorTestMessageType::TIMER_ELAPSED);
+   CPPUNIT_ASSERT_EQUAL(3U, mCountA);
+
+   Process(dtGame::MessageType::TICK_LOCAL);
+   CPPUNIT_ASSERT_EQUAL(3U, mCountA);
+   CPPUNIT_ASSERT_EQUAL(1U, mCountB);
+
+   CPPUNIT_ASSERT_EQUAL(2U, mComponent->GetCallbackCount(dtGame::MessageType::INFO_TIMER_ELAPSED));
+   CPPUNIT_ASSERT_EQUAL(2U, mComponent->GetCallbackCount(DirectorTestMessageType::TIMER_ELAPSED));
+   CPPUNIT_ASSERT_EQUAL(0U, mComponent->GetCallbackCount(dtGame::MessageType::TICK_LOCAL));
+   CPPUNIT_ASSERT_EQUAL(4U, mComponent->GetTotalCallbackCount());
+
+   mComponent->ResetCallbackCounts();
+   CPPUNIT_ASSERT_EQUAL(0U, mComponent->GetTotalCallbackCount());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void MessageGMComponentTests::TestAllMessages()
+{
+   mComponent->RegisterMessage("", mNodeA.get(),
+      dtDirector::MessageGMComponent::MsgFunc(this, &MessageGMComponentTests::OnMessageA));
+
+   Process(dtGame::MessageType::TICK_LOCAL);
+   Process(dtGame::MessageType::INFO_TIMER_ELAPSED);
+   Process(DirectorTestMessageType::TIMER_ELAPSED);
+   CPPUNIT_ASSERT_EQUAL(3U, mCountA);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void MessageGMComponentTests::TestUnRegister()
+{
+   mComponent->RegisterMessage("Timer Elapsed", mNodeA.get(),
+      dtDirector::MessageGMComponent::MsgFunc(this, &MessageGMComponentTests::OnMessageA));
+   mComponent->RegisterMessage(dtGame::MessageType::INFO_TIMER_ELAPSED, mNodeB.get(),
+      dtDirector::MessageGMComponent::MsgFunc(this, &MessageGMComponentTests::OnMessageB));
+
+   // Unregistering by name also removes the type registrations with that name.
+   mComponent->UnRegisterMessage("Timer Elapsed", mNodeB.get());
+   Process(dtGame::MessageType::INFO_TIMER_ELAPSED);
+   CPPUNIT_ASSERT_EQUAL(1U, mCountA);
+   CPPUNIT_ASSERT_EQUAL(0U, mCountB);
+
+   mComponent->UnRegisterMessages(mNodeA.get());
+   Process(dtGame::MessageType::INFO_TIMER_ELAPSED);
+   Process(DirectorTestMessageType::TIMER_ELAPSED);
+   CPPUNIT_ASSERT_EQUAL(1U, mCountA);
+
+   // Registering the name again after it was dropped must be found again.
+   mComponent->RegisterMessage("Timer Elapsed", mNodeA.get(),
+      dtDirector::MessageGMComponent::MsgFunc(this, &MessageGMComponentTests::OnMessageA));
+   Process(DirectorTestMessageType::TIMER_ELAPSED);
+   CPPUNIT_ASSERT_EQUAL(2U, mCountA);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void MessageGMComponentTests::TestUnRegisterWhileProcessing()
+{
+   mComponent->RegisterMessage("", mNodeA.get(),
+      dtDirector::MessageGMComponent::MsgFunc(this, &MessageGMComponentTests::OnMessageA));
+   mComponent->RegisterMessage("Tick Local", mNodeB.get(),
+      dtDirector::MessageGMComponent::MsgFunc(this, &MessageGMComponentTests::OnMessageB));
+
+   // The removal is queued until the message is done, then applied.
+   mUnRegisterBInA = true;
+   Process(dtGame::MessageType::TICK_LOCAL);
+   CPPUNIT_ASSERT_EQUAL(1U, mCountA);
+   CPPUNIT_ASSERT_EQUAL(1U, mCountB);
+
+   mUnRegisterBInA = false;
+   Process(dtGame::MessageType::TICK_LOCAL);
+   CPPUNIT_ASSERT_EQUAL(2U, mCountA);
+   CPPUNIT_ASSERT_EQUAL(1U, mCountB);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void MessageGMComponentTests::TestInactiveDirector()
+{
+   mComponent->RegisterMessage(dtGame::MessageType::TICK_LOCAL, mNodeA.get(),
+      dtDirector::MessageGMComponent::MsgFunc(this, &MessageGMComponentTests::OnMessageA));
+
+   mDirector->SetActive(false);
+   Process(dtGame::MessageType::TICK_LOCAL);
+   CPPUNIT_ASSERT_EQUAL(0U, mCountA);
+
+   mDirector->SetActive(true);
+   Process(dtGame::MessageType::TICK_LOCAL);
+   CPPUNIT_ASSERT_EQUAL(1U, mCountA);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void MessageGMComponentTests::TestAboutActor()
+{
+   dtCore::UniqueId actorA;
+   dtCore::UniqueId actorB;
+
+   mComponent->RegisterMessage(dtGame::MessageType::INFO_TIMER_ELAPSED, actorA, mNodeA.get(),
+      dtDirector::MessageGMComponent::MsgFunc(this, &MessageGMComponentTests::OnMessageA));
+   mComponent->RegisterMessage("Timer Elapsed", actorB, mNodeB.get(),
+      dtDirector::MessageGMComponent::MsgFunc(this, &MessageGMComponentTests::OnMessageB));
+
+   Process(dtGame::MessageType::INFO_TIMER_ELAPSED, actorA);
+   CPPUNIT_ASSERT_EQUAL(1U, mCountA);
+   CPPUNIT_ASSERT_EQUAL(0U, mCountB);
+
+   // The name route matches every type with the name, but only about its actor.
+   Process(DirectorTestMessageType::TIMER_ELAPSED, actorB);
+   CPPUNIT_ASSERT_EQUAL(1U, mCountA);
+   CPPUNIT_ASSERT_EQUAL(1U, mCountB);
+
+   Process(dtGame::MessageType::INFO_TIMER_ELAPSED);
+   Process(dtGame::MessageType::TICK_LOCAL, actorA);
+   CPPUNIT_ASSERT_EQUAL(1U, mCountA);
+   CPPUNIT_ASSERT_EQUAL(1U, mCountB);
+
+   mComponent->UnRegisterMessages(mNodeA.get());
+   Process(dtGame::MessageType::INFO_TIMER_ELAPSED, actorA);
+   CPPUNIT_ASSERT_EQUAL(1U, mCountA);
+
+   mComponent->UnRegisterMessage("Timer Elapsed", mNodeB.get());
+   Process(dtGame::MessageType::INFO_TIMER_ELAPSED, actorB);
+   CPPUNIT_ASSERT_EQUAL(1U, mCountB);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void MessageGMComponentTests::TestCalledOncePerMessage()
+{
+   dtCore::UniqueId actor;
+
+   // The same node through the type, the name, an about actor route and every message.
+   mComponent->RegisterMessage(dtGame::MessageType::INFO_TIMER_ELAPSED, mNodeA.get(),
+      dtDirector::MessageGMComponent::MsgFunc(this, &MessageGMComponentTests::OnMessageA));
+   mComponent->RegisterMessage("Timer Elapsed", mNodeA.get(),
+      dtDirector::MessageGMComponent::MsgFunc(this, &MessageGMComponentTests::OnMessageA));
+   mComponent->RegisterMessage("Timer Elapsed", actor, mNodeA.get(),
+      dtDirector::MessageGMComponent::MsgFunc(this, &MessageGMComponentTests::OnMessageA));
+   mComponent->RegisterMessage("", mNodeA.get(),
+      dtDirector::MessageGMComponent::MsgFunc(this, &MessageGMComponentTests::OnMessageA));
+   mComponent->RegisterMessage("", mNodeB.get(),
+      dtDirector::MessageGMComponent::MsgFunc(this, &MessageGMComponentTests::OnMessageB));
+
+   Process(dtGame::MessageType::INFO_TIMER_ELAPSED, actor);
+   CPPUNIT_ASSERT_EQUAL(1U, mCountA);
+   CPPUNIT_ASSERT_EQUAL(1U, mCountB);
+   CPPUNIT_ASSERT_EQUAL(2U, mComponent->GetCallbackCount(dtGame::MessageType::INFO_TIMER_ELAPSED));
+
+   Process(DirectorTestMessageType::TIMER_ELAPSED);
+   CPPUNIT_ASSERT_EQUAL(2U, mCountA);
+   CPPUNIT_ASSERT_EQUAL(2U, mCountB);
+}
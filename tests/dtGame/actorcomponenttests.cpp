@@ -67,6 +67,7 @@
 #include "basegmtests.h"
 
 #include <iostream>
+#include <sstream>
 
 class ActorComponentTests : public dtGame::BaseGMTestFixture
 {
@@ -79,6 +80,8 @@ class ActorComponentTests : public dtGame::BaseGMTestFixture
       CPPUNIT_TEST(TestPropertyRemoving);
       CPPUNIT_TEST(TestCloning);
       CPPUNIT_TEST(TestCopyPropertiesOnComponents);
+      CPPUNIT_TEST(TestComponentLookupByType);
+      CPPUNIT_TEST(TestComponentLookupPerformance);
 
    CPPUNIT_TEST_SUITE_END();
 
@@ -356,6 +359,101 @@ public:
       CPPUNIT_ASSERT_EQUAL(extraComp->GetProperty(propName)->ToString(), extraCompCopyProp->GetProperty(propName)->ToString());
    }
 
+   struct CountComponents
+   {
+      CountComponents(unsigned& count) : mCount(count) {}
+      void operator()(dtGame::ActorComponent&) { ++mCount; }
+      unsigned& mCount;
+   };
+
+   void TestComponentLookupByType()
+   {
+      dtCore::RefPtr<dtGame::GameActorProxy> actor;
+      mGM->CreateActor(*TestGameActorLibrary::TEST1_GAME_ACTOR_TYPE, actor);
+      actor->RemoveAllComponents();
+
+      dtCore::RefPtr<TestActorComponent1> component1 = new TestActorComponent1();
+      dtCore::RefPtr<TestActorComponent2> component2 = new TestActorComponent2();
+      actor->AddComponent(*component1);
+      actor->AddComponent(*component2);
+
+      CPPUNIT_ASSERT(actor->GetComponent<TestActorComponent1>() == component1.get());
+      CPPUNIT_ASSERT(actor->GetComponent<TestActorComponent2>() == component2.get());
+
+      // Both derive from the base type, in the order they were added.
+      CPPUNIT_ASSERT(actor->FindComponent(dtGame::ActorComponent::BaseActorComponentType) == component1.get());
+      std::vector<dtGame::ActorComponent*> components;
+      actor->GetComponents(dtGame::ActorComponent::BaseActorComponentType, components);
+      CPPUNIT_ASSERT_EQUAL(size_t(2), components.size());
+      CPPUNIT_ASSERT(components[0] == component1.get());
+      CPPUNIT_ASSERT(components[1] == component2.get());
+
+      unsigned count = 0;
+      actor->ForEachComponent(dtGame::ActorComponent::BaseActorComponentType, CountComponents(count));
+      CPPUNIT_ASSERT_EQUAL(2U, count);
+
+      // A separate type object that equals the registered one must still find it.
+      dtCore::RefPtr<dtCore::ActorType> sameType = new dtCore::ActorType(TestActorComponent1::TYPE->GetName(),
+               TestActorComponent1::TYPE->GetCategory());
+      CPPUNIT_ASSERT(actor->HasComponent(sameType.get()));
+      CPPUNIT_ASSERT(actor->FindComponent(sameType.get()) == component1.get());
+      count = 0;
+      actor->ForEachComponent(sameType.get(), CountComponents(count));
+      CPPUNIT_ASSERT_EQUAL(1U, count);
+
+      actor->RemoveComponent(*component1);
+      CPPUNIT_ASSERT(!actor->HasComponent(TestActorComponent1::TYPE));
+      CPPUNIT_ASSERT(actor->GetComponent<TestActorComponent1>() == NULL);
+      CPPUNIT_ASSERT(actor->FindComponent(dtGame::ActorComponent::BaseActorComponentType) == component2.get());
+
+      actor->RemoveAllComponents();
+      CPPUNIT_ASSERT(!actor->HasComponent(dtGame::ActorComponent::BaseActorComponentType));
+      CPPUNIT_ASSERT(actor->GetComponents(dtGame::ActorComponent::BaseActorComponentType).empty());
+   }
+
+   void TestComponentLookupPerformance()
+   {
+      const unsigned numActors = 2000;
+      const unsigned numRounds = 50;
+
+      std::vector<dtCore::RefPtr<dtGame::GameActorProxy> > actors;
+      actors.reserve(numActors);
+      for (unsigned i = 0; i < numActors; ++i)
+      {
+         dtCore::RefPtr<dtGame::GameActorProxy> actor;
+         mGM->CreateActor(*TestGameActorLibrary::TEST1_GAME_ACTOR_TYPE, actor);
+         actor->AddComponent(*new TestActorComponent1());
+         actor->AddComponent(*new TestActorComponent2());
+         mGM->AddActor(*actor, false, false);
+         actors.push_back(actor);
+      }
+
+      dtCore::Timer statsTickClock;
+      dtCore::Timer_t startTime = statsTickClock.Tick();
+
+      unsigned found = 0;
+      for (unsigned round = 0; round < numRounds; ++round)
+      {
+         for (unsigned i = 0; i < numActors; ++i)
+         {
+            dtGame::GameActorProxy& actor = *actors[i];
+            found += actor.GetComponent<TestActorComponent1>() != NULL;
+            found += actor.GetComponent<TestActorComponent2>() != NULL;
+            found += actor.HasComponent(dtGame::ActorComponent::BaseActorComponentType);
+         }
+      }
+
+      double timeDelta = statsTickClock.DeltaSec(startTime, statsTickClock.Tick());
+      CPPUNIT_ASSERT_EQUAL(3U * numActors * numRounds, found);
+
+      std::ostringstream ss;
+      ss << "Component lookups for " << numActors << " actors, " << numRounds << " rounds took - ["
+         << timeDelta << "] seconds";
+      LOG_ALWAYS(ss.str());
+
+      mGM->DeleteAllActors(true);
+   }
+
 private:
 };
 
@@ -86,6 +86,7 @@ class GameManagerTests : public dtGame::BaseGMTestFixture
         CPPUNIT_TEST(TestFindActorByType);
         CPPUNIT_TEST(TestFindActorByWrongType);
         CPPUNIT_TEST(TestFindActorByName);
+        CPPUNIT_TEST(TestActorIndex);
 
         CPPUNIT_TEST(TestDataStream);
 
@@ -129,6 +130,7 @@ public:
    void TestFindActorByType();
    void TestFindActorByWrongType();
    void TestFindActorByName();
+   void TestActorIndex();
 
    void TestDataStream();
 
@@ -316,6 +318,75 @@ void GameManagerTests::TestFindActorByName()
    }
 }
 
+/////////////////////////////////////////////////
+static void AssertSortedById(const dtCore::ActorPtrVector& actors)
+{
+   for (size_t i = 1; i < actors.size(); ++i)
+   {
+      CPPUNIT_ASSERT_MESSAGE("Search results should be sorted by id.", actors[i - 1]->GetId() < actors[i]->GetId());
+   }
+}
+
+/////////////////////////////////////////////////
+void GameManagerTests::TestActorIndex()
+{
+   std::vector<dtCore::RefPtr<dtActors::GameMeshActor> > meshes;
+   for (unsigned i = 0; i < 6; ++i)
+   {
+      dtCore::RefPtr<dtActors::GameMeshActor> p;
+      mGM->CreateActor(*dtActors::EngineActorRegistry::GAME_MESH_ACTOR_TYPE, p);
+      CPPUNIT_ASSERT(p != NULL);
+      p->SetName(i % 2 == 0 ? "indexEven" : "indexOdd");
+      mGM->AddActor(*p, false, false);
+      meshes.push_back(p);
+   }
+
+   dtCore::ActorPtrVector found;
+   mGM->FindActorsByName("indexEven", found);
+   CPPUNIT_ASSERT_EQUAL(size_t(3), found.size());
+   AssertSortedById(found);
+
+   mGM->FindActorsByName("index*", found);
+   CPPUNIT_ASSERT_EQUAL(size_t(6), found.size());
+   AssertSortedById(found);
+
+   mGM->FindActorsByType(*dtActors::EngineActorRegistry::GAME_MESH_ACTOR_TYPE, found);
+   CPPUNIT_ASSERT_EQUAL(size_t(6), found.size());
+   AssertSortedById(found);
+
+   // Renames move the actor in the name index.
+   meshes[0]->SetName("indexRenamed");
+   mGM->FindActorsByName("indexEven", found);
+   CPPUNIT_ASSERT_EQUAL(size_t(2), found.size());
+   mGM->FindActorsByName("indexRenamed", found);
+   CPPUNIT_ASSERT_EQUAL(size_t(1), found.size());
+   CPPUNIT_ASSERT(found[0] == meshes[0].get());
+
+   // Actors that aren't game actors are indexed too, and removed right away on delete.
+   dtCore::RefPtr<dtCore::BaseActorObject> light;
+   mGM->CreateActor(*dtActors::EngineActorRegistry::POSITIONAL_LIGHT_ACTOR_TYPE, light);
+   CPPUNIT_ASSERT(light != NULL);
+   light->SetName("indexLight");
+   mGM->AddActor(*light);
+   mGM->FindActorsByName("indexLight", found);
+   CPPUNIT_ASSERT_EQUAL(size_t(1), found.size());
+
+   mGM->DeleteActor(light->GetId());
+   mGM->FindActorsByName("indexLight", found);
+   CPPUNIT_ASSERT(found.empty());
+
+   // Game actors are removed once the delete completes at the end of the tick.
+   mGM->DeleteActor(*meshes[1]);
+   dtCore::System::GetInstance().Step(0.01666f);
+   mGM->FindActorsByName("indexOdd", found);
+   CPPUNIT_ASSERT_EQUAL(size_t(2), found.size());
+
+   // A deleted actor is no longer listened to, so renaming it doesn't put it back.
+   meshes[1]->SetName("indexRenamedAfterDelete");
+   mGM->FindActorsByName("indexRenamedAfterDelete", found);
+   CPPUNIT_ASSERT(found.empty());
+}
+
 /////////////////////////////////////////////////
 void GameManagerTests::TestPrototypeActors()
 {
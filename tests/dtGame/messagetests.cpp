@@ -28,6 +28,7 @@
 
 #include <prefix/unittestprefix.h>
 #include <iostream>
+#include <cstdio>
 #include <osg/Math>
 #include <dtUtil/log.h>
 #include <dtUtil/fileutils.h>
@@ -44,12 +45,14 @@
 #include <dtCore/actortype.h>
 #include <dtCore/project.h>
 #include <dtCore/map.h>
+#include <dtCore/mapbinary.h>
 #include <dtCore/actorproperty.h>
 #include <dtCore/gameeventmanager.h>
 #include <dtCore/gameevent.h>
 
 #include <dtUtil/fileutils.h>
 #include <dtUtil/datastream.h>
+#include <dtUtil/threadpool.h>
 
 #include <dtGame/messageparameter.h>
 #include <dtGame/machineinfo.h>
@@ -90,6 +93,9 @@ class MessageTests : public CPPUNIT_NS::TestFixture
       CPPUNIT_TEST(TestChangeMap);
       CPPUNIT_TEST(TestChangeMapGameEvents);
       CPPUNIT_TEST(TestChangeMapErrorConditions);
+      CPPUNIT_TEST(TestChangeMapIncremental);
+      CPPUNIT_TEST(TestChangeMapCancelWhileOpening);
+      CPPUNIT_TEST(TestChangeMapLargeInBackground);
       CPPUNIT_TEST(TestDefaultMessageProcessorWithPauseResumeRequests);
       CPPUNIT_TEST(TestDefaultMessageProcessorWithMapRequests);
       CPPUNIT_TEST(TestDefaultMessageProcessorWithPauseResumeCommands);
@@ -125,6 +131,9 @@ public:
    void TestChangeMapGameEvents();
    void TestChangeMap();
    void TestChangeMapErrorConditions();
+   void TestChangeMapIncremental();
+   void TestChangeMapCancelWhileOpening();
+   void TestChangeMapLargeInBackground();
    void TestDefaultMessageProcessorWithPauseResumeRequests();
    void TestDefaultMessageProcessorWithMapRequests();
    void TestDefaultMessageProcessorWithPauseResumeCommands();
@@ -1395,6 +1404,282 @@ void MessageTests::TestChangeMap()
 //   }
 }
 
+void MessageTests::TestChangeMapIncremental()
+{
+   try
+   {
+      dtCore::Project& project = dtCore::Project::GetInstance();
+      dtGame::GameManager::NameVector mapNames;
+      mapNames.push_back("Incremental Game Actors");
+
+      dtCore::RefPtr<dtCore::Map> map = &project.CreateMap(mapNames[0], "incga");
+      createActors(*map);
+      map->AddLibrary(mTestGameActorLibrary, "1.0");
+      map->AddLibrary(mTestActorLibrary, "1.0");
+      // The crash actors throw in OnEnteredWorld, so they never make it into the GM.
+      const size_t expectedActors = map->GetAllProxies().size() - 1;
+
+      project.SaveMap(*map);
+      project.CloseMap(*map);
+
+      dtGame::TestComponent& tc = *new dtGame::TestComponent("name");
+      mGameManager->AddComponent(tc, dtGame::GameManager::ComponentPriority::NORMAL);
+
+      mGameManager->SetMapChangeInBackground(true);
+      CPPUNIT_ASSERT(mGameManager->GetMapChangeInBackground());
+      // Small enough that only one actor is added each frame.
+      mGameManager->SetMapChangeActorTimeBudget(0.000001);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(0.000001, mGameManager->GetMapChangeActorTimeBudget(), 1e-9);
+
+      CPPUNIT_ASSERT(!mGameManager->CancelMapChange());
+
+      // First load everything and make sure it gets there over several frames.
+      mGameManager->ChangeMapSet(mapNames, false);
+      CPPUNIT_ASSERT(mGameManager->IsMapChangeInProgress());
+
+      unsigned frames = 0;
+      while (mGameManager->IsMapChangeInProgress() && frames < 1000)
+      {
+         CPPUNIT_ASSERT_MESSAGE("INFO_MAP_LOADED must not be sent until all the actors are in the GM.",
+                  !tc.FindProcessMessageOfType(dtGame::MessageType::INFO_MAP_LOADED).valid());
+         dtCore::System::GetInstance().Step();
+         ++frames;
+      }
+      // One more step to deliver the last messages.
+      dtCore::System::GetInstance().Step();
+
+      CPPUNIT_ASSERT(!mGameManager->IsMapChangeInProgress());
+      CPPUNIT_ASSERT_MESSAGE("The actors should have been added over more than a couple of frames.", frames > 2);
+      CPPUNIT_ASSERT_EQUAL(expectedActors, mGameManager->GetNumAllActors());
+
+      float lastPercent = -1.0f;
+      unsigned numProgress = 0;
+      for (unsigned i = 0; i < tc.GetReceivedProcessMessages().size(); ++i)
+      {
+         const dtGame::Message& msg = *tc.GetReceivedProcessMessages()[i];
+         if (msg.GetMessageType() == dtGame::MessageType::INFO_MAP_CHANGE_PROGRESS)
+         {
+            const dtGame::MapChangeProgressMessage& progressMsg = static_cast<const dtGame::MapChangeProgressMessage&>(msg);
+            CheckMapNames(progressMsg, mapNames);
+            CPPUNIT_ASSERT_MESSAGE("The progress should never go backwards.", progressMsg.GetPercentComplete() >= lastPercent);
+            lastPercent = progressMsg.GetPercentComplete();
+            ++numProgress;
+         }
+      }
+      CPPUNIT_ASSERT(numProgress > 1);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(100.0f, lastPercent, 0.001f);
+
+      dtCore::RefPtr<const dtGame::Message> changedMsg = tc.FindProcessMessageOfType(dtGame::MessageType::INFO_MAP_CHANGED);
+      CPPUNIT_ASSERT(changedMsg.valid());
+      CheckMapNames(static_cast<const dtGame::MapMessage&>(*changedMsg), mapNames);
+
+      // Now reload it and cancel part way through.
+      mGameManager->CloseCurrentMap();
+      dtCore::System::GetInstance().Step();
+      dtCore::System::GetInstance().Step();
+      CPPUNIT_ASSERT_EQUAL(size_t(0), mGameManager->GetNumAllActors());
+      tc.reset();
+
+      mGameManager->ChangeMapSet(mapNames, false);
+      frames = 0;
+      while (mGameManager->GetNumAllActors() < 2 && frames < 1000)
+      {
+         dtCore::System::GetInstance().Step();
+         ++frames;
+      }
+      CPPUNIT_ASSERT(mGameManager->IsMapChangeInProgress());
+      CPPUNIT_ASSERT(mGameManager->CancelMapChange());
+
+      dtCore::System::GetInstance().Step();
+      dtCore::System::GetInstance().Step();
+
+      CPPUNIT_ASSERT(!mGameManager->IsMapChangeInProgress());
+      CPPUNIT_ASSERT_EQUAL_MESSAGE("A cancelled map change should remove the actors it added.",
+               size_t(0), mGameManager->GetNumAllActors());
+      CPPUNIT_ASSERT(mGameManager->GetCurrentMapSet().empty());
+      CPPUNIT_ASSERT(!project.IsMapOpen(mapNames[0]));
+      CPPUNIT_ASSERT_MESSAGE("A cancelled map change must not report the map as loaded.",
+               !tc.FindProcessMessageOfType(dtGame::MessageType::INFO_MAP_LOADED).valid());
+
+      changedMsg = tc.FindProcessMessageOfType(dtGame::MessageType::INFO_MAP_CHANGED);
+      CPPUNIT_ASSERT(changedMsg.valid());
+      dtGame::GameManager::NameVector changedNames;
+      static_cast<const dtGame::MapMessage&>(*changedMsg).GetMapNames(changedNames);
+      CPPUNIT_ASSERT(changedNames.empty());
+
+      project.DeleteMap(mapNames[0]);
+   }
+   catch(const dtUtil::Exception& e)
+   {
+      CPPUNIT_FAIL(e.ToString());
+   }
+}
+
+void MessageTests::TestChangeMapCancelWhileOpening()
+{
+   bool startedThreadPool = !dtUtil::ThreadPool::IsInitialized();
+   if (startedThreadPool)
+   {
+      dtUtil::ThreadPool::Init();
+   }
+
+   try
+   {
+      dtCore::Project& project = dtCore::Project::GetInstance();
+      dtGame::GameManager::NameVector mapNames;
+      mapNames.push_back("Cancel Open A");
+      mapNames.push_back("Cancel Open B");
+
+      for (unsigned i = 0; i < mapNames.size(); ++i)
+      {
+         dtCore::RefPtr<dtCore::Map> map = &project.CreateMap(mapNames[i], "cancelopen" + dtUtil::ToString(i));
+         createActors(*map);
+         map->AddLibrary(mTestGameActorLibrary, "1.0");
+         map->AddLibrary(mTestActorLibrary, "1.0");
+         project.SaveMap(*map);
+         project.CloseMap(*map);
+      }
+
+      dtGame::TestComponent& tc = *new dtGame::TestComponent("name");
+      mGameManager->AddComponent(tc, dtGame::GameManager::ComponentPriority::NORMAL);
+      mGameManager->SetMapChangeInBackground(true);
+
+      // The first step closes the old maps and starts reading the new ones.  None are opened until the next.
+      mGameManager->ChangeMapSet(mapNames, false);
+      dtCore::System::GetInstance().Step();
+      CPPUNIT_ASSERT(mGameManager->IsMapChangeInProgress());
+      CPPUNIT_ASSERT(mGameManager->CancelMapChange());
+
+      dtCore::System::GetInstance().Step();
+      dtCore::System::GetInstance().Step();
+
+      CPPUNIT_ASSERT(!mGameManager->IsMapChangeInProgress());
+      CPPUNIT_ASSERT_EQUAL(size_t(0), mGameManager->GetNumAllActors());
+      CPPUNIT_ASSERT(mGameManager->GetCurrentMapSet().empty());
+      CPPUNIT_ASSERT(!project.IsMapOpen(mapNames[0]));
+      CPPUNIT_ASSERT(!project.IsMapOpen(mapNames[1]));
+      CPPUNIT_ASSERT_MESSAGE("The change was cancelled before the maps were all open.",
+               !tc.FindProcessMessageOfType(dtGame::MessageType::INFO_MAP_LOAD_BEGIN).valid());
+      CPPUNIT_ASSERT(!tc.FindProcessMessageOfType(dtGame::MessageType::INFO_MAP_LOADED).valid());
+
+      dtCore::RefPtr<const dtGame::Message> changedMsg = tc.FindProcessMessageOfType(dtGame::MessageType::INFO_MAP_CHANGED);
+      CPPUNIT_ASSERT(changedMsg.valid());
+      dtGame::GameManager::NameVector changedNames;
+      static_cast<const dtGame::MapMessage&>(*changedMsg).GetMapNames(changedNames);
+      CPPUNIT_ASSERT(changedNames.empty());
+
+      project.DeleteMap(mapNames[0]);
+      project.DeleteMap(mapNames[1]);
+   }
+   catch(const dtUtil::Exception& e)
+   {
+      if (startedThreadPool)
+      {
+         dtUtil::ThreadPool::Shutdown();
+      }
+      CPPUNIT_FAIL(e.ToString());
+   }
+
+   if (startedThreadPool)
+   {
+      dtUtil::ThreadPool::Shutdown();
+   }
+}
+
+void MessageTests::TestChangeMapLargeInBackground()
+{
+   bool startedThreadPool = !dtUtil::ThreadPool::IsInitialized();
+   if (startedThreadPool)
+   {
+      dtUtil::ThreadPool::Init();
+   }
+
+   try
+   {
+      dtCore::Project& project = dtCore::Project::GetInstance();
+      dtGame::GameManager::NameVector mapNames;
+      mapNames.push_back("Large Background Map");
+
+      const unsigned numActors = 2000;
+      dtCore::RefPtr<dtCore::Map> map = &project.CreateMap(mapNames[0], "largebackground");
+      for (unsigned i = 0; i < numActors; ++i)
+      {
+         dtCore::RefPtr<dtCore::BaseActorObject> actor = mGameManager->CreateActor(*dtActors::EngineActorRegistry::TASK_ACTOR_TYPE);
+         actor->SetName("Task " + dtUtil::ToString(i));
+         map->AddProxy(*actor);
+      }
+      project.SaveMap(*map);
+
+      // With an up to date binary copy, the map is decoded with the read and its actors are created a slice at a time.
+      const std::string xmlPath = project.GetContext() + dtUtil::FileUtils::PATH_SEPARATOR + "maps"
+               + dtUtil::FileUtils::PATH_SEPARATOR + map->GetFileName();
+      const std::string binaryPath = xmlPath.substr(0, xmlPath.rfind('.')) + "." + dtCore::MapBinaryWriter::MAP_FILE_EXTENSION;
+      dtCore::RefPtr<dtCore::MapBinaryWriter> writer = new dtCore::MapBinaryWriter();
+      CPPUNIT_ASSERT(writer->SetSourceFile(xmlPath));
+      writer->Save(*map, binaryPath);
+      CPPUNIT_ASSERT(dtCore::MapBinaryReader::IsUpToDate(binaryPath, xmlPath));
+
+      project.CloseMap(*map);
+      map = NULL;
+
+      dtGame::TestComponent& tc = *new dtGame::TestComponent("name");
+      mGameManager->AddComponent(tc, dtGame::GameManager::ComponentPriority::NORMAL);
+      mGameManager->SetMapChangeInBackground(true);
+      mGameManager->SetMapChangeActorTimeBudget(1.0);
+
+      mGameManager->ChangeMapSet(mapNames, false);
+      unsigned frames = 0;
+      while (mGameManager->IsMapChangeInProgress() && frames < 10000)
+      {
+         dtCore::System::GetInstance().Step();
+         ++frames;
+      }
+      dtCore::System::GetInstance().Step();
+
+      CPPUNIT_ASSERT(!mGameManager->IsMapChangeInProgress());
+      CPPUNIT_ASSERT(project.IsMapOpen(mapNames[0]));
+      CPPUNIT_ASSERT_EQUAL(size_t(numActors), mGameManager->GetNumAllActors());
+      CPPUNIT_ASSERT_MESSAGE("Reading, opening and adding should take more than a couple of frames.", frames > 2);
+
+      bool sawPartlyBuilt = false;
+      const std::vector<dtCore::RefPtr<const dtGame::Message> >& received = tc.GetReceivedProcessMessages();
+      for (size_t i = 0; i < received.size(); ++i)
+      {
+         if (received[i]->GetMessageType() == dtGame::MessageType::INFO_MAP_CHANGE_PROGRESS)
+         {
+            float percent = static_cast<const dtGame::MapChangeProgressMessage&>(*received[i]).GetPercentComplete();
+            sawPartlyBuilt = sawPartlyBuilt || (percent > 25.0f && percent < 50.0f);
+         }
+      }
+      CPPUNIT_ASSERT_MESSAGE("Creating the actors of the binary map should be spread over several frames.", sawPartlyBuilt);
+      CPPUNIT_ASSERT(tc.FindProcessMessageOfType(dtGame::MessageType::INFO_MAP_LOAD_BEGIN).valid());
+      CPPUNIT_ASSERT(tc.FindProcessMessageOfType(dtGame::MessageType::INFO_MAP_LOADED).valid());
+
+      dtCore::RefPtr<const dtGame::Message> changedMsg = tc.FindProcessMessageOfType(dtGame::MessageType::INFO_MAP_CHANGED);
+      CPPUNIT_ASSERT(changedMsg.valid());
+      CheckMapNames(static_cast<const dtGame::MapMessage&>(*changedMsg), mapNames);
+
+      mGameManager->CloseCurrentMap();
+      dtCore::System::GetInstance().Step();
+      dtCore::System::GetInstance().Step();
+      project.DeleteMap(mapNames[0]);
+      std::remove(binaryPath.c_str());
+   }
+   catch(const dtUtil::Exception& e)
+   {
+      if (startedThreadPool)
+      {
+         dtUtil::ThreadPool::Shutdown();
+      }
+      CPPUNIT_FAIL(e.ToString());
+   }
+
+   if (startedThreadPool)
+   {
+      dtUtil::ThreadPool::Shutdown();
+   }
+}
+
 void MessageTests::TestGameEventMessage()
 {
    try
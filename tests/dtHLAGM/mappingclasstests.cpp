@@ -52,7 +52,25 @@
 #include <dtHLAGM/hlacomponentconfig.h>
 #include <dtHLAGM/attributetype.h>
 #include <dtHLAGM/rprparametertranslator.h>
+#include <dtHLAGM/attributetranslationplan.h>
 
+namespace
+{
+   /// A handle that compares by value without being the same object, like an uncached RTI handle wrapper.
+   class TestAttributeHandle : public dtHLAGM::RTIHandle
+   {
+   public:
+      TestAttributeHandle(int value): mValue(value) {}
+      virtual bool operator==(dtHLAGM::RTIHandle& h)
+      {
+         TestAttributeHandle* other = dynamic_cast<TestAttributeHandle*>(&h);
+         return other != NULL && other->mValue == mValue;
+      }
+      // Coarse on purpose, so some values collide.
+      virtual size_t GetHash() const { return size_t(mValue % 4); }
+      int mValue;
+   };
+}
 
 
 class MappingClassTests : public CPPUNIT_NS::TestFixture
@@ -63,6 +81,7 @@ class MappingClassTests : public CPPUNIT_NS::TestFixture
       CPPUNIT_TEST(TestParameterToParameterList);
       CPPUNIT_TEST(TestObjectToActor);
       CPPUNIT_TEST(TestInteractionToMessage);
+      CPPUNIT_TEST(TestAttributeTranslationPlan);
 
    CPPUNIT_TEST_SUITE_END();
 
@@ -281,6 +300,85 @@ class MappingClassTests : public CPPUNIT_NS::TestFixture
 
       }
 
+      void TestAttributeTranslationPlan()
+      {
+         dtCore::RefPtr<TestAttributeHandle> handleA = new TestAttributeHandle(1);
+         dtCore::RefPtr<TestAttributeHandle> handleB = new TestAttributeHandle(2);
+         dtCore::RefPtr<TestAttributeHandle> handleACopy = new TestAttributeHandle(1);
+         dtCore::RefPtr<TestAttributeHandle> handleUnused = new TestAttributeHandle(3);
+         dtCore::RefPtr<TestAttributeHandle> handleColliding = new TestAttributeHandle(5);
+
+         dtHLAGM::AttributeTranslationPlan plan;
+         CPPUNIT_ASSERT(!plan.IsCompiled());
+
+         plan.AddMapping(dtHLAGM::AttributeTranslationPlan::MAPPING_KIND_NORMAL, handleB.get(), NULL);
+         plan.AddMapping(dtHLAGM::AttributeTranslationPlan::MAPPING_KIND_MAPPING_NAME, NULL, NULL);
+         plan.AddMapping(dtHLAGM::AttributeTranslationPlan::MAPPING_KIND_NORMAL, handleA.get(), NULL);
+         plan.AddMapping(dtHLAGM::AttributeTranslationPlan::MAPPING_KIND_ENTITY_TYPE, handleA.get(), NULL);
+         plan.Finish(42);
+
+         CPPUNIT_ASSERT(plan.IsCompiled());
+         CPPUNIT_ASSERT_EQUAL(size_t(4), plan.GetMappingCount());
+         CPPUNIT_ASSERT(plan.IsCompiledFor(42));
+         CPPUNIT_ASSERT_MESSAGE("Mappings with a different hash need a new plan.", !plan.IsCompiledFor(43));
+         CPPUNIT_ASSERT(plan.GetEntry(1).mKind == dtHLAGM::AttributeTranslationPlan::MAPPING_KIND_MAPPING_NAME);
+
+         // The plan keeps the handles alive, so releasing the mapping's reference doesn't leave it dangling.
+         TestAttributeHandle* rawB = handleB.get();
+         handleB = NULL;
+         CPPUNIT_ASSERT(rawB->referenceCount() > 0);
+         handleB = rawB;
+
+         dtHLAGM::AttributeTranslationPlan::HandleRange range = plan.FindMappings(*handleA);
+         CPPUNIT_ASSERT_EQUAL(2, int(range.second - range.first));
+         CPPUNIT_ASSERT_EQUAL_MESSAGE("Mappings sharing a handle should stay in mapping order.", 2U, *range.first);
+         CPPUNIT_ASSERT_EQUAL(3U, *(range.first + 1));
+
+         range = plan.FindMappings(*handleACopy);
+         CPPUNIT_ASSERT_EQUAL_MESSAGE("A different handle object with the same value should still be found.",
+                  2, int(range.second - range.first));
+         range = plan.FindMappings(*handleACopy);
+         CPPUNIT_ASSERT_EQUAL_MESSAGE("The cached value match should give the same mappings.", 2, int(range.second - range.first));
+         CPPUNIT_ASSERT_EQUAL(2U, *range.first);
+
+         range = plan.FindMappings(*handleB);
+         CPPUNIT_ASSERT_EQUAL(1, int(range.second - range.first));
+         CPPUNIT_ASSERT_EQUAL(0U, *range.first);
+
+         range = plan.FindMappings(*handleUnused);
+         CPPUNIT_ASSERT(range.first == range.second);
+
+         // Same hash as handleA, but a different value.  The second lookup is answered by the cache.
+         range = plan.FindMappings(*handleColliding);
+         CPPUNIT_ASSERT(range.first == range.second);
+         range = plan.FindMappings(*handleColliding);
+         CPPUNIT_ASSERT(range.first == range.second);
+
+         std::vector<dtHLAGM::AttributeToPropertyList> mappings(2);
+         mappings[0].SetHLAName("Orientation");
+         mappings[0].GetParameterDefinitions().push_back(dtHLAGM::OneToManyMapping::ParameterDefinition());
+         size_t mappingsHash = dtHLAGM::AttributeTranslationPlan::HashMappings(mappings);
+         CPPUNIT_ASSERT_EQUAL(mappingsHash, dtHLAGM::AttributeTranslationPlan::HashMappings(mappings));
+
+         mappings[1].SetHLAName("Orientation");
+         CPPUNIT_ASSERT_MESSAGE("Renaming a mapping in place should change the hash.",
+                  mappingsHash != dtHLAGM::AttributeTranslationPlan::HashMappings(mappings));
+         mappingsHash = dtHLAGM::AttributeTranslationPlan::HashMappings(mappings);
+
+         mappings[1].SetAttributeHandle(handleB.get());
+         CPPUNIT_ASSERT_MESSAGE("Resolving a handle should change the hash.",
+                  mappingsHash != dtHLAGM::AttributeTranslationPlan::HashMappings(mappings));
+         mappingsHash = dtHLAGM::AttributeTranslationPlan::HashMappings(mappings);
+
+         mappings[1].GetParameterDefinitions().push_back(dtHLAGM::OneToManyMapping::ParameterDefinition());
+         CPPUNIT_ASSERT_MESSAGE("Adding the first parameter should change the hash.",
+                  mappingsHash != dtHLAGM::AttributeTranslationPlan::HashMappings(mappings));
+
+         plan.Clear();
+         CPPUNIT_ASSERT(!plan.IsCompiled());
+         CPPUNIT_ASSERT_EQUAL(size_t(0), plan.GetMappingCount());
+      }
+
       template <typename OneToXMappingType>
       void TestOneToXMapping(OneToXMappingType& thisOneToXMapping)
       {
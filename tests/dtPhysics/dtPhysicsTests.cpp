@@ -37,6 +37,7 @@
 #include <dtCore/system.h>
 #include <dtCore/scene.h>
 
+#include <dtUtil/datastream.h>
 #include <dtUtil/log.h>
 #include <dtUtil/macros.h>
 #include <dtUtil/fileutils.h>
@@ -47,6 +48,7 @@
 
 #include <string>
 #include <cmath>
+#include <algorithm>
 
 #include <dtPhysics/physicscomponent.h>
 #include <dtPhysics/physicsactcomp.h>
@@ -58,6 +60,7 @@
 #include <dtPhysics/raycast.h>
 #include <dtPhysics/physicsactorregistry.h>
 #include <dtPhysics/bodywrapper.h>
+#include <dtPhysics/collisioncache.h>
 #include <dtPhysics/physicsreaderwriter.h>
 #include <dtPhysics/geometry.h>
 #include <dtPhysics/palutil.h>
@@ -104,6 +107,8 @@ namespace dtPhysics
       CPPUNIT_TEST(testComponentPerEngine);
       CPPUNIT_TEST(testCallbacksPerEngine);
       CPPUNIT_TEST(testPhysicsReaderWriter);
+      CPPUNIT_TEST(testMeshCacheEviction);
+      CPPUNIT_TEST(testCollisionCache);
       CPPUNIT_TEST_SUITE_END();
 
    public:
@@ -143,6 +148,8 @@ namespace dtPhysics
       void testComponentPerEngine();
       void testCallbacksPerEngine();
       void testPhysicsReaderWriter();
+      void testMeshCacheEviction();
+      void testCollisionCache();
 
       // used so we have a place to test actors
       // not called multiple times like the others.
@@ -2117,4 +2124,125 @@ namespace dtPhysics
       CPPUNIT_ASSERT(data->GetMaterialIndex(MAT_NAME_C) == 5);
       CPPUNIT_ASSERT(data->GetMaterialCount() == 3);
    }
+
+   /////////////////////////////////////////////////////////
+   void dtPhysicsTests::testMeshCacheEviction()
+   {
+      dtPhysics::VertexData::ClearAllCachedData();
+      const unsigned oldMax = dtPhysics::VertexData::GetMaxCachedData();
+      dtPhysics::VertexData::SetMaxCachedData(2U);
+      dtPhysics::VertexData::ResetCacheStats();
+
+      dtCore::RefPtr<dtPhysics::VertexData> a, b, c;
+      CPPUNIT_ASSERT(dtPhysics::VertexData::GetOrCreateCachedData(a, "A"));
+      CPPUNIT_ASSERT(dtPhysics::VertexData::GetOrCreateCachedData(b, "B"));
+      // Using A makes B the least recently used, so adding C drops B.
+      CPPUNIT_ASSERT(dtPhysics::VertexData::FindCachedData("A") == a);
+      c = new dtPhysics::VertexData;
+      CPPUNIT_ASSERT(dtPhysics::VertexData::AddCachedData("C", *c));
+      CPPUNIT_ASSERT(!dtPhysics::VertexData::AddCachedData("C", *new dtPhysics::VertexData));
+
+      CPPUNIT_ASSERT(dtPhysics::VertexData::FindCachedData("A") == a);
+      CPPUNIT_ASSERT(!dtPhysics::VertexData::FindCachedData("B").valid());
+      CPPUNIT_ASSERT(dtPhysics::VertexData::FindCachedData("C") == c);
+
+      dtPhysics::VertexData::CacheStats stats = dtPhysics::VertexData::GetCacheStats();
+      CPPUNIT_ASSERT_EQUAL(3U, stats.mHits);
+      // The two creates each miss once, and so does the find of B.
+      CPPUNIT_ASSERT_EQUAL(3U, stats.mMisses);
+      CPPUNIT_ASSERT_EQUAL(1U, stats.mEvictions);
+      CPPUNIT_ASSERT_EQUAL(2U, stats.mNumEntries);
+
+      dtPhysics::VertexData::SetMaxCachedData(oldMax);
+      dtPhysics::VertexData::ClearAllCachedData();
+      CPPUNIT_ASSERT_EQUAL(0U, dtPhysics::VertexData::GetCacheStats().mNumEntries);
+   }
+
+   /////////////////////////////////////////////////////////
+   void dtPhysicsTests::testCollisionCache()
+   {
+      dtUtil::FileUtils& fileUtils = dtUtil::FileUtils::GetInstance();
+      const std::string cacheDir("temp_dtPhysicsCollisionCache");
+      const std::string sourceFile = fileUtils.GetAbsolutePath(".") + "/temp_dtPhysicsCacheSource.phys";
+      if (fileUtils.DirExists(cacheDir))
+      {
+         fileUtils.DirDelete(cacheDir, true);
+      }
+
+      dtCore::RefPtr<dtPhysics::VertexData> data = new dtPhysics::VertexData;
+      for (unsigned i = 0; i < 30; ++i)
+      {
+         data->mVertices.push_back(osg::Vec3(float(i), 0.0f, 1.0f));
+         data->mIndices.push_back(i);
+      }
+      data->SetMaterialName(2, "MatA");
+      CPPUNIT_ASSERT(dtPhysics::PhysicsReaderWriter::SaveTriangleDataFile(*data, sourceFile));
+
+      CPPUNIT_ASSERT(!dtPhysics::CollisionCache::IsEnabled());
+      CPPUNIT_ASSERT(dtPhysics::CollisionCache::GetCacheFileName(sourceFile, false).empty());
+
+      dtPhysics::CollisionCache::SetDirectory(cacheDir);
+      dtPhysics::CollisionCache::ResetStats();
+      CPPUNIT_ASSERT(dtPhysics::CollisionCache::IsEnabled());
+      const std::string cacheFile = dtPhysics::CollisionCache::GetCacheFileName(sourceFile, false);
+      CPPUNIT_ASSERT(!cacheFile.empty());
+      CPPUNIT_ASSERT(cacheFile != dtPhysics::CollisionCache::GetCacheFileName(sourceFile, true));
+
+      dtCore::RefPtr<dtPhysics::VertexData> cooked = new dtPhysics::VertexData;
+      CPPUNIT_ASSERT(dtPhysics::CollisionCache::LoadTriangleData(*cooked, sourceFile, false));
+      CPPUNIT_ASSERT(fileUtils.FileExists(cacheFile));
+
+      dtCore::RefPtr<dtPhysics::VertexData> cached = new dtPhysics::VertexData;
+      CPPUNIT_ASSERT(dtPhysics::CollisionCache::LoadTriangleData(*cached, sourceFile, false));
+      CPPUNIT_ASSERT(cached->mVertices == data->mVertices);
+      CPPUNIT_ASSERT(cached->mIndices == data->mIndices);
+      CPPUNIT_ASSERT_EQUAL(dtPhysics::MaterialIndex(2), cached->GetMaterialIndex("MatA"));
+
+      dtPhysics::CollisionCache::Stats stats = dtPhysics::CollisionCache::GetStats();
+      CPPUNIT_ASSERT_EQUAL(1U, stats.mMisses);
+      CPPUNIT_ASSERT_EQUAL(1U, stats.mWrites);
+      CPPUNIT_ASSERT_EQUAL(1U, stats.mHits);
+
+      // Without a thread pool the request loads right away.
+      dtPhysics::VertexData::ClearAllCachedData();
+      CPPUNIT_ASSERT(dtPhysics::CollisionCache::RequestLoad("CacheTestKey", sourceFile, false));
+      dtPhysics::CollisionCache::WaitForLoad("CacheTestKey");
+      dtCore::RefPtr<dtPhysics::VertexData> requested = dtPhysics::VertexData::FindCachedData("CacheTestKey");
+      CPPUNIT_ASSERT(requested.valid());
+      CPPUNIT_ASSERT(requested->mVertices == data->mVertices);
+      CPPUNIT_ASSERT(!dtPhysics::CollisionCache::RequestLoad("CacheTestKey", sourceFile, false));
+
+      // A corrupt vertex count must be rejected before anything is allocated for it.
+      dtUtil::DataStream valid;
+      dtPhysics::PhysicsReaderWriter::WriteTriangleData(valid, *data);
+      char header[13];
+      CPPUNIT_ASSERT_EQUAL(13U, valid.ReadBinary(header, 13U));
+      dtUtil::DataStream corrupt;
+      corrupt.WriteBinary(header, 13U);
+      corrupt.Write(0x7FFFFFFFU);
+      dtCore::RefPtr<dtPhysics::VertexData> rejected = new dtPhysics::VertexData;
+      CPPUNIT_ASSERT_THROW(dtPhysics::PhysicsReaderWriter::ReadTriangleData(corrupt, *rejected, "corrupt"), dtUtil::Exception);
+      CPPUNIT_ASSERT(rejected->mVertices.empty());
+
+      // Going over the size limit deletes old cooked files until the rest fit.
+      const std::string secondSourceFile = fileUtils.GetAbsolutePath(".") + "/temp_dtPhysicsCacheSource2.phys";
+      CPPUNIT_ASSERT(dtPhysics::PhysicsReaderWriter::SaveTriangleDataFile(*data, secondSourceFile));
+      const std::string secondCacheFile = dtPhysics::CollisionCache::GetCacheFileName(secondSourceFile, false);
+      dtCore::RefPtr<dtPhysics::VertexData> secondCooked = new dtPhysics::VertexData;
+      CPPUNIT_ASSERT(dtPhysics::CollisionCache::LoadTriangleData(*secondCooked, secondSourceFile, false));
+      CPPUNIT_ASSERT(fileUtils.FileExists(secondCacheFile));
+      const size_t largest = std::max(fileUtils.GetFileInfo(cacheFile).size, fileUtils.GetFileInfo(secondCacheFile).size);
+      dtPhysics::CollisionCache::ResetStats();
+      dtPhysics::CollisionCache::SetMaxDirectorySize(largest);
+      CPPUNIT_ASSERT_EQUAL(largest, size_t(dtPhysics::CollisionCache::GetMaxDirectorySize()));
+      CPPUNIT_ASSERT_EQUAL(1U, dtPhysics::CollisionCache::GetStats().mEvictions);
+      CPPUNIT_ASSERT(fileUtils.FileExists(cacheFile) != fileUtils.FileExists(secondCacheFile));
+
+      dtPhysics::VertexData::ClearAllCachedData();
+      dtPhysics::CollisionCache::SetMaxDirectorySize(0ULL);
+      dtPhysics::CollisionCache::SetDirectory("");
+      fileUtils.FileDelete(sourceFile);
+      fileUtils.FileDelete(secondSourceFile);
+      fileUtils.DirDelete(cacheDir, true);
+   }
 }
@@ -0,0 +1,261 @@
+/* -*-c++-*-
+ * allTests - This source file (.h & .cpp) - Using 'The MIT License'
+ * Copyright (C) 2005-2008, Alion Science and Technology Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * This software was developed by Alion Science and Technology Corporation under
+ * circumstances in which the U. S. Government may have rights in the software.
+ */
+
+#include <prefix/unittestprefix.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <dtCore/refptr.h>
+#include <dtCore/system.h>
+#include <dtTerrain/terrain.h>
+#include <dtTerrain/terraindatareader.h>
+#include <dtTerrain/terraindatarenderer.h>
+#include <dtTerrain/terraindatatype.h>
+#include <dtTerrain/pagedterraintile.h>
+#include <dtTerrain/heightfield.h>
+#include <dtTerrain/heightfieldpyramid.h>
+
+#include <osg/Group>
+#include <osg/Math>
+
+#include <cmath>
+#include <map>
+
+namespace
+{
+   const unsigned int TEST_POSTS = 129;
+
+   /**
+    * Fills each tile with rolling hills and a few sharp peaks.
+    */
+   class TestTerrainReader : public dtTerrain::TerrainDataReader
+   {
+   public:
+      bool OnLoadTerrainTile(dtTerrain::PagedTerrainTile& tile)
+      {
+         dtCore::RefPtr<dtTerrain::HeightField> hf = new dtTerrain::HeightField(TEST_POSTS, TEST_POSTS);
+         double lon = tile.GetGeoCoordinates().GetLongitude();
+         for (unsigned int r = 0; r < TEST_POSTS; ++r)
+         {
+            for (unsigned int c = 0; c < TEST_POSTS; ++c)
+            {
+               double h = 200.0 + 150.0 * std::sin((c + lon * 7.0) * 0.1) * std::cos(r * 0.13);
+               if ((c * 31 + r * 17) % 97 == 0)
+               {
+                  h += 900.0;
+               }
+               hf->SetHeight(c, r, short(h));
+            }
+         }
+         tile.SetHeightField(hf.get());
+         return true;
+      }
+
+      const dtTerrain::TerrainDataType& GetDataType() const { return dtTerrain::TerrainDataType::DTED; }
+
+      const std::string GenerateTerrainTileCachePath(const dtTerrain::PagedTerrainTile&) { return "test"; }
+   };
+
+   /**
+    * Samples the tile heightfields bilinearly, with each tile covering its square degree and
+    * row zero at the north edge.
+    */
+   class TestTerrainRenderer : public dtTerrain::TerrainDataRenderer
+   {
+   public:
+      TestTerrainRenderer() : mRoot(new osg::Group) {}
+
+      void OnLoadTerrainTile(dtTerrain::PagedTerrainTile& tile)
+      {
+         const dtTerrain::GeoCoordinates& coords = tile.GetGeoCoordinates();
+         mTiles[std::make_pair(int(coords.GetLatitude()), int(coords.GetLongitude()))] = tile.GetHeightField();
+      }
+
+      void OnUnloadTerrainTile(dtTerrain::PagedTerrainTile& tile)
+      {
+         const dtTerrain::GeoCoordinates& coords = tile.GetGeoCoordinates();
+         mTiles.erase(std::make_pair(int(coords.GetLatitude()), int(coords.GetLongitude())));
+      }
+
+      float GetHeight(float x, float y)
+      {
+         dtTerrain::GeoCoordinates coords;
+         coords.SetCartesianPoint(osg::Vec3(x, y, 0.0f));
+         int lat = int(std::floor(coords.GetLatitude()));
+         int lon = int(std::floor(coords.GetLongitude()));
+
+         TileMap::const_iterator found = mTiles.find(std::make_pair(lat, lon));
+         if (found == mTiles.end())
+         {
+            return 0.0f;
+         }
+
+         dtTerrain::GeoCoordinates origin;
+         origin.SetLatitude(lat);
+         origin.SetLongitude(lon);
+         const osg::Vec3& originPoint = origin.GetCartesianPoint();
+         const float cells = float(TEST_POSTS - 1);
+         const float tileSize = float(dtTerrain::GeoCoordinates::EQUATORIAL_RADIUS * osg::DegreesToRadians(1.0));
+         float c = osg::clampTo((x - originPoint.x()) / tileSize * cells, 0.0f, cells);
+         float r = osg::clampTo(cells - (y - originPoint.y()) / tileSize * cells, 0.0f, cells);
+         return found->second->GetInterpolatedHeight(c, r);
+      }
+
+      osg::Vec3 GetNormal(float, float) { return osg::Vec3(0.0f, 0.0f, 1.0f); }
+
+      osg::Group* GetRootDrawable() { return mRoot.get(); }
+
+      float GetHeightFieldMargin() const { return 0.0f; }
+
+      bool IsGetHeightThreadSafe() const { return true; }
+
+   private:
+      typedef std::map<std::pair<int,int>, dtCore::RefPtr<const dtTerrain::HeightField> > TileMap;
+      TileMap mTiles;
+      dtCore::RefPtr<osg::Group> mRoot;
+   };
+}
+
+/**
+ * @class LineOfSightTests
+ * @brief Checks the accelerated terrain line of sight against SimpleLineOfSight.
+ */
+class LineOfSightTests : public CPPUNIT_NS::TestFixture
+{
+   CPPUNIT_TEST_SUITE(LineOfSightTests);
+      CPPUNIT_TEST(TestHeightFieldPyramid);
+      CPPUNIT_TEST(TestMatchesSimpleLineOfSight);
+   CPPUNIT_TEST_SUITE_END();
+
+   public:
+
+      void setUp()
+      {
+         mTerrain = new dtTerrain::Terrain("LOSTestTerrain");
+         mTerrain->SetAsyncTileLoading(false);
+         mTerrain->SetDataReader(new TestTerrainReader);
+         mTerrain->SetDataRenderer(new TestTerrainRenderer);
+      }
+
+      void tearDown()
+      {
+         mTerrain = NULL;
+      }
+
+      void TestHeightFieldPyramid()
+      {
+         dtCore::RefPtr<dtTerrain::HeightField> hf = new dtTerrain::HeightField(10, 7);
+         short highest = -1000;
+         for (unsigned int r = 0; r < 7; ++r)
+         {
+            for (unsigned int c = 0; c < 10; ++c)
+            {
+               short h = short((c * 37 + r * 11) % 23 - 5);
+               hf->SetHeight(c, r, h);
+               highest = std::max(highest, h);
+            }
+         }
+
+         dtCore::RefPtr<dtTerrain::HeightFieldPyramid> pyramid = new dtTerrain::HeightFieldPyramid;
+         pyramid->Build(*hf);
+         CPPUNIT_ASSERT_EQUAL(9U, pyramid->GetNumColumns(0));
+         CPPUNIT_ASSERT_EQUAL(6U, pyramid->GetNumRows(0));
+
+         unsigned int top = pyramid->GetNumLevels() - 1;
+         CPPUNIT_ASSERT_EQUAL(1U, pyramid->GetNumColumns(top));
+         CPPUNIT_ASSERT_EQUAL(1U, pyramid->GetNumRows(top));
+         CPPUNIT_ASSERT_EQUAL(highest, pyramid->GetMaxHeight(top, 0, 0));
+
+         short cellMax = std::max(std::max(hf->GetHeight(3, 2), hf->GetHeight(4, 2)),
+            std::max(hf->GetHeight(3, 3), hf->GetHeight(4, 3)));
+         short cellMin = std::min(std::min(hf->GetHeight(3, 2), hf->GetHeight(4, 2)),
+            std::min(hf->GetHeight(3, 3), hf->GetHeight(4, 3)));
+         CPPUNIT_ASSERT_EQUAL(cellMax, pyramid->GetMaxHeight(0, 3, 2));
+         CPPUNIT_ASSERT_EQUAL(cellMin, pyramid->GetMinHeight(0, 3, 2));
+      }
+
+      void TestMatchesSimpleLineOfSight()
+      {
+         dtTerrain::GeoCoordinates coords;
+         for (int lon = 0; lon < 2; ++lon)
+         {
+            coords.SetLatitude(0);
+            coords.SetLongitude(lon);
+            coords.SetAltitude(0);
+            mTerrain->LoadTerrainTile(*mTerrain->CreateTerrainTile(coords));
+         }
+         mTerrain->OnSystem(dtCore::System::MESSAGE_PRE_FRAME, 0.0, 0.0);
+
+         const float tileSize = float(dtTerrain::GeoCoordinates::EQUATORIAL_RADIUS * osg::DegreesToRadians(1.0));
+         std::vector<dtTerrain::LineOfSightQuery> queries;
+         unsigned int seed = 12345;
+         for (unsigned int i = 0; i < 400; ++i)
+         {
+            // Start points over both tiles, some rays crossing the boundary between them.
+            osg::Vec3 start(tileSize * (0.5f + NextRandom(seed)), tileSize * (0.1f + 0.8f * NextRandom(seed)),
+               150.0f + 500.0f * NextRandom(seed));
+            osg::Vec3 end = start + osg::Vec3(20000.0f * (NextRandom(seed) - 0.5f),
+               20000.0f * (NextRandom(seed) - 0.5f), 800.0f * (NextRandom(seed) - 0.5f));
+            queries.push_back(dtTerrain::LineOfSightQuery(start, end));
+         }
+
+         unsigned int numBlocked = 0;
+         for (unsigned int i = 0; i < queries.size(); ++i)
+         {
+            const dtTerrain::LineOfSightQuery& query = queries[i];
+            bool expected = dtTerrain::SimpleLineOfSight(mTerrain.get(), query.mStart, query.mEnd);
+            osg::Vec3 blockingPoint;
+            CPPUNIT_ASSERT_EQUAL(expected, mTerrain->IsClearLineOfSight(query.mStart, query.mEnd, blockingPoint));
+            if (!expected)
+            {
+               ++numBlocked;
+               CPPUNIT_ASSERT(blockingPoint.z() >= 0.0f);
+            }
+         }
+
+         // Make sure the test covers both results.
+         CPPUNIT_ASSERT(numBlocked > 0 && numBlocked < queries.size());
+
+         mTerrain->ComputeLinesOfSight(queries);
+         for (unsigned int i = 0; i < queries.size(); ++i)
+         {
+            const dtTerrain::LineOfSightQuery& query = queries[i];
+            CPPUNIT_ASSERT_EQUAL(dtTerrain::SimpleLineOfSight(mTerrain.get(), query.mStart, query.mEnd),
+               query.mClear);
+         }
+      }
+
+   private:
+
+      float NextRandom(unsigned int& seed)
+      {
+         seed = seed * 1103515245U + 12345U;
+         return float((seed >> 8) & 0xFFFF) / 65535.0f;
+      }
+
+      dtCore::RefPtr<dtTerrain::Terrain> mTerrain;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(LineOfSightTests);
@@ -0,0 +1,269 @@
+/* -*-c++-*-
+ * allTests - This source file (.h & .cpp) - Using 'The MIT License'
+ * Copyright (C) 2005-2008, Alion Science and Technology Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * This software was developed by Alion Science and Technology Corporation under
+ * circumstances in which the U. S. Government may have rights in the software.
+ */
+
+#include <prefix/unittestprefix.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <dtCore/refptr.h>
+#include <dtCore/system.h>
+#include <dtCore/timer.h>
+#include <dtTerrain/terrain.h>
+#include <dtTerrain/terraindatareader.h>
+#include <dtTerrain/terraindatarenderer.h>
+#include <dtTerrain/terraindatatype.h>
+#include <dtTerrain/pagedterraintile.h>
+#include <dtUtil/threadpool.h>
+
+#include <osg/Group>
+
+#include <OpenThreads/Atomic>
+#include <OpenThreads/Block>
+
+namespace
+{
+   // Kept outside the reader so they can be checked after the terrain deletes it.
+   OpenThreads::Atomic gNumLoadsStarted;
+   OpenThreads::Atomic gNumUnloads;
+
+   /**
+    * Counts the tiles it is asked for.  When gated, each load waits until the gate is released,
+    * which holds the tile on the paging thread.
+    */
+   class PagingTestReader : public dtTerrain::TerrainDataReader
+   {
+   public:
+      PagingTestReader(OpenThreads::Block* gate = NULL, unsigned int sleepMS = 0)
+      : mGate(gate)
+      , mSleepMS(sleepMS)
+      {
+      }
+
+      bool OnLoadTerrainTile(dtTerrain::PagedTerrainTile&)
+      {
+         ++gNumLoadsStarted;
+         if (mGate != NULL)
+         {
+            mGate->block();
+         }
+         if (mSleepMS > 0)
+         {
+            dtCore::AppSleep(mSleepMS);
+         }
+         return true;
+      }
+
+      void OnUnloadTerrainTile(dtTerrain::PagedTerrainTile&)
+      {
+         ++gNumUnloads;
+      }
+
+      const dtTerrain::TerrainDataType& GetDataType() const { return dtTerrain::TerrainDataType::DTED; }
+
+      const std::string GenerateTerrainTileCachePath(const dtTerrain::PagedTerrainTile&) { return "test"; }
+
+   private:
+      OpenThreads::Block* mGate;
+      unsigned int mSleepMS;
+   };
+
+   /// Counts the tiles attached to the scene.
+   class PagingTestRenderer : public dtTerrain::TerrainDataRenderer
+   {
+   public:
+      PagingTestRenderer() : mRoot(new osg::Group), mNumAttached(0) {}
+
+      void OnLoadTerrainTile(dtTerrain::PagedTerrainTile&) { ++mNumAttached; }
+
+      float GetHeight(float, float) { return 0.0f; }
+
+      osg::Vec3 GetNormal(float, float) { return osg::Vec3(0.0f, 0.0f, 1.0f); }
+
+      osg::Group* GetRootDrawable() { return mRoot.get(); }
+
+      unsigned int GetNumAttached() const { return mNumAttached; }
+
+   private:
+      dtCore::RefPtr<osg::Group> mRoot;
+      unsigned int mNumAttached;
+   };
+}
+
+/**
+ * @class TerrainPagingTests
+ * @brief Tests loading terrain tiles on the thread pool.
+ */
+class TerrainPagingTests : public CPPUNIT_NS::TestFixture
+{
+   CPPUNIT_TEST_SUITE(TerrainPagingTests);
+      CPPUNIT_TEST(TestAsyncDefaultsOff);
+      CPPUNIT_TEST(TestAsyncLoad);
+      CPPUNIT_TEST(TestUnloadWhileInFlight);
+      CPPUNIT_TEST(TestDeleteWhileLoading);
+   CPPUNIT_TEST_SUITE_END();
+
+   public:
+
+      void setUp()
+      {
+         mStartedThreadPool = !dtUtil::ThreadPool::IsInitialized();
+         if (mStartedThreadPool)
+         {
+            dtUtil::ThreadPool::Init();
+         }
+
+         gNumLoadsStarted = 0;
+         gNumUnloads = 0;
+         mRenderer = new PagingTestRenderer;
+         mTerrain = new dtTerrain::Terrain("PagingTestTerrain");
+         mTerrain->SetDataRenderer(mRenderer.get());
+      }
+
+      void tearDown()
+      {
+         mGate.release();
+         mTerrain = NULL;
+         mRenderer = NULL;
+         if (mStartedThreadPool)
+         {
+            dtUtil::ThreadPool::Shutdown();
+         }
+      }
+
+      void TestAsyncDefaultsOff()
+      {
+         CPPUNIT_ASSERT(!mTerrain->GetAsyncTileLoading());
+
+         mTerrain->SetDataReader(new PagingTestReader);
+         LoadTiles(2);
+         PreFrame();
+         CPPUNIT_ASSERT_EQUAL(0U, mTerrain->GetNumTilesLoading());
+         CPPUNIT_ASSERT_EQUAL(2U, mRenderer->GetNumAttached());
+      }
+
+      void TestAsyncLoad()
+      {
+         mTerrain->SetAsyncTileLoading(true);
+         mTerrain->SetDataReader(new PagingTestReader);
+         LoadTiles(5);
+         CPPUNIT_ASSERT(PageUntilLoaded());
+         CPPUNIT_ASSERT_EQUAL(5U, mRenderer->GetNumAttached());
+         CPPUNIT_ASSERT_EQUAL(5U, unsigned(gNumLoadsStarted));
+      }
+
+      void TestUnloadWhileInFlight()
+      {
+         mGate.reset();
+         mTerrain->SetAsyncTileLoading(true);
+         mTerrain->SetDataReader(new PagingTestReader(&mGate));
+         LoadTiles(3);
+         PreFrame();
+         CPPUNIT_ASSERT(WaitForLoadsStarted(1));
+
+         // The first tile is held on the paging thread, the other two haven't started.
+         mTerrain->UnloadAllTerrainTiles();
+         PostFrame();
+         CPPUNIT_ASSERT_EQUAL(1U, mTerrain->GetNumTilesLoading());
+
+         mGate.release();
+         CPPUNIT_ASSERT(PageUntilLoaded());
+         PostFrame();
+
+         // None are attached, the two waiting were never read, and the one read was unloaded.
+         CPPUNIT_ASSERT_EQUAL(0U, mRenderer->GetNumAttached());
+         CPPUNIT_ASSERT_EQUAL(1U, unsigned(gNumLoadsStarted));
+         CPPUNIT_ASSERT_EQUAL(1U, unsigned(gNumUnloads));
+      }
+
+      void TestDeleteWhileLoading()
+      {
+         mTerrain->SetAsyncTileLoading(true);
+         mTerrain->SetDataReader(new PagingTestReader(NULL, 20));
+         LoadTiles(6);
+         PreFrame();
+         CPPUNIT_ASSERT(WaitForLoadsStarted(1));
+
+         // Deleting must wait for the tile being read and drop the rest.
+         mTerrain = NULL;
+         unsigned int numStarted = gNumLoadsStarted;
+         CPPUNIT_ASSERT(numStarted < 6);
+         dtCore::AppSleep(100);
+         CPPUNIT_ASSERT_EQUAL(numStarted, unsigned(gNumLoadsStarted));
+      }
+
+   private:
+
+      void LoadTiles(int count)
+      {
+         dtTerrain::GeoCoordinates coords;
+         for (int lon = 0; lon < count; ++lon)
+         {
+            coords.SetLatitude(0);
+            coords.SetLongitude(lon);
+            coords.SetAltitude(0);
+            mTerrain->LoadTerrainTile(*mTerrain->CreateTerrainTile(coords));
+         }
+      }
+
+      void PreFrame()
+      {
+         mTerrain->OnSystem(dtCore::System::MESSAGE_PRE_FRAME, 0.0, 0.0);
+      }
+
+      void PostFrame()
+      {
+         mTerrain->OnSystem(dtCore::System::MESSAGE_POST_FRAME, 0.0, 0.0);
+      }
+
+      bool PageUntilLoaded()
+      {
+         for (int i = 0; i < 500; ++i)
+         {
+            PreFrame();
+            if (mTerrain->GetNumTilesLoading() == 0)
+            {
+               return true;
+            }
+            dtCore::AppSleep(10);
+         }
+         return false;
+      }
+
+      bool WaitForLoadsStarted(unsigned int count)
+      {
+         for (int i = 0; i < 500 && unsigned(gNumLoadsStarted) < count; ++i)
+         {
+            dtCore::AppSleep(10);
+         }
+         return unsigned(gNumLoadsStarted) >= count;
+      }
+
+      dtCore::RefPtr<dtTerrain::Terrain> mTerrain;
+      dtCore::RefPtr<PagingTestRenderer> mRenderer;
+      OpenThreads::Block mGate;
+      bool mStartedThreadPool;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TerrainPagingTests);
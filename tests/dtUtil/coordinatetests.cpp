@@ -37,6 +37,7 @@
 #include <iostream>
 #include <osg/io_utils>
 #include <osg/Math>
+#include <osg/Timer>
 
 /**
  * @class CoordinateTests
@@ -59,6 +60,7 @@ class CoordinateTests : public CPPUNIT_NS::TestFixture
       CPPUNIT_TEST(TestMGRSvsXYZ);
       CPPUNIT_TEST(TestConvertGeodeticToUTM );
       CPPUNIT_TEST(TestConvertUTMToGeodetic);
+      CPPUNIT_TEST(TestBatchConversions);
    CPPUNIT_TEST_SUITE_END();
 
    public:
@@ -80,6 +82,7 @@ class CoordinateTests : public CPPUNIT_NS::TestFixture
       void TestConvertGeodeticToUTM();
       void TestMGRSvsXYZ();
       void TestConvertUTMToGeodetic();
+      void TestBatchConversions();
 
    private:
 
@@ -812,3 +815,78 @@ void CoordinateTests::TestConvertUTMToGeodetic()
    CPPUNIT_ASSERT_DOUBLES_EQUAL( -45.1, osg::RadiansToDegrees(lat), epsilon );
    CPPUNIT_ASSERT_DOUBLES_EQUAL( -123.0, osg::RadiansToDegrees(lon), epsilon );
 }
+
+//////////////////////////////////////////////////////////////////////////////
+void CoordinateTests::TestBatchConversions()
+{
+   converter->SetIncomingCoordinateType(dtUtil::IncomingCoordinateType::GEOCENTRIC);
+   converter->SetLocalCoordinateType(dtUtil::LocalCoordinateType::CARTESIAN_UTM);
+
+   converter->SetLocalOffset(osg::Vec3d(562078.225268, 3788040.632974, -32.0));
+   converter->SetUTMZone(11);
+   converter->SetRemoteReferenceForOriginRotationMatrix(osg::Vec3d(-2321639.117695, -4740372.413446, 3569341.066936));
+
+   const size_t count = 2000;
+   std::vector<osg::Vec3d> locs(count);
+   std::vector<osg::Vec3> rots(count);
+   for (size_t i = 0; i < count; ++i)
+   {
+      double offset = double(i) * 3.7;
+      locs[i].set(-2321639.117695 + offset, -4740372.413446 - offset, 3569341.066936 + 0.5 * offset);
+      float angle = float(i % 100) * 0.02f - 1.0f;
+      rots[i].set(angle, 0.5f * angle, -0.7f * angle);
+   }
+
+   std::vector<osg::Vec3> singleTranslations(count), singleRotations(count);
+   std::vector<osg::Vec3> batchTranslations(count), batchRotations(count);
+
+   // Not a pass/fail check, the timings are logged so changes to the batch code can be compared.
+   const unsigned runs = 10;
+   osg::Timer_t start = osg::Timer::instance()->tick();
+   for (unsigned run = 0; run < runs; ++run)
+   {
+      for (size_t i = 0; i < count; ++i)
+      {
+         singleTranslations[i] = converter->ConvertToLocalTranslation(locs[i]);
+         singleRotations[i] = converter->ConvertToLocalRotation(rots[i][0], rots[i][1], rots[i][2]);
+      }
+   }
+   osg::Timer_t mid = osg::Timer::instance()->tick();
+   for (unsigned run = 0; run < runs; ++run)
+   {
+      converter->ConvertToLocalTransforms(&locs[0], &rots[0], &batchTranslations[0], &batchRotations[0], count);
+   }
+   osg::Timer_t end = osg::Timer::instance()->tick();
+
+   mLogger->LogMessage(dtUtil::Log::LOG_ALWAYS, __FUNCTION__, __LINE__,
+            "Converting %u transforms %u times took %lf ms one at a time and %lf ms as a batch.",
+            unsigned(count), runs, osg::Timer::instance()->delta_m(start, mid), osg::Timer::instance()->delta_m(mid, end));
+
+   for (size_t i = 0; i < count; ++i)
+   {
+      std::ostringstream ss;
+      ss << "Index " << i << " Expected: " << singleTranslations[i] << ", Actual: " << batchTranslations[i];
+      CPPUNIT_ASSERT_MESSAGE(ss.str(), dtUtil::Equivalent(singleTranslations[i], batchTranslations[i], 1e-2f));
+
+      ss.str("");
+      ss << "Index " << i << " Expected: " << singleRotations[i] << ", Actual: " << batchRotations[i];
+      CPPUNIT_ASSERT_MESSAGE(ss.str(), dtUtil::Equivalent(singleRotations[i], batchRotations[i], 1e-3f));
+   }
+
+   std::vector<osg::Vec3d> remoteLocs(count);
+   converter->ConvertToRemoteTranslations(&batchTranslations[0], &remoteLocs[0], count);
+   for (size_t i = 0; i < count; ++i)
+   {
+      CPPUNIT_ASSERT(converter->ConvertToRemoteTranslation(batchTranslations[i]) == remoteLocs[i]);
+   }
+
+   std::vector<osg::Vec3d> remoteRots(count);
+   converter->ConvertToRemoteRotations(&batchRotations[0], &remoteRots[0], count);
+   for (size_t i = 0; i < count; ++i)
+   {
+      osg::Vec3d expected = converter->ConvertToRemoteRotation(batchRotations[i]);
+      std::ostringstream ss;
+      ss << "Index " << i << " Expected: " << expected << ", Actual: " << remoteRots[i];
+      CPPUNIT_ASSERT_MESSAGE(ss.str(), dtUtil::Equivalent(expected, remoteRots[i], 1e-4));
+   }
+}
@@ -0,0 +1,297 @@
+/* -*-c++-*-
+* allTests - This source file (.h & .cpp) - Using 'The MIT License'
+* Copyright (C) 2014, Caper Holdings, LLC
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+* THE SOFTWARE.
+*/
+#include <prefix/unittestprefix.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <dtUtil/datastream.h>
+#include <dtUtil/log.h>
+#include <osg/io_utils>
+#include <osg/Timer>
+
+#include <climits>
+#include <utility>
+
+namespace dtUtil
+{
+   class DataStreamTests : public CPPUNIT_NS::TestFixture
+   {
+      CPPUNIT_TEST_SUITE(DataStreamTests);
+         CPPUNIT_TEST(TestFixedWidthRoundTrip);
+         CPPUNIT_TEST(TestVariableLengthRoundTrip);
+         CPPUNIT_TEST(TestVarIntSizes);
+         CPPUNIT_TEST(TestGrowthPolicyAndReserve);
+         CPPUNIT_TEST(TestView);
+         CPPUNIT_TEST(TestCopyAndMove);
+         CPPUNIT_TEST(TestThroughput);
+      CPPUNIT_TEST_SUITE_END();
+
+   public:
+
+      void WriteValues(DataStream& ds, const std::string& longString)
+      {
+         ds << true << 'c' << (unsigned char)(200) << short(-3) << (unsigned short)(65535)
+            << -1 << 300U << long(-70000) << (unsigned long)(70000UL)
+            << LLONG_MIN << ULLONG_MAX << 1.5f << 2.25
+            << std::string("hello") << longString << osg::Vec3f(1.0f, 2.0f, 3.0f);
+      }
+
+      void CheckValues(DataStream& ds, const std::string& longString)
+      {
+         bool b; char c; unsigned char uc; short s; unsigned short us; int i; unsigned u;
+         long l; unsigned long ul; long long ll; unsigned long long ull; float f; double d;
+         std::string shortStr, longStr; osg::Vec3f vec;
+
+         ds >> b >> c >> uc >> s >> us >> i >> u >> l >> ul >> ll >> ull >> f >> d
+            >> shortStr >> longStr >> vec;
+
+         CPPUNIT_ASSERT(b);
+         CPPUNIT_ASSERT_EQUAL('c', c);
+         CPPUNIT_ASSERT_EQUAL((unsigned char)(200), uc);
+         CPPUNIT_ASSERT_EQUAL(short(-3), s);
+         CPPUNIT_ASSERT_EQUAL((unsigned short)(65535), us);
+         CPPUNIT_ASSERT_EQUAL(-1, i);
+         CPPUNIT_ASSERT_EQUAL(300U, u);
+         CPPUNIT_ASSERT_EQUAL(long(-70000), l);
+         CPPUNIT_ASSERT_EQUAL((unsigned long)(70000UL), ul);
+         CPPUNIT_ASSERT_EQUAL(LLONG_MIN, ll);
+         CPPUNIT_ASSERT_EQUAL(ULLONG_MAX, ull);
+         CPPUNIT_ASSERT_EQUAL(1.5f, f);
+         CPPUNIT_ASSERT_EQUAL(2.25, d);
+         CPPUNIT_ASSERT_EQUAL(std::string("hello"), shortStr);
+         CPPUNIT_ASSERT_EQUAL(longString, longStr);
+         CPPUNIT_ASSERT_EQUAL(osg::Vec3f(1.0f, 2.0f, 3.0f), vec);
+         CPPUNIT_ASSERT_EQUAL(0U, ds.GetRemainingReadSize());
+      }
+
+      void TestFixedWidthRoundTrip()
+      {
+         DataStream ds;
+         CPPUNIT_ASSERT(!ds.GetVariableLengthEncoding());
+         std::string longString(1000, 'x');
+         WriteValues(ds, longString);
+         CheckValues(ds, longString);
+
+         // The fixed width format is unchanged, a 4 byte int and a 1 byte size in front of a short string.
+         DataStream fixed;
+         fixed << 5 << std::string("abc");
+         CPPUNIT_ASSERT_EQUAL(8U, fixed.GetBufferSize());
+      }
+
+      void TestVariableLengthRoundTrip()
+      {
+         DataStream ds;
+         ds.SetVariableLengthEncoding(true);
+         // Long strings are not truncated in this mode.
+         std::string longString(40000, 'y');
+         WriteValues(ds, longString);
+         CheckValues(ds, longString);
+
+         DataStream small;
+         small.SetVariableLengthEncoding(true);
+         small << 5 << std::string("abc");
+         CPPUNIT_ASSERT_EQUAL(5U, small.GetBufferSize());
+
+         // A fixed width reader of the same stream reads the old format again.
+         small.ClearBuffer();
+         small.SetVariableLengthEncoding(false);
+         small << 5;
+         int value = 0;
+         small >> value;
+         CPPUNIT_ASSERT_EQUAL(5, value);
+         CPPUNIT_ASSERT_EQUAL(4U, small.GetBufferSize());
+      }
+
+      void TestVarIntSizes()
+      {
+         DataStream ds;
+         ds.WriteVarUInt(0ULL);
+         CPPUNIT_ASSERT_EQUAL(1U, ds.GetBufferSize());
+         ds.WriteVarUInt(127ULL);
+         CPPUNIT_ASSERT_EQUAL(2U, ds.GetBufferSize());
+         ds.WriteVarUInt(128ULL);
+         CPPUNIT_ASSERT_EQUAL(4U, ds.GetBufferSize());
+         ds.WriteVarUInt(ULLONG_MAX);
+         CPPUNIT_ASSERT_EQUAL(14U, ds.GetBufferSize());
+         ds.WriteVarInt(-1LL);
+         CPPUNIT_ASSERT_EQUAL(15U, ds.GetBufferSize());
+
+         unsigned long long u = 1ULL;
+         long long s = 0LL;
+         ds.ReadVarUInt(u);
+         CPPUNIT_ASSERT_EQUAL(0ULL, u);
+         ds.ReadVarUInt(u);
+         CPPUNIT_ASSERT_EQUAL(127ULL, u);
+         ds.ReadVarUInt(u);
+         CPPUNIT_ASSERT_EQUAL(128ULL, u);
+         ds.ReadVarUInt(u);
+         CPPUNIT_ASSERT_EQUAL(ULLONG_MAX, u);
+         ds.ReadVarInt(s);
+         CPPUNIT_ASSERT_EQUAL(-1LL, s);
+
+         CPPUNIT_ASSERT_THROW(ds.ReadVarUInt(u), DataStreamBufferReadError);
+
+         // A truncated varint must not read past the end.
+         DataStream truncated;
+         truncated << (unsigned char)(0x80);
+         CPPUNIT_ASSERT_THROW(truncated.ReadVarUInt(u), DataStreamBufferReadError);
+      }
+
+      void TestGrowthPolicyAndReserve()
+      {
+         DataStream ds(0U);
+         CPPUNIT_ASSERT_EQUAL(0U, ds.GetBufferCapacity());
+         CPPUNIT_ASSERT_EQUAL(DataStream::DEFAULT_GROWTH_FACTOR, ds.GetGrowthFactor());
+
+         ds.SetGrowthPolicy(1.0f, 64U);
+         ds << 1;
+         CPPUNIT_ASSERT_EQUAL(64U, ds.GetBufferCapacity());
+         ds.WriteBytes(0, 61U);
+         CPPUNIT_ASSERT_EQUAL(128U, ds.GetBufferCapacity());
+
+         ds.SetGrowthPolicy(0.5f, 0U);
+         CPPUNIT_ASSERT_EQUAL(1.0f, ds.GetGrowthFactor());
+
+         CPPUNIT_ASSERT_EQUAL(4096U, ds.Reserve(4096U));
+         CPPUNIT_ASSERT_EQUAL(4096U, ds.Reserve(16U));
+         CPPUNIT_ASSERT_EQUAL(65U, ds.GetBufferSize());
+
+         int value = 0;
+         ds >> value;
+         CPPUNIT_ASSERT_EQUAL(1, value);
+
+         // A write bigger than one growth step still fits.
+         DataStream big(4U);
+         big.SetGrowthPolicy(1.0f, 1U);
+         big << 2.0;
+         CPPUNIT_ASSERT(big.GetBufferCapacity() >= 8U);
+      }
+
+      void TestView()
+      {
+         DataStream source;
+         source << 42 << std::string("view");
+
+         DataStream view = DataStream::CreateView(source.GetBuffer(), source.GetBufferSize());
+         CPPUNIT_ASSERT(view.IsReadOnlyView());
+         CPPUNIT_ASSERT(view.GetBuffer() == source.GetBuffer());
+
+         int value = 0;
+         std::string str;
+         view >> value >> str;
+         CPPUNIT_ASSERT_EQUAL(42, value);
+         CPPUNIT_ASSERT_EQUAL(std::string("view"), str);
+
+         CPPUNIT_ASSERT_THROW(view << 1, DataStreamBufferWriteError);
+         CPPUNIT_ASSERT_THROW(view.ClearBuffer(), DataStreamBufferWriteError);
+         CPPUNIT_ASSERT_THROW(view.SetBufferSize(64U), DataStreamBufferWriteError);
+
+         // Copying a view doesn't copy the memory either.
+         DataStream viewCopy(view);
+         CPPUNIT_ASSERT(viewCopy.IsReadOnlyView());
+         CPPUNIT_ASSERT(viewCopy.GetBuffer() == source.GetBuffer());
+
+         DataStream empty = DataStream::CreateView(NULL, 0U);
+         CPPUNIT_ASSERT_THROW(empty >> value, DataStreamBufferReadError);
+      }
+
+      void TestCopyAndMove()
+      {
+         DataStream source;
+         source.SetVariableLengthEncoding(true);
+         source << 7 << std::string("moved");
+
+         DataStream copy(source);
+         CPPUNIT_ASSERT(copy.GetBuffer() != source.GetBuffer());
+         CPPUNIT_ASSERT(copy.GetVariableLengthEncoding());
+
+         const char* buffer = source.GetBuffer();
+         DataStream moved(std::move(source));
+         CPPUNIT_ASSERT(moved.GetBuffer() == buffer);
+         CPPUNIT_ASSERT_EQUAL(0U, source.GetBufferSize());
+
+         int value = 0;
+         std::string str;
+         moved >> value >> str;
+         CPPUNIT_ASSERT_EQUAL(7, value);
+         CPPUNIT_ASSERT_EQUAL(std::string("moved"), str);
+
+         // The moved from stream can be written again.
+         source << 9;
+         source >> value;
+         CPPUNIT_ASSERT_EQUAL(9, value);
+
+         copy = std::move(moved);
+         CPPUNIT_ASSERT(copy.GetBuffer() == buffer);
+      }
+
+      void TestThroughput()
+      {
+         const unsigned count = 200000U;
+         osg::Timer* timer = osg::Timer::instance();
+         double fixedMs = 0.0, varMs = 0.0, readMs = 0.0;
+         unsigned fixedSize = 0U, varSize = 0U;
+
+         for (int mode = 0; mode < 2; ++mode)
+         {
+            DataStream ds;
+            ds.SetVariableLengthEncoding(mode == 1);
+
+            osg::Timer_t start = timer->tick();
+            for (unsigned i = 0; i < count; ++i)
+            {
+               ds << i << int(i % 200) - 100 << 0.5f;
+            }
+            osg::Timer_t mid = timer->tick();
+
+            unsigned u = 0U;
+            int s = 0;
+            float f = 0.0f;
+            for (unsigned i = 0; i < count; ++i)
+            {
+               ds >> u >> s >> f;
+               CPPUNIT_ASSERT_EQUAL(i, u);
+            }
+            osg::Timer_t end = timer->tick();
+
+            if (mode == 0)
+            {
+               fixedMs = timer->delta_m(start, mid);
+               fixedSize = ds.GetBufferSize();
+            }
+            else
+            {
+               varMs = timer->delta_m(start, mid);
+               varSize = ds.GetBufferSize();
+            }
+            readMs += timer->delta_m(mid, end);
+         }
+
+         CPPUNIT_ASSERT(varSize < fixedSize);
+
+         Log::GetInstance().LogMessage(Log::LOG_ALWAYS, __FUNCTION__, __LINE__,
+                  "Writing %u records took %lf ms fixed width (%u bytes) and %lf ms variable length (%u bytes), reading both took %lf ms.",
+                  count, fixedMs, fixedSize, varMs, varSize, readMs);
+      }
+   };
+
+   CPPUNIT_TEST_SUITE_REGISTRATION(DataStreamTests);
+}
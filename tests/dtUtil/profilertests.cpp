@@ -0,0 +1,130 @@
+/* -*-c++-*-
+* allTests - This source file (.h & .cpp) - Using 'The MIT License'
+* Copyright (C) 2014, Caper Holdings, LLC
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+* THE SOFTWARE.
+*/
+#include <prefix/unittestprefix.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <dtUtil/profiler.h>
+#include <sstream>
+
+namespace dtUtil
+{
+   class ProfilerTests : public CPPUNIT_NS::TestFixture
+   {
+      CPPUNIT_TEST_SUITE(ProfilerTests);
+         CPPUNIT_TEST(TestZonesAndCounters);
+         CPPUNIT_TEST(TestRingBufferKeepsNewest);
+         CPPUNIT_TEST(TestInternName);
+      CPPUNIT_TEST_SUITE_END();
+
+   public:
+      void setUp()
+      {
+         Profiler& profiler = Profiler::GetInstance();
+         mOldEventsPerThread = profiler.GetEventsPerThread();
+         profiler.SetEnabled(true);
+         profiler.Clear();
+      }
+
+      void tearDown()
+      {
+         Profiler& profiler = Profiler::GetInstance();
+         profiler.SetEnabled(false);
+         profiler.SetEventsPerThread(mOldEventsPerThread);
+         profiler.Clear();
+      }
+
+      void TestZonesAndCounters()
+      {
+         Profiler& profiler = Profiler::GetInstance();
+         profiler.SetThreadName("Test \"Thread\"");
+         profiler.MarkFrame();
+         CPPUNIT_ASSERT_EQUAL(1U, profiler.GetFrameNumber());
+         {
+            ProfileZone zone("Outer Zone");
+            ProfileZone inner("Inner Zone");
+         }
+         profiler.RecordCounter("Test Counter", 42.0);
+
+         std::ostringstream ss;
+         profiler.ExportChromeTrace(ss);
+         const std::string trace = ss.str();
+
+         CPPUNIT_ASSERT(trace.find("{\"traceEvents\":[") == 0);
+         CPPUNIT_ASSERT(trace.find("\"name\":\"Outer Zone\"") != std::string::npos);
+         CPPUNIT_ASSERT(trace.find("\"name\":\"Inner Zone\"") != std::string::npos);
+         CPPUNIT_ASSERT(trace.find("\"ph\":\"X\"") != std::string::npos);
+         CPPUNIT_ASSERT(trace.find("\"name\":\"Test Counter\"") != std::string::npos);
+         CPPUNIT_ASSERT(trace.find("\"value\":42") != std::string::npos);
+         CPPUNIT_ASSERT(trace.find("\"frame\":1") != std::string::npos);
+         // The quotes in the thread name must be escaped.
+         CPPUNIT_ASSERT(trace.find("Test \\\"Thread\\\"") != std::string::npos);
+
+         profiler.Clear();
+         CPPUNIT_ASSERT_EQUAL(0U, profiler.GetFrameNumber());
+         ss.str("");
+         profiler.ExportChromeTrace(ss);
+         CPPUNIT_ASSERT(ss.str().find("Outer Zone") == std::string::npos);
+
+         profiler.SetEnabled(false);
+         {
+            ProfileZone zone("Disabled Zone");
+         }
+         ss.str("");
+         profiler.ExportChromeTrace(ss);
+         CPPUNIT_ASSERT_MESSAGE("Zones should not be recorded while the profiler is disabled.",
+            ss.str().find("Disabled Zone") == std::string::npos);
+      }
+
+      void TestRingBufferKeepsNewest()
+      {
+         Profiler& profiler = Profiler::GetInstance();
+         profiler.SetEventsPerThread(4U);
+         profiler.Clear();
+
+         profiler.RecordCounter("Oldest", 1.0);
+         for (unsigned i = 0; i < 4; ++i)
+         {
+            profiler.RecordCounter("Newer", double(i));
+         }
+
+         std::ostringstream ss;
+         profiler.ExportChromeTrace(ss);
+         CPPUNIT_ASSERT(ss.str().find("Oldest") == std::string::npos);
+         CPPUNIT_ASSERT(ss.str().find("Newer") != std::string::npos);
+      }
+
+      void TestInternName()
+      {
+         Profiler& profiler = Profiler::GetInstance();
+         std::string name("Component A");
+         const char* interned = profiler.InternName(name);
+         name = "Component B";
+         CPPUNIT_ASSERT_EQUAL(std::string("Component A"), std::string(interned));
+         CPPUNIT_ASSERT(interned == profiler.InternName("Component A"));
+      }
+
+   private:
+      unsigned mOldEventsPerThread;
+   };
+
+   CPPUNIT_TEST_SUITE_REGISTRATION(ProfilerTests);
+}
@@ -0,0 +1,70 @@
+/* -*-c++-*-
+ * CharacterBundleCompiler - main (.h & .cpp) - Using 'The MIT License'
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+///Utility to pack a character file and the skeleton, meshes, animations, materials and pose mesh it uses
+///into one character bundle so the model database loads it with a single read.
+///The character file remains the file to edit; the model database only uses the bundle while it is at least
+///as new as the character file.
+/// Examples
+///     CharacterBundleCompiler.exe "c:/DemoProject/SkeletalMeshes/marine/marine.dtchar"
+///            will write marine.dtcharb next to marine.dtchar
+///     CharacterBundleCompiler.exe "c:/DemoProject/SkeletalMeshes/marine/marine.dtchar" output.dtcharb
+///            will write the marine into output.dtcharb
+
+#include <dtUtil/log.h>
+#include <dtAnim/characterbundle.h>
+
+void usage(const std::string& progName)
+{
+   LOG_ALWAYS("usage:" + progName + " <Character File> [outputFile." + dtAnim::CharacterBundle::FILE_EXTENSION + "]");
+}
+
+int main(int argc, char** argv)
+{
+   if (argc<2)
+   {
+      usage(std::string(argv[0]));
+      return 1;
+   }
+
+   const std::string characterFile(argv[1]);
+
+   std::string outputFilename;
+   if (argc > 2)
+   {
+      outputFilename = std::string(argv[2]);
+   }
+   else
+   {
+      outputFilename = dtAnim::CharacterBundle::GetBundleFileName(characterFile);
+   }
+
+   if (!dtAnim::CharacterBundle::Compile(characterFile, outputFilename))
+   {
+      LOG_ERROR("Unable to write the character bundle for: " + characterFile);
+      return 1;
+   }
+
+   LOG_ALWAYS("Character bundle written to: " + outputFilename);
+   return 0;
+}
@@ -0,0 +1,237 @@
+/* -*-c++-*-
+ * GMBenchmark - benchmarkactors (.h & .cpp) - Using 'The MIT License'
+ * Copyright (C) 2014, Caper Holdings LLC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "benchmarkactors.h"
+
+#include <dtCore/propertymacros.h>
+#include <dtGame/gameactor.h>
+#include <dtGame/messagetype.h>
+#include <dtUtil/stringutils.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace dtGMBenchmark
+{
+   /////////////////////////////////////////////////////////////////////////////
+   DT_IMPLEMENT_MESSAGE_TYPE_CLASS(BenchmarkMessageType);
+
+   namespace
+   {
+      std::vector<const BenchmarkMessageType*> gBenchmarkTypes;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void BenchmarkMessageType::CreateTypes(unsigned count)
+   {
+      count = std::min(count, unsigned(MAX_TYPES));
+      gBenchmarkTypes.reserve(count);
+      while (gBenchmarkTypes.size() < count)
+      {
+         unsigned index = unsigned(gBenchmarkTypes.size());
+         gBenchmarkTypes.push_back(new BenchmarkMessageType("Benchmark " + dtUtil::ToString(index), "Benchmark",
+            "A message sent by the GM benchmark.", (unsigned short)(BENCHMARK_MESSAGE_TYPE_ID + index),
+            DT_MSG_CLASS(BenchmarkMessage)));
+      }
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   unsigned BenchmarkMessageType::GetNumTypes()
+   {
+      return unsigned(gBenchmarkTypes.size());
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   const BenchmarkMessageType& BenchmarkMessageType::GetByIndex(unsigned index)
+   {
+      return *gBenchmarkTypes[index];
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   DT_IMPLEMENT_MESSAGE_BEGIN(BenchmarkMessage)
+      DT_ADD_PARAMETER(unsigned int, Sequence)
+      DT_ADD_PARAMETER(float, Value)
+   DT_IMPLEMENT_MESSAGE_END()
+
+   /////////////////////////////////////////////////////////////////////////////
+   /////////////////////////////////////////////////////////////////////////////
+   const dtUtil::RefString BenchmarkActor::PROPERTY_VALUE("Value");
+   const dtUtil::RefString BenchmarkActor::PROPERTY_COUNTER("Counter");
+   const dtUtil::RefString BenchmarkActor::PROPERTY_VELOCITY("Velocity");
+   const dtUtil::RefString BenchmarkActor::PROPERTY_LABEL("Label");
+
+   /////////////////////////////////////////////////////////////////////////////
+   BenchmarkActor::BenchmarkActor()
+   : mValue(0.0f)
+   , mCounter(0)
+   , mVelocity(0.0f, 0.0f, 0.0f)
+   , mLabel("Benchmark")
+   , mNumMessageTypes(1U)
+   , mTicking(false)
+   , mNumMessagesReceived(0U)
+   , mNumTicksReceived(0U)
+   {
+      SetClassName("dtGMBenchmark::BenchmarkActor");
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   BenchmarkActor::~BenchmarkActor()
+   {
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void BenchmarkActor::CreateDrawable()
+   {
+      SetDrawable(*new dtGame::GameActor(*this));
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void BenchmarkActor::BuildPropertyMap()
+   {
+      BaseClass::BuildPropertyMap();
+
+      typedef dtCore::PropertyRegHelper<BenchmarkActor> RegHelper;
+      static dtUtil::RefString GROUP("Benchmark");
+      RegHelper regHelper(*this, this, GROUP);
+
+      DT_REGISTER_PROPERTY(Value, "A float that is read and written by the benchmark.", RegHelper, regHelper);
+      DT_REGISTER_PROPERTY(Counter, "An int that is read and written by the benchmark.", RegHelper, regHelper);
+      DT_REGISTER_PROPERTY(Velocity, "A vector that is read and written by the benchmark.", RegHelper, regHelper);
+      DT_REGISTER_PROPERTY(Label, "A string that is read and written by the benchmark.", RegHelper, regHelper);
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void BenchmarkActor::OnEnteredWorld()
+   {
+      BaseClass::OnEnteredWorld();
+
+      unsigned numTypes = std::min(mNumMessageTypes, BenchmarkMessageType::GetNumTypes());
+      for (unsigned i = 0; i < numTypes; ++i)
+      {
+         RegisterForMessagesAboutSelf(BenchmarkMessageType::GetByIndex(i),
+            dtUtil::MakeFunctor(&BenchmarkActor::OnBenchmarkMessage, this));
+      }
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void BenchmarkActor::OnTickLocal(const dtGame::TickMessage& tickMessage)
+   {
+      ++mNumTicksReceived;
+      mValue += tickMessage.GetDeltaSimTime();
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void BenchmarkActor::SetTicking(bool ticking)
+   {
+      if (ticking == mTicking)
+      {
+         return;
+      }
+
+      mTicking = ticking;
+      if (mTicking)
+      {
+         RegisterForMessages(dtGame::MessageType::TICK_LOCAL, dtGame::GameActorProxy::TICK_LOCAL_INVOKABLE);
+      }
+      else
+      {
+         UnregisterForMessages(dtGame::MessageType::TICK_LOCAL, dtGame::GameActorProxy::TICK_LOCAL_INVOKABLE);
+      }
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void BenchmarkActor::OnBenchmarkMessage(const BenchmarkMessage& message)
+   {
+      ++mNumMessagesReceived;
+      mValue = message.GetValue();
+      ++mCounter;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   /////////////////////////////////////////////////////////////////////////////
+   BenchmarkComponent::BenchmarkComponent(const std::string& name)
+   : BaseClass(name)
+   , mRecordArrivals(false)
+   , mNumMessagesReceived(0U)
+   , mNumTicksReceived(0U)
+   {
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   BenchmarkComponent::~BenchmarkComponent()
+   {
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void BenchmarkComponent::ProcessMessage(const dtGame::Message& message)
+   {
+      if (message.GetMessageType() == dtGame::MessageType::TICK_LOCAL)
+      {
+         ++mNumTicksReceived;
+      }
+      else if (message.GetMessageType().GetId() >= BenchmarkMessageType::BENCHMARK_MESSAGE_TYPE_ID
+         && message.GetMessageType().GetId() < BenchmarkMessageType::BENCHMARK_MESSAGE_TYPE_ID + BenchmarkMessageType::GetNumTypes())
+      {
+         ++mNumMessagesReceived;
+         if (mRecordArrivals)
+         {
+            const BenchmarkMessage& benchmarkMessage = static_cast<const BenchmarkMessage&>(message);
+            unsigned sequence = benchmarkMessage.GetSequence();
+            if (sequence < mArrivalTicks.size())
+            {
+               mArrivalTicks[sequence] = osg::Timer::instance()->tick();
+            }
+         }
+      }
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void BenchmarkComponent::StartRecordingArrivals(unsigned numMessages)
+   {
+      mArrivalTicks.assign(numMessages, osg::Timer_t(0));
+      mRecordArrivals = true;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void BenchmarkComponent::StopRecordingArrivals()
+   {
+      mRecordArrivals = false;
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   /////////////////////////////////////////////////////////////////////////////
+   dtCore::RefPtr<dtCore::ActorType> BenchmarkActorRegistry::BENCHMARK_ACTOR_TYPE(
+      new dtCore::ActorType("Benchmark Actor", "Benchmark", "A game actor used to measure the GameManager."));
+
+   /////////////////////////////////////////////////////////////////////////////
+   BenchmarkActorRegistry::BenchmarkActorRegistry()
+   : dtCore::ActorPluginRegistry("GMBenchmark", "Actors used by the GameManager benchmark.")
+   {
+   }
+
+   /////////////////////////////////////////////////////////////////////////////
+   void BenchmarkActorRegistry::RegisterActorTypes()
+   {
+      mActorFactory->RegisterType<BenchmarkActor>(BENCHMARK_ACTOR_TYPE.get());
+   }
+}
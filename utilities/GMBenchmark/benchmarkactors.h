@@ -0,0 +1,173 @@
+/* -*-c++-*-
+ * GMBenchmark - benchmarkactors (.h & .cpp) - Using 'The MIT License'
+ * Copyright (C) 2014, Caper Holdings LLC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef GM_BENCHMARK_ACTORS_H
+#define GM_BENCHMARK_ACTORS_H
+
+#include <dtCore/actorpluginregistry.h>
+#include <dtCore/actortype.h>
+#include <dtGame/basemessages.h>
+#include <dtGame/gameactorproxy.h>
+#include <dtGame/gmcomponent.h>
+#include <dtGame/messagetype.h>
+#include <dtUtil/getsetmacros.h>
+
+#include <osg/Timer>
+#include <osg/Vec3>
+
+#include <vector>
+
+/// Everything here lives in the benchmark executable, so nothing is exported.
+#define GM_BENCHMARK_EXPORT
+
+namespace dtGMBenchmark
+{
+   /**
+    * The message types the benchmark sends.  They all use BenchmarkMessage, so sending
+    * more types only spreads the same traffic over more entries in the GM's dispatch maps.
+    */
+   DT_DECLARE_MESSAGE_TYPE_CLASS_BEGIN(BenchmarkMessageType, GM_BENCHMARK_EXPORT)
+      static const unsigned short BENCHMARK_MESSAGE_TYPE_ID = 4096;
+      /// Message type ids are 16 bits, so only this many fit above BENCHMARK_MESSAGE_TYPE_ID.
+      static const unsigned MAX_TYPES = 65536U - BENCHMARK_MESSAGE_TYPE_ID;
+
+      /**
+       * Creates types named "Benchmark 0" and up until there are count of them, at most MAX_TYPES.
+       * They are never deleted, because an enumeration can't remove its instances.
+       */
+      static void CreateTypes(unsigned count);
+
+      /// @return the number of types created so far.
+      static unsigned GetNumTypes();
+
+      /// @return the benchmark type with the given index, which must be less than GetNumTypes.
+      static const BenchmarkMessageType& GetByIndex(unsigned index);
+   DT_DECLARE_MESSAGE_TYPE_CLASS_END()
+
+   DT_DECLARE_MESSAGE_BEGIN(BenchmarkMessage, dtGame::Message, GM_BENCHMARK_EXPORT)
+      /// The index of the message in the run, so the receiver can find when it was sent.
+      DECLARE_PARAMETER_INLINE(unsigned int, Sequence)
+      /// Some payload, so the message isn't empty.
+      DECLARE_PARAMETER_INLINE(float, Value)
+   DT_DECLARE_MESSAGE_END()
+
+   /**
+    * A plain game actor with a few properties.  It handles the benchmark messages that are
+    * about itself through invokables, and counts ticks if ticking is turned on.
+    */
+   class GM_BENCHMARK_EXPORT BenchmarkActor : public dtGame::GameActorProxy
+   {
+   public:
+      typedef dtGame::GameActorProxy BaseClass;
+
+      static const dtUtil::RefString PROPERTY_VALUE;
+      static const dtUtil::RefString PROPERTY_COUNTER;
+      static const dtUtil::RefString PROPERTY_VELOCITY;
+      static const dtUtil::RefString PROPERTY_LABEL;
+
+      BenchmarkActor();
+
+      virtual void BuildPropertyMap();
+
+      /// Registers for the first NumMessageTypes benchmark message types about this actor.
+      virtual void OnEnteredWorld();
+
+      virtual void OnTickLocal(const dtGame::TickMessage& tickMessage);
+
+      /// Starts or stops getting TICK_LOCAL.
+      void SetTicking(bool ticking);
+      bool GetTicking() const { return mTicking; }
+
+      void OnBenchmarkMessage(const BenchmarkMessage& message);
+
+      unsigned GetNumMessagesReceived() const { return mNumMessagesReceived; }
+      unsigned GetNumTicksReceived() const { return mNumTicksReceived; }
+
+      DT_DECLARE_ACCESSOR_INLINE(float, Value)
+      DT_DECLARE_ACCESSOR_INLINE(int, Counter)
+      DT_DECLARE_ACCESSOR_INLINE(osg::Vec3, Velocity)
+      DT_DECLARE_ACCESSOR_INLINE(std::string, Label)
+
+      /// How many of the benchmark types to register for when entering the world.
+      DT_DECLARE_ACCESSOR_INLINE(unsigned, NumMessageTypes)
+
+   protected:
+      virtual ~BenchmarkActor();
+
+      virtual void CreateDrawable();
+
+   private:
+      bool mTicking;
+      unsigned mNumMessagesReceived;
+      unsigned mNumTicksReceived;
+   };
+
+   /**
+    * A component that looks at every message.  One of them can also time how long each
+    * benchmark message took to get to it from when it was sent.
+    */
+   class GM_BENCHMARK_EXPORT BenchmarkComponent : public dtGame::GMComponent
+   {
+   public:
+      typedef dtGame::GMComponent BaseClass;
+
+      BenchmarkComponent(const std::string& name);
+
+      virtual void ProcessMessage(const dtGame::Message& message);
+
+      /**
+       * Turns on recording when each benchmark message arrives.
+       * @param numMessages The number of messages that will be sent, so nothing allocates while recording.
+       */
+      void StartRecordingArrivals(unsigned numMessages);
+      void StopRecordingArrivals();
+
+      /// @return the tick each message arrived on, indexed by sequence.  Zero means it never arrived.
+      const std::vector<osg::Timer_t>& GetArrivalTicks() const { return mArrivalTicks; }
+
+      unsigned GetNumMessagesReceived() const { return mNumMessagesReceived; }
+      unsigned GetNumTicksReceived() const { return mNumTicksReceived; }
+
+   protected:
+      virtual ~BenchmarkComponent();
+
+   private:
+      bool mRecordArrivals;
+      std::vector<osg::Timer_t> mArrivalTicks;
+      unsigned mNumMessagesReceived;
+      unsigned mNumTicksReceived;
+   };
+
+   /// Registers BenchmarkActor.  The benchmark adds it with dtCore::AutoLibraryRegister.
+   class GM_BENCHMARK_EXPORT BenchmarkActorRegistry : public dtCore::ActorPluginRegistry
+   {
+   public:
+      static dtCore::RefPtr<dtCore::ActorType> BENCHMARK_ACTOR_TYPE;
+
+      BenchmarkActorRegistry();
+
+      virtual void RegisterActorTypes();
+   };
+}
+
+#endif // GM_BENCHMARK_ACTORS_H
@@ -0,0 +1,884 @@
+/* -*-c++-*-
+ * GMBenchmark - main - Using 'The MIT License'
+ * Copyright (C) 2014, Caper Holdings LLC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/// Runs a GameManager with no window and no GPU and measures its core paths:
+/// message dispatch to components and actor invokables, ticks, actor creation and
+/// deletion, property access and message serialization.
+///
+/// Examples
+///     GMBenchmark
+///            runs everything with the default sizes and writes GMBenchmarkResults.json
+///     GMBenchmark --actors 5000 --components 8 --messageTypes 4 --output run.json --label "after change"
+///     GMBenchmark --scenario MessageDispatch --frames 1000
+///
+/// The result file is JSON with one entry per scenario, so runs can be compared by a script.
+
+#include "benchmarkactors.h"
+
+#include <dtCore/actorfactory.h>
+#include <dtCore/floatactorproperty.h>
+#include <dtCore/scene.h>
+#include <dtCore/system.h>
+#include <dtGame/actorupdatemessage.h>
+#include <dtGame/gamemanager.h>
+#include <dtGame/messagefactory.h>
+#include <dtGame/messagetype.h>
+#include <dtUtil/datastream.h>
+#include <dtUtil/exception.h>
+#include <dtUtil/log.h>
+
+#include <osg/ArgumentParser>
+#include <osg/Timer>
+
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+// ALLOCATION COUNTING
+////////////////////////////////////////////////////////////////////////////////
+namespace
+{
+   /// Every operator new in the process bumps this.  On Windows the Delta3D dlls have their
+   /// own operator new, so only the allocations made by this executable are counted there.
+   /// It is a plain zero-initialized integer rather than an atomic class, because operator new
+   /// runs during static initialization, before any constructor in this file would have.
+#ifdef _MSC_VER
+   volatile long gNumAllocations = 0;
+#else
+   volatile unsigned gNumAllocations = 0;
+#endif
+
+   inline void CountAllocation()
+   {
+#ifdef _MSC_VER
+      _InterlockedIncrement(&gNumAllocations);
+#else
+      __sync_fetch_and_add(&gNumAllocations, 1U);
+#endif
+   }
+
+   inline unsigned GetNumAllocations()
+   {
+#ifdef _MSC_VER
+      return unsigned(_InterlockedExchangeAdd(&gNumAllocations, 0L));
+#else
+      return __sync_fetch_and_add(&gNumAllocations, 0U);
+#endif
+   }
+}
+
+void* operator new(std::size_t size)
+{
+   CountAllocation();
+   void* result = std::malloc(size != 0 ? size : 1);
+   if (result == NULL)
+   {
+      throw std::bad_alloc();
+   }
+   return result;
+}
+
+void* operator new[](std::size_t size)
+{
+   return operator new(size);
+}
+
+void operator delete(void* ptr) throw()
+{
+   std::free(ptr);
+}
+
+void operator delete[](void* ptr) throw()
+{
+   std::free(ptr);
+}
+
+namespace dtGMBenchmark
+{
+   ////////////////////////////////////////////////////////////////////////////////
+   // SETTINGS AND RESULTS
+   ////////////////////////////////////////////////////////////////////////////////
+   struct BenchmarkSettings
+   {
+      BenchmarkSettings()
+      : mNumActors(1000U)
+      , mNumComponents(4U)
+      , mNumMessageTypes(4U)
+      , mNumFrames(200U)
+      , mMessagesPerFrame(1000U)
+      , mWarmupFrames(10U)
+      , mOutputFile("GMBenchmarkResults.json")
+      {
+      }
+
+      unsigned mNumActors;
+      unsigned mNumComponents;
+      unsigned mNumMessageTypes;
+      unsigned mNumFrames;
+      unsigned mMessagesPerFrame;
+      unsigned mWarmupFrames;
+      std::string mOutputFile;
+      std::string mLabel;
+      std::string mScenario;
+   };
+
+   struct BenchmarkResult
+   {
+      BenchmarkResult(const std::string& name, const std::string& operation, const std::string& sampleKind)
+      : mName(name)
+      , mOperation(operation)
+      , mSampleKind(sampleKind)
+      , mOperations(0U)
+      , mSeconds(0.0)
+      , mAllocations(0U)
+      , mBytesPerOperation(0.0)
+      {
+      }
+
+      double GetOperationsPerSecond() const { return mSeconds > 0.0 ? double(mOperations) / mSeconds : 0.0; }
+      double GetAllocationsPerOperation() const { return mOperations > 0U ? double(mAllocations) / double(mOperations) : 0.0; }
+
+      std::string mName;
+      /// What one operation is, such as "message" or "tick".
+      std::string mOperation;
+      /// What each latency sample measures.
+      std::string mSampleKind;
+      unsigned long long mOperations;
+      double mSeconds;
+      unsigned long long mAllocations;
+      /// Only filled in by the serialization scenarios.
+      double mBytesPerOperation;
+      /// Latencies in microseconds.  They are sorted once the scenario is done.
+      std::vector<double> mSamples;
+   };
+
+   typedef std::vector<BenchmarkResult> ResultVector;
+
+   /// Everything the scenarios share.
+   struct BenchmarkContext
+   {
+      BenchmarkSettings mSettings;
+      dtCore::RefPtr<dtCore::Scene> mScene;
+      dtCore::RefPtr<dtGame::GameManager> mGM;
+      std::vector<dtCore::RefPtr<BenchmarkActor> > mActors;
+      std::vector<dtCore::RefPtr<BenchmarkComponent> > mComponents;
+   };
+
+   /// Measures the wall time and the allocations between Start and Stop.
+   class ScenarioMeasurement
+   {
+   public:
+      explicit ScenarioMeasurement(BenchmarkResult& result)
+      : mResult(result)
+      , mStartTick(0)
+      , mStartAllocations(0U)
+      {
+      }
+
+      void Start()
+      {
+         mStartAllocations = GetNumAllocations();
+         mStartTick = osg::Timer::instance()->tick();
+      }
+
+      void Stop(unsigned long long operations)
+      {
+         osg::Timer_t endTick = osg::Timer::instance()->tick();
+         // Unsigned math, so a wrap of the counter still gives the right difference.
+         unsigned allocations = GetNumAllocations() - mStartAllocations;
+
+         mResult.mOperations = operations;
+         mResult.mSeconds = osg::Timer::instance()->delta_s(mStartTick, endTick);
+         mResult.mAllocations = allocations;
+         std::sort(mResult.mSamples.begin(), mResult.mSamples.end());
+      }
+
+   private:
+      BenchmarkResult& mResult;
+      osg::Timer_t mStartTick;
+      unsigned mStartAllocations;
+   };
+
+   ////////////////////////////////////////////////////////////////////////////////
+   /// Nearest rank percentile of sorted samples.
+   double Percentile(const std::vector<double>& sortedSamples, double percent)
+   {
+      if (sortedSamples.empty())
+      {
+         return 0.0;
+      }
+
+      size_t rank = size_t(percent / 100.0 * double(sortedSamples.size()) + 0.5);
+      rank = std::min(std::max(rank, size_t(1)), sortedSamples.size());
+      return sortedSamples[rank - 1];
+   }
+
+   ////////////////////////////////////////////////////////////////////////////////
+   void StepFrames(unsigned numFrames)
+   {
+      for (unsigned i = 0; i < numFrames; ++i)
+      {
+         dtCore::System::GetInstance().Step();
+      }
+   }
+
+   ////////////////////////////////////////////////////////////////////////////////
+   // SCENARIOS
+   ////////////////////////////////////////////////////////////////////////////////
+
+   ////////////////////////////////////////////////////////////////////////////////
+   /// Sends benchmark messages about the actors, round robin over the message types, and
+   /// steps the GM to deliver them to every component and to the actor's invokable.
+   void RunMessageDispatch(BenchmarkContext& context, ResultVector& results)
+   {
+      const BenchmarkSettings& settings = context.mSettings;
+      dtGame::GameManager& gm = *context.mGM;
+      dtGame::MessageFactory& factory = gm.GetMessageFactory();
+
+      BenchmarkResult result("MessageDispatch", "message", "from SendMessage to the first component");
+      const unsigned numMessages = settings.mNumFrames * settings.mMessagesPerFrame;
+      const unsigned numTypes = BenchmarkMessageType::GetNumTypes();
+
+      std::vector<dtCore::UniqueId> actorIds;
+      actorIds.reserve(context.mActors.size());
+      for (size_t i = 0; i < context.mActors.size(); ++i)
+      {
+         actorIds.push_back(context.mActors[i]->GetId());
+      }
+
+      std::vector<osg::Timer_t> sendTicks(numMessages, osg::Timer_t(0));
+      result.mSamples.reserve(numMessages);
+
+      BenchmarkComponent& timingComponent = *context.mComponents.front();
+      timingComponent.StartRecordingArrivals(numMessages);
+
+      unsigned actorMessagesBefore = 0U;
+      for (size_t i = 0; i < context.mActors.size(); ++i)
+      {
+         actorMessagesBefore += context.mActors[i]->GetNumMessagesReceived();
+      }
+
+      const osg::Timer& timer = *osg::Timer::instance();
+      ScenarioMeasurement measurement(result);
+      measurement.Start();
+
+      unsigned sequence = 0U;
+      for (unsigned frame = 0; frame < settings.mNumFrames; ++frame)
+      {
+         for (unsigned i = 0; i < settings.mMessagesPerFrame; ++i, ++sequence)
+         {
+            dtCore::RefPtr<BenchmarkMessage> msg;
+            factory.CreateMessage(BenchmarkMessageType::GetByIndex(sequence % numTypes), msg);
+            if (!actorIds.empty())
+            {
+               msg->SetAboutActorId(actorIds[sequence % actorIds.size()]);
+            }
+            msg->SetSequence(sequence);
+            msg->SetValue(float(sequence));
+
+            sendTicks[sequence] = timer.tick();
+            gm.SendMessage(*msg);
+         }
+         dtCore::System::GetInstance().Step();
+      }
+
+      measurement.Stop(numMessages);
+      timingComponent.StopRecordingArrivals();
+
+      const std::vector<osg::Timer_t>& arrivalTicks = timingComponent.GetArrivalTicks();
+      unsigned numLost = 0U;
+      for (unsigned i = 0; i < numMessages; ++i)
+      {
+         if (arrivalTicks[i] == 0)
+         {
+            ++numLost;
+            continue;
+         }
+         result.mSamples.push_back(timer.delta_u(sendTicks[i], arrivalTicks[i]));
+      }
+      std::sort(result.mSamples.begin(), result.mSamples.end());
+
+      unsigned actorMessagesAfter = 0U;
+      for (size_t i = 0; i < context.mActors.size(); ++i)
+      {
+         actorMessagesAfter += context.mActors[i]->GetNumMessagesReceived();
+      }
+
+      if (numLost > 0U || (!context.mActors.empty() && actorMessagesAfter - actorMessagesBefore != numMessages))
+      {
+         std::ostringstream ss;
+         ss << "Not every benchmark message was delivered.  " << numLost << " never reached the components and the actors got "
+            << (actorMessagesAfter - actorMessagesBefore) << " of " << numMessages << ".";
+         LOG_WARNING(ss.str());
+      }
+
+      results.push_back(result);
+   }
+
+   ////////////////////////////////////////////////////////////////////////////////
+   /// Steps the GM with every actor and component getting TICK_LOCAL and no other traffic.
+   void RunComponentTick(BenchmarkContext& context, ResultVector& results)
+   {
+      const BenchmarkSettings& settings = context.mSettings;
+      BenchmarkResult result("ComponentTick", "tick", "one whole frame");
+
+      for (size_t i = 0; i < context.mActors.size(); ++i)
+      {
+         context.mActors[i]->SetTicking(true);
+      }
+      StepFrames(settings.mWarmupFrames);
+
+      result.mSamples.reserve(settings.mNumFrames);
+      const osg::Timer& timer = *osg::Timer::instance();
+      ScenarioMeasurement measurement(result);
+      measurement.Start();
+
+      for (unsigned frame = 0; frame < settings.mNumFrames; ++frame)
+      {
+         osg::Timer_t frameStart = timer.tick();
+         dtCore::System::GetInstance().Step();
+         result.mSamples.push_back(timer.delta_u(frameStart, timer.tick()));
+      }
+
+      unsigned long long ticksPerFrame = context.mActors.size() + context.mComponents.size();
+      measurement.Stop(ticksPerFrame * settings.mNumFrames);
+
+      for (size_t i = 0; i < context.mActors.size(); ++i)
+      {
+         context.mActors[i]->SetTicking(false);
+      }
+
+      results.push_back(result);
+   }
+
+   ////////////////////////////////////////////////////////////////////////////////
+   /// Creates and adds as many actors again as the benchmark has, steps so they enter
+   /// the world, then deletes them all and steps so they are removed.
+   void RunActorLifecycle(BenchmarkContext& context, ResultVector& results)
+   {
+      const BenchmarkSettings& settings = context.mSettings;
+      dtGame::GameManager& gm = *context.mGM;
+      BenchmarkResult result("ActorLifecycle", "actor created, added and deleted", "CreateActor and AddActor of one actor");
+
+      const unsigned numRounds = 5U;
+      const unsigned numActors = std::max(1U, settings.mNumActors);
+      std::vector<dtCore::RefPtr<BenchmarkActor> > actors;
+      actors.reserve(numActors);
+      result.mSamples.reserve(numRounds * numActors);
+
+      const osg::Timer& timer = *osg::Timer::instance();
+      ScenarioMeasurement measurement(result);
+      measurement.Start();
+
+      for (unsigned round = 0; round < numRounds; ++round)
+      {
+         for (unsigned i = 0; i < numActors; ++i)
+         {
+            osg::Timer_t start = timer.tick();
+            dtCore::RefPtr<BenchmarkActor> actor;
+            gm.CreateActor(*BenchmarkActorRegistry::BENCHMARK_ACTOR_TYPE, actor);
+            actor->SetNumMessageTypes(settings.mNumMessageTypes);
+            gm.AddActor(*actor, false, false);
+            result.mSamples.push_back(timer.delta_u(start, timer.tick()));
+            actors.push_back(actor);
+         }
+         dtCore::System::GetInstance().Step();
+
+         for (size_t i = 0; i < actors.size(); ++i)
+         {
+            gm.DeleteActor(*actors[i]);
+         }
+         actors.clear();
+         dtCore::System::GetInstance().Step();
+      }
+
+      measurement.Stop((unsigned long long)(numRounds) * numActors);
+      results.push_back(result);
+   }
+
+   ////////////////////////////////////////////////////////////////////////////////
+   /// Looks up a property by name on every actor and sets and gets it, the way generic code does.
+   void RunPropertyAccess(BenchmarkContext& context, ResultVector& results)
+   {
+      const BenchmarkSettings& settings = context.mSettings;
+      BenchmarkResult result("PropertyAccess", "property lookup, set and get", "one pass over all the actors, per actor");
+      if (context.mActors.empty())
+      {
+         return;
+      }
+
+      result.mSamples.reserve(settings.mNumFrames);
+      const osg::Timer& timer = *osg::Timer::instance();
+      float checksum = 0.0f;
+
+      ScenarioMeasurement measurement(result);
+      measurement.Start();
+
+      for (unsigned pass = 0; pass < settings.mNumFrames; ++pass)
+      {
+         osg::Timer_t passStart = timer.tick();
+         for (size_t i = 0; i < context.mActors.size(); ++i)
+         {
+            dtCore::FloatActorProperty* prop = NULL;
+            context.mActors[i]->GetProperty(BenchmarkActor::PROPERTY_VALUE, prop);
+            prop->SetValue(float(pass));
+            checksum += prop->GetValue();
+         }
+         result.mSamples.push_back(timer.delta_u(passStart, timer.tick()) / double(context.mActors.size()));
+      }
+
+      measurement.Stop((unsigned long long)(settings.mNumFrames) * context.mActors.size());
+
+      // Keeps the loop from being optimized away.
+      if (checksum < 0.0f)
+      {
+         LOG_ALWAYS("Unexpected property checksum.");
+      }
+      results.push_back(result);
+   }
+
+   ////////////////////////////////////////////////////////////////////////////////
+   /// Writes and reads every benchmark property through its string form, as the map and config code does.
+   void RunPropertyStrings(BenchmarkContext& context, ResultVector& results)
+   {
+      const BenchmarkSettings& settings = context.mSettings;
+      BenchmarkResult result("PropertyStrings", "property ToString and FromString", "one pass over all the actors, per property");
+      if (context.mActors.empty())
+      {
+         return;
+      }
+
+      const dtUtil::RefString* names[] =
+      {
+         &BenchmarkActor::PROPERTY_VALUE, &BenchmarkActor::PROPERTY_COUNTER,
+         &BenchmarkActor::PROPERTY_VELOCITY, &BenchmarkActor::PROPERTY_LABEL
+      };
+      const unsigned numNames = sizeof(names) / sizeof(names[0]);
+      const unsigned numPasses = std::max(1U, settings.mNumFrames / 10U);
+
+      result.mSamples.reserve(numPasses);
+      const osg::Timer& timer = *osg::Timer::instance();
+      unsigned numFailed = 0U;
+
+      ScenarioMeasurement measurement(result);
+      measurement.Start();
+
+      for (unsigned pass = 0; pass < numPasses; ++pass)
+      {
+         osg::Timer_t passStart = timer.tick();
+         for (size_t i = 0; i < context.mActors.size(); ++i)
+         {
+            for (unsigned n = 0; n < numNames; ++n)
+            {
+               dtCore::ActorProperty* prop = context.mActors[i]->GetProperty(*names[n]);
+               if (!prop->FromString(prop->ToString()))
+               {
+                  ++numFailed;
+               }
+            }
+         }
+         result.mSamples.push_back(timer.delta_u(passStart, timer.tick()) / double(context.mActors.size() * numNames));
+      }
+
+      measurement.Stop((unsigned long long)(numPasses) * context.mActors.size() * numNames);
+
+      if (numFailed > 0U)
+      {
+         LOG_WARNING("Some benchmark properties could not be read back from their string form.");
+      }
+      results.push_back(result);
+   }
+
+   ////////////////////////////////////////////////////////////////////////////////
+   /// Writes a full actor update to a DataStream and reads it back into another message.
+   void RunSerialization(BenchmarkContext& context, ResultVector& results, bool variableLength)
+   {
+      const BenchmarkSettings& settings = context.mSettings;
+      BenchmarkResult result(variableLength ? "SerializeVarInt" : "SerializeFixed",
+         "actor update written and read", "one write and read of one message");
+      if (context.mActors.empty())
+      {
+         return;
+      }
+
+      dtGame::MessageFactory& factory = context.mGM->GetMessageFactory();
+      dtCore::RefPtr<dtGame::ActorUpdateMessage> update;
+      factory.CreateMessage(dtGame::MessageType::INFO_ACTOR_UPDATED, update);
+      context.mActors.front()->PopulateActorUpdate(*update);
+
+      dtCore::RefPtr<dtGame::Message> copy = factory.CreateMessage(dtGame::MessageType::INFO_ACTOR_UPDATED);
+
+      dtUtil::DataStream stream;
+      stream.SetVariableLengthEncoding(variableLength);
+
+      const unsigned numMessages = std::max(1U, settings.mNumFrames * settings.mMessagesPerFrame / 10U);
+      result.mSamples.reserve(numMessages);
+      const osg::Timer& timer = *osg::Timer::instance();
+      unsigned numFailed = 0U;
+
+      ScenarioMeasurement measurement(result);
+      measurement.Start();
+
+      for (unsigned i = 0; i < numMessages; ++i)
+      {
+         osg::Timer_t start = timer.tick();
+         stream.Rewind();
+         update->ToDataStream(stream);
+         if (!copy->FromDataStream(stream))
+         {
+            ++numFailed;
+         }
+         result.mSamples.push_back(timer.delta_u(start, timer.tick()));
+      }
+
+      measurement.Stop(numMessages);
+      result.mBytesPerOperation = double(stream.GetWritePosition());
+
+      if (numFailed > 0U)
+      {
+         LOG_WARNING("Some actor updates could not be read back from the stream.");
+      }
+      results.push_back(result);
+   }
+
+   ////////////////////////////////////////////////////////////////////////////////
+   // REPORTING
+   ////////////////////////////////////////////////////////////////////////////////
+
+   ////////////////////////////////////////////////////////////////////////////////
+   void WriteJsonString(std::ostream& stream, const std::string& str)
+   {
+      stream << '"';
+      for (std::string::const_iterator i = str.begin(); i != str.end(); ++i)
+      {
+         if (*i == '"' || *i == '\\')
+         {
+            stream << '\\' << *i;
+         }
+         else if (static_cast<unsigned char>(*i) < 0x20)
+         {
+            stream << ' ';
+         }
+         else
+         {
+            stream << *i;
+         }
+      }
+      stream << '"';
+   }
+
+   ////////////////////////////////////////////////////////////////////////////////
+   void WriteResultsJson(std::ostream& stream, const BenchmarkSettings& settings, const ResultVector& results)
+   {
+      char timeString[32] = "";
+      std::time_t now = std::time(NULL);
+      std::strftime(timeString, sizeof(timeString), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+      stream << std::fixed << std::setprecision(3);
+      stream << "{\n";
+      stream << "  \"benchmark\": \"GMBenchmark\",\n";
+      stream << "  \"formatVersion\": 1,\n";
+      stream << "  \"label\": ";
+      WriteJsonString(stream, settings.mLabel);
+      stream << ",\n";
+      stream << "  \"time\": \"" << timeString << "\",\n";
+      stream << "  \"settings\": {\n";
+      stream << "    \"actors\": " << settings.mNumActors << ",\n";
+      stream << "    \"components\": " << settings.mNumComponents << ",\n";
+      stream << "    \"messageTypes\": " << settings.mNumMessageTypes << ",\n";
+      stream << "    \"frames\": " << settings.mNumFrames << ",\n";
+      stream << "    \"messagesPerFrame\": " << settings.mMessagesPerFrame << ",\n";
+      stream << "    \"warmupFrames\": " << settings.mWarmupFrames << "\n";
+      stream << "  },\n";
+      stream << "  \"results\": [";
+
+      for (size_t i = 0; i < results.size(); ++i)
+      {
+         const BenchmarkResult& result = results[i];
+         stream << (i == 0 ? "\n" : ",\n");
+         stream << "    {\n";
+         stream << "      \"name\": ";
+         WriteJsonString(stream, result.mName);
+         stream << ",\n      \"operation\": ";
+         WriteJsonString(stream, result.mOperation);
+         stream << ",\n";
+         stream << "      \"operations\": " << result.mOperations << ",\n";
+         stream << "      \"seconds\": " << std::setprecision(6) << result.mSeconds << std::setprecision(3) << ",\n";
+         stream << "      \"operationsPerSecond\": " << result.GetOperationsPerSecond() << ",\n";
+         stream << "      \"allocations\": " << result.mAllocations << ",\n";
+         stream << "      \"allocationsPerOperation\": " << result.GetAllocationsPerOperation() << ",\n";
+         if (result.mBytesPerOperation > 0.0)
+         {
+            stream << "      \"bytesPerOperation\": " << result.mBytesPerOperation << ",\n";
+         }
+         stream << "      \"latencyMicroseconds\": {\n";
+         stream << "        \"sample\": ";
+         WriteJsonString(stream, result.mSampleKind);
+         stream << ",\n";
+         stream << "        \"count\": " << result.mSamples.size() << ",\n";
+         stream << "        \"p50\": " << Percentile(result.mSamples, 50.0) << ",\n";
+         stream << "        \"p90\": " << Percentile(result.mSamples, 90.0) << ",\n";
+         stream << "        \"p99\": " << Percentile(result.mSamples, 99.0) << ",\n";
+         stream << "        \"p999\": " << Percentile(result.mSamples, 99.9) << ",\n";
+         stream << "        \"max\": " << (result.mSamples.empty() ? 0.0 : result.mSamples.back()) << "\n";
+         stream << "      }\n";
+         stream << "    }";
+      }
+
+      stream << "\n  ]\n}\n";
+   }
+
+   ////////////////////////////////////////////////////////////////////////////////
+   void PrintResults(std::ostream& stream, const ResultVector& results)
+   {
+      stream << std::left << std::setw(18) << "Scenario"
+             << std::right << std::setw(16) << "ops/s"
+             << std::setw(12) << "allocs/op"
+             << std::setw(12) << "p50 us"
+             << std::setw(12) << "p90 us"
+             << std::setw(12) << "p99 us"
+             << std::setw(12) << "max us" << "\n";
+
+      stream << std::fixed;
+      for (size_t i = 0; i < results.size(); ++i)
+      {
+         const BenchmarkResult& result = results[i];
+         stream << std::left << std::setw(18) << result.mName << std::right
+                << std::setprecision(0) << std::setw(16) << result.GetOperationsPerSecond()
+                << std::setprecision(2) << std::setw(12) << result.GetAllocationsPerOperation()
+                << std::setprecision(3)
+                << std::setw(12) << Percentile(result.mSamples, 50.0)
+                << std::setw(12) << Percentile(result.mSamples, 90.0)
+                << std::setw(12) << Percentile(result.mSamples, 99.0)
+                << std::setw(12) << (result.mSamples.empty() ? 0.0 : result.mSamples.back()) << "\n";
+      }
+   }
+
+   ////////////////////////////////////////////////////////////////////////////////
+   // SETUP
+   ////////////////////////////////////////////////////////////////////////////////
+
+   ////////////////////////////////////////////////////////////////////////////////
+   void SetupGameManager(BenchmarkContext& context)
+   {
+      const BenchmarkSettings& settings = context.mSettings;
+
+      dtCore::System& system = dtCore::System::GetInstance();
+      // Leave out the stages that traverse and draw the scene, there is nothing to draw to.
+      system.SetSystemStages(dtCore::System::STAGE_POST_EVENT_TRAVERSAL | dtCore::System::STAGE_PREFRAME
+         | dtCore::System::STAGE_FRAME_SYNCH | dtCore::System::STAGE_POSTFRAME);
+      system.Start();
+
+      context.mScene = new dtCore::Scene;
+      context.mGM = new dtGame::GameManager(*context.mScene);
+
+      for (unsigned i = 0; i < settings.mNumComponents; ++i)
+      {
+         std::ostringstream name;
+         name << "Benchmark Component " << i;
+         dtCore::RefPtr<BenchmarkComponent> component = new BenchmarkComponent(name.str());
+         context.mGM->AddComponent(*component, dtGame::GameManager::ComponentPriority::NORMAL);
+         context.mComponents.push_back(component);
+      }
+
+      // The message dispatch scenario times the messages with the first component.
+      if (context.mComponents.empty())
+      {
+         dtCore::RefPtr<BenchmarkComponent> component = new BenchmarkComponent("Benchmark Timing Component");
+         context.mGM->AddComponent(*component, dtGame::GameManager::ComponentPriority::NORMAL);
+         context.mComponents.push_back(component);
+      }
+
+      context.mActors.reserve(settings.mNumActors);
+      for (unsigned i = 0; i < settings.mNumActors; ++i)
+      {
+         dtCore::RefPtr<BenchmarkActor> actor;
+         context.mGM->CreateActor(*BenchmarkActorRegistry::BENCHMARK_ACTOR_TYPE, actor);
+         actor->SetNumMessageTypes(settings.mNumMessageTypes);
+         context.mGM->AddActor(*actor, false, false);
+         context.mActors.push_back(actor);
+      }
+
+      StepFrames(std::max(1U, settings.mWarmupFrames));
+   }
+
+   ////////////////////////////////////////////////////////////////////////////////
+   void ShutdownGameManager(BenchmarkContext& context)
+   {
+      context.mActors.clear();
+      context.mComponents.clear();
+      if (context.mGM.valid())
+      {
+         context.mGM->DeleteAllActors(true);
+         context.mGM->Shutdown();
+         context.mGM = NULL;
+      }
+      context.mScene = NULL;
+      dtCore::System::GetInstance().Stop();
+   }
+
+   ////////////////////////////////////////////////////////////////////////////////
+   bool ShouldRun(const BenchmarkSettings& settings, const std::string& scenario)
+   {
+      return settings.mScenario.empty() || settings.mScenario == scenario;
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int main(int argc, char** argv)
+{
+   using namespace dtGMBenchmark;
+
+   osg::ArgumentParser arguments(&argc, argv);
+   osg::ApplicationUsage& usage = *arguments.getApplicationUsage();
+   usage.setApplicationName("GMBenchmark");
+   usage.setDescription("Measures the GameManager's message dispatch, ticks, actor creation, properties and "
+      "message serialization with no window, and writes the results as JSON.");
+   usage.setCommandLineUsage(arguments.getApplicationName() + " [options]");
+   usage.addCommandLineOption("--actors <count>", "The number of actors in the GM.  Defaults to 1000.");
+   usage.addCommandLineOption("--components <count>", "The number of GM components that see every message.  Defaults to 4.");
+   usage.addCommandLineOption("--messageTypes <count>", "The number of message types to spread the messages over.  Defaults to 4.");
+   usage.addCommandLineOption("--frames <count>", "The number of frames each scenario runs.  Defaults to 200.");
+   usage.addCommandLineOption("--messagesPerFrame <count>", "The number of messages sent each frame.  Defaults to 1000.");
+   usage.addCommandLineOption("--warmupFrames <count>", "The number of frames stepped before measuring.  Defaults to 10.");
+   usage.addCommandLineOption("--scenario <name>", "Runs only one of MessageDispatch, ComponentTick, ActorLifecycle, "
+      "PropertyAccess, PropertyStrings, SerializeFixed or SerializeVarInt.");
+   usage.addCommandLineOption("--label <text>", "Text stored in the result file to tell runs apart, such as a revision.");
+   usage.addCommandLineOption("--output <filename>", "The result file.  Defaults to GMBenchmarkResults.json.");
+   usage.addCommandLineOption("--help", "Show usage.");
+
+   if (arguments.read("--help"))
+   {
+      usage.write(std::cout);
+      return 0;
+   }
+
+   BenchmarkSettings settings;
+   arguments.read("--actors", settings.mNumActors);
+   arguments.read("--components", settings.mNumComponents);
+   arguments.read("--messageTypes", settings.mNumMessageTypes);
+   arguments.read("--frames", settings.mNumFrames);
+   arguments.read("--messagesPerFrame", settings.mMessagesPerFrame);
+   arguments.read("--warmupFrames", settings.mWarmupFrames);
+   arguments.read("--scenario", settings.mScenario);
+   arguments.read("--label", settings.mLabel);
+   arguments.read("--output", settings.mOutputFile);
+   const unsigned numTypes = std::max(1U, std::min(settings.mNumMessageTypes, unsigned(BenchmarkMessageType::MAX_TYPES)));
+   if (numTypes != settings.mNumMessageTypes)
+   {
+      std::cout << "Warning: --messageTypes must be from 1 to " << BenchmarkMessageType::MAX_TYPES
+         << ", using " << numTypes << " instead of " << settings.mNumMessageTypes << "." << std::endl;
+      settings.mNumMessageTypes = numTypes;
+   }
+   BenchmarkMessageType::CreateTypes(settings.mNumMessageTypes);
+
+   arguments.reportRemainingOptionsAsUnrecognized();
+   if (arguments.errors())
+   {
+      arguments.writeErrorMessages(std::cout);
+      usage.write(std::cout);
+      return 1;
+   }
+
+   // Logging would be measured along with everything else.
+   dtUtil::Log::SetAllLogLevels(dtUtil::Log::LOG_WARNING);
+
+   dtCore::AutoLibraryRegister<BenchmarkActorRegistry> registry("GMBenchmark");
+
+   ResultVector results;
+   BenchmarkContext context;
+   context.mSettings = settings;
+
+   try
+   {
+      SetupGameManager(context);
+
+      if (ShouldRun(settings, "MessageDispatch"))
+      {
+         RunMessageDispatch(context, results);
+      }
+      if (ShouldRun(settings, "ComponentTick"))
+      {
+         RunComponentTick(context, results);
+      }
+      if (ShouldRun(settings, "ActorLifecycle"))
+      {
+         RunActorLifecycle(context, results);
+      }
+      if (ShouldRun(settings, "PropertyAccess"))
+      {
+         RunPropertyAccess(context, results);
+      }
+      if (ShouldRun(settings, "PropertyStrings"))
+      {
+         RunPropertyStrings(context, results);
+      }
+      if (ShouldRun(settings, "SerializeFixed"))
+      {
+         RunSerialization(context, results, false);
+      }
+      if (ShouldRun(settings, "SerializeVarInt"))
+      {
+         RunSerialization(context, results, true);
+      }
+   }
+   catch (const dtUtil::Exception& ex)
+   {
+      ex.LogException(dtUtil::Log::LOG_ERROR);
+      ShutdownGameManager(context);
+      return 1;
+   }
+
+   ShutdownGameManager(context);
+
+   if (results.empty())
+   {
+      LOG_ERROR("No scenario named \"" + settings.mScenario + "\".");
+      return 1;
+   }
+
+   PrintResults(std::cout, results);
+
+   std::ofstream resultFile(settings.mOutputFile.c_str(), std::ios::out | std::ios::trunc);
+   if (!resultFile.is_open())
+   {
+      LOG_ERROR("Unable to open \"" + settings.mOutputFile + "\" to write the benchmark results.");
+      return 1;
+   }
+   WriteResultsJson(resultFile, settings, results);
+   std::cout << "Results written to " << settings.mOutputFile << std::endl;
+
+   return 0;
+}
@@ -0,0 +1,103 @@
+/* -*-c++-*-
+ * MapBinaryConverter - main (.h & .cpp) - Using 'The MIT License'
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+///Utility to convert an xml map into the binary map format so the project loads it faster.
+///The xml map remains the file to edit; the project only uses the binary copy while it is at least
+///as new as the xml.
+/// Examples
+///     MapBinaryConverter.exe "c:/DemoMap" MyCoolMap
+///            will write MyCoolMap.dtmapb next to MyCoolMap.dtmap
+///     MapBinaryConverter.exe "c:/DemoMap" MyCoolMap output.dtmapb
+///            will write MyCoolMap into output.dtmapb
+
+#include <dtUtil/log.h>
+#include <dtUtil/fileutils.h>
+#include <dtCore/project.h>
+#include <dtCore/exceptionenum.h>
+#include <dtCore/map.h>
+#include <dtCore/mapbinary.h>
+#include <osgDB/FileNameUtils>
+
+void usage(const std::string& progName)
+{
+   LOG_ALWAYS("usage:" + progName + " <Project Context Path> <Map Name> [outputFile." + dtCore::MapBinaryWriter::MAP_FILE_EXTENSION + "]");
+}
+
+int main(int argc, char** argv)
+{
+   if (argc<3)
+   {
+      usage(std::string(argv[0]));
+      return 1;
+   }
+
+   const std::string contextPath(argv[1]);
+   const std::string mapName(argv[2]);
+
+   try
+   {
+      dtCore::Project::GetInstance().SetContext(contextPath, true);
+   }
+   catch (dtCore::ProjectInvalidContextException& e)
+   {
+      LOG_ERROR("Could not load project context");
+      e.LogException();
+      return 1;
+   }
+
+   int result = 0;
+   try
+   {
+      dtCore::Map& map = dtCore::Project::GetInstance().GetMap(mapName);
+
+      std::string outputFilename;
+      if (argc > 3)
+      {
+         outputFilename = std::string(argv[3]);
+      }
+      else
+      {
+         outputFilename = contextPath + dtUtil::FileUtils::PATH_SEPARATOR + dtCore::Project::MAP_DIRECTORY
+            + dtUtil::FileUtils::PATH_SEPARATOR + osgDB::getNameLessExtension(map.GetFileName())
+            + "." + dtCore::MapBinaryWriter::MAP_FILE_EXTENSION;
+      }
+
+      dtCore::RefPtr<dtCore::MapBinaryWriter> writer = new dtCore::MapBinaryWriter();
+      const std::string xmlFilename = contextPath + dtUtil::FileUtils::PATH_SEPARATOR + dtCore::Project::MAP_DIRECTORY
+         + dtUtil::FileUtils::PATH_SEPARATOR + map.GetFileName();
+      if (!writer->SetSourceFile(xmlFilename))
+      {
+         LOG_WARNING("Unable to read \"" + xmlFilename + "\", the binary map will not be loaded in place of it.");
+      }
+      writer->Save(map, outputFilename);
+      LOG_ALWAYS("Binary map written to: " + outputFilename);
+   }
+   catch (const dtUtil::Exception& e)
+   {
+      e.LogException();
+      result = 1;
+   }
+
+   dtCore::Project::GetInstance().CloseAllMaps(true);
+   return result;
+}